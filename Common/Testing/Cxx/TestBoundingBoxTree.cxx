@@ -0,0 +1,225 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestBoundingBoxTree.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVBoundingBoxTree.h"
+
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkSVGlobals.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static void RandomBoxes(vtkMinimalStandardRandomSequence *sequence,
+                        const int numBoxes, const double size,
+                        std::vector<double> &bounds)
+{
+  bounds.resize(6*numBoxes);
+  for (int i=0; i<numBoxes; i++)
+  {
+    for (int j=0; j<3; j++)
+    {
+      double center = sequence->GetValue();
+      sequence->Next();
+      double half = size*sequence->GetValue();
+      sequence->Next();
+      bounds[6*i+2*j]   = center - half;
+      bounds[6*i+2*j+1] = center + half;
+    }
+  }
+}
+
+// Compare queries against checking every box
+static int CompareQueries(vtkMinimalStandardRandomSequence *sequence,
+                          vtkSVBoundingBoxTree *tree,
+                          const std::vector<double> &bounds)
+{
+  int numBoxes = bounds.size()/6;
+  std::vector<double> queries;
+  RandomBoxes(sequence, 200, 0.1, queries);
+  std::vector<vtkIdType> found, expected;
+  for (int q=0; q<200; q++)
+  {
+    found.clear();
+    expected.clear();
+    tree->FindOverlappingBoxes(&queries[6*q], found);
+    for (int i=0; i<numBoxes; i++)
+    {
+      if (vtkSVBoundingBoxTree::BoundsOverlap(&bounds[6*i], &queries[6*q]))
+        expected.push_back(i);
+    }
+    std::sort(found.begin(), found.end());
+    if (found != expected)
+    {
+      fprintf(stdout,"Query %d found %d boxes, expected %d\n", q,
+              (int) found.size(), (int) expected.size());
+      return SV_ERROR;
+    }
+  }
+
+  return SV_OK;
+}
+
+static int TestQueries(const int numBoxes)
+{
+  vtkNew(vtkMinimalStandardRandomSequence, sequence);
+  sequence->SetSeed(1);
+
+  std::vector<double> bounds;
+  RandomBoxes(sequence, numBoxes, 0.02, bounds);
+
+  vtkNew(vtkSVBoundingBoxTree, tree);
+  tree->Build(&bounds[0], numBoxes);
+  if (tree->GetNumberOfBoxes() != numBoxes)
+  {
+    fprintf(stdout,"Tree has wrong number of boxes\n");
+    return SV_ERROR;
+  }
+
+  if (CompareQueries(sequence, tree, bounds) != SV_OK)
+    return SV_ERROR;
+
+  return SV_OK;
+}
+
+// Remove every removeStep box, number the others backwards with shrunk
+// bounds, and add numAdded new boxes after them
+static int UpdateBoxes(vtkMinimalStandardRandomSequence *sequence,
+                       vtkSVBoundingBoxTree *tree, const int removeStep,
+                       const int numAdded, std::vector<double> &bounds)
+{
+  int numBoxes = bounds.size()/6;
+  std::vector<vtkIdType> newIds(numBoxes, -1);
+  std::vector<double> newBounds;
+  for (int i=numBoxes-1; i>=0; i--)
+  {
+    if (i%removeStep == 0)
+      continue;
+    newIds[i] = newBounds.size()/6;
+    for (int j=0; j<3; j++)
+    {
+      double quarter = 0.25*(bounds[6*i+2*j+1] - bounds[6*i+2*j]);
+      newBounds.push_back(bounds[6*i+2*j] + quarter);
+      newBounds.push_back(bounds[6*i+2*j+1] - quarter);
+    }
+  }
+  std::vector<double> addedBounds;
+  RandomBoxes(sequence, numAdded, 0.02, addedBounds);
+  newBounds.insert(newBounds.end(), addedBounds.begin(), addedBounds.end());
+
+  tree->Update(&newBounds[0], newBounds.size()/6, &newIds[0]);
+  bounds.swap(newBounds);
+  if (tree->GetNumberOfBoxes() != (vtkIdType) bounds.size()/6)
+  {
+    fprintf(stdout,"Updated tree has %d boxes, expected %d\n",
+            (int) tree->GetNumberOfBoxes(), (int) bounds.size()/6);
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestUpdate(const int numBoxes)
+{
+  vtkNew(vtkMinimalStandardRandomSequence, sequence);
+  sequence->SetSeed(2);
+
+  std::vector<double> bounds;
+  RandomBoxes(sequence, numBoxes, 0.02, bounds);
+  vtkNew(vtkSVBoundingBoxTree, tree);
+  tree->Build(&bounds[0], numBoxes);
+
+  // A few updates in a row, the last one removes every box
+  if (UpdateBoxes(sequence, tree, 3, numBoxes/10, bounds) != SV_OK ||
+      CompareQueries(sequence, tree, bounds) != SV_OK)
+    return SV_ERROR;
+  if (UpdateBoxes(sequence, tree, 2, 0, bounds) != SV_OK ||
+      CompareQueries(sequence, tree, bounds) != SV_OK)
+    return SV_ERROR;
+  if (UpdateBoxes(sequence, tree, 5, numBoxes/2, bounds) != SV_OK ||
+      CompareQueries(sequence, tree, bounds) != SV_OK)
+    return SV_ERROR;
+  if (UpdateBoxes(sequence, tree, 1, 20, bounds) != SV_OK ||
+      CompareQueries(sequence, tree, bounds) != SV_OK)
+    return SV_ERROR;
+
+  return SV_OK;
+}
+
+static int TestDegenerate()
+{
+  // Many copies of the same box can not be split by their centers
+  std::vector<double> bounds;
+  for (int i=0; i<100; i++)
+  {
+    double box[6] = {0.0, 1.0, 0.0, 1.0, 0.0, 0.0};
+    bounds.insert(bounds.end(), box, box+6);
+  }
+  vtkNew(vtkSVBoundingBoxTree, tree);
+  tree->Build(&bounds[0], 100);
+
+  double query[6] = {0.5, 0.5, 0.5, 0.5, -1.0, 1.0};
+  std::vector<vtkIdType> found;
+  tree->FindOverlappingBoxes(query, found);
+  if (found.size() != 100)
+  {
+    fprintf(stdout,"Expected all boxes to be found\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+int TestBoundingBoxTree(int argc, char *argv[])
+{
+  if (TestQueries(1) != SV_OK)
+    return EXIT_FAILURE;
+  if (TestQueries(5000) != SV_OK)
+    return EXIT_FAILURE;
+  if (TestDegenerate() != SV_OK)
+    return EXIT_FAILURE;
+  if (TestUpdate(10) != SV_OK)
+    return EXIT_FAILURE;
+  if (TestUpdate(5000) != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
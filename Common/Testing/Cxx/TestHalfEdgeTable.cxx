@@ -0,0 +1,249 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestHalfEdgeTable.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVHalfEdgeTable.h"
+
+#include "vtkCellArray.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSVGlobals.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Octahedron, the second cell has the other orientation
+static void Octahedron(vtkPolyData *pd)
+{
+  vtkNew(vtkPoints, points);
+  points->InsertNextPoint( 1.0,  0.0,  0.0);
+  points->InsertNextPoint(-1.0,  0.0,  0.0);
+  points->InsertNextPoint( 0.0,  1.0,  0.0);
+  points->InsertNextPoint( 0.0, -1.0,  0.0);
+  points->InsertNextPoint( 0.0,  0.0,  1.0);
+  points->InsertNextPoint( 0.0,  0.0, -1.0);
+
+  vtkIdType tris[8][3] = {{0, 2, 4}, {4, 1, 2}, {1, 3, 4}, {3, 0, 4},
+                          {2, 0, 5}, {1, 2, 5}, {3, 1, 5}, {0, 3, 5}};
+  vtkNew(vtkCellArray, polys);
+  for (int i=0; i<8; i++)
+    polys->InsertNextCell(3, tris[i]);
+
+  pd->SetPoints(points);
+  pd->SetPolys(polys);
+}
+
+static int TestClosedMesh()
+{
+  vtkNew(vtkPolyData, pd);
+  Octahedron(pd);
+
+  vtkNew(vtkSVHalfEdgeTable, table);
+  table->Build(pd);
+
+  // Every edge of a closed triangle mesh is in two triangles
+  vtkIdType numCells = table->GetNumberOfCells();
+  if (numCells != 8 || table->GetNumberOfEdges() != 3*numCells/2)
+  {
+    fprintf(stdout,"Table has %d cells and %d edges, expected 8 and 12\n",
+            (int) numCells, (int) table->GetNumberOfEdges());
+    return SV_ERROR;
+  }
+  for (vtkIdType i=0; i<table->GetNumberOfEdges(); i++)
+  {
+    if (table->GetEdgeNumberOfCells(i) != 2)
+    {
+      fprintf(stdout,"Edge %d is not in two cells\n", (int) i);
+      return SV_ERROR;
+    }
+  }
+
+  std::vector<int> edgeUses(table->GetNumberOfEdges(), 0);
+  for (vtkIdType i=0; i<3*numCells; i++)
+  {
+    vtkIdType opposite = table->GetOpposite(i);
+    if (opposite < 0 || table->GetOpposite(opposite) != i)
+    {
+      fprintf(stdout,"Half-edge %d and its opposite do not match\n", (int) i);
+      return SV_ERROR;
+    }
+    if (table->GetCell(opposite) == table->GetCell(i) ||
+        table->GetNeighbor(i) != table->GetCell(opposite))
+    {
+      fprintf(stdout,"Half-edge %d has the wrong neighbor\n", (int) i);
+      return SV_ERROR;
+    }
+    if (table->GetEdge(i) != table->GetEdge(opposite) ||
+        table->FindHalfEdge(table->GetCell(opposite), table->GetOrigin(i),
+                            table->GetTarget(i)) != opposite)
+    {
+      fprintf(stdout,"Half-edge %d and its opposite are not on one edge\n", (int) i);
+      return SV_ERROR;
+    }
+    if (table->GetApex(i) == table->GetOrigin(i) ||
+        table->GetApex(i) == table->GetTarget(i))
+    {
+      fprintf(stdout,"Apex of half-edge %d is on the edge\n", (int) i);
+      return SV_ERROR;
+    }
+    edgeUses[table->GetEdge(i)]++;
+  }
+  for (size_t i=0; i<edgeUses.size(); i++)
+  {
+    if (edgeUses[i] != 2)
+    {
+      fprintf(stdout,"Edge %d has %d half-edges\n", (int) i, edgeUses[i]);
+      return SV_ERROR;
+    }
+  }
+
+  // Every point of the octahedron is in four triangles
+  for (vtkIdType i=0; i<pd->GetNumberOfPoints(); i++)
+  {
+    if (table->GetPointNumberOfCells(i) != 4)
+    {
+      fprintf(stdout,"Point %d is in %d cells, expected 4\n", (int) i,
+              (int) table->GetPointNumberOfCells(i));
+      return SV_ERROR;
+    }
+    const vtkIdType *halfEdges = table->GetPointHalfEdges(i);
+    for (int j=0; j<4; j++)
+    {
+      if (table->GetOrigin(halfEdges[j]) != i)
+      {
+        fprintf(stdout,"Half-edge %d does not start at point %d\n",
+                (int) halfEdges[j], (int) i);
+        return SV_ERROR;
+      }
+    }
+  }
+
+  return SV_OK;
+}
+
+static int TestOpenMesh()
+{
+  // Two triangles sharing one edge and a quad that has no half-edges
+  vtkNew(vtkPoints, points);
+  points->InsertNextPoint(0.0, 0.0, 0.0);
+  points->InsertNextPoint(1.0, 0.0, 0.0);
+  points->InsertNextPoint(1.0, 1.0, 0.0);
+  points->InsertNextPoint(0.0, 1.0, 0.0);
+  points->InsertNextPoint(2.0, 0.0, 0.0);
+  points->InsertNextPoint(2.0, 1.0, 0.0);
+
+  vtkIdType tri0[3] = {0, 1, 2}, tri1[3] = {0, 2, 3}, quad[4] = {1, 4, 5, 2};
+  vtkNew(vtkCellArray, polys);
+  polys->InsertNextCell(3, tri0);
+  polys->InsertNextCell(4, quad);
+  polys->InsertNextCell(3, tri1);
+
+  vtkNew(vtkPolyData, pd);
+  pd->SetPoints(points);
+  pd->SetPolys(polys);
+
+  vtkNew(vtkSVHalfEdgeTable, table);
+  table->Build(pd);
+
+  if (table->GetNumberOfEdges() != 5)
+  {
+    fprintf(stdout,"Table has %d edges, expected 5\n",
+            (int) table->GetNumberOfEdges());
+    return SV_ERROR;
+  }
+
+  vtkIdType shared0 = table->FindHalfEdge(0, 2, 0);
+  vtkIdType shared1 = table->FindHalfEdge(2, 0, 2);
+  if (shared0 < 0 || shared1 < 0 || table->GetOpposite(shared0) != shared1)
+  {
+    fprintf(stdout,"Shared edge is not found\n");
+    return SV_ERROR;
+  }
+
+  int numBoundary = 0;
+  for (int k=0; k<3; k++)
+  {
+    for (vtkIdType cellId=0; cellId<3; cellId+=2)
+    {
+      vtkIdType halfEdge = vtkSVHalfEdgeTable::GetHalfEdge(cellId, k);
+      if (table->GetOpposite(halfEdge) == -1)
+      {
+        numBoundary++;
+        if (table->GetNeighbor(halfEdge) != -1 ||
+            table->GetEdgeNumberOfCells(table->GetEdge(halfEdge)) != 1)
+        {
+          fprintf(stdout,"Boundary half-edge %d has a neighbor\n", (int) halfEdge);
+          return SV_ERROR;
+        }
+      }
+    }
+    if (table->GetOrigin(vtkSVHalfEdgeTable::GetHalfEdge(1, k)) != -1 ||
+        table->GetEdge(vtkSVHalfEdgeTable::GetHalfEdge(1, k)) != -1)
+    {
+      fprintf(stdout,"Quad has half-edges\n");
+      return SV_ERROR;
+    }
+  }
+  if (numBoundary != 4)
+  {
+    fprintf(stdout,"Found %d boundary half-edges, expected 4\n", numBoundary);
+    return SV_ERROR;
+  }
+
+  // Points of the quad only are in no triangles
+  if (table->GetPointNumberOfCells(4) != 0 ||
+      table->GetPointNumberOfCells(0) != 2)
+  {
+    fprintf(stdout,"Point stars are wrong\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+int TestHalfEdgeTable(int argc, char *argv[])
+{
+  if (TestClosedMesh() != SV_OK)
+    return EXIT_FAILURE;
+  if (TestOpenMesh() != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestIndexedHeap.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVIndexedHeap.h"
+
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkSVGlobals.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+// Pop everything and compare against the sorted keys and ids
+static int CheckOrder(vtkSVIndexedHeap *heap,
+                      std::vector<std::pair<double, vtkIdType> > &expected)
+{
+  std::sort(expected.begin(), expected.end());
+  if (heap->GetNumberOfItems() != static_cast<vtkIdType>(expected.size()))
+  {
+    fprintf(stdout,"Heap has %d items, expected %d\n",
+            (int) heap->GetNumberOfItems(), (int) expected.size());
+    return SV_ERROR;
+  }
+
+  for (size_t i=0; i<expected.size(); i++)
+  {
+    double peekKey, key;
+    vtkIdType peekId = heap->Peek(peekKey);
+    vtkIdType id = heap->Pop(key);
+    if (id != peekId || key != peekKey)
+    {
+      fprintf(stdout,"Peek and pop do not agree\n");
+      return SV_ERROR;
+    }
+    if (id != expected[i].second || key != expected[i].first)
+    {
+      fprintf(stdout,"Pop %d gave id %d with key %g, expected id %d with key %g\n",
+              (int) i, (int) id, key, (int) expected[i].second, expected[i].first);
+      return SV_ERROR;
+    }
+    if (heap->IsId(id))
+    {
+      fprintf(stdout,"Id %d is still in the heap after pop\n", (int) id);
+      return SV_ERROR;
+    }
+  }
+
+  double key;
+  if (heap->Pop(key) != -1 || heap->GetNumberOfItems() != 0)
+  {
+    fprintf(stdout,"Heap is not empty\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestKeyChanges(const int numIds)
+{
+  vtkNew(vtkMinimalStandardRandomSequence, sequence);
+  sequence->SetSeed(1);
+
+  vtkNew(vtkSVIndexedHeap, heap);
+  heap->Allocate(numIds);
+
+  std::vector<double> keys(numIds);
+  for (int i=0; i<numIds; i++)
+  {
+    keys[i] = sequence->GetValue();
+    sequence->Next();
+    heap->Insert(keys[i], i);
+  }
+
+  // Move every third id up or down and remove every fifth
+  for (int i=0; i<numIds; i+=3)
+  {
+    keys[i] = i%2 ? keys[i] - 0.5 : keys[i] + 0.5;
+    heap->Insert(keys[i], i);
+    if (heap->GetKey(i) != keys[i])
+    {
+      fprintf(stdout,"Key of id %d was not changed\n", i);
+      return SV_ERROR;
+    }
+  }
+  for (int i=0; i<numIds; i+=5)
+    heap->DeleteId(i);
+  heap->DeleteId(numIds + 10);
+
+  std::vector<std::pair<double, vtkIdType> > expected;
+  for (int i=0; i<numIds; i++)
+  {
+    if (i%5 == 0)
+    {
+      if (heap->IsId(i) || heap->GetKey(i) != VTK_DOUBLE_MAX)
+      {
+        fprintf(stdout,"Deleted id %d is still in the heap\n", i);
+        return SV_ERROR;
+      }
+      continue;
+    }
+    expected.push_back(std::make_pair(keys[i], static_cast<vtkIdType>(i)));
+  }
+
+  return CheckOrder(heap, expected);
+}
+
+static int TestEqualKeys()
+{
+  // Equal keys come out in order of id, ids past the allocation grow it
+  vtkNew(vtkSVIndexedHeap, heap);
+  heap->Allocate(4);
+
+  std::vector<std::pair<double, vtkIdType> > expected;
+  vtkIdType ids[6] = {7, 2, 12, 0, 5, 3};
+  for (int i=0; i<6; i++)
+  {
+    heap->Insert(1.0, ids[i]);
+    expected.push_back(std::make_pair(1.0, ids[i]));
+  }
+
+  if (CheckOrder(heap, expected) != SV_OK)
+    return SV_ERROR;
+
+  // Reuse after reset
+  heap->Insert(2.0, 1);
+  heap->Reset();
+  if (heap->GetNumberOfItems() != 0 || heap->IsId(1))
+  {
+    fprintf(stdout,"Heap is not empty after reset\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+int TestIndexedHeap(int argc, char *argv[])
+{
+  if (TestKeyChanges(1) != SV_OK)
+    return EXIT_FAILURE;
+  if (TestKeyChanges(1000) != SV_OK)
+    return EXIT_FAILURE;
+  if (TestEqualKeys() != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,253 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestQuadricKernels.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVQuadricKernels.h"
+
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkSVGlobals.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static double RandomValue(vtkMinimalStandardRandomSequence *sequence,
+                          const double low, const double high)
+{
+  double value = low + (high - low)*sequence->GetValue();
+  sequence->Next();
+  return value;
+}
+
+// Packed quadric with a positive definite system
+static void RandomQuadric(vtkMinimalStandardRandomSequence *sequence,
+                          const int numComps, std::vector<double> &quad)
+{
+  quad.resize(vtkSVQuadricKernels::GetQuadricSize(numComps));
+  for (size_t i=0; i<quad.size(); i++)
+    quad[i] = RandomValue(sequence, -0.5, 0.5);
+  quad[0]  += 5.0;
+  quad[4]  += 5.0;
+  quad[7]  += 5.0;
+  quad[10] = 4.0;
+}
+
+static int TestEvaluate(vtkMinimalStandardRandomSequence *sequence,
+                        const int numComps)
+{
+  std::vector<double> quad;
+  RandomQuadric(sequence, numComps, quad);
+
+  int n = 3 + numComps;
+  std::vector<double> a(n*n), b(n), x(n);
+  vtkSVQuadricKernels::AssembleSystem(&quad[0], numComps, &a[0], &b[0]);
+  for (int i=0; i<n; i++)
+    x[i] = RandomValue(sequence, -1.0, 1.0);
+
+  // x^T A x - 2 b^T x + c
+  double expected = quad[9];
+  for (int i=0; i<n; i++)
+  {
+    expected -= 2.0*b[i]*x[i];
+    for (int j=0; j<n; j++)
+      expected += x[i]*a[i*n+j]*x[j];
+  }
+
+  double cost = vtkSVQuadricKernels::Evaluate(&quad[0], &x[0], numComps);
+  if (fabs(cost - expected) > 1.0e-12*(1.0 + fabs(expected)))
+  {
+    fprintf(stdout,"Cost with %d components is %g, expected %g\n", numComps,
+            cost, expected);
+    return SV_ERROR;
+  }
+  if (numComps == 0 &&
+      vtkSVQuadricKernels::Evaluate(&quad[0], &x[0]) != cost)
+  {
+    fprintf(stdout,"Geometric cost does not match\n");
+    return SV_ERROR;
+  }
+
+  // Sum of two quadrics evaluates to the sum of the costs
+  std::vector<double> other, sum(quad.size());
+  RandomQuadric(sequence, numComps, other);
+  vtkSVQuadricKernels::Add(&quad[0], &other[0], &sum[0], quad.size());
+  double sumCost = vtkSVQuadricKernels::Evaluate(&sum[0], &x[0], numComps);
+  double addCost = cost + vtkSVQuadricKernels::Evaluate(&other[0], &x[0], numComps);
+  if (fabs(sumCost - addCost) > 1.0e-12*(1.0 + fabs(addCost)))
+  {
+    fprintf(stdout,"Cost of the sum is %g, expected %g\n", sumCost, addCost);
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestMinimize(vtkMinimalStandardRandomSequence *sequence,
+                        const int numComps)
+{
+  std::vector<double> quad;
+  RandomQuadric(sequence, numComps, quad);
+
+  int n = 3 + numComps;
+  std::vector<double> a(n*n), b(n);
+  vtkSVQuadricKernels::AssembleSystem(&quad[0], numComps, &a[0], &b[0]);
+  std::vector<double> factor(a), x(b);
+  if (!vtkSVQuadricKernels::SymmetricSolve(&factor[0], n, &x[0], 1.0e-12))
+  {
+    fprintf(stdout,"Could not solve a system of size %d\n", n);
+    return SV_ERROR;
+  }
+
+  // Residual of A x = b
+  for (int i=0; i<n; i++)
+  {
+    double r = -b[i];
+    for (int j=0; j<n; j++)
+      r += a[i*n+j]*x[j];
+    if (fabs(r) > 1.0e-10)
+    {
+      fprintf(stdout,"Residual %g in row %d of a system of size %d\n", r, i, n);
+      return SV_ERROR;
+    }
+  }
+
+  // The solution is the minimum of the quadric
+  double minCost = vtkSVQuadricKernels::Evaluate(&quad[0], &x[0], numComps);
+  for (int i=0; i<n; i++)
+  {
+    std::vector<double> y(x);
+    y[i] += 1.0e-3;
+    if (vtkSVQuadricKernels::Evaluate(&quad[0], &y[0], numComps) < minCost)
+    {
+      fprintf(stdout,"Solution of size %d is not the minimum\n", n);
+      return SV_ERROR;
+    }
+  }
+
+  return SV_OK;
+}
+
+static int TestSingular()
+{
+  // Points on a plane only constrain one direction
+  double a[9] = {1.0, 0.0, 0.0,
+                 0.0, 0.0, 0.0,
+                 0.0, 0.0, 0.0};
+  double x[3] = {1.0, 2.0, 3.0};
+  if (vtkSVQuadricKernels::SymmetricSolve(a, 3, x, 1.0e-12))
+  {
+    fprintf(stdout,"Solved a singular system\n");
+    return SV_ERROR;
+  }
+  if (x[0] != 1.0 || x[1] != 2.0 || x[2] != 3.0)
+  {
+    fprintf(stdout,"Right hand side changed for a singular system\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestLU4x4()
+{
+  // Zero first pivot needs a row swap
+  double a[4][4] = {{0.0, 2.0, 1.0, 1.0},
+                    {1.0, 1.0, 0.0, 1.0},
+                    {2.0, 0.0, 3.0, 1.0},
+                    {1.0, 1.0, 1.0, 0.0}};
+  double exact[4] = {1.0, -2.0, 0.5, 3.0};
+  double x[4];
+  for (int i=0; i<4; i++)
+  {
+    x[i] = 0.0;
+    for (int j=0; j<4; j++)
+      x[i] += a[i][j]*exact[j];
+  }
+
+  int index[4];
+  if (!vtkSVQuadricKernels::LUFactor4x4(a, index))
+  {
+    fprintf(stdout,"Could not factor a regular 4x4 matrix\n");
+    return SV_ERROR;
+  }
+  vtkSVQuadricKernels::LUSolve4x4(a, index, x);
+  for (int i=0; i<4; i++)
+  {
+    if (fabs(x[i] - exact[i]) > 1.0e-12)
+    {
+      fprintf(stdout,"LU solution %d is %g, expected %g\n", i, x[i], exact[i]);
+      return SV_ERROR;
+    }
+  }
+
+  double singular[4][4] = {{1.0, 2.0, 3.0, 4.0},
+                           {2.0, 4.0, 6.0, 8.0},
+                           {0.0, 1.0, 0.0, 1.0},
+                           {1.0, 0.0, 1.0, 0.0}};
+  if (vtkSVQuadricKernels::LUFactor4x4(singular, index))
+  {
+    fprintf(stdout,"Factored a singular 4x4 matrix\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+int TestQuadricKernels(int argc, char *argv[])
+{
+  vtkNew(vtkMinimalStandardRandomSequence, sequence);
+  sequence->SetSeed(1);
+
+  // Unrolled sizes and the run time sizes after them
+  for (int numComps=0; numComps<=vtkSVQuadricKernels::MAX_FIXED_SIZE-1; numComps++)
+  {
+    if (TestEvaluate(sequence, numComps) != SV_OK)
+      return EXIT_FAILURE;
+    if (TestMinimize(sequence, numComps) != SV_OK)
+      return EXIT_FAILURE;
+  }
+
+  if (TestSingular() != SV_OK)
+    return EXIT_FAILURE;
+  if (TestLU4x4() != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
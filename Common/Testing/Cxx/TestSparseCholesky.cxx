@@ -0,0 +1,259 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestSparseCholesky.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVSparseCholesky.h"
+
+#include "vtkSVGlobals.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Rows of a symmetric matrix with the full pattern
+struct TestMatrix
+{
+  int NumberOfRows;
+  std::vector<int> RowOffsets;
+  std::vector<int> Columns;
+  std::vector<double> Values;
+};
+
+static void AddValue(TestMatrix &mat, const int column, const double value)
+{
+  mat.Columns.push_back(column);
+  mat.Values.push_back(value);
+}
+
+// Tridiagonal matrix with diag on the diagonal and -1 beside it
+static void TridiagonalMatrix(const int numRows, const double diag, TestMatrix &mat)
+{
+  mat.NumberOfRows = numRows;
+  mat.RowOffsets.assign(1, 0);
+  mat.Columns.clear();
+  mat.Values.clear();
+  for (int i=0; i<numRows; i++)
+  {
+    if (i > 0)
+      AddValue(mat, i-1, -1.0);
+    AddValue(mat, i, diag);
+    if (i < numRows-1)
+      AddValue(mat, i+1, -1.0);
+    mat.RowOffsets.push_back(mat.Columns.size());
+  }
+}
+
+// Five point laplacian of a dim x dim grid with diag on the diagonal
+static void GridMatrix(const int dim, const double diag, TestMatrix &mat)
+{
+  mat.NumberOfRows = dim*dim;
+  mat.RowOffsets.assign(1, 0);
+  mat.Columns.clear();
+  mat.Values.clear();
+  for (int j=0; j<dim; j++)
+  {
+    for (int i=0; i<dim; i++)
+    {
+      int row = j*dim + i;
+      if (j > 0)
+        AddValue(mat, row-dim, -1.0);
+      if (i > 0)
+        AddValue(mat, row-1, -1.0);
+      AddValue(mat, row, diag);
+      if (i < dim-1)
+        AddValue(mat, row+1, -1.0);
+      if (j < dim-1)
+        AddValue(mat, row+dim, -1.0);
+      mat.RowOffsets.push_back(mat.Columns.size());
+    }
+  }
+}
+
+// Many disconnected tridiagonal blocks of blockSize rows
+static void BlockMatrix(const int numBlocks, const int blockSize,
+                        const double diag, TestMatrix &mat)
+{
+  mat.NumberOfRows = numBlocks*blockSize;
+  mat.RowOffsets.assign(1, 0);
+  mat.Columns.clear();
+  mat.Values.clear();
+  for (int row=0; row<mat.NumberOfRows; row++)
+  {
+    int i = row % blockSize;
+    if (i > 0)
+      AddValue(mat, row-1, -1.0);
+    AddValue(mat, row, diag);
+    if (i < blockSize-1)
+      AddValue(mat, row+1, -1.0);
+    mat.RowOffsets.push_back(mat.Columns.size());
+  }
+}
+
+// Solve for the right hand side of a known solution and compare
+static int CheckSolve(vtkSVSparseCholesky *cholesky, const TestMatrix &mat)
+{
+  int n = mat.NumberOfRows;
+  std::vector<double> exact(n), x(n, 0.0);
+  for (int i=0; i<n; i++)
+    exact[i] = sin(0.37*i) + 1.0;
+  for (int i=0; i<n; i++)
+  {
+    for (int p=mat.RowOffsets[i]; p<mat.RowOffsets[i+1]; p++)
+      x[i] += mat.Values[p]*exact[mat.Columns[p]];
+  }
+
+  cholesky->Solve(&x[0]);
+
+  double maxError = 0.0;
+  for (int i=0; i<n; i++)
+  {
+    if (fabs(x[i] - exact[i]) > maxError)
+      maxError = fabs(x[i] - exact[i]);
+  }
+  if (maxError > 1.0e-10)
+  {
+    fprintf(stdout,"Solution with %d rows is off by %g\n", n, maxError);
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestSolve(TestMatrix &mat)
+{
+  vtkNew(vtkSVSparseCholesky, cholesky);
+  if (cholesky->Analyze(mat.NumberOfRows, mat.RowOffsets, mat.Columns) != SV_OK)
+  {
+    fprintf(stdout,"Could not analyze the pattern\n");
+    return SV_ERROR;
+  }
+  if (cholesky->GetNumberOfRows() != mat.NumberOfRows)
+  {
+    fprintf(stdout,"Factor has wrong number of rows\n");
+    return SV_ERROR;
+  }
+  if (cholesky->Factorize(&mat.Values[0]) != SV_OK)
+  {
+    fprintf(stdout,"Could not factor a positive definite matrix\n");
+    return SV_ERROR;
+  }
+  if (CheckSolve(cholesky, mat) != SV_OK)
+    return SV_ERROR;
+
+  // New values on the same pattern reuse the analysis
+  for (size_t p=0; p<mat.Values.size(); p++)
+    mat.Values[p] *= 2.0;
+  if (cholesky->Factorize(&mat.Values[0]) != SV_OK)
+  {
+    fprintf(stdout,"Could not factor the scaled matrix\n");
+    return SV_ERROR;
+  }
+  if (CheckSolve(cholesky, mat) != SV_OK)
+    return SV_ERROR;
+
+  return SV_OK;
+}
+
+static int TestNotPositiveDefinite()
+{
+  // Eigenvalues are 1 - 2cos(k pi/11), some of them negative
+  TestMatrix mat;
+  TridiagonalMatrix(10, 1.0, mat);
+
+  vtkNew(vtkSVSparseCholesky, cholesky);
+  if (cholesky->Analyze(mat.NumberOfRows, mat.RowOffsets, mat.Columns) != SV_OK)
+  {
+    fprintf(stdout,"Could not analyze the pattern\n");
+    return SV_ERROR;
+  }
+  if (cholesky->Factorize(&mat.Values[0]) != SV_ERROR)
+  {
+    fprintf(stdout,"Factored an indefinite matrix\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestBadPattern()
+{
+  // Second row has no diagonal
+  std::vector<int> rowOffsets(3), columns(2);
+  rowOffsets[0] = 0; rowOffsets[1] = 1; rowOffsets[2] = 2;
+  columns[0] = 0; columns[1] = 0;
+
+  vtkNew(vtkSVSparseCholesky, cholesky);
+  if (cholesky->Analyze(2, rowOffsets, columns) != SV_ERROR)
+  {
+    fprintf(stdout,"Accepted a row without a diagonal\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+int TestSparseCholesky(int argc, char *argv[])
+{
+  TestMatrix mat;
+
+  TridiagonalMatrix(1, 2.0, mat);
+  if (TestSolve(mat) != SV_OK)
+    return EXIT_FAILURE;
+
+  TridiagonalMatrix(100, 2.0, mat);
+  if (TestSolve(mat) != SV_OK)
+    return EXIT_FAILURE;
+
+  GridMatrix(30, 4.5, mat);
+  if (TestSolve(mat) != SV_OK)
+    return EXIT_FAILURE;
+
+  // One component per block, more than the stack could hold as levels
+  BlockMatrix(200000, 2, 2.0, mat);
+  if (TestSolve(mat) != SV_OK)
+    return EXIT_FAILURE;
+
+  if (TestNotPositiveDefinite() != SV_OK)
+    return EXIT_FAILURE;
+  if (TestBadPattern() != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestTensor.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVTensor.h"
+
+#include "vtkSVGlobals.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+static int TestLayout()
+{
+  vtkSVTensor<double> a;
+  a.Resize(2, 3, 4);
+
+  for (int i=0; i<a.GetSize(); i++)
+    a(i) = i;
+
+  // Last index should be fastest
+  if (a(1, 2, 3) != 23 || a(0, 1, 0) != 4)
+  {
+    fprintf(stdout,"Tensor is not row-major\n");
+    return SV_ERROR;
+  }
+
+  vtkSVTensorView<double> view = a.GetView();
+  if (!view.IsContiguous() || view.GetStride(0) != 12 || view.GetStride(2) != 1)
+  {
+    fprintf(stdout,"Incorrect strides for full view\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestViews()
+{
+  vtkSVTensor<double> a;
+  a.Resize(3, 4, 2);
+  for (int i=0; i<a.GetSize(); i++)
+    a(i) = i;
+
+  // Swap axes and take a fiber along the original second axis
+  vtkSVTensorView<double> swapped = a.GetView().SwapAxes(0, 1);
+  vtkSVTensorView<double> fiber = swapped.Slice(2, 1).Slice(1, 2);
+  if (fiber.GetRank() != 1 || fiber.GetShape(0) != 4)
+  {
+    fprintf(stdout,"Incorrect fiber shape\n");
+    return SV_ERROR;
+  }
+  for (int j=0; j<4; j++)
+  {
+    if (fiber(j) != a(2, j, 1))
+    {
+      fprintf(stdout,"Fiber value %d is %.4f, expected %.4f\n", j, fiber(j), a(2, j, 1));
+      return SV_ERROR;
+    }
+  }
+  if (swapped.IsContiguous())
+  {
+    fprintf(stdout,"Swapped view should not be contiguous\n");
+    return SV_ERROR;
+  }
+
+  // Writing through a view writes the tensor
+  a.GetView().Range(1, 1, 3).Fill(-1.0);
+  for (int i=0; i<3; i++)
+  {
+    for (int j=0; j<4; j++)
+    {
+      bool inRange = j >= 1 && j < 3;
+      if ((a(i, j, 0) == -1.0) != inRange)
+      {
+        fprintf(stdout,"Range fill wrote wrong entries\n");
+        return SV_ERROR;
+      }
+    }
+  }
+
+  // Copy a transposed block
+  vtkSVTensor<double> b;
+  b.Resize(4, 3);
+  b.GetView().CopyFrom(a.GetView().Slice(2, 0).SwapAxes(0, 1));
+  for (int i=0; i<3; i++)
+  {
+    for (int j=0; j<4; j++)
+    {
+      if (b(j, i) != a(i, j, 0))
+      {
+        fprintf(stdout,"Transposed copy not equal\n");
+        return SV_ERROR;
+      }
+    }
+  }
+
+  return SV_OK;
+}
+
+static int TestReshape()
+{
+  vtkSVTensor<double> a;
+  a.Resize(6, 3);
+  for (int i=0; i<a.GetSize(); i++)
+    a(i) = i;
+
+  vtkIdType shape[4] = {2, 3, 1, 3};
+  a.Reshape(4, shape);
+  if (a.GetRank() != 4 || a(1, 2, 0, 1) != 16)
+  {
+    fprintf(stdout,"Reshape changed the values\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+int TestTensor(int argc, char *argv[])
+{
+  if (TestLayout() != SV_OK)
+  {
+    fprintf(stdout,"Tensor layout test failed\n");
+    return EXIT_FAILURE;
+  }
+  if (TestViews() != SV_OK)
+  {
+    fprintf(stdout,"Tensor view test failed\n");
+    return EXIT_FAILURE;
+  }
+  if (TestReshape() != SV_OK)
+  {
+    fprintf(stdout,"Tensor reshape test failed\n");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
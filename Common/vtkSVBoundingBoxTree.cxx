@@ -0,0 +1,600 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVBoundingBoxTree.h"
+
+#include "vtkObjectFactory.h"
+#include "vtkSVGlobals.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+// Number of bins used to evaluate the surface area heuristic
+const int NumberOfBins = 16;
+
+// ----------------------
+// BoundsArea
+// ----------------------
+/* Half the surface area of a box */
+double BoundsArea(const double bounds[6])
+{
+  double dx = bounds[1] - bounds[0];
+  double dy = bounds[3] - bounds[2];
+  double dz = bounds[5] - bounds[4];
+  return dx*dy + dy*dz + dz*dx;
+}
+
+// ----------------------
+// InitBounds
+// ----------------------
+void InitBounds(double bounds[6])
+{
+  for (int i=0; i<3; i++)
+  {
+    bounds[2*i]   = VTK_DOUBLE_MAX;
+    bounds[2*i+1] = -VTK_DOUBLE_MAX;
+  }
+}
+
+// ----------------------
+// AddToBounds
+// ----------------------
+void AddToBounds(const double box[6], double bounds[6])
+{
+  for (int i=0; i<3; i++)
+  {
+    bounds[2*i]   = svminimum(bounds[2*i], box[2*i]);
+    bounds[2*i+1] = svmaximum(bounds[2*i+1], box[2*i+1]);
+  }
+}
+
+// ----------------------
+// CenterOrder
+// ----------------------
+/* Orders items by their box center along one axis */
+struct CenterOrder
+{
+  const double *Centers;
+  int Axis;
+
+  bool operator()(const vtkIdType a, const vtkIdType b) const
+  {
+    return this->Centers[3*a+this->Axis] < this->Centers[3*b+this->Axis];
+  }
+};
+
+// ----------------------
+// InBin
+// ----------------------
+/* True for items whose center falls in a bin below the split */
+struct InBin
+{
+  const double *Centers;
+  int Axis;
+  int Split;
+  double Min;
+  double Scale;
+
+  bool operator()(const vtkIdType item) const
+  {
+    int bin = static_cast<int>((this->Centers[3*item+this->Axis]-this->Min)*this->Scale);
+    return svminimum(bin, NumberOfBins-1) < this->Split;
+  }
+};
+}
+
+// ----------------------
+// StandardNewMacro
+// ----------------------
+vtkStandardNewMacro(vtkSVBoundingBoxTree);
+
+// ----------------------
+// Constructor
+// ----------------------
+vtkSVBoundingBoxTree::vtkSVBoundingBoxTree()
+{
+  this->MaximumBoxesPerLeaf = 4;
+}
+
+// ----------------------
+// Destructor
+// ----------------------
+vtkSVBoundingBoxTree::~vtkSVBoundingBoxTree()
+{
+}
+
+// ----------------------
+// PrintSelf
+// ----------------------
+void vtkSVBoundingBoxTree::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Maximum boxes per leaf: " << this->MaximumBoxesPerLeaf << "\n";
+  os << indent << "Number of boxes: " << this->GetNumberOfBoxes() << "\n";
+  os << indent << "Number of nodes: " << this->GetNumberOfNodes() << "\n";
+}
+
+// ----------------------
+// Initialize
+// ----------------------
+void vtkSVBoundingBoxTree::Initialize()
+{
+  this->NodeBounds.clear();
+  this->NodeStarts.clear();
+  this->NodeCounts.clear();
+  this->Items.clear();
+  this->ItemBounds.clear();
+}
+
+// ----------------------
+// AddNode
+// ----------------------
+int vtkSVBoundingBoxTree::AddNode(const double *bounds, const vtkIdType begin,
+                                  const vtkIdType end)
+{
+  double nodeBounds[6];
+  InitBounds(nodeBounds);
+  for (vtkIdType i=begin; i<end; i++)
+    AddToBounds(&bounds[6*this->Items[i]], nodeBounds);
+
+  int nodeId = this->NodeCounts.size();
+  this->NodeBounds.insert(this->NodeBounds.end(), nodeBounds, nodeBounds+6);
+  this->NodeStarts.push_back(begin);
+  this->NodeCounts.push_back(end-begin);
+  return nodeId;
+}
+
+// ----------------------
+// Build
+// ----------------------
+void vtkSVBoundingBoxTree::Build(const double *bounds, const vtkIdType numberOfBoxes)
+{
+  this->Initialize();
+  if (numberOfBoxes <= 0)
+    return;
+
+  std::vector<double> centers(3*numberOfBoxes);
+  this->Items.resize(numberOfBoxes);
+  for (vtkIdType i=0; i<numberOfBoxes; i++)
+  {
+    this->Items[i] = i;
+    for (int j=0; j<3; j++)
+      centers[3*i+j] = 0.5*(bounds[6*i+2*j] + bounds[6*i+2*j+1]);
+  }
+
+  // Nodes still to split, each node covers Items[start, start+count)
+  this->AddNode(bounds, 0, numberOfBoxes);
+  std::vector<int> toSplit(1, 0);
+  while (!toSplit.empty())
+  {
+    int nodeId = toSplit.back();
+    toSplit.pop_back();
+
+    vtkIdType begin = this->NodeStarts[nodeId];
+    vtkIdType end   = begin + this->NodeCounts[nodeId];
+    if (end - begin <= this->MaximumBoxesPerLeaf)
+      continue;
+
+    double centerBounds[6];
+    InitBounds(centerBounds);
+    for (vtkIdType i=begin; i<end; i++)
+    {
+      const double *c = &centers[3*this->Items[i]];
+      double point[6] = {c[0], c[0], c[1], c[1], c[2], c[2]};
+      AddToBounds(point, centerBounds);
+    }
+
+    // Binned surface area heuristic on each axis
+    int bestAxis = -1;
+    int bestSplit = 0;
+    double bestCost = VTK_DOUBLE_MAX;
+    for (int axis=0; axis<3; axis++)
+    {
+      double min    = centerBounds[2*axis];
+      double extent = centerBounds[2*axis+1] - min;
+      if (extent <= 0.0)
+        continue;
+      double scale = NumberOfBins/extent;
+
+      int binCounts[NumberOfBins];
+      double binBounds[NumberOfBins][6];
+      for (int b=0; b<NumberOfBins; b++)
+      {
+        binCounts[b] = 0;
+        InitBounds(binBounds[b]);
+      }
+      for (vtkIdType i=begin; i<end; i++)
+      {
+        vtkIdType item = this->Items[i];
+        int b = svminimum(static_cast<int>((centers[3*item+axis]-min)*scale), NumberOfBins-1);
+        binCounts[b]++;
+        AddToBounds(&bounds[6*item], binBounds[b]);
+      }
+
+      // Sweep from the right to get the right side area of every split
+      double rightArea[NumberOfBins];
+      int rightCount[NumberOfBins];
+      double sweepBounds[6];
+      InitBounds(sweepBounds);
+      int sweepCount = 0;
+      for (int b=NumberOfBins-1; b>0; b--)
+      {
+        sweepCount += binCounts[b];
+        if (binCounts[b] > 0)
+          AddToBounds(binBounds[b], sweepBounds);
+        rightCount[b] = sweepCount;
+        rightArea[b]  = sweepCount > 0 ? BoundsArea(sweepBounds) : 0.0;
+      }
+      InitBounds(sweepBounds);
+      sweepCount = 0;
+      for (int b=1; b<NumberOfBins; b++)
+      {
+        sweepCount += binCounts[b-1];
+        if (binCounts[b-1] > 0)
+          AddToBounds(binBounds[b-1], sweepBounds);
+        if (sweepCount == 0 || rightCount[b] == 0)
+          continue;
+        double cost = sweepCount*BoundsArea(sweepBounds) + rightCount[b]*rightArea[b];
+        if (cost < bestCost)
+        {
+          bestCost  = cost;
+          bestAxis  = axis;
+          bestSplit = b;
+        }
+      }
+    }
+
+    vtkIdType mid = begin;
+    if (bestAxis != -1)
+    {
+      InBin below;
+      below.Centers = &centers[0];
+      below.Axis    = bestAxis;
+      below.Split   = bestSplit;
+      below.Min     = centerBounds[2*bestAxis];
+      below.Scale   = NumberOfBins/(centerBounds[2*bestAxis+1] - below.Min);
+      mid = std::partition(this->Items.begin()+begin, this->Items.begin()+end, below) -
+            this->Items.begin();
+    }
+    if (mid == begin || mid == end)
+    {
+      // All centers together, split in half along the longest axis
+      int axis = 0;
+      for (int j=1; j<3; j++)
+      {
+        if (centerBounds[2*j+1]-centerBounds[2*j] > centerBounds[2*axis+1]-centerBounds[2*axis])
+          axis = j;
+      }
+      CenterOrder order;
+      order.Centers = &centers[0];
+      order.Axis    = axis;
+      mid = (begin+end)/2;
+      std::nth_element(this->Items.begin()+begin, this->Items.begin()+mid,
+                       this->Items.begin()+end, order);
+    }
+
+    // Children are stored next to each other
+    int left  = this->AddNode(bounds, begin, mid);
+    int right = this->AddNode(bounds, mid, end);
+    this->NodeStarts[nodeId] = left;
+    this->NodeCounts[nodeId] = 0;
+    toSplit.push_back(right);
+    toSplit.push_back(left);
+  }
+
+  // Copy of the box bounds in leaf order for the final tests in queries
+  this->ItemBounds.resize(6*numberOfBoxes);
+  for (vtkIdType i=0; i<numberOfBoxes; i++)
+    std::copy(&bounds[6*this->Items[i]], &bounds[6*this->Items[i]]+6, &this->ItemBounds[6*i]);
+}
+
+// ----------------------
+// Update
+// ----------------------
+void vtkSVBoundingBoxTree::Update(const double *bounds, const vtkIdType numberOfBoxes,
+                                  const vtkIdType *newIds)
+{
+  if (this->NodeCounts.empty() || numberOfBoxes <= 0)
+  {
+    this->Build(bounds, numberOfBoxes);
+    return;
+  }
+
+  // Nodes that can be reached from the root, parents before children
+  int numNodes = this->NodeCounts.size();
+  std::vector<int> order;
+  order.reserve(numNodes);
+  std::vector<int> stack(1, 0);
+  while (!stack.empty())
+  {
+    int nodeId = stack.back();
+    stack.pop_back();
+    order.push_back(nodeId);
+    if (this->NodeCounts[nodeId] == 0)
+    {
+      stack.push_back(this->NodeStarts[nodeId]+1);
+      stack.push_back(this->NodeStarts[nodeId]);
+    }
+  }
+
+  // New ids of the boxes kept in each leaf, and the number of kept boxes
+  // under each node with their bounds, children before parents
+  std::vector<char> used(numberOfBoxes, 0);
+  std::vector<vtkIdType> keptItems;
+  keptItems.reserve(numberOfBoxes);
+  std::vector<vtkIdType> keptStarts(numNodes, 0), keptCounts(numNodes, 0);
+  std::vector<double> keptBounds(6*numNodes);
+  for (int k=order.size()-1; k>=0; k--)
+  {
+    int nodeId = order[k];
+    double *nodeBounds = &keptBounds[6*nodeId];
+    InitBounds(nodeBounds);
+    if (this->NodeCounts[nodeId] == 0)
+    {
+      int left = this->NodeStarts[nodeId];
+      keptCounts[nodeId] = keptCounts[left] + keptCounts[left+1];
+      for (int child=left; child<left+2; child++)
+      {
+        if (keptCounts[child] > 0)
+          AddToBounds(&keptBounds[6*child], nodeBounds);
+      }
+      continue;
+    }
+
+    keptStarts[nodeId] = keptItems.size();
+    vtkIdType start = this->NodeStarts[nodeId];
+    for (vtkIdType i=start; i<start+this->NodeCounts[nodeId]; i++)
+    {
+      vtkIdType newId = newIds[this->Items[i]];
+      if (newId < 0 || newId >= numberOfBoxes || used[newId])
+        continue;
+      used[newId] = 1;
+      keptItems.push_back(newId);
+      AddToBounds(&bounds[6*newId], nodeBounds);
+    }
+    keptCounts[nodeId] = keptItems.size() - keptStarts[nodeId];
+  }
+  if (keptCounts[0] == 0)
+  {
+    this->Build(bounds, numberOfBoxes);
+    return;
+  }
+
+  // Copy the nodes that still hold boxes. An inner node with one empty child
+  // is replaced by the other child, so every leaf keeps at least one box.
+  std::vector<vtkIdType> oldStarts;
+  std::vector<int> oldCounts;
+  oldStarts.swap(this->NodeStarts);
+  oldCounts.swap(this->NodeCounts);
+  this->NodeBounds.assign(6, 0.0);
+  this->NodeStarts.assign(1, 0);
+  this->NodeCounts.assign(1, 0);
+  this->Items.clear();
+
+  // Pairs of old node and the new node it is copied to
+  std::vector<std::pair<int, int> > toCopy(1, std::make_pair(0, 0));
+  while (!toCopy.empty())
+  {
+    int oldId = toCopy.back().first;
+    int newId = toCopy.back().second;
+    toCopy.pop_back();
+    while (oldCounts[oldId] == 0)
+    {
+      int left = oldStarts[oldId];
+      if (keptCounts[left] == 0)
+        oldId = left+1;
+      else if (keptCounts[left+1] == 0)
+        oldId = left;
+      else
+        break;
+    }
+    std::copy(&keptBounds[6*oldId], &keptBounds[6*oldId]+6, &this->NodeBounds[6*newId]);
+
+    if (oldCounts[oldId] == 0)
+    {
+      // Children are stored next to each other
+      int left = this->NodeCounts.size();
+      this->NodeBounds.resize(6*(left+2));
+      this->NodeStarts.resize(left+2);
+      this->NodeCounts.resize(left+2);
+      this->NodeStarts[newId] = left;
+      this->NodeCounts[newId] = 0;
+      toCopy.push_back(std::make_pair(oldStarts[oldId]+1, left+1));
+      toCopy.push_back(std::make_pair(oldStarts[oldId], left));
+      continue;
+    }
+
+    this->NodeStarts[newId] = this->Items.size();
+    this->NodeCounts[newId] = keptCounts[oldId];
+    this->Items.insert(this->Items.end(), keptItems.begin()+keptStarts[oldId],
+                       keptItems.begin()+keptStarts[oldId]+keptCounts[oldId]);
+  }
+
+  std::vector<vtkIdType> addedIds;
+  for (vtkIdType i=0; i<numberOfBoxes; i++)
+  {
+    if (!used[i])
+      addedIds.push_back(i);
+  }
+  if (!addedIds.empty())
+  {
+    std::vector<double> addedBounds(6*addedIds.size());
+    for (size_t i=0; i<addedIds.size(); i++)
+      std::copy(&bounds[6*addedIds[i]], &bounds[6*addedIds[i]]+6, &addedBounds[6*i]);
+
+    vtkNew(vtkSVBoundingBoxTree, added);
+    added->SetMaximumBoxesPerLeaf(this->MaximumBoxesPerLeaf);
+    added->Build(&addedBounds[0], addedIds.size());
+
+    // The old root moves next to the root of the added tree, which comes
+    // with its nodes and items shifted to the end
+    int oldRoot = this->NodeCounts.size();
+    vtkIdType itemOffset = this->Items.size();
+    double rootBounds[6];
+    std::copy(&this->NodeBounds[0], &this->NodeBounds[0]+6, rootBounds);
+    vtkIdType rootStart = this->NodeStarts[0];
+    int rootCount = this->NodeCounts[0];
+    this->NodeBounds.insert(this->NodeBounds.end(), rootBounds, rootBounds+6);
+    this->NodeStarts.push_back(rootStart);
+    this->NodeCounts.push_back(rootCount);
+    for (int j=0; j<added->GetNumberOfNodes(); j++)
+    {
+      this->NodeBounds.insert(this->NodeBounds.end(), &added->NodeBounds[6*j],
+                              &added->NodeBounds[6*j]+6);
+      if (added->NodeCounts[j] == 0)
+        this->NodeStarts.push_back(added->NodeStarts[j] + oldRoot + 1);
+      else
+        this->NodeStarts.push_back(added->NodeStarts[j] + itemOffset);
+      this->NodeCounts.push_back(added->NodeCounts[j]);
+    }
+    for (vtkIdType i=0; i<added->GetNumberOfBoxes(); i++)
+      this->Items.push_back(addedIds[added->Items[i]]);
+
+    AddToBounds(&added->NodeBounds[0], &this->NodeBounds[0]);
+    this->NodeStarts[0] = oldRoot;
+    this->NodeCounts[0] = 0;
+  }
+
+  // Copy of the box bounds in leaf order for the final tests in queries
+  this->ItemBounds.resize(6*this->Items.size());
+  for (size_t i=0; i<this->Items.size(); i++)
+    std::copy(&bounds[6*this->Items[i]], &bounds[6*this->Items[i]]+6, &this->ItemBounds[6*i]);
+}
+
+// ----------------------
+// FindOverlappingBoxes
+// ----------------------
+void vtkSVBoundingBoxTree::FindOverlappingBoxes(const double bounds[6],
+                                                std::vector<vtkIdType> &ids) const
+{
+  if (this->NodeCounts.empty())
+    return;
+
+  std::vector<int> stack;
+  stack.reserve(64);
+  stack.push_back(0);
+  while (!stack.empty())
+  {
+    int nodeId = stack.back();
+    stack.pop_back();
+    if (!vtkSVBoundingBoxTree::BoundsOverlap(&this->NodeBounds[6*nodeId], bounds))
+      continue;
+
+    if (this->NodeCounts[nodeId] == 0)
+    {
+      stack.push_back(this->NodeStarts[nodeId]+1);
+      stack.push_back(this->NodeStarts[nodeId]);
+      continue;
+    }
+
+    vtkIdType start = this->NodeStarts[nodeId];
+    for (vtkIdType i=start; i<start+this->NodeCounts[nodeId]; i++)
+    {
+      if (vtkSVBoundingBoxTree::BoundsOverlap(&this->ItemBounds[6*i], bounds))
+        ids.push_back(this->Items[i]);
+    }
+  }
+}
+
+// ----------------------
+// FindClosestBox
+// ----------------------
+vtkIdType vtkSVBoundingBoxTree::FindClosestBox(const double x[3],
+                                               BoxDistance2Function distance2,
+                                               void *data, double &dist2) const
+{
+  dist2 = VTK_DOUBLE_MAX;
+  if (this->NodeCounts.empty())
+    return -1;
+
+  // Nodes with the squared distance to their bounds, nearer child on top
+  vtkIdType closestId = -1;
+  std::vector<std::pair<double, int> > stack;
+  stack.reserve(64);
+  stack.push_back(std::make_pair(vtkSVBoundingBoxTree::Distance2ToBounds(x, &this->NodeBounds[0]), 0));
+  while (!stack.empty())
+  {
+    double nodeDist2 = stack.back().first;
+    int nodeId = stack.back().second;
+    stack.pop_back();
+    if (nodeDist2 >= dist2)
+      continue;
+
+    if (this->NodeCounts[nodeId] == 0)
+    {
+      int left  = this->NodeStarts[nodeId];
+      int right = left + 1;
+      double leftDist2  = vtkSVBoundingBoxTree::Distance2ToBounds(x, &this->NodeBounds[6*left]);
+      double rightDist2 = vtkSVBoundingBoxTree::Distance2ToBounds(x, &this->NodeBounds[6*right]);
+      if (leftDist2 < rightDist2)
+      {
+        stack.push_back(std::make_pair(rightDist2, right));
+        stack.push_back(std::make_pair(leftDist2, left));
+      }
+      else
+      {
+        stack.push_back(std::make_pair(leftDist2, left));
+        stack.push_back(std::make_pair(rightDist2, right));
+      }
+      continue;
+    }
+
+    vtkIdType start = this->NodeStarts[nodeId];
+    for (vtkIdType i=start; i<start+this->NodeCounts[nodeId]; i++)
+    {
+      if (vtkSVBoundingBoxTree::Distance2ToBounds(x, &this->ItemBounds[6*i]) >= dist2)
+        continue;
+      double itemDist2 = distance2(this->Items[i], x, data);
+      if (itemDist2 < dist2)
+      {
+        dist2 = itemDist2;
+        closestId = this->Items[i];
+      }
+    }
+  }
+
+  return closestId;
+}
+
+// ----------------------
+// GetBounds
+// ----------------------
+bool vtkSVBoundingBoxTree::GetBounds(double bounds[6]) const
+{
+  if (this->NodeCounts.empty())
+    return false;
+  for (int i=0; i<6; i++)
+    bounds[i] = this->NodeBounds[i];
+  return true;
+}
@@ -0,0 +1,172 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class vtkSVBoundingBoxTree
+ *  \brief Bounding volume hierarchy over a set of axis aligned boxes stored
+ *  in flat arrays.
+ *
+ *  The tree is built with the surface area heuristic over binned box
+ *  centers. Nodes are kept in one array with the two children of a node
+ *  stored next to each other, and the boxes of a leaf are a contiguous
+ *  range of the item array, so queries do not chase pointers. Queries only
+ *  read the tree and use their own stack, which makes them safe to call
+ *  from several threads at once, for example from a vtkSMPTools functor.
+ *
+ *  Bounds follow the VTK ordering (xmin, xmax, ymin, ymax, zmin, zmax).
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVBoundingBoxTree_h
+#define vtkSVBoundingBoxTree_h
+
+#include "vtkObject.h"
+#include "vtkSVCommonModule.h" // For export
+
+#include <vector>
+
+class VTKSVCOMMON_EXPORT vtkSVBoundingBoxTree : public vtkObject
+{
+public:
+  static vtkSVBoundingBoxTree *New();
+  vtkTypeMacro(vtkSVBoundingBoxTree,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  //@{
+  /// \brief Largest number of boxes in a leaf. Default is 4.
+  vtkSetClampMacro(MaximumBoxesPerLeaf, int, 1, VTK_INT_MAX);
+  vtkGetMacro(MaximumBoxesPerLeaf, int);
+  //@}
+
+  /// \brief Build the tree.
+  /// \param bounds Six values per box.
+  /// \param numberOfBoxes Number of boxes, ids in queries are indices
+  /// into this list.
+  void Build(const double *bounds, const vtkIdType numberOfBoxes);
+
+  /// \brief Keep the tree after the boxes were renumbered, with some boxes
+  /// removed and some added. The nodes of the kept boxes are reused and
+  /// refit to their new bounds, nodes left empty are dropped, and the added
+  /// boxes get a tree of their own joined to the old one at the root.
+  /// \param bounds Six values per box with the new numbering.
+  /// \param numberOfBoxes Number of boxes with the new numbering.
+  /// \param newIds New id of every box of the tree, -1 if it was removed.
+  /// Boxes that are not the new id of any old box are the added boxes.
+  void Update(const double *bounds, const vtkIdType numberOfBoxes,
+              const vtkIdType *newIds);
+
+  /// \brief Remove the tree.
+  void Initialize();
+
+  /// \brief Append the id of every box overlapping the given bounds.
+  /// Boxes only touching count as overlapping.
+  void FindOverlappingBoxes(const double bounds[6],
+                            std::vector<vtkIdType> &ids) const;
+
+  /// \brief Function giving the squared distance from a point to the object
+  /// in a box, used by FindClosestBox.
+  typedef double (*BoxDistance2Function)(const vtkIdType id, const double x[3],
+                                         void *data);
+
+  /// \brief Id of the box holding the object closest to the point, -1 if
+  /// the tree is empty. Boxes farther away than the closest object found so
+  /// far are skipped. dist2 is the squared distance to the closest object.
+  vtkIdType FindClosestBox(const double x[3], BoxDistance2Function distance2,
+                           void *data, double &dist2) const;
+
+  //@{
+  /// \brief Sizes of the tree.
+  int GetNumberOfNodes() const {return this->NodeCounts.size();}
+  vtkIdType GetNumberOfBoxes() const {return this->Items.size();}
+  //@}
+
+  /// \brief Bounds of all boxes, false if the tree is empty.
+  bool GetBounds(double bounds[6]) const;
+
+  /// \brief Squared distance from a point to bounds, zero inside.
+  static double Distance2ToBounds(const double x[3], const double bounds[6])
+  {
+    double dist2 = 0.0;
+    for (int i=0; i<3; i++)
+    {
+      double d = 0.0;
+      if (x[i] < bounds[2*i])
+        d = bounds[2*i] - x[i];
+      else if (x[i] > bounds[2*i+1])
+        d = x[i] - bounds[2*i+1];
+      dist2 += d*d;
+    }
+    return dist2;
+  }
+
+  /// \brief True if the two bounds overlap or touch.
+  static bool BoundsOverlap(const double a[6], const double b[6])
+  {
+    return a[0] <= b[1] && b[0] <= a[1] &&
+           a[2] <= b[3] && b[2] <= a[3] &&
+           a[4] <= b[5] && b[4] <= a[5];
+  }
+
+protected:
+  vtkSVBoundingBoxTree();
+  ~vtkSVBoundingBoxTree();
+
+  /// \brief Add a node with the bounds of items begin to end, returns its id.
+  int AddNode(const double *bounds, const vtkIdType begin, const vtkIdType end);
+
+  int MaximumBoxesPerLeaf;
+
+  //@{
+  /// \brief Six bounds per node. For leaves NodeStarts is the first item of
+  /// the leaf and NodeCounts the number of items. For inner nodes
+  /// NodeCounts is zero and NodeStarts is the first of the two children.
+  std::vector<double> NodeBounds;
+  std::vector<vtkIdType> NodeStarts;
+  std::vector<int> NodeCounts;
+  //@}
+
+  //@{
+  /// \brief Box ids ordered so that the boxes of each leaf are contiguous,
+  /// and the six bounds of each box in the same order.
+  std::vector<vtkIdType> Items;
+  std::vector<double> ItemBounds;
+  //@}
+
+private:
+  vtkSVBoundingBoxTree(const vtkSVBoundingBoxTree&);  // Not implemented.
+  void operator=(const vtkSVBoundingBoxTree&);  // Not implemented.
+};
+
+#endif  // vtkSVBoundingBoxTree_h
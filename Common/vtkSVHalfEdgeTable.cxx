@@ -0,0 +1,179 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVHalfEdgeTable.h"
+
+#include "vtkCellArray.h"
+#include "vtkObjectFactory.h"
+#include "vtkPolyData.h"
+
+// ----------------------
+// StandardNewMacro
+// ----------------------
+vtkStandardNewMacro(vtkSVHalfEdgeTable);
+
+// ----------------------
+// Constructor
+// ----------------------
+vtkSVHalfEdgeTable::vtkSVHalfEdgeTable()
+{
+}
+
+// ----------------------
+// Destructor
+// ----------------------
+vtkSVHalfEdgeTable::~vtkSVHalfEdgeTable()
+{
+}
+
+// ----------------------
+// PrintSelf
+// ----------------------
+void vtkSVHalfEdgeTable::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Number of cells: " << this->GetNumberOfCells() << "\n";
+  os << indent << "Number of edges: " << this->GetNumberOfEdges() << "\n";
+}
+
+// ----------------------
+// Reset
+// ----------------------
+void vtkSVHalfEdgeTable::Reset()
+{
+  this->Origins.clear();
+  this->Opposites.clear();
+  this->Edges.clear();
+  this->EdgeHalfEdges.clear();
+  this->EdgeNumberOfCells.clear();
+  this->PointOffsets.clear();
+  this->PointHalfEdges.clear();
+}
+
+// ----------------------
+// Build
+// ----------------------
+void vtkSVHalfEdgeTable::Build(vtkPolyData *pd)
+{
+  this->Reset();
+
+  vtkCellArray *polys = pd->GetPolys();
+  vtkIdType numCells = polys->GetNumberOfCells();
+  vtkIdType numPts   = pd->GetNumberOfPoints();
+
+  // Start points of the half-edges, -1 for cells that are not triangles
+  this->Origins.assign(3*numCells, -1);
+  vtkIdType npts, *pts, cellId;
+  for (cellId=0, polys->InitTraversal(); polys->GetNextCell(npts, pts); cellId++)
+  {
+    if (npts != 3)
+      continue;
+    this->Origins[3*cellId]   = pts[2];
+    this->Origins[3*cellId+1] = pts[0];
+    this->Origins[3*cellId+2] = pts[1];
+  }
+
+  // Half-edges starting at each point, stored by point
+  this->PointOffsets.assign(numPts+1, 0);
+  for (vtkIdType i=0; i<3*numCells; i++)
+  {
+    if (this->Origins[i] >= 0)
+      this->PointOffsets[this->Origins[i]+1]++;
+  }
+  for (vtkIdType i=0; i<numPts; i++)
+    this->PointOffsets[i+1] += this->PointOffsets[i];
+
+  this->PointHalfEdges.resize(this->PointOffsets[numPts]);
+  std::vector<vtkIdType> fill(this->PointOffsets.begin(), this->PointOffsets.end()-1);
+  for (vtkIdType i=0; i<3*numCells; i++)
+  {
+    if (this->Origins[i] >= 0)
+      this->PointHalfEdges[fill[this->Origins[i]]++] = i;
+  }
+
+  // Give every edge an id. The half-edges of an edge start at one of its
+  // two points, so only the stars of the two points are searched.
+  this->Opposites.assign(3*numCells, -1);
+  this->Edges.assign(3*numCells, -1);
+  std::vector<vtkIdType> matches;
+  for (vtkIdType i=0; i<3*numCells; i++)
+  {
+    if (this->Origins[i] < 0 || this->Edges[i] != -1)
+      continue;
+
+    vtkIdType p0 = this->GetOrigin(i);
+    vtkIdType p1 = this->GetTarget(i);
+    matches.clear();
+    for (int side=0; side<2; side++)
+    {
+      vtkIdType ptId  = side == 0 ? p0 : p1;
+      vtkIdType other = side == 0 ? p1 : p0;
+      for (vtkIdType j=this->PointOffsets[ptId]; j<this->PointOffsets[ptId+1]; j++)
+      {
+        vtkIdType halfEdge = this->PointHalfEdges[j];
+        if (halfEdge != i && this->GetTarget(halfEdge) == other)
+          matches.push_back(halfEdge);
+      }
+    }
+
+    vtkIdType edgeId = this->EdgeHalfEdges.size();
+    this->EdgeHalfEdges.push_back(i);
+    this->EdgeNumberOfCells.push_back(1 + matches.size());
+    this->Edges[i] = edgeId;
+    for (size_t j=0; j<matches.size(); j++)
+      this->Edges[matches[j]] = edgeId;
+
+    if (matches.size() == 1)
+    {
+      this->Opposites[i] = matches[0];
+      this->Opposites[matches[0]] = i;
+    }
+  }
+}
+
+// ----------------------
+// FindHalfEdge
+// ----------------------
+vtkIdType vtkSVHalfEdgeTable::FindHalfEdge(const vtkIdType cellId,
+                                           const vtkIdType p0,
+                                           const vtkIdType p1) const
+{
+  for (int k=0; k<3; k++)
+  {
+    vtkIdType halfEdge = 3*cellId + k;
+    vtkIdType origin = this->GetOrigin(halfEdge);
+    vtkIdType target = this->GetTarget(halfEdge);
+    if ((origin == p0 && target == p1) || (origin == p1 && target == p0))
+      return halfEdge;
+  }
+  return -1;
+}
@@ -0,0 +1,154 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class  vtkSVHalfEdgeTable
+ *  \brief Half-edges and edge ids of the triangles of a vtkPolyData.
+ *
+ *  Triangle cellId has the half-edges 3*cellId, 3*cellId+1 and 3*cellId+2.
+ *  Half-edge k of a triangle with points (p0, p1, p2) goes from the point
+ *  before pk to pk, so the half-edges are (p2, p0), (p0, p1) and (p1, p2),
+ *  which is the edge order used by the subdivision filters. Every edge of
+ *  the mesh gets an id, and the half-edges of the two triangles of a
+ *  manifold edge are each other's opposite, regardless of the orientation
+ *  of the triangles. Polygons that are not triangles have no half-edges.
+ *
+ *  The table is built once from the cell array and answers edge, neighbor
+ *  and point star queries without going through the links of the mesh.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVHalfEdgeTable_h
+#define vtkSVHalfEdgeTable_h
+
+#include "vtkObject.h"
+#include "vtkSVCommonModule.h" // For export
+
+#include <vector>
+
+class vtkPolyData;
+
+class VTKSVCOMMON_EXPORT vtkSVHalfEdgeTable : public vtkObject
+{
+public:
+  static vtkSVHalfEdgeTable *New();
+  vtkTypeMacro(vtkSVHalfEdgeTable,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// \brief Build the table from the polys of pd. The ids of the cells are
+  /// the ids of the polys in the order of the cell array.
+  void Build(vtkPolyData *pd);
+
+  /// \brief Empty the table.
+  void Reset();
+
+  //@{
+  /// \brief Size of the table.
+  vtkIdType GetNumberOfCells() const {return this->Origins.size()/3;}
+  vtkIdType GetNumberOfEdges() const {return this->EdgeHalfEdges.size();}
+  //@}
+
+  //@{
+  /// \brief Half-edge k of a triangle and the triangle of a half-edge.
+  static vtkIdType GetHalfEdge(const vtkIdType cellId, const int k) {return 3*cellId + k;}
+  static vtkIdType GetCell(const vtkIdType halfEdge) {return halfEdge/3;}
+  static vtkIdType GetNext(const vtkIdType halfEdge) {return halfEdge%3 == 2 ? halfEdge - 2 : halfEdge + 1;}
+  static vtkIdType GetPrevious(const vtkIdType halfEdge) {return halfEdge%3 == 0 ? halfEdge + 2 : halfEdge - 1;}
+  //@}
+
+  //@{
+  /// \brief Start, end and the third point of the triangle of a half-edge.
+  /// -1 if the cell is not a triangle.
+  vtkIdType GetOrigin(const vtkIdType halfEdge) const {return this->Origins[halfEdge];}
+  vtkIdType GetTarget(const vtkIdType halfEdge) const {return this->Origins[GetNext(halfEdge)];}
+  vtkIdType GetApex(const vtkIdType halfEdge) const {return this->Origins[GetPrevious(halfEdge)];}
+  //@}
+
+  /// \brief Half-edge of the other triangle of a manifold edge, -1 for
+  /// boundary and non-manifold edges.
+  vtkIdType GetOpposite(const vtkIdType halfEdge) const {return this->Opposites[halfEdge];}
+
+  /// \brief Triangle on the other side of a half-edge, -1 if there is none.
+  vtkIdType GetNeighbor(const vtkIdType halfEdge) const
+  {
+    return this->Opposites[halfEdge] < 0 ? -1 : this->Opposites[halfEdge]/3;
+  }
+
+  /// \brief Id of the edge of a half-edge, -1 if the cell is not a triangle.
+  vtkIdType GetEdge(const vtkIdType halfEdge) const {return this->Edges[halfEdge];}
+
+  /// \brief Half-edge of a triangle between the points p0 and p1 in either
+  /// direction, -1 if the triangle has no such edge.
+  vtkIdType FindHalfEdge(const vtkIdType cellId, const vtkIdType p0,
+                         const vtkIdType p1) const;
+
+  //@{
+  /// \brief Edge queries. The half-edge of an edge is the first one found
+  /// in the order of the cells.
+  vtkIdType GetEdgeHalfEdge(const vtkIdType edgeId) const {return this->EdgeHalfEdges[edgeId];}
+  int GetEdgeNumberOfCells(const vtkIdType edgeId) const {return this->EdgeNumberOfCells[edgeId];}
+  //@}
+
+  //@{
+  /// \brief Half-edges starting at a point, one for every triangle using the
+  /// point, in order of cell id.
+  vtkIdType GetPointNumberOfCells(const vtkIdType ptId) const
+  {
+    return this->PointOffsets[ptId+1] - this->PointOffsets[ptId];
+  }
+  const vtkIdType *GetPointHalfEdges(const vtkIdType ptId) const
+  {
+    return this->PointHalfEdges.empty() ? NULL : &this->PointHalfEdges[this->PointOffsets[ptId]];
+  }
+  //@}
+
+protected:
+  vtkSVHalfEdgeTable();
+  ~vtkSVHalfEdgeTable();
+
+  std::vector<vtkIdType> Origins;           // start point of each half-edge
+  std::vector<vtkIdType> Opposites;         // opposite half-edge or -1
+  std::vector<vtkIdType> Edges;             // edge id of each half-edge
+  std::vector<vtkIdType> EdgeHalfEdges;     // first half-edge of each edge
+  std::vector<int>       EdgeNumberOfCells; // triangles using each edge
+  std::vector<vtkIdType> PointOffsets;      // start of each point in PointHalfEdges
+  std::vector<vtkIdType> PointHalfEdges;    // half-edges starting at each point
+
+private:
+  vtkSVHalfEdgeTable(const vtkSVHalfEdgeTable&);  // Not implemented.
+  void operator=(const vtkSVHalfEdgeTable&);  // Not implemented.
+};
+
+#endif  // vtkSVHalfEdgeTable_h
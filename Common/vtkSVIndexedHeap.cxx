@@ -0,0 +1,259 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVIndexedHeap.h"
+
+#include "vtkObjectFactory.h"
+
+namespace
+{
+// Number of children of each node
+const vtkIdType HeapArity = 4;
+}
+
+// ----------------------
+// StandardNewMacro
+// ----------------------
+vtkStandardNewMacro(vtkSVIndexedHeap);
+
+// ----------------------
+// Constructor
+// ----------------------
+vtkSVIndexedHeap::vtkSVIndexedHeap()
+{
+}
+
+// ----------------------
+// Destructor
+// ----------------------
+vtkSVIndexedHeap::~vtkSVIndexedHeap()
+{
+}
+
+// ----------------------
+// PrintSelf
+// ----------------------
+void vtkSVIndexedHeap::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Number of items: " << this->Items.size() << "\n";
+}
+
+// ----------------------
+// Allocate
+// ----------------------
+void vtkSVIndexedHeap::Allocate(const vtkIdType numIds)
+{
+  this->Items.clear();
+  this->Items.reserve(numIds);
+  this->Positions.assign(numIds, -1);
+}
+
+// ----------------------
+// Reset
+// ----------------------
+void vtkSVIndexedHeap::Reset()
+{
+  for (size_t i=0; i<this->Items.size(); i++)
+  {
+    this->Positions[this->Items[i].Id] = -1;
+  }
+  this->Items.clear();
+}
+
+// ----------------------
+// Insert
+// ----------------------
+void vtkSVIndexedHeap::Insert(const double key, const vtkIdType id)
+{
+  if (id >= static_cast<vtkIdType>(this->Positions.size()))
+  {
+    this->Positions.resize(id+1, -1);
+  }
+
+  vtkIdType pos = this->Positions[id];
+  if (pos >= 0)
+  {
+    // Change the key and move the item whichever way it now has to go
+    double oldKey = this->Items[pos].Key;
+    this->Items[pos].Key = key;
+    if (key < oldKey)
+    {
+      this->SiftUp(pos);
+    }
+    else
+    {
+      this->SiftDown(pos);
+    }
+    return;
+  }
+
+  HeapItem item;
+  item.Key = key;
+  item.Id  = id;
+  this->Items.push_back(item);
+  pos = this->Items.size() - 1;
+  this->Positions[id] = pos;
+  this->SiftUp(pos);
+}
+
+// ----------------------
+// DeleteId
+// ----------------------
+void vtkSVIndexedHeap::DeleteId(const vtkIdType id)
+{
+  if (!this->IsId(id))
+  {
+    return;
+  }
+
+  // Put the last item in the hole, it can belong above or below it
+  vtkIdType pos = this->Positions[id];
+  this->Positions[id] = -1;
+  HeapItem last = this->Items.back();
+  this->Items.pop_back();
+  if (pos == static_cast<vtkIdType>(this->Items.size()))
+  {
+    return;
+  }
+  this->Items[pos] = last;
+  this->Positions[last.Id] = pos;
+  this->SiftUp(pos);
+  this->SiftDown(this->Positions[last.Id]);
+}
+
+// ----------------------
+// Pop
+// ----------------------
+vtkIdType vtkSVIndexedHeap::Pop(double &key)
+{
+  vtkIdType id = this->Peek(key);
+  if (id >= 0)
+  {
+    this->DeleteId(id);
+  }
+  return id;
+}
+
+// ----------------------
+// Peek
+// ----------------------
+vtkIdType vtkSVIndexedHeap::Peek(double &key) const
+{
+  if (this->Items.empty())
+  {
+    key = VTK_DOUBLE_MAX;
+    return -1;
+  }
+  key = this->Items[0].Key;
+  return this->Items[0].Id;
+}
+
+// ----------------------
+// IsId
+// ----------------------
+int vtkSVIndexedHeap::IsId(const vtkIdType id) const
+{
+  return id >= 0 && id < static_cast<vtkIdType>(this->Positions.size()) &&
+         this->Positions[id] >= 0;
+}
+
+// ----------------------
+// GetKey
+// ----------------------
+double vtkSVIndexedHeap::GetKey(const vtkIdType id) const
+{
+  if (!this->IsId(id))
+  {
+    return VTK_DOUBLE_MAX;
+  }
+  return this->Items[this->Positions[id]].Key;
+}
+
+// ----------------------
+// SiftUp
+// ----------------------
+void vtkSVIndexedHeap::SiftUp(vtkIdType pos)
+{
+  HeapItem item = this->Items[pos];
+  while (pos > 0)
+  {
+    vtkIdType parent = (pos - 1) / HeapArity;
+    if (!Less(item, this->Items[parent]))
+    {
+      break;
+    }
+    this->Items[pos] = this->Items[parent];
+    this->Positions[this->Items[pos].Id] = pos;
+    pos = parent;
+  }
+  this->Items[pos] = item;
+  this->Positions[item.Id] = pos;
+}
+
+// ----------------------
+// SiftDown
+// ----------------------
+void vtkSVIndexedHeap::SiftDown(vtkIdType pos)
+{
+  vtkIdType numItems = this->Items.size();
+  HeapItem item = this->Items[pos];
+  while (true)
+  {
+    vtkIdType first = HeapArity*pos + 1;
+    if (first >= numItems)
+    {
+      break;
+    }
+
+    // Smallest of the children
+    vtkIdType last = first + HeapArity < numItems ? first + HeapArity : numItems;
+    vtkIdType child = first;
+    for (vtkIdType c=first+1; c<last; c++)
+    {
+      if (Less(this->Items[c], this->Items[child]))
+      {
+        child = c;
+      }
+    }
+
+    if (!Less(this->Items[child], item))
+    {
+      break;
+    }
+    this->Items[pos] = this->Items[child];
+    this->Positions[this->Items[pos].Id] = pos;
+    pos = child;
+  }
+  this->Items[pos] = item;
+  this->Positions[item.Id] = pos;
+}
@@ -0,0 +1,124 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class  vtkSVIndexedHeap
+ *  \brief Min heap of ids with a key each, where the key of an id in the
+ *  heap can be changed in place.
+ *
+ *  Every id has its position in the heap stored, so DeleteId and changing
+ *  the key of an id are O(log n) without searching, and an id is never in
+ *  the heap twice. The heap has four children per node, which keeps it
+ *  shallow and the children of a node next to each other in memory. Equal
+ *  keys are popped in order of id.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVIndexedHeap_h
+#define vtkSVIndexedHeap_h
+
+#include "vtkObject.h"
+#include "vtkSVCommonModule.h" // For export
+
+#include <vector>
+
+class VTKSVCOMMON_EXPORT vtkSVIndexedHeap : public vtkObject
+{
+public:
+  static vtkSVIndexedHeap *New();
+  vtkTypeMacro(vtkSVIndexedHeap,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// \brief Empty the heap and reserve space for ids 0 to numIds-1. Larger
+  /// ids can still be inserted.
+  void Allocate(const vtkIdType numIds);
+
+  /// \brief Empty the heap.
+  void Reset();
+
+  /// \brief Insert an id with a key. If the id is already in the heap, its
+  /// key is changed instead.
+  void Insert(const double key, const vtkIdType id);
+
+  /// \brief Remove an id from the heap, nothing is done if it is not in it.
+  void DeleteId(const vtkIdType id);
+
+  /// \brief Remove and return the id with the smallest key, -1 if the heap
+  /// is empty. The key is returned in key.
+  vtkIdType Pop(double &key);
+
+  /// \brief Return the id with the smallest key without removing it, -1 if
+  /// the heap is empty.
+  vtkIdType Peek(double &key) const;
+
+  /// \brief Return 1 if the id is in the heap.
+  int IsId(const vtkIdType id) const;
+
+  /// \brief Key of an id, VTK_DOUBLE_MAX if it is not in the heap.
+  double GetKey(const vtkIdType id) const;
+
+  /// \brief Number of ids in the heap.
+  vtkIdType GetNumberOfItems() const {return this->Items.size();}
+
+protected:
+  vtkSVIndexedHeap();
+  ~vtkSVIndexedHeap();
+
+  struct HeapItem
+  {
+    double Key;
+    vtkIdType Id;
+  };
+
+  /// \brief Move the item at pos towards the root or the leaves until the
+  /// heap is ordered again.
+  void SiftUp(vtkIdType pos);
+  void SiftDown(vtkIdType pos);
+
+  /// \brief Ordering of two items, by key then id.
+  static bool Less(const HeapItem &a, const HeapItem &b)
+  {
+    return a.Key < b.Key || (a.Key == b.Key && a.Id < b.Id);
+  }
+
+  std::vector<HeapItem> Items;      // heap ordered items
+  std::vector<vtkIdType> Positions; // position of each id in Items or -1
+
+private:
+  vtkSVIndexedHeap(const vtkSVIndexedHeap&);  // Not implemented.
+  void operator=(const vtkSVIndexedHeap&);  // Not implemented.
+};
+
+#endif  // vtkSVIndexedHeap_h
@@ -0,0 +1,296 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class  vtkSVQuadricKernels
+ *  \brief Small dense kernels for the quadric error metrics of the
+ *  decimation.
+ *
+ *  The cost of an edge collapse adds two packed quadrics, solves a small
+ *  symmetric system for the new point and evaluates the quadric there. The
+ *  system has 3 + number of attribute components unknowns and is positive
+ *  semi-definite, so it is solved with an LDL^T factorization without
+ *  pivoting. The size is a template parameter so that the loops of the
+ *  common sizes are unrolled by the compiler; a size of 0 selects the
+ *  run time size. The add and evaluate kernels work on raw pointers with
+ *  unit stride so that they can be vectorized.
+ *
+ *  A packed quadric holds the upper triangle of the 4x4 geometric quadric
+ *  in its first 10 values, the attribute weight (area) in value 10 and four
+ *  values per attribute component after that: the gradient of the
+ *  component followed by its offset.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVQuadricKernels_h
+#define vtkSVQuadricKernels_h
+
+#include "vtkType.h"
+
+#include <cmath>
+
+class vtkSVQuadricKernels
+{
+public:
+  /// \brief Largest system size with an unrolled solver in SymmetricSolve.
+  enum { MAX_FIXED_SIZE = 9 };
+
+  /** \brief Number of values in a packed quadric.
+   *  \param numComps number of attribute components. */
+  static int GetQuadricSize(const int numComps) {return 11 + 4*numComps;}
+
+  /** \brief c = a + b for two packed quadrics. c may be the same as a or b.
+   *  \param size number of values, see GetQuadricSize. */
+  static void Add(const double *a, const double *b, double *c, const int size)
+  {
+    for (int i=0; i<size; i++)
+      c[i] = a[i] + b[i];
+  }
+
+  /** \brief Value of the geometric part of a packed quadric at the point x,
+   *  that is [x 1]^T Q [x 1]. */
+  static double Evaluate(const double *quad, const double x[3])
+  {
+    return quad[0]*x[0]*x[0] + quad[4]*x[1]*x[1] + quad[7]*x[2]*x[2] +
+           2.0*(quad[1]*x[0]*x[1] + quad[2]*x[0]*x[2] + quad[5]*x[1]*x[2]) +
+           2.0*(quad[3]*x[0] + quad[6]*x[1] + quad[8]*x[2]) + quad[9];
+  }
+
+  /** \brief Value of a packed quadric with attributes at x. The first three
+   *  values of x are the position, the next numComps values the attribute
+   *  components. Same as x^T A x - 2 b^T x + c with A and b from
+   *  AssembleSystem, without building the dense matrix. */
+  static double Evaluate(const double *quad, const double *x, const int numComps)
+  {
+    double cost = vtkSVQuadricKernels::Evaluate(quad, x);
+    const double *s    = x + 3;
+    const double *grad = quad + 11;
+    for (int i=0; i<numComps; i++, grad += 4)
+    {
+      cost += s[i]*(2.0*(grad[0]*x[0] + grad[1]*x[1] + grad[2]*x[2] + grad[3]) +
+                    quad[10]*s[i]);
+    }
+    return cost;
+  }
+
+  /** \brief Build the dense symmetric system A x = b of a packed quadric.
+   *  \param a row major (3 + numComps)^2 matrix, both triangles are filled.
+   *  \param b right hand side with 3 + numComps values. */
+  static void AssembleSystem(const double *quad, const int numComps, double *a,
+                             double *b)
+  {
+    const int n = 3 + numComps;
+    for (int i=0; i<n*n; i++)
+      a[i] = 0.0;
+
+    a[0]       = quad[0];
+    a[1]       = a[n]       = quad[1];
+    a[2]       = a[2*n]     = quad[2];
+    a[n+1]     = quad[4];
+    a[n+2]     = a[2*n+1]   = quad[5];
+    a[2*n+2]   = quad[7];
+
+    b[0] = -quad[3];
+    b[1] = -quad[6];
+    b[2] = -quad[8];
+
+    const double *grad = quad + 11;
+    for (int i=3; i<n; i++, grad += 4)
+    {
+      a[i]     = a[i*n]     = grad[0];
+      a[n+i]   = a[i*n+1]   = grad[1];
+      a[2*n+i] = a[i*n+2]   = grad[2];
+      a[i*n+i] = quad[10];
+      b[i]     = -grad[3];
+    }
+  }
+
+  /** \brief Factor a symmetric positive semi-definite matrix as L D L^T in
+   *  place. Only the lower triangle is read. On return the strict lower
+   *  triangle holds L and the diagonal holds D.
+   *  \param N compile time size, or 0 to use size.
+   *  \param a row major matrix.
+   *  \param size size of the matrix when N is 0.
+   *  \param tolerance a pivot smaller than tolerance times the largest
+   *  diagonal value is taken as singular.
+   *  \return 1 on success, 0 if the matrix is singular. */
+  template <int N>
+  static int LDLTFactor(double *a, const int size, const double tolerance)
+  {
+    const int n = N > 0 ? N : size;
+
+    double scale = 0.0;
+    for (int i=0; i<n; i++)
+      scale = std::fabs(a[i*n+i]) > scale ? std::fabs(a[i*n+i]) : scale;
+    if (scale == 0.0)
+      return 0;
+
+    for (int j=0; j<n; j++)
+    {
+      double *rowJ = a + j*n;
+      double d = rowJ[j];
+      for (int k=0; k<j; k++)
+        d -= rowJ[k]*rowJ[k]*a[k*n+k];
+      if (d <= tolerance*scale)
+        return 0;
+      rowJ[j] = d;
+
+      for (int i=j+1; i<n; i++)
+      {
+        double *rowI = a + i*n;
+        double val = rowI[j];
+        for (int k=0; k<j; k++)
+          val -= rowI[k]*rowJ[k]*a[k*n+k];
+        rowI[j] = val/d;
+      }
+    }
+    return 1;
+  }
+
+  /** \brief Solve with a matrix factored by LDLTFactor.
+   *  \param x right hand side on input, solution on return. */
+  template <int N>
+  static void LDLTSolve(const double *a, const int size, double *x)
+  {
+    const int n = N > 0 ? N : size;
+
+    for (int i=1; i<n; i++)
+    {
+      const double *rowI = a + i*n;
+      for (int k=0; k<i; k++)
+        x[i] -= rowI[k]*x[k];
+    }
+    for (int i=0; i<n; i++)
+      x[i] /= a[i*n+i];
+    for (int i=n-2; i>=0; i--)
+    {
+      for (int k=i+1; k<n; k++)
+        x[i] -= a[k*n+i]*x[k];
+    }
+  }
+
+  /** \brief Factor and solve a symmetric positive semi-definite system,
+   *  using the unrolled kernels up to MAX_FIXED_SIZE.
+   *  \param a row major matrix, overwritten by its factorization.
+   *  \param x right hand side on input, solution on return.
+   *  \return 1 on success, 0 if the matrix is singular; x is then left
+   *  unchanged. */
+  static int SymmetricSolve(double *a, const int n, double *x,
+                            const double tolerance)
+  {
+    switch (n)
+    {
+      case 3: return vtkSVQuadricKernels::FactorAndSolve<3>(a, n, x, tolerance);
+      case 4: return vtkSVQuadricKernels::FactorAndSolve<4>(a, n, x, tolerance);
+      case 5: return vtkSVQuadricKernels::FactorAndSolve<5>(a, n, x, tolerance);
+      case 6: return vtkSVQuadricKernels::FactorAndSolve<6>(a, n, x, tolerance);
+      case 7: return vtkSVQuadricKernels::FactorAndSolve<7>(a, n, x, tolerance);
+      case 8: return vtkSVQuadricKernels::FactorAndSolve<8>(a, n, x, tolerance);
+      case 9: return vtkSVQuadricKernels::FactorAndSolve<9>(a, n, x, tolerance);
+      default: return vtkSVQuadricKernels::FactorAndSolve<0>(a, n, x, tolerance);
+    }
+  }
+
+  /** \brief LU factorization with partial pivoting of a general 4x4 matrix in
+   *  place, for the attribute gradients of a triangle.
+   *  \param index row permutation for LUSolve4x4.
+   *  \return 1 on success, 0 if the matrix is singular. */
+  static int LUFactor4x4(double a[4][4], int index[4])
+  {
+    for (int j=0; j<4; j++)
+    {
+      int pivot = j;
+      for (int i=j+1; i<4; i++)
+      {
+        if (std::fabs(a[i][j]) > std::fabs(a[pivot][j]))
+          pivot = i;
+      }
+      if (std::fabs(a[pivot][j]) <= 1.0e-12)
+        return 0;
+      index[j] = pivot;
+      if (pivot != j)
+      {
+        for (int k=0; k<4; k++)
+        {
+          double tmp = a[j][k];
+          a[j][k] = a[pivot][k];
+          a[pivot][k] = tmp;
+        }
+      }
+
+      double inv = 1.0/a[j][j];
+      for (int i=j+1; i<4; i++)
+      {
+        a[i][j] *= inv;
+        for (int k=j+1; k<4; k++)
+          a[i][k] -= a[i][j]*a[j][k];
+      }
+    }
+    return 1;
+  }
+
+  /** \brief Solve with a matrix factored by LUFactor4x4.
+   *  \param x right hand side on input, solution on return. */
+  static void LUSolve4x4(const double a[4][4], const int index[4], double x[4])
+  {
+    for (int i=0; i<4; i++)
+    {
+      double tmp = x[index[i]];
+      x[index[i]] = x[i];
+      x[i] = tmp;
+      for (int k=0; k<i; k++)
+        x[i] -= a[i][k]*x[k];
+    }
+    for (int i=3; i>=0; i--)
+    {
+      for (int k=i+1; k<4; k++)
+        x[i] -= a[i][k]*x[k];
+      x[i] /= a[i][i];
+    }
+  }
+
+private:
+  template <int N>
+  static int FactorAndSolve(double *a, const int n, double *x,
+                            const double tolerance)
+  {
+    if (!vtkSVQuadricKernels::LDLTFactor<N>(a, n, tolerance))
+      return 0;
+    vtkSVQuadricKernels::LDLTSolve<N>(a, n, x);
+    return 1;
+  }
+};
+
+#endif  // vtkSVQuadricKernels_h
@@ -0,0 +1,369 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVSparseCholesky.h"
+
+#include "vtkObjectFactory.h"
+#include "vtkSVGlobals.h"
+
+namespace
+{
+// Subsets of rows at most this large are not dissected further
+const int DissectionLeafSize = 64;
+
+// ----------------------
+// BreadthFirstLevels
+// ----------------------
+/* Visits the rows of the subset marked with level -2 that are connected to
+ * start and sets their level to the distance from start. The rows are
+ * appended to order in the order they are visited. */
+void BreadthFirstLevels(const std::vector<int> &rowOffsets,
+                        const std::vector<int> &columns, const int start,
+                        std::vector<int> &level, std::vector<int> &order)
+{
+  order.clear();
+  order.push_back(start);
+  level[start] = 0;
+  for (size_t head=0; head<order.size(); head++)
+  {
+    int row = order[head];
+    for (int p=rowOffsets[row]; p<rowOffsets[row+1]; p++)
+    {
+      int col = columns[p];
+      if (level[col] == -2)
+      {
+        level[col] = level[row] + 1;
+        order.push_back(col);
+      }
+    }
+  }
+}
+}
+
+// ----------------------
+// StandardNewMacro
+// ----------------------
+vtkStandardNewMacro(vtkSVSparseCholesky);
+
+// ----------------------
+// Constructor
+// ----------------------
+vtkSVSparseCholesky::vtkSVSparseCholesky()
+{
+  this->NumberOfRows = 0;
+  this->Factored     = 0;
+}
+
+// ----------------------
+// Destructor
+// ----------------------
+vtkSVSparseCholesky::~vtkSVSparseCholesky()
+{
+}
+
+// ----------------------
+// PrintSelf
+// ----------------------
+void vtkSVSparseCholesky::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Number of rows: " << this->NumberOfRows << "\n";
+  os << indent << "Number of matrix elements: " << this->Columns.size() << "\n";
+  os << indent << "Number of factor elements: " << this->GetNumberOfFactorElements() << "\n";
+  os << indent << "Factored: " << this->Factored << "\n";
+}
+
+// ----------------------
+// Dissect
+// ----------------------
+void vtkSVSparseCholesky::Dissect(std::vector<int> &nodes, std::vector<int> &level)
+{
+  if (static_cast<int>(nodes.size()) <= DissectionLeafSize)
+  {
+    this->Permutation.insert(this->Permutation.end(), nodes.begin(), nodes.end());
+    return;
+  }
+
+  // Start from a row far from the first one, which is near the end of a
+  // long path through the subset
+  std::vector<int> order;
+  for (size_t i=0; i<nodes.size(); i++)
+    level[nodes[i]] = -2;
+  int start = nodes[0];
+  for (int pass=0; pass<2; pass++)
+  {
+    BreadthFirstLevels(this->RowOffsets, this->Columns, start, level, order);
+    start = order.back();
+    for (size_t i=0; i<order.size(); i++)
+      level[order[i]] = -2;
+  }
+  BreadthFirstLevels(this->RowOffsets, this->Columns, start, level, order);
+
+  if (order.size() < nodes.size())
+  {
+    // More than one component. All of them are found here and dissected in
+    // a loop, so the depth of the recursion does not grow with their number
+    std::vector<int> components(order);
+    std::vector<size_t> offsets(1, 0);
+    offsets.push_back(components.size());
+    for (size_t i=0; i<nodes.size(); i++)
+    {
+      if (level[nodes[i]] == -2)
+      {
+        BreadthFirstLevels(this->RowOffsets, this->Columns, nodes[i], level, order);
+        components.insert(components.end(), order.begin(), order.end());
+        offsets.push_back(components.size());
+      }
+    }
+    for (size_t i=0; i<nodes.size(); i++)
+      level[nodes[i]] = -1;
+
+    std::vector<int>().swap(nodes);
+    std::vector<int>().swap(order);
+    for (size_t c=0; c+1<offsets.size(); c++)
+    {
+      std::vector<int> component(components.begin()+offsets[c],
+                                 components.begin()+offsets[c+1]);
+      this->Dissect(component, level);
+    }
+    return;
+  }
+
+  int numLevels = level[order.back()] + 1;
+  if (numLevels < 3)
+  {
+    for (size_t i=0; i<nodes.size(); i++)
+      level[nodes[i]] = -1;
+    this->Permutation.insert(this->Permutation.end(), nodes.begin(), nodes.end());
+    return;
+  }
+
+  // The level holding the middle row separates the rows before and after
+  int split = level[order[order.size()/2]];
+  split = svmaximum(1, svminimum(split, numLevels-2));
+  std::vector<int> first, second, separator;
+  for (size_t i=0; i<order.size(); i++)
+  {
+    if (level[order[i]] < split)
+      first.push_back(order[i]);
+    else if (level[order[i]] == split)
+      separator.push_back(order[i]);
+    else
+      second.push_back(order[i]);
+  }
+  for (size_t i=0; i<nodes.size(); i++)
+    level[nodes[i]] = -1;
+
+  std::vector<int>().swap(nodes);
+  std::vector<int>().swap(order);
+  this->Dissect(first, level);
+  this->Dissect(second, level);
+  this->Permutation.insert(this->Permutation.end(), separator.begin(), separator.end());
+}
+
+// ----------------------
+// Analyze
+// ----------------------
+int vtkSVSparseCholesky::Analyze(const int numRows, const std::vector<int> &rowOffsets,
+                                 const std::vector<int> &columns)
+{
+  this->Factored = 0;
+  this->NumberOfRows = numRows;
+  if (numRows < 0 || static_cast<int>(rowOffsets.size()) != numRows+1 ||
+      rowOffsets[numRows] != static_cast<int>(columns.size()))
+  {
+    vtkErrorMacro("Row offsets do not match the number of rows and columns");
+    return SV_ERROR;
+  }
+  for (int i=0; i<numRows; i++)
+  {
+    int hasDiagonal = 0;
+    for (int p=rowOffsets[i]; p<rowOffsets[i+1]; p++)
+    {
+      if (columns[p] < 0 || columns[p] >= numRows)
+      {
+        vtkErrorMacro("Column " << columns[p] << " of row " << i << " is out of range");
+        return SV_ERROR;
+      }
+      if (columns[p] == i)
+        hasDiagonal = 1;
+    }
+    if (!hasDiagonal)
+    {
+      vtkErrorMacro("Row " << i << " has no diagonal");
+      return SV_ERROR;
+    }
+  }
+  this->RowOffsets = rowOffsets;
+  this->Columns    = columns;
+
+  // Fill reducing order
+  this->Permutation.clear();
+  this->Permutation.reserve(numRows);
+  std::vector<int> level(numRows, -1);
+  std::vector<int> nodes(numRows);
+  for (int i=0; i<numRows; i++)
+    nodes[i] = i;
+  this->Dissect(nodes, level);
+  this->InversePermutation.resize(numRows);
+  for (int k=0; k<numRows; k++)
+    this->InversePermutation[this->Permutation[k]] = k;
+
+  // Elimination tree and column counts of the factor, from the rows of the
+  // matrix above the diagonal in the new order
+  this->Parent.assign(numRows, -1);
+  std::vector<int> flag(numRows);
+  std::vector<int> counts(numRows, 0);
+  for (int k=0; k<numRows; k++)
+  {
+    flag[k] = k;
+    int row = this->Permutation[k];
+    for (int p=rowOffsets[row]; p<rowOffsets[row+1]; p++)
+    {
+      int i = this->InversePermutation[columns[p]];
+      for (; i < k && flag[i] != k; i = this->Parent[i])
+      {
+        if (this->Parent[i] == -1)
+          this->Parent[i] = k;
+        counts[i]++;
+        flag[i] = k;
+      }
+    }
+  }
+  this->FactorOffsets.resize(numRows+1);
+  this->FactorOffsets[0] = 0;
+  for (int k=0; k<numRows; k++)
+    this->FactorOffsets[k+1] = this->FactorOffsets[k] + counts[k];
+  this->FactorRows.resize(this->FactorOffsets[numRows]);
+  this->FactorValues.resize(this->FactorOffsets[numRows]);
+  this->Diagonal.resize(numRows);
+
+  return SV_OK;
+}
+
+// ----------------------
+// Factorize
+// ----------------------
+int vtkSVSparseCholesky::Factorize(const double *values)
+{
+  this->Factored = 0;
+  int numRows = this->NumberOfRows;
+  if (static_cast<int>(this->FactorOffsets.size()) != numRows+1)
+  {
+    vtkErrorMacro("Analyze must be called before Factorize");
+    return SV_ERROR;
+  }
+
+  // Up looking factorization, row k of the factor is found by a sparse
+  // triangular solve whose pattern is the path up the elimination tree
+  std::vector<double> y(numRows, 0.0);
+  std::vector<int> flag(numRows);
+  std::vector<int> pattern(numRows);
+  std::vector<int> counts(numRows, 0);
+  for (int k=0; k<numRows; k++)
+  {
+    int top = numRows;
+    flag[k] = k;
+    int row = this->Permutation[k];
+    for (int p=this->RowOffsets[row]; p<this->RowOffsets[row+1]; p++)
+    {
+      int i = this->InversePermutation[this->Columns[p]];
+      if (i > k)
+        continue;
+      y[i] += values[p];
+      int len = 0;
+      for (; flag[i] != k; i = this->Parent[i])
+      {
+        pattern[len++] = i;
+        flag[i] = k;
+      }
+      while (len > 0)
+        pattern[--top] = pattern[--len];
+    }
+
+    double diagonal = y[k];
+    y[k] = 0.0;
+    for (; top < numRows; top++)
+    {
+      int i = pattern[top];
+      double yi = y[i];
+      y[i] = 0.0;
+      int end = this->FactorOffsets[i] + counts[i];
+      for (int p=this->FactorOffsets[i]; p<end; p++)
+        y[this->FactorRows[p]] -= this->FactorValues[p] * yi;
+      double lki = yi / this->Diagonal[i];
+      diagonal -= lki * yi;
+      this->FactorRows[end] = k;
+      this->FactorValues[end] = lki;
+      counts[i]++;
+    }
+    if (diagonal <= 0.0)
+    {
+      vtkErrorMacro("Matrix is not positive definite, pivot " << diagonal << " at row " << row);
+      return SV_ERROR;
+    }
+    this->Diagonal[k] = diagonal;
+  }
+
+  this->Factored = 1;
+  return SV_OK;
+}
+
+// ----------------------
+// Solve
+// ----------------------
+void vtkSVSparseCholesky::Solve(double *x) const
+{
+  if (!this->Factored)
+    return;
+
+  int numRows = this->NumberOfRows;
+  std::vector<double> y(numRows);
+  for (int k=0; k<numRows; k++)
+    y[k] = x[this->Permutation[k]];
+
+  for (int j=0; j<numRows; j++)
+  {
+    for (int p=this->FactorOffsets[j]; p<this->FactorOffsets[j+1]; p++)
+      y[this->FactorRows[p]] -= this->FactorValues[p] * y[j];
+  }
+  for (int j=0; j<numRows; j++)
+    y[j] /= this->Diagonal[j];
+  for (int j=numRows-1; j>=0; j--)
+  {
+    for (int p=this->FactorOffsets[j]; p<this->FactorOffsets[j+1]; p++)
+      y[j] -= this->FactorValues[p] * y[this->FactorRows[p]];
+  }
+
+  for (int k=0; k<numRows; k++)
+    x[this->Permutation[k]] = y[k];
+}
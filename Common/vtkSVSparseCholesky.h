@@ -0,0 +1,124 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class  vtkSVSparseCholesky
+ *  \brief Sparse LDL^T factorization of a symmetric positive definite matrix.
+ *
+ *  The matrix is given in compressed rows with the full symmetric pattern,
+ *  both triangles and the diagonal. Analyze orders the rows with nested
+ *  dissection on the graph of the matrix and finds the pattern of the
+ *  factor. Factorize computes the factor for a set of values in the order
+ *  of the pattern, so a matrix whose values change but whose pattern does
+ *  not is only analyzed once. Solve only reads the factor and can be called
+ *  from several threads at once.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVSparseCholesky_h
+#define vtkSVSparseCholesky_h
+
+#include "vtkObject.h"
+#include "vtkSVCommonModule.h" // For export
+
+#include <vector>
+
+class VTKSVCOMMON_EXPORT vtkSVSparseCholesky : public vtkObject
+{
+public:
+  static vtkSVSparseCholesky *New();
+  vtkTypeMacro(vtkSVSparseCholesky,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// \brief Order the rows and find the pattern of the factor.
+  /// \param numRows Number of rows and columns.
+  /// \param rowOffsets Start of each row in columns, numRows+1 values.
+  /// \param columns Column of each value, every row must hold its diagonal.
+  /// \return SV_ERROR if the pattern is not valid.
+  int Analyze(const int numRows, const std::vector<int> &rowOffsets,
+              const std::vector<int> &columns);
+
+  /// \brief Compute the factor for values in the order of the columns given
+  /// to Analyze. Returns SV_ERROR if the matrix is not positive definite.
+  int Factorize(const double *values);
+
+  /// \brief Solve the factored system, the right hand side is replaced by
+  /// the solution.
+  void Solve(double *x) const;
+
+  //@{
+  /// \brief Sizes of the matrix and the factor.
+  int GetNumberOfRows() const {return this->NumberOfRows;}
+  int GetNumberOfFactorElements() const {return this->FactorOffsets.empty() ? 0 : this->FactorOffsets.back();}
+  //@}
+
+protected:
+  vtkSVSparseCholesky();
+  ~vtkSVSparseCholesky();
+
+  /// \brief Append the rows in nodes to Permutation, separators last.
+  void Dissect(std::vector<int> &nodes, std::vector<int> &level);
+
+  int NumberOfRows;
+  int Factored;
+
+  //@{
+  /// \brief Pattern of the matrix.
+  std::vector<int> RowOffsets;
+  std::vector<int> Columns;
+  //@}
+
+  //@{
+  /// \brief Row of the matrix for each row of the factor and the inverse.
+  std::vector<int> Permutation;
+  std::vector<int> InversePermutation;
+  //@}
+
+  //@{
+  /// \brief Elimination tree and the factor stored by columns below the
+  /// diagonal, with the diagonal in Diagonal.
+  std::vector<int> Parent;
+  std::vector<int> FactorOffsets;
+  std::vector<int> FactorRows;
+  std::vector<double> FactorValues;
+  std::vector<double> Diagonal;
+  //@}
+
+private:
+  vtkSVSparseCholesky(const vtkSVSparseCholesky&);  // Not implemented.
+  void operator=(const vtkSVSparseCholesky&);  // Not implemented.
+};
+
+#endif  // vtkSVSparseCholesky_h
@@ -0,0 +1,405 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class  vtkSVTensor
+ *  \brief Lightweight contiguous, row-major dense array of up to four
+ *  dimensions with strided, non-owning views.
+ *
+ *  The NURBS routines spend most of their time on small matrices and grids of
+ *  homogeneous control points. vtkTypedArray and vtkStructuredGrid access goes
+ *  through a virtual call per value; this class keeps the values in one
+ *  std::vector so that kernels can work on raw pointers and strides. Views
+ *  (vtkSVTensorView) can be sliced, restricted to a range and have their axes
+ *  swapped without copying, which lets one kernel process any parametric
+ *  direction of a curve, surface or volume.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVTensor_h
+#define vtkSVTensor_h
+
+#include "vtkType.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+/** \brief Non-owning view into a block of memory with shape and strides.
+ *  Strides are given in number of elements, not bytes. */
+template <class T>
+class vtkSVTensorView
+{
+public:
+  enum { MAX_RANK = 4 };
+
+  vtkSVTensorView() : Data(NULL), Rank(0)
+  {
+    for (int i=0; i<MAX_RANK; i++)
+    {
+      this->Shape[i]   = 1;
+      this->Strides[i] = 0;
+    }
+  }
+
+  /** \brief Construct a view of the given rank.
+   *  \param data pointer to the first element of the view.
+   *  \param rank number of dimensions, at most MAX_RANK.
+   *  \param shape number of entries along each axis.
+   *  \param strides distance in elements between entries along each axis. */
+  vtkSVTensorView(T *data, const int rank, const vtkIdType *shape,
+                  const vtkIdType *strides) : Data(data), Rank(rank)
+  {
+    assert(rank >= 0 && rank <= MAX_RANK);
+    for (int i=0; i<MAX_RANK; i++)
+    {
+      this->Shape[i]   = i < rank ? shape[i] : 1;
+      this->Strides[i] = i < rank ? strides[i] : 0;
+    }
+  }
+
+  /// \brief Allow a view of T to be used where a view of const T is expected.
+  template <class U>
+  vtkSVTensorView(const vtkSVTensorView<U> &other) : Data(other.GetData()), Rank(other.GetRank())
+  {
+    for (int i=0; i<MAX_RANK; i++)
+    {
+      this->Shape[i]   = other.GetShape(i);
+      this->Strides[i] = other.GetStride(i);
+    }
+  }
+
+  //@{
+  /// \brief Access to the raw layout of the view.
+  T *GetData() const {return this->Data;}
+  int GetRank() const {return this->Rank;}
+  vtkIdType GetShape(const int axis) const {return this->Shape[axis];}
+  vtkIdType GetStride(const int axis) const {return this->Strides[axis];}
+  //@}
+
+  /// \brief Total number of entries in the view.
+  vtkIdType GetSize() const
+  {
+    vtkIdType size = 1;
+    for (int i=0; i<this->Rank; i++)
+      size *= this->Shape[i];
+    return this->Rank == 0 ? 0 : size;
+  }
+
+  /// \brief True if the entries are laid out row-major with no gaps.
+  bool IsContiguous() const
+  {
+    vtkIdType expected = 1;
+    for (int i=this->Rank-1; i>=0; i--)
+    {
+      if (this->Shape[i] != 1 && this->Strides[i] != expected)
+        return false;
+      expected *= this->Shape[i];
+    }
+    return true;
+  }
+
+  //@{
+  /// \brief Element access, unused trailing indices are zero.
+  T &operator()(const vtkIdType i) const
+  {
+    return this->Data[i*this->Strides[0]];
+  }
+  T &operator()(const vtkIdType i, const vtkIdType j) const
+  {
+    return this->Data[i*this->Strides[0] + j*this->Strides[1]];
+  }
+  T &operator()(const vtkIdType i, const vtkIdType j, const vtkIdType k) const
+  {
+    return this->Data[i*this->Strides[0] + j*this->Strides[1] + k*this->Strides[2]];
+  }
+  T &operator()(const vtkIdType i, const vtkIdType j, const vtkIdType k,
+                const vtkIdType l) const
+  {
+    return this->Data[i*this->Strides[0] + j*this->Strides[1] +
+                      k*this->Strides[2] + l*this->Strides[3]];
+  }
+  //@}
+
+  /** \brief Get a pointer to the start of an entry. Useful for the last axis
+   *  when it is contiguous, i.e. the four values of a homogeneous point. */
+  T *GetPointer(const vtkIdType i, const vtkIdType j=0, const vtkIdType k=0) const
+  {
+    return this->Data + i*this->Strides[0] + j*this->Strides[1] + k*this->Strides[2];
+  }
+
+  /** \brief Fix the index of one axis, giving a view of one rank lower.
+   *  \param axis axis to remove.
+   *  \param index index along axis to keep. */
+  vtkSVTensorView Slice(const int axis, const vtkIdType index) const
+  {
+    assert(axis >= 0 && axis < this->Rank);
+    vtkSVTensorView slice;
+    slice.Data = this->Data + index*this->Strides[axis];
+    slice.Rank = this->Rank-1;
+    for (int i=0, j=0; i<this->Rank; i++)
+    {
+      if (i == axis)
+        continue;
+      slice.Shape[j]   = this->Shape[i];
+      slice.Strides[j] = this->Strides[i];
+      j++;
+    }
+    return slice;
+  }
+
+  /** \brief Restrict one axis to the half open range [begin, end). */
+  vtkSVTensorView Range(const int axis, const vtkIdType begin, const vtkIdType end) const
+  {
+    assert(axis >= 0 && axis < this->Rank && begin <= end);
+    vtkSVTensorView range = *this;
+    range.Data = this->Data + begin*this->Strides[axis];
+    range.Shape[axis] = end - begin;
+    return range;
+  }
+
+  /** \brief Swap two axes without moving any data. */
+  vtkSVTensorView SwapAxes(const int axis0, const int axis1) const
+  {
+    assert(axis0 >= 0 && axis0 < this->Rank && axis1 >= 0 && axis1 < this->Rank);
+    vtkSVTensorView swapped = *this;
+    std::swap(swapped.Shape[axis0], swapped.Shape[axis1]);
+    std::swap(swapped.Strides[axis0], swapped.Strides[axis1]);
+    return swapped;
+  }
+
+  /** \brief Set every entry of the view to val. */
+  void Fill(const T &val) const
+  {
+    if (this->Rank == 0)
+      return;
+    for (vtkIdType i=0; i<this->Shape[0]; i++)
+      for (vtkIdType j=0; j<this->Shape[1]; j++)
+        for (vtkIdType k=0; k<this->Shape[2]; k++)
+          for (vtkIdType l=0; l<this->Shape[3]; l++)
+            (*this)(i, j, k, l) = val;
+  }
+
+  /** \brief Copy the entries of a view with the same shape into this one. */
+  template <class U>
+  void CopyFrom(const vtkSVTensorView<U> &src) const
+  {
+    assert(src.GetRank() == this->Rank);
+    vtkIdType n[MAX_RANK];
+    for (int i=0; i<MAX_RANK; i++)
+    {
+      assert(src.GetShape(i) == this->Shape[i]);
+      n[i] = this->Rank == 0 ? 0 : this->Shape[i];
+    }
+    for (vtkIdType i=0; i<n[0]; i++)
+      for (vtkIdType j=0; j<n[1]; j++)
+        for (vtkIdType k=0; k<n[2]; k++)
+          for (vtkIdType l=0; l<n[3]; l++)
+            (*this)(i, j, k, l) = src(i, j, k, l);
+  }
+
+private:
+  template <class U> friend class vtkSVTensorView;
+
+  T         *Data;
+  int       Rank;
+  vtkIdType Shape[MAX_RANK];
+  vtkIdType Strides[MAX_RANK];
+};
+
+/** \brief Owning, contiguous, row-major array. The last index is the
+ *  fastest varying one. */
+template <class T>
+class vtkSVTensor
+{
+public:
+  enum { MAX_RANK = vtkSVTensorView<T>::MAX_RANK };
+
+  vtkSVTensor() : Rank(0)
+  {
+    for (int i=0; i<MAX_RANK; i++)
+      this->Shape[i] = 1;
+  }
+
+  //@{
+  /** \brief Set the shape of the array. Existing values are not preserved in
+   *  any meaningful order, but the storage is reused when large enough so that
+   *  resizing a scratch tensor in a loop does not allocate. */
+  void Resize(const vtkIdType d0)
+  {
+    vtkIdType shape[1] = {d0};
+    this->Resize(1, shape);
+  }
+  void Resize(const vtkIdType d0, const vtkIdType d1)
+  {
+    vtkIdType shape[2] = {d0, d1};
+    this->Resize(2, shape);
+  }
+  void Resize(const vtkIdType d0, const vtkIdType d1, const vtkIdType d2)
+  {
+    vtkIdType shape[3] = {d0, d1, d2};
+    this->Resize(3, shape);
+  }
+  void Resize(const vtkIdType d0, const vtkIdType d1, const vtkIdType d2,
+              const vtkIdType d3)
+  {
+    vtkIdType shape[4] = {d0, d1, d2, d3};
+    this->Resize(4, shape);
+  }
+  void Resize(const int rank, const vtkIdType *shape)
+  {
+    assert(rank >= 0 && rank <= MAX_RANK);
+    this->Rank = rank;
+    vtkIdType size = rank == 0 ? 0 : 1;
+    for (int i=0; i<MAX_RANK; i++)
+    {
+      this->Shape[i] = i < rank ? shape[i] : 1;
+      size *= this->Shape[i];
+    }
+    this->Values.resize(size);
+  }
+  //@}
+
+  /** \brief Change the shape without touching the values. The total number of
+   *  entries must stay the same. */
+  void Reshape(const int rank, const vtkIdType *shape)
+  {
+    assert(rank >= 0 && rank <= MAX_RANK);
+    vtkIdType size = rank == 0 ? 0 : 1;
+    for (int i=0; i<rank; i++)
+      size *= shape[i];
+    assert(size == this->GetSize());
+    (void)size;
+    this->Rank = rank;
+    for (int i=0; i<MAX_RANK; i++)
+      this->Shape[i] = i < rank ? shape[i] : 1;
+  }
+
+  //@{
+  /// \brief Layout information.
+  int GetRank() const {return this->Rank;}
+  vtkIdType GetShape(const int axis) const {return this->Shape[axis];}
+  vtkIdType GetSize() const {return static_cast<vtkIdType>(this->Values.size());}
+  //@}
+
+  //@{
+  /// \brief Raw access to the contiguous storage.
+  T *GetData() {return this->Values.empty() ? NULL : &this->Values[0];}
+  const T *GetData() const {return this->Values.empty() ? NULL : &this->Values[0];}
+  //@}
+
+  /// \brief Set all values of the array.
+  void Fill(const T &val) {std::fill(this->Values.begin(), this->Values.end(), val);}
+
+  /// \brief Swap storage and shape with another tensor without copying.
+  void Swap(vtkSVTensor &other)
+  {
+    this->Values.swap(other.Values);
+    std::swap(this->Rank, other.Rank);
+    for (int i=0; i<MAX_RANK; i++)
+      std::swap(this->Shape[i], other.Shape[i]);
+  }
+
+  //@{
+  /// \brief Element access using row-major ordering.
+  T &operator()(const vtkIdType i)
+  {
+    return this->Values[i];
+  }
+  const T &operator()(const vtkIdType i) const
+  {
+    return this->Values[i];
+  }
+  T &operator()(const vtkIdType i, const vtkIdType j)
+  {
+    return this->Values[i*this->Shape[1] + j];
+  }
+  const T &operator()(const vtkIdType i, const vtkIdType j) const
+  {
+    return this->Values[i*this->Shape[1] + j];
+  }
+  T &operator()(const vtkIdType i, const vtkIdType j, const vtkIdType k)
+  {
+    return this->Values[(i*this->Shape[1] + j)*this->Shape[2] + k];
+  }
+  const T &operator()(const vtkIdType i, const vtkIdType j, const vtkIdType k) const
+  {
+    return this->Values[(i*this->Shape[1] + j)*this->Shape[2] + k];
+  }
+  T &operator()(const vtkIdType i, const vtkIdType j, const vtkIdType k,
+                const vtkIdType l)
+  {
+    return this->Values[((i*this->Shape[1] + j)*this->Shape[2] + k)*this->Shape[3] + l];
+  }
+  const T &operator()(const vtkIdType i, const vtkIdType j, const vtkIdType k,
+                      const vtkIdType l) const
+  {
+    return this->Values[((i*this->Shape[1] + j)*this->Shape[2] + k)*this->Shape[3] + l];
+  }
+  //@}
+
+  //@{
+  /// \brief Get a strided view of the whole array.
+  vtkSVTensorView<T> GetView()
+  {
+    vtkIdType strides[MAX_RANK];
+    this->ComputeStrides(strides);
+    return vtkSVTensorView<T>(this->GetData(), this->Rank, this->Shape, strides);
+  }
+  vtkSVTensorView<const T> GetView() const
+  {
+    vtkIdType strides[MAX_RANK];
+    this->ComputeStrides(strides);
+    return vtkSVTensorView<const T>(this->GetData(), this->Rank, this->Shape, strides);
+  }
+  //@}
+
+private:
+  void ComputeStrides(vtkIdType strides[MAX_RANK]) const
+  {
+    vtkIdType stride = 1;
+    for (int i=MAX_RANK-1; i>=0; i--)
+    {
+      strides[i] = stride;
+      stride *= this->Shape[i];
+    }
+  }
+
+  std::vector<T> Values;
+  int            Rank;
+  vtkIdType      Shape[MAX_RANK];
+};
+
+#endif  // vtkSVTensor_h
@@ -0,0 +1,509 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file PolyDataBooleanBenchmark.cxx
+ *
+ *  \brief Times unions of parametric tubes at increasing resolution. A pair
+ *  case unions two crossing tubes and a tree case unions branches onto a
+ *  trunk one at a time. The radius of the crossing tubes is waved so that
+ *  the intersection curves wind more with more waves. The time and peak
+ *  memory of every phase named by the progress text of the boolean filter
+ *  are printed and can be written to a csv file.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkAlgorithm.h"
+#include "vtkCallbackCommand.h"
+#include "vtkCellArray.h"
+#include "vtkMath.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+#include "vtkSVGlobals.h"
+#include "vtkSVLoopBooleanPolyDataFilter.h"
+
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <vector>
+
+// ----------------------
+// PhaseRecord
+// ----------------------
+struct PhaseRecord
+{
+  std::string Name; // progress text of the phase
+  double Time;      // seconds summed over all runs
+  double PeakMemory; // largest peak resident memory in MB
+};
+
+// ----------------------
+// ResetPeakMemory
+// ----------------------
+/// \brief Start a new peak resident memory measurement where the system
+/// allows it. Elsewhere the peak is the peak of the whole process.
+static void ResetPeakMemory()
+{
+#if defined(__linux__)
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  if (clearRefs)
+    {
+    clearRefs << "5";
+    }
+#endif
+}
+
+// ----------------------
+// GetPeakMemory
+// ----------------------
+/// \brief Peak resident memory in MB since the last reset, zero if it can
+/// not be read on this system.
+static double GetPeakMemory()
+{
+#if defined(__linux__)
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+    {
+    if (line.compare(0, 6, "VmHWM:") == 0)
+      {
+      std::istringstream value(line.substr(6));
+      double kiloBytes = 0.0;
+      value >> kiloBytes;
+      return kiloBytes/1024.0;
+      }
+    }
+#endif
+  return 0.0;
+}
+
+// ----------------------
+// PhaseRecorder
+// ----------------------
+/// \brief Observes the progress of a filter and times each phase it names
+class PhaseRecorder
+{
+public:
+  PhaseRecorder() : StartTime(0.0) {}
+
+  void Begin(const std::string &name)
+  {
+    this->End();
+    this->Current = name;
+    ResetPeakMemory();
+    this->StartTime = vtkTimerLog::GetUniversalTime();
+  }
+
+  void End()
+  {
+    if (this->Current.empty())
+      {
+      return;
+      }
+    double time = vtkTimerLog::GetUniversalTime() - this->StartTime;
+    double peak = GetPeakMemory();
+
+    size_t i = 0;
+    for (; i < this->Phases.size(); i++)
+      {
+      if (this->Phases[i].Name == this->Current)
+        {
+        break;
+        }
+      }
+    if (i == this->Phases.size())
+      {
+      PhaseRecord record;
+      record.Name = this->Current;
+      record.Time = 0.0;
+      record.PeakMemory = 0.0;
+      this->Phases.push_back(record);
+      }
+    this->Phases[i].Time += time;
+    this->Phases[i].PeakMemory = svmaximum(this->Phases[i].PeakMemory, peak);
+    this->Current.clear();
+  }
+
+  std::vector<PhaseRecord> Phases;
+  std::string Current;
+  double StartTime;
+};
+
+// ----------------------
+// RecordPhase
+// ----------------------
+static void RecordPhase(vtkObject *caller, unsigned long eventId,
+                        void *clientData, void *vtkNotUsed(callData))
+{
+  PhaseRecorder *recorder = static_cast<PhaseRecorder*>(clientData);
+  if (eventId == vtkCommand::EndEvent)
+    {
+    recorder->End();
+    return;
+    }
+  const char *text = static_cast<vtkAlgorithm*>(caller)->GetProgressText();
+  if (text != NULL && recorder->Current != text)
+    {
+    recorder->Begin(text);
+    }
+}
+
+// ----------------------
+// BuildTube
+// ----------------------
+/// \brief Closed tube of triangles around the segment from start along axis.
+/// The radius is waved around the tube with the given number of waves.
+static void BuildTube(const double start[3], const double axis[3],
+                      const double length, const double radius,
+                      const int waves, const int numTheta, const int numAxial,
+                      vtkPolyData *tube)
+{
+  // Frame around the axis
+  double w[3] = {axis[0], axis[1], axis[2]};
+  vtkMath::Normalize(w);
+  double u[3], v[3];
+  vtkMath::Perpendiculars(w, u, v, 0.0);
+
+  vtkNew(vtkPoints, points);
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numTheta*numAxial + 2);
+  for (int a = 0; a < numAxial; a++)
+    {
+    double s = length*a/(numAxial - 1);
+    for (int t = 0; t < numTheta; t++)
+      {
+      double theta = 2.0*vtkMath::Pi()*t/numTheta;
+      double r = radius;
+      if (waves > 0)
+        {
+        r *= 1.0 + 0.15*sin(waves*theta);
+        }
+      double pt[3];
+      for (int j = 0; j < 3; j++)
+        {
+        pt[j] = start[j] + s*w[j] + r*(cos(theta)*u[j] + sin(theta)*v[j]);
+        }
+      points->SetPoint(a*numTheta + t, pt);
+      }
+    }
+  vtkIdType startCenter = numTheta*numAxial;
+  vtkIdType endCenter   = startCenter + 1;
+  double pt[3];
+  for (int j = 0; j < 3; j++)
+    {
+    pt[j] = start[j];
+    }
+  points->SetPoint(startCenter, pt);
+  for (int j = 0; j < 3; j++)
+    {
+    pt[j] = start[j] + length*w[j];
+    }
+  points->SetPoint(endCenter, pt);
+
+  // Triangles with outward normals
+  vtkNew(vtkCellArray, polys);
+  polys->Allocate(4*(2*numTheta*numAxial));
+  for (int a = 0; a < numAxial - 1; a++)
+    {
+    for (int t = 0; t < numTheta; t++)
+      {
+      vtkIdType p00 = a*numTheta + t;
+      vtkIdType p01 = a*numTheta + (t+1)%numTheta;
+      vtkIdType p10 = p00 + numTheta;
+      vtkIdType p11 = p01 + numTheta;
+      vtkIdType tri0[3] = {p00, p01, p11};
+      vtkIdType tri1[3] = {p00, p11, p10};
+      polys->InsertNextCell(3, tri0);
+      polys->InsertNextCell(3, tri1);
+      }
+    }
+  vtkIdType last = (numAxial - 1)*numTheta;
+  for (int t = 0; t < numTheta; t++)
+    {
+    vtkIdType startTri[3] = {startCenter, (t+1)%numTheta, t};
+    vtkIdType endTri[3] = {endCenter, last + t, last + (t+1)%numTheta};
+    polys->InsertNextCell(3, startTri);
+    polys->InsertNextCell(3, endTri);
+    }
+
+  tube->SetPoints(points);
+  tube->SetPolys(polys);
+}
+
+// ----------------------
+// GetTubeResolution
+// ----------------------
+/// \brief Resolution around and along a tube for close to the given number
+/// of triangles with cells about as long as they are wide
+static void GetTubeResolution(const double numTriangles, const double length,
+                              const double radius, int &numTheta, int &numAxial)
+{
+  double aspect = length/(2.0*vtkMath::Pi()*radius);
+  numTheta = svmaximum(8, static_cast<int>(sqrt(numTriangles/(2.0*aspect))));
+  numAxial = svmaximum(2, static_cast<int>(numTriangles/(2.0*numTheta)));
+}
+
+// ----------------------
+// RunCase
+// ----------------------
+/// \brief Unions the tubes of a case one after the other onto the first and
+/// records the phases of all the booleans
+static int RunCase(const std::string &caseName, const double numTriangles,
+                   const int waves, const int numBranches, const double tolerance,
+                   PhaseRecorder *recorder, vtkIdType &numInputTriangles,
+                   vtkIdType &numOutputTriangles)
+{
+  const double length = 8.0;
+  const double radius = 1.0;
+
+  // Trunk along x, with half of the triangles for the pair
+  int numTubes = caseName == "pair" ? 2 : numBranches + 1;
+  double trunkTriangles = numTriangles/2.0;
+  double branchTriangles = numTriangles/2.0;
+  if (caseName != "pair")
+    {
+    branchTriangles = numTriangles/(2.0*numBranches);
+    }
+
+  int numTheta, numAxial;
+  GetTubeResolution(trunkTriangles, length, radius, numTheta, numAxial);
+  double trunkStart[3] = {-length/2.0, 0.0, 0.0};
+  double trunkAxis[3] = {1.0, 0.0, 0.0};
+  vtkNew(vtkPolyData, result);
+  BuildTube(trunkStart, trunkAxis, length, radius, 0, numTheta, numAxial, result);
+  numInputTriangles = result->GetNumberOfCells();
+
+  vtkNew(vtkCallbackCommand, observer);
+  observer->SetCallback(RecordPhase);
+  observer->SetClientData(recorder);
+
+  for (int i = 1; i < numTubes; i++)
+    {
+    vtkNew(vtkPolyData, branch);
+    if (caseName == "pair")
+      {
+      // Crosses all the way through the trunk
+      double branchRadius = 0.6*radius;
+      GetTubeResolution(branchTriangles, length, branchRadius, numTheta, numAxial);
+      double start[3] = {0.0, -length/2.0, 0.0};
+      double axis[3] = {0.0, 1.0, 0.0};
+      BuildTube(start, axis, length, branchRadius, waves, numTheta, numAxial, branch);
+      }
+    else
+      {
+      // Starts inside the trunk and leaves on alternating sides
+      double branchRadius = 0.4*radius;
+      double branchLength = length/2.0;
+      GetTubeResolution(branchTriangles, branchLength, branchRadius, numTheta, numAxial);
+      double x = -length/2.0 + length*i/(numBranches + 1);
+      double side = i%2 == 0 ? 1.0 : -1.0;
+      double start[3] = {x, 0.0, 0.0};
+      double axis[3] = {0.3, side, 0.2*side};
+      BuildTube(start, axis, branchLength, branchRadius, waves, numTheta, numAxial, branch);
+      }
+    numInputTriangles += branch->GetNumberOfCells();
+
+    vtkNew(vtkSVLoopBooleanPolyDataFilter, boolean);
+    boolean->SetInputData(0, result);
+    boolean->SetInputData(1, branch);
+    boolean->SetOperationToUnion();
+    boolean->SetTolerance(tolerance);
+    boolean->AddObserver(vtkCommand::ProgressEvent, observer);
+    boolean->AddObserver(vtkCommand::EndEvent, observer);
+    boolean->Update();
+    if (boolean->GetStatus() != SV_OK)
+      {
+      std::cout << "ERROR: Boolean " << i << " of case " << caseName << " failed" << endl;
+      return SV_ERROR;
+      }
+    result->DeepCopy(boolean->GetOutput());
+    }
+  numOutputTriangles = result->GetNumberOfCells();
+
+  return SV_OK;
+}
+
+int main(int argc, char *argv[])
+{
+  // BEGIN PROCESSING COMMAND-LINE ARGUMENTS
+  // Assume no options specified at command line
+  bool RequestedHelp = false;
+  bool OutputProvided = false;
+
+  // Variables used in processing the commandline
+  int iarg, arglength;
+  std::string tmpstr;
+
+  // Filenames
+  std::string outputFilename;
+
+  // Default values for options
+  std::string caseName = "all";
+  double minTriangles = 1.0e4;
+  double maxTriangles = 4.0e6;
+  double factor = 4.0;
+  int maxWaves = 16;
+  int numBranches = 4;
+  double testTolerance = 1e-6;
+
+  // argc is the number of strings on the command-line
+  //  starting with the program name
+  for(iarg=1; iarg<argc; iarg++){
+      arglength = strlen(argv[iarg]);
+      // replace 0..arglength-1 with argv[iarg]
+      tmpstr.replace(0,arglength,argv[iarg],0,arglength);
+      if(tmpstr=="-h")                      {RequestedHelp = true;}
+      else if(tmpstr=="-case")              {caseName = argv[++iarg];}
+      else if(tmpstr=="-mintriangles")      {minTriangles = atof(argv[++iarg]);}
+      else if(tmpstr=="-maxtriangles")      {maxTriangles = atof(argv[++iarg]);}
+      else if(tmpstr=="-factor")            {factor = atof(argv[++iarg]);}
+      else if(tmpstr=="-maxwaves")          {maxWaves = atoi(argv[++iarg]);}
+      else if(tmpstr=="-branches")          {numBranches = atoi(argv[++iarg]);}
+      else if(tmpstr=="-tolerance")         {testTolerance = atof(argv[++iarg]);}
+      else if(tmpstr=="-output")            {OutputProvided = true; outputFilename = argv[++iarg];}
+      else {cout << argv[iarg] << " is not a valid argument. Ask for help with -h." << endl; RequestedHelp = true; return EXIT_FAILURE;}
+      // reset tmpstr for next argument
+      tmpstr.erase(0,arglength);
+  }
+  if (RequestedHelp)
+  {
+    cout << endl;
+    cout << "usage:" <<endl;
+    cout << "  PolyDataBooleanBenchmark -case [Case] -mintriangles [Triangles] -maxtriangles [Triangles] -output [Output Filename] ..." << endl;
+    cout << endl;
+    cout << "COMMAND-LINE ARGUMENT SUMMARY" << endl;
+    cout << "  -h                  : Display usage and command-line argument summary"<< endl;
+    cout << "  -case               : pair, tree or all [default all]"<< endl;
+    cout << "  -mintriangles       : Number of input triangles of the first run [default 1.0e4]"<< endl;
+    cout << "  -maxtriangles       : Number of input triangles of the last run [default 4.0e6]"<< endl;
+    cout << "  -factor             : Growth of the number of triangles between runs [default 4]"<< endl;
+    cout << "  -maxwaves           : Runs use 0 waves and powers of 4 waves up to this number [default 16]"<< endl;
+    cout << "  -branches           : Number of branches of the tree case [default 4]"<< endl;
+    cout << "  -tolerance          : Tolerance for the boolean operation [default 1.0e-6]"<< endl;
+    cout << "  -output             : Csv file name for the results [default none]"<< endl;
+    cout << "END COMMAND-LINE ARGUMENT SUMMARY" << endl;
+    return EXIT_FAILURE;
+  }
+  if (caseName != "pair" && caseName != "tree" && caseName != "all")
+  {
+    cout << "ERROR: Case must be pair, tree or all." << endl;
+    return EXIT_FAILURE;
+  }
+  if (factor <= 1.0 || minTriangles <= 0.0 || numBranches < 1)
+  {
+    cout << "ERROR: Need a factor greater than one, a positive number of triangles and at least one branch." << endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> cases;
+  if (caseName == "pair" || caseName == "all")
+    cases.push_back("pair");
+  if (caseName == "tree" || caseName == "all")
+    cases.push_back("tree");
+
+  std::vector<double> sizes;
+  for (double size = minTriangles; size <= maxTriangles; size *= factor)
+    sizes.push_back(size);
+  if (sizes.empty() || sizes.back() < maxTriangles)
+    sizes.push_back(maxTriangles);
+
+  std::vector<int> wavesList;
+  wavesList.push_back(0);
+  for (int waves = 4; waves <= maxWaves; waves *= 4)
+    wavesList.push_back(waves);
+
+  std::ofstream csv;
+  if (OutputProvided)
+  {
+    csv.open(outputFilename.c_str());
+    if (!csv)
+    {
+      cout << "ERROR: Could not open " << outputFilename << endl;
+      return EXIT_FAILURE;
+    }
+    csv << "case,waves,input_triangles,output_triangles,phase,seconds,peak_mb" << endl;
+  }
+
+  int status = EXIT_SUCCESS;
+  for (size_t c = 0; c < cases.size(); c++)
+  {
+    for (size_t w = 0; w < wavesList.size(); w++)
+    {
+      for (size_t s = 0; s < sizes.size(); s++)
+      {
+        PhaseRecorder recorder;
+        vtkIdType numInputTriangles = 0, numOutputTriangles = 0;
+        double startTime = vtkTimerLog::GetUniversalTime();
+        if (RunCase(cases[c], sizes[s], wavesList[w], numBranches, testTolerance,
+                    &recorder, numInputTriangles, numOutputTriangles) != SV_OK)
+        {
+          status = EXIT_FAILURE;
+          continue;
+        }
+        double totalTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+        PhaseRecord total;
+        total.Name = "Total";
+        total.Time = totalTime;
+        total.PeakMemory = 0.0;
+        for (size_t p = 0; p < recorder.Phases.size(); p++)
+          total.PeakMemory = svmaximum(total.PeakMemory, recorder.Phases[p].PeakMemory);
+        recorder.Phases.push_back(total);
+
+        std::cout << cases[c] << " waves " << wavesList[w] << " input triangles " <<
+          numInputTriangles << " output triangles " << numOutputTriangles << endl;
+        for (size_t p = 0; p < recorder.Phases.size(); p++)
+        {
+          PhaseRecord &phase = recorder.Phases[p];
+          std::cout << "  " << phase.Name << ": " << phase.Time << " s, " <<
+            phase.PeakMemory << " MB" << endl;
+          if (OutputProvided)
+          {
+            csv << cases[c] << "," << wavesList[w] << "," << numInputTriangles << "," <<
+              numOutputTriangles << "," << phase.Name << "," << phase.Time << "," <<
+              phase.PeakMemory << endl;
+          }
+        }
+      }
+    }
+  }
+
+  std::cout<<"Done"<<endl;
+  return status;
+}
@@ -45,6 +45,178 @@
 #include <vtkTriangleFilter.h>
 #include <vtkCellData.h>
 #include <vtkMath.h>
+#include <vtkIntArray.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSelectEnclosedPoints.h>
+#include "vtkSVLoopIntersectionPolyDataFilter.h"
+
+#include <map>
+
+// Number of cells of a mesh inside the other surface, using their centers
+static int CountCellsInside( vtkPolyData *mesh, vtkPolyData *surface )
+{
+  vtkSmartPointer<vtkPoints> centers =
+    vtkSmartPointer<vtkPoints>::New();
+  for (vtkIdType cellId = 0; cellId < mesh->GetNumberOfCells(); cellId++)
+    {
+    vtkIdType npts, *pts;
+    mesh->GetCellPoints(cellId, npts, pts);
+    double center[3] = {0.0, 0.0, 0.0};
+    for (vtkIdType i = 0; i < npts; i++)
+      {
+      double pt[3];
+      mesh->GetPoint(pts[i], pt);
+      for (int j = 0; j < 3; j++)
+        {
+        center[j] += pt[j]/npts;
+        }
+      }
+    centers->InsertNextPoint(center);
+    }
+  vtkSmartPointer<vtkPolyData> centersPd =
+    vtkSmartPointer<vtkPolyData>::New();
+  centersPd->SetPoints(centers);
+
+  vtkSmartPointer<vtkSelectEnclosedPoints> selector =
+    vtkSmartPointer<vtkSelectEnclosedPoints>::New();
+  selector->SetInputData(centersPd);
+  selector->SetSurfaceData(surface);
+  selector->Update();
+
+  int numInside = 0;
+  for (vtkIdType i = 0; i < centers->GetNumberOfPoints(); i++)
+    {
+    numInside += selector->IsInside(i);
+    }
+  return numInside;
+}
+
+// Checks the cells kept by the boolean and their region ids against the
+// split surfaces classified on their own
+static int CheckBooleanOperation( vtkPolyData *input0, vtkPolyData *input1,
+                                  int operation )
+{
+  vtkSmartPointer<vtkSVLoopBooleanPolyDataFilter> boolFilter =
+    vtkSmartPointer<vtkSVLoopBooleanPolyDataFilter>::New();
+  boolFilter->SetOperation( operation );
+  boolFilter->SetInputData( 0, input0 );
+  boolFilter->SetInputData( 1, input1 );
+  boolFilter->Update();
+  if (boolFilter->GetStatus() != 1 ||
+      boolFilter->GetNumberOfIntersectionLines() == 0)
+    {
+    std::cerr << "Boolean operation " << operation << " failed" << std::endl;
+    return 0;
+    }
+  vtkPolyData *output = boolFilter->GetOutput();
+
+  vtkSmartPointer<vtkSVLoopIntersectionPolyDataFilter> intersector =
+    vtkSmartPointer<vtkSVLoopIntersectionPolyDataFilter>::New();
+  intersector->SetInputData( 0, input0 );
+  intersector->SetInputData( 1, input1 );
+  intersector->SplitFirstOutputOn();
+  intersector->SplitSecondOutputOn();
+  intersector->Update();
+  vtkPolyData *split0 = intersector->GetOutput(1);
+  vtkPolyData *split1 = intersector->GetOutput(2);
+  int numInside0 = CountCellsInside(split0, input1);
+  int numInside1 = CountCellsInside(split1, input0);
+  int numOutside0 = split0->GetNumberOfCells() - numInside0;
+  int numOutside1 = split1->GetNumberOfCells() - numInside1;
+
+  // Union keeps the outside of both, intersection the inside of both, and
+  // difference the outside of the first with the inside of the second. The
+  // region ids of the cells kept from each surface are the ones the filter
+  // keeps for that operation.
+  std::map<int, int> expected;
+  if (operation == vtkSVLoopBooleanPolyDataFilter::VTK_UNION)
+    {
+    expected[-1] += numOutside0;
+    expected[1]  += numOutside1;
+    }
+  else if (operation == vtkSVLoopBooleanPolyDataFilter::VTK_INTERSECTION)
+    {
+    expected[1]  += numInside0;
+    expected[-1] += numInside1;
+    }
+  else
+    {
+    expected[-1] += numOutside0;
+    expected[-1] += numInside1;
+    }
+
+  int numExpected = 0;
+  for (std::map<int, int>::iterator it = expected.begin();
+       it != expected.end(); ++it)
+    {
+    numExpected += it->second;
+    }
+  if (output->GetNumberOfCells() != numExpected)
+    {
+    std::cerr << "Boolean operation " << operation << " kept "
+              << output->GetNumberOfCells() << " cells, expected "
+              << numExpected << std::endl;
+    return 0;
+    }
+
+  vtkIntArray *regions = vtkIntArray::SafeDownCast(
+    output->GetCellData()->GetArray("BooleanRegion"));
+  if (regions == NULL)
+    {
+    std::cerr << "No region ids on the output" << std::endl;
+    return 0;
+    }
+  std::map<int, int> found;
+  for (vtkIdType cellId = 0; cellId < output->GetNumberOfCells(); cellId++)
+    {
+    found[regions->GetValue(cellId)]++;
+    }
+  if (found != expected)
+    {
+    std::cerr << "Region ids of boolean operation " << operation
+              << " do not match the cells kept from each surface" << std::endl;
+    return 0;
+    }
+
+  // The kept regions close the surface
+  double freeEdgeRange[2];
+  output->GetCellData()->GetArray("FreeEdge")->GetRange(freeEdgeRange, 0);
+  if (freeEdgeRange[1] != 0)
+    {
+    std::cerr << "Boolean operation " << operation << " has free edges"
+              << std::endl;
+    return 0;
+    }
+  return 1;
+}
+
+static int CheckSphereBooleanOperations()
+{
+  double centerSeparation = 0.15;
+  vtkSmartPointer<vtkSphereSource> sphere1 =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere1->SetCenter(-centerSeparation, 0.0, 0.0);
+  sphere1->Update();
+
+  vtkSmartPointer<vtkSphereSource> sphere2 =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere2->SetCenter(  centerSeparation, 0.0, 0.0);
+  sphere2->Update();
+
+  int operations[3] = {vtkSVLoopBooleanPolyDataFilter::VTK_UNION,
+                       vtkSVLoopBooleanPolyDataFilter::VTK_INTERSECTION,
+                       vtkSVLoopBooleanPolyDataFilter::VTK_DIFFERENCE};
+  for (int i = 0; i < 3; i++)
+    {
+    if (!CheckBooleanOperation(sphere1->GetOutput(), sphere2->GetOutput(),
+                               operations[i]))
+      {
+      return 0;
+      }
+    }
+  return 1;
+}
 
 static vtkActor* GetCubeBooleanOperationActor( double x, int operation )
 {
@@ -244,6 +416,11 @@ static vtkActor* GetCylinderBooleanOperationActor( double x, int operation )
 
 int TestLoopBooleanPolyDataFilter(int argc, char *argv[])
 {
+  if (!CheckSphereBooleanOperations())
+    {
+    return EXIT_FAILURE;
+    }
+
   vtkSmartPointer<vtkRenderer> renderer =
     vtkSmartPointer<vtkRenderer>::New();
   vtkSmartPointer<vtkRenderWindow> renWin =
@@ -0,0 +1,230 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVLoopBooleanSession.h"
+#include "vtkSVGlobals.h"
+#include "vtkSVLoopBooleanPolyDataFilter.h"
+
+#include <vtkCellData.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkSVBoundingBoxTree.h>
+
+#include <algorithm>
+#include <vector>
+
+static vtkPolyData* GetSphere(const double center[3], double radius,
+                              int resolution)
+{
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetCenter(center[0], center[1], center[2]);
+  sphere->SetRadius(radius);
+  sphere->SetPhiResolution(resolution);
+  sphere->SetThetaResolution(resolution);
+  sphere->Update();
+
+  vtkPolyData *output = vtkPolyData::New();
+  output->DeepCopy(sphere->GetOutput());
+  return output;
+}
+
+// The tree kept by the session finds the same cells as a tree built from
+// scratch over the result
+static int CheckTree(vtkSVLoopBooleanSession *session)
+{
+  vtkPolyData *result = session->GetResult();
+  double tolerance = session->GetTolerance();
+  vtkIdType numCells = result->GetNumberOfCells();
+  if (session->GetTree()->GetNumberOfBoxes() != numCells)
+    {
+    std::cerr << "Tree has " << session->GetTree()->GetNumberOfBoxes()
+              << " boxes, result has " << numCells << " cells" << std::endl;
+    return 0;
+    }
+
+  std::vector<double> bounds(6*numCells);
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    vtkIdType npts, *pts;
+    result->GetCellPoints(cellId, npts, pts);
+    double *b = &bounds[6*cellId];
+    for (int j = 0; j < 3; j++)
+      {
+      b[2*j]   = VTK_DOUBLE_MAX;
+      b[2*j+1] = -VTK_DOUBLE_MAX;
+      }
+    for (vtkIdType i = 0; i < npts; i++)
+      {
+      double pt[3];
+      result->GetPoint(pts[i], pt);
+      for (int j = 0; j < 3; j++)
+        {
+        b[2*j]   = std::min(b[2*j], pt[j] - tolerance);
+        b[2*j+1] = std::max(b[2*j+1], pt[j] + tolerance);
+        }
+      }
+    }
+  vtkSmartPointer<vtkSVBoundingBoxTree> tree =
+    vtkSmartPointer<vtkSVBoundingBoxTree>::New();
+  tree->Build(&bounds[0], numCells);
+
+  std::vector<vtkIdType> found, expected;
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    found.clear();
+    expected.clear();
+    session->GetTree()->FindOverlappingBoxes(&bounds[6*cellId], found);
+    tree->FindOverlappingBoxes(&bounds[6*cellId], expected);
+    std::sort(found.begin(), found.end());
+    std::sort(expected.begin(), expected.end());
+    if (found != expected)
+      {
+      std::cerr << "Session tree found " << found.size() << " cells near "
+                << "cell " << cellId << ", expected " << expected.size()
+                << std::endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+int TestLoopBooleanSession(int argc, char *argv[])
+{
+  // Small spheres on a large one, none of them touch each other
+  double origin[3] = {0.0, 0.0, 0.0};
+  double centers[4][3] = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0},
+                          {0.0, 0.0, 1.0}, {-1.0, 0.0, 0.0}};
+  vtkSmartPointer<vtkPolyData> base =
+    vtkSmartPointer<vtkPolyData>::Take(GetSphere(origin, 1.0, 40));
+  std::vector<vtkSmartPointer<vtkPolyData> > surfaces;
+  for (int i = 0; i < 4; i++)
+    {
+    surfaces.push_back(
+      vtkSmartPointer<vtkPolyData>::Take(GetSphere(centers[i], 0.25, 12)));
+    }
+
+  // The same unions with the boolean filter alone
+  vtkSmartPointer<vtkPolyData> expected = vtkSmartPointer<vtkPolyData>::New();
+  expected->DeepCopy(base);
+  for (int i = 0; i < 4; i++)
+    {
+    vtkSmartPointer<vtkSVLoopBooleanPolyDataFilter> boolFilter =
+      vtkSmartPointer<vtkSVLoopBooleanPolyDataFilter>::New();
+    boolFilter->SetOperationToUnion();
+    boolFilter->SetInputData(0, expected);
+    boolFilter->SetInputData(1, surfaces[i]);
+    boolFilter->Update();
+    if (boolFilter->GetStatus() != 1)
+      {
+      std::cerr << "Boolean " << i << " failed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    vtkSmartPointer<vtkPolyData> next = vtkSmartPointer<vtkPolyData>::New();
+    next->DeepCopy(boolFilter->GetOutput());
+    expected = next;
+    }
+
+  vtkSmartPointer<vtkPolyData> result = vtkSmartPointer<vtkPolyData>::New();
+  result->DeepCopy(base);
+  vtkSmartPointer<vtkSVLoopBooleanSession> session =
+    vtkSmartPointer<vtkSVLoopBooleanSession>::New();
+  session->SetOperationToUnion();
+  session->Initialize(result);
+  for (int i = 0; i < 4; i++)
+    {
+    if (session->Apply(surfaces[i]) != SV_OK ||
+        session->GetNumberOfIntersectionLines() == 0)
+      {
+      std::cerr << "Session union " << i << " failed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (!CheckTree(session))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The small spheres add few cells, the first tree is kept throughout
+  if (session->GetNumberOfTreeBuilds() != 1)
+    {
+    std::cerr << "Tree was built " << session->GetNumberOfTreeBuilds()
+              << " times, expected once" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (result->GetNumberOfPoints() != expected->GetNumberOfPoints() ||
+      result->GetNumberOfCells() != expected->GetNumberOfCells())
+    {
+    std::cerr << "Session result has " << result->GetNumberOfPoints()
+              << " points and " << result->GetNumberOfCells() << " cells, "
+              << "boolean filter " << expected->GetNumberOfPoints()
+              << " points and " << expected->GetNumberOfCells() << " cells"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (result->GetCellData()->GetArray("SessionCellIds") != NULL)
+    {
+    std::cerr << "Session cell ids were left on the result" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A surface away from the result is left out without a boolean
+  double far[3] = {5.0, 5.0, 5.0};
+  vtkSmartPointer<vtkPolyData> farSphere =
+    vtkSmartPointer<vtkPolyData>::Take(GetSphere(far, 0.25, 12));
+  vtkIdType numCells = result->GetNumberOfCells();
+  if (session->Apply(farSphere) != SV_OK ||
+      session->GetNumberOfIntersectionLines() != 0 ||
+      result->GetNumberOfCells() != numCells ||
+      session->GetNumberOfTreeBuilds() != 1)
+    {
+    std::cerr << "Surface away from the result changed the session"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A large surface away from the small ones adds more cells than the tree
+  // was built with, so it is built again
+  double side[3] = {0.3, -1.2, -0.2};
+  vtkSmartPointer<vtkPolyData> large =
+    vtkSmartPointer<vtkPolyData>::Take(GetSphere(side, 1.0, 60));
+  if (session->Apply(large) != SV_OK ||
+      session->GetNumberOfIntersectionLines() == 0 ||
+      session->GetNumberOfTreeBuilds() != 2 || !CheckTree(session))
+    {
+    std::cerr << "Union with a large surface did not build the tree again"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
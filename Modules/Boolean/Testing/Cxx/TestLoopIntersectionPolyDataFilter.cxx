@@ -32,6 +32,8 @@
 #include <vtkSVLoopIntersectionPolyDataFilter.h>
 
 #include <vtkActor.h>
+#include <vtkCellArray.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
@@ -40,6 +42,105 @@
 #include <vtkSmartPointer.h>
 #include <vtkSphereSource.h>
 
+#include <algorithm>
+
+// Same points and cells with the same ids
+static int CompareOutputs(vtkPolyData *pd0, vtkPolyData *pd1)
+{
+  if (pd0->GetNumberOfPoints() != pd1->GetNumberOfPoints() ||
+      pd0->GetNumberOfCells() != pd1->GetNumberOfCells())
+    {
+    std::cerr << "Outputs have " << pd0->GetNumberOfPoints() << " and "
+              << pd1->GetNumberOfPoints() << " points, " << pd0->GetNumberOfCells()
+              << " and " << pd1->GetNumberOfCells() << " cells" << endl;
+    return 0;
+    }
+  for (vtkIdType i = 0; i < pd0->GetNumberOfPoints(); i++)
+    {
+    double x0[3], x1[3];
+    pd0->GetPoint(i, x0);
+    pd1->GetPoint(i, x1);
+    if (x0[0] != x1[0] || x0[1] != x1[1] || x0[2] != x1[2])
+      {
+      std::cerr << "Point " << i << " differs" << endl;
+      return 0;
+      }
+    }
+  for (vtkIdType i = 0; i < pd0->GetNumberOfCells(); i++)
+    {
+    vtkIdType npts0, *pts0, npts1, *pts1;
+    pd0->GetCellPoints(i, npts0, pts0);
+    pd1->GetCellPoints(i, npts1, pts1);
+    if (npts0 != npts1 || !std::equal(pts0, pts0+npts0, pts1))
+      {
+      std::cerr << "Cell " << i << " differs" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// The OBB tree and the bounding box tree searches give the same lines and
+// split surfaces
+static int CompareSearchModes(vtkSphereSource *source0, vtkSphereSource *source1)
+{
+  vtkSmartPointer<vtkSVLoopIntersectionPolyDataFilter> filters[2];
+  for (int i = 0; i < 2; i++)
+    {
+    filters[i] = vtkSmartPointer<vtkSVLoopIntersectionPolyDataFilter>::New();
+    filters[i]->SetInputConnection( 0, source0->GetOutputPort() );
+    filters[i]->SetInputConnection( 1, source1->GetOutputPort() );
+    filters[i]->SetUseOBBTree(i);
+    filters[i]->Update();
+    }
+
+  if (filters[0]->GetNumberOfIntersectionLines() == 0)
+    {
+    std::cerr << "No intersection found" << endl;
+    return 0;
+    }
+  for (int port = 0; port < 3; port++)
+    {
+    if (!CompareOutputs(filters[0]->GetOutput(port), filters[1]->GetOutput(port)))
+      {
+      std::cerr << "Output " << port << " depends on the search" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// Dropping the pairs the exact predicates separate does not change the lines
+// and split surfaces of meshes that cross
+static int CompareExactPredicates(vtkSphereSource *source0, vtkSphereSource *source1)
+{
+  vtkSmartPointer<vtkSVLoopIntersectionPolyDataFilter> filters[2];
+  for (int i = 0; i < 2; i++)
+    {
+    filters[i] = vtkSmartPointer<vtkSVLoopIntersectionPolyDataFilter>::New();
+    filters[i]->SetInputConnection( 0, source0->GetOutputPort() );
+    filters[i]->SetInputConnection( 1, source1->GetOutputPort() );
+    filters[i]->SetUseOBBTree(0);
+    filters[i]->SetUseExactPredicates(i);
+    filters[i]->Update();
+    }
+
+  if (filters[0]->GetNumberOfIntersectionLines() == 0)
+    {
+    std::cerr << "No intersection found" << endl;
+    return 0;
+    }
+  for (int port = 0; port < 3; port++)
+    {
+    if (!CompareOutputs(filters[0]->GetOutput(port), filters[1]->GetOutput(port)))
+      {
+      std::cerr << "Output " << port << " depends on the exact predicates" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
 int TestLoopIntersectionPolyDataFilter(int argc, char *argv[])
 {
   vtkSmartPointer<vtkSphereSource> sphereSource1 =
@@ -64,6 +165,24 @@ int TestLoopIntersectionPolyDataFilter(int argc, char *argv[])
     vtkSmartPointer<vtkSphereSource>::New();
   sphereSource2->SetCenter(1.0, 0.0, 0.0);
   sphereSource2->SetRadius(2.0);
+  sphereSource2->Update();
+
+  // A smaller sphere off the axes crosses the first one at other angles
+  vtkSmartPointer<vtkSphereSource> sphereSource3 =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphereSource3->SetCenter(0.7, 0.4, 0.2);
+  sphereSource3->SetRadius(1.5);
+  sphereSource3->SetPhiResolution(13);
+  sphereSource3->SetThetaResolution(17);
+  sphereSource3->Update();
+
+  if (!CompareSearchModes(sphereSource1, sphereSource2) ||
+      !CompareExactPredicates(sphereSource1, sphereSource2) ||
+      !CompareExactPredicates(sphereSource1, sphereSource3))
+    {
+    return EXIT_FAILURE;
+    }
+
   vtkSmartPointer<vtkPolyDataMapper> sphere2Mapper =
     vtkSmartPointer<vtkPolyDataMapper>::New();
   sphere2Mapper->SetInputConnection( sphereSource2->GetOutputPort() );
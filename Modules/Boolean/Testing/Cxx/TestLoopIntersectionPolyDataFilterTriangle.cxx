@@ -0,0 +1,140 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vtkSVLoopIntersectionPolyDataFilter.h>
+
+#include <vtkCellArray.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTriangle.h>
+
+#include <cmath>
+
+// Total area of the triangles, -1 if there is another cell type
+static double SurfaceArea(vtkPolyData *pd)
+{
+  double area = 0.0;
+  for (vtkIdType i = 0; i < pd->GetNumberOfCells(); i++)
+    {
+    vtkIdType npts, *pts;
+    pd->GetCellPoints(i, npts, pts);
+    if (npts != 3)
+      {
+      return -1.0;
+      }
+    double x0[3], x1[3], x2[3];
+    pd->GetPoint(pts[0], x0);
+    pd->GetPoint(pts[1], x1);
+    pd->GetPoint(pts[2], x2);
+    area += vtkTriangle::TriangleArea(x0, x1, x2);
+    }
+  return area;
+}
+
+// Splits both spheres along their intersection, the cells crossed by the
+// lines are triangulated with Triangle. The split surfaces must be all
+// triangles with the same area as the inputs.
+static int TestSplit(vtkSphereSource *source0, vtkSphereSource *source1)
+{
+  vtkSmartPointer<vtkSVLoopIntersectionPolyDataFilter> filter =
+    vtkSmartPointer<vtkSVLoopIntersectionPolyDataFilter>::New();
+  filter->SetInputConnection( 0, source0->GetOutputPort() );
+  filter->SetInputConnection( 1, source1->GetOutputPort() );
+  filter->SplitFirstOutputOn();
+  filter->SplitSecondOutputOn();
+  filter->Update();
+
+  if (filter->GetStatus() != 1 || filter->GetNumberOfIntersectionLines() == 0)
+    {
+    std::cerr << "Intersection failed" << endl;
+    return 0;
+    }
+
+  vtkPolyData *inputs[2] = {source0->GetOutput(), source1->GetOutput()};
+  for (int i = 0; i < 2; i++)
+    {
+    vtkPolyData *split = filter->GetOutput(i+1);
+    if (split->GetNumberOfCells() <= inputs[i]->GetNumberOfCells())
+      {
+      std::cerr << "Surface " << i << " was not split" << endl;
+      return 0;
+      }
+    double area      = SurfaceArea(split);
+    double inputArea = SurfaceArea(inputs[i]);
+    if (area < 0.0)
+      {
+      std::cerr << "Split surface " << i << " has cells that are not triangles" << endl;
+      return 0;
+      }
+    if (fabs(area - inputArea) > 1.0e-8*inputArea)
+      {
+      std::cerr << "Split surface " << i << " has area " << area
+                << ", input has " << inputArea << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+int TestLoopIntersectionPolyDataFilterTriangle(int argc, char *argv[])
+{
+  vtkSmartPointer<vtkSphereSource> sphereSource1 =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphereSource1->SetCenter(0.0, 0.0, 0.0);
+  sphereSource1->SetRadius(2.0);
+  sphereSource1->SetPhiResolution(11);
+  sphereSource1->SetThetaResolution(21);
+  sphereSource1->Update();
+
+  vtkSmartPointer<vtkSphereSource> sphereSource2 =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphereSource2->SetCenter(1.0, 0.0, 0.0);
+  sphereSource2->SetRadius(2.0);
+  sphereSource2->Update();
+
+  // Finer sphere, so some cells of the first one are crossed by many lines
+  vtkSmartPointer<vtkSphereSource> sphereSource3 =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphereSource3->SetCenter(0.7, 0.4, 0.2);
+  sphereSource3->SetRadius(1.5);
+  sphereSource3->SetPhiResolution(40);
+  sphereSource3->SetThetaResolution(60);
+  sphereSource3->Update();
+
+  if (!TestSplit(sphereSource1, sphereSource2) ||
+      !TestSplit(sphereSource1, sphereSource3))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,437 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVMultiplePolyDataIntersectionFilter.h"
+#include "vtkSVLoopBooleanPolyDataFilter.h"
+
+#include <vtkBoundingBox.h>
+#include <vtkCellData.h>
+#include <vtkCylinderSource.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkIntArray.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+
+#include <map>
+#include <vector>
+
+// Gives the test access to the intersection table and PostSetGlobalArrays
+class IntersectionFilterTester : public vtkSVMultiplePolyDataIntersectionFilter
+{
+public:
+  static IntersectionFilterTester *New();
+  vtkTypeMacro(IntersectionFilterTester, vtkSVMultiplePolyDataIntersectionFilter);
+
+  int BuildIntersectionTable(vtkPolyData* inputs[], int numInputs)
+    {
+    return this->Superclass::BuildIntersectionTable(inputs, numInputs);
+    }
+  int GetIntersectionEntry(int i, int j)
+    {
+    return this->Superclass::GetIntersectionEntry(i, j);
+    }
+  void PostSetGlobalArrays(vtkPolyData *result, int numIntersections)
+    {
+    this->Superclass::PostSetGlobalArrays(result, numIntersections);
+    }
+};
+vtkStandardNewMacro(IntersectionFilterTester);
+
+static vtkPolyData* GetSphere(const double center[3], double radius)
+{
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetCenter(center[0], center[1], center[2]);
+  sphere->SetRadius(radius);
+  sphere->SetPhiResolution(15);
+  sphere->SetThetaResolution(15);
+  sphere->Update();
+
+  vtkPolyData *output = vtkPolyData::New();
+  output->DeepCopy(sphere->GetOutput());
+  return output;
+}
+
+// Thin cylinder along x = y, moved by offset
+static vtkPolyData* GetDiagonalCylinder(double offset)
+{
+  vtkSmartPointer<vtkCylinderSource> cylinder =
+    vtkSmartPointer<vtkCylinderSource>::New();
+  cylinder->SetHeight(4.0);
+  cylinder->SetRadius(0.1);
+  cylinder->SetResolution(20);
+
+  vtkSmartPointer<vtkTransform> transform =
+    vtkSmartPointer<vtkTransform>::New();
+  transform->Translate(offset, -offset, 0.0);
+  transform->RotateZ(-45.0);
+
+  vtkSmartPointer<vtkTransformPolyDataFilter> transformer =
+    vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  transformer->SetInputConnection(cylinder->GetOutputPort());
+  transformer->SetTransform(transform);
+  transformer->Update();
+
+  vtkPolyData *output = vtkPolyData::New();
+  output->DeepCopy(transformer->GetOutput());
+  return output;
+}
+
+static int RunUnion(const double centers[][3], const double radii[],
+                    int numInputs, int useTreeReduction, vtkPolyData *output)
+{
+  // New inputs every time, the filter adds arrays to them
+  vtkSmartPointer<vtkSVMultiplePolyDataIntersectionFilter> unioner =
+    vtkSmartPointer<vtkSVMultiplePolyDataIntersectionFilter>::New();
+  for (int i = 0; i < numInputs; i++)
+    {
+    vtkPolyData *sphere = GetSphere(centers[i], radii[i]);
+    unioner->AddInputData(sphere);
+    sphere->Delete();
+    }
+  unioner->SetPassInfoAsGlobal(1);
+  unioner->SetAssignSurfaceIds(1);
+  unioner->SetNoIntersectionOutput(1);
+  unioner->SetUseTreeReduction(useTreeReduction);
+  unioner->Update();
+  if (unioner->GetStatus() != 1)
+    {
+    std::cerr << "Union failed with UseTreeReduction " << useTreeReduction
+              << std::endl;
+    return 0;
+    }
+
+  output->DeepCopy(unioner->GetOutput());
+  return 1;
+}
+
+// Number of points or cells with each value of the array
+static int CountValues(vtkDataSetAttributes *data, const char *name,
+                       std::map<int, int> &counts)
+{
+  vtkIntArray *array = vtkIntArray::SafeDownCast(data->GetArray(name));
+  if (array == NULL)
+    {
+    std::cerr << "No array " << name << " on the output" << std::endl;
+    return 0;
+    }
+  counts.clear();
+  for (vtkIdType i = 0; i < array->GetNumberOfTuples(); i++)
+    {
+    counts[array->GetValue(i)]++;
+    }
+  return 1;
+}
+
+static int CompareValues(vtkDataSetAttributes *data0,
+                         vtkDataSetAttributes *data1, const char *name)
+{
+  std::map<int, int> counts0, counts1;
+  if (!CountValues(data0, name, counts0) || !CountValues(data1, name, counts1))
+    {
+    return 0;
+    }
+  if (counts0 != counts1)
+    {
+    std::cerr << "Values of " << name << " differ between the sequential "
+              << "and the tree union" << std::endl;
+    return 0;
+    }
+  return 1;
+}
+
+static int CompareUnions(const double centers[][3], const double radii[],
+                         int numInputs)
+{
+  vtkSmartPointer<vtkPolyData> sequential = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkPolyData> tree = vtkSmartPointer<vtkPolyData>::New();
+  if (!RunUnion(centers, radii, numInputs, 0, sequential) ||
+      !RunUnion(centers, radii, numInputs, 1, tree))
+    {
+    return 0;
+    }
+
+  if (sequential->GetNumberOfPoints() != tree->GetNumberOfPoints() ||
+      sequential->GetNumberOfCells() != tree->GetNumberOfCells())
+    {
+    std::cerr << "Sequential union has " << sequential->GetNumberOfPoints()
+              << " points and " << sequential->GetNumberOfCells()
+              << " cells, tree union " << tree->GetNumberOfPoints()
+              << " points and " << tree->GetNumberOfCells() << " cells"
+              << std::endl;
+    return 0;
+    }
+
+  // Every input keeps its surface id
+  std::map<int, int> surfaceIds;
+  if (!CountValues(tree->GetCellData(), "ModelFaceID", surfaceIds))
+    {
+    return 0;
+    }
+  if ((int) surfaceIds.size() != numInputs)
+    {
+    std::cerr << "Tree union has " << surfaceIds.size() << " surface ids, "
+              << "expected " << numInputs << std::endl;
+    return 0;
+    }
+
+  if (!CompareValues(sequential->GetCellData(), tree->GetCellData(), "ModelFaceID") ||
+      !CompareValues(sequential->GetCellData(), tree->GetCellData(), "BooleanRegion") ||
+      !CompareValues(sequential->GetCellData(), tree->GetCellData(), "GlobalBoundaryCells") ||
+      !CompareValues(sequential->GetPointData(), tree->GetPointData(), "GlobalBoundaryPoints"))
+    {
+    return 0;
+    }
+  return 1;
+}
+
+static int TestPostSetGlobalArrays()
+{
+  double centers[2][3] = {{-0.3, 0.0, 0.0}, {0.3, 0.0, 0.0}};
+  vtkPolyData *sphere0 = GetSphere(centers[0], 1.0);
+  vtkPolyData *sphere1 = GetSphere(centers[1], 1.0);
+  vtkSmartPointer<vtkSVLoopBooleanPolyDataFilter> boolFilter =
+    vtkSmartPointer<vtkSVLoopBooleanPolyDataFilter>::New();
+  boolFilter->SetOperationToUnion();
+  boolFilter->SetInputData(0, sphere0);
+  boolFilter->SetInputData(1, sphere1);
+  boolFilter->Update();
+  sphere0->Delete();
+  sphere1->Delete();
+
+  vtkSmartPointer<IntersectionFilterTester> tester =
+    vtkSmartPointer<IntersectionFilterTester>::New();
+
+  // The first union takes the boundary of the boolean
+  vtkSmartPointer<vtkPolyData> first = vtkSmartPointer<vtkPolyData>::New();
+  first->DeepCopy(boolFilter->GetOutput());
+  vtkSmartPointer<vtkIntArray> boundaryCells =
+    vtkSmartPointer<vtkIntArray>::New();
+  boundaryCells->DeepCopy(first->GetCellData()->GetArray("BoundaryCells"));
+  tester->PostSetGlobalArrays(first, 1);
+  vtkIntArray *globalCells = vtkIntArray::SafeDownCast(
+    first->GetCellData()->GetArray("GlobalBoundaryCells"));
+  if (globalCells == NULL)
+    {
+    std::cerr << "No global boundary cells after the first union" << std::endl;
+    return 0;
+    }
+  for (vtkIdType i = 0; i < first->GetNumberOfCells(); i++)
+    {
+    if (globalCells->GetValue(i) != boundaryCells->GetValue(i))
+      {
+      std::cerr << "Global boundary of cell " << i << " is not the boundary "
+                << "of the first union" << std::endl;
+      return 0;
+      }
+    }
+
+  // Later unions add the new boundary to the global one
+  vtkSmartPointer<vtkPolyData> later = vtkSmartPointer<vtkPolyData>::New();
+  later->DeepCopy(boolFilter->GetOutput());
+  vtkSmartPointer<vtkIntArray> oldCells = vtkSmartPointer<vtkIntArray>::New();
+  oldCells->SetName("GlobalBoundaryCells");
+  for (vtkIdType i = 0; i < later->GetNumberOfCells(); i++)
+    {
+    oldCells->InsertValue(i, i%2);
+    }
+  later->GetCellData()->AddArray(oldCells);
+  vtkSmartPointer<vtkIntArray> oldPoints = vtkSmartPointer<vtkIntArray>::New();
+  oldPoints->SetName("GlobalBoundaryPoints");
+  for (vtkIdType i = 0; i < later->GetNumberOfPoints(); i++)
+    {
+    oldPoints->InsertValue(i, i%2);
+    }
+  later->GetPointData()->AddArray(oldPoints);
+
+  tester->PostSetGlobalArrays(later, 2);
+  globalCells = vtkIntArray::SafeDownCast(
+    later->GetCellData()->GetArray("GlobalBoundaryCells"));
+  vtkIntArray *globalPoints = vtkIntArray::SafeDownCast(
+    later->GetPointData()->GetArray("GlobalBoundaryPoints"));
+  vtkIntArray *boundaryPoints = vtkIntArray::SafeDownCast(
+    later->GetPointData()->GetArray("BoundaryPoints"));
+  for (vtkIdType i = 0; i < later->GetNumberOfCells(); i++)
+    {
+    int expected = (i%2 == 1 || boundaryCells->GetValue(i) == 1) ? 1 : 0;
+    if (globalCells->GetValue(i) != expected)
+      {
+      std::cerr << "Global boundary of cell " << i << " is not the old "
+                << "global boundary or the new boundary" << std::endl;
+      return 0;
+      }
+    }
+  for (vtkIdType i = 0; i < later->GetNumberOfPoints(); i++)
+    {
+    int expected = (i%2 == 1 || boundaryPoints->GetValue(i) == 1) ? 1 : 0;
+    if (globalPoints->GetValue(i) != expected)
+      {
+      std::cerr << "Global boundary of point " << i << " is not the old "
+                << "global boundary or the new boundary" << std::endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+static int TestIntersectionTable()
+{
+  // Two parallel diagonal cylinders whose axis aligned boxes overlap while
+  // their oriented boxes do not, and spheres where some overlap
+  double centers[4][3] = {{5.0, 0.0, 0.0}, {6.5, 0.0, 0.0},
+                          {5.0, 5.0, 0.0}, {6.5, 1.5, 0.0}};
+  std::vector<vtkSmartPointer<vtkPolyData> > surfaces;
+  surfaces.push_back(vtkSmartPointer<vtkPolyData>::Take(GetDiagonalCylinder(0.0)));
+  surfaces.push_back(vtkSmartPointer<vtkPolyData>::Take(GetDiagonalCylinder(0.6)));
+  for (int i = 0; i < 4; i++)
+    {
+    surfaces.push_back(vtkSmartPointer<vtkPolyData>::Take(GetSphere(centers[i], 1.0)));
+    }
+  int numInputs = surfaces.size();
+  std::vector<vtkPolyData*> inputs(numInputs);
+  for (int i = 0; i < numInputs; i++)
+    {
+    inputs[i] = surfaces[i];
+    }
+
+  // Dense table like the one the filter used to keep
+  std::vector<std::vector<int> > dense(numInputs, std::vector<int>(numInputs, 0));
+  int numDense = 0;
+  for (int i = 0; i < numInputs; i++)
+    {
+    inputs[i]->ComputeBounds();
+    vtkBoundingBox boundingBox0(inputs[i]->GetBounds());
+    for (int j = 0; j < numInputs; j++)
+      {
+      vtkBoundingBox boundingBox1(inputs[j]->GetBounds());
+      if (i != j && boundingBox0.Intersects(boundingBox1))
+        {
+        dense[i][j] = 1;
+        numDense++;
+        }
+      }
+    }
+  if (!dense[0][1])
+    {
+    std::cerr << "Boxes of the cylinders should overlap" << std::endl;
+    return 0;
+    }
+
+  vtkSmartPointer<IntersectionFilterTester> tester =
+    vtkSmartPointer<IntersectionFilterTester>::New();
+  int numSparse = tester->BuildIntersectionTable(&inputs[0], numInputs);
+  if (numSparse != numDense)
+    {
+    std::cerr << "Sparse table has " << numSparse << " entries, dense table "
+              << numDense << std::endl;
+    return 0;
+    }
+  for (int i = 0; i < numInputs; i++)
+    {
+    for (int j = 0; j < numInputs; j++)
+      {
+      if ((tester->GetIntersectionEntry(i, j) != -1) != (dense[i][j] == 1))
+        {
+        std::cerr << "Sparse and dense tables differ for " << i << " and "
+                  << j << std::endl;
+        return 0;
+        }
+      }
+    }
+
+  // The oriented boxes only drop pairs
+  tester->UseOrientedBoundingBoxesOn();
+  tester->BuildIntersectionTable(&inputs[0], numInputs);
+  for (int i = 0; i < numInputs; i++)
+    {
+    for (int j = 0; j < numInputs; j++)
+      {
+      if (tester->GetIntersectionEntry(i, j) != -1 && dense[i][j] == 0)
+        {
+        std::cerr << "Oriented boxes added the pair " << i << " and " << j
+                  << std::endl;
+        return 0;
+        }
+      }
+    }
+  if (tester->GetIntersectionEntry(0, 1) != -1 ||
+      tester->GetIntersectionEntry(1, 0) != -1)
+    {
+    std::cerr << "Oriented boxes of the cylinders should not overlap"
+              << std::endl;
+    return 0;
+    }
+  if (tester->GetIntersectionEntry(2, 3) == -1 ||
+      tester->GetIntersectionEntry(3, 5) == -1)
+    {
+    std::cerr << "Oriented boxes dropped spheres that intersect" << std::endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestMultiplePolyDataIntersectionFilter(int argc, char *argv[])
+{
+  if (!TestIntersectionTable())
+    {
+    return EXIT_FAILURE;
+    }
+  if (!TestPostSetGlobalArrays())
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A chain, unioned in the same order by both
+  double chainCenters[3][3] = {{0.0, 0.0, 0.0}, {1.2, 0.0, 0.0},
+                               {2.4, 0.1, 0.0}};
+  double chainRadii[3] = {0.8, 0.8, 0.8};
+  if (!CompareUnions(chainCenters, chainRadii, 3))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Three spheres around a center one that do not touch each other, the
+  // tree takes one round for each
+  double starCenters[4][3] = {{0.0, 0.0, 0.0}, {1.5, 0.0, 0.0},
+                              {-1.5, 0.0, 0.0}, {0.0, 1.5, 0.1}};
+  double starRadii[4] = {1.0, 0.8, 0.8, 0.8};
+  if (!CompareUnions(starCenters, starRadii, 4))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -649,8 +649,18 @@ REAL iccerrboundA, iccerrboundB, iccerrboundC;
 REAL o3derrboundA, o3derrboundB, o3derrboundC;
 
 /* Random number seed is not constant, but I've made it global anyway.       */
-
+/*   With TRIANGLE_REENTRANT it is kept per thread, so several threads can   */
+/*   triangulate at once.                                                    */
+
+#ifdef TRIANGLE_REENTRANT
+#ifdef _MSC_VER
+__declspec(thread) unsigned long randomseed;
+#else /* not _MSC_VER */
+__thread unsigned long randomseed;
+#endif /* not _MSC_VER */
+#else /* not TRIANGLE_REENTRANT */
 unsigned long randomseed;                     /* Current random number seed. */
+#endif /* not TRIANGLE_REENTRANT */
 
 
 /* Mesh data structure.  Triangle operates on only one mesh, but the mesh    */
@@ -1407,6 +1417,17 @@ REAL area;                                      /* The area of the triangle. */
 /**                                                                         **/
 /**                                                                         **/
 
+#ifdef TRIANGLE_REENTRANT
+
+/* With TRIANGLE_REENTRANT the caller provides the memory allocation, so     */
+/*   memory can be reused between meshes, and must call exactinit() once    */
+/*   before the first mesh is made.                                          */
+
+void *triexternalmalloc(int size);
+void triexternalfree(void *memptr);
+
+#endif /* TRIANGLE_REENTRANT */
+
 #ifdef ANSI_DECLARATORS
 void triexit(int status)
 #else /* not ANSI_DECLARATORS */
@@ -1428,7 +1449,11 @@ int size;
 {
   VOID *memptr;
 
+#ifdef TRIANGLE_REENTRANT
+  memptr = (VOID *) triexternalmalloc(size);
+#else /* not TRIANGLE_REENTRANT */
   memptr = (VOID *) malloc((unsigned int) size);
+#endif /* not TRIANGLE_REENTRANT */
   if (memptr == (VOID *) NULL) {
     printf("Error:  Out of memory.\n");
     triexit(1);
@@ -1444,7 +1469,11 @@ VOID *memptr;
 #endif /* not ANSI_DECLARATORS */
 
 {
+#ifdef TRIANGLE_REENTRANT
+  triexternalfree((void *) memptr);
+#else /* not TRIANGLE_REENTRANT */
   free(memptr);
+#endif /* not TRIANGLE_REENTRANT */
 }
 
 /**                                                                         **/
@@ -6653,7 +6682,9 @@ struct mesh *m;
   m->hyperbolacount = m->circletopcount = m->circumcentercount = 0;
   randomseed = 1;
 
+#ifndef TRIANGLE_REENTRANT
   exactinit();                     /* Initialize exact arithmetic constants. */
+#endif /* not TRIANGLE_REENTRANT */
 }
 
 /*****************************************************************************/
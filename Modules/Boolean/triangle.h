@@ -287,3 +287,9 @@ void trifree(VOID *memptr);
 void triangulate();
 void trifree();
 #endif /* not ANSI_DECLARATORS */
+
+#ifdef TRIANGLE_REENTRANT
+/* The caller allocates memory through triexternalmalloc() and              */
+/*   triexternalfree() and calls exactinit() once before triangulating.     */
+void exactinit();
+#endif /* TRIANGLE_REENTRANT */
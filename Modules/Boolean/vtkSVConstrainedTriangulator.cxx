@@ -0,0 +1,245 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVConstrainedTriangulator.h"
+
+#include "vtkSVGlobals.h"
+
+#include <cstdlib>
+#include <cstring>
+
+extern "C"
+{
+#define ANSI_DECLARATORS
+#ifndef VOID
+# define VOID void
+#endif
+#ifndef REAL
+# define REAL double
+#endif
+#include "triangle.h"
+}
+
+namespace
+{
+
+// Most blocks kept for reuse by one triangulator
+const size_t MaximumCachedBlocks = 64;
+
+// Size of the header stored in front of every block, keeps the alignment
+// of malloc
+const size_t BlockHeaderSize = 16;
+
+// Cache of the triangulator running on this thread, NULL if there is none
+thread_local vtkSVConstrainedTriangulator::BlockCache *CurrentCache = NULL;
+
+// ----------------------
+// GetBlockSize
+// ----------------------
+size_t &GetBlockSize(void *block)
+{
+  return *static_cast<size_t *>(block);
+}
+
+// ----------------------
+// CacheScope
+// ----------------------
+// Makes a cache current on this thread while it is in scope.
+class CacheScope
+{
+public:
+  CacheScope(vtkSVConstrainedTriangulator::BlockCache *cache)
+  {
+    this->Previous = CurrentCache;
+    CurrentCache = cache;
+  }
+  ~CacheScope()
+  {
+    CurrentCache = this->Previous;
+  }
+
+private:
+  vtkSVConstrainedTriangulator::BlockCache *Previous;
+};
+
+// ----------------------
+// InitializeTriangle
+// ----------------------
+int InitializeTriangle()
+{
+  exactinit();
+  return 1;
+}
+
+}
+
+// ----------------------
+// triexternalmalloc
+// ----------------------
+/// \brief Allocation used by Triangle. Gives back the smallest block cached
+/// by the current triangulator that is big enough, but not more than twice
+/// the size asked for.
+extern "C" void *triexternalmalloc(int size)
+{
+  size_t needed = static_cast<size_t>(size);
+  if (CurrentCache != NULL)
+    {
+    std::vector<void *> &blocks = CurrentCache->Blocks;
+    size_t best = blocks.size();
+    for (size_t i = 0; i < blocks.size(); i++)
+      {
+      size_t blockSize = GetBlockSize(blocks[i]);
+      if (blockSize >= needed && blockSize <= 2*needed + BlockHeaderSize &&
+          (best == blocks.size() || blockSize < GetBlockSize(blocks[best])))
+        {
+        best = i;
+        }
+      }
+    if (best != blocks.size())
+      {
+      void *block = blocks[best];
+      blocks[best] = blocks.back();
+      blocks.pop_back();
+      return static_cast<char *>(block) + BlockHeaderSize;
+      }
+    }
+
+  void *block = malloc(needed + BlockHeaderSize);
+  if (block == NULL)
+    {
+    return NULL;
+    }
+  GetBlockSize(block) = needed;
+  return static_cast<char *>(block) + BlockHeaderSize;
+}
+
+// ----------------------
+// triexternalfree
+// ----------------------
+/// \brief Free used by Triangle. Keeps the block for the current
+/// triangulator if there is one and it has room.
+extern "C" void triexternalfree(void *memptr)
+{
+  if (memptr == NULL)
+    {
+    return;
+    }
+  void *block = static_cast<char *>(memptr) - BlockHeaderSize;
+  if (CurrentCache != NULL && CurrentCache->Blocks.size() < MaximumCachedBlocks)
+    {
+    CurrentCache->Blocks.push_back(block);
+    return;
+    }
+  free(block);
+}
+
+// ----------------------
+// Constructor
+// ----------------------
+vtkSVConstrainedTriangulator::vtkSVConstrainedTriangulator()
+{
+  // The exact arithmetic constants are global, set them once
+  static const int initialized = InitializeTriangle();
+  (void) initialized;
+}
+
+// ----------------------
+// Destructor
+// ----------------------
+vtkSVConstrainedTriangulator::~vtkSVConstrainedTriangulator()
+{
+  this->ReleaseMemory();
+}
+
+// ----------------------
+// ReleaseMemory
+// ----------------------
+void vtkSVConstrainedTriangulator::ReleaseMemory()
+{
+  for (size_t i = 0; i < this->Cache.Blocks.size(); i++)
+    {
+    free(this->Cache.Blocks[i]);
+    }
+  this->Cache.Blocks.clear();
+}
+
+// ----------------------
+// Triangulate
+// ----------------------
+int vtkSVConstrainedTriangulator::Triangulate(const int numberOfPoints,
+                                              const double *points,
+                                              const int numberOfSegments,
+                                              const int *segments,
+                                              const int numberOfHoles,
+                                              const double *holes,
+                                              std::vector<int> &triangles)
+{
+  triangles.clear();
+  this->Points.assign(points, points + 2*numberOfPoints);
+  if (numberOfPoints < 3)
+    {
+    return SV_ERROR;
+    }
+
+  CacheScope scope(&this->Cache);
+
+  // Triangle does not change or free the input lists
+  struct triangulateio in, out;
+  memset(&in, 0, sizeof(struct triangulateio));
+  memset(&out, 0, sizeof(struct triangulateio));
+  in.numberofpoints   = numberOfPoints;
+  in.pointlist        = const_cast<double *>(points);
+  in.numberofsegments = numberOfSegments;
+  in.segmentlist      = const_cast<int *>(segments);
+  in.numberofholes    = numberOfHoles;
+  in.holelist         = const_cast<double *>(holes);
+
+  // z: number from zero, Q: quiet, B: no boundary markers, P: no output
+  // segments, p: use the segments
+  char switches[8];
+  strcpy(switches, numberOfSegments > 0 ? "pzQBP" : "zQBP");
+  triangulate(switches, &in, &out, (struct triangulateio *) NULL);
+
+  triangles.assign(out.trianglelist, out.trianglelist + 3*out.numberoftriangles);
+  if (out.numberofpoints > numberOfPoints)
+    {
+    this->Points.insert(this->Points.end(), out.pointlist + 2*numberOfPoints,
+                        out.pointlist + 2*out.numberofpoints);
+    }
+
+  trifree(out.trianglelist);
+  trifree(out.pointlist);
+  trifree(out.pointmarkerlist);
+  trifree(out.segmentlist);
+  trifree(out.segmentmarkerlist);
+
+  return SV_OK;
+}
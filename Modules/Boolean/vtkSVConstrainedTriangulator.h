@@ -0,0 +1,105 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class vtkSVConstrainedTriangulator
+ *  \brief Constrained Delaunay triangulation of planar points and segments
+ *  with Shewchuk's Triangle library.
+ *
+ *  Points, segments and holes are given as plain arrays and the triangles
+ *  are returned as point ids, nothing goes through vtkPolyData. The memory
+ *  Triangle uses for its mesh is kept by the triangulator when Triangle
+ *  frees it and given back on the next call, so one triangulator should be
+ *  kept and reused for many small triangulations. A triangulator can only
+ *  be used by one thread at a time, but different threads can each use
+ *  their own at the same time.
+ *
+ *  Triangle must be built with TRIANGLE_REENTRANT.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVConstrainedTriangulator_h
+#define vtkSVConstrainedTriangulator_h
+
+#include "vtkSVBooleanModule.h" // For export macro
+
+#include <vector>
+
+class VTKSVBOOLEAN_EXPORT vtkSVConstrainedTriangulator
+{
+public:
+  vtkSVConstrainedTriangulator();
+  ~vtkSVConstrainedTriangulator();
+
+  /** \brief Triangulate points in the plane, keeping the segments as edges.
+   *  \param numberOfPoints Number of points.
+   *  \param points x and y of each point.
+   *  \param numberOfSegments Number of segments, zero for an unconstrained
+   *  triangulation of the convex hull.
+   *  \param segments Two point ids for each segment.
+   *  \param numberOfHoles Number of holes.
+   *  \param holes x and y of one point inside each hole. Triangles in a
+   *  region enclosed by segments that contains a hole point are removed.
+   *  \param triangles Filled with three point ids for each triangle. Ids past
+   *  the input points are points Triangle added where segments cross, see
+   *  GetPoints.
+   *  \return SV_OK, or SV_ERROR if there were less than three points. */
+  int Triangulate(const int numberOfPoints, const double *points,
+                  const int numberOfSegments, const int *segments,
+                  const int numberOfHoles, const double *holes,
+                  std::vector<int> &triangles);
+
+  /** \brief x and y of every point of the last triangulation, the input
+   *  points first followed by any points Triangle added. */
+  const std::vector<double> &GetPoints() const {return this->Points;}
+
+  /** \brief Give the memory kept for reuse back to the system. */
+  void ReleaseMemory();
+
+  /// \brief Memory blocks kept for reuse.
+  struct BlockCache
+  {
+    std::vector<void *> Blocks;
+  };
+
+private:
+  vtkSVConstrainedTriangulator(const vtkSVConstrainedTriangulator&);  // Not implemented.
+  void operator=(const vtkSVConstrainedTriangulator&);  // Not implemented.
+
+  BlockCache          Cache;
+  std::vector<double> Points;
+};
+
+#endif
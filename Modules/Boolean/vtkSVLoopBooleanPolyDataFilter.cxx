@@ -33,8 +33,9 @@
 
 #include "vtkAppendPolyData.h"
 #include "vtkCellArray.h"
+#include "vtkCallbackCommand.h"
 #include "vtkCellData.h"
-#include "vtkDataSetSurfaceFilter.h"
+#include "vtkDataSetAttributes.h"
 #include "vtkGenericCell.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
@@ -43,19 +44,22 @@
 #include "vtkPointData.h"
 #include "vtkPointLocator.h"
 #include "vtkPolyDataNormals.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkSVBoundingBoxTree.h"
 #include "vtkSVGlobals.h"
 #include "vtkSVLoopIntersectionPolyDataFilter.h"
 #include "vtkTransform.h"
-#include "vtkTransformPolyDataFilter.h"
-#include "vtkThreshold.h"
 #include "vtkTriangle.h"
-#include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <sstream>
 #include <iostream>
 #include <list>
+#include <set>
+#include <vector>
 
 //----------------------------------------------------------------------------
 // Helper typedefs and data structures.
@@ -82,6 +86,173 @@ struct simLoop
   int loopType; // closed, open
 };
 
+// ----------------------
+// ForwardProgress
+// ----------------------
+// The intersection is the first part of the boolean, pass its progress and
+// phase on to the boolean filter.
+void ForwardProgress(vtkObject *caller, unsigned long vtkNotUsed(eventId),
+                     void *clientData, void *vtkNotUsed(callData))
+{
+  vtkAlgorithm *intersector = static_cast<vtkAlgorithm*>(caller);
+  vtkAlgorithm *self = static_cast<vtkAlgorithm*>(clientData);
+  self->SetProgressText(intersector->GetProgressText());
+  self->UpdateProgress(0.6*intersector->GetProgress());
+}
+
+// ----------------------
+// RegionUnionFind
+// ----------------------
+// Lock free union find over the cells of a mesh. A root is always linked
+// under the smaller root, so every region ends up with its smallest cell id
+// as root whatever the order of the unions.
+class RegionUnionFind
+{
+public:
+  RegionUnionFind(vtkIdType numberOfCells) : Parents(numberOfCells)
+  {
+    for (vtkIdType i = 0; i < numberOfCells; i++)
+      {
+      this->Parents[i].store(i);
+      }
+  }
+
+  vtkIdType Find(vtkIdType id)
+  {
+    while (true)
+      {
+      vtkIdType parent = this->Parents[id].load();
+      if (parent == id)
+        {
+        return id;
+        }
+      // Path halving
+      vtkIdType grandParent = this->Parents[parent].load();
+      if (parent != grandParent)
+        {
+        this->Parents[id].compare_exchange_weak(parent, grandParent);
+        }
+      id = grandParent;
+      }
+  }
+
+  void Union(vtkIdType id0, vtkIdType id1)
+  {
+    while (true)
+      {
+      id0 = this->Find(id0);
+      id1 = this->Find(id1);
+      if (id0 == id1)
+        {
+        return;
+        }
+      if (id0 < id1)
+        {
+        std::swap(id0, id1);
+        }
+      vtkIdType expected = id0;
+      if (this->Parents[id0].compare_exchange_strong(expected, id1))
+        {
+        return;
+        }
+      }
+  }
+
+private:
+  std::vector<std::atomic<vtkIdType> > Parents;
+};
+
+// ----------------------
+// UnionPointNeighbors
+// ----------------------
+// Joins every cell away from the intersection with all cells sharing one of
+// its points, the way the flood fill used to step.
+class UnionPointNeighbors
+{
+public:
+  RegionUnionFind *UnionFind;
+  vtkIntArray     *BoundaryCells;
+  const vtkIdType *CellOffsets;
+  const vtkIdType *CellPointIds;
+  const vtkIdType *PointCellOffsets;
+  const vtkIdType *PointCellIds;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      if (this->BoundaryCells->GetValue(cellId) == 1)
+        {
+        continue;
+        }
+      for (vtkIdType i = this->CellOffsets[cellId]; i < this->CellOffsets[cellId+1]; i++)
+        {
+        vtkIdType ptId = this->CellPointIds[i];
+        for (vtkIdType j = this->PointCellOffsets[ptId]; j < this->PointCellOffsets[ptId+1]; j++)
+          {
+          this->UnionFind->Union(cellId, this->PointCellIds[j]);
+          }
+        }
+      }
+  }
+};
+
+// ----------------------
+// UnionEdgeNeighbors
+// ----------------------
+// Joins the two cells of every manifold edge that is not an intersection edge.
+class UnionEdgeNeighbors
+{
+public:
+  RegionUnionFind *UnionFind;
+  const vtkIdType *EdgeCells;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      this->UnionFind->Union(this->EdgeCells[2*i], this->EdgeCells[2*i+1]);
+      }
+  }
+};
+
+// ----------------------
+// LabelRegions
+// ----------------------
+class LabelRegions
+{
+public:
+  RegionUnionFind *UnionFind;
+  vtkIdType       *Regions;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      this->Regions[cellId] = this->UnionFind->Find(cellId);
+      }
+  }
+};
+
+// ----------------------
+// HalfEdge
+// ----------------------
+struct HalfEdge
+{
+  vtkIdType pt0; // smaller point id
+  vtkIdType pt1; // larger point id
+  vtkIdType cellId;
+
+  bool operator<(const HalfEdge &other) const
+  {
+    if (this->pt0 != other.pt0)
+      {
+      return this->pt0 < other.pt0;
+      }
+    return this->pt1 < other.pt1;
+  }
+};
+
 }
 
 // ----------------------
@@ -94,13 +265,15 @@ public:
   virtual ~Impl();
 
   void Initialize();
-  void SetCheckArrays();
   void SetBoundaryArrays();
-  void ResetCheckArrays();
+  void FindRegions(int inputIndex);
   void GetBooleanRegions(int inputIndex, std::vector<simLoop> *loops);
   void DetermineIntersection(std::vector<simLoop> *loops);
   void PerformBoolean(vtkPolyData *output, int booleanOperation);
-  void ThresholdRegions(vtkPolyData **surfaces);
+
+  /// \brief True if the two points of the intersection lines are the ends
+  /// of one intersection line.
+  bool IsIntersectionEdge(vtkIdType linePt0, vtkIdType linePt1) const;
 
 protected:
 
@@ -113,9 +286,25 @@ protected:
   int GetCellOrientation(vtkPolyData *pd, vtkIdType cellId, vtkIdType p0,
       vtkIdType p1, int index);
 
-  int FindRegion(int inputIndex, int fillnumber, int start, int fill);
+  /// \brief Fill the flat tables of the intersection lines
+  void BuildLineTable();
 
-  int FindRegionTipToe(int inputIndex, int fillnumber, int fill);
+  /// \brief Number of intersection lines using a point and their ids
+  vtkIdType GetNumberOfPointLines(vtkIdType linePt) const
+  {
+    return this->PointLineOffsets[linePt+1] - this->PointLineOffsets[linePt];
+  }
+  const vtkIdType *GetPointLines(vtkIdType linePt) const
+  {
+    return &this->PointLineIds[this->PointLineOffsets[linePt]];
+  }
+
+  /// \brief The point of a line that is not the given point
+  vtkIdType GetOtherLinePoint(vtkIdType lineId, vtkIdType linePt) const
+  {
+    return this->LinePoints[2*lineId] == linePt ?
+      this->LinePoints[2*lineId+1] : this->LinePoints[2*lineId];
+  }
 
 public:
 
@@ -129,15 +318,18 @@ public:
   vtkIntArray *BooleanArray[2];
   vtkIntArray *NewCellIds[2];
 
-  vtkIdType *Checked[2];
-  vtkIdType *CheckedCarefully[2];
   vtkIdType *PointMapper[2];
   vtkIdType *ReversePointMapper[2];
 
-  vtkIdList *CheckCells;
-  vtkIdList *CheckCells2;
-  vtkIdList *CheckCellsCareful;
-  vtkIdList *CheckCellsCareful2;
+  /// \brief The two points of every intersection line, and for every point
+  /// of the lines the lines using it, listed from PointLineOffsets.
+  std::vector<vtkIdType> LinePoints;
+  std::vector<vtkIdType> PointLineOffsets;
+  std::vector<vtkIdType> PointLineIds;
+
+  /// \brief Region of every cell of the two meshes, given as the smallest
+  /// cell id in the region. Regions are bounded by the intersection lines.
+  std::vector<vtkIdType> Regions[2];
 
   // Pointer to overarching filter
   vtkSVLoopBooleanPolyDataFilter *ParentFilter;
@@ -146,9 +338,7 @@ public:
 // ----------------------
 // Impl Constructor
 // ----------------------
-vtkSVLoopBooleanPolyDataFilter::Impl::Impl() :
-  CheckCells(0), CheckCells2(0), CheckCellsCareful(0),
-  CheckCellsCareful2(0)
+vtkSVLoopBooleanPolyDataFilter::Impl::Impl()
 {
   for (int i = 0;i<2;i++)
     {
@@ -159,16 +349,10 @@ vtkSVLoopBooleanPolyDataFilter::Impl::Impl() :
     this->BoundaryCellArray[i] = vtkIntArray::New();
     this->NewCellIds[i] = vtkIntArray::New();
 
-    this->Checked[i] = NULL;
-    this->CheckedCarefully[i] = NULL;
     this->PointMapper[i] = NULL;
     this->ReversePointMapper[i] = NULL;
     }
   this->IntersectionLines = vtkPolyData::New();
-  this->CheckCells = vtkIdList::New();
-  this->CheckCells2 = vtkIdList::New();
-  this->CheckCellsCareful = vtkIdList::New();
-  this->CheckCellsCareful2 = vtkIdList::New();
 
   //Intersection Case:
   //0 -> Only hard closed intersection loops
@@ -190,14 +374,6 @@ vtkSVLoopBooleanPolyDataFilter::Impl::~Impl()
     this->BoundaryCellArray[i]->Delete();
     this->NewCellIds[i]->Delete();
 
-    if (this->Checked[i] != NULL)
-      {
-      delete [] this->Checked[i];
-      }
-    if (this->CheckedCarefully[i] != NULL)
-      {
-      delete [] this->CheckedCarefully[i];
-      }
     if (this->PointMapper[i] != NULL)
       {
       delete [] this->PointMapper[i];
@@ -208,253 +384,6 @@ vtkSVLoopBooleanPolyDataFilter::Impl::~Impl()
       }
     }
   this->IntersectionLines->Delete();
-  this->CheckCells->Delete();
-  this->CheckCells2->Delete();
-  this->CheckCellsCareful->Delete();
-  this->CheckCellsCareful2->Delete();
-}
-
-// ----------------------
-// Impl::FindRegion
-// ----------------------
-/// \brief Flood fill algorithm to find region of mesh separated by intersection lines
-int vtkSVLoopBooleanPolyDataFilter::Impl::FindRegion(int inputIndex,
-    int fillnumber, int start, int fill)
-{
-  vtkDebugWithObjectMacro(this->ParentFilter,<<"Finding region with fill " << fillnumber <<
-    " of mesh "<<inputIndex<<" with cellID "<<this->CheckCells->GetId(0));
-
-  //Id List to store neighbor cells for each set of nodes and a cell
-  vtkNew(vtkIdList, neighbors);
-  vtkNew(vtkIdList, tmp);
-
-  //Get neighboring cell for each pair of points in current cell
-  //While there are still cells to be checked, find neighbor cells
-  vtkIdType numCheckCells;
-  while ((numCheckCells = this->CheckCells->GetNumberOfIds()) > 0)
-    {
-    for (int c=0;c<numCheckCells;c++)
-      {
-      vtkIdType cellId = this->CheckCells->GetId(c);
-      //Get the three points of the cell
-      vtkIdType *pts = 0;
-      vtkIdType npts = 0;
-      this->Mesh[inputIndex]->GetCellPoints(cellId, npts, pts);
-      if (this->Checked[inputIndex][cellId] == 0)
-        {
-        //Mark cell as checked and insert the fillnumber value to cell
-        if (fill)
-          {
-          this->BooleanArray[inputIndex]->InsertValue(cellId, fillnumber);
-          }
-        this->Checked[inputIndex][cellId] = 1;
-        for (int i=0; i < npts; i++)
-          {
-          vtkIdType p1 = pts[i];
-          //Get the cells attached to each point
-          this->Mesh[inputIndex]->GetPointCells(p1, neighbors);
-          vtkIdType numNeighbors = neighbors->GetNumberOfIds();
-
-          //For each neighboring cell
-          for (int j=0;j < numNeighbors;j++)
-            {
-            //If this cell is close to a boundary
-            if (this->BoundaryCellArray[inputIndex]->
-                GetValue(neighbors->GetId(j)))
-              {
-              //If this cell hasn't been checked already
-              if (this->CheckedCarefully[inputIndex][neighbors->
-                  GetId(j)] == 0)
-                {
-                //Add this cell to the careful check cells list and run
-                //the region finding tip toe code
-                this->CheckCellsCareful->
-                  InsertNextId(neighbors->GetId(j));
-                if (fill)
-                  {
-                  this->FindRegionTipToe(inputIndex, fillnumber, 1);
-                  }
-                else
-                  {
-                  this->FindRegionTipToe(inputIndex, fillnumber, 0);
-                  }
-                this->CheckCellsCareful->Reset();
-                this->CheckCellsCareful2->Reset();
-                }
-              }
-            //Cell needs to be added to check list
-            else
-              {
-              this->CheckCells2->InsertNextId(neighbors->GetId(j));
-              }
-            }
-          }
-        }
-      //This statement is for if the start cell is a boundary cell
-      else if (this->CheckedCarefully[inputIndex][cellId] == 0 && start)
-        {
-        start=0;
-        this->CheckCells->Reset();
-        this->CheckCellsCareful->InsertNextId(cellId);
-        if (fill)
-          {
-          this->FindRegionTipToe(inputIndex, fillnumber, 1);
-          }
-        else
-          {
-          this->FindRegionTipToe(inputIndex, fillnumber, 0);
-          }
-        }
-      }
-
-    //Swap the current check list to the full check list and continue
-    tmp = this->CheckCells;
-    this->CheckCells = this->CheckCells2;
-    this->CheckCells2 = tmp;
-    tmp->Reset();
-    }
-  return SV_OK;
-}
-
-// ----------------------
-// Impl::FindRegionTipToe
-// ----------------------
-/// \brief This is the slow version of the flood fill algorithm that is initiated
-/// when we get close to a boundary to ensure we don't cross the line
-int vtkSVLoopBooleanPolyDataFilter::Impl::FindRegionTipToe(
-    int inputIndex, int fillnumber, int fill)
-{
-  //Id List to store neighbor cells for each set of nodes and a cell
-  vtkNew(vtkIdList, tmp);
-  vtkNew(vtkIdList, neighborIds);
-
-  //Get neighboring cell for each pair of points in current cell
-  //While there are still cells to be checked
-  vtkIdType numCheckCells;
-  while ((numCheckCells = this->CheckCellsCareful->GetNumberOfIds()) > 0)
-    {
-    for (int c=0;c<numCheckCells;c++)
-      {
-      neighborIds->Reset();
-      vtkIdType cellId = this->CheckCellsCareful->GetId(c);
-      //Get the three points of the cell
-      vtkIdType *pts = 0;
-      vtkIdType npts = 0;
-      this->Mesh[inputIndex]->GetCellPoints(cellId, npts, pts);
-      //Update this cell to have been checked carefully and assign it
-      //with the fillnumber scalar
-      if (this->CheckedCarefully[inputIndex][cellId] == 0)
-        {
-        if (fill)
-          {
-          this->BooleanArray[inputIndex]->InsertValue(cellId, fillnumber);
-          }
-        this->CheckedCarefully[inputIndex][cellId] = 1;
-        //For each edge of the cell
-        vtkDebugWithObjectMacro(this->ParentFilter, <<"Checking edges of cell "<<cellId);
-        for (int i=0; i < npts; i++)
-          {
-          vtkIdType p1 = pts[i];
-          vtkIdType p2 = pts[(i+1)%(npts)];
-
-          vtkNew(vtkIdList, neighbors);
-          //Initial check to make sure the cell is in fact a face cell
-          this->Mesh[inputIndex]->
-            GetCellEdgeNeighbors(cellId, p1, p2, neighbors);
-          vtkIdType numNeighbors = neighbors->GetNumberOfIds();
-
-          //Check to make sure it is an oustide surface cell,
-          //i.e. one neighbor
-          if (numNeighbors==1)
-            {
-            int count = 0;
-              //Check to see if cell is on the boundary,
-              //if it is get adjacent lines
-            if (this->BoundaryPointArray[inputIndex]->GetValue(p1) == 1)
-              {
-              count++;
-              }
-
-            if (this->BoundaryPointArray[inputIndex]->GetValue(p2) == 1)
-              {
-              count++;
-              }
-
-            vtkIdType neighbor=neighbors->GetId(0);
-            //if cell is not on the boundary, add new cell to check list
-            if (count < 2)
-              {
-              neighborIds->InsertNextId(neighbor);
-              }
-            //if cell is on boundary, check to make sure it isn't
-            //false positive; don't add to check list. This is done by
-            //getting the boundary lines attached to each point, then
-            //intersecting the two lists. If the result is zero, then this
-            //is a false positive
-            else
-              {
-              //Variables for the boundary cells adjacent to the boundary point
-              vtkNew(vtkIdList, bLinesOne);
-              vtkNew(vtkIdList, bLinesTwo);
-
-              vtkIdType bPt1 = PointMapper[inputIndex][p1];
-              this->IntersectionLines->GetPointCells(bPt1, bLinesOne);
-
-              vtkIdType bPt2 = PointMapper[inputIndex][p2];
-              this->IntersectionLines->GetPointCells(bPt2, bLinesTwo);
-
-              bLinesOne->IntersectWith(bLinesTwo);
-              //Cell is false positive. Add to check list.
-              if (bLinesOne->GetNumberOfIds() == 0)
-                {
-                vtkDebugWithObjectMacro(this->ParentFilter, <<"False positive! "<<neighbor);
-                neighborIds->InsertNextId(neighbor);
-                }
-              else
-                {
-                vtkDebugWithObjectMacro(this->ParentFilter, <<"I have not been added because false");
-                }
-              }
-            }
-          else
-            {
-            vtkDebugWithObjectMacro(this->ParentFilter, <<"NumNei is not 1");
-            vtkDebugWithObjectMacro(this->ParentFilter, <<"Number of Neighbors "<<numNeighbors);
-            vtkDebugWithObjectMacro(this->ParentFilter, <<"Cell is "<<cellId);
-            for (int k=0;k<numNeighbors;k++)
-              {
-              vtkDebugWithObjectMacro(this->ParentFilter, <<"Id!!! "<<neighbors->GetId(k));
-              }
-            }
-          }
-
-        vtkIdType numIds = neighborIds->GetNumberOfIds();
-        if (numIds>0)
-          {
-          //Add all Ids in current list to global list of Ids
-          for (int k=0; k< numIds;k++)
-            {
-              vtkIdType neighborId = neighborIds->GetId(k);
-              if (this->CheckedCarefully[inputIndex][neighborId]==0)
-                {
-                this->CheckCellsCareful2->InsertNextId(neighborId);
-                }
-              else if (this->Checked[inputIndex][neighborId]==0)
-                {
-                this->CheckCells2->InsertNextId(neighborId);
-                }
-            }
-          }
-        }
-      }
-
-    //Add current list of checked cells to the full list and continue
-    tmp = this->CheckCellsCareful;
-    this->CheckCellsCareful = this->CheckCellsCareful2;
-    this->CheckCellsCareful2 = tmp;
-    tmp->Reset();
-    }
-  return SV_OK;
 }
 
 // ----------------------
@@ -481,8 +410,6 @@ void vtkSVLoopBooleanPolyDataFilter::Impl::Initialize()
     this->BoundaryPointArray[i]->SetNumberOfTuples(numPts);
     this->BoundaryCellArray[i]->SetNumberOfTuples(numPolys);
     this->BooleanArray[i]->SetNumberOfTuples(numPolys);
-    this->Checked[i] = new vtkIdType[numPolys];
-    this->CheckedCarefully[i] = new vtkIdType[numPolys];
     this->PointMapper[i] = new vtkIdType[numPolys];
     this->ReversePointMapper[i] = new vtkIdType[numLinePts];
 
@@ -494,8 +421,6 @@ void vtkSVLoopBooleanPolyDataFilter::Impl::Initialize()
       {
       this->BoundaryCellArray[i]->InsertValue(j, 0);
       this->BooleanArray[i]->InsertValue(j, 0);
-      this->Checked[i][j] = 0;
-      this->CheckedCarefully[i][j] = 0;
       this->PointMapper[i][j] = -1;
       }
     for (int j=0;j<numLinePts;j++)
@@ -503,6 +428,8 @@ void vtkSVLoopBooleanPolyDataFilter::Impl::Initialize()
       this->ReversePointMapper[i][j] = -1;
       }
     }
+  this->BuildLineTable();
+
   this->NewCellIds[0]->DeepCopy(this->IntersectionLines->GetCellData()->
       GetArray("NewCell0ID"));
   this->NewCellIds[1]->DeepCopy(this->IntersectionLines->GetCellData()->
@@ -530,15 +457,213 @@ void vtkSVLoopBooleanPolyDataFilter::Impl::Initialize()
   this->Mesh[1]->GetPointData()->SetActiveScalars("BoundaryPoints");
 }
 
+// ----------------------
+// Impl::BuildLineTable
+// ----------------------
+/// \brief Flat tables of the intersection lines for the loop tracing and the
+/// intersection edge test. Lines of a point are in increasing id order.
+void vtkSVLoopBooleanPolyDataFilter::Impl::BuildLineTable()
+{
+  vtkIdType numLines = this->IntersectionLines->GetNumberOfCells();
+  vtkIdType numLinePts = this->IntersectionLines->GetNumberOfPoints();
+
+  this->LinePoints.assign(2*numLines, -1);
+  this->PointLineOffsets.assign(numLinePts+1, 0);
+  for (vtkIdType lineId = 0; lineId < numLines; lineId++)
+    {
+    vtkIdType npts, *pts;
+    this->IntersectionLines->GetCellPoints(lineId, npts, pts);
+    if (npts != 2)
+      {
+      vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Points is not 2 for cell "
+        <<lineId);
+      continue;
+      }
+    this->LinePoints[2*lineId]   = pts[0];
+    this->LinePoints[2*lineId+1] = pts[1];
+    this->PointLineOffsets[pts[0]+1]++;
+    if (pts[1] != pts[0])
+      {
+      this->PointLineOffsets[pts[1]+1]++;
+      }
+    }
+  for (vtkIdType ptId = 0; ptId < numLinePts; ptId++)
+    {
+    this->PointLineOffsets[ptId+1] += this->PointLineOffsets[ptId];
+    }
+
+  this->PointLineIds.resize(this->PointLineOffsets[numLinePts]);
+  std::vector<vtkIdType> fill(this->PointLineOffsets.begin(),
+                              this->PointLineOffsets.end()-1);
+  for (vtkIdType lineId = 0; lineId < numLines; lineId++)
+    {
+    vtkIdType pt0 = this->LinePoints[2*lineId];
+    vtkIdType pt1 = this->LinePoints[2*lineId+1];
+    if (pt0 == -1)
+      {
+      continue;
+      }
+    this->PointLineIds[fill[pt0]++] = lineId;
+    if (pt1 != pt0)
+      {
+      this->PointLineIds[fill[pt1]++] = lineId;
+      }
+    }
+}
+
+// ----------------------
+// Impl::IsIntersectionEdge
+// ----------------------
+bool vtkSVLoopBooleanPolyDataFilter::Impl::IsIntersectionEdge(
+    vtkIdType linePt0, vtkIdType linePt1) const
+{
+  if (linePt0 < 0 || linePt1 < 0)
+    {
+    return false;
+    }
+  vtkIdType numLines = this->GetNumberOfPointLines(linePt0);
+  const vtkIdType *lines = this->GetPointLines(linePt0);
+  for (vtkIdType i = 0; i < numLines; i++)
+    {
+    if (this->GetOtherLinePoint(lines[i], linePt0) == linePt1)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+// ----------------------
+// Impl::FindRegions
+// ----------------------
+/// \brief Label the regions of a mesh bounded by the intersection lines.
+/// Cells away from the intersection are joined to every cell around their
+/// points and cells on the intersection only across edges that are not
+/// intersection edges. The unions run in parallel.
+void vtkSVLoopBooleanPolyDataFilter::Impl::FindRegions(int inputIndex)
+{
+  vtkPolyData *mesh = this->Mesh[inputIndex];
+  vtkIdType numCells = mesh->GetNumberOfCells();
+  vtkIdType numPts = mesh->GetNumberOfPoints();
+
+  // Flat cell and point to cell tables
+  std::vector<vtkIdType> cellOffsets(numCells+1, 0);
+  std::vector<vtkIdType> cellPointIds;
+  cellPointIds.reserve(3*numCells);
+  std::vector<vtkIdType> pointCellOffsets(numPts+1, 0);
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    vtkIdType npts, *pts;
+    mesh->GetCellPoints(cellId, npts, pts);
+    for (vtkIdType i = 0; i < npts; i++)
+      {
+      cellPointIds.push_back(pts[i]);
+      pointCellOffsets[pts[i]+1]++;
+      }
+    cellOffsets[cellId+1] = cellPointIds.size();
+    }
+  for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+    {
+    pointCellOffsets[ptId+1] += pointCellOffsets[ptId];
+    }
+  std::vector<vtkIdType> pointCellIds(pointCellOffsets[numPts]);
+  std::vector<vtkIdType> fill(pointCellOffsets.begin(), pointCellOffsets.end()-1);
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    for (vtkIdType i = cellOffsets[cellId]; i < cellOffsets[cellId+1]; i++)
+      {
+      pointCellIds[fill[cellPointIds[i]]++] = cellId;
+      }
+    }
+
+  // Edges shared by exactly two cells that are not intersection edges
+  std::vector<HalfEdge> halfEdges(cellPointIds.size());
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    vtkIdType start = cellOffsets[cellId];
+    vtkIdType npts = cellOffsets[cellId+1] - start;
+    for (vtkIdType i = 0; i < npts; i++)
+      {
+      vtkIdType p0 = cellPointIds[start+i];
+      vtkIdType p1 = cellPointIds[start+(i+1)%npts];
+      HalfEdge &edge = halfEdges[start+i];
+      edge.pt0 = svminimum(p0, p1);
+      edge.pt1 = svmaximum(p0, p1);
+      edge.cellId = cellId;
+      }
+    }
+  std::sort(halfEdges.begin(), halfEdges.end());
+
+  std::vector<vtkIdType> edgeCells;
+  size_t numHalfEdges = halfEdges.size();
+  for (size_t i = 0; i < numHalfEdges;)
+    {
+    size_t j = i+1;
+    while (j < numHalfEdges && !(halfEdges[i] < halfEdges[j]))
+      {
+      j++;
+      }
+    if (j - i == 2)
+      {
+      vtkIdType p0 = halfEdges[i].pt0;
+      vtkIdType p1 = halfEdges[i].pt1;
+      bool cut = this->BoundaryPointArray[inputIndex]->GetValue(p0) == 1 &&
+                 this->BoundaryPointArray[inputIndex]->GetValue(p1) == 1 &&
+                 this->IsIntersectionEdge(this->PointMapper[inputIndex][p0],
+                                          this->PointMapper[inputIndex][p1]);
+      if (!cut)
+        {
+        edgeCells.push_back(halfEdges[i].cellId);
+        edgeCells.push_back(halfEdges[i+1].cellId);
+        }
+      }
+    i = j;
+    }
+
+  RegionUnionFind unionFind(numCells);
+
+  if (numPts > 0)
+    {
+    UnionPointNeighbors pointUnioner;
+    pointUnioner.UnionFind        = &unionFind;
+    pointUnioner.BoundaryCells    = this->BoundaryCellArray[inputIndex];
+    pointUnioner.CellOffsets      = &cellOffsets[0];
+    pointUnioner.CellPointIds     = cellPointIds.empty() ? NULL : &cellPointIds[0];
+    pointUnioner.PointCellOffsets = &pointCellOffsets[0];
+    pointUnioner.PointCellIds     = pointCellIds.empty() ? NULL : &pointCellIds[0];
+    vtkSMPTools::For(0, numCells, pointUnioner);
+    }
+
+  if (!edgeCells.empty())
+    {
+    UnionEdgeNeighbors edgeUnioner;
+    edgeUnioner.UnionFind = &unionFind;
+    edgeUnioner.EdgeCells = &edgeCells[0];
+    vtkSMPTools::For(0, edgeCells.size()/2, edgeUnioner);
+    }
+
+  this->Regions[inputIndex].resize(numCells);
+  if (numCells > 0)
+    {
+    LabelRegions labeler;
+    labeler.UnionFind = &unionFind;
+    labeler.Regions   = &this->Regions[inputIndex][0];
+    vtkSMPTools::For(0, numCells, labeler);
+    }
+  vtkDebugWithObjectMacro(this->ParentFilter, <<"Found regions of mesh "<<inputIndex);
+}
+
 // ----------------------
 // Impl::GetBooleanRegions
 // ----------------------
 void vtkSVLoopBooleanPolyDataFilter::Impl::GetBooleanRegions(
     int inputIndex, std::vector<simLoop> *loops)
 {
-  vtkNew(vtkPolyData, tmpPolyData);
-  tmpPolyData->DeepCopy(this->Mesh[inputIndex]);
-  tmpPolyData->BuildLinks();
+  vtkIdType numCells = this->Mesh[inputIndex]->GetNumberOfCells();
+  const std::vector<vtkIdType> &regions = this->Regions[inputIndex];
+
+  //Orientation of each region, stored at the root cell of the region
+  std::vector<int> regionSigns(numCells, 0);
 
   std::vector<simLoop>::iterator loopit;
   std::list<simLine>::iterator cellit;
@@ -546,60 +671,32 @@ void vtkSVLoopBooleanPolyDataFilter::Impl::GetBooleanRegions(
   //For each intersection loop
   for (loopit = loops->begin();loopit != loops->end(); ++loopit)
     {
-    std::list<simLine> loopcells = (loopit)->cells;
     //Go through each cell in the loop
-    for (cellit=loopcells.begin();cellit != loopcells.end();++cellit)
+    for (cellit=loopit->cells.begin();cellit != loopit->cells.end();++cellit)
       {
-      simLine nextLine;
-      nextLine = *cellit;
-      vtkIdType nextCell = nextLine.id;
-      vtkIdType p1 = nextLine.pt1;
-      vtkIdType p2 = nextLine.pt2;
-      vtkIdType outputCellId0 = this->NewCellIds[inputIndex]->GetComponent(nextCell,0);
-      vtkIdType outputCellId1 = this->NewCellIds[inputIndex]->GetComponent(nextCell,1);
-      //If the cell has not been given an orientation from the flood fill
-      //algorithm and it has an id from vtkSVLoopIntersectionPolyDataFilter
-      if (outputCellId0 != -1)
-        {
-        //If the cell hasn't been touched
-        if (this->CheckedCarefully[inputIndex][outputCellId0] == 0)
-          {
-          int sign1 = this->GetCellOrientation(tmpPolyData, outputCellId0,
-            p1, p2, inputIndex);
-          //If cell orientation is found
-          if (sign1 != 0)
-            {
-            this->CheckCells->InsertNextId(outputCellId0);
-            this->FindRegion(inputIndex, sign1, 1, 1);
-            this->CheckCells->Reset();
-            this->CheckCells2->Reset();
-            this->CheckCellsCareful->Reset();
-            this->CheckCellsCareful2->Reset();
-            }
-          }
-        }
-      //Check cell on other side of intersection line
-      if (outputCellId1 != -1)
+      vtkIdType nextCell = cellit->id;
+      vtkIdType p1 = cellit->pt1;
+      vtkIdType p2 = cellit->pt2;
+      //Check the cells on both sides of the intersection line that have an
+      //id from vtkSVLoopIntersectionPolyDataFilter
+      for (int side = 0; side < 2; side++)
         {
-        //If the cell hasn't been touched
-        if (this->CheckedCarefully[inputIndex][outputCellId1] == 0)
+        vtkIdType outputCellId = this->NewCellIds[inputIndex]->GetComponent(nextCell, side);
+        //If the region of the cell has not been given an orientation yet
+        if (outputCellId != -1 && regionSigns[regions[outputCellId]] == 0)
           {
-          int sign2 = this->GetCellOrientation(tmpPolyData, outputCellId1,
-              p1, p2, inputIndex);
-          //If cell orientation is found
-          if (sign2 != 0)
-            {
-            this->CheckCells->InsertNextId(outputCellId1);
-            this->FindRegion(inputIndex, sign2, 1, 1);
-            this->CheckCells->Reset();
-            this->CheckCells2->Reset();
-            this->CheckCellsCareful->Reset();
-            this->CheckCellsCareful2->Reset();
-            }
+          regionSigns[regions[outputCellId]] =
+            this->GetCellOrientation(this->Mesh[inputIndex], outputCellId,
+                                     p1, p2, inputIndex);
           }
         }
       }
     }
+
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    this->BooleanArray[inputIndex]->SetValue(cellId, regionSigns[regions[cellId]]);
+    }
 }
 
 // ----------------------
@@ -614,7 +711,6 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::GetCellOrientation(
   // Get cell points
   vtkIdType npts;
   vtkIdType *pts;
-  pd->BuildLinks();
   pd->GetCellPoints(cellId,npts,pts);
 
   //pt0Id and pt1Id are from intersectionLines PolyData and I am trying
@@ -634,27 +730,11 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::GetCellOrientation(
       }
     }
 
-  // Set group of points in own point set
-  vtkNew(vtkPoints, cellPts);
-  cellPts->InsertNextPoint(pd->GetPoint(cellPtId0));
-  cellPts->InsertNextPoint(pd->GetPoint(cellPtId1));
-  cellPts->InsertNextPoint(pd->GetPoint(cellPtId2));
-
-  // Create polydata of points
-  vtkNew(vtkPolyData, cellPD);
-  cellPD->SetPoints(cellPts);
-
-  // Set lines of cells
-  vtkNew(vtkCellArray, cellLines);
-  for (int j=0;j<npts;j++)
-    {
-    int spot1 = j;
-    int spot2 = (j+1)%3;
-    cellLines->InsertNextCell(2);
-    cellLines->InsertCellPoint(spot1);
-    cellLines->InsertCellPoint(spot2);
-    }
-  cellPD->SetLines(cellLines);
+  // Points ordered along the intersection line
+  double cellPts[3][3];
+  pd->GetPoint(cellPtId0, cellPts[0]);
+  pd->GetPoint(cellPtId1, cellPts[1]);
+  pd->GetPoint(cellPtId2, cellPts[2]);
 
   // Set up a transform that will rotate the points to the
   // XY-plane (normal aligned with z-axis).
@@ -707,30 +787,20 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::GetCellOrientation(
   transform->Translate(-center[0], -center[1], -center[2]);
 
   // transform
-  vtkNew(vtkTransformPolyDataFilter, transformer);
-  transformer->SetInputData(cellPD);
-  transformer->SetTransform(transform);
-  transformer->Update();
-
-  // trasformed polydata
-  vtkNew(vtkPolyData, transPD);
-  transPD = transformer->GetOutput();
-  transPD->BuildLinks();
+  double transPts[3][3];
+  for (int j=0;j<3;j++)
+    {
+    transform->TransformPoint(cellPts[j], transPts[j]);
+    }
 
   // Calculate area
   double area = 0;
-  double tedgept1[3];
-  double tedgept2[3];
-  vtkIdType newpt;
-  for(newpt=0;newpt<transPD->GetNumberOfPoints()-1;newpt++)
+  for (int j=0;j<3;j++)
     {
-      transPD->GetPoint(newpt, tedgept1);
-      transPD->GetPoint(newpt+1, tedgept2);
-      area = area + (tedgept1[0]*tedgept2[1])-(tedgept2[0]*tedgept1[1]);
+    double *tedgept1 = transPts[j];
+    double *tedgept2 = transPts[(j+1)%3];
+    area = area + (tedgept1[0]*tedgept2[1])-(tedgept2[0]*tedgept1[1]);
     }
-  transPD->GetPoint(newpt, tedgept1);
-  transPD->GetPoint(0, tedgept2);
-  area = area + (tedgept1[0]*tedgept2[1])-(tedgept2[0]*tedgept1[1]);
 
   // Check with tolerance
   int value=0;
@@ -749,31 +819,6 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::GetCellOrientation(
   return value;
 }
 
-// ----------------------
-// ResetCheckArrays
-// ----------------------
-/// \brief Reset the find region arrays to test another region
-void vtkSVLoopBooleanPolyDataFilter::Impl::ResetCheckArrays()
-{
-  for (int i=0;i<2;i++)
-    {
-    int numPolys = this->Mesh[i]->GetNumberOfCells();
-    for (vtkIdType cellId = 0; cellId < numPolys;cellId++)
-      {
-      if (this->BoundaryCellArray[i]->GetValue(cellId) == 1)
-        {
-        this->Checked[i][cellId] = 1;
-        this->CheckedCarefully[i][cellId] = 0;
-        }
-      else
-        {
-        this->Checked[i][cellId] = 0;
-        this->CheckedCarefully[i][cellId] = 1;
-        }
-      }
-    }
-}
-
 // ----------------------
 // SetBoundary Arrays
 // ----------------------
@@ -812,7 +857,6 @@ void vtkSVLoopBooleanPolyDataFilter::Impl::SetBoundaryArrays()
     for (int i = 0;i < bpCellIds1->GetNumberOfIds();i++)
       {
       this->BoundaryCellArray[0]->InsertValue(bpCellIds1->GetId(i), 1);
-      this->Checked[0][bpCellIds1->GetId(i)] = 1;
       }
 
     // Find closest point
@@ -830,28 +874,6 @@ void vtkSVLoopBooleanPolyDataFilter::Impl::SetBoundaryArrays()
     for (int i = 0;i < bpCellIds2->GetNumberOfIds();i++)
       {
       this->BoundaryCellArray[1]->InsertValue(bpCellIds2->GetId(i), 1);
-      this->Checked[1][bpCellIds2->GetId(i)] = 1;
-      }
-    }
-}
-
-// ----------------------
-// SetCheckArrays
-// ----------------------
-/// \brieff Set the original finding region check arrays
-void vtkSVLoopBooleanPolyDataFilter::Impl::SetCheckArrays()
-{
-  for (int i =0;i<2;i++)
-    {
-    //Get the number of Polys for scalar  allocation
-    int numPolys = this->Mesh[i]->GetNumberOfPolys();
-
-    for (int j=0;j < numPolys;j++)
-      {
-      if (this->Checked[i][j] == 0)
-        this->CheckedCarefully[i][j] = 1;
-      else
-        this->CheckedCarefully[i][j] = 0;
       }
     }
 }
@@ -860,6 +882,7 @@ void vtkSVLoopBooleanPolyDataFilter::Impl::SetCheckArrays()
 // StandardNewMacro
 // ----------------------
 vtkStandardNewMacro(vtkSVLoopBooleanPolyDataFilter);
+vtkCxxSetObjectMacro(vtkSVLoopBooleanPolyDataFilter,FirstInputTree,vtkSVBoundingBoxTree);
 
 // ----------------------
 // Constructor
@@ -878,6 +901,7 @@ vtkSVLoopBooleanPolyDataFilter::vtkSVLoopBooleanPolyDataFilter() :
 
   this->Status = 1;
   this->Tolerance = 1e-6;
+  this->FirstInputTree = NULL;
 }
 
 // ----------------------
@@ -885,6 +909,11 @@ vtkSVLoopBooleanPolyDataFilter::vtkSVLoopBooleanPolyDataFilter() :
 // ----------------------
 vtkSVLoopBooleanPolyDataFilter::~vtkSVLoopBooleanPolyDataFilter()
 {
+  if (this->FirstInputTree)
+    {
+    this->FirstInputTree->Delete();
+    this->FirstInputTree = NULL;
+    }
 }
 
 // ----------------------
@@ -931,6 +960,11 @@ int vtkSVLoopBooleanPolyDataFilter::RequestData(
   polydataIntersection->SplitFirstOutputOn();
   polydataIntersection->SplitSecondOutputOn();
   polydataIntersection->SetTolerance(this->Tolerance);
+  polydataIntersection->SetFirstInputTree(this->FirstInputTree);
+  vtkNew(vtkCallbackCommand, progressForwarder);
+  progressForwarder->SetCallback(ForwardProgress);
+  progressForwarder->SetClientData(this);
+  polydataIntersection->AddObserver(vtkCommand::ProgressEvent, progressForwarder);
   polydataIntersection->Update();
   if (polydataIntersection->GetStatus() != SV_OK)
     {
@@ -944,6 +978,8 @@ int vtkSVLoopBooleanPolyDataFilter::RequestData(
           polydataIntersection->GetNumberOfIntersectionLines();
 
   vtkDebugMacro(<<"Intersection is Done!!!");
+  this->SetProgressText("Regions");
+  this->UpdateProgress(0.6);
 
   vtkSVLoopBooleanPolyDataFilter::Impl *impl =
     new vtkSVLoopBooleanPolyDataFilter::Impl();
@@ -1027,8 +1063,9 @@ int vtkSVLoopBooleanPolyDataFilter::RequestData(
   impl->Initialize();
   vtkDebugMacro(<<"Setting Bound Arrays");
   impl->SetBoundaryArrays();
-  vtkDebugMacro(<<"Setting Check Arrays");
-  impl->SetCheckArrays();
+  vtkDebugMacro(<<"Finding Regions");
+  impl->FindRegions(0);
+  impl->FindRegions(1);
 
   //Determine the intersection type and obtain the intersection loops
   //to give to Boolean Region finding
@@ -1044,6 +1081,8 @@ int vtkSVLoopBooleanPolyDataFilter::RequestData(
   vtkDebugMacro(<<"DONE WITH 2");
 
   //Combine certain orientations based on the operation desired
+  this->SetProgressText("Output");
+  this->UpdateProgress(0.85);
   impl->PerformBoolean(outputSurface, this->Operation);
 
   //Number of bad triangles and free edges (Should be zero for watertight,
@@ -1113,6 +1152,7 @@ void vtkSVLoopBooleanPolyDataFilter::PrintSelf(
           this->NumberOfIntersectionPoints << "\n";
   os << indent << "NumberOfIntersectionLines: " <<
           this->NumberOfIntersectionLines << "\n";
+  os << indent << "FirstInputTree: " << this->FirstInputTree << "\n";
 }
 
 // ----------------------
@@ -1157,19 +1197,24 @@ void vtkSVLoopBooleanPolyDataFilter::Impl::DetermineIntersection(
     if (usedPt[interPt] == false)
       {
       simLoop newloop;
-      vtkNew(vtkIdList, cellIds);
-      this->IntersectionLines->GetPointCells(interPt, cellIds);
-      if (cellIds->GetNumberOfIds() > 2)
+      vtkIdType numLines = this->GetNumberOfPointLines(interPt);
+      const vtkIdType *lines = this->GetPointLines(interPt);
+      if (numLines > 2)
         {
         vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Cells is greater than 2 for first point "
           <<interPt);
         }
-      else if (cellIds->GetNumberOfIds() < 2)
+      else if (numLines < 2)
         {
         vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Cells is less than 2 for point "<<interPt);
         }
+      if (numLines == 0)
+        {
+        usedPt[interPt] = true;
+        continue;
+        }
 
-      vtkIdType nextCell = cellIds->GetId(0);
+      vtkIdType nextCell = lines[0];
 
       //Run through intersection lines to get loops!
       vtkDebugWithObjectMacro(this->ParentFilter,"Running loop find: " << interPt << " " <<  nextCell);
@@ -1185,10 +1230,13 @@ void vtkSVLoopBooleanPolyDataFilter::Impl::DetermineIntersection(
           vtkDebugWithObjectMacro(this->ParentFilter, <<"End point of open loop is "<<nextPt);
           newloop.endPt = nextPt;
           newloop.loopType = 2;
-          nextCell = cellIds->GetId(1);
-          vtkIdType newId = this->RunLoopFind(interPt, nextCell, usedPt,
-                                              &newloop);
-          newloop.startPt = newId;
+          if (numLines > 1)
+            {
+            nextCell = lines[1];
+            vtkIdType newId = this->RunLoopFind(interPt, nextCell, usedPt,
+                                                &newloop);
+            newloop.startPt = newId;
+            }
           //Save start and end point in custom data structure for loop
           }
         else
@@ -1213,30 +1261,8 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::RunLoopFind(
     vtkIdType interPt, vtkIdType nextCell, bool *usedPt, simLoop *loop)
 {
   vtkIdType prevPt = interPt;
-  vtkIdType nextPt = interPt;
-  vtkNew(vtkIdList, pointIds);
-  vtkNew(vtkIdList, cellIds);
-
-  IntersectionLines->GetCellPoints(nextCell, pointIds);
-  if (pointIds->GetNumberOfIds() > 2)
-    {
-    vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Points is greater than 2 for first cell "
-      <<nextCell);
-    }
-  else if (pointIds->GetNumberOfIds() < 2)
-    {
-    vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Points is less than 2 for first cell "
-      <<nextCell);
-    }
+  vtkIdType nextPt = this->GetOtherLinePoint(nextCell, interPt);
 
-  if (pointIds->GetId(0) == nextPt)
-    {
-    nextPt = pointIds->GetId(1);
-    }
-  else
-    {
-    nextPt = pointIds->GetId(0);
-    }
   simLine newline;
   newline.pt1 = prevPt;
   newline.pt2 = nextPt;
@@ -1246,8 +1272,9 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::RunLoopFind(
   usedPt[nextPt] = true;
   while(nextPt != loop->cells.front().pt1)
     {
-    IntersectionLines->GetPointCells(nextPt, cellIds);
-    if (cellIds->GetNumberOfIds() > 2)
+    vtkIdType numLines = this->GetNumberOfPointLines(nextPt);
+    const vtkIdType *lines = this->GetPointLines(nextPt);
+    if (numLines > 2)
       {
       IntersectionCase = 1;
       vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Cells is greater than 2 for point "
@@ -1260,7 +1287,7 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::RunLoopFind(
         }
       vtkDebugWithObjectMacro(this->ParentFilter, <<"Next cell is "<<nextCell);
       }
-    else if (cellIds->GetNumberOfIds() < 2)
+    else if (numLines < 2)
       {
       vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Cells is less than 2 for point "<<nextPt);
       IntersectionCase = 2;
@@ -1268,36 +1295,18 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::RunLoopFind(
       }
     else
       {
-      if (cellIds->GetId(0) == nextCell)
+      if (lines[0] == nextCell)
         {
-        nextCell = cellIds->GetId(1);
+        nextCell = lines[1];
         }
       else
         {
-        nextCell = cellIds->GetId(0);
+        nextCell = lines[0];
         }
       }
 
-    IntersectionLines->GetCellPoints(nextCell, pointIds);
-    if (pointIds->GetNumberOfIds() > 2)
-      {
-      vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Points is greater than 2 for cell "
-        <<nextCell);
-      }
-    else if (pointIds->GetNumberOfIds() < 2)
-      {
-      vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Points is less than 2 for first cell "
-        <<nextCell);
-      }
     prevPt = nextPt;
-    if (pointIds->GetId(0) == nextPt)
-      {
-      nextPt = pointIds->GetId(1);
-      }
-    else
-      {
-      nextPt = pointIds->GetId(0);
-      }
+    nextPt = this->GetOtherLinePoint(nextCell, nextPt);
     usedPt[nextPt] = true;
 
     simLine newestline;
@@ -1325,42 +1334,19 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::RunLoopTest(
   vtkIdType stopCell = nextCell;
   vtkIdType prevPt = interPt;
   vtkIdType nextPt = interPt;
-  vtkNew(vtkIdList, pointIds);
-  vtkNew(vtkPolyData, tmpPolyData);
   int input = 0;
-  tmpPolyData->DeepCopy(this->Mesh[input]);
-  tmpPolyData->BuildLinks();
+  const std::vector<vtkIdType> &regions = this->Regions[input];
   std::list<simLine>::iterator cellit;
 
-  vtkNew(vtkIdList, cellIds);
-  IntersectionLines->GetPointCells(nextPt, cellIds);
+  vtkIdType numLines = this->GetNumberOfPointLines(nextPt);
+  const vtkIdType *lines = this->GetPointLines(nextPt);
   vtkDebugWithObjectMacro(this->ParentFilter, <<"Number of cells should be more than two!! "<<
-    cellIds->GetNumberOfIds());
-  for (vtkIdType i=0;i<cellIds->GetNumberOfIds();i++)
+    numLines);
+  for (vtkIdType i=0;i<numLines;i++)
     {
-    int numRegionsFound=0;
-    vtkIdType cellId = cellIds->GetId(i);
+    vtkIdType cellId = lines[i];
     vtkDebugWithObjectMacro(this->ParentFilter, <<"Testing cell "<<cellId);
-    IntersectionLines->GetCellPoints(cellId, pointIds);
-    if (pointIds->GetNumberOfIds() > 2)
-      {
-      vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Points is greater than 2 for first cell "<<
-        nextCell);
-      }
-    else if (pointIds->GetNumberOfIds() < 2)
-      {
-      vtkDebugWithObjectMacro(this->ParentFilter, <<"Number Of Points is less than 2 for first cell "<<
-        nextCell);
-      }
-
-    if (pointIds->GetId(0) == interPt)
-      {
-      nextPt = pointIds->GetId(1);
-      }
-    else
-      {
-      nextPt = pointIds->GetId(0);
-      }
+    nextPt = this->GetOtherLinePoint(cellId, interPt);
 
     if (usedPt[nextPt] == true)
       {
@@ -1374,55 +1360,29 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::RunLoopTest(
       newline.pt2 = nextPt;
       loop->cells.push_back(newline);
       vtkDebugWithObjectMacro(this->ParentFilter, <<"Cell id is: "<<cellId);
+
+      //Regions on the negative side of the candidate loop
+      std::set<vtkIdType> regionsFound;
       for (cellit=loop->cells.begin();cellit != loop->cells.end(); ++cellit)
         {
-        simLine nextLine;
-        nextLine = *cellit;
-        nextCell = nextLine.id;
-        vtkIdType p1 = nextLine.pt1;
-        vtkIdType p2 = nextLine.pt2;
-        vtkDebugWithObjectMacro(this->ParentFilter, <<"Line cell is "<<nextCell);
-        vtkIdType outputCellId0 = this->NewCellIds[input]->GetComponent(nextCell, 0);
-        vtkIdType outputCellId1 = this->NewCellIds[input]->GetComponent(nextCell, 1);
-        if (outputCellId0 != -1)
-          {
-          if (this->CheckedCarefully[input][outputCellId0] == 0)
-            {
-            int sign1 = this->GetCellOrientation(tmpPolyData, outputCellId0,
-              p1, p2, input);
-            if (sign1 == -1)
-              {
-              numRegionsFound++;
-              this->CheckCells->InsertNextId(outputCellId0);
-              this->FindRegion(input, sign1, 1, 0);
-              this->CheckCells->Reset();
-              this->CheckCells2->Reset();
-              this->CheckCellsCareful->Reset();
-              this->CheckCellsCareful2->Reset();
-              }
-            }
-          }
-        if (outputCellId1 != -1)
+        vtkDebugWithObjectMacro(this->ParentFilter, <<"Line cell is "<<cellit->id);
+        for (int side = 0; side < 2; side++)
           {
-          if (this->CheckedCarefully[input][outputCellId1] == 0)
+          vtkIdType outputCellId = this->NewCellIds[input]->GetComponent(cellit->id, side);
+          if (outputCellId != -1 &&
+              regionsFound.find(regions[outputCellId]) == regionsFound.end())
             {
-            int sign2 = this->GetCellOrientation(tmpPolyData, outputCellId1,
-              p1, p2, input);
-            if (sign2 == -1)
+            int sign = this->GetCellOrientation(this->Mesh[input], outputCellId,
+              cellit->pt1, cellit->pt2, input);
+            if (sign == -1)
               {
-              numRegionsFound++;
-              this->CheckCells->InsertNextId(outputCellId1);
-              this->FindRegion(input, sign2, 1, 0);
-              this->CheckCells->Reset();
-              this->CheckCells2->Reset();
-              this->CheckCellsCareful->Reset();
-              this->CheckCellsCareful2->Reset();
+              regionsFound.insert(regions[outputCellId]);
               }
             }
           }
         }
       loop->cells.pop_back();
-      this->ResetCheckArrays();
+      int numRegionsFound = regionsFound.size();
       vtkDebugWithObjectMacro(this->ParentFilter, <<"Number of Regions Found: "<<numRegionsFound);
       if (numRegionsFound == 1)
         {
@@ -1439,220 +1399,127 @@ int vtkSVLoopBooleanPolyDataFilter::Impl::RunLoopTest(
 // ----------------------
 // Impl::PerformBoolean
 // ----------------------
-/// \brief Combine the correct regions for output boolean
+/// \brief Combine the correct regions for output boolean. The cells kept
+/// from both meshes and the points they use are copied to the output in one
+/// pass, keeping the data arrays the two meshes have in common.
 void vtkSVLoopBooleanPolyDataFilter::Impl::PerformBoolean(
     vtkPolyData *output, int booleanOperation)
 {
-  //// Four surfaces
-  //vtkPolyData *surfaces[4];
-  //for (int i=0;i<4;i++)
-  //  {
-  //  surfaces[i] = vtkPolyData::New();;
-  //  }
-
-  //this->ThresholdRegions(surfaces);
-
-  //vtkNew(vtkAppendPolyData, appender);
-
-  ////If open intersection case, make sure correct region is taken
-  //if (this->IntersectionCase == 2)
-  //  {
-  //  vtkNew(vtkPolyData, tmp);
-  //  int numCells[4];
-  //  std::list<vtkIdType> nocellregion;
-  //  for (int i=0;i<4;i++)
-  //    {
-  //    numCells[i] = surfaces[i]->GetNumberOfCells();
-  //    if (numCells[i] == 0)
-  //      {
-  //      nocellregion.push_back(i);
-  //      }
-  //    }
-  //  if (nocellregion.size() > 0)
-  //    {
-  //    if (nocellregion.front() == 0)
-  //      {
-  //      tmp->DeepCopy(surfaces[1]);
-  //      surfaces[1]->DeepCopy(surfaces[0]);
-  //      surfaces[0]->DeepCopy(tmp);
-  //      }
-  //    if (nocellregion.back() == 2)
-  //      {
-  //      tmp->DeepCopy(surfaces[3]);
-  //      surfaces[3]->DeepCopy(surfaces[2]);
-  //      surfaces[2]->DeepCopy(tmp);
-  //      }
-  //    }
-  //  }
-  //if (booleanOperation == 0)
-  //  {
-  //  appender->AddInputData(surfaces[0]);
-  //  appender->AddInputData(surfaces[2]);
-  //  }
-  //if (booleanOperation == 1)
-  //  {
-  //  appender->AddInputData(surfaces[1]);
-  //  appender->AddInputData(surfaces[3]);
-  //  }
-  //if (booleanOperation == 2)
-  //  {
-  //  appender->AddInputData(surfaces[0]);
-  //  appender->AddInputData(surfaces[3]);
-  //  }
-  //appender->Update();
-
-  //output->DeepCopy(appender->GetOutput());
-
-  //for (int i =0;i < 4;i++)
-  //  {
-  //  surfaces[i]->Delete();
-  //  }
-  vtkSmartPointer<vtkThreshold> thresholder =
-    vtkSmartPointer<vtkThreshold>::New();
-  vtkSmartPointer<vtkDataSetSurfaceFilter> surfacer =
-    vtkSmartPointer<vtkDataSetSurfaceFilter>::New();
-
-  vtkSmartPointer<vtkPolyData> surface1_A =
-	  vtkSmartPointer<vtkPolyData>::New();
-  thresholder->SetInputData(this->Mesh[0]);
-  thresholder->SetInputArrayToProcess(0,0,0,1,"BooleanRegion");
-  thresholder->ThresholdBetween(-1,-1);
-  thresholder->Update();
-  surfacer->SetInputData(thresholder->GetOutput());
-  surfacer->Update();
-  surface1_A->DeepCopy(surfacer->GetOutput());
-
-  vtkSmartPointer<vtkPolyData> surface1_B =
-	  vtkSmartPointer<vtkPolyData>::New();
-  thresholder->SetInputData(this->Mesh[0]);
-  thresholder->SetInputArrayToProcess(0,0,0,1,"BooleanRegion");
-  thresholder->ThresholdBetween(1,1);
-  thresholder->Update();
-  surfacer->SetInputData(thresholder->GetOutput());
-  surfacer->Update();
-  surface1_B->DeepCopy(surfacer->GetOutput());
-
-  vtkSmartPointer<vtkPolyData> surface2_A =
-	  vtkSmartPointer<vtkPolyData>::New();
-  thresholder->SetInputData(this->Mesh[1]);
-  thresholder->SetInputArrayToProcess(0,0,0,1,"BooleanRegion");
-  thresholder->ThresholdBetween(1,1);
-  thresholder->Update();
-  surfacer->SetInputData(thresholder->GetOutput());
-  surfacer->Update();
-  surface2_A->DeepCopy(surfacer->GetOutput());
-
-  vtkSmartPointer<vtkPolyData> surface2_B =
-	  vtkSmartPointer<vtkPolyData>::New();
-  thresholder->SetInputData(this->Mesh[1]);
-  thresholder->SetInputArrayToProcess(0,0,0,1,"BooleanRegion");
-  thresholder->ThresholdBetween(-1,-1);
-  thresholder->Update();
-  surfacer->SetInputData(thresholder->GetOutput());
-  surfacer->Update();
-  surface2_B->DeepCopy(surfacer->GetOutput());
-
-  vtkSmartPointer<vtkAppendPolyData> appender =
-    vtkSmartPointer<vtkAppendPolyData>::New();
-
+  //Region kept from each mesh: union keeps the outside of both,
+  //intersection the inside of both, and difference the outside of the first
+  //with the inside of the second
+  int keepValue[2];
   if (booleanOperation == 0)
-  {
-    appender->AddInputData(surface1_A);
-    appender->AddInputData(surface2_A);
-  }
-  if (booleanOperation == 1)
-  {
-    appender->AddInputData(surface1_B);
-    appender->AddInputData(surface2_B);
-  }
-  if (booleanOperation == 2)
-  {
-    appender->AddInputData(surface1_A);
-    appender->AddInputData(surface2_B);
-  }
-  appender->Update();
-
-  output->DeepCopy(appender->GetOutput());
-}
-
-// ----------------------
-// Impl::ThresholdRegions
-// ----------------------
-void vtkSVLoopBooleanPolyDataFilter::Impl::ThresholdRegions(vtkPolyData **surfaces)
-{
-  vtkPoints    *points[4];
-  vtkCellArray *cells[4];
-  vtkIntArray  *boundaryPoints[4];
-  vtkIntArray  *boundaryCells[4];
-  vtkIntArray  *booleanCells[4];
-
-  for (int i=0;i<4;i++)
     {
-      points[i] = vtkPoints::New();
-      cells[i]  = vtkCellArray::New();
-      boundaryPoints[i] = vtkIntArray::New();
-      boundaryCells[i]  =  vtkIntArray::New();
-      booleanCells[i]   = vtkIntArray::New();
+    keepValue[0] = -1;
+    keepValue[1] = 1;
+    }
+  else if (booleanOperation == 1)
+    {
+    keepValue[0] = 1;
+    keepValue[1] = -1;
+    }
+  else
+    {
+    keepValue[0] = -1;
+    keepValue[1] = -1;
     }
 
-  for (int i=0; i<2; i++)
+  int pointType = VTK_FLOAT;
+  vtkIdType numNewPts = 0, numNewCells = 0, connectivitySize = 0;
+  std::vector<vtkIdType> newPointIds[2];
+  for (int i=0;i<2;i++)
     {
-    int numCells = this->Mesh[i]->GetNumberOfCells();
-    for (int j=0; j<numCells; j++)
+    vtkPolyData *mesh = this->Mesh[i];
+    if (mesh->GetPoints()->GetDataType() == VTK_DOUBLE)
+      {
+      pointType = VTK_DOUBLE;
+      }
+    newPointIds[i].assign(mesh->GetNumberOfPoints(), -1);
+    vtkIdType numCells = mesh->GetNumberOfCells();
+    for (vtkIdType cellId = 0; cellId < numCells; cellId++)
       {
-      int value = this->BooleanArray[i]->GetValue(j);
+      if (this->BooleanArray[i]->GetValue(cellId) != keepValue[i])
+        {
+        continue;
+        }
       vtkIdType npts, *pts;
-      this->Mesh[i]->GetCellPoints(j, npts, pts);
-      if (value < 0)
+      mesh->GetCellPoints(cellId, npts, pts);
+      for (vtkIdType j = 0; j < npts; j++)
         {
-        vtkNew(vtkIdList, newPointIds);
-        newPointIds->SetNumberOfIds(3);
-        for (int k=0; k<npts; k++)
-          {
-          double pt[3];
-          this->Mesh[i]->GetPoint(pts[k], pt);
-          vtkIdType newId = points[3*i]->InsertNextPoint(pt);
-          newPointIds->SetId(k, newId);
-          boundaryPoints[3*i]->InsertValue(newId, this->BoundaryPointArray[i]->GetValue(pts[k]));
-          }
-        vtkIdType cellId = cells[3*i]->InsertNextCell(newPointIds);
-        boundaryCells[3*i]->InsertValue(cellId, this->BoundaryCellArray[i]->GetValue(j));
-        booleanCells[3*i]->InsertValue(cellId, this->BooleanArray[i]->GetValue(j));
+        newPointIds[i][pts[j]] = 0;
         }
-      if (value > 0)
+      numNewCells++;
+      connectivitySize += npts + 1;
+      }
+    vtkIdType numPts = mesh->GetNumberOfPoints();
+    for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+      {
+      if (newPointIds[i][ptId] == 0)
         {
-        vtkNew(vtkIdList, newPointIds);
-        newPointIds->SetNumberOfIds(3);
-        for (int k=0; k<npts; k++)
-          {
-          double pt[3];
-          this->Mesh[i]->GetPoint(pts[k], pt);
-          vtkIdType newId = points[i+1]->InsertNextPoint(pt);
-          newPointIds->SetId(k, newId);
-          boundaryPoints[i+1]->InsertValue(newId, this->BoundaryPointArray[i]->GetValue(pts[k]));
-          }
-        vtkIdType cellId = cells[i+1]->InsertNextCell(newPointIds);
-        boundaryCells[i+1]->InsertValue(cellId, this->BoundaryCellArray[i]->GetValue(j));
-        booleanCells[i+1]->InsertValue(cellId, this->BooleanArray[i]->GetValue(j));
+        newPointIds[i][ptId] = numNewPts++;
         }
       }
     }
-  for (int i=0; i<4; i++)
+
+  //Arrays common to both meshes
+  vtkDataSetAttributes::FieldList pointFields(2);
+  pointFields.InitializeFieldList(this->Mesh[0]->GetPointData());
+  pointFields.IntersectFieldList(this->Mesh[1]->GetPointData());
+  vtkDataSetAttributes::FieldList cellFields(2);
+  cellFields.InitializeFieldList(this->Mesh[0]->GetCellData());
+  cellFields.IntersectFieldList(this->Mesh[1]->GetCellData());
+
+  vtkNew(vtkPoints, newPoints);
+  newPoints->SetDataType(pointType);
+  newPoints->SetNumberOfPoints(numNewPts);
+  vtkNew(vtkCellArray, newPolys);
+  newPolys->Allocate(connectivitySize);
+
+  vtkNew(vtkPolyData, newMesh);
+  vtkPointData *outPD = newMesh->GetPointData();
+  vtkCellData *outCD = newMesh->GetCellData();
+  outPD->CopyAllocate(pointFields, numNewPts);
+  outCD->CopyAllocate(cellFields, numNewCells);
+
+  vtkIdType newCellId = 0;
+  for (int i=0;i<2;i++)
     {
-    surfaces[i]->SetPoints(points[i]);
-    surfaces[i]->SetPolys(cells[i]);
-    surfaces[i]->BuildLinks();
-    boundaryPoints[i]->SetName("BoundaryPoints");
-    surfaces[i]->GetPointData()->AddArray(boundaryPoints[i]);
-    boundaryCells[i]->SetName("BoundaryCells");
-    surfaces[i]->GetCellData()->AddArray(boundaryCells[i]);
-    booleanCells[i]->SetName("BooleanRegion");
-    surfaces[i]->GetCellData()->AddArray(booleanCells[i]);
-
-    points[i]->Delete();
-    cells[i]->Delete();
-    boundaryPoints[i]->Delete();
-    boundaryCells[i]->Delete();
-    booleanCells[i]->Delete();
+    vtkPolyData *mesh = this->Mesh[i];
+    vtkPointData *inPD = mesh->GetPointData();
+    vtkCellData *inCD = mesh->GetCellData();
+
+    vtkIdType numPts = mesh->GetNumberOfPoints();
+    for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+      {
+      vtkIdType newPtId = newPointIds[i][ptId];
+      if (newPtId != -1)
+        {
+        newPoints->SetPoint(newPtId, mesh->GetPoint(ptId));
+        outPD->CopyData(pointFields, inPD, i, ptId, newPtId);
+        }
+      }
+
+    vtkIdType numCells = mesh->GetNumberOfCells();
+    for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+      {
+      if (this->BooleanArray[i]->GetValue(cellId) != keepValue[i])
+        {
+        continue;
+        }
+      vtkIdType npts, *pts;
+      mesh->GetCellPoints(cellId, npts, pts);
+      newPolys->InsertNextCell(npts);
+      for (vtkIdType j = 0; j < npts; j++)
+        {
+        newPolys->InsertCellPoint(newPointIds[i][pts[j]]);
+        }
+      outCD->CopyData(cellFields, inCD, i, cellId, newCellId++);
+      }
     }
+
+  newMesh->SetPoints(newPoints);
+  newMesh->SetPolys(newPolys);
+
+  output->DeepCopy(newMesh);
 }
@@ -46,6 +46,9 @@
  * The ouput result will have data about the Original Surface,
  * BoundaryPoints, Boundary Cells,
  * Free Edges, and Bad Triangles
+ * The progress text names the current phase. It is the phase of the
+ * intersection filter while that runs, then "Regions" while the regions
+ * are classified and "Output" while the output surface is built.
  *
  * \author Adam Updegrove
  * \author updega2@gmail.com
@@ -60,6 +63,8 @@
 
 #include "vtkPolyDataAlgorithm.h"
 
+class vtkSVBoundingBoxTree;
+
 class VTKSVBOOLEAN_EXPORT vtkSVLoopBooleanPolyDataFilter :
         public vtkPolyDataAlgorithm
 {
@@ -126,6 +131,13 @@ public:
   vtkGetMacro(Tolerance, double);
   vtkSetMacro(Tolerance, double);
 
+  //@{
+  /// \brief Optional bounding box tree over the triangles of the first input,
+  /// given to vtkSVLoopIntersectionPolyDataFilter::SetFirstInputTree.
+  virtual void SetFirstInputTree(vtkSVBoundingBoxTree*);
+  vtkGetObjectMacro(FirstInputTree, vtkSVBoundingBoxTree);
+  //@}
+
 protected:
   vtkSVLoopBooleanPolyDataFilter();
   ~vtkSVLoopBooleanPolyDataFilter();
@@ -144,6 +156,8 @@ protected:
   int Status;
   double Tolerance;
 
+  vtkSVBoundingBoxTree *FirstInputTree;
+
   /// brief A class containing the actual implementation. Called during Update
   class Impl;
 
@@ -0,0 +1,389 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVLoopBooleanSession.h"
+
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkIdTypeArray.h"
+#include "vtkObjectFactory.h"
+#include "vtkSMPTools.h"
+#include "vtkSVGlobals.h"
+
+namespace
+{
+
+// Cell data array with the cell ids of the result before an operation, the
+// cells of the other surface get -1
+const char *SessionCellIdsName = "SessionCellIds";
+
+// ----------------------
+// AddCellIds
+// ----------------------
+void AddCellIds(vtkPolyData *surface, const bool numbered)
+{
+  vtkIdType numCells = surface->GetNumberOfCells();
+  vtkNew(vtkIdTypeArray, cellIds);
+  cellIds->SetName(SessionCellIdsName);
+  cellIds->SetNumberOfTuples(numCells);
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    cellIds->SetValue(cellId, numbered ? cellId : -1);
+    }
+  surface->GetCellData()->AddArray(cellIds);
+}
+
+// ----------------------
+// ComputeCellBounds
+// ----------------------
+// Bounds of every triangle grown by the tolerance. Any other cell gets empty
+// bounds and is never a candidate. The cells of the mesh must be built.
+class ComputeCellBounds
+{
+public:
+  vtkPolyData *Mesh;
+  double      *Bounds;
+  double      Tolerance;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double pts[3][3];
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      double *b = &this->Bounds[6*cellId];
+      if (this->Mesh->GetCellType(cellId) != VTK_TRIANGLE)
+        {
+        b[0] = b[2] = b[4] = VTK_DOUBLE_MAX;
+        b[1] = b[3] = b[5] = -VTK_DOUBLE_MAX;
+        continue;
+        }
+      vtkIdType npts, *ptIds;
+      this->Mesh->GetCellPoints(cellId, npts, ptIds);
+      for (int i = 0; i < 3; i++)
+        {
+        this->Mesh->GetPoint(ptIds[i], pts[i]);
+        }
+      for (int j = 0; j < 3; j++)
+        {
+        b[2*j]   = svminimum(pts[0][j], svminimum(pts[1][j], pts[2][j])) - this->Tolerance;
+        b[2*j+1] = svmaximum(pts[0][j], svmaximum(pts[1][j], pts[2][j])) + this->Tolerance;
+        }
+      }
+  }
+};
+
+}
+
+// ----------------------
+// StandardNewMacro
+// ----------------------
+vtkStandardNewMacro(vtkSVLoopBooleanSession);
+
+// ----------------------
+// Constructor
+// ----------------------
+vtkSVLoopBooleanSession::vtkSVLoopBooleanSession()
+{
+  this->Result = NULL;
+  this->Tree   = vtkSVBoundingBoxTree::New();
+
+  this->Tolerance = 1e-6;
+  this->Operation = vtkSVLoopBooleanPolyDataFilter::VTK_UNION;
+  this->NumberOfIntersectionPoints = 0;
+  this->NumberOfIntersectionLines  = 0;
+  this->NumberOfTreeBuilds = 0;
+  this->NumberOfAddedCells = 0;
+  this->NumberOfBuiltCells = 0;
+}
+
+// ----------------------
+// Destructor
+// ----------------------
+vtkSVLoopBooleanSession::~vtkSVLoopBooleanSession()
+{
+  if (this->Result)
+    {
+    this->Result->UnRegister(this);
+    this->Result = NULL;
+    }
+  if (this->Tree)
+    {
+    this->Tree->Delete();
+    this->Tree = NULL;
+    }
+}
+
+// ----------------------
+// PrintSelf
+// ----------------------
+void vtkSVLoopBooleanSession::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Tolerance: " << this->Tolerance << "\n";
+  os << indent << "Operation: " << this->Operation << "\n";
+  os << indent << "NumberOfIntersectionPoints: " <<
+          this->NumberOfIntersectionPoints << "\n";
+  os << indent << "NumberOfIntersectionLines: " <<
+          this->NumberOfIntersectionLines << "\n";
+  os << indent << "NumberOfTreeBuilds: " << this->NumberOfTreeBuilds << "\n";
+  os << indent << "Result: " << this->Result << "\n";
+  os << indent << "Tree: " << this->Tree << "\n";
+}
+
+// ----------------------
+// Initialize
+// ----------------------
+int vtkSVLoopBooleanSession::Initialize(vtkPolyData *surface)
+{
+  if (surface == NULL)
+    {
+    vtkErrorMacro("No surface to start the session with");
+    return SV_ERROR;
+    }
+
+  if (surface != this->Result)
+    {
+    surface->Register(this);
+    if (this->Result)
+      {
+      this->Result->UnRegister(this);
+      }
+    this->Result = surface;
+    }
+  this->NumberOfIntersectionPoints = 0;
+  this->NumberOfIntersectionLines  = 0;
+  this->NumberOfTreeBuilds = 0;
+
+  this->UpdateTree();
+  this->Modified();
+
+  return SV_OK;
+}
+
+// ----------------------
+// Apply
+// ----------------------
+int vtkSVLoopBooleanSession::Apply(vtkPolyData *surface)
+{
+  if (this->Result == NULL)
+    {
+    vtkErrorMacro("Session must be initialized before an operation");
+    return SV_ERROR;
+    }
+  this->NumberOfIntersectionPoints = 0;
+  this->NumberOfIntersectionLines  = 0;
+
+  if (!this->IsNearResult(surface))
+    {
+    vtkDebugMacro("Surface is not near the result, no boolean needed");
+    return SV_OK;
+    }
+
+  // The cell ids are passed through the boolean as cell data, the arrays
+  // kept are the ones both surfaces have
+  vtkIdType numCells = this->Result->GetNumberOfCells();
+  AddCellIds(this->Result, true);
+  vtkNew(vtkPolyData, input);
+  input->ShallowCopy(surface);
+  AddCellIds(input, false);
+
+  vtkNew(vtkSVLoopBooleanPolyDataFilter, boolean);
+  boolean->SetInputData(0, this->Result);
+  boolean->SetInputData(1, input);
+  boolean->SetTolerance(this->Tolerance);
+  boolean->SetOperation(this->Operation);
+  boolean->SetFirstInputTree(this->Tree);
+  boolean->Update();
+  this->Result->GetCellData()->RemoveArray(SessionCellIdsName);
+  if (boolean->GetStatus() != 1)
+    {
+    vtkErrorMacro("Boolean failed");
+    return SV_ERROR;
+    }
+
+  this->NumberOfIntersectionPoints = boolean->GetNumberOfIntersectionPoints();
+  this->NumberOfIntersectionLines  = boolean->GetNumberOfIntersectionLines();
+  if (this->NumberOfIntersectionPoints == 0 ||
+      this->NumberOfIntersectionLines == 0)
+    {
+    return SV_OK;
+    }
+
+  this->Result->DeepCopy(boolean->GetOutput());
+  vtkIdTypeArray *cellIds = vtkIdTypeArray::SafeDownCast(
+    this->Result->GetCellData()->GetArray(SessionCellIdsName));
+  if (cellIds == NULL)
+    {
+    this->UpdateTree();
+    }
+  else
+    {
+    // Split cells keep the id of the cell they came from, the first piece
+    // takes the place of that cell in the tree
+    std::vector<vtkIdType> newIds(numCells, -1);
+    for (vtkIdType cellId = 0; cellId < cellIds->GetNumberOfTuples(); cellId++)
+      {
+      vtkIdType oldId = cellIds->GetValue(cellId);
+      if (oldId >= 0 && oldId < numCells && newIds[oldId] == -1)
+        {
+        newIds[oldId] = cellId;
+        }
+      }
+    this->Result->GetCellData()->RemoveArray(SessionCellIdsName);
+    this->ReuseTree(newIds);
+    }
+  this->Modified();
+
+  return SV_OK;
+}
+
+// ----------------------
+// UpdateTree
+// ----------------------
+void vtkSVLoopBooleanSession::UpdateTree()
+{
+  this->UpdateCellBounds();
+  vtkIdType numCells = this->Result->GetNumberOfCells();
+  if (numCells == 0)
+    {
+    this->Tree->Initialize();
+    }
+  else
+    {
+    this->Tree->Build(&this->CellBounds[0], numCells);
+    }
+  this->NumberOfTreeBuilds++;
+  this->NumberOfAddedCells = 0;
+  this->NumberOfBuiltCells = numCells;
+}
+
+// ----------------------
+// ReuseTree
+// ----------------------
+void vtkSVLoopBooleanSession::ReuseTree(const std::vector<vtkIdType> &newIds)
+{
+  vtkIdType numCells = this->Result->GetNumberOfCells();
+  vtkIdType numKept = 0;
+  for (size_t i = 0; i < newIds.size(); i++)
+    {
+    if (newIds[i] != -1)
+      {
+      numKept++;
+      }
+    }
+
+  // A tree that is mostly added cells is not much better than a new one
+  this->NumberOfAddedCells += numCells - numKept;
+  if (numKept == 0 || newIds.empty() ||
+      this->NumberOfAddedCells > this->NumberOfBuiltCells)
+    {
+    this->UpdateTree();
+    return;
+    }
+
+  this->UpdateCellBounds();
+  this->Tree->Update(&this->CellBounds[0], numCells, &newIds[0]);
+}
+
+// ----------------------
+// UpdateCellBounds
+// ----------------------
+void vtkSVLoopBooleanSession::UpdateCellBounds()
+{
+  vtkIdType numCells = this->Result->GetNumberOfCells();
+  this->CellBounds.resize(6*numCells);
+  if (numCells == 0)
+    {
+    return;
+    }
+
+  // Cells are read by several threads
+  this->Result->BuildCells();
+
+  ComputeCellBounds computer;
+  computer.Mesh      = this->Result;
+  computer.Bounds    = &this->CellBounds[0];
+  computer.Tolerance = this->Tolerance;
+  vtkSMPTools::For(0, numCells, computer);
+}
+
+// ----------------------
+// IsNearResult
+// ----------------------
+bool vtkSVLoopBooleanSession::IsNearResult(vtkPolyData *surface)
+{
+  double surfaceBounds[6], treeBounds[6];
+  if (!this->Tree->GetBounds(treeBounds) ||
+      surface->GetNumberOfCells() == 0)
+    {
+    return false;
+    }
+  surface->GetBounds(surfaceBounds);
+  for (int i = 0; i < 3; i++)
+    {
+    surfaceBounds[2*i]   -= this->Tolerance;
+    surfaceBounds[2*i+1] += this->Tolerance;
+    }
+  if (!vtkSVBoundingBoxTree::BoundsOverlap(surfaceBounds, treeBounds))
+    {
+    return false;
+    }
+
+  std::vector<vtkIdType> overlaps;
+  vtkIdType numCells = surface->GetNumberOfCells();
+  double pts[3][3], bounds[6];
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    if (surface->GetCellType(cellId) != VTK_TRIANGLE)
+      {
+      continue;
+      }
+    vtkIdType npts, *ptIds;
+    surface->GetCellPoints(cellId, npts, ptIds);
+    for (int i = 0; i < 3; i++)
+      {
+      surface->GetPoint(ptIds[i], pts[i]);
+      }
+    for (int j = 0; j < 3; j++)
+      {
+      bounds[2*j]   = svminimum(pts[0][j], svminimum(pts[1][j], pts[2][j])) - this->Tolerance;
+      bounds[2*j+1] = svmaximum(pts[0][j], svmaximum(pts[1][j], pts[2][j])) + this->Tolerance;
+      }
+    this->Tree->FindOverlappingBoxes(bounds, overlaps);
+    if (!overlaps.empty())
+      {
+      return true;
+      }
+    }
+
+  return false;
+}
@@ -0,0 +1,171 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class vtkSVLoopBooleanSession
+ *  \brief Runs a series of booleans with vtkSVLoopBooleanPolyDataFilter on
+ *  one running result, keeping a bounding box tree over the triangles of
+ *  the result from one operation to the next.
+ *
+ *  \details Each new surface is first checked against the tree, and a
+ *  surface that is not near any triangle of the result is left out without
+ *  running the boolean. Otherwise the tree is given to the boolean, so the
+ *  search for intersecting triangles follows the size of the new surface
+ *  instead of the size of the result. The cells of the result are numbered
+ *  before each operation, so afterwards the tree is updated rather than
+ *  built again: the cells that are still there keep their place in the
+ *  tree, and the new cells get a small tree joined at the root. The tree is
+ *  built again once more cells were added than were there at the last
+ *  build.
+ *
+ *  The surface given to Initialize is the result and is changed in place,
+ *  so arrays added to it between operations are kept as long as the
+ *  boolean passes them on.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVLoopBooleanSession_h
+#define vtkSVLoopBooleanSession_h
+
+#include "vtkSVBooleanModule.h" // For export macro
+
+#include "vtkObject.h"
+#include "vtkPolyData.h"
+#include "vtkSVBoundingBoxTree.h"
+#include "vtkSVLoopBooleanPolyDataFilter.h"
+
+#include <vector>
+
+class VTKSVBOOLEAN_EXPORT vtkSVLoopBooleanSession : public vtkObject
+{
+public:
+  static vtkSVLoopBooleanSession *New();
+  vtkTypeMacro(vtkSVLoopBooleanSession,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  //@{
+  /// \brief The tolerance for geometric tests, set before Initialize.
+  /// Default is 1e-6.
+  vtkSetMacro(Tolerance, double);
+  vtkGetMacro(Tolerance, double);
+  //@}
+
+  //@{
+  /// \brief The boolean operation to perform. Defaults to union.
+  vtkSetClampMacro(Operation, int,
+                   vtkSVLoopBooleanPolyDataFilter::VTK_UNION,
+                   vtkSVLoopBooleanPolyDataFilter::VTK_DIFFERENCE);
+  vtkGetMacro(Operation, int);
+  void SetOperationToUnion()
+  { this->SetOperation(vtkSVLoopBooleanPolyDataFilter::VTK_UNION); }
+  void SetOperationToIntersection()
+  { this->SetOperation(vtkSVLoopBooleanPolyDataFilter::VTK_INTERSECTION); }
+  void SetOperationToDifference()
+  { this->SetOperation(vtkSVLoopBooleanPolyDataFilter::VTK_DIFFERENCE); }
+  //@}
+
+  //@{
+  /// \brief Number of intersection points and lines of the last operation,
+  /// zero if the surfaces did not intersect.
+  vtkGetMacro(NumberOfIntersectionPoints, int);
+  vtkGetMacro(NumberOfIntersectionLines, int);
+  //@}
+
+  //@{
+  /// \brief Number of times the tree was built from scratch, the other
+  /// operations updated it.
+  vtkGetMacro(NumberOfTreeBuilds, int);
+  //@}
+
+  //@{
+  /// \brief The running result and the tree over its triangles.
+  vtkGetObjectMacro(Result, vtkPolyData);
+  vtkGetObjectMacro(Tree, vtkSVBoundingBoxTree);
+  //@}
+
+  /** \brief Start a session with a surface as the result.
+   *  \return SV_OK, or SV_ERROR if the surface is NULL. */
+  int Initialize(vtkPolyData *surface);
+
+  /** \brief Perform the operation between the result and a surface.
+   *  \return SV_OK, or SV_ERROR if the boolean failed. If the surfaces do
+   *  not intersect the result is not changed and the number of intersection
+   *  lines is zero. */
+  int Apply(vtkPolyData *surface);
+
+  /** \brief Recompute the tree, needed only if the points or cells of the
+   *  result were changed outside of the session. */
+  void UpdateTree();
+
+protected:
+  vtkSVLoopBooleanSession();
+  ~vtkSVLoopBooleanSession();
+
+  /** \brief True if the bounds of any triangle of the surface overlap the
+   *  bounds of a triangle of the result. Both are grown by the tolerance,
+   *  the same as in the search of the boolean. */
+  bool IsNearResult(vtkPolyData *surface);
+
+  /** \brief Recompute the bounds of the cells of the result. */
+  void UpdateCellBounds();
+
+  /** \brief Keep the tree after an operation.
+   *  \param newIds Cell of the result each cell of the old result became,
+   *  -1 if it was removed. */
+  void ReuseTree(const std::vector<vtkIdType> &newIds);
+
+  vtkPolyData *Result;
+  vtkSVBoundingBoxTree *Tree;
+
+  /// \brief Six bounds per cell of the result, kept to reuse the memory.
+  std::vector<double> CellBounds;
+
+  double Tolerance;
+  int Operation;
+  int NumberOfIntersectionPoints;
+  int NumberOfIntersectionLines;
+  int NumberOfTreeBuilds;
+
+  /// \brief Cells added to the tree since it was last built, and the cells
+  /// it was built with.
+  vtkIdType NumberOfAddedCells;
+  vtkIdType NumberOfBuiltCells;
+
+private:
+  vtkSVLoopBooleanSession(const vtkSVLoopBooleanSession&);  // Not implemented.
+  void operator=(const vtkSVLoopBooleanSession&);  // Not implemented.
+};
+
+#endif
@@ -29,20 +29,17 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#define OLD 0
-#define TRIANGLE 1
-#define CURRENT 2
 #include "vtkSVLoopIntersectionPolyDataFilter.h"
 #include "delaunay_options.h"
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCleanPolyData.h"
-#if VTKSV_DELAUNAY_TYPE == OLD
+#ifdef VTKSV_DELAUNAY_OLD
 #include "vtkDelaunay2D_60.h"
-#elif VTKSV_DELAUNAY_TYPE == TRIANGLE
-#include "triangle.h"
-#include "vtkTriangleDelaunay2D.h"
+#elif defined(VTKSV_DELAUNAY_TRIANGLE)
+#include "vtkDelaunay2D.h"
+#include "vtkSVConstrainedTriangulator.h"
 #else
 #include "vtkDelaunay2D.h"
 #endif
@@ -57,10 +54,14 @@
 #include "vtkPointData.h"
 #include "vtkPointLocator.h"
 #include "vtkPoints.h"
+#include "vtkPolyData.h"
 #include "vtkPolyDataNormals.h"
 #include "vtkPolygon.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSortDataArray.h"
 #include "vtkSmartPointer.h"
+#include "vtkSVBoundingBoxTree.h"
 #include "vtkSVGlobals.h"
 #include "vtkTriangle.h"
 #include "vtkTriangleFilter.h"
@@ -68,8 +69,15 @@
 #include "vtkTransformPolyDataFilter.h"
 #include "vtkUnstructuredGrid.h"
 
+#include "predicates.h"
+
+#include <algorithm>
+#include <cfloat>
 #include <list>
 #include <map>
+#include <memory>
+#include <set>
+#include <vector>
 
 //----------------------------------------------------------------------------
 // Helper typedefs and data structures.
@@ -93,13 +101,497 @@ struct simPolygon
   int orientation; // their orientation
 };
 
+// ----------------------
+// TriangleHit
+// ----------------------
+struct TriangleHit
+{
+  vtkIdType cellId0; // cell on first mesh
+  vtkIdType cellId1; // cell on second mesh
+  double pt0[3]; // intersection line start
+  double pt1[3]; // intersection line end
+  double surfaceid[2]; // surface of the two line points
+
+  bool operator<(const TriangleHit &other) const
+  {
+    return this->cellId0 < other.cellId0 ||
+           (this->cellId0 == other.cellId0 && this->cellId1 < other.cellId1);
+  }
+
+  bool operator==(const TriangleHit &other) const
+  {
+    return this->cellId0 == other.cellId0 && this->cellId1 == other.cellId1;
+  }
+};
+
+// ----------------------
+// GetTriangleCoordinates
+// ----------------------
+// Nine coordinates of every triangle and its bounds grown by the tolerance.
+// Any other cell gets empty bounds and is never a candidate.
+void GetTriangleCoordinates(vtkPolyData *mesh, double tolerance,
+                            std::vector<double> &coords,
+                            std::vector<double> &bounds)
+{
+  vtkIdType numCells = mesh->GetNumberOfCells();
+  coords.resize(9*numCells);
+  bounds.resize(6*numCells);
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    double *x = &coords[9*cellId];
+    double *b = &bounds[6*cellId];
+    if (mesh->GetCellType(cellId) != VTK_TRIANGLE)
+      {
+      b[0] = b[2] = b[4] = VTK_DOUBLE_MAX;
+      b[1] = b[3] = b[5] = -VTK_DOUBLE_MAX;
+      continue;
+      }
+    vtkIdType npts, *ptIds;
+    mesh->GetCellPoints(cellId, npts, ptIds);
+    for (int i = 0; i < 3; i++)
+      {
+      mesh->GetPoint(ptIds[i], &x[3*i]);
+      }
+    for (int j = 0; j < 3; j++)
+      {
+      b[2*j]   = svminimum(x[j], svminimum(x[3+j], x[6+j])) - tolerance;
+      b[2*j+1] = svmaximum(x[j], svmaximum(x[3+j], x[6+j])) + tolerance;
+      }
+    }
+}
+
+// ----------------------
+// InitializePredicates
+// ----------------------
+int InitializePredicates()
+{
+  p_exactinit();
+  return 1;
+}
+
+// ----------------------
+// Orient3dErrorBound
+// ----------------------
+// Relative error bound of the floating point orient3d determinant, the
+// same bound predicates.c uses before it goes adaptive.
+const double Orient3dEpsilon    = 0.5*DBL_EPSILON;
+const double Orient3dErrorBound = (7.0 + 56.0*Orient3dEpsilon)*Orient3dEpsilon;
+
+// ----------------------
+// Orient3dFilter
+// ----------------------
+// Floating point orient3d determinant of the points a, b, c and d given
+// relative to d, and the bound its sign is certain beyond.
+inline void Orient3dFilter(double adx, double ady, double adz,
+                           double bdx, double bdy, double bdz,
+                           double cdx, double cdy, double cdz,
+                           double &det, double &errorBound)
+{
+  double bdxcdy = bdx*cdy;
+  double cdxbdy = cdx*bdy;
+  double cdxady = cdx*ady;
+  double adxcdy = adx*cdy;
+  double adxbdy = adx*bdy;
+  double bdxady = bdx*ady;
+
+  det = adz*(bdxcdy - cdxbdy) + bdz*(cdxady - adxcdy) + cdz*(adxbdy - bdxady);
+  errorBound = Orient3dErrorBound*
+    ((fabs(bdxcdy) + fabs(cdxbdy))*fabs(adz) +
+     (fabs(cdxady) + fabs(adxcdy))*fabs(bdz) +
+     (fabs(adxbdy) + fabs(bdxady))*fabs(cdz));
+}
+
+// ----------------------
+// Orient3dSign
+// ----------------------
+// Sign of a filtered determinant, computed again with the adaptive exact
+// predicate when the filter can not decide it.
+inline int Orient3dSign(double det, double errorBound, const double a[3],
+                        const double b[3], const double c[3], const double d[3])
+{
+  if (det > errorBound)
+    {
+    return 1;
+    }
+  if (-det > errorBound)
+    {
+    return -1;
+    }
+  double pa[3] = {a[0], a[1], a[2]};
+  double pb[3] = {b[0], b[1], b[2]};
+  double pc[3] = {c[0], c[1], c[2]};
+  double pd[3] = {d[0], d[1], d[2]};
+  double exact = p_orient3d(pa, pb, pc, pd);
+  return (exact > 0.0) - (exact < 0.0);
+}
+
+// ----------------------
+// TrianglePairFilter
+// ----------------------
+// Batch of triangles tested against one triangle for a plane that separates
+// them. The determinants of all pairs are computed over flat arrays in loops
+// without branches that the compiler can vectorize. Only the signs their
+// error bounds do not decide go to the exact predicate. The signs are exact,
+// so a pair is dropped when the points of one triangle are strictly on one
+// side of the plane of the other, however close they are. Such a pair can
+// not intersect, but TriangleTriangleIntersection may still give a line for
+// it when it is closer than the tolerance. InitializePredicates must have
+// been called.
+class TrianglePairFilter
+{
+public:
+  /// \brief Empty the batch
+  void Reset()
+  {
+    this->Coords.clear();
+  }
+
+  /// \brief Add a triangle given by its nine coordinates
+  void AddTriangle(const double tri[9])
+  {
+    this->Coords.insert(this->Coords.end(), tri, tri+9);
+  }
+
+  size_t GetNumberOfTriangles() const
+  {
+    return this->Coords.size()/9;
+  }
+
+  const double *GetTriangle(size_t i) const
+  {
+    return &this->Coords[9*i];
+  }
+
+  /// \brief Keep every triangle of the batch
+  void KeepAll()
+  {
+    this->Keep.assign(this->GetNumberOfTriangles(), 1);
+  }
+
+  /// \brief Keep only the triangles of the batch that touch tri. A pair is
+  /// dropped when all points of either triangle are strictly on one side of
+  /// the plane of the other.
+  void Run(const double tri[9])
+  {
+    size_t n = this->GetNumberOfTriangles();
+    this->Keep.resize(n);
+    if (n == 0)
+      {
+      return;
+      }
+
+    // Coordinates of the batch by component
+    this->Components.resize(9*n);
+    for (size_t k = 0; k < n; k++)
+      {
+      for (int j = 0; j < 9; j++)
+        {
+        this->Components[j*n+k] = this->Coords[9*k+j];
+        }
+      }
+    const double *x = &this->Components[0];
+
+    this->Dets.resize(6*n);
+    this->ErrorBounds.resize(6*n);
+    for (int v = 0; v < 3; v++)
+      {
+      // Point v of tri against the planes of the batch
+      const double dx = tri[3*v], dy = tri[3*v+1], dz = tri[3*v+2];
+      double *det = &this->Dets[v*n];
+      double *errorBound = &this->ErrorBounds[v*n];
+      for (size_t k = 0; k < n; k++)
+        {
+        Orient3dFilter(x[k]-dx,     x[n+k]-dy,   x[2*n+k]-dz,
+                       x[3*n+k]-dx, x[4*n+k]-dy, x[5*n+k]-dz,
+                       x[6*n+k]-dx, x[7*n+k]-dy, x[8*n+k]-dz,
+                       det[k], errorBound[k]);
+        }
+
+      // Point v of the batch against the plane of tri
+      const double *px = &x[3*v*n], *py = &x[(3*v+1)*n], *pz = &x[(3*v+2)*n];
+      det = &this->Dets[(3+v)*n];
+      errorBound = &this->ErrorBounds[(3+v)*n];
+      for (size_t k = 0; k < n; k++)
+        {
+        Orient3dFilter(tri[0]-px[k], tri[1]-py[k], tri[2]-pz[k],
+                       tri[3]-px[k], tri[4]-py[k], tri[5]-pz[k],
+                       tri[6]-px[k], tri[7]-py[k], tri[8]-pz[k],
+                       det[k], errorBound[k]);
+        }
+      }
+
+    for (size_t k = 0; k < n; k++)
+      {
+      const double *other = this->GetTriangle(k);
+      int signs[3];
+      for (int v = 0; v < 3; v++)
+        {
+        signs[v] = Orient3dSign(this->Dets[v*n+k], this->ErrorBounds[v*n+k],
+                                &other[0], &other[3], &other[6], &tri[3*v]);
+        }
+      if (signs[0] == signs[1] && signs[0] == signs[2] && signs[0] != 0)
+        {
+        this->Keep[k] = 0;
+        continue;
+        }
+
+      for (int v = 0; v < 3; v++)
+        {
+        signs[v] = Orient3dSign(this->Dets[(3+v)*n+k], this->ErrorBounds[(3+v)*n+k],
+                                &tri[0], &tri[3], &tri[6], &other[3*v]);
+        }
+      this->Keep[k] = !(signs[0] == signs[1] && signs[0] == signs[2] && signs[0] != 0);
+      }
+  }
+
+  /// \brief One for every triangle of the batch that is kept
+  std::vector<char> Keep;
+
+private:
+  std::vector<double> Coords;
+  std::vector<double> Components;
+  std::vector<double> Dets;
+  std::vector<double> ErrorBounds;
+};
+
+// ----------------------
+// FindTriangleHits
+// ----------------------
+// Tests each triangle of the first mesh against the triangles of the second
+// mesh whose bounds it overlaps. Every thread keeps its own hits.
+class FindTriangleHits
+{
+public:
+  const std::vector<double> *Coords0;
+  const std::vector<double> *Bounds0;
+  const std::vector<double> *Coords1;
+  vtkSVBoundingBoxTree      *Tree1;
+  double                    Tolerance;
+  int                       UseExactPredicates;
+
+  vtkSMPThreadLocal<std::vector<TriangleHit> > Hits;
+  vtkSMPThreadLocal<std::vector<vtkIdType> >   Candidates;
+  vtkSMPThreadLocal<TrianglePairFilter>        Filters;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<TriangleHit> &hits      = this->Hits.Local();
+    std::vector<vtkIdType> &candidates  = this->Candidates.Local();
+    TrianglePairFilter &filter          = this->Filters.Local();
+    double tri0[9], tri1[9];
+    for (vtkIdType cellId0 = begin; cellId0 < end; cellId0++)
+      {
+      const double *bounds0 = &(*this->Bounds0)[6*cellId0];
+      if (bounds0[0] > bounds0[1])
+        {
+        continue;
+        }
+      std::copy(&(*this->Coords0)[9*cellId0], &(*this->Coords0)[9*cellId0]+9, tri0);
+
+      candidates.clear();
+      this->Tree1->FindOverlappingBoxes(bounds0, candidates);
+
+      filter.Reset();
+      for (size_t c = 0; c < candidates.size(); c++)
+        {
+        filter.AddTriangle(&(*this->Coords1)[9*candidates[c]]);
+        }
+      if (this->UseExactPredicates)
+        {
+        filter.Run(tri0);
+        }
+      else
+        {
+        filter.KeepAll();
+        }
+
+      for (size_t c = 0; c < candidates.size(); c++)
+        {
+        if (!filter.Keep[c])
+          {
+          continue;
+          }
+        vtkIdType cellId1 = candidates[c];
+        std::copy(filter.GetTriangle(c), filter.GetTriangle(c)+9, tri1);
+
+        TriangleHit hit;
+        int coplanar = 0;
+        int intersects =
+          vtkSVLoopIntersectionPolyDataFilter::TriangleTriangleIntersection
+          (&tri0[0], &tri0[3], &tri0[6], &tri1[0], &tri1[3], &tri1[6],
+           coplanar, hit.pt0, hit.pt1, hit.surfaceid, this->Tolerance);
+
+        // Coplanar triangle intersection is not handled, same as the
+        // serial search
+        if (intersects && !coplanar)
+          {
+          hit.cellId0 = cellId0;
+          hit.cellId1 = cellId1;
+          hits.push_back(hit);
+          }
+        }
+      }
+  }
+};
+
+// ----------------------
+// FindTriangleHitsInFirst
+// ----------------------
+// Same as FindTriangleHits with a tree over the first mesh, so each triangle
+// of the second mesh is tested against the triangles of the first mesh whose
+// bounds it overlaps. The first mesh is only read, its cells must be built.
+class FindTriangleHitsInFirst
+{
+public:
+  vtkPolyData               *Mesh0;
+  const std::vector<double> *Coords1;
+  const std::vector<double> *Bounds1;
+  vtkSVBoundingBoxTree      *Tree0;
+  double                    Tolerance;
+  int                       UseExactPredicates;
+
+  vtkSMPThreadLocal<std::vector<TriangleHit> > Hits;
+  vtkSMPThreadLocal<std::vector<vtkIdType> >   Candidates;
+  vtkSMPThreadLocal<TrianglePairFilter>        Filters;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<TriangleHit> &hits      = this->Hits.Local();
+    std::vector<vtkIdType> &candidates  = this->Candidates.Local();
+    TrianglePairFilter &filter          = this->Filters.Local();
+    double tri0[9], tri1[9];
+    for (vtkIdType cellId1 = begin; cellId1 < end; cellId1++)
+      {
+      const double *bounds1 = &(*this->Bounds1)[6*cellId1];
+      if (bounds1[0] > bounds1[1])
+        {
+        continue;
+        }
+      std::copy(&(*this->Coords1)[9*cellId1], &(*this->Coords1)[9*cellId1]+9, tri1);
+
+      candidates.clear();
+      this->Tree0->FindOverlappingBoxes(bounds1, candidates);
+
+      // Gather the triangles among the candidates
+      size_t numTriangles = 0;
+      filter.Reset();
+      for (size_t c = 0; c < candidates.size(); c++)
+        {
+        vtkIdType cellId0 = candidates[c];
+        if (this->Mesh0->GetCellType(cellId0) != VTK_TRIANGLE)
+          {
+          continue;
+          }
+        vtkIdType npts, *ptIds;
+        this->Mesh0->GetCellPoints(cellId0, npts, ptIds);
+        for (int i = 0; i < 3; i++)
+          {
+          this->Mesh0->GetPoint(ptIds[i], &tri0[3*i]);
+          }
+        filter.AddTriangle(tri0);
+        candidates[numTriangles++] = cellId0;
+        }
+      if (this->UseExactPredicates)
+        {
+        filter.Run(tri1);
+        }
+      else
+        {
+        filter.KeepAll();
+        }
+
+      for (size_t c = 0; c < numTriangles; c++)
+        {
+        if (!filter.Keep[c])
+          {
+          continue;
+          }
+        vtkIdType cellId0 = candidates[c];
+        std::copy(filter.GetTriangle(c), filter.GetTriangle(c)+9, tri0);
+
+        TriangleHit hit;
+        int coplanar = 0;
+        int intersects =
+          vtkSVLoopIntersectionPolyDataFilter::TriangleTriangleIntersection
+          (&tri0[0], &tri0[3], &tri0[6], &tri1[0], &tri1[3], &tri1[6],
+           coplanar, hit.pt0, hit.pt1, hit.surfaceid, this->Tolerance);
+
+        if (intersects && !coplanar)
+          {
+          hit.cellId0 = cellId0;
+          hit.cellId1 = cellId1;
+          hits.push_back(hit);
+          }
+        }
+      }
+  }
+};
+
 }
 
 // ----------------------
 // IntersectionMapType
 // ----------------------
-typedef std::multimap< vtkIdType, vtkIdType >    IntersectionMapType;
-typedef IntersectionMapType::iterator            IntersectionMapIteratorType;
+/// \brief Flat multimap from one id to another. Pairs are appended while
+/// the intersections are found and then sorted once with Sort before any
+/// lookup. The sort is stable so values with the same key keep the order
+/// they were inserted in, the same as std::multimap.
+class IntersectionMapType
+{
+public:
+  typedef std::pair<vtkIdType, vtkIdType>      ValueType;
+  typedef std::vector<ValueType>::const_iterator IteratorType;
+
+  IntersectionMapType() : Sorted(true) {}
+
+  void Insert(vtkIdType key, vtkIdType value)
+    {
+    this->Pairs.push_back(ValueType(key, value));
+    this->Sorted = false;
+    }
+
+  void Sort()
+    {
+    if (this->Sorted)
+      {
+      return;
+      }
+    std::stable_sort(this->Pairs.begin(), this->Pairs.end(), CompareKeys);
+    this->Sorted = true;
+    }
+
+  /// \brief Range of pairs with the given key. Sort must have been called
+  /// since the last insert. Safe to call from several threads.
+  void EqualRange(vtkIdType key, IteratorType &lower, IteratorType &upper) const
+    {
+    lower = std::lower_bound(this->Pairs.begin(), this->Pairs.end(),
+                             ValueType(key, 0), CompareKeys);
+    upper = lower;
+    while (upper != this->Pairs.end() && upper->first == key)
+      {
+      ++upper;
+      }
+    }
+
+  bool Contains(vtkIdType key) const
+    {
+    IteratorType lower = std::lower_bound(this->Pairs.begin(),
+      this->Pairs.end(), ValueType(key, 0), CompareKeys);
+    return lower != this->Pairs.end() && lower->first == key;
+    }
+
+  vtkIdType GetNumberOfValues() const {return this->Pairs.size();}
+
+private:
+  static bool CompareKeys(const ValueType &a, const ValueType &b)
+    {
+    return a.first < b.first;
+    }
+
+  std::vector<ValueType> Pairs;
+  bool Sorted;
+};
+typedef IntersectionMapType::IteratorType        IntersectionMapIteratorType;
 
 // ----------------------
 // CellEdgeLine
@@ -113,8 +605,135 @@ typedef struct _CellEdgeLine {
 // ----------------------
 // PointEdgeMapType
 // ----------------------
-typedef std::multimap< vtkIdType, CellEdgeLineType > PointEdgeMapType;
-typedef PointEdgeMapType::iterator                   PointEdgeMapIteratorType;
+/// \brief Map from a point to the cell edges it lies on. Lookups happen
+/// while the map is still being filled, so instead of sorting, the entries
+/// of each point are chained through an index into one flat array.
+class PointEdgeMapType
+{
+public:
+  /// \brief Get the entry for a point and cell, NULL if there is none.
+  const CellEdgeLineType *Find(vtkIdType ptId, vtkIdType cellId) const
+    {
+    if (ptId >= static_cast<vtkIdType>(this->Heads.size()))
+      {
+      return NULL;
+      }
+    for (vtkIdType i = this->Heads[ptId]; i != -1; i = this->Next[i])
+      {
+      if (this->Entries[i].CellId == cellId)
+        {
+        return &this->Entries[i];
+        }
+      }
+    return NULL;
+    }
+
+  void Insert(vtkIdType ptId, const CellEdgeLineType &entry)
+    {
+    if (ptId >= static_cast<vtkIdType>(this->Heads.size()))
+      {
+      this->Heads.resize(ptId+1, -1);
+      }
+    this->Entries.push_back(entry);
+    this->Next.push_back(this->Heads[ptId]);
+    this->Heads[ptId] = this->Entries.size() - 1;
+    }
+
+private:
+  std::vector<vtkIdType>        Heads;
+  std::vector<vtkIdType>        Next;
+  std::vector<CellEdgeLineType> Entries;
+};
+
+// ----------------------
+// SplitCellWorkspace
+// ----------------------
+/// \brief Scratch objects used to split one cell. Each thread keeps its own
+/// and reuses it for every cell it splits, the objects are made the first
+/// time the thread splits a cell.
+struct SplitCellWorkspace
+{
+  SplitCellWorkspace() : TransformSign(0) {}
+
+  void Initialize()
+    {
+    this->Points         = vtkSmartPointer<vtkPoints>::New();
+    this->Merger         = vtkSmartPointer<vtkPointLocator>::New();
+    this->CellBoundaryPt = vtkSmartPointer<vtkIdTypeArray>::New();
+    this->Lines          = vtkSmartPointer<vtkCellArray>::New();
+    this->InterceptLines = vtkSmartPointer<vtkCellArray>::New();
+    this->NbrCellIds     = vtkSmartPointer<vtkIdList>::New();
+    this->EdgePtIdList   = vtkSmartPointer<vtkIdTypeArray>::New();
+    this->InterPtIdList  = vtkSmartPointer<vtkIdTypeArray>::New();
+    this->AngleList      = vtkSmartPointer<vtkDoubleArray>::New();
+    this->CheckPD        = vtkSmartPointer<vtkPolyData>::New();
+    this->FullPD         = vtkSmartPointer<vtkPolyData>::New();
+    this->Transform      = vtkSmartPointer<vtkTransform>::New();
+    this->Transformer    = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+    this->SplittingPD    = vtkSmartPointer<vtkPolyData>::New();
+#ifdef VTKSV_DELAUNAY_TRIANGLE
+    this->Polys          = vtkSmartPointer<vtkCellArray>::New();
+    this->Triangulator.reset(new vtkSVConstrainedTriangulator);
+#endif
+    }
+
+  vtkSmartPointer<vtkPoints>                  Points;
+  vtkSmartPointer<vtkPointLocator>            Merger;
+  vtkSmartPointer<vtkIdTypeArray>             CellBoundaryPt;
+  vtkSmartPointer<vtkCellArray>               Lines;
+  vtkSmartPointer<vtkCellArray>               InterceptLines;
+  vtkSmartPointer<vtkIdList>                  NbrCellIds;
+  vtkSmartPointer<vtkIdTypeArray>             EdgePtIdList;
+  vtkSmartPointer<vtkIdTypeArray>             InterPtIdList;
+  vtkSmartPointer<vtkDoubleArray>             AngleList;
+  vtkSmartPointer<vtkPolyData>                CheckPD;
+  vtkSmartPointer<vtkPolyData>                FullPD;
+  vtkSmartPointer<vtkTransform>               Transform;
+  vtkSmartPointer<vtkTransformPolyDataFilter> Transformer;
+
+  /// \brief Copy of the cell being split. Used to double check the area of
+  /// small area cells
+  vtkSmartPointer<vtkPolyData>                SplittingPD;
+  int                                         TransformSign;
+
+  std::map<vtkIdType, vtkIdType>              PtIdMap;
+  std::map<vtkIdType, vtkIdType>              ReverseIdMap;
+  std::map<vtkIdType, vtkIdType>              ReverseLineIdMap;
+
+#ifdef VTKSV_DELAUNAY_TRIANGLE
+  /// \brief Loops are given to Triangle directly, keeps its memory between
+  /// cells
+  std::shared_ptr<vtkSVConstrainedTriangulator> Triangulator;
+  std::vector<double>                         PlanarPoints;
+  std::vector<int>                            Segments;
+  std::vector<int>                            Triangles;
+  vtkSmartPointer<vtkCellArray>               Polys;
+#endif
+};
+
+// ----------------------
+// SplitCellResult
+// ----------------------
+/// \brief Everything the split of one cell adds to the output. It is kept
+/// until all cells are split and then added to the output in cell order.
+struct SplitCellResult
+{
+  SplitCellResult() : Status(SV_OK) {}
+
+  /// \brief A new cell that lies on an intersection line.
+  struct NewCell
+  {
+    vtkIdType SubCellId;
+    int       InterPtCount;
+    int       InterPts[3];
+  };
+
+  int                                     Status;
+  /// \brief New cells as the number of points followed by the point ids.
+  std::vector<vtkIdType>                  Cells;
+  std::vector<std::pair<vtkIdType, int> > BoundaryPoints;
+  std::vector<NewCell>                    NewCells;
+};
 
 
 //----------------------------------------------------------------------------
@@ -126,10 +745,27 @@ public:
   Impl();
   virtual ~Impl();
 
-  /// \brief Finds all triangle triangle intersections between two input OOBTrees
+  /// \brief Finds all triangle triangle intersections between two input
+  /// OOBTrees and keeps them in Hits
   static int FindTriangleIntersections(vtkOBBNode *node0, vtkOBBNode *node1,
                                        vtkMatrix4x4 *transform, void *arg);
 
+  /// \brief Finds all triangle triangle intersections with a bounding box
+  /// tree over the second mesh, or over the first mesh if Tree0 is set, and
+  /// keeps them in Hits. The exact tests run in parallel.
+  int FindAllTriangleIntersections();
+
+  /// \brief Adds the lines of all the Hits in order of the first and then
+  /// second cell id, so the output does not depend on the number of threads
+  /// or on which tree found them.
+  int AddAllIntersections();
+
+  /// \brief Adds the intersection line between two triangles to the output
+  /// and to all the maps used later to split the meshes
+  int AddIntersection(vtkIdType cellId0, vtkIdType cellId1,
+                      vtkIdType *triPtIds0, vtkIdType *triPtIds1,
+                      double outpt0[3], double outpt1[3], double surfaceid[2]);
+
   /// \brief Temporarily moving here to try some stuff out
   static int IntersectPlaneWithLine(double p1[3], double p2[3], double n[3],
                                     double p0[3], double& t, double x[3]);
@@ -140,12 +776,17 @@ public:
 
 protected:
 
-  /// \brief Split cells into polygons created by intersection lines
-  vtkCellArray* SplitCell(vtkPolyData *input, vtkIdType cellId,
-                          vtkIdType *cellPts,
-                          IntersectionMapType *map,
-                          vtkPolyData *interLines, int inputIndex,
-                          int numCurrCells);
+  /// \brief Split a cell into polygons created by intersection lines. Does
+  /// not change the filter state, the new cells and everything else the split
+  /// adds to the output are returned in result, so cells can be split in
+  /// parallel.
+  int SplitCell(vtkPolyData *input, vtkIdType cellId, vtkIdType *cellPts,
+                IntersectionMapType *map, double bounds[6],
+                vtkPolyData *interLines, int inputIndex,
+                SplitCellWorkspace &work, SplitCellResult &result);
+
+  /// \brief Splits a range of the cells that need to be split
+  class SplitCellsFunctor;
 
   /// \brief Function to add point to check edge list for remeshing step
   int AddToPointEdgeMap(int index, vtkIdType ptId, double x[3],
@@ -194,10 +835,18 @@ protected:
 public:
   vtkPolyData         *Mesh[2];
   vtkOBBTree          *OBBTree1;
+  vtkSVBoundingBoxTree *Tree0;
+
+  /// \brief Intersecting triangle pairs found by either search
+  std::vector<TriangleHit> Hits;
 
   // Stores the intersection lines.
   vtkCellArray        *IntersectionLines;
 
+  /// \brief End points of every intersection line, smaller id first, to
+  /// find duplicate lines without building links
+  std::set<std::pair<vtkIdType, vtkIdType> > LineEnds;
+
   vtkIdTypeArray      *SurfaceId;
   vtkIdTypeArray      *NewCellIds[2];
 
@@ -227,11 +876,10 @@ public:
   /// cell, and the ID of the line.
   PointEdgeMapType    *PointEdgeMap[2];
 
-  /// \brief vtkPolyData to hold current splitting cell. Used to double check area
-  /// of small area cells
-  vtkPolyData *SplittingPD;
-  int         TransformSign;
+  /// \brief Scratch space for splitting cells, one for each thread
+  vtkSMPThreadLocal<SplitCellWorkspace> SplitWorkspaces;
   double      Tolerance;
+  int         UseExactPredicates;
 
   /// \brief Pointer to overarching filter
   vtkSVLoopIntersectionPolyDataFilter *ParentFilter;
@@ -246,7 +894,7 @@ protected:
 // Impl Constructor
 // ----------------------
 vtkSVLoopIntersectionPolyDataFilter::Impl::Impl() :
-  OBBTree1(0), IntersectionLines(0), SurfaceId(0), PointMerger(0)
+  OBBTree1(0), Tree0(0), IntersectionLines(0), SurfaceId(0), PointMerger(0)
 {
   for (int i = 0; i < 2; i++)
     {
@@ -257,9 +905,8 @@ vtkSVLoopIntersectionPolyDataFilter::Impl::Impl() :
     this->PointEdgeMap[i]         = new PointEdgeMapType();
     }
   this->PointMapper               = new IntersectionMapType();
-  this->SplittingPD               = vtkPolyData::New();
-  this->TransformSign = 0;
   this->Tolerance = 1e-6;
+  this->UseExactPredicates = 1;
 }
 
 // ----------------------
@@ -274,7 +921,6 @@ vtkSVLoopIntersectionPolyDataFilter::Impl::~Impl()
     delete this->PointEdgeMap[i];
     }
   delete this->PointMapper;
-  this->SplittingPD->Delete();
 }
 
 // ----------------------
@@ -291,11 +937,6 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
   vtkPolyData     *mesh0                 = info->Mesh[0];
   vtkPolyData     *mesh1                 = info->Mesh[1];
   vtkOBBTree      *obbTree1              = info->OBBTree1;
-  vtkCellArray    *intersectionLines     = info->IntersectionLines;
-  vtkIdTypeArray  *intersectionSurfaceId = info->SurfaceId;
-  vtkIdTypeArray  *intersectionCellIds0  = info->CellIds[0];
-  vtkIdTypeArray  *intersectionCellIds1  = info->CellIds[1];
-  vtkPointLocator *pointMerger           = info->PointMerger;
   double tolerance                       = info->Tolerance;
 
   //The number of cells in OBBTree
@@ -339,14 +980,13 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
               mesh1->GetPoint(triPtIds1[id], triPts1[id]);
               }
 
+            TriangleHit hit;
             int coplanar = 0;
-            double outpt0[3], outpt1[3];
-            double surfaceid[2];
             int intersects =
               vtkSVLoopIntersectionPolyDataFilter::TriangleTriangleIntersection
               (triPts0[0], triPts0[1], triPts0[2],
                triPts1[0], triPts1[1], triPts1[2],
-               coplanar, outpt0, outpt1, surfaceid, tolerance);
+               coplanar, hit.pt0, hit.pt1, hit.surfaceid, tolerance);
 
             if (coplanar)
               {
@@ -357,187 +997,335 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
               continue;
               }
 
-            //If actual intersection, add point and cell to edge, line,
-            //and surface maps!
+            //If actual intersection, keep it to add the point and cell to
+            //edge, line, and surface maps in order later
             if (intersects)
               {
-              vtkIdType lineId = intersectionLines->GetNumberOfCells();
+              hit.cellId0 = cellId0;
+              hit.cellId1 = cellId1;
+              info->Hits.push_back(hit);
+              }
+            }
+          }
+        }
+      }
+    }
 
-              vtkIdType ptId0, ptId1;
-              int unique[2];
-              unique[0] = pointMerger->InsertUniquePoint(outpt0, ptId0);
-              unique[1] = pointMerger->InsertUniquePoint(outpt1, ptId1);
+  return SV_OK;
+}
 
-              int addline = 1;
-              if (ptId0 == ptId1)
-                {
-                addline = 0;
-                }
+// ----------------------
+// Impl::FindAllTriangleIntersections
+// ----------------------
+int vtkSVLoopIntersectionPolyDataFilter::Impl::FindAllTriangleIntersections()
+{
+  vtkPolyData *mesh0 = this->Mesh[0];
+  vtkPolyData *mesh1 = this->Mesh[1];
+
+  // Flat copies so that the threads do not touch the meshes
+  std::vector<double> coords0, bounds0, coords1, bounds1;
+  GetTriangleCoordinates(mesh1, this->Tolerance, coords1, bounds1);
+
+  std::vector<TriangleHit> &hits = this->Hits;
+  if (this->Tree0)
+    {
+    // Only the triangles of the first mesh near the second are touched
+    mesh0->BuildCells();
+
+    FindTriangleHitsInFirst finder;
+    finder.Mesh0     = mesh0;
+    finder.Coords1   = &coords1;
+    finder.Bounds1   = &bounds1;
+    finder.Tree0     = this->Tree0;
+    finder.Tolerance = this->Tolerance;
+    finder.UseExactPredicates = this->UseExactPredicates;
+    this->ParentFilter->SetProgressText("Segments");
+    this->ParentFilter->UpdateProgress(0.2);
+    vtkSMPTools::For(0, mesh1->GetNumberOfCells(), finder);
+
+    for (vtkSMPThreadLocal<std::vector<TriangleHit> >::iterator it = finder.Hits.begin();
+         it != finder.Hits.end(); ++it)
+      {
+      hits.insert(hits.end(), it->begin(), it->end());
+      }
+    }
+  else
+    {
+    GetTriangleCoordinates(mesh0, this->Tolerance, coords0, bounds0);
 
-              if (ptId0 == ptId1 && surfaceid[0] != surfaceid[1])
-                {
-                intersectionSurfaceId->InsertValue(ptId0, 3);
-                }
-              else
-                {
-                if (unique[0])
-                  {
-                  intersectionSurfaceId->InsertValue(ptId0, surfaceid[0]);
-                  }
-                else
-                  {
-                  if (intersectionSurfaceId->GetValue(ptId0) != 3)
-                    {
-                    intersectionSurfaceId->InsertValue(ptId0, surfaceid[0]);
-                    }
-                  }
-                if (unique[1])
-                  {
-                  intersectionSurfaceId->InsertValue(ptId1, surfaceid[1]);
-                  }
-                else
-                  {
-                  if (intersectionSurfaceId->GetValue(ptId1) != 3)
-                    {
-                    intersectionSurfaceId->InsertValue(ptId1, surfaceid[1]);
-                    }
-                  }
-                }
+    vtkNew(vtkSVBoundingBoxTree, tree1);
+    tree1->Build(bounds1.empty() ? NULL : &bounds1[0], mesh1->GetNumberOfCells());
 
-              info->IntersectionPtsMap[0]->
-                insert(std::make_pair(ptId0, cellId0));
-              info->IntersectionPtsMap[1]->
-                insert(std::make_pair(ptId0, cellId1));
-              info->IntersectionPtsMap[0]->
-                insert(std::make_pair(ptId1, cellId0));
-              info->IntersectionPtsMap[1]->
-                insert(std::make_pair(ptId1, cellId1));
-
-              //Check to see if duplicate line. Line can only be a duplicate
-              //line if both points are not unique and they don't
-              //equal eachother
-              if (!unique[0] && !unique[1] && ptId0 != ptId1)
-                {
-                vtkNew(vtkPolyData, lineTest);
-                lineTest->SetPoints(pointMerger->GetPoints());
-                lineTest->SetLines(intersectionLines);
-                lineTest->BuildLinks();
-                int newLine = info->CheckLine(lineTest, ptId0, ptId1);
-                if (newLine == 0)
-                  {
-                  addline = 0;
-                  }
-                }
-              if (addline)
-                {
-                //If the line is new and does not consist of two identical
-                //points, add the line to the intersection and update
-                //mapping information
-                intersectionLines->InsertNextCell(2);
-                intersectionLines->InsertCellPoint(ptId0);
-                intersectionLines->InsertCellPoint(ptId1);
-
-                intersectionCellIds0->InsertNextValue(cellId0);
-                intersectionCellIds1->InsertNextValue(cellId1);
-
-                info->PointCellIds[0]->InsertValue(ptId0, cellId0);
-                info->PointCellIds[0]->InsertValue(ptId1, cellId0);
-                info->PointCellIds[1]->InsertValue(ptId0, cellId1);
-                info->PointCellIds[1]->InsertValue(ptId1, cellId1);
-
-                info->IntersectionMap[0]->
-                  insert(std::make_pair(cellId0, lineId));
-                info->IntersectionMap[1]->
-                  insert(std::make_pair(cellId1, lineId));
-
-                // Check which edges of cellId0 and cellId1 outpt0 and
-                // outpt1 are on, if any.
-                int isOnEdge=0;
-                int m0p0=0, m0p1=0, m1p0=0, m1p1=0;
-                for (vtkIdType edgeId = 0; edgeId < 3; edgeId++)
-                  {
-                  isOnEdge = info->AddToPointEdgeMap(0, ptId0, outpt0,
-                      mesh0, cellId0, edgeId, lineId, triPtIds0);
-                  if (isOnEdge != -1)
-                    {
-                    m0p0++;
-                    }
-                  isOnEdge = info->AddToPointEdgeMap(0, ptId1, outpt1,
-                      mesh0, cellId0, edgeId, lineId, triPtIds0);
-                  if (isOnEdge != -1)
-                    {
-                    m0p1++;
-                    }
-                  isOnEdge = info->AddToPointEdgeMap(1, ptId0, outpt0,
-                      mesh1, cellId1, edgeId, lineId, triPtIds1);
-                  if (isOnEdge != -1)
-                    {
-                    m1p0++;
-                    }
-                  isOnEdge = info->AddToPointEdgeMap(1, ptId1, outpt1,
-                      mesh1, cellId1, edgeId, lineId, triPtIds1);
-                  if (isOnEdge != -1)
-                    {
-                    m1p1++;
-                    }
-                  }
-                //Special cases caught by tolerance and not from the Point
-                //Merger
-                if (m0p0 > 0 && m1p0 > 0)
-                  {
-                  intersectionSurfaceId->InsertValue(ptId0, 3);
-                  }
-                if (m0p1 > 0 && m1p1 > 0)
-                  {
-                  intersectionSurfaceId->InsertValue(ptId1, 3);
-                  }
-                }
-              //Add information about origin surface to std::maps for
-              //checks later
-              if (intersectionSurfaceId->GetValue(ptId0) == 1)
-                {
-                info->IntersectionPtsMap[0]->
-                  insert(std::make_pair(ptId0, cellId0));
-                }
-              else if (intersectionSurfaceId->GetValue(ptId0) == 2)
-                {
-                info->IntersectionPtsMap[1]->
-                  insert(std::make_pair(ptId0, cellId1));
-                }
-              else
-                {
-                info->IntersectionPtsMap[0]->
-                  insert(std::make_pair(ptId0, cellId0));
-                info->IntersectionPtsMap[1]->
-                  insert(std::make_pair(ptId0, cellId1));
-                }
-              if (intersectionSurfaceId->GetValue(ptId1) == 1)
-                {
-                info->IntersectionPtsMap[0]->
-                  insert(std::make_pair(ptId1, cellId0));
-                }
-              else if (intersectionSurfaceId->GetValue(ptId1) == 2)
-                {
-                info->IntersectionPtsMap[1]->
-                  insert(std::make_pair(ptId1, cellId1));
-                }
-              else
-                {
-                info->IntersectionPtsMap[0]->
-                  insert(std::make_pair(ptId1, cellId0));
-                info->IntersectionPtsMap[1]->
-                  insert(std::make_pair(ptId1, cellId1));
-                }
-              }
-            }
-          }
+    FindTriangleHits finder;
+    finder.Coords0   = &coords0;
+    finder.Bounds0   = &bounds0;
+    finder.Coords1   = &coords1;
+    finder.Tree1     = tree1;
+    finder.Tolerance = this->Tolerance;
+    finder.UseExactPredicates = this->UseExactPredicates;
+    this->ParentFilter->SetProgressText("Segments");
+    this->ParentFilter->UpdateProgress(0.2);
+    vtkSMPTools::For(0, mesh0->GetNumberOfCells(), finder);
+
+    for (vtkSMPThreadLocal<std::vector<TriangleHit> >::iterator it = finder.Hits.begin();
+         it != finder.Hits.end(); ++it)
+      {
+      hits.insert(hits.end(), it->begin(), it->end());
+      }
+    }
+
+  return SV_OK;
+}
+
+// ----------------------
+// Impl::AddAllIntersections
+// ----------------------
+int vtkSVLoopIntersectionPolyDataFilter::Impl::AddAllIntersections()
+{
+  vtkPolyData *mesh0 = this->Mesh[0];
+  vtkPolyData *mesh1 = this->Mesh[1];
+
+  // Merge in a fixed order, a pair of cells may be found twice
+  std::vector<TriangleHit> &hits = this->Hits;
+  std::sort(hits.begin(), hits.end());
+  hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+
+  for (size_t i = 0; i < hits.size(); i++)
+    {
+    TriangleHit &hit = hits[i];
+    vtkIdType npts0, *triPtIds0, npts1, *triPtIds1;
+    mesh0->GetCellPoints(hit.cellId0, npts0, triPtIds0);
+    mesh1->GetCellPoints(hit.cellId1, npts1, triPtIds1);
+    this->AddIntersection(hit.cellId0, hit.cellId1, triPtIds0, triPtIds1,
+                          hit.pt0, hit.pt1, hit.surfaceid);
+    }
+  hits.clear();
+
+  return SV_OK;
+}
+
+// ----------------------
+// Impl::AddIntersection
+// ----------------------
+int vtkSVLoopIntersectionPolyDataFilter::Impl
+::AddIntersection(vtkIdType cellId0, vtkIdType cellId1,
+                  vtkIdType *triPtIds0, vtkIdType *triPtIds1,
+                  double outpt0[3], double outpt1[3], double surfaceid[2])
+{
+  //Set up local structures to hold Impl array information
+  vtkPolyData     *mesh0                 = this->Mesh[0];
+  vtkPolyData     *mesh1                 = this->Mesh[1];
+  vtkCellArray    *intersectionLines     = this->IntersectionLines;
+  vtkIdTypeArray  *intersectionSurfaceId = this->SurfaceId;
+  vtkIdTypeArray  *intersectionCellIds0  = this->CellIds[0];
+  vtkIdTypeArray  *intersectionCellIds1  = this->CellIds[1];
+  vtkPointLocator *pointMerger           = this->PointMerger;
+
+  vtkIdType lineId = intersectionLines->GetNumberOfCells();
+
+  vtkIdType ptId0, ptId1;
+  int unique[2];
+  unique[0] = pointMerger->InsertUniquePoint(outpt0, ptId0);
+  unique[1] = pointMerger->InsertUniquePoint(outpt1, ptId1);
+
+  int addline = 1;
+  if (ptId0 == ptId1)
+    {
+    addline = 0;
+    }
+
+  if (ptId0 == ptId1 && surfaceid[0] != surfaceid[1])
+    {
+    intersectionSurfaceId->InsertValue(ptId0, 3);
+    }
+  else
+    {
+    if (unique[0])
+      {
+      intersectionSurfaceId->InsertValue(ptId0, surfaceid[0]);
+      }
+    else
+      {
+      if (intersectionSurfaceId->GetValue(ptId0) != 3)
+        {
+        intersectionSurfaceId->InsertValue(ptId0, surfaceid[0]);
         }
       }
+    if (unique[1])
+      {
+      intersectionSurfaceId->InsertValue(ptId1, surfaceid[1]);
+      }
+    else
+      {
+      if (intersectionSurfaceId->GetValue(ptId1) != 3)
+        {
+        intersectionSurfaceId->InsertValue(ptId1, surfaceid[1]);
+        }
+      }
+    }
+
+  this->IntersectionPtsMap[0]->
+    Insert(ptId0, cellId0);
+  this->IntersectionPtsMap[1]->
+    Insert(ptId0, cellId1);
+  this->IntersectionPtsMap[0]->
+    Insert(ptId1, cellId0);
+  this->IntersectionPtsMap[1]->
+    Insert(ptId1, cellId1);
+
+  //Check to see if duplicate line. Line can only be a duplicate
+  //line if both points are not unique and they don't
+  //equal eachother
+  std::pair<vtkIdType, vtkIdType> lineEnds(svminimum(ptId0, ptId1),
+                                            svmaximum(ptId0, ptId1));
+  if (!unique[0] && !unique[1] && ptId0 != ptId1)
+    {
+    if (this->LineEnds.count(lineEnds))
+      {
+      addline = 0;
+      }
+    }
+  if (addline)
+    {
+    this->LineEnds.insert(lineEnds);
+
+    //If the line is new and does not consist of two identical
+    //points, add the line to the intersection and update
+    //mapping information
+    intersectionLines->InsertNextCell(2);
+    intersectionLines->InsertCellPoint(ptId0);
+    intersectionLines->InsertCellPoint(ptId1);
+
+    intersectionCellIds0->InsertNextValue(cellId0);
+    intersectionCellIds1->InsertNextValue(cellId1);
+
+    this->PointCellIds[0]->InsertValue(ptId0, cellId0);
+    this->PointCellIds[0]->InsertValue(ptId1, cellId0);
+    this->PointCellIds[1]->InsertValue(ptId0, cellId1);
+    this->PointCellIds[1]->InsertValue(ptId1, cellId1);
+
+    this->IntersectionMap[0]->
+      Insert(cellId0, lineId);
+    this->IntersectionMap[1]->
+      Insert(cellId1, lineId);
+
+    // Check which edges of cellId0 and cellId1 outpt0 and
+    // outpt1 are on, if any.
+    int isOnEdge=0;
+    int m0p0=0, m0p1=0, m1p0=0, m1p1=0;
+    for (vtkIdType edgeId = 0; edgeId < 3; edgeId++)
+      {
+      isOnEdge = this->AddToPointEdgeMap(0, ptId0, outpt0,
+          mesh0, cellId0, edgeId, lineId, triPtIds0);
+      if (isOnEdge != -1)
+        {
+        m0p0++;
+        }
+      isOnEdge = this->AddToPointEdgeMap(0, ptId1, outpt1,
+          mesh0, cellId0, edgeId, lineId, triPtIds0);
+      if (isOnEdge != -1)
+        {
+        m0p1++;
+        }
+      isOnEdge = this->AddToPointEdgeMap(1, ptId0, outpt0,
+          mesh1, cellId1, edgeId, lineId, triPtIds1);
+      if (isOnEdge != -1)
+        {
+        m1p0++;
+        }
+      isOnEdge = this->AddToPointEdgeMap(1, ptId1, outpt1,
+          mesh1, cellId1, edgeId, lineId, triPtIds1);
+      if (isOnEdge != -1)
+        {
+        m1p1++;
+        }
+      }
+    //Special cases caught by tolerance and not from the Point
+    //Merger
+    if (m0p0 > 0 && m1p0 > 0)
+      {
+      intersectionSurfaceId->InsertValue(ptId0, 3);
+      }
+    if (m0p1 > 0 && m1p1 > 0)
+      {
+      intersectionSurfaceId->InsertValue(ptId1, 3);
+      }
+    }
+  //Add information about origin surface to std::maps for
+  //checks later
+  if (intersectionSurfaceId->GetValue(ptId0) == 1)
+    {
+    this->IntersectionPtsMap[0]->
+      Insert(ptId0, cellId0);
+    }
+  else if (intersectionSurfaceId->GetValue(ptId0) == 2)
+    {
+    this->IntersectionPtsMap[1]->
+      Insert(ptId0, cellId1);
+    }
+  else
+    {
+    this->IntersectionPtsMap[0]->
+      Insert(ptId0, cellId0);
+    this->IntersectionPtsMap[1]->
+      Insert(ptId0, cellId1);
+    }
+  if (intersectionSurfaceId->GetValue(ptId1) == 1)
+    {
+    this->IntersectionPtsMap[0]->
+      Insert(ptId1, cellId0);
+    }
+  else if (intersectionSurfaceId->GetValue(ptId1) == 2)
+    {
+    this->IntersectionPtsMap[1]->
+      Insert(ptId1, cellId1);
+    }
+  else
+    {
+    this->IntersectionPtsMap[0]->
+      Insert(ptId1, cellId0);
+    this->IntersectionPtsMap[1]->
+      Insert(ptId1, cellId1);
     }
 
   return SV_OK;
 }
 
+// ----------------------
+// Impl::SplitCellsFunctor
+// ----------------------
+class vtkSVLoopIntersectionPolyDataFilter::Impl::SplitCellsFunctor
+{
+public:
+  Impl                         *Self;
+  vtkPolyData                  *Input;
+  vtkPolyData                  *InterLines;
+  int                          InputIndex;
+  double                       *Bounds;
+  const std::vector<vtkIdType> *CellIds;
+  const std::vector<vtkIdType> *CellPts;
+  std::vector<SplitCellResult> *Results;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    SplitCellWorkspace &work = this->Self->SplitWorkspaces.Local();
+    if (!work.Points)
+      {
+      work.Initialize();
+      }
+    IntersectionMapType *map = this->Self->IntersectionMap[this->InputIndex];
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      vtkIdType cellPts[3];
+      std::copy(&(*this->CellPts)[3*i], &(*this->CellPts)[3*i]+3, cellPts);
+      SplitCellResult &result = (*this->Results)[i];
+      result.Status = this->Self->SplitCell(this->Input, (*this->CellIds)[i],
+        cellPts, map, this->Bounds, this->InterLines, this->InputIndex, work,
+        result);
+      }
+  }
+};
+
 // ----------------------
 // Impl::SplitMesh
 // ----------------------
@@ -617,10 +1405,15 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
     newPolys->EstimateSize(cells->GetNumberOfCells(), 3);
     output->SetPolys(newPolys);
 
+    // Index of each cell in the list of cells to split, -1 if the cell is
+    // not split
+    std::vector<vtkIdType> splitIndex(cells->GetNumberOfCells(), -1);
+    std::vector<vtkIdType> splitCellIds;
+    std::vector<vtkIdType> splitCellPts;
+
     vtkNew( vtkIdList , edgeNeighbors);
     vtkIdType nptsX = 0;
     vtkIdType *pts = 0;
-    vtkNew( vtkIdList , cellsToCheck);
     for (cells->InitTraversal(); cells->GetNextCell(nptsX, pts); cellIdX++)
       {
       if (nptsX != 3)
@@ -630,18 +1423,13 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
         continue;
         }
 
-      cellsToCheck->Reset();
-      cellsToCheck->Allocate(nptsX+1);
-      cellsToCheck->InsertNextId(cellIdX);
-
       // Collect the cells relevant for splitting this cell.  If the
       // cell is in the intersection map, split. If not, one of its
       // edges may be split by an intersection line that splits a
       // neighbor cell. Mark the cell as needing a split if this is
       // the case.
-      bool needsSplit = intersectionMap->find(cellIdX)
-        != intersectionMap->end();
-      for (vtkIdType ptId = 0; ptId < nptsX; ptId++)
+      bool needsSplit = intersectionMap->Contains(cellIdX);
+      for (vtkIdType ptId = 0; ptId < nptsX && !needsSplit; ptId++)
         {
         vtkIdType pt0Id = pts[ptId];
         vtkIdType pt1Id = pts[(ptId+1) % nptsX];
@@ -649,74 +1437,116 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
         input->GetCellEdgeNeighbors(cellIdX, pt0Id, pt1Id, edgeNeighbors);
         for (vtkIdType nbr = 0; nbr < edgeNeighbors->GetNumberOfIds(); nbr++)
           {
-          vtkIdType nbrId = edgeNeighbors->GetId(nbr);
-          cellsToCheck->InsertNextId(nbrId);
-
-          if (intersectionMap->find(nbrId) != intersectionMap->end())
+          if (intersectionMap->Contains(edgeNeighbors->GetId(nbr)))
             {
             needsSplit = true;
             }
           } // for (vtkIdType nbr = 0; ...
         } // for (vtkIdType pt = 0; ...
 
-      // Splitting occurs here
-      if (!needsSplit)
+      if (needsSplit)
+        {
+        splitIndex[cellIdX] = splitCellIds.size();
+        splitCellIds.push_back(cellIdX);
+        splitCellPts.insert(splitCellPts.end(), pts, pts+3);
+        }
+      } // for (cells->InitTraversal(); ...
+
+    // Splitting occurs here. Nothing shared is changed while splitting, the
+    // links and bounds that would otherwise be built lazily are built first.
+    splitLines->BuildLinks();
+    double bounds[6];
+    input->GetBounds(bounds);
+
+    std::vector<SplitCellResult> results(splitCellIds.size());
+    SplitCellsFunctor splitter;
+    splitter.Self       = this;
+    splitter.Input      = input;
+    splitter.InterLines = splitLines;
+    splitter.InputIndex = inputIndex;
+    splitter.Bounds     = bounds;
+    splitter.CellIds    = &splitCellIds;
+    splitter.CellPts    = &splitCellPts;
+    splitter.Results    = &results;
+    vtkSMPTools::For(0, splitCellIds.size(), splitter);
+
+    // Add the cells in order, so the output is the same for any number of
+    // threads
+    cellIdX = 0;
+    for (cells->InitTraversal(); cells->GetNextCell(nptsX, pts); cellIdX++)
+      {
+      if (nptsX != 3)
+        {
+        continue;
+        }
+
+      if (splitIndex[cellIdX] == -1)
         {
         // Just insert the cell and copy the cell data
         newId = newPolys->InsertNextCell(3, pts);
         outCD->CopyData(inCD, cellIdX, newId);
+        continue;
         }
-      else
+
+      SplitCellResult &result = results[splitIndex[cellIdX]];
+      for (size_t i = 0; i < result.BoundaryPoints.size(); i++)
         {
-        //Total number of cells so that we know the id numbers of the new
-        //cells added and we can add it to the new cell id mapping
-        int numCurrCells = newPolys->GetNumberOfCells();
-        vtkCellArray *splitCells = this->SplitCell
-          (input, cellIdX, pts, intersectionMap, splitLines,
-           inputIndex,numCurrCells);
-        if (splitCells != NULL)
-          {
-          double pt0[3], pt1[3], pt2[3], normal[3];
-          points->GetPoint(pts[0], pt0);
-          points->GetPoint(pts[1], pt1);
-          points->GetPoint(pts[2], pt2);
-          vtkTriangle::ComputeNormal(pt0, pt1, pt2, normal);
-          vtkMath::Normalize(normal);
-
-          vtkIdType npts, *ptIds, subCellId;
-          splitCells->InitTraversal();
-          for (subCellId = 0; splitCells->GetNextCell(npts, ptIds); subCellId++)
-            {
-            // Check for reversed cells. I'm not sure why, but in some
-            // cases, cells are reversed.
-            double subCellNormal[3];
-            points->GetPoint(ptIds[0], pt0);
-            points->GetPoint(ptIds[1], pt1);
-            points->GetPoint(ptIds[2], pt2);
-            vtkTriangle::ComputeNormal(pt0, pt1, pt2, subCellNormal);
-            vtkMath::Normalize(subCellNormal);
-
-            if (vtkMath::Dot(normal, subCellNormal) > 0)
-              {
-              newId = newPolys->InsertNextCell(npts, ptIds);
-              }
-            else
-              {
-              newId = newPolys->InsertNextCell(npts);
-              for (int i = 0; i < npts; i++)
-                {
-                newPolys->InsertCellPoint(ptIds[ npts-i-1 ]);
-                }
-              }
+        this->BoundaryPoints[inputIndex]->InsertValue(
+          result.BoundaryPoints[i].first, result.BoundaryPoints[i].second);
+        }
 
-            outCD->CopyData(inCD, cellIdX, newId); // Duplicate cell data
-            }
-          splitCells->Delete();
+      //Total number of cells so that we know the id numbers of the new
+      //cells added and we can add it to the new cell id mapping
+      int numCurrCells = newPolys->GetNumberOfCells();
+      for (size_t i = 0; i < result.NewCells.size(); i++)
+        {
+        SplitCellResult::NewCell &newCell = result.NewCells[i];
+        this->AddToNewCellMap(inputIndex, newCell.InterPtCount,
+          newCell.InterPts, splitLines, numCurrCells + newCell.SubCellId);
+        }
+
+      if (result.Status != SV_OK)
+        {
+        vtkDebugWithObjectMacro(this->ParentFilter, <<"Error in splitting cell!");
+        continue;
+        }
+
+      double pt0[3], pt1[3], pt2[3], normal[3];
+      points->GetPoint(pts[0], pt0);
+      points->GetPoint(pts[1], pt1);
+      points->GetPoint(pts[2], pt2);
+      vtkTriangle::ComputeNormal(pt0, pt1, pt2, normal);
+      vtkMath::Normalize(normal);
+
+      for (size_t loc = 0; loc < result.Cells.size(); )
+        {
+        vtkIdType npts = result.Cells[loc];
+        vtkIdType *ptIds = &result.Cells[loc+1];
+        loc += npts + 1;
+
+        // Check for reversed cells. I'm not sure why, but in some
+        // cases, cells are reversed.
+        double subCellNormal[3];
+        points->GetPoint(ptIds[0], pt0);
+        points->GetPoint(ptIds[1], pt1);
+        points->GetPoint(ptIds[2], pt2);
+        vtkTriangle::ComputeNormal(pt0, pt1, pt2, subCellNormal);
+        vtkMath::Normalize(subCellNormal);
+
+        if (vtkMath::Dot(normal, subCellNormal) > 0)
+          {
+          newId = newPolys->InsertNextCell(npts, ptIds);
           }
         else
           {
-          vtkDebugWithObjectMacro(this->ParentFilter, <<"Error in splitting cell!");
+          newId = newPolys->InsertNextCell(npts);
+          for (int i = 0; i < npts; i++)
+            {
+            newPolys->InsertCellPoint(ptIds[ npts-i-1 ]);
+            }
           }
+
+        outCD->CopyData(inCD, cellIdX, newId); // Duplicate cell data
         }
       } // for (cells->InitTraversal(); ...
     } //if inputGetPolys()->GetNumberOfCells() > 1 ...
@@ -727,11 +1557,11 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
 // ----------------------
 // Impl::SplitCell
 // ----------------------
-vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
+int vtkSVLoopIntersectionPolyDataFilter::Impl
 ::SplitCell(vtkPolyData *input, vtkIdType cellId, vtkIdType *cellPts,
-            IntersectionMapType *map,
+            IntersectionMapType *map, double bounds[6],
             vtkPolyData *interLines, int inputIndex,
-            int numCurrCells)
+            SplitCellWorkspace &work, SplitCellResult &result)
 {
   // Copy down the SurfaceID array that tells which surface the point belongs
   // to
@@ -740,16 +1570,18 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
     interLines->GetPointData()->GetArray("SurfaceID"));
 
   //Array to keep track of which points are on the boundary of the cell
-  vtkNew(vtkIdTypeArray, cellBoundaryPt);
+  vtkIdTypeArray *cellBoundaryPt = work.CellBoundaryPt;
+  cellBoundaryPt->Reset();
   //Array to tell whether the original cell points lie on the intersecting
   //line
   int CellPointOnInterLine[3] = {0,0,0};
 
   // Gather points from the cell
-  vtkNew( vtkPoints, points);
-  vtkNew( vtkPointLocator , merger);
+  vtkPoints *points = work.Points;
+  points->Reset();
+  vtkPointLocator *merger = work.Merger;
   merger->SetTolerance(this->Tolerance);
-  merger->InitPointInsertion(points, input->GetBounds());
+  merger->InitPointInsertion(points, bounds);
 
   double xyz[3];
   for (int i = 0; i < 3; i++)
@@ -765,8 +1597,10 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
 
   // Set up line cells and array to track the just the intersecting lines
   // on the cell.
-  vtkNew( vtkCellArray , lines);
-  vtkNew( vtkCellArray , interceptlines);
+  vtkCellArray *lines = work.Lines;
+  vtkCellArray *interceptlines = work.InterceptLines;
+  lines->Reset();
+  interceptlines->Reset();
 
   double p0[3], p1[3], p2[3];
   input->GetPoint(cellPts[0], p0);
@@ -776,10 +1610,11 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
   // This maps the point IDs for the vtkPolyData passed to
   // vtkDelaunay2D back to the original IDs in interLines. NOTE: The
   // point IDs from the cell are not stored here.
-  std::map< vtkIdType, vtkIdType > ptIdMap;
+  std::map< vtkIdType, vtkIdType > &ptIdMap = work.PtIdMap;
+  ptIdMap.clear();
 
-  IntersectionMapIteratorType iterLower = map->lower_bound(cellId);
-  IntersectionMapIteratorType iterUpper = map->upper_bound(cellId);
+  IntersectionMapIteratorType iterLower, iterUpper;
+  map->EqualRange(cellId, iterLower, iterUpper);
   //Get all the lines associated with the original cell
   while (iterLower != iterUpper)
     {
@@ -850,14 +1685,13 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
   IntersectionMapIteratorType ptIterUpper;
   IntersectionMapIteratorType cellIterLower;
   IntersectionMapIteratorType cellIterUpper;
-  vtkNew( vtkIdList , nbrCellIds);
+  vtkIdList *nbrCellIds = work.NbrCellIds;
   for (vtkIdType i = 0; i < 3; i++)
     {
     //Get Points belonging to each edge of this cell
     vtkIdType edgePtId0 = cellPts[i];
     vtkIdType edgePtId1 = cellPts[(i+1) % 3];
 
-    double edgePt0[3], edgePt1[3];
     if (edgePtId0 >= input->GetNumberOfPoints())
       {
       vtkGenericWarningMacro(<< "invalid point read 3");
@@ -866,8 +1700,6 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
       {
       vtkGenericWarningMacro(<< "invalid point read 4");
       }
-    input->GetPoint(edgePtId0, edgePt0);
-    input->GetPoint(edgePtId1, edgePt1);
 
     nbrCellIds->Reset();
     input->GetCellEdgeNeighbors(cellId, edgePtId0, edgePtId1, nbrCellIds);
@@ -875,8 +1707,7 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
     for (vtkIdType j = 0; j < nbrCellIds->GetNumberOfIds(); j++)
       {
       vtkIdType nbrCellId = nbrCellIds->GetId(j);
-      iterLower = map->lower_bound(nbrCellId);
-      iterUpper = map->upper_bound(nbrCellId);
+      map->EqualRange(nbrCellId, iterLower, iterUpper);
       while (iterLower != iterUpper)
         {
         vtkIdType lineId = iterLower->second;
@@ -889,17 +1720,15 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
             vtkGenericWarningMacro(<< "invalid point read 5");
             }
           interLines->GetPoint(linePtIds[k], xyz);
-          ptIterLower = this->PointMapper->lower_bound(linePtIds[k]);
-          ptIterUpper = this->PointMapper->upper_bound(linePtIds[k]);
+          this->PointMapper->EqualRange(linePtIds[k], ptIterLower,
+                                        ptIterUpper);
 
           //Find all points within this neighbor cell
           while (ptIterLower != ptIterUpper)
             {
             vtkIdType mappedPtId = ptIterLower->second;
-            cellIterLower = this->IntersectionPtsMap[inputIndex]->
-              lower_bound(mappedPtId);
-            cellIterUpper = this->IntersectionPtsMap[inputIndex]->
-              upper_bound(mappedPtId);
+            this->IntersectionPtsMap[inputIndex]->
+              EqualRange(mappedPtId, cellIterLower, cellIterUpper);
             //Check all cell values associated with this point
             while (cellIterLower != cellIterUpper)
               {
@@ -961,8 +1790,10 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
     }
 
   // Set up reverse ID map
-  std::map< vtkIdType, vtkIdType > reverseIdMap;
-  std::map< vtkIdType, vtkIdType > reverseLineIdMap;
+  std::map< vtkIdType, vtkIdType > &reverseIdMap = work.ReverseIdMap;
+  std::map< vtkIdType, vtkIdType > &reverseLineIdMap = work.ReverseLineIdMap;
+  reverseIdMap.clear();
+  reverseLineIdMap.clear();
   std::map< vtkIdType, vtkIdType >::iterator iter = ptIdMap.begin();
   while (iter != ptIdMap.end())
     {
@@ -988,19 +1819,18 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
   vtkMath::Perpendiculars(n, v0, v1, 0.0);
 
   // For each point on an edge, compute it's relative angle about n.
-  vtkNew( vtkIdTypeArray , edgePtIdList);
-  vtkNew( vtkIdTypeArray , interPtIdList);
-  edgePtIdList->Allocate(points->GetNumberOfPoints());
-  vtkNew( vtkDoubleArray,  angleList);
-  angleList->Allocate(points->GetNumberOfPoints());
-  bool *interPtBool = new bool[points->GetNumberOfPoints()];
+  vtkIdTypeArray *edgePtIdList = work.EdgePtIdList;
+  vtkIdTypeArray *interPtIdList = work.InterPtIdList;
+  vtkDoubleArray *angleList = work.AngleList;
+  edgePtIdList->Reset();
+  interPtIdList->Reset();
+  angleList->Reset();
 
   for (vtkIdType ptId = 0; ptId < points->GetNumberOfPoints(); ptId++)
     {
     double x[3];
     points->GetPoint(ptId, x);
 
-    interPtBool[ptId] = false;
     if (cellBoundaryPt->GetValue(ptId))
       {
       // Point is on line. Add its id to id list and add its angle to
@@ -1014,21 +1844,21 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
         {
         //Intersection Point!
         interPtIdList->InsertNextValue(ptId);
-        interPtBool[ptId] = true;
         }
       }
     //Setting the boundary points
     if (ptId > 2)
       {
-      this->BoundaryPoints[inputIndex]->InsertValue(reverseIdMap[ptId], 1);
+      result.BoundaryPoints.push_back(
+        std::make_pair(reverseIdMap[ptId], 1));
       }
     else if (CellPointOnInterLine[ptId])
       {
-      this->BoundaryPoints[inputIndex]->InsertValue(cellPts[ptId], 1);
+      result.BoundaryPoints.push_back(std::make_pair(cellPts[ptId], 1));
       }
     else
       {
-      this->BoundaryPoints[inputIndex]->InsertValue(cellPts[ptId], 0);
+      result.BoundaryPoints.push_back(std::make_pair(cellPts[ptId], 0));
       }
 
     }
@@ -1037,7 +1867,8 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
   // a consistent order.
   vtkSortDataArray::Sort(angleList, edgePtIdList);
 
-  vtkNew(vtkPolyData, checkPD);
+  vtkPolyData *checkPD = work.CheckPD;
+  checkPD->Initialize();
   checkPD->SetPoints(points);
   checkPD->SetLines(lines);
   checkPD->BuildLinks();
@@ -1067,27 +1898,23 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
 
   // Set up a transform that will rotate the points to the
   // XY-plane (normal aligned with z-axis).
-  vtkNew( vtkTransform , transform);
-  this->TransformSign = this->GetTransform(transform, points);
+  vtkTransform *transform = work.Transform;
+  work.TransformSign = this->GetTransform(transform, points);
 
-  vtkCellArray *splitCells = vtkCellArray::New();
-  vtkNew(vtkPolyData, interpd);
-  interpd->SetPoints(points);
-  interpd->SetLines(interceptlines);
-  interpd->BuildLinks();
-
-  vtkNew(vtkPolyData, fullpd);
+  vtkPolyData *fullpd = work.FullPD;
+  fullpd->Initialize();
   fullpd->SetPoints(points);
   fullpd->SetLines(lines);
-  SplittingPD->DeepCopy(fullpd);
+  work.SplittingPD->DeepCopy(fullpd);
 
-  vtkNew(vtkTransformPolyDataFilter, transformer);
-  vtkNew(vtkPolyData, transformedpd);
+  vtkTransformPolyDataFilter *transformer = work.Transformer;
   transformer->SetInputData(fullpd);
   transformer->SetTransform(transform);
+  transformer->Modified();
   transformer->Update();
-  transformedpd = transformer->GetOutput();
+  vtkPolyData *transformedpd = transformer->GetOutput();
   transformedpd->BuildLinks();
+  vtkIdType numCurrCells = 0;
 #ifdef VTKSV_PREDELAUNAY_SPLIT
   //If the triangle has intersecting lines and new points
   if (interPtIdList->GetNumberOfTuples() > 0 &&
@@ -1097,10 +1924,7 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
     std::vector<simPolygon> loops;
     if (this->GetLoops(transformedpd, &loops) != SV_OK)
       {
-      splitCells->Delete();
-      splitCells = NULL;
-      delete [] interPtBool;
-      return splitCells;
+      return SV_ERROR;
       }
     //For each loop, orient and triangulate
     for (int k = 0; k < (int) loops.size(); k++)
@@ -1111,7 +1935,7 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
       vtkNew(vtkCellArray, newLines);
       std::list<simPoint>::iterator it;
       int ptiter=0;
-      int *pointMapper = new int[loops[k].points.size()];
+      std::vector<int> pointMapper(loops[k].points.size());
       for (it = loops[k].points.begin(); it != loops[k].points.end(); ++it)
         {
         if (ptiter < (int) loops[k].points.size()-1)
@@ -1138,76 +1962,105 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
       vtkNew(vtkPolygon, boundaryPoly);
       this->Orient(newpd, transform, boundary, boundaryPoly);
 
-      //Triangulate with delaunay2D
-#if VTKSV_DELAUNAY_TYPE == OLD
-      vtkNew( vtkDelaunay2D_60 , del2D);
-#elif VTKSV_DELAUNAY_TYPE == TRIANGLE
-      vtknew( vtktriangledelaunay2d , del2d);
+      polys = NULL;
+#ifdef VTKSV_DELAUNAY_TRIANGLE
+      //Triangulate the loop in the plane of the cell with Triangle
+      vtkIdType numLoopPts = newPoints->GetNumberOfPoints();
+      std::vector<double> &planarPts = work.PlanarPoints;
+      planarPts.resize(2*numLoopPts);
+      for (vtkIdType i = 0; i < numLoopPts; i++)
+        {
+        double x[3];
+        transform->TransformPoint(newPoints->GetPoint(i), x);
+        planarPts[2*i]   = x[0];
+        planarPts[2*i+1] = x[1];
+        }
+      vtkIdList *boundaryIds = boundaryPoly->GetPointIds();
+      vtkIdType numSegments = boundaryIds->GetNumberOfIds();
+      std::vector<int> &segments = work.Segments;
+      segments.resize(2*numSegments);
+      for (vtkIdType i = 0; i < numSegments; i++)
+        {
+        segments[2*i]   = boundaryIds->GetId(i);
+        segments[2*i+1] = boundaryIds->GetId((i+1) % numSegments);
+        }
+      std::vector<int> &triangles = work.Triangles;
+      work.Triangulator->Triangulate(numLoopPts, &planarPts[0], numSegments,
+        numSegments > 0 ? &segments[0] : NULL, 0, NULL, triangles);
+
+      polys = work.Polys;
+      polys->Reset();
+      for (size_t i = 0; i < triangles.size(); i += 3)
+        {
+        vtkIdType ids[3] = {triangles[i], triangles[i+1], triangles[i+2]};
+        polys->InsertNextCell(3, ids);
+        }
+      //Triangle does not use an offset, if the loop is not fully
+      //triangulated try again with delaunay2D and its offsets
+      if (polys->GetNumberOfCells() != numLoopPts - 2)
+        {
+        polys = NULL;
+        }
+#endif
+#ifdef VTKSV_DELAUNAY_OLD
+      vtkSmartPointer<vtkDelaunay2D_60> del2D;
 #else
-      vtkNew( vtkDelaunay2D , del2D);
+      vtkSmartPointer<vtkDelaunay2D> del2D;
 #endif
-      del2D->SetInputData(newpd);
-      del2D->SetSourceData(boundary);
-      del2D->SetTolerance(0.0);
-      del2D->SetAlpha(0.0);
-      del2D->SetOffset(0);
-      del2D->SetProjectionPlaneMode(VTK_SET_TRANSFORM_PLANE);
-      del2D->SetTransform(transform);
-      del2D->BoundingTriangulationOff();
-      del2D->Update();
-      polys = del2D->GetOutput()->GetPolys();
-      vtkNew(vtkTriangleFilter, triangulator);
-      //If the number of cells output is not two minus the number of
-      //points, the triangulation failed with 0 offset! Try again with
-      //a higher offset. This typically resolves triangulation issues
-      if (polys->GetNumberOfCells() != newpd->GetNumberOfPoints() - 2)
+      if (polys == NULL)
         {
-        int numoffsets = 1;
-        while ((polys->GetNumberOfCells() != newpd->GetNumberOfPoints()-2)
-            && numoffsets < 20)
-          {
-#if VTKSV_DELAUNAY_TYPE == OLD
-          vtkNew( vtkDelaunay2D_60 , del2Doffset);
-#elif VTKSV_DELAUNAY_TYPE == TRIANGLE
-          vtkNew( vtkTriangleDelaunay2D , del2Doffset);
+        //Triangulate with delaunay2D
+#ifdef VTKSV_DELAUNAY_OLD
+        del2D = vtkSmartPointer<vtkDelaunay2D_60>::New();
 #else
-          vtkNew( vtkDelaunay2D , del2Doffset);
+        del2D = vtkSmartPointer<vtkDelaunay2D>::New();
 #endif
-          del2Doffset->SetInputData(newpd);
-          del2Doffset->SetSourceData(boundary);
-          del2Doffset->SetTolerance(0.0);
-          del2Doffset->SetAlpha(0.0);
-          del2Doffset->SetOffset(numoffsets);
-          del2Doffset->SetProjectionPlaneMode(VTK_SET_TRANSFORM_PLANE);
-          del2Doffset->SetTransform(transform);
-          del2Doffset->BoundingTriangulationOff();
-          del2Doffset->Update();
-
-          polys->DeepCopy(del2Doffset->GetOutput()->GetPolys());
-          numoffsets++;
-          }
+        del2D->SetInputData(newpd);
+        del2D->SetSourceData(boundary);
+        del2D->SetTolerance(0.0);
+        del2D->SetAlpha(0.0);
+        del2D->SetOffset(0);
+        del2D->SetProjectionPlaneMode(VTK_SET_TRANSFORM_PLANE);
+        del2D->SetTransform(transform);
+        del2D->BoundingTriangulationOff();
+        del2D->Update();
+        polys = del2D->GetOutput()->GetPolys();
+        //If the number of cells output is not two minus the number of
+        //points, the triangulation failed with 0 offset! Try again with
+        //a higher offset. This typically resolves triangulation issues
         if (polys->GetNumberOfCells() != newpd->GetNumberOfPoints() - 2)
           {
-          //If the offsets all failed, try last attempt with ear splitting
-          triangulator->SetInputData(boundary);
-          triangulator->Update();
-          polys = triangulator->GetOutput()->GetPolys();
-
-          splitCells->Delete();
-          splitCells = NULL;
-          delete [] pointMapper;
-          delete [] interPtBool;
-          return splitCells;
+          int numoffsets = 1;
+          while ((polys->GetNumberOfCells() != newpd->GetNumberOfPoints()-2)
+              && numoffsets < 20)
+            {
+#ifdef VTKSV_DELAUNAY_OLD
+            vtkNew( vtkDelaunay2D_60 , del2Doffset);
+#else
+            vtkNew( vtkDelaunay2D , del2Doffset);
+#endif
+            del2Doffset->SetInputData(newpd);
+            del2Doffset->SetSourceData(boundary);
+            del2Doffset->SetTolerance(0.0);
+            del2Doffset->SetAlpha(0.0);
+            del2Doffset->SetOffset(numoffsets);
+            del2Doffset->SetProjectionPlaneMode(VTK_SET_TRANSFORM_PLANE);
+            del2Doffset->SetTransform(transform);
+            del2Doffset->BoundingTriangulationOff();
+            del2Doffset->Update();
+
+            polys->DeepCopy(del2Doffset->GetOutput()->GetPolys());
+            numoffsets++;
+            }
+          if (polys->GetNumberOfCells() != newpd->GetNumberOfPoints() - 2)
+            {
+            return SV_ERROR;
+            }
           }
         }
-      else
-        {
-        polys = del2D->GetOutput()->GetPolys();
-        }
 
       // Renumber the point IDs.
       vtkIdType npts, *ptIds;
-      interLines->BuildLinks();
       for (polys->InitTraversal(); polys->GetNextCell(npts, ptIds);)
         {
         if (pointMapper[ptIds[0]] >= points->GetNumberOfPoints() ||
@@ -1217,9 +2070,10 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
           vtkGenericWarningMacro(<< "Invalid point ID!!!");
           }
 
-        splitCells->InsertNextCell(npts);
-        int interPtCount = 0;
-        int interPts[3];
+        result.Cells.push_back(npts);
+        SplitCellResult::NewCell newCell;
+        newCell.SubCellId = numCurrCells;
+        newCell.InterPtCount = 0;
         for (int i = 0; i < npts; i++)
           {
           vtkIdType remappedPtId;
@@ -1229,27 +2083,25 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
             //If original cell point is also on intersecting lines
             if (CellPointOnInterLine[pointMapper[ptIds[i]]])
               {
-              interPts[interPtCount++] =
+              newCell.InterPts[newCell.InterPtCount++] =
                 reverseLineIdMap[pointMapper[ptIds[i]] ];
               }
             }
           else  //If point is from intersection lines
             {
             remappedPtId = reverseIdMap[ pointMapper[ptIds[i]] ];
-            interPts[interPtCount++] =
+            newCell.InterPts[newCell.InterPtCount++] =
               reverseLineIdMap[ pointMapper[ptIds[i]] ];
             }
-          splitCells->InsertCellPoint(remappedPtId);
+          result.Cells.push_back(remappedPtId);
           }
-        if (interPtCount >= 2) //If there are more than two, inter line
+        if (newCell.InterPtCount >= 2) //If there are more than two, inter line
           {
           //Add the information to new cell mapping on intersection lines
-          this->AddToNewCellMap(inputIndex, interPtCount, interPts,
-              interLines, numCurrCells);
+          result.NewCells.push_back(newCell);
           }
         numCurrCells++;
         }
-      delete [] pointMapper;
       }
     }
   else  //Not (intersection lines and new points)
@@ -1257,10 +2109,8 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
 #endif
     //Possible to have only additional point and not lines
     //Triangulate with delaunay2D
-#if VTKSV_DELAUNAY_TYPE == OLD
+#ifdef VTKSV_DELAUNAY_OLD
     vtkNew( vtkDelaunay2D_60 , del2D);
-#elif VTKSV_DELAUNAY_TYPE == TRIANGLE
-    vtkNew( vtkDelaunay2D , del2D);
 #else
     vtkNew( vtkDelaunay2D , del2D);
 #endif
@@ -1286,9 +2136,10 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
         vtkGenericWarningMacro(<< "Invalid point ID!!!");
         }
 
-      splitCells->InsertNextCell(npts);
-      int interPtCount = 0;
-      int interPts[3];
+      result.Cells.push_back(npts);
+      SplitCellResult::NewCell newCell;
+      newCell.SubCellId = numCurrCells;
+      newCell.InterPtCount = 0;
       for (int i = 0; i < npts; i++)
         {
         vtkIdType remappedPtId;
@@ -1297,20 +2148,21 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
           remappedPtId = cellPts[ ptIds[i] ];
           if (CellPointOnInterLine[ptIds[i]])
             {
-            interPts[interPtCount++] = reverseLineIdMap[ptIds[i] ];
+            newCell.InterPts[newCell.InterPtCount++] =
+              reverseLineIdMap[ptIds[i] ];
             }
           }
         else
           {
           remappedPtId = reverseIdMap[ ptIds[i] ];
-          interPts[interPtCount++] = reverseLineIdMap[ptIds[i] ];
+          newCell.InterPts[newCell.InterPtCount++] =
+            reverseLineIdMap[ptIds[i] ];
           }
-        splitCells->InsertCellPoint(remappedPtId);
+        result.Cells.push_back(remappedPtId);
         }
-      if (interPtCount >= 2)
+      if (newCell.InterPtCount >= 2)
         {
-        this->AddToNewCellMap(inputIndex, interPtCount, interPts,
-            interLines, numCurrCells);
+        result.NewCells.push_back(newCell);
         }
       numCurrCells++;
       }
@@ -1318,8 +2170,7 @@ vtkCellArray* vtkSVLoopIntersectionPolyDataFilter::Impl
     }
 #endif
 
-  delete [] interPtBool;
-  return splitCells;
+  return SV_OK;
 }
 
 // ----------------------
@@ -1339,18 +2190,10 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
   mesh->GetPoint(edgePtId1, pt1);
 
   // Check to see if this point-cell combo is already in the list
-  PointEdgeMapIteratorType iterLower =
-    this->PointEdgeMap[index]->lower_bound(ptId);
-  PointEdgeMapIteratorType iterUpper =
-    this->PointEdgeMap[index]->upper_bound(ptId);
-
-  while (iterLower != iterUpper)
+  const CellEdgeLineType *found = this->PointEdgeMap[index]->Find(ptId, cellId);
+  if (found != NULL)
     {
-    if (iterLower->second.CellId == cellId)
-      {
-      return iterLower->second.EdgeId;
-      }
-    ++iterLower;
+    return found->EdgeId;
     }
 
   double t, dist, closestPt[3];
@@ -1361,7 +2204,7 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl
     cellEdgeLine.CellId = cellId;
     cellEdgeLine.EdgeId = edgeId;
     cellEdgeLine.LineId = lineId;
-    this->PointEdgeMap[index]->insert(std::make_pair(ptId, cellEdgeLine));
+    this->PointEdgeMap[index]->Insert(ptId, cellEdgeLine);
     value = edgeId;
     }
   return value;
@@ -1829,12 +2672,13 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl::GetLoopOrientation(
     //interior three points to make sure the area is correct
     vtkDebugWithObjectMacro(this->ParentFilter, <<"Very Small Area Triangle");
     vtkDebugWithObjectMacro(this->ParentFilter, <<"Double check area with more accurate transform");
+    vtkPolyData *splittingPD = this->SplitWorkspaces.Local().SplittingPD;
     vtkNew(vtkPoints, testPoints);
     vtkNew(vtkPolyData, testPD);
     vtkNew(vtkCellArray, testCells);
-    testPoints->InsertNextPoint(this->SplittingPD->GetPoint(ptId1));
-    testPoints->InsertNextPoint(this->SplittingPD->GetPoint(ptId2));
-    testPoints->InsertNextPoint(this->SplittingPD->GetPoint(ptId3));
+    testPoints->InsertNextPoint(splittingPD->GetPoint(ptId1));
+    testPoints->InsertNextPoint(splittingPD->GetPoint(ptId2));
+    testPoints->InsertNextPoint(splittingPD->GetPoint(ptId3));
     for (int i = 0; i < 3; i++)
       {
       testCells->InsertNextCell(2);
@@ -1847,13 +2691,13 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl::GetLoopOrientation(
 
     vtkNew(vtkTransform, newTransform);
     int sign = this->GetTransform(newTransform, testPoints);
-    if (sign != this->TransformSign)
+    if (sign != this->SplitWorkspaces.Local().TransformSign)
       {
-      testPoints->SetPoint(0, this->SplittingPD->GetPoint(ptId2));
-      testPoints->SetPoint(1, this->SplittingPD->GetPoint(ptId1));
+      testPoints->SetPoint(0, splittingPD->GetPoint(ptId2));
+      testPoints->SetPoint(1, splittingPD->GetPoint(ptId1));
       this->GetTransform(newTransform, testPoints);
-      testPoints->SetPoint(0, this->SplittingPD->GetPoint(ptId1));
-      testPoints->SetPoint(1, this->SplittingPD->GetPoint(ptId2));
+      testPoints->SetPoint(0, splittingPD->GetPoint(ptId1));
+      testPoints->SetPoint(1, splittingPD->GetPoint(ptId2));
       }
 
     vtkNew(vtkTransformPolyDataFilter, newTransformer);
@@ -2020,6 +2864,7 @@ int vtkSVLoopIntersectionPolyDataFilter::Impl::GetTransform(
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSVLoopIntersectionPolyDataFilter);
+vtkCxxSetObjectMacro(vtkSVLoopIntersectionPolyDataFilter,FirstInputTree,vtkSVBoundingBoxTree);
 
 //----------------------------------------------------------------------------
 vtkSVLoopIntersectionPolyDataFilter::vtkSVLoopIntersectionPolyDataFilter()
@@ -2036,11 +2881,19 @@ vtkSVLoopIntersectionPolyDataFilter::vtkSVLoopIntersectionPolyDataFilter()
   this->Status = 1;
   this->ComputeIntersectionPointArray = 0;
   this->Tolerance = 1e-6;
+  this->UseOBBTree = 0;
+  this->UseExactPredicates = 1;
+  this->FirstInputTree = NULL;
 }
 
 //----------------------------------------------------------------------------
 vtkSVLoopIntersectionPolyDataFilter::~vtkSVLoopIntersectionPolyDataFilter()
 {
+  if (this->FirstInputTree)
+    {
+    this->FirstInputTree->Delete();
+    this->FirstInputTree = NULL;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -2061,6 +2914,9 @@ void vtkSVLoopIntersectionPolyDataFilter::PrintSelf(ostream &os, vtkIndent inden
           this->ComputeIntersectionPointArray << "\n";
   os << indent << "Tolerance: " <<
           this->Tolerance << "\n";
+  os << indent << "UseOBBTree: " << this->UseOBBTree << "\n";
+  os << indent << "UseExactPredicates: " << this->UseExactPredicates << "\n";
+  os << indent << "FirstInputTree: " << this->FirstInputTree << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -2418,23 +3274,6 @@ int vtkSVLoopIntersectionPolyDataFilter::RequestData(
   vtkNew(vtkPolyData , mesh1);
   mesh1->DeepCopy(input1);
 
-  // Find the triangle-triangle intersections between mesh0 and mesh1
-  vtkNew(vtkOBBTree , obbTree0);
-  obbTree0->SetDataSet(mesh0);
-  obbTree0->SetNumberOfCellsPerNode(10);
-  obbTree0->SetMaxLevel(1000000);
-  obbTree0->SetTolerance(this->Tolerance);
-  obbTree0->AutomaticOn();
-  obbTree0->BuildLocator();
-
-  vtkNew(vtkOBBTree , obbTree1);
-  obbTree1->SetDataSet(mesh1);
-  obbTree1->SetNumberOfCellsPerNode(10);
-  obbTree1->SetMaxLevel(1000000);
-  obbTree1->SetTolerance(this->Tolerance);
-  obbTree1->AutomaticOn();
-  obbTree1->BuildLocator();
-
   // Set up the structure for determining exact triangle-triangle
   // intersections.
   vtkSVLoopIntersectionPolyDataFilter::Impl *impl =
@@ -2442,7 +3281,6 @@ int vtkSVLoopIntersectionPolyDataFilter::RequestData(
   impl->ParentFilter = this;
   impl->Mesh[0]  = mesh0;
   impl->Mesh[1]  = mesh1;
-  impl->OBBTree1 = obbTree1;
   impl->Tolerance = this->Tolerance;
 
   vtkNew(vtkCellArray , lines);
@@ -2499,9 +3337,53 @@ int vtkSVLoopIntersectionPolyDataFilter::RequestData(
   impl->PointMerger = pointMerger;
 
   // This performs the triangle intersection search
-  obbTree0->IntersectWithOBBTree
-    (obbTree1, 0, vtkSVLoopIntersectionPolyDataFilter::
-     Impl::FindTriangleIntersections, impl);
+  this->SetProgressText("Broad phase");
+  this->UpdateProgress(0.05);
+  if (this->UseOBBTree)
+    {
+    vtkNew(vtkOBBTree , obbTree0);
+    obbTree0->SetDataSet(mesh0);
+    obbTree0->SetNumberOfCellsPerNode(10);
+    obbTree0->SetMaxLevel(1000000);
+    obbTree0->SetTolerance(this->Tolerance);
+    obbTree0->AutomaticOn();
+    obbTree0->BuildLocator();
+
+    vtkNew(vtkOBBTree , obbTree1);
+    obbTree1->SetDataSet(mesh1);
+    obbTree1->SetNumberOfCellsPerNode(10);
+    obbTree1->SetMaxLevel(1000000);
+    obbTree1->SetTolerance(this->Tolerance);
+    obbTree1->AutomaticOn();
+    obbTree1->BuildLocator();
+    impl->OBBTree1 = obbTree1;
+
+    this->SetProgressText("Segments");
+    this->UpdateProgress(0.2);
+    obbTree0->IntersectWithOBBTree
+      (obbTree1, 0, vtkSVLoopIntersectionPolyDataFilter::
+       Impl::FindTriangleIntersections, impl);
+    impl->OBBTree1 = NULL;
+    impl->AddAllIntersections();
+    }
+  else
+    {
+    if (this->FirstInputTree && !this->CheckInput &&
+        this->FirstInputTree->GetNumberOfBoxes() == mesh0->GetNumberOfCells())
+      {
+      impl->Tree0 = this->FirstInputTree;
+      }
+    if (this->UseExactPredicates)
+      {
+      // The exact arithmetic constants are global, set them once
+      static const int initialized = InitializePredicates();
+      (void) initialized;
+      }
+    impl->UseExactPredicates = this->UseExactPredicates;
+    impl->FindAllTriangleIntersections();
+    impl->Tree0 = NULL;
+    impl->AddAllIntersections();
+    }
 
   int rawLines = outputIntersection->GetNumberOfLines();
 
@@ -2536,7 +3418,14 @@ int vtkSVLoopIntersectionPolyDataFilter::RequestData(
     {
     tmpLines->GetPoint(ptId, newpt);
     mapPtId = linePtMapper->FindClosestPoint(newpt);
-    impl->PointMapper->insert(std::make_pair(mapPtId, ptId));
+    impl->PointMapper->Insert(mapPtId, ptId);
+    }
+  // All lookups from here on are on finished maps, sort them once
+  impl->PointMapper->Sort();
+  for (int i = 0; i < 2; i++)
+    {
+    impl->IntersectionMap[i]->Sort();
+    impl->IntersectionPtsMap[i]->Sort();
     }
   vtkDebugMacro(<<"LINEPTSAFTER "<<outputIntersection->GetNumberOfPoints());
   this->NumberOfIntersectionPoints = outputIntersection->GetNumberOfPoints();
@@ -2555,6 +3444,8 @@ int vtkSVLoopIntersectionPolyDataFilter::RequestData(
     return SV_OK;
     }
 
+  this->SetProgressText("Split");
+  this->UpdateProgress(0.5);
   impl->BoundaryPoints[0] = vtkIntArray::New();
   impl->BoundaryPoints[1] = vtkIntArray::New();
   // Split the first output if so desired, needed if performing boolean op
@@ -72,6 +72,11 @@
  * indicating if the cell has any free edges. A watertight surface will have
  * 0 everywhere for this array!
  *
+ * While the filter runs, its progress text names the current phase: "Broad
+ * phase" while the trees over the triangles are built, "Segments" while the
+ * intersection lines of the triangle pairs are found and "Split" while the
+ * inputs are remeshed.
+ *
  * \author Adam Updegrove
  * \author updega2@gmail.com
  * \author UC Berkeley
@@ -84,6 +89,8 @@
 #include "vtkPolyDataAlgorithm.h"
 #include "vtkSVBooleanModule.h" // For export macro
 
+class vtkSVBoundingBoxTree;
+
 class VTKSVBOOLEAN_EXPORT vtkSVLoopIntersectionPolyDataFilter :
         public vtkPolyDataAlgorithm
 {
@@ -151,6 +158,42 @@ public:
   vtkSetMacro(Tolerance, double);
   //@}
 
+  //@{
+  /// \brief If on, intersecting triangles are found by traversing two
+  /// vtkOBBTrees in serial. If off, a bounding box tree over the second input
+  /// is searched in parallel. Either way the lines are added in order of the
+  /// cell ids, so both give the same point and line ids.
+  /// Default: OFF
+  vtkGetMacro(UseOBBTree, int);
+  vtkSetMacro(UseOBBTree, int);
+  vtkBooleanMacro(UseOBBTree, int);
+  //@}
+
+  //@{
+  /// \brief If on, the parallel search first drops the triangle pairs where
+  /// one triangle lies strictly on one side of the plane of the other. The
+  /// sides are decided with a floating point filter and, when it is not sure,
+  /// the exact orient3d predicate, so only pairs that really touch get the
+  /// tolerance based intersection. Triangles that do not touch but are closer
+  /// than the tolerance give no line, while with the option off they may.
+  /// Not used with UseOBBTree.
+  /// Default: ON
+  vtkGetMacro(UseExactPredicates, int);
+  vtkSetMacro(UseExactPredicates, int);
+  vtkBooleanMacro(UseExactPredicates, int);
+  //@}
+
+  //@{
+  /// \brief Optional bounding box tree over the triangles of the first input,
+  /// with the boxes grown by at least the tolerance. When given, the search
+  /// for intersecting triangles loops over the second input and queries this
+  /// tree, so a large first input that is kept between runs is not walked.
+  /// Not used with UseOBBTree or CheckInput, or if the number of boxes does
+  /// not match the number of cells of the first input.
+  virtual void SetFirstInputTree(vtkSVBoundingBoxTree*);
+  vtkGetObjectMacro(FirstInputTree, vtkSVBoundingBoxTree);
+  //@}
+
   ///\brief Given two triangles defined by points (p1, q1, r1) and (p2, q2,
   // r2), returns whether the two triangles intersect.
   // \details If they do, the endpoints of the line forming the
@@ -191,6 +234,9 @@ protected:
   int CheckInput;
   int Status;
   double Tolerance;
+  int UseOBBTree;
+  int UseExactPredicates;
+  vtkSVBoundingBoxTree *FirstInputTree;
 
 private:
   vtkSVLoopIntersectionPolyDataFilter(const vtkSVLoopIntersectionPolyDataFilter&);
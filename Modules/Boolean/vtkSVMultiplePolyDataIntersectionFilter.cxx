@@ -42,13 +42,183 @@
 #include "vtkSVGeneralUtils.h"
 #include "vtkSVGlobals.h"
 #include "vtkSVLoopBooleanPolyDataFilter.h"
+#include "vtkSVLoopBooleanSession.h"
 #include "vtkSVIOUtils.h"
 #include "vtkTrivialProducer.h"
 #include "vtkSmartPointer.h"
-#include "vtkBoundingBox.h"
 #include "vtkIdList.h"
 #include "vtkIntArray.h"
 #include "vtkAppendPolyData.h"
+#include "vtkMath.h"
+#include "vtkOBBTree.h"
+#include "vtkSVBoundingBoxTree.h"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// ----------------------
+// UnionNode
+// ----------------------
+// A surface in the tree union, either an input or the union of inputs.
+struct UnionNode
+{
+  vtkSmartPointer<vtkPolyData> Surface;
+  std::vector<int>             Members;
+  int                          NumberOfUnions;
+  int                          Id;
+};
+
+// ----------------------
+// UnionPairs
+// ----------------------
+// Runs the booleans of a set of disjoint pairs of nodes one after the other.
+// Each boolean already spreads its own loops over threads with vtkSMPTools,
+// running whole booleans on different threads as well would nest them.
+class UnionPairs
+{
+public:
+  std::vector<UnionNode>                         *Nodes;
+  const std::vector<std::pair<int, int> >        *Pairs;
+  std::vector<vtkSmartPointer<vtkPolyData> >     *Results;
+  std::vector<int>                               *Status;
+  double                                         Tolerance;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType p = begin; p < end; p++)
+      {
+      const std::pair<int, int> &pair = (*this->Pairs)[p];
+
+      vtkNew(vtkSVLoopBooleanPolyDataFilter, boolean);
+      boolean->SetInputData(0, (*this->Nodes)[pair.first].Surface);
+      boolean->SetInputData(1, (*this->Nodes)[pair.second].Surface);
+      boolean->SetTolerance(this->Tolerance);
+      boolean->SetOperationToUnion();
+      boolean->Update();
+      if (boolean->GetStatus() != 1)
+        {
+        (*this->Status)[p] = SV_ERROR;
+        continue;
+        }
+      (*this->Status)[p] = SV_OK;
+
+      //Objects actually don't intersect
+      if (boolean->GetNumberOfIntersectionPoints() == 0 ||
+          boolean->GetNumberOfIntersectionLines() == 0)
+        {
+        continue;
+        }
+      (*this->Results)[p] = vtkSmartPointer<vtkPolyData>::New();
+      (*this->Results)[p]->ShallowCopy(boolean->GetOutput());
+      }
+  }
+};
+
+// ----------------------
+// OrientedBox
+// ----------------------
+struct OrientedBox
+{
+  double Center[3];
+  double Axes[3][3];
+  double HalfSizes[3];
+};
+
+// ----------------------
+// ComputeOrientedBox
+// ----------------------
+// Box around the points of a surface grown by pad on every side, with unit
+// axes even if the points are on a plane or a line.
+void ComputeOrientedBox(vtkOBBTree *obbTree, vtkPolyData *surface,
+                        const double pad, OrientedBox &box)
+{
+  double corner[3], axes[3][3], size[3];
+  obbTree->ComputeOBB(surface, corner, axes[0], axes[1], axes[2], size);
+
+  for (int i = 0; i < 3; i++)
+    {
+    box.Center[i] = corner[i] + 0.5*(axes[0][i] + axes[1][i] + axes[2][i]);
+    box.HalfSizes[i] = 0.5*vtkMath::Norm(axes[i]) + pad;
+    box.Axes[0][i] = axes[0][i];
+    box.Axes[1][i] = axes[1][i];
+    }
+
+  if (vtkMath::Normalize(box.Axes[0]) == 0.0)
+    {
+    box.Axes[0][0] = 1.0; box.Axes[0][1] = 0.0; box.Axes[0][2] = 0.0;
+    }
+  if (vtkMath::Normalize(box.Axes[1]) == 0.0)
+    {
+    double other[3];
+    vtkMath::Perpendiculars(box.Axes[0], box.Axes[1], other, 0.0);
+    }
+  vtkMath::Cross(box.Axes[0], box.Axes[1], box.Axes[2]);
+  vtkMath::Normalize(box.Axes[2]);
+}
+
+// ----------------------
+// OrientedBoxesOverlap
+// ----------------------
+// Separating axis test with the axes of both boxes and their cross products.
+bool OrientedBoxesOverlap(const OrientedBox &a, const OrientedBox &b)
+{
+  double diff[3];
+  vtkMath::Subtract(b.Center, a.Center, diff);
+
+  double testAxes[15][3];
+  int numTestAxes = 0;
+  for (int i = 0; i < 3; i++)
+    {
+    for (int k = 0; k < 3; k++)
+      {
+      testAxes[numTestAxes][k] = a.Axes[i][k];
+      testAxes[numTestAxes+1][k] = b.Axes[i][k];
+      }
+    numTestAxes += 2;
+    }
+  for (int i = 0; i < 3; i++)
+    {
+    for (int j = 0; j < 3; j++)
+      {
+      vtkMath::Cross(a.Axes[i], b.Axes[j], testAxes[numTestAxes]);
+      // Parallel axes, already covered by the axes of the boxes
+      if (vtkMath::Norm(testAxes[numTestAxes]) > 1.0e-10)
+        {
+        numTestAxes++;
+        }
+      }
+    }
+
+  for (int i = 0; i < numTestAxes; i++)
+    {
+    double radiusA = 0.0, radiusB = 0.0;
+    for (int j = 0; j < 3; j++)
+      {
+      radiusA += a.HalfSizes[j]*fabs(vtkMath::Dot(a.Axes[j], testAxes[i]));
+      radiusB += b.HalfSizes[j]*fabs(vtkMath::Dot(b.Axes[j], testAxes[i]));
+      }
+    if (fabs(vtkMath::Dot(diff, testAxes[i])) > radiusA + radiusB)
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+// ----------------------
+// CompareFirstMember
+// ----------------------
+bool CompareFirstMember(const UnionNode &a, const UnionNode &b)
+{
+  return a.Members[0] < b.Members[0];
+}
+
+}
 
 // ----------------------
 // StandardNewMacro
@@ -65,9 +235,10 @@ vtkSVMultiplePolyDataIntersectionFilter::vtkSVMultiplePolyDataIntersectionFilter
   this->NoIntersectionOutput = 1;
   this->PassInfoAsGlobal = 0;
   this->AssignSurfaceIds = 0;
+  this->UseTreeReduction = 0;
+  this->UseOrientedBoundingBoxes = 0;
 
   this->BooleanObject = vtkPolyData::New();
-  this->IntersectionTable = NULL;
   this->Status = 1;
   this->Tolerance = 1e-6;
 }
@@ -173,49 +344,141 @@ SetInputConnectionByNumber(int num,vtkAlgorithmOutput *input)
   this->SetNthInputConnection(0, num, input);
 }
 
+// ----------------------
+// BuildIntersectionTable
+// ----------------------
 int vtkSVMultiplePolyDataIntersectionFilter::BuildIntersectionTable(
     vtkPolyData* inputs[], int numInputs)
 {
   for (int i = 0;i < numInputs;i++)
     {
-    inputs[i]->ComputeBounds();
+    if (this->AssignSurfaceIds)
+      this->SetSurfaceId(inputs[i],i+1);
+    }
+
+  std::vector<std::pair<int, int> > pairs;
+  this->FindOverlappingPairs(inputs, numInputs, pairs);
+
+  // Both directions of each pair, the pairs are in increasing order so every
+  // row comes out sorted
+  this->IntersectionOffsets.assign(numInputs+1, 0);
+  for (size_t p = 0; p < pairs.size(); p++)
+    {
+    this->IntersectionOffsets[pairs[p].first+1]++;
+    this->IntersectionOffsets[pairs[p].second+1]++;
+    }
+  for (int i = 0; i < numInputs; i++)
+    {
+    this->IntersectionOffsets[i+1] += this->IntersectionOffsets[i];
+    }
+  this->IntersectionIds.resize(2*pairs.size());
+  this->IntersectionState.assign(2*pairs.size(), 1);
+  std::vector<int> next(this->IntersectionOffsets.begin(),
+                        this->IntersectionOffsets.end()-1);
+  for (size_t p = 0; p < pairs.size(); p++)
+    {
+    this->IntersectionIds[next[pairs[p].first]++] = pairs[p].second;
+    this->IntersectionIds[next[pairs[p].second]++] = pairs[p].first;
     }
 
-  int totalIntersections=0;
-  int intersect=0;
   for (int i = 0;i < numInputs;i++)
     {
-    if (this->AssignSurfaceIds)
-      this->SetSurfaceId(inputs[i],i+1);
-    int objectIntersections=0;
-    double bounds0[6];
-    inputs[i]->GetBounds(bounds0);
-    vtkBoundingBox boundingBox0;
-    boundingBox0.SetBounds(bounds0);
-    for (int j = 0;j < numInputs; j++)
+    if (this->IntersectionOffsets[i] == this->IntersectionOffsets[i+1])
       {
-      if (i != j)
-	{
-	double bounds1[6];
-	inputs[j]->GetBounds(bounds1);
-	vtkBoundingBox boundingBox1;
-	boundingBox1.SetBounds(bounds1);
-	int intersects = boundingBox0.Intersects(boundingBox1);
-	if (intersects)
-	  {
-	  this->IntersectionTable[i][j] = 1;
-	  objectIntersections++;
-	  totalIntersections++;
-	  }
-	}
+      vtkGenericWarningMacro( << "Input object "<<i<<" doesn't intersect "
+                              << "with any other input object." );
       }
-      if (objectIntersections == 0)
+    }
+  return this->IntersectionIds.size();
+}
+
+// ----------------------
+// FindOverlappingPairs
+// ----------------------
+/// \details The bounds of the surfaces are put in a vtkSVBoundingBoxTree that
+/// every surface then queries, so the work follows the number of overlaps
+/// rather than the square of the number of surfaces. Pairs are returned with
+/// the smaller id first, in increasing order.
+void vtkSVMultiplePolyDataIntersectionFilter::FindOverlappingPairs(
+    vtkPolyData* surfaces[], int numSurfaces,
+    std::vector<std::pair<int, int> > &pairs)
+{
+  pairs.clear();
+
+  // Empty surfaces have no bounds to put in the tree
+  std::vector<int> treeIds;
+  std::vector<double> bounds;
+  for (int i = 0; i < numSurfaces; i++)
+    {
+    if (surfaces[i]->GetNumberOfPoints() == 0)
+      {
+      continue;
+      }
+    surfaces[i]->ComputeBounds();
+    double surfaceBounds[6];
+    surfaces[i]->GetBounds(surfaceBounds);
+    bounds.insert(bounds.end(), surfaceBounds, surfaceBounds+6);
+    treeIds.push_back(i);
+    }
+  int numTreeIds = treeIds.size();
+  if (numTreeIds < 2)
+    {
+    return;
+    }
+
+  vtkNew(vtkSVBoundingBoxTree, tree);
+  tree->Build(&bounds[0], numTreeIds);
+
+  std::vector<OrientedBox> boxes;
+  if (this->UseOrientedBoundingBoxes)
+    {
+    boxes.resize(numTreeIds);
+    vtkNew(vtkOBBTree, obbTree);
+    for (int i = 0; i < numTreeIds; i++)
+      {
+      ComputeOrientedBox(obbTree, surfaces[treeIds[i]], this->Tolerance, boxes[i]);
+      }
+    }
+
+  std::vector<vtkIdType> overlaps;
+  for (int i = 0; i < numTreeIds; i++)
+    {
+    overlaps.clear();
+    tree->FindOverlappingBoxes(&bounds[6*i], overlaps);
+    std::sort(overlaps.begin(), overlaps.end());
+    for (size_t j = 0; j < overlaps.size(); j++)
+      {
+      if (overlaps[j] <= i)
+        {
+        continue;
+        }
+      if (this->UseOrientedBoundingBoxes &&
+          !OrientedBoxesOverlap(boxes[i], boxes[overlaps[j]]))
         {
-        vtkGenericWarningMacro( << "Input object "<<i<<" doesn't intersect "
-	                        << "with any other input object." );
+        vtkDebugMacro("Oriented boxes of objects " << treeIds[i] << " and "
+                      << treeIds[overlaps[j]] << " do not overlap");
+        continue;
         }
+      pairs.push_back(std::make_pair(treeIds[i], treeIds[overlaps[j]]));
+      }
+    }
+}
+
+// ----------------------
+// GetIntersectionEntry
+// ----------------------
+int vtkSVMultiplePolyDataIntersectionFilter::GetIntersectionEntry(int i, int j)
+{
+  std::vector<int>::iterator begin =
+    this->IntersectionIds.begin() + this->IntersectionOffsets[i];
+  std::vector<int>::iterator end =
+    this->IntersectionIds.begin() + this->IntersectionOffsets[i+1];
+  std::vector<int>::iterator it = std::lower_bound(begin, end, j);
+  if (it == end || *it != j)
+    {
+    return -1;
     }
-  return totalIntersections;
+  return it - this->IntersectionIds.begin();
 }
 
 // ----------------------
@@ -230,6 +493,13 @@ int vtkSVMultiplePolyDataIntersectionFilter::ExecuteIntersection(
   vtkNew(vtkIdList, checkInputArray2);
   vtkNew(vtkIdList, tmp);
 
+  // The session keeps a tree over the triangles of BooleanObject, so adding
+  // a small surface does not walk the whole result to find intersections
+  vtkNew(vtkSVLoopBooleanSession, session);
+  session->SetTolerance(this->Tolerance);
+  session->SetOperationToUnion();
+  session->Initialize(this->BooleanObject);
+
   this->inResult[start] = 1;
   checkInputArray->InsertNextId(start);
   while ((numChecks = checkInputArray->GetNumberOfIds()) > 0)
@@ -237,35 +507,27 @@ int vtkSVMultiplePolyDataIntersectionFilter::ExecuteIntersection(
     for(int c = 0;c < numChecks; c++)
       {
       int i = checkInputArray->GetId(c);
-      for (int j = 0;j < numInputs; j++)
+      for (int e = this->IntersectionOffsets[i];
+           e < this->IntersectionOffsets[i+1]; e++)
         {
+	int j = this->IntersectionIds[e];
 	//Bounding boxes intersect!
-        if (this->IntersectionTable[i][j] == 1)
+        if (this->IntersectionState[e] == 1)
           {
 	    std::cout<<"UNIONING "<<i<<" and "<<j<<endl;
-	    this->IntersectionTable[i][j] = -1;
-	    this->IntersectionTable[j][i] = -1;
+	    this->IntersectionState[e] = -1;
+	    this->IntersectionState[this->GetIntersectionEntry(j, i)] = -1;
 
-	  vtkNew(vtkSVLoopBooleanPolyDataFilter, boolean);
 	  if (this->PassInfoAsGlobal && totalIntersections != 0)
 	    this->PreSetGlobalArrays(inputs[j]);
 
-	  boolean->SetInputData(0,this->BooleanObject);
-	  boolean->SetInputData(1,inputs[j]);
-	  boolean->SetTolerance(this->Tolerance);
-	  //if (this->NoIntersectionOutput)
-	  //  boolean->SetNoIntersectionOutput(1);
-	  //else
-	  //  boolean->SetNoIntersectionOutput(0);
-	  boolean->SetOperationToUnion();
-	  boolean->Update();
-	  if (boolean->GetStatus() != 1)
+	  if (session->Apply(inputs[j]) != SV_OK)
 	  {
 	    return SV_ERROR;
 	  }
 
-	  int numPts = boolean->GetNumberOfIntersectionPoints();
-	  int numLines = boolean->GetNumberOfIntersectionLines();
+	  int numPts = session->GetNumberOfIntersectionPoints();
+	  int numLines = session->GetNumberOfIntersectionLines();
 
 	  //Objects actually don't intersect
 	  if ((numPts == 0 || numLines == 0))
@@ -277,14 +539,15 @@ int vtkSVMultiplePolyDataIntersectionFilter::ExecuteIntersection(
 	      this->inResult[i] = 1;
 	      this->inResult[j] = 1;
 	      totalIntersections++;
-	      this->BooleanObject->DeepCopy(boolean->GetOutput());
 	      if (this->PassInfoAsGlobal)
 		this->PostSetGlobalArrays(totalIntersections);
 
 	      checkInputArray2->InsertNextId(j);
-	      for (int k = 0;k < numInputs; k++)
+	      for (int k = this->IntersectionOffsets[j];
+		   k < this->IntersectionOffsets[j+1]; k++)
 		{
-		this->IntersectionTable[k][j] = -1;
+		this->IntersectionState[
+		  this->GetIntersectionEntry(this->IntersectionIds[k], j)] = -1;
 		}
 	    }
           }
@@ -299,6 +562,175 @@ int vtkSVMultiplePolyDataIntersectionFilter::ExecuteIntersection(
   return SV_OK;
 }
 
+// ----------------------
+// ExecuteTreeIntersection
+// ----------------------
+/// \details Every round pairs up surfaces with overlapping bounding boxes,
+/// going through them in order, and unions the pairs one after the other.
+/// Pairs that turn out not to intersect are not tried again. Surfaces that
+/// never intersect anything are left on their own.
+int vtkSVMultiplePolyDataIntersectionFilter::ExecuteTreeIntersection(
+    vtkPolyData* inputs[], int numInputs)
+{
+  std::vector<UnionNode> nodes(numInputs);
+  for (int i = 0; i < numInputs; i++)
+    {
+    nodes[i].Surface = vtkSmartPointer<vtkPolyData>::New();
+    nodes[i].Surface->ShallowCopy(inputs[i]);
+    nodes[i].Members.push_back(i);
+    nodes[i].NumberOfUnions = 0;
+    nodes[i].Id = i;
+    }
+  int nextId = numInputs;
+
+  std::set<std::pair<int, int> > noIntersection;
+  while (true)
+    {
+    int numNodes = nodes.size();
+    std::vector<vtkPolyData*> surfaces(numNodes);
+    for (int i = 0; i < numNodes; i++)
+      {
+      surfaces[i] = nodes[i].Surface;
+      }
+    std::vector<std::pair<int, int> > candidates;
+    this->FindOverlappingPairs(&surfaces[0], numNodes, candidates);
+
+    std::vector<int> paired(numNodes, 0);
+    std::vector<std::pair<int, int> > pairs;
+    for (size_t c = 0; c < candidates.size(); c++)
+      {
+      int i = candidates[c].first;
+      int j = candidates[c].second;
+      if (paired[i] || paired[j] ||
+          noIntersection.count(std::make_pair(nodes[i].Id, nodes[j].Id)))
+        {
+        continue;
+        }
+      paired[i] = 1;
+      paired[j] = 1;
+      pairs.push_back(std::make_pair(i, j));
+      }
+    if (pairs.empty())
+      {
+      break;
+      }
+
+    // Surfaces that are already unions carry the global arrays, the other
+    // surface of the pair needs them too so they are kept in the result
+    if (this->PassInfoAsGlobal)
+      {
+      for (size_t p = 0; p < pairs.size(); p++)
+        {
+        UnionNode &node0 = nodes[pairs[p].first];
+        UnionNode &node1 = nodes[pairs[p].second];
+        if (node0.NumberOfUnions == 0 && node1.NumberOfUnions == 0)
+          {
+          continue;
+          }
+        if (node0.NumberOfUnions == 0)
+          {
+          this->PreSetGlobalArrays(node0.Surface);
+          }
+        if (node1.NumberOfUnions == 0)
+          {
+          this->PreSetGlobalArrays(node1.Surface);
+          }
+        }
+      }
+
+    std::vector<vtkSmartPointer<vtkPolyData> > results(pairs.size());
+    std::vector<int> status(pairs.size(), SV_OK);
+    UnionPairs unioner;
+    unioner.Nodes     = &nodes;
+    unioner.Pairs     = &pairs;
+    unioner.Results   = &results;
+    unioner.Status    = &status;
+    unioner.Tolerance = this->Tolerance;
+    unioner(0, pairs.size());
+
+    std::vector<UnionNode> newNodes;
+    std::vector<int> removed(numNodes, 0);
+    for (size_t p = 0; p < pairs.size(); p++)
+      {
+      if (status[p] != SV_OK)
+        {
+        return SV_ERROR;
+        }
+      UnionNode &node0 = nodes[pairs[p].first];
+      UnionNode &node1 = nodes[pairs[p].second];
+      if (results[p] == NULL)
+        {
+        vtkDebugMacro("No intersection for objects " << node0.Id << " and " << node1.Id);
+        noIntersection.insert(std::make_pair(node0.Id, node1.Id));
+        continue;
+        }
+      vtkDebugMacro("Unioned objects " << node0.Id << " and " << node1.Id);
+
+      UnionNode newNode;
+      newNode.Surface = results[p];
+      newNode.Members = node0.Members;
+      newNode.Members.insert(newNode.Members.end(), node1.Members.begin(),
+                             node1.Members.end());
+      std::sort(newNode.Members.begin(), newNode.Members.end());
+      newNode.NumberOfUnions = node0.NumberOfUnions + node1.NumberOfUnions + 1;
+      newNode.Id = nextId++;
+      if (this->PassInfoAsGlobal)
+        {
+        this->PostSetGlobalArrays(newNode.Surface,
+          node0.NumberOfUnions + node1.NumberOfUnions == 0 ? 1 : 2);
+        }
+      newNodes.push_back(newNode);
+      removed[pairs[p].first] = 1;
+      removed[pairs[p].second] = 1;
+      }
+    if (newNodes.empty())
+      {
+      continue;
+      }
+
+    // Keep the nodes ordered by their first input
+    for (int i = 0; i < numNodes; i++)
+      {
+      if (!removed[i])
+        {
+        newNodes.push_back(nodes[i]);
+        }
+      }
+    std::sort(newNodes.begin(), newNodes.end(), CompareFirstMember);
+    nodes.swap(newNodes);
+    }
+
+  for (int i = 0; i < numInputs; i++)
+    {
+    this->inResult[i] = 0;
+    }
+  if (this->NoIntersectionOutput)
+    {
+    vtkNew(vtkAppendPolyData, appender);
+    for (size_t i = 0; i < nodes.size(); i++)
+      {
+      appender->AddInputData(nodes[i].Surface);
+      for (size_t j = 0; j < nodes[i].Members.size(); j++)
+        {
+        this->inResult[nodes[i].Members[j]] = 1;
+        }
+      }
+    appender->Update();
+    this->BooleanObject->DeepCopy(appender->GetOutput());
+    }
+  else
+    {
+    // Only the surface with the first input
+    this->BooleanObject->DeepCopy(nodes[0].Surface);
+    for (size_t j = 0; j < nodes[0].Members.size(); j++)
+      {
+      this->inResult[nodes[0].Members[j]] = 1;
+      }
+    }
+
+  return SV_OK;
+}
+
 // ----------------------
 // PreSetGlobalArrays
 // ----------------------
@@ -328,6 +760,15 @@ void vtkSVMultiplePolyDataIntersectionFilter::PreSetGlobalArrays(
 // ----------------------
 void vtkSVMultiplePolyDataIntersectionFilter::PostSetGlobalArrays(
     int numIntersections)
+{
+  this->PostSetGlobalArrays(this->BooleanObject, numIntersections);
+}
+
+// ----------------------
+// PostSetGlobalArrays
+// ----------------------
+void vtkSVMultiplePolyDataIntersectionFilter::PostSetGlobalArrays(
+    vtkPolyData *result, int numIntersections)
 {
   //std::cout<<"Passing Data"<<endl;
   if (numIntersections == 1)
@@ -335,14 +776,14 @@ void vtkSVMultiplePolyDataIntersectionFilter::PostSetGlobalArrays(
     vtkNew(vtkIntArray, currentPointArray);
     vtkNew(vtkIntArray, currentCellArray);
     currentPointArray = vtkIntArray::SafeDownCast(
-	this->BooleanObject->GetPointData()->GetArray("BoundaryPoints"));
+	result->GetPointData()->GetArray("BoundaryPoints"));
     currentCellArray = vtkIntArray::SafeDownCast(
-	this->BooleanObject->GetCellData()->GetArray("BoundaryCells"));
+	result->GetCellData()->GetArray("BoundaryCells"));
 
     currentPointArray->SetName("GlobalBoundaryPoints");
-    this->BooleanObject->GetPointData()->AddArray(currentPointArray);
+    result->GetPointData()->AddArray(currentPointArray);
     currentCellArray->SetName("GlobalBoundaryCells");
-    this->BooleanObject->GetCellData()->AddArray(currentCellArray);
+    result->GetCellData()->AddArray(currentCellArray);
   }
   else
   {
@@ -354,18 +795,18 @@ void vtkSVMultiplePolyDataIntersectionFilter::PostSetGlobalArrays(
     vtkNew(vtkIntArray, newCellArray);
 
     currentPointArray = vtkIntArray::SafeDownCast(
-	this->BooleanObject->GetPointData()->GetArray("BoundaryPoints"));
+	result->GetPointData()->GetArray("BoundaryPoints"));
     globalPointArray = vtkIntArray::SafeDownCast(
-	this->BooleanObject->GetPointData()->
+	result->GetPointData()->
 	GetArray("GlobalBoundaryPoints"));
     currentCellArray = vtkIntArray::SafeDownCast(
-	this->BooleanObject->GetCellData()->GetArray("BoundaryCells"));
+	result->GetCellData()->GetArray("BoundaryCells"));
     globalCellArray = vtkIntArray::SafeDownCast(
-	this->BooleanObject->GetCellData()->
+	result->GetCellData()->
 	GetArray("GlobalBoundaryCells"));
 
-    int numPts = this->BooleanObject->GetNumberOfPoints();
-    int numCells = this->BooleanObject->GetNumberOfCells();
+    int numPts = result->GetNumberOfPoints();
+    int numCells = result->GetNumberOfCells();
     for (int i = 0; i< numPts; i++)
     {
       newPointArray->InsertValue(i,0);
@@ -373,9 +814,9 @@ void vtkSVMultiplePolyDataIntersectionFilter::PostSetGlobalArrays(
 	  currentPointArray->GetValue(i) == 1)
 	newPointArray->InsertValue(i,1);
     }
-    this->BooleanObject->GetPointData()->RemoveArray("GlobalBoundaryPoints");
+    result->GetPointData()->RemoveArray("GlobalBoundaryPoints");
     newPointArray->SetName("GlobalBoundaryPoints");
-    this->BooleanObject->GetPointData()->AddArray(newPointArray);
+    result->GetPointData()->AddArray(newPointArray);
     for (int i = 0; i< numCells; i++)
     {
       newCellArray->InsertValue(i,0);
@@ -383,9 +824,9 @@ void vtkSVMultiplePolyDataIntersectionFilter::PostSetGlobalArrays(
 	  currentCellArray->GetValue(i) == 1)
 	newCellArray->InsertValue(i,1);
     }
-    this->BooleanObject->GetCellData()->RemoveArray("GlobalBoundaryCells");
+    result->GetCellData()->RemoveArray("GlobalBoundaryCells");
     newCellArray->SetName("GlobalBoundaryCells");
-    this->BooleanObject->GetCellData()->AddArray(newCellArray);
+    result->GetCellData()->AddArray(newCellArray);
   }
 }
 
@@ -416,7 +857,8 @@ void vtkSVMultiplePolyDataIntersectionFilter::PrintTable(int numInputs)
     std::cout<<" ";
     for (int j = 0; j < numInputs;j++)
       {
-	std::cout<<this->IntersectionTable[i][j]<<" ";
+	int entry = this->GetIntersectionEntry(i, j);
+	std::cout<<(entry == -1 ? -1 : this->IntersectionState[entry])<<" ";
       }
     std::cout<<" "<<endl;
     }
@@ -446,17 +888,11 @@ int vtkSVMultiplePolyDataIntersectionFilter::RequestData(
     }
 
   this->inResult = new int[numInputs];
-  this->IntersectionTable = new int*[numInputs];
   vtkPolyData** inputs = new vtkPolyData*[numInputs];
   for (int idx = 0; idx < numInputs; ++idx)
     {
     this->inResult[idx] = 0;
     inputs[idx] = vtkPolyData::GetData(inputVector[0], idx);
-    this->IntersectionTable[idx] = new int[numInputs];
-    for (int idy = 0; idy < numInputs; ++idy)
-      {
-	this->IntersectionTable[idx][idy] = -1;
-      }
     }
 
   int intersections = this->BuildIntersectionTable(inputs, numInputs);
@@ -464,17 +900,28 @@ int vtkSVMultiplePolyDataIntersectionFilter::RequestData(
     vtkGenericWarningMacro( << "No intersections!");
   //this->PrintTable(numInputs);
 
+  if (this->UseTreeReduction)
+    {
+    int retVal = this->ExecuteTreeIntersection(inputs, numInputs);
+    if (retVal == SV_OK)
+      {
+      output->DeepCopy(this->BooleanObject);
+      }
+    else
+      {
+      this->Status = 0;
+      }
+    delete [] this->inResult;
+    delete [] inputs;
+    return retVal;
+    }
+
   this->BooleanObject->DeepCopy(inputs[0]);
   int retVal = this->ExecuteIntersection(inputs,numInputs,0);
   if (retVal == 0)
   {
     this->Status = 0;
-    for (int idx = 0; idx < numInputs; ++idx)
-      {
-	delete [] this->IntersectionTable[idx];
-      }
     delete [] this->inResult;
-    delete [] this->IntersectionTable;
     delete [] inputs;
     return SV_ERROR;
   }
@@ -494,12 +941,7 @@ int vtkSVMultiplePolyDataIntersectionFilter::RequestData(
 	if (check == 0)
 	{
 	  this->Status = 0;
-	  for (int idx = 0; idx < numInputs; ++idx)
-	    {
-	      delete [] this->IntersectionTable[idx];
-	    }
 	  delete [] this->inResult;
-	  delete [] this->IntersectionTable;
 	  delete [] inputs;
 	  return SV_ERROR;
 	}
@@ -514,12 +956,7 @@ int vtkSVMultiplePolyDataIntersectionFilter::RequestData(
 
   output->DeepCopy(this->BooleanObject);
 
-  for (int idx = 0; idx < numInputs; ++idx)
-    {
-      delete [] this->IntersectionTable[idx];
-    }
   delete [] this->inResult;
-  delete [] this->IntersectionTable;
   delete [] inputs;
   return retVal;
 }
@@ -616,6 +1053,8 @@ void vtkSVMultiplePolyDataIntersectionFilter::PrintSelf(ostream& os,
   os << "UserManagedInputs:" << (this->UserManagedInputs?"On":"Off") << endl;
   os << "AssignSurfaceIds:" << (this->AssignSurfaceIds?"On":"Off") << endl;
   os << "PassInfoAsGlobal:" << (this->PassInfoAsGlobal?"On":"Off") << endl;
+  os << "UseTreeReduction:" << (this->UseTreeReduction?"On":"Off") << endl;
+  os << "UseOrientedBoundingBoxes:" << (this->UseOrientedBoundingBoxes?"On":"Off") << endl;
 }
 
 // ----------------------
@@ -47,6 +47,9 @@
 #include "vtkPolyData.h"
 #include "vtkPolyDataAlgorithm.h"
 
+#include <utility>
+#include <vector>
+
 class VTKSVBOOLEAN_EXPORT vtkSVMultiplePolyDataIntersectionFilter : public vtkPolyDataAlgorithm
 {
 public:
@@ -132,6 +135,27 @@ public:
   vtkGetMacro(AssignSurfaceIds,int);
   //@}
 
+  //@{
+  /// \brief Set/get boolean to union the inputs as a tree. Inputs whose
+  /// bounding boxes overlap are unioned in disjoint pairs, then the results
+  /// are paired again until nothing is left to union. When
+  /// off, the default, inputs are unioned one at a time into one surface.
+  vtkSetMacro(UseTreeReduction,int);
+  vtkGetMacro(UseTreeReduction,int);
+  vtkBooleanMacro(UseTreeReduction,int);
+  //@}
+
+  //@{
+  /// \brief Set/get boolean to also compare the oriented bounding boxes of
+  /// inputs whose axis aligned boxes overlap. Pairs with separated oriented
+  /// boxes are not given to the boolean. Useful for long vessels running
+  /// diagonally, whose axis aligned boxes overlap with many others. Off by
+  /// default.
+  vtkSetMacro(UseOrientedBoundingBoxes,int);
+  vtkGetMacro(UseOrientedBoundingBoxes,int);
+  vtkBooleanMacro(UseOrientedBoundingBoxes,int);
+  //@}
+
   //@{
   /// \brief Check the status of the filter after update. If the status is zero,
   /// there was an error in the operation. If status is one, everything
@@ -164,8 +188,18 @@ protected:
   int NoIntersectionOutput;
   int PassInfoAsGlobal;
   int AssignSurfaceIds;
+  int UseTreeReduction;
+  int UseOrientedBoundingBoxes;
 
-  int **IntersectionTable;
+  //@{
+  /// \brief Sparse table of the inputs that may intersect. The neighbors of
+  /// input i are IntersectionIds[IntersectionOffsets[i]] up to
+  /// IntersectionIds[IntersectionOffsets[i+1]], in increasing order.
+  /// IntersectionState is 1 for a pair still to try and -1 otherwise.
+  std::vector<int> IntersectionOffsets;
+  std::vector<int> IntersectionIds;
+  std::vector<int> IntersectionState;
+  //@}
   int *inResult;
   vtkPolyData *BooleanObject;
   int Status;
@@ -173,11 +207,19 @@ protected:
 
   //Function to build the table defining where intersections occur.
   int BuildIntersectionTable(vtkPolyData* inputs[], int numInputs);
+  //Function to find the pairs of surfaces that may intersect
+  void FindOverlappingPairs(vtkPolyData* surfaces[], int numSurfaces,
+                            std::vector<std::pair<int, int> > &pairs);
+  //Function to get the position of j in the table row of i, -1 if not there
+  int GetIntersectionEntry(int i, int j);
   //Function to run the intersection on intersecting polydatas
   int ExecuteIntersection(vtkPolyData *inputs[],int numInputs,int start);
+  //Function to run the intersection as a tree of pairwise unions
+  int ExecuteTreeIntersection(vtkPolyData *inputs[],int numInputs);
   //Function to set the boundary point information as global information
   void PreSetGlobalArrays(vtkPolyData *input);
   void PostSetGlobalArrays(int numIntersections);
+  void PostSetGlobalArrays(vtkPolyData *result, int numIntersections);
   //Function to set surface id
   void SetSurfaceId(vtkPolyData *input,int surfaceid);
 
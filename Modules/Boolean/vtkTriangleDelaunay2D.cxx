@@ -27,20 +27,10 @@
 #include <vtkPolyData.h>
 #include <vtkTransform.h>
 
-extern "C"
-{
-#define ANSI_DECLARATORS
-#ifndef VOID
-# define VOID void
-#endif
-#ifndef REAL
-# define REAL double
-#endif
-#include "triangle.h"
-}
 #include "predicates.h"
 
 #include <algorithm>
+#include <vector>
 
 
 vtkStandardNewMacro(vtkTriangleDelaunay2D);
@@ -128,82 +118,23 @@ int vtkTriangleDelaunay2D::RequestData(vtkInformation* vtkNotUsed(request),
       }
     }
 
-  struct triangulateio in, out;
-  memset(&in, 0, sizeof(struct triangulateio));
-  memset(&out, 0, sizeof(struct triangulateio));
-
-  // Copy point coordinates to triangle input data structure
+  // Copy point coordinates to the triangulator input
   std::size_t nbPts = (std::size_t)points->GetNumberOfPoints();
-  in.numberofpoints = static_cast<int>(nbPts);
-  in.pointlist = new REAL[in.numberofpoints * 2];
-  if (points->GetDataType() == VTK_FLOAT)
+  std::vector<double> pointlist(2 * nbPts);
+  for (std::size_t i = 0; i < nbPts; i++)
     {
-    float* ptsPtr = static_cast<float*>(points->GetVoidPointer(0));
-    for (std::size_t i = 0, ptr = 0; i < nbPts; i++, ptsPtr++)
-      {
-      in.pointlist[ptr++] = *ptsPtr++;
-      in.pointlist[ptr++] = *ptsPtr++;
-      }
-    }
-  else if (points->GetDataType() == VTK_DOUBLE)
-    {
-    double* ptsPtr = static_cast<double*>(points->GetVoidPointer(0));
-    for (std::size_t i = 0, ptr = 0; i < nbPts; i++, ptsPtr++)
-      {
-      in.pointlist[ptr++] = *ptsPtr++;
-      in.pointlist[ptr++] = *ptsPtr++;
-      }
+    double pt[3];
+    points->GetPoint(i, pt);
+    pointlist[2 * i + 0] = pt[0];
+    pointlist[2 * i + 1] = pt[1];
     }
 
-  unsigned int nbSegments = 0;
-
-  std::vector<bool> polyIsInternal;
-  vtkIdType nbOfInternalPolys = 0;
+  std::vector<int> segmentlist;
+  std::vector<double> holelist;
 
   // Process polys then lines
   if (source)
     {
-    polyIsInternal.reserve(source->GetNumberOfPolys());
-    vtkCellArray* cell = source->GetPolys();
-    for (int sourceCnt = 0; sourceCnt < 2; sourceCnt++)
-      {
-      if (cell)
-        {
-        cell->InitTraversal();
-        vtkIdType nbpts, *pts;
-        while (cell->GetNextCell(nbpts, pts))
-          {
-          nbSegments += nbpts;
-          if (sourceCnt == 0)
-            {
-            bool isInternal = !this->IsCellCCW(nbpts, pts, points);
-            polyIsInternal.push_back(isInternal);
-            if (isInternal)
-              {
-              nbOfInternalPolys++;
-              }
-            }
-          }
-        }
-      cell = source->GetLines();
-      }
-    }
-
-  // add MA edges, if any
-  in.numberofsegments = nbSegments;
-  in.segmentlist = nbSegments > 0 ? new int[in.numberofsegments * 2] : 0;
-  in.segmentmarkerlist = nbSegments > 0 ? new int[in.numberofsegments] : 0;
-  in.numberofholes = nbOfInternalPolys;
-
-  if (nbOfInternalPolys > 0)
-    {
-    in.holelist = new REAL[nbOfInternalPolys * 2 + 1];
-    }
-
-  vtkIdType cnt = 0;
-  if (source)
-    {
-    unsigned int segCnt = 0, holecnt = 0;
     vtkCellArray* cell = source->GetPolys();
     for (int sourceCnt = 0; sourceCnt < 2; sourceCnt++)
       {
@@ -214,47 +145,50 @@ int vtkTriangleDelaunay2D::RequestData(vtkInformation* vtkNotUsed(request),
         while (cell->GetNextCell(nbpts, pts))
           {
           nbpts -= (sourceCnt == 0) ? 0 : 1;
-          unsigned int initSeg = segCnt;
+          std::size_t initSeg = segmentlist.size() / 2;
           for (int j = 0; j < nbpts; j++)
             {
-            in.segmentlist[2 * segCnt + 0] = pts[j];
-            in.segmentlist[2 * segCnt + 1] =
-              pts[(sourceCnt == 0 && j == nbpts - 1) ? 0 : (j+1)];
-            in.segmentmarkerlist[segCnt] = cnt + 1;
-            segCnt++;
+            segmentlist.push_back(pts[j]);
+            segmentlist.push_back(
+              pts[(sourceCnt == 0 && j == nbpts - 1) ? 0 : (j+1)]);
             }
           // do not consider external boundary & lines
-          if (sourceCnt == 0 && polyIsInternal[cnt])
+          if (sourceCnt == 0 && !this->IsCellCCW(nbpts, pts, points))
             {
             // Compute hole position
-            this->GetPointInsidePolygon(in.pointlist,
-              &in.segmentlist[2 * initSeg], nbpts,
-              &in.holelist[holecnt++ * 2]);
+            double hole[2] = {0.0, 0.0};
+            this->GetPointInsidePolygon(&pointlist[0],
+              &segmentlist[2 * initSeg], nbpts, hole);
+            holelist.push_back(hole[0]);
+            holelist.push_back(hole[1]);
             }
-          cnt++;
           }
         }
       cell = source->GetLines();
       }
     }
 
-  triangulate((char*)(in.numberofsegments > 0 ? "pzQ" : "zQ"),
-    &in, &out, (struct triangulateio*)NULL);
+  std::vector<int> triangles;
+  this->Triangulator.Triangulate(static_cast<int>(nbPts), &pointlist[0],
+    static_cast<int>(segmentlist.size() / 2),
+    segmentlist.empty() ? NULL : &segmentlist[0],
+    static_cast<int>(holelist.size() / 2),
+    holelist.empty() ? NULL : &holelist[0], triangles);
 
   vtkDebugMacro(
-    << "Triangle CDT has " << out.numberoftriangles << " triangles");
+    << "Triangle CDT has " << triangles.size() / 3 << " triangles");
 
   // Fetch output triangles
   vtkNew<vtkCellArray> tri;
-  tri->Allocate(4 * out.numberoftriangles);
+  tri->Allocate(4 * triangles.size() / 3);
 
-  for (int i = 0; i < out.numberoftriangles; i++)
+  for (std::size_t i = 0; i < triangles.size(); i += 3)
     {
     vtkIdType ids[3] =
       {
-      out.trianglelist[i * 3 + 0],
-      out.trianglelist[i * 3 + 1],
-      out.trianglelist[i * 3 + 2]
+      triangles[i + 0],
+      triangles[i + 1],
+      triangles[i + 2]
       };
     tri->InsertNextCell(3, ids);
     }
@@ -263,17 +197,6 @@ int vtkTriangleDelaunay2D::RequestData(vtkInformation* vtkNotUsed(request),
   cdt->SetPolys(tri.Get());
   cdt->GetPointData()->ShallowCopy(input->GetPointData());
 
-  // Free all allocated arrays, including the one allocated by Triangle
-  delete [] in.pointlist;
-  delete [] in.segmentlist;
-  delete [] in.segmentmarkerlist;
-  delete [] in.holelist;
-  trifree(out.trianglelist);
-  trifree(out.pointlist);
-  trifree(out.pointmarkerlist);
-  trifree(out.segmentlist);
-  trifree(out.segmentmarkerlist);
-
   // If the best fitting option was ON, then the current transform
   // is the one that was computed internally. We must now destroy it.
   if (this->ProjectionPlaneMode == VTK_BEST_FITTING_PLANE)
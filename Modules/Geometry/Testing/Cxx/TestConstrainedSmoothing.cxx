@@ -32,12 +32,16 @@
 #include "vtkSVConstrainedSmoothing.h"
 
 #include <vtkCamera.h>
+#include <vtkMath.h>
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 #include "vtkSVGlobals.h"
 #include "vtkSVIOUtils.h"
 #include "vtkTestUtilities.h"
 
+#include <algorithm>
+#include <cmath>
+
 int TestConstrainedSmoothing(int argc, char *argv[])
 {
   // Read the surface
@@ -66,5 +70,45 @@ int TestConstrainedSmoothing(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
+  // The direct solve and converged conjugate gradients give the same surface
+  vtkNew(vtkSVConstrainedSmoothing, iterativeSmoother);
+  iterativeSmoother->SetInputData(surfacePd);
+  iterativeSmoother->SetNumSmoothOperations(2);
+  iterativeSmoother->SetWeight(0.2);
+  iterativeSmoother->SetNumGradientSolves(1000);
+  iterativeSmoother->UseDirectSolverOff();
+  iterativeSmoother->Update();
+
+  vtkNew(vtkSVConstrainedSmoothing, directSmoother);
+  directSmoother->SetInputData(surfacePd);
+  directSmoother->SetNumSmoothOperations(2);
+  directSmoother->SetWeight(0.2);
+  directSmoother->UseDirectSolverOn();
+  directSmoother->Update();
+
+  vtkPolyData *iterative = iterativeSmoother->GetOutput();
+  vtkPolyData *direct    = directSmoother->GetOutput();
+  if (direct->GetNumberOfPoints() != surfacePd->GetNumberOfPoints())
+  {
+    std::cerr << "Direct solve did not execute properly" << endl;
+    return EXIT_FAILURE;
+  }
+
+  double moved = 0.0, diff = 0.0;
+  for (int i=0; i<surfacePd->GetNumberOfPoints(); i++)
+  {
+    double pt0[3], pt1[3], pt2[3];
+    surfacePd->GetPoint(i, pt0);
+    iterative->GetPoint(i, pt1);
+    direct->GetPoint(i, pt2);
+    moved = std::max(moved, sqrt(vtkMath::Distance2BetweenPoints(pt0, pt1)));
+    diff  = std::max(diff, sqrt(vtkMath::Distance2BetweenPoints(pt1, pt2)));
+  }
+  if (moved == 0.0 || diff > 0.01*moved)
+  {
+    std::cerr << "Direct solve is " << diff << " from conjugate gradients that moved " << moved << endl;
+    return EXIT_FAILURE;
+  }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,142 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestLocalQuadricDecimation.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVLocalQuadricDecimation.h"
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include "vtkSVGlobals.h"
+#include "vtkSVIOUtils.h"
+#include "vtkTestUtilities.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+static int RunDecimation(vtkPolyData *input, const int useParallel,
+                         const double targetReduction, vtkPolyData *output)
+{
+  vtkNew(vtkSVLocalQuadricDecimation, decimator);
+  decimator->SetInputData(input);
+  decimator->SetTargetReduction(targetReduction);
+  decimator->SetUseParallelDecimation(useParallel);
+  decimator->Update();
+
+  output->DeepCopy(decimator->GetOutput());
+  double actual = decimator->GetActualReduction();
+  if (fabs(actual - targetReduction) > 0.05)
+  {
+    fprintf(stdout,"Reduction is %g, expected %g\n", actual, targetReduction);
+    return SV_ERROR;
+  }
+  if (output->GetNumberOfPolys() == 0 ||
+      output->GetNumberOfPolys() >= input->GetNumberOfPolys())
+  {
+    fprintf(stdout,"Decimation did not remove triangles\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestParallel(vtkPolyData *input, const double targetReduction)
+{
+  vtkNew(vtkPolyData, serial);
+  vtkNew(vtkPolyData, parallel);
+  vtkNew(vtkPolyData, parallelAgain);
+  if (RunDecimation(input, 0, targetReduction, serial) != SV_OK ||
+      RunDecimation(input, 1, targetReduction, parallel) != SV_OK ||
+      RunDecimation(input, 1, targetReduction, parallelAgain) != SV_OK)
+    return SV_ERROR;
+
+  // Both keep about as many triangles
+  double numSerial   = serial->GetNumberOfPolys();
+  double numParallel = parallel->GetNumberOfPolys();
+  if (fabs(numParallel - numSerial) > 0.05*numSerial)
+  {
+    fprintf(stdout,"Parallel decimation kept %d triangles, serial %d\n",
+            (int) numParallel, (int) numSerial);
+    return SV_ERROR;
+  }
+
+  // The rounds pick different edges, but the surface keeps its extent
+  double inputBounds[6], serialBounds[6], parallelBounds[6];
+  input->GetBounds(inputBounds);
+  serial->GetBounds(serialBounds);
+  parallel->GetBounds(parallelBounds);
+  double diagonal = sqrt(pow(inputBounds[1] - inputBounds[0], 2) +
+                         pow(inputBounds[3] - inputBounds[2], 2) +
+                         pow(inputBounds[5] - inputBounds[4], 2));
+  for (int i=0; i<6; i++)
+  {
+    if (fabs(parallelBounds[i] - serialBounds[i]) > 0.01*diagonal)
+    {
+      fprintf(stdout,"Parallel bound %d is %g, serial bound is %g\n", i,
+              parallelBounds[i], serialBounds[i]);
+      return SV_ERROR;
+    }
+  }
+
+  // Rounds do not depend on the number of threads
+  if (parallelAgain->GetNumberOfPoints() != parallel->GetNumberOfPoints() ||
+      parallelAgain->GetNumberOfPolys() != parallel->GetNumberOfPolys())
+  {
+    fprintf(stdout,"Parallel decimation is not repeatable\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+int TestLocalQuadricDecimation(int argc, char *argv[])
+{
+  // Read the surface
+  vtkNew(vtkPolyData, surfacePd);
+  char *surface_filename = vtkTestUtilities::ExpandDataFileName(
+    argc, argv, "0141_1001_Renal_Branch_Surface.vtp");
+  vtkSVIOUtils::ReadVTPFile(surface_filename, surfacePd);
+
+  if (TestParallel(surfacePd, 0.5) != SV_OK)
+    return EXIT_FAILURE;
+  if (TestParallel(surfacePd, 0.8) != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
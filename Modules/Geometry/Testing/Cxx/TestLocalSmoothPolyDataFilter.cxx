@@ -0,0 +1,287 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestLocalSmoothPolyDataFilter.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVLocalSmoothPolyDataFilter.h"
+
+#include <vtkCellArray.h>
+#include <vtkMath.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include "vtkSVGlobals.h"
+#include "vtkSVIOUtils.h"
+#include "vtkTestUtilities.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Mean distance of the points to the average of their edge neighbors
+static double Roughness(vtkPolyData *pd)
+{
+  vtkIdType numPts = pd->GetNumberOfPoints();
+  std::vector<double> sums(3*numPts, 0.0);
+  std::vector<int> counts(numPts, 0);
+
+  vtkCellArray *polys = pd->GetPolys();
+  vtkIdType npts, *pts;
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts);)
+  {
+    for (vtkIdType k=0; k<npts; k++)
+    {
+      vtkIdType p0 = pts[k], p1 = pts[(k+1)%npts];
+      double x0[3], x1[3];
+      pd->GetPoint(p0, x0);
+      pd->GetPoint(p1, x1);
+      for (int j=0; j<3; j++)
+      {
+        sums[3*p0+j] += x1[j];
+        sums[3*p1+j] += x0[j];
+      }
+      counts[p0]++;
+      counts[p1]++;
+    }
+  }
+
+  double roughness = 0.0;
+  for (vtkIdType i=0; i<numPts; i++)
+  {
+    if (counts[i] == 0)
+      continue;
+    double x[3], avg[3];
+    pd->GetPoint(i, x);
+    for (int j=0; j<3; j++)
+      avg[j] = sums[3*i+j]/counts[i];
+    roughness += sqrt(vtkMath::Distance2BetweenPoints(x, avg));
+  }
+  return roughness/numPts;
+}
+
+// Largest distance between the points with the same id
+static double MaximumDistance(vtkPolyData *pd0, vtkPolyData *pd1)
+{
+  double maxDist = 0.0;
+  for (vtkIdType i=0; i<pd0->GetNumberOfPoints(); i++)
+  {
+    double x0[3], x1[3];
+    pd0->GetPoint(i, x0);
+    pd1->GetPoint(i, x1);
+    double dist = sqrt(vtkMath::Distance2BetweenPoints(x0, x1));
+    maxDist = dist > maxDist ? dist : maxDist;
+  }
+  return maxDist;
+}
+
+// Mean distance of the points to their centroid, smaller when the surface
+// shrinks
+static double Size(vtkPolyData *pd)
+{
+  vtkIdType numPts = pd->GetNumberOfPoints();
+  double center[3] = {0.0, 0.0, 0.0};
+  for (vtkIdType i=0; i<numPts; i++)
+  {
+    double x[3];
+    pd->GetPoint(i, x);
+    for (int j=0; j<3; j++)
+      center[j] += x[j]/numPts;
+  }
+
+  double size = 0.0;
+  for (vtkIdType i=0; i<numPts; i++)
+    size += sqrt(vtkMath::Distance2BetweenPoints(pd->GetPoint(i), center));
+  return size/numPts;
+}
+
+static int RunSmoothing(vtkPolyData *input, vtkSVLocalSmoothPolyDataFilter *smoother,
+                        vtkPolyData *output)
+{
+  smoother->SetInputData(input);
+  smoother->Update();
+
+  output->DeepCopy(smoother->GetOutput());
+  if (output->GetNumberOfPoints() != input->GetNumberOfPoints() ||
+      output->GetNumberOfCells() != input->GetNumberOfCells())
+  {
+    fprintf(stdout,"Smoothing changed the size of the mesh\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int RunExplicit(vtkPolyData *input, const int useJacobi,
+                       const int numIterations, const double relaxation,
+                       vtkPolyData *output)
+{
+  vtkNew(vtkSVLocalSmoothPolyDataFilter, smoother);
+  smoother->SetNumberOfIterations(numIterations);
+  smoother->SetRelaxationFactor(relaxation);
+  smoother->SetUseJacobiIteration(useJacobi);
+  return RunSmoothing(input, smoother, output);
+}
+
+static int RunImplicit(vtkPolyData *input, const int useBiLaplacian,
+                       const int numIterations, const double timeStep,
+                       vtkPolyData *output)
+{
+  vtkNew(vtkSVLocalSmoothPolyDataFilter, smoother);
+  smoother->SetNumberOfIterations(numIterations);
+  smoother->SetUseImplicitSmoothing(1);
+  smoother->SetImplicitTimeStep(timeStep);
+  smoother->SetUseBiLaplacian(useBiLaplacian);
+  return RunSmoothing(input, smoother, output);
+}
+
+static int TestJacobi(vtkPolyData *input)
+{
+  vtkNew(vtkPolyData, serial);
+  vtkNew(vtkPolyData, jacobi);
+  vtkNew(vtkPolyData, jacobiAgain);
+  if (RunExplicit(input, 0, 20, 0.1, serial) != SV_OK ||
+      RunExplicit(input, 1, 20, 0.1, jacobi) != SV_OK ||
+      RunExplicit(input, 1, 20, 0.1, jacobiAgain) != SV_OK)
+    return SV_ERROR;
+
+  // Both smooth the surface by about the same amount
+  double inputRoughness  = Roughness(input);
+  double serialRoughness = Roughness(serial);
+  double jacobiRoughness = Roughness(jacobi);
+  if (serialRoughness >= inputRoughness || jacobiRoughness >= inputRoughness)
+  {
+    fprintf(stdout,"Roughness %g went to %g serial and %g Jacobi\n",
+            inputRoughness, serialRoughness, jacobiRoughness);
+    return SV_ERROR;
+  }
+  if (fabs(jacobiRoughness - serialRoughness) > 0.5*(inputRoughness - serialRoughness))
+  {
+    fprintf(stdout,"Jacobi roughness %g is not close to serial roughness %g\n",
+            jacobiRoughness, serialRoughness);
+    return SV_ERROR;
+  }
+
+  // The points end up close to each other
+  double moved = MaximumDistance(input, serial);
+  double diff  = MaximumDistance(serial, jacobi);
+  if (diff > 0.5*moved)
+  {
+    fprintf(stdout,"Jacobi points are %g from serial points that moved %g\n",
+            diff, moved);
+    return SV_ERROR;
+  }
+
+  // Jacobi passes do not depend on the order the points are visited in
+  if (MaximumDistance(jacobi, jacobiAgain) != 0.0)
+  {
+    fprintf(stdout,"Jacobi smoothing is not repeatable\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestImplicit(vtkPolyData *input)
+{
+  // A small backward Euler step is close to one explicit pass
+  vtkNew(vtkPolyData, explicitStep);
+  vtkNew(vtkPolyData, implicitStep);
+  if (RunExplicit(input, 1, 1, 0.01, explicitStep) != SV_OK ||
+      RunImplicit(input, 0, 1, 0.01, implicitStep) != SV_OK)
+    return SV_ERROR;
+  double moved = MaximumDistance(input, explicitStep);
+  double diff  = MaximumDistance(explicitStep, implicitStep);
+  if (moved == 0.0 || diff > 0.1*moved)
+  {
+    fprintf(stdout,"Implicit step is %g from explicit step that moved %g\n",
+            diff, moved);
+    return SV_ERROR;
+  }
+
+  // Large steps with the laplacian and the bi-laplacian
+  vtkNew(vtkPolyData, laplacian);
+  vtkNew(vtkPolyData, biLaplacian);
+  if (RunImplicit(input, 0, 5, 1.0, laplacian) != SV_OK ||
+      RunImplicit(input, 1, 5, 1.0, biLaplacian) != SV_OK)
+    return SV_ERROR;
+
+  double inputRoughness = Roughness(input);
+  if (Roughness(laplacian) >= inputRoughness ||
+      Roughness(biLaplacian) >= inputRoughness)
+  {
+    fprintf(stdout,"Roughness %g went to %g with the laplacian and %g with the bi-laplacian\n",
+            inputRoughness, Roughness(laplacian), Roughness(biLaplacian));
+    return SV_ERROR;
+  }
+
+  double inputSize = Size(input);
+  if (inputSize - Size(biLaplacian) >= inputSize - Size(laplacian))
+  {
+    fprintf(stdout,"Bi-laplacian shrinks the surface to %g, laplacian to %g, from %g\n",
+            Size(biLaplacian), Size(laplacian), inputSize);
+    return SV_ERROR;
+  }
+
+  // No time step leaves the surface as it is
+  vtkNew(vtkPolyData, noStep);
+  if (RunImplicit(input, 0, 5, 0.0, noStep) != SV_OK)
+    return SV_ERROR;
+  if (MaximumDistance(input, noStep) != 0.0)
+  {
+    fprintf(stdout,"Implicit smoothing with no time step moved the points\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+int TestLocalSmoothPolyDataFilter(int argc, char *argv[])
+{
+  // Read the surface
+  vtkNew(vtkPolyData, surfacePd);
+  char *surface_filename = vtkTestUtilities::ExpandDataFileName(
+    argc, argv, "0141_1001_Renal_Branch_Surface.vtp");
+  vtkSVIOUtils::ReadVTPFile(surface_filename, surfacePd);
+
+  if (TestJacobi(surfacePd) != SV_OK)
+    return EXIT_FAILURE;
+  if (TestImplicit(surfacePd) != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,238 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestSubdivisionStencils.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVSubdivisionStencils.h"
+
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSVGlobals.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Random stencils of one to six points with weights that sum to one
+static void RandomStencils(vtkMinimalStandardRandomSequence *sequence,
+                           const int numStencils, const int numPts,
+                           vtkSVSubdivisionStencils *stencils)
+{
+  stencils->Allocate(numStencils, 6*numStencils);
+  for (int i=0; i<numStencils; i++)
+  {
+    vtkIdType ids[6];
+    double weights[6], sum = 0.0;
+    int npts = 1 + static_cast<int>(6*sequence->GetValue()) % 6;
+    sequence->Next();
+    for (int j=0; j<npts; j++)
+    {
+      ids[j] = static_cast<vtkIdType>(numPts*sequence->GetValue()) % numPts;
+      sequence->Next();
+      weights[j] = 0.1 + sequence->GetValue();
+      sequence->Next();
+      sum += weights[j];
+    }
+    for (int j=0; j<npts; j++)
+      weights[j] /= sum;
+    if (npts == 1)
+      weights[0] = 1.0;
+    stencils->InsertNextStencil(npts, ids, weights);
+  }
+}
+
+static int TestTable()
+{
+  vtkNew(vtkSVSubdivisionStencils, stencils);
+
+  vtkIdType ids0[2] = {3, 5};
+  double weights0[2] = {0.5, 0.5};
+  vtkNew(vtkIdList, ids1);
+  ids1->InsertNextId(1);
+  ids1->InsertNextId(2);
+  ids1->InsertNextId(4);
+  double weights1[3] = {0.25, 0.25, 0.5};
+
+  if (stencils->InsertNextStencil(2, ids0, weights0) != 0 ||
+      stencils->InsertNextStencil(ids1, weights1) != 1 ||
+      stencils->GetNumberOfStencils() != 2)
+  {
+    fprintf(stdout,"Stencils were not added at the end of the table\n");
+    return SV_ERROR;
+  }
+
+  vtkIdType npts;
+  const vtkIdType *ids;
+  const double *weights;
+  stencils->GetStencil(1, npts, ids, weights);
+  if (npts != 3 || ids[0] != 1 || ids[1] != 2 || ids[2] != 4 ||
+      weights[0] != 0.25 || weights[2] != 0.5)
+  {
+    fprintf(stdout,"Stencil 1 does not match what was inserted\n");
+    return SV_ERROR;
+  }
+  stencils->GetStencil(0, npts, ids, weights);
+  if (npts != 2 || ids[0] != 3 || ids[1] != 5 || weights[1] != 0.5)
+  {
+    fprintf(stdout,"Stencil 0 does not match what was inserted\n");
+    return SV_ERROR;
+  }
+
+  stencils->Reset();
+  if (stencils->GetNumberOfStencils() != 0)
+  {
+    fprintf(stdout,"Table is not empty after reset\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestEvaluate(const int numStencils)
+{
+  vtkNew(vtkMinimalStandardRandomSequence, sequence);
+  sequence->SetSeed(1);
+
+  int numPts = 100;
+  vtkNew(vtkPoints, inputPts);
+  vtkNew(vtkDoubleArray, inputData);
+  inputData->SetName("Data");
+  inputData->SetNumberOfComponents(1);
+  for (int i=0; i<numPts; i++)
+  {
+    double x[3];
+    for (int j=0; j<3; j++)
+    {
+      x[j] = sequence->GetValue();
+      sequence->Next();
+    }
+    inputPts->InsertNextPoint(x);
+    inputData->InsertNextTuple1(x[0] + 2.0*x[1] + 3.0*x[2]);
+  }
+  vtkNew(vtkPointData, inputPD);
+  inputPD->AddArray(inputData);
+
+  vtkNew(vtkSVSubdivisionStencils, stencils);
+  RandomStencils(sequence, numStencils, numPts, stencils);
+
+  // The new points go after a copy of the old ones like in the filters
+  vtkNew(vtkPoints, outputPts);
+  vtkNew(vtkPointData, outputPD);
+  outputPD->InterpolateAllocate(inputPD, numPts + numStencils);
+  for (int i=0; i<numPts; i++)
+  {
+    outputPts->InsertNextPoint(inputPts->GetPoint(i));
+    outputPD->CopyData(inputPD, i, i);
+  }
+  stencils->EvaluatePoints(inputPts, outputPts, numPts);
+  stencils->InterpolatePointData(inputPD, outputPD, numPts);
+
+  if (outputPts->GetNumberOfPoints() != numPts + numStencils)
+  {
+    fprintf(stdout,"Output has %d points, expected %d\n",
+            (int) outputPts->GetNumberOfPoints(), numPts + numStencils);
+    return SV_ERROR;
+  }
+
+  // Compare with the weighted sums, the data is linear in the position
+  vtkDataArray *outputData = outputPD->GetArray("Data");
+  for (int i=0; i<numStencils; i++)
+  {
+    vtkIdType npts;
+    const vtkIdType *ids;
+    const double *weights;
+    stencils->GetStencil(i, npts, ids, weights);
+    double expected[3] = {0.0, 0.0, 0.0};
+    for (vtkIdType j=0; j<npts; j++)
+    {
+      double x[3];
+      inputPts->GetPoint(ids[j], x);
+      for (int k=0; k<3; k++)
+        expected[k] += weights[j]*x[k];
+    }
+
+    double x[3];
+    outputPts->GetPoint(numPts + i, x);
+    for (int k=0; k<3; k++)
+    {
+      if (fabs(x[k] - expected[k]) > 1.0e-12)
+      {
+        fprintf(stdout,"Point of stencil %d is not the weighted sum\n", i);
+        return SV_ERROR;
+      }
+    }
+    double value = expected[0] + 2.0*expected[1] + 3.0*expected[2];
+    if (fabs(outputData->GetTuple1(numPts + i) - value) > 1.0e-12)
+    {
+      fprintf(stdout,"Data of stencil %d is %g, expected %g\n", i,
+              outputData->GetTuple1(numPts + i), value);
+      return SV_ERROR;
+    }
+  }
+
+  // Points of the previous level are not touched
+  for (int i=0; i<numPts; i++)
+  {
+    double x[3], y[3];
+    inputPts->GetPoint(i, x);
+    outputPts->GetPoint(i, y);
+    if (x[0] != y[0] || x[1] != y[1] || x[2] != y[2])
+    {
+      fprintf(stdout,"Point %d of the previous level changed\n", i);
+      return SV_ERROR;
+    }
+  }
+
+  return SV_OK;
+}
+
+int TestSubdivisionStencils(int argc, char *argv[])
+{
+  if (TestTable() != SV_OK)
+    return EXIT_FAILURE;
+  if (TestEvaluate(1) != SV_OK)
+    return EXIT_FAILURE;
+  if (TestEvaluate(10000) != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,246 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestSurfaceProjector.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVSurfaceProjector.h"
+
+#include "vtkCellArray.h"
+#include "vtkMath.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSVGlobals.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Wavy height field with quads in the even rows and triangles in the odd
+static void WavySurface(const int dim, vtkPolyData *pd)
+{
+  vtkNew(vtkPoints, points);
+  for (int j=0; j<=dim; j++)
+  {
+    for (int i=0; i<=dim; i++)
+    {
+      double x = static_cast<double>(i)/dim;
+      double y = static_cast<double>(j)/dim;
+      points->InsertNextPoint(x, y, 0.05*sin(2.0*SV_PI*x)*cos(2.0*SV_PI*y));
+    }
+  }
+
+  vtkNew(vtkCellArray, polys);
+  for (int j=0; j<dim; j++)
+  {
+    for (int i=0; i<dim; i++)
+    {
+      vtkIdType p0 = j*(dim+1) + i;
+      vtkIdType quad[4] = {p0, p0+1, p0+dim+2, p0+dim+1};
+      if (j%2 == 0)
+      {
+        polys->InsertNextCell(4, quad);
+      }
+      else
+      {
+        vtkIdType tri0[3] = {quad[0], quad[1], quad[2]};
+        vtkIdType tri1[3] = {quad[0], quad[2], quad[3]};
+        polys->InsertNextCell(3, tri0);
+        polys->InsertNextCell(3, tri1);
+      }
+    }
+  }
+
+  pd->SetPoints(points);
+  pd->SetPolys(polys);
+}
+
+// Closest point by checking every triangle of the fans of the polygons
+static double BruteForceDistance2(vtkPolyData *pd, const double x[3])
+{
+  double minDist2 = VTK_DOUBLE_MAX;
+  vtkCellArray *polys = pd->GetPolys();
+  vtkIdType npts, *pts;
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts);)
+  {
+    for (int j=1; j<npts-1; j++)
+    {
+      double a[3], b[3], c[3], closestPt[3], dist2;
+      pd->GetPoint(pts[0], a);
+      pd->GetPoint(pts[j], b);
+      pd->GetPoint(pts[j+1], c);
+      vtkSVSurfaceProjector::ClosestPointOnTriangle(x, a, b, c, closestPt, dist2);
+      if (dist2 < minDist2)
+        minDist2 = dist2;
+    }
+  }
+  return minDist2;
+}
+
+static int TestClosestPointOnTriangle()
+{
+  double a[3] = {0.0, 0.0, 0.0};
+  double b[3] = {1.0, 0.0, 0.0};
+  double c[3] = {0.0, 1.0, 0.0};
+
+  // One query per region with its closest point
+  double queries[7][3] = {{ 0.2,  0.2, 1.0}, { 0.5, -1.0, 0.0},
+                          { 1.0,  1.0, 0.0}, {-1.0,  0.5, 0.0},
+                          {-1.0, -1.0, 0.0}, { 2.0, -0.5, 0.0},
+                          {-0.5,  2.0, 0.0}};
+  double expected[7][3] = {{0.2, 0.2, 0.0}, {0.5, 0.0, 0.0},
+                           {0.5, 0.5, 0.0}, {0.0, 0.5, 0.0},
+                           {0.0, 0.0, 0.0}, {1.0, 0.0, 0.0},
+                           {0.0, 1.0, 0.0}};
+  for (int i=0; i<7; i++)
+  {
+    double closestPt[3], dist2;
+    int region = vtkSVSurfaceProjector::ClosestPointOnTriangle(queries[i], a, b, c,
+                                                               closestPt, dist2);
+    if (region != i)
+    {
+      fprintf(stdout,"Query %d is in region %d\n", i, region);
+      return SV_ERROR;
+    }
+    if (vtkMath::Distance2BetweenPoints(closestPt, expected[i]) > 1.0e-24 ||
+        fabs(dist2 - vtkMath::Distance2BetweenPoints(closestPt, queries[i])) > 1.0e-12)
+    {
+      fprintf(stdout,"Query %d has the wrong closest point\n", i);
+      return SV_ERROR;
+    }
+  }
+
+  return SV_OK;
+}
+
+static int TestProjection()
+{
+  int dim = 20;
+  vtkNew(vtkPolyData, pd);
+  WavySurface(dim, pd);
+
+  vtkNew(vtkSVSurfaceProjector, projector);
+  if (projector->Build(pd) != SV_OK)
+  {
+    fprintf(stdout,"Could not build the projector\n");
+    return SV_ERROR;
+  }
+  if (projector->GetNumberOfTriangles() != 2*dim*dim)
+  {
+    fprintf(stdout,"Projector has %d triangles, expected %d\n",
+            (int) projector->GetNumberOfTriangles(), 2*dim*dim);
+    return SV_ERROR;
+  }
+
+  vtkNew(vtkMinimalStandardRandomSequence, sequence);
+  sequence->SetSeed(1);
+
+  // Points along a path near the surface, the walk starts from the
+  // triangle of the last point like it does during smoothing
+  vtkIdType lastTriangle = -1;
+  for (int q=0; q<500; q++)
+  {
+    double u = q/500.0;
+    double x[3];
+    x[0] = -0.1 + 1.2*u;
+    x[1] = 0.5 + 0.6*sin(6.0*SV_PI*u);
+    x[2] = 0.05*sin(2.0*SV_PI*x[0])*cos(2.0*SV_PI*x[1]) +
+           sequence->GetRangeValue(-0.02, 0.02);
+    sequence->Next();
+
+    double expected = BruteForceDistance2(pd, x);
+
+    double closestPt[3], dist2;
+    vtkIdType triangleId = projector->FindClosestPoint(x, closestPt, dist2);
+    if (triangleId < 0 || fabs(dist2 - expected) > 1.0e-12)
+    {
+      fprintf(stdout,"Tree distance of query %d is %g, expected %g\n", q,
+              dist2, expected);
+      return SV_ERROR;
+    }
+    if (projector->GetCellId(triangleId) < 0 ||
+        projector->GetCellId(triangleId) >= pd->GetNumberOfPolys())
+    {
+      fprintf(stdout,"Triangle %d has no cell\n", (int) triangleId);
+      return SV_ERROR;
+    }
+
+    vtkIdType startTriangle = lastTriangle;
+    if (startTriangle < 0)
+      startTriangle = triangleId;
+    // The walk stops at a local minimum, above a concave edge that can be
+    // the face that is not the closest
+    triangleId = projector->ProjectPoint(x, startTriangle, closestPt, dist2);
+    if (triangleId < 0 || dist2 < expected - 1.0e-12 ||
+        sqrt(dist2) - sqrt(expected) > 1.0e-3)
+    {
+      fprintf(stdout,"Walk distance of query %d is %g, expected %g\n", q,
+              dist2, expected);
+      return SV_ERROR;
+    }
+    if (fabs(vtkMath::Distance2BetweenPoints(x, closestPt) - dist2) > 1.0e-12)
+    {
+      fprintf(stdout,"Closest point of query %d is not at its distance\n", q);
+      return SV_ERROR;
+    }
+    lastTriangle = triangleId;
+  }
+
+  // No walk at all goes to the tree
+  projector->SetMaximumWalkSteps(0);
+  double x[3] = {0.5, 0.5, 1.0}, closestPt[3], dist2;
+  projector->ProjectPoint(x, 0, closestPt, dist2);
+  if (fabs(dist2 - BruteForceDistance2(pd, x)) > 1.0e-12)
+  {
+    fprintf(stdout,"Tree fall back gave the wrong distance\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+int TestSurfaceProjector(int argc, char *argv[])
+{
+  if (TestClosestPointOnTriangle() != SV_OK)
+    return EXIT_FAILURE;
+  if (TestProjection() != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \file TestUpdeSmoothing.cxx
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#include "vtkSVUpdeSmoothing.h"
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include "vtkSVGlobals.h"
+#include "vtkSVIOUtils.h"
+#include "vtkSVSurfaceProjector.h"
+#include "vtkTestUtilities.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+static int RunSmoothing(vtkPolyData *input, const int useParallel,
+                        vtkPolyData *output,
+                        vtkSVUpdeSmoothing::SweepStatistics &stats)
+{
+  vtkNew(vtkSVUpdeSmoothing, smoother);
+  smoother->SetInputData(input);
+  smoother->SetUseInputAsSource(1);
+  smoother->SetNumberOfInnerSmoothOperations(50);
+  smoother->SetUseParallelSweeps(useParallel);
+  smoother->Update();
+
+  output->DeepCopy(smoother->GetOutput());
+  stats = smoother->GetLastSweepStatistics();
+  if (output->GetNumberOfPoints() != input->GetNumberOfPoints() ||
+      output->GetNumberOfPolys() != input->GetNumberOfPolys())
+  {
+    fprintf(stdout,"Smoothing changed the size of the mesh\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestColoredSweeps(vtkPolyData *input)
+{
+  vtkNew(vtkPolyData, serial);
+  vtkNew(vtkPolyData, parallel);
+  vtkSVUpdeSmoothing::SweepStatistics serialStats, parallelStats;
+  if (RunSmoothing(input, 0, serial, serialStats) != SV_OK ||
+      RunSmoothing(input, 1, parallel, parallelStats) != SV_OK)
+    return SV_ERROR;
+
+  // The colors visit the points in another order, the quality reached is
+  // about the same
+  if (parallelStats.Untangling != serialStats.Untangling)
+  {
+    fprintf(stdout,"Serial and colored sweeps did not end in the same pass\n");
+    return SV_ERROR;
+  }
+  if (fabs(parallelStats.AverageCondition - serialStats.AverageCondition) >
+      0.1*serialStats.AverageCondition)
+  {
+    fprintf(stdout,"Average condition is %g with colored sweeps, %g serial\n",
+            parallelStats.AverageCondition, serialStats.AverageCondition);
+    return SV_ERROR;
+  }
+
+  // The smoothed points are projected back to the input
+  vtkNew(vtkSVSurfaceProjector, projector);
+  projector->Build(input);
+  double length = input->GetLength();
+  for (vtkIdType i=0; i<parallel->GetNumberOfPoints(); i++)
+  {
+    double x[3], closestPt[3], dist2;
+    parallel->GetPoint(i, x);
+    projector->FindClosestPoint(x, closestPt, dist2);
+    if (sqrt(dist2) > 1.0e-3*length)
+    {
+      fprintf(stdout,"Point %d is %g from the surface\n", (int) i, sqrt(dist2));
+      return SV_ERROR;
+    }
+  }
+
+  return SV_OK;
+}
+
+int TestUpdeSmoothing(int argc, char *argv[])
+{
+  // Read the surface
+  vtkNew(vtkPolyData, surfacePd);
+  char *surface_filename = vtkTestUtilities::ExpandDataFileName(
+    argc, argv, "0141_1001_Renal_Branch_Surface.vtp");
+  vtkSVIOUtils::ReadVTPFile(surface_filename, surfacePd);
+
+  if (TestColoredSweeps(surfacePd) != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
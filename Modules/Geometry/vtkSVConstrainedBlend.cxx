@@ -85,6 +85,8 @@ vtkSVConstrainedBlend::vtkSVConstrainedBlend()
     this->NumGradientSolves = 20;
     this->DecimationTargetReduction = 0.01;
     this->NumSubdivisionIterations = 1;
+    this->UseImplicitSmoothing = 0;
+    this->ImplicitTimeStep = 1.0;
 }
 
 // ----------------------
@@ -129,6 +131,8 @@ void vtkSVConstrainedBlend::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Number of conjugate gradient iterations: " << this->NumGradientSolves << "\n";
   os << indent << "Target reduction for decimation: " << this->DecimationTargetReduction << "\n";
   os << indent << "Number of iterations in subdivision: " << this->NumSubdivisionIterations << "\n";
+  os << indent << "Use implicit smoothing: " << this->UseImplicitSmoothing << "\n";
+  os << indent << "Implicit time step: " << this->ImplicitTimeStep << "\n";
 }
 
 // ----------------------
@@ -375,6 +379,8 @@ int vtkSVConstrainedBlend::LaplacianSmooth(vtkPolyData *pd)
   }
   smoother->SetNumberOfIterations(this->NumLapSmoothOperations);
   smoother->SetRelaxationFactor(this->RelaxationFactor);
+  smoother->SetUseImplicitSmoothing(this->UseImplicitSmoothing);
+  smoother->SetImplicitTimeStep(this->ImplicitTimeStep);
   smoother->BoundarySmoothingOff();
   smoother->Update();
 
@@ -107,6 +107,17 @@ public:
   vtkSetMacro(NumLapSmoothOperations,int);
   //@}
 
+  //@{
+  /// \brief Get/Set whether the laplacian smoothing takes implicit steps
+  /// with a time step of ImplicitTimeStep instead of explicit relaxations.
+  /// Each of the NumLapSmoothOperations is then one implicit step.
+  vtkGetMacro(UseImplicitSmoothing,int);
+  vtkSetMacro(UseImplicitSmoothing,int);
+  vtkBooleanMacro(UseImplicitSmoothing,int);
+  vtkGetMacro(ImplicitTimeStep,double);
+  vtkSetMacro(ImplicitTimeStep,double);
+  //@}
+
   //@{
   /// \brief Get/Set the number of maximum conjugate gradient iterations used
   /// for the constrained smoothing.
@@ -167,10 +178,12 @@ protected:
   int NumLapSmoothOperations;
   int NumGradientSolves;
   int NumSubdivisionIterations;
+  int UseImplicitSmoothing;
 
   double Weight;
   double RelaxationFactor;
   double DecimationTargetReduction;
+  double ImplicitTimeStep;
 
 private:
   vtkSVConstrainedBlend(const vtkSVConstrainedBlend&);  // Not implemented.
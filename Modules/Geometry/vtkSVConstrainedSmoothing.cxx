@@ -59,6 +59,7 @@
 #include "vtkSVGeneralUtils.h"
 #include "vtkSVGlobals.h"
 #include "vtkSVMathUtils.h"
+#include "vtkSVSparseCholesky.h"
 #include "vtkSVSparseMatrix.h"
 
 #include <iostream>
@@ -82,6 +83,9 @@ vtkSVConstrainedSmoothing::vtkSVConstrainedSmoothing()
     this->Weight = 0.0;
     this->NumSmoothOperations = 5;
     this->NumGradientSolves = 20;
+    this->UseDirectSolver = 0;
+
+    this->NormalSolver = vtkSVSparseCholesky::New();
 
     this->fixedPt = NULL;
     this->NumFixedPoints = 0;
@@ -102,6 +106,11 @@ vtkSVConstrainedSmoothing::~vtkSVConstrainedSmoothing()
     delete [] this->PointArrayName;
     this->PointArrayName = NULL;
   }
+  if (this->NormalSolver != NULL)
+  {
+    this->NormalSolver->Delete();
+    this->NormalSolver = NULL;
+  }
 }
 
 // ----------------------
@@ -123,6 +132,7 @@ void vtkSVConstrainedSmoothing::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "Number of smooth operations: " << this->NumSmoothOperations << "\n";
   os << indent << "Number of conjugate gradient iterations: " << this->NumGradientSolves << "\n";
+  os << indent << "Use direct solver: " << this->UseDirectSolver << "\n";
 }
 
 // ----------------------
@@ -191,6 +201,13 @@ int vtkSVConstrainedSmoothing::RequestData(vtkInformation *vtkNotUsed(request),
 
     input->BuildLinks();
     this->SetFixedPoints(input);
+    if (this->UseDirectSolver && this->FactorNormalMatrix(input) != SV_OK)
+    {
+      vtkErrorMacro("Could not factor the normal matrix");
+      this->SetErrorCode(vtkErrorCode::UserError + 1);
+      delete [] this->fixedPt;
+      return SV_ERROR;
+    }
     vtkNew(vtkPolyData, tmp);
     tmp->DeepCopy(input);
     for (int i=0;i<this->NumSmoothOperations;i++)
@@ -324,7 +341,8 @@ int vtkSVConstrainedSmoothing::ConstainedSmooth(vtkPolyData *original,vtkPolyDat
   int totalEqs = numPoints*6 - this->NumFixedPoints;
   //Set up spartse matrix for conjugate gradient solve
   vtkNew(vtkSVSparseMatrix, A);
-  A->SetMatrixSize(numPoints*6, numPoints*3);
+  if (!this->UseDirectSolver)
+    A->SetMatrixSize(numPoints*6, numPoints*3);
   std::vector<double> b(numPoints*6);
   std::vector<double> x(numPoints*3);
 
@@ -359,46 +377,64 @@ int vtkSVConstrainedSmoothing::ConstainedSmooth(vtkPolyData *original,vtkPolyDat
       weighting = weighting*(dist);
 
       int x_loc = ((int) pointId)*3 + i;
-      A->SetElement(x_loc,x_loc,1);
+      if (!this->UseDirectSolver)
+        A->SetElement(x_loc,x_loc,1);
       b[x_loc] = pt[i]  + weighting;
       x[x_loc] = pt[i];
     }
 
   }
 
-  for (vtkIdType pointId = 0;pointId < numPoints; pointId++)
+  if (this->UseDirectSolver)
   {
-    if (!this->fixedPt[pointId])
+    // Each coordinate solves (I + L^T L) x = b, the laplacian rows have a
+    // zero right hand side
+    std::vector<double> rhs(numPoints);
+    for (int i=0;i<3;i++)
     {
-      for (int i=0;i<3;i++)
-      {
-        int x_row = numPoints*3 + ((int) pointId)*3 + i;
-        int x_column = ((int) pointId)*3 + i;
-        A->SetElement(x_row,x_column,1);
-        b[x_row] = 0.0;
-      }
-
-      std::set<vtkIdType> neighborPts;
-      this->GetAttachedPoints(current,pointId,&neighborPts);
-      int numNeighborPts = neighborPts.size();
-      //std::cout<<"Checking Neighbor Points ";
-      std::set<vtkIdType>::iterator it;
-      it = neighborPts.begin();
-      while (it != neighborPts.end())
+      for (vtkIdType pointId = 0;pointId < numPoints; pointId++)
+        rhs[pointId] = b[((int) pointId)*3 + i];
+      this->NormalSolver->Solve(&rhs[0]);
+      for (vtkIdType pointId = 0;pointId < numPoints; pointId++)
+        x[((int) pointId)*3 + i] = rhs[pointId];
+    }
+  }
+  else
+  {
+    for (vtkIdType pointId = 0;pointId < numPoints; pointId++)
+    {
+      if (!this->fixedPt[pointId])
       {
         for (int i=0;i<3;i++)
         {
           int x_row = numPoints*3 + ((int) pointId)*3 + i;
-          int x_column = ((int) *it)*3 + i;
-          double value = -1.0/numNeighborPts;
-          A->SetElement(x_row,x_column,value);
+          int x_column = ((int) pointId)*3 + i;
+          A->SetElement(x_row,x_column,1);
+          b[x_row] = 0.0;
+        }
+
+        std::set<vtkIdType> neighborPts;
+        this->GetAttachedPoints(current,pointId,&neighborPts);
+        int numNeighborPts = neighborPts.size();
+        //std::cout<<"Checking Neighbor Points ";
+        std::set<vtkIdType>::iterator it;
+        it = neighborPts.begin();
+        while (it != neighborPts.end())
+        {
+          for (int i=0;i<3;i++)
+          {
+            int x_row = numPoints*3 + ((int) pointId)*3 + i;
+            int x_column = ((int) *it)*3 + i;
+            double value = -1.0/numNeighborPts;
+            A->SetElement(x_row,x_column,value);
+          }
+          ++it;
         }
-        ++it;
       }
     }
-  }
 
-  vtkSVMathUtils::ConjugateGradient(A,&b[0],this->NumGradientSolves,&x[0], 1.0e-8);
+    vtkSVMathUtils::ConjugateGradient(A,&b[0],this->NumGradientSolves,&x[0], 1.0e-8);
+  }
   //Not necessary, just to check how well satisfied
   //std::vector<double> c(totalEqs);
   //A->MultiplyColumn(&x[0],&c[0]);
@@ -425,6 +461,90 @@ int vtkSVConstrainedSmoothing::ConstainedSmooth(vtkPolyData *original,vtkPolyDat
   return SV_OK;
 }
 
+// ----------------------
+// FactorNormalMatrix
+// ----------------------
+int vtkSVConstrainedSmoothing::FactorNormalMatrix(vtkPolyData *pd)
+{
+  int numPoints = pd->GetNumberOfPoints();
+
+  // Laplacian rows, a point that is not fixed has 1 at itself and -1/n at
+  // each of its n attached points
+  std::vector<int> rowOffsets(numPoints+1, 0);
+  std::vector<int> rowColumns;
+  std::vector<double> rowValues;
+  for (vtkIdType pointId = 0;pointId < numPoints; pointId++)
+  {
+    if (!this->fixedPt[pointId])
+    {
+      std::set<vtkIdType> neighborPts;
+      this->GetAttachedPoints(pd,pointId,&neighborPts);
+      int numNeighborPts = neighborPts.size();
+      rowColumns.push_back(pointId);
+      rowValues.push_back(1.0);
+      std::set<vtkIdType>::iterator it;
+      for (it = neighborPts.begin(); it != neighborPts.end(); ++it)
+      {
+        rowColumns.push_back(*it);
+        rowValues.push_back(-1.0/numNeighborPts);
+      }
+    }
+    rowOffsets[pointId+1] = rowColumns.size();
+  }
+
+  // Same rows stored by columns
+  std::vector<int> colOffsets(numPoints+1, 0);
+  std::vector<int> colRows(rowColumns.size());
+  std::vector<double> colValues(rowColumns.size());
+  for (size_t p=0; p<rowColumns.size(); p++)
+    colOffsets[rowColumns[p]+1]++;
+  for (int i=0; i<numPoints; i++)
+    colOffsets[i+1] += colOffsets[i];
+  std::vector<int> next(colOffsets.begin(), colOffsets.end()-1);
+  for (int row=0; row<numPoints; row++)
+  {
+    for (int p=rowOffsets[row]; p<rowOffsets[row+1]; p++)
+    {
+      int q = next[rowColumns[p]]++;
+      colRows[q] = row;
+      colValues[q] = rowValues[p];
+    }
+  }
+
+  // I + L^T L, row a adds row r of L scaled by L(r,a) for each r in column a
+  std::vector<int> offsets(1, 0);
+  std::vector<int> columns;
+  std::vector<double> values;
+  std::vector<int> position(numPoints, -1);
+  for (int a=0; a<numPoints; a++)
+  {
+    int start = columns.size();
+    position[a] = start;
+    columns.push_back(a);
+    values.push_back(1.0);
+    for (int q=colOffsets[a]; q<colOffsets[a+1]; q++)
+    {
+      int row = colRows[q];
+      for (int p=rowOffsets[row]; p<rowOffsets[row+1]; p++)
+      {
+        int col = rowColumns[p];
+        if (position[col] < start)
+        {
+          position[col] = columns.size();
+          columns.push_back(col);
+          values.push_back(0.0);
+        }
+        values[position[col]] += colValues[q]*rowValues[p];
+      }
+    }
+    offsets.push_back(columns.size());
+  }
+
+  if (this->NormalSolver->Analyze(numPoints, offsets, columns) != SV_OK)
+    return SV_ERROR;
+  return this->NormalSolver->Factorize(&values[0]);
+}
+
 // ----------------------
 // GetAttachedPoints
 // ----------------------
@@ -49,6 +49,8 @@
 #include "vtkPolyDataAlgorithm.h"
 #include <set>
 
+class vtkSVSparseCholesky;
+
 class VTKSVGEOMETRY_EXPORT vtkSVConstrainedSmoothing : public vtkPolyDataAlgorithm
 {
 public:
@@ -90,12 +92,24 @@ public:
 
   //@{
   /// \brief Get/Set the number of maximum conjugate gradient iterations used
-  /// for the constrained smoothing.
-  /// each sub blend
+  /// for the constrained smoothing when UseDirectSolver is off.
   vtkGetMacro(NumGradientSolves,int);
   vtkSetMacro(NumGradientSolves,int);
   //@}
 
+  //@{
+  /// \brief Get/Set whether the least squares problem is solved through its
+  /// normal equations with a sparse factorization. The normal matrix only
+  /// depends on the connectivity, so it is assembled and factored once and
+  /// each smooth operation only changes the right hand side. If off, the
+  /// full system is built and solved with conjugate gradients every
+  /// operation. The direct solve gives the converged answer, which differs
+  /// from the NumGradientSolves limited iterations. Default is off.
+  vtkGetMacro(UseDirectSolver,int);
+  vtkSetMacro(UseDirectSolver,int);
+  vtkBooleanMacro(UseDirectSolver,int);
+  //@}
+
 protected:
   vtkSVConstrainedSmoothing();
   ~vtkSVConstrainedSmoothing();
@@ -118,9 +132,17 @@ protected:
   int GetAttachedPoints(vtkPolyData *pd, vtkIdType nodeId, std::set<vtkIdType> *attachedPts);
   int SetFixedPoints(vtkPolyData *pd);
 
+  /// \brief Assemble and factor the normal matrix I + L^T L of one
+  /// coordinate, where L holds the laplacian rows of the points that are
+  /// not fixed.
+  int FactorNormalMatrix(vtkPolyData *pd);
+
   double Weight;
   int NumSmoothOperations;
   int NumGradientSolves;
+  int UseDirectSolver;
+
+  vtkSVSparseCholesky *NormalSolver;
 
   int *fixedPt;
   int NumFixedPoints;
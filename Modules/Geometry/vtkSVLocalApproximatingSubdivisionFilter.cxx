@@ -48,7 +48,6 @@
 #include "vtkCell.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
-#include "vtkEdgeTable.h"
 #include "vtkErrorCode.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
@@ -59,6 +58,8 @@
 #include "vtkUnsignedCharArray.h"
 
 #include "vtkSVGeneralUtils.h"
+#include "vtkSVHalfEdgeTable.h"
+#include "vtkSVSubdivisionStencils.h"
 #include "vtkSVGlobals.h"
 
 // ----------------------
@@ -72,6 +73,10 @@ vtkSVLocalApproximatingSubdivisionFilter::vtkSVLocalApproximatingSubdivisionFilt
   this->NumberOfSubdivisions = 1;
   this->UseCellArray = 0;
   this->UsePointArray = 0;
+
+  this->HalfEdges = vtkSVHalfEdgeTable::New();
+  this->VertexStencils = vtkSVSubdivisionStencils::New();
+  this->EdgeStencils = vtkSVSubdivisionStencils::New();
 }
 
 // ----------------------
@@ -89,6 +94,21 @@ vtkSVLocalApproximatingSubdivisionFilter::~vtkSVLocalApproximatingSubdivisionFil
     delete [] this->SubdividePointArrayName;
     this->SubdividePointArrayName = NULL;
   }
+  if (this->HalfEdges != NULL)
+  {
+    this->HalfEdges->Delete();
+    this->HalfEdges = NULL;
+  }
+  if (this->VertexStencils != NULL)
+  {
+    this->VertexStencils->Delete();
+    this->VertexStencils = NULL;
+  }
+  if (this->EdgeStencils != NULL)
+  {
+    this->EdgeStencils->Delete();
+    this->EdgeStencils = NULL;
+  }
 }
 
 // ----------------------
@@ -183,8 +203,9 @@ int vtkSVLocalApproximatingSubdivisionFilter::RequestData(
                                                   this->NumberOfSubdivisions);
     abort = this->GetAbortExecute();
 
-    // Generate topology  for the input dataset
-    inputDS->BuildLinks();
+    // Generate topology  for the input dataset. The half-edges are all the
+    // filters need, so no links or cells are built for the level.
+    this->HalfEdges->Build(inputDS);
 
     numCells = inputDS->GetNumberOfCells ();
     numPts = inputDS->GetNumberOfPoints();
@@ -193,11 +214,12 @@ int vtkSVLocalApproximatingSubdivisionFilter::RequestData(
     // include even points (computed from old points) and
     // odd points (inserted on edges)
     outputPts = vtkPoints::New();
-    outputPts->Allocate (numPts);
+    outputPts->Allocate (numPts + this->HalfEdges->GetNumberOfEdges());
 
     // Copy pointdata structure from input
     outputPD = vtkPointData::New();
-    outputPD->CopyAllocate(inputDS->GetPointData(),2*inputDS->GetNumberOfPoints());
+    outputPD->CopyAllocate(inputDS->GetPointData(),
+                           numPts + this->HalfEdges->GetNumberOfEdges());
 
     // Copy celldata structure from input
     outputCD = vtkCellData::New();
@@ -234,8 +256,11 @@ int vtkSVLocalApproximatingSubdivisionFilter::RequestData(
     inputDS->SetPolys(outputPolys); outputPolys->Delete();
     inputDS->GetPointData()->PassData(outputPD); outputPD->Delete();
     inputDS->GetCellData()->PassData(outputCD); outputCD->Delete();
-    inputDS->Squeeze();
     } // each level
+  this->HalfEdges->Reset();
+  this->VertexStencils->Reset();
+  this->EdgeStencils->Reset();
+  inputDS->Squeeze();
 
   output->SetPoints(inputDS->GetPoints());
   output->SetPolys(inputDS->GetPolys());
@@ -246,49 +271,6 @@ int vtkSVLocalApproximatingSubdivisionFilter::RequestData(
   return SV_OK;
 }
 
-// ----------------------
-// FindEdge
-// ----------------------
-int vtkSVLocalApproximatingSubdivisionFilter::FindEdge (vtkPolyData *mesh,
-                                                 vtkIdType cellId,
-                                                 vtkIdType p1, vtkIdType p2,
-                                                 vtkIntArray *edgeData,
-                                                 vtkIdList *cellIds)
-{
-
-  int edgeId = 0;
-  vtkIdType currentCellId = 0;
-  vtkIdType i;
-  int numEdges;
-  vtkIdType tp1, tp2;
-  vtkCell *cell;
-
-  // get all the cells that use the edge (except for cellId)
-  mesh->GetCellEdgeNeighbors (cellId, p1, p2, cellIds);
-
-  // find the edge that has the point we are looking for
-  for ( i=0; i < cellIds->GetNumberOfIds(); i++)
-    {
-    currentCellId = cellIds->GetId(i);
-    cell = mesh->GetCell(currentCellId);
-    numEdges = cell->GetNumberOfEdges();
-    tp1 = cell->GetPointId(2);
-    tp2 = cell->GetPointId(0);
-    for (edgeId=0; edgeId < numEdges; edgeId++)
-      {
-      if ( (tp1 == p1 && tp2 == p2) ||
-           (tp2 == p1 && tp1 == p2))
-        {
-        break;
-        }
-      tp1 = tp2;
-      tp2 = cell->GetPointId(edgeId + 1);
-      }
-    }
-    // found the edge, return the stored value
-  return static_cast<int>(edgeData->GetComponent(currentCellId,edgeId));
-}
-
 // ----------------------
 // InterpolatePosition
 // ----------------------
@@ -335,7 +317,6 @@ void vtkSVLocalApproximatingSubdivisionFilter::GenerateSubdivisionCells (
   vtkPolyData *inputDS, vtkIntArray *edgeData, vtkCellArray *outputPolys,
   vtkCellData *outputCD)
 {
-  vtkIdType numCells = inputDS->GetNumberOfCells();
   vtkIdType cellId, newId;
   int id;
   vtkIdType npts;
@@ -343,16 +324,17 @@ void vtkSVLocalApproximatingSubdivisionFilter::GenerateSubdivisionCells (
   double edgePts[3];
   vtkIdType newCellPts[3];
   vtkCellData *inputCD = inputDS->GetCellData();
+  vtkCellArray *inputPolys = inputDS->GetPolys();
 
   // Now create new cells from existing points and generated edge points
-  for (cellId=0; cellId < numCells; cellId++)
+  for (cellId=0, inputPolys->InitTraversal();
+       inputPolys->GetNextCell(npts, pts); cellId++)
     {
-    if ( inputDS->GetCellType(cellId) != VTK_TRIANGLE )
+    if (npts != 3)
       {
       continue;
       }
-    // get the original point ids and the ids stored as cell data
-    inputDS->GetCellPoints(cellId, npts, pts);
+    // the ids stored as cell data
     edgeData->GetTuple(cellId, edgePts);
     int newPtCount=0;
     for (int i=0;i<npts;i++)
@@ -53,6 +53,9 @@
 #include "vtkPointData.h"
 #include "vtkPoints.h"
 
+class vtkSVHalfEdgeTable;
+class vtkSVSubdivisionStencils;
+
 class VTKSVGEOMETRY_EXPORT vtkSVLocalApproximatingSubdivisionFilter : public vtkPolyDataAlgorithm
 {
 public:
@@ -96,8 +99,6 @@ protected:
   void GenerateSubdivisionCells (vtkPolyData *inputDS, vtkIntArray *edgeData,
                                  vtkCellArray *outputPolys,
                                  vtkCellData *outputCD);
-  int FindEdge (vtkPolyData *mesh, vtkIdType cellId, vtkIdType p1,
-                vtkIdType p2, vtkIntArray *edgeData, vtkIdList *cellIds);
   vtkIdType InterpolatePosition (vtkPoints *inputPts, vtkPoints *outputPts,
                                  vtkIdList *stencil, double *weights);
   vtkIdType KeepPosition (vtkPoints *inputPts, vtkPoints *outputPts,
@@ -113,6 +114,15 @@ protected:
   int UsePointArray;
 
   int NumberOfSubdivisions;
+
+  // Half-edges of the current level, built once before the points of the
+  // level are generated.
+  vtkSVHalfEdgeTable *HalfEdges;
+
+  // Stencils of the moved old points and of the new edge points of the
+  // current level, evaluated together once all are known.
+  vtkSVSubdivisionStencils *VertexStencils;
+  vtkSVSubdivisionStencils *EdgeStencils;
 private:
   vtkSVLocalApproximatingSubdivisionFilter(const vtkSVLocalApproximatingSubdivisionFilter&);  // Not implemented.
   void operator=(const vtkSVLocalApproximatingSubdivisionFilter&);  // Not implemented.
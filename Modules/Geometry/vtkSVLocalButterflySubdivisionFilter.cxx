@@ -47,7 +47,6 @@
 
 #include "vtkMath.h"
 #include "vtkCellArray.h"
-#include "vtkEdgeTable.h"
 #include "vtkErrorCode.h"
 #include "vtkIdList.h"
 #include "vtkObjectFactory.h"
@@ -57,6 +56,10 @@
 #include "vtkSmartPointer.h"
 
 #include "vtkSVGlobals.h"
+#include "vtkSVHalfEdgeTable.h"
+#include "vtkSVSubdivisionStencils.h"
+
+#include <vector>
 
 // ----------------------
 // StandardNewMacro
@@ -81,26 +84,32 @@ int vtkSVLocalButterflySubdivisionFilter::GenerateSubdivisionPoints(
   vtkIdType cellId, newId, i, j;
   int edgeId;
   vtkIdType npts = 0;
-  vtkIdType p1, p2, p3;
+  vtkIdType p1, p2, halfEdge, edge, neighborId;
   int valence1, valence2;
   vtkCellArray *inputPolys=inputDS->GetPolys();
-  vtkNew(vtkIdList, cellIds);
-  vtkNew(vtkIdList, p1CellIds);
-  vtkNew(vtkIdList, p2CellIds);
+  vtkSVHalfEdgeTable *halfEdges = this->HalfEdges;
+  vtkSVSubdivisionStencils *edgeStencils = this->EdgeStencils;
   vtkNew(vtkIdList, stencil);
   vtkNew(vtkIdList, stencil1);
   vtkNew(vtkIdList, stencil2);
   vtkPoints *inputPts=inputDS->GetPoints();
   vtkPointData *inputPD=inputDS->GetPointData();
-  vtkNew(vtkIdList, edgeNeighbor);
+  vtkIdType numPts = inputDS->GetNumberOfPoints();
 
   weights = new double[256];
   weights1 = new double[256];
   weights2 = new double[256];
 
-  // Create an edge table to keep track of which edges we've processed
-  vtkNew(vtkEdgeTable, edgeTable);
-  edgeTable->InitEdgeInsertion(inputDS->GetNumberOfPoints());
+  // New point of each edge, -1 until it is created
+  std::vector<vtkIdType> edgePoints(halfEdges->GetNumberOfEdges(), -1);
+  edgeStencils->Allocate(halfEdges->GetNumberOfEdges(),
+                         8*halfEdges->GetNumberOfEdges());
+
+  // The old points keep their data
+  for (vtkIdType ptId=0; ptId < numPts; ptId++)
+    {
+    outputPD->CopyData (inputPD, ptId, ptId);
+    }
 
   int total = inputPolys->GetNumberOfCells();
   int *noSubdivideCell = new int[total];
@@ -113,74 +122,64 @@ int vtkSVLocalButterflySubdivisionFilter::GenerateSubdivisionPoints(
   for (cellId=0, inputPolys->InitTraversal();
        inputPolys->GetNextCell(npts, pts); cellId++)
     {
-    p1 = pts[2];
-    p2 = pts[0];
-
-    if ( inputDS->GetCellType(cellId) != VTK_TRIANGLE)
+    if (npts != 3)
       {
       continue;
       }
 
     for (edgeId=0; edgeId < 3; edgeId++)
       {
-      isLocalBoundary = 0;
-      inputDS->GetCellEdgeNeighbors (cellId, p1, p2, edgeNeighbor);
-      if (edgeNeighbor->GetNumberOfIds() > 1)
+      halfEdge = vtkSVHalfEdgeTable::GetHalfEdge(cellId, edgeId);
+      edge = halfEdges->GetEdge(halfEdge);
+      p1 = halfEdges->GetOrigin(halfEdge);
+      p2 = halfEdges->GetTarget(halfEdge);
+
+      if (halfEdges->GetEdgeNumberOfCells(edge) > 2)
         {
         delete [] weights; delete [] weights1; delete [] weights2;
         delete [] noSubdivideCell;
         vtkErrorMacro ("Dataset is non-manifold and cannot be subdivided.");
         return 0;
         }
-      if (noSubdivideCell[edgeNeighbor->GetId(0)] ||
+      isLocalBoundary = 0;
+      neighborId = halfEdges->GetNeighbor(halfEdge);
+      if ((neighborId != -1 && noSubdivideCell[neighborId]) ||
 	  noSubdivideCell[cellId])
 	isLocalBoundary = 1;
 
-      outputPD->CopyData (inputPD, p1, p1);
-      outputPD->CopyData (inputPD, p2, p2);
-      // Do we need to  create a point on this edge?
-      if (edgeTable->IsEdge (p1, p2) == -1 && isLocalBoundary == 0)
+      // Do we need to  create a point on this edge? Edges between
+      // subdivided and fixed cells do not get a point.
+      if (edgePoints[edge] == -1 && isLocalBoundary == 0)
         {
-        edgeTable->InsertEdge (p1, p2);
-
-        inputDS->GetCellEdgeNeighbors (-1, p1, p2, cellIds);
         // If this is a boundary edge. we need to use a special subdivision rule
-        if (cellIds->GetNumberOfIds() == 1)
+        if (halfEdges->GetEdgeNumberOfCells(edge) == 1)
           {
           // Compute new Position and PointData using the same subdivision scheme
-          this->GenerateBoundaryStencil (p1, p2,
-                                         inputDS, stencil, weights);
+          this->GenerateBoundaryStencil (p1, p2, stencil, weights);
           } // boundary edge
-        else if (cellIds->GetNumberOfIds() == 2)
+        else
           {
           // find the valence of the two points
-          inputDS->GetPointCells (p1, p1CellIds);
-          valence1 = p1CellIds->GetNumberOfIds();
-          inputDS->GetPointCells (p2, p2CellIds);
-          valence2 = p2CellIds->GetNumberOfIds();
+          valence1 = halfEdges->GetPointNumberOfCells(p1);
+          valence2 = halfEdges->GetPointNumberOfCells(p2);
 
           if (valence1 == 6 && valence2 == 6)
             {
-            this->GenerateButterflyStencil (p1, p2,
-                                            inputDS, stencil, weights);
+            this->GenerateButterflyStencil (p1, p2, edge, stencil, weights);
             }
           else if (valence1 == 6 && valence2 != 6)
             {
-            this->GenerateLoopStencil (p2, p1,
-                                       inputDS, stencil, weights);
+            this->GenerateLoopStencil (p2, p1, edge, stencil, weights);
             }
           else if (valence1 != 6 && valence2 == 6)
             {
-            this->GenerateLoopStencil (p1, p2,
-                                       inputDS, stencil, weights);
+            this->GenerateLoopStencil (p1, p2, edge, stencil, weights);
             }
           else
             {
             // Edge connects two extraordinary vertices
-            this->GenerateLoopStencil (p2, p1,
-                                       inputDS, stencil1, weights1);
-            this->GenerateLoopStencil (p1, p2,
-                                       inputDS, stencil2, weights2);
+            this->GenerateLoopStencil (p2, p1, edge, stencil1, weights1);
+            this->GenerateLoopStencil (p1, p2, edge, stencil2, weights2);
             // combine the two stencils and halve the weights
             vtkIdType total = stencil1->GetNumberOfIds() +
               stencil2->GetNumberOfIds();
@@ -199,46 +198,19 @@ int vtkSVLocalButterflySubdivisionFilter::GenerateSubdivisionPoints(
               }
             }
           }
-        else
-          {
-          delete [] weights; delete [] weights1; delete [] weights2;
-          vtkErrorMacro ("Dataset is non-manifold and cannot be subdivided.");
-          //return 0;
-          }
-          newId = this->InterpolatePosition (inputPts, outputPts, stencil, weights);
-          outputPD->InterpolatePoint (inputPD, newId, stencil, weights);
-        }
-      else if (isLocalBoundary == 0) // we have already created a point on this edge. find it
-        {
-        newId = this->FindEdge (inputDS, cellId, p1, p2, edgeData, cellIds);
-        }
-      else
-        {
-        newId = -1;
-        //std::cout<<"How much is this actually happening"<<endl;
-        //This is a boundary between subdivision and no subdivision. We do not want to put a point here.
-        if (edgeTable->IsEdge (p1, p2) == -1)
-          {
-          outputPD->CopyData (inputPD, p1, p1);
-          outputPD->CopyData (inputPD, p2, p2);
-          edgeTable->InsertEdge (p1, p2);
-          }
-        else
-          {
-          inputDS->GetCellEdgeNeighbors (-1, p1, p2, cellIds);
-          //newId = this->FindEdge (inputDS, cellId, p1, p2, edgeData, cellIds);
-          }
+        // The point is computed with the others once all stencils are known
+        edgePoints[edge] = numPts +
+          edgeStencils->InsertNextStencil (stencil, weights);
         }
+      newId = edgePoints[edge];
       edgeData->InsertComponent(cellId,edgeId,newId);
-      p1 = p2;
-      if (edgeId < 2)
-        {
-        p2 = pts[edgeId + 1];
-        }
-        //}
       } // each interior edge
     } // each cell
 
+  // Compute new Position and PointData for all edges at once
+  edgeStencils->EvaluatePoints (inputPts, outputPts, numPts);
+  edgeStencils->InterpolatePointData (inputPD, outputPD, numPts);
+
   // cleanup
   delete [] weights; delete [] weights1; delete [] weights2;
   delete [] noSubdivideCell;
@@ -250,58 +222,48 @@ int vtkSVLocalButterflySubdivisionFilter::GenerateSubdivisionPoints(
 // GenerateLoopStencil
 // ----------------------
 void vtkSVLocalButterflySubdivisionFilter::GenerateLoopStencil(
-  vtkIdType p1, vtkIdType p2, vtkPolyData *polys, vtkIdList *stencilIds,
+  vtkIdType p1, vtkIdType p2, vtkIdType edgeId, vtkIdList *stencilIds,
   double *weights)
 {
-  vtkIdList *cellIds = vtkIdList::New();
-  vtkCell *cell;
+  vtkSVHalfEdgeTable *halfEdges = this->HalfEdges;
   int j;
-  vtkIdType startCell, nextCell, tp2, p;
+  vtkIdType startEdge, startCell, nextCell, tp2, p, halfEdge;
   int shift[255];
   int processed = 0;
   int boundary = 0;
 
-  // Find another cell with this edge (we assume there is just one)
-  polys->GetCellEdgeNeighbors (-1, p1, p2, cellIds);
-  startCell = cellIds->GetId(0);
+  // The two cells of the edge (we assume there are just two)
+  startEdge = halfEdges->GetEdgeHalfEdge(edgeId);
+  startCell = vtkSVHalfEdgeTable::GetCell(startEdge);
 
   stencilIds->Reset();
   stencilIds->InsertNextId (p2);
   shift[0] = 0;
 
   // Walk around the loop and get cells
-  nextCell = cellIds->GetId(1);
+  nextCell = halfEdges->GetNeighbor(startEdge);
   tp2 = p2;
   while (nextCell != startCell)
     {
-    cell = polys->GetCell(nextCell);
-    p = -1;
-    for (int i = 0; i < 3; i++)
-      {
-      if ((p = cell->GetPointId(i)) != p1 && cell->GetPointId(i) != tp2)
-        {
-        break;
-        }
-      }
+    halfEdge = halfEdges->FindHalfEdge(nextCell, p1, tp2);
+    p = halfEdges->GetApex(halfEdge);
     tp2 = p;
     stencilIds->InsertNextId (tp2);
     processed++;
     shift[processed] = processed;
-    polys->GetCellEdgeNeighbors (nextCell, p1, tp2, cellIds);
-    if (cellIds->GetNumberOfIds() != 1)
+    halfEdge = halfEdges->FindHalfEdge(nextCell, p1, tp2);
+    if (halfEdges->GetNeighbor(halfEdge) == -1)
       {
       boundary = 1;
        break;
       }
-    nextCell = cellIds->GetId(0);
+    nextCell = halfEdges->GetNeighbor(halfEdge);
     }
 
   // If p1 or p2 is on the boundary, use the butterfly stencil with reflected vertices.
   if (boundary)
     {
-    this->GenerateButterflyStencil (p1, p2,
-                                    polys, stencilIds, weights);
-    cellIds->Delete();
+    this->GenerateButterflyStencil (p1, p2, edgeId, stencilIds, weights);
     return;
     }
 
@@ -333,16 +295,7 @@ void vtkSVLocalButterflySubdivisionFilter::GenerateLoopStencil(
     }
   else
     {  // K == 2. p1 must be on a boundary edge,
-    cell = polys->GetCell(startCell);
-    p = -1;
-    for (int i = 0; i < 3; i++)
-      {
-      if ((p = cell->GetPointId(i)) != p1 && cell->GetPointId(i) != p2)
-        {
-        break;
-        }
-      }
-    p2 = p;
+    p2 = halfEdges->GetApex(startEdge);
     stencilIds->InsertNextId (p2);
     weights[0] = 5.0 / 12.0;
     weights[1] = -1.0 / 12.0;
@@ -351,61 +304,63 @@ void vtkSVLocalButterflySubdivisionFilter::GenerateLoopStencil(
   // add in the extraordinary vertex
   weights[stencilIds->GetNumberOfIds()] = .75;
   stencilIds->InsertNextId (p1);
-
-  cellIds->Delete();
 }
 
 // ----------------------
 // GenerateBoundaryStencil
 // ----------------------
 void vtkSVLocalButterflySubdivisionFilter::GenerateBoundaryStencil(
-  vtkIdType p1, vtkIdType p2, vtkPolyData *polys, vtkIdList *stencilIds,
-  double *weights)
+  vtkIdType p1, vtkIdType p2, vtkIdList *stencilIds, double *weights)
 {
-  vtkIdList *cellIds = vtkIdList::New();
-  vtkIdType *cells;
-  unsigned short ncells;
-  vtkIdType *pts;
-  vtkIdType npts;
+  vtkSVHalfEdgeTable *halfEdges = this->HalfEdges;
+  const vtkIdType *pointEdges;
+  vtkIdType ncells, halfEdge, other;
   int i, j;
   vtkIdType p0, p3;
 
   // find a boundary edge that uses p1 other than the one containing p2
-  polys->GetPointCells (p1, ncells, cells);
+  ncells = halfEdges->GetPointNumberOfCells(p1);
+  pointEdges = halfEdges->GetPointHalfEdges(p1);
   p0 = -1;
   for (i = 0; i < ncells && p0 == -1; i++)
     {
-    polys->GetCellPoints (cells[i], npts, pts);
-    for (j = 0; j < npts; j++)
+    // the two edges of the cell at p1
+    for (j = 0; j < 2; j++)
       {
-      if (pts[j] == p1 || pts[j] == p2)
+      halfEdge = j == 0 ? pointEdges[i] :
+        vtkSVHalfEdgeTable::GetPrevious(pointEdges[i]);
+      other = j == 0 ? halfEdges->GetTarget(halfEdge) :
+        halfEdges->GetOrigin(halfEdge);
+      if (other == p1 || other == p2)
         {
         continue;
         }
-      polys->GetCellEdgeNeighbors (-1, p1, pts[j], cellIds);
-      if (cellIds->GetNumberOfIds() == 1)
+      if (halfEdges->GetEdgeNumberOfCells(halfEdges->GetEdge(halfEdge)) == 1)
         {
-        p0 = pts[j];
+        p0 = other;
         break;
         }
       }
     }
   // find a boundary edge that uses p2 other than the one containing p1
-  polys->GetPointCells (p2, ncells, cells);
+  ncells = halfEdges->GetPointNumberOfCells(p2);
+  pointEdges = halfEdges->GetPointHalfEdges(p2);
   p3 = -1;
   for (i = 0; i < ncells && p3 == -1; i++)
     {
-    polys->GetCellPoints (cells[i], npts, pts);
-    for (j = 0; j < npts; j++)
+    for (j = 0; j < 2; j++)
       {
-      if (pts[j] == p1 || pts[j] == p2 || pts[j] == p0)
+      halfEdge = j == 0 ? pointEdges[i] :
+        vtkSVHalfEdgeTable::GetPrevious(pointEdges[i]);
+      other = j == 0 ? halfEdges->GetTarget(halfEdge) :
+        halfEdges->GetOrigin(halfEdge);
+      if (other == p1 || other == p2 || other == p0)
         {
         continue;
         }
-      polys->GetCellEdgeNeighbors (-1, p2, pts[j], cellIds);
-      if (cellIds->GetNumberOfIds() == 1)
+      if (halfEdges->GetEdgeNumberOfCells(halfEdges->GetEdge(halfEdge)) == 1)
         {
-        p3 = pts[j];
+        p3 = other;
         break;
         }
       }
@@ -419,107 +374,40 @@ void vtkSVLocalButterflySubdivisionFilter::GenerateBoundaryStencil(
   weights[1] = .5625;
   weights[2] = .5625;
   weights[3] = -.0625;
-
-  cellIds->Delete();
 }
 
 // ----------------------
 // GenerateButterflyStencil
 // ----------------------
 void vtkSVLocalButterflySubdivisionFilter::GenerateButterflyStencil (
-  vtkIdType p1, vtkIdType p2, vtkPolyData *polys, vtkIdList *stencilIds,
+  vtkIdType p1, vtkIdType p2, vtkIdType edgeId, vtkIdList *stencilIds,
   double *weights)
 {
-  vtkIdList *cellIds = vtkIdList::New();
-  vtkCell *cell;
+  vtkSVHalfEdgeTable *halfEdges = this->HalfEdges;
   int i;
-  vtkIdType cell0, cell1;
-  vtkIdType p, p3, p4, p5, p6, p7, p8;
+  vtkIdType edge0, edge1, cell0, cell1, halfEdge;
+  vtkIdType p3, p4, p5, p6, p7, p8;
 
-  polys->GetCellEdgeNeighbors (-1, p1, p2, cellIds);
-  cell0 = cellIds->GetId(0);
-  cell1 = cellIds->GetId(1);
+  edge0 = halfEdges->GetEdgeHalfEdge(edgeId);
+  edge1 = halfEdges->GetOpposite(edge0);
+  cell0 = vtkSVHalfEdgeTable::GetCell(edge0);
+  cell1 = vtkSVHalfEdgeTable::GetCell(edge1);
 
-  cell = polys->GetCell(cell0);
-  p3 = -1;
-  for (i = 0; i < 3; i++)
-    {
-    if ((p = cell->GetPointId(i)) != p1 && cell->GetPointId(i) != p2)
-      {
-      p3 = p;
-      break;
-      }
-    }
-  cell = polys->GetCell(cell1);
-  p4 = -1;
-  for (i = 0; i < 3; i++)
-    {
-    if ((p = cell->GetPointId(i)) != p1 && cell->GetPointId(i) != p2)
-      {
-      p4 = p;
-      break;
-      }
-    }
+  p3 = halfEdges->GetApex(edge0);
+  p4 = halfEdges->GetApex(edge1);
 
-  polys->GetCellEdgeNeighbors (cell0, p1, p3, cellIds);
-  p5 = -1;
-  if (cellIds->GetNumberOfIds() > 0)
-    {
-    cell = polys->GetCell(cellIds->GetId(0));
-    for (i = 0; i < 3; i++)
-      {
-      if ((p = cell->GetPointId(i)) != p1 && cell->GetPointId(i) != p3)
-        {
-        p5 = p;
-        break;
-        }
-      }
-    }
+  // points across the other edges of the two cells
+  halfEdge = halfEdges->GetOpposite(halfEdges->FindHalfEdge(cell0, p1, p3));
+  p5 = halfEdge == -1 ? -1 : halfEdges->GetApex(halfEdge);
 
-  polys->GetCellEdgeNeighbors (cell0, p2, p3, cellIds);
-  p6 = -1;
-  if (cellIds->GetNumberOfIds() > 0)
-    {
-    cell = polys->GetCell(cellIds->GetId(0));
-    for (i = 0; i < 3; i++)
-      {
-      if ((p = cell->GetPointId(i)) != p2 && cell->GetPointId(i) != p3)
-        {
-        p6 = p;
-        break;
-        }
-      }
-    }
+  halfEdge = halfEdges->GetOpposite(halfEdges->FindHalfEdge(cell0, p2, p3));
+  p6 = halfEdge == -1 ? -1 : halfEdges->GetApex(halfEdge);
 
-  polys->GetCellEdgeNeighbors (cell1, p1, p4, cellIds);
-  p7 = -1;
-  if (cellIds->GetNumberOfIds() > 0)
-    {
-    cell = polys->GetCell(cellIds->GetId(0));
-    for (i = 0; i < 3; i++)
-      {
-      if ((p = cell->GetPointId(i)) != p1 && cell->GetPointId(i) != p4)
-        {
-        p7 = p;
-        break;
-        }
-      }
-    }
+  halfEdge = halfEdges->GetOpposite(halfEdges->FindHalfEdge(cell1, p1, p4));
+  p7 = halfEdge == -1 ? -1 : halfEdges->GetApex(halfEdge);
 
-  p8 = -1;
-  polys->GetCellEdgeNeighbors (cell1, p2, p4, cellIds);
-  if (cellIds->GetNumberOfIds() > 0)
-    {
-    cell = polys->GetCell(cellIds->GetId(0));
-    for (i = 0; i < 3; i++)
-      {
-      if ((p = cell->GetPointId(i)) != p2 && cell->GetPointId(i) != p4)
-        {
-        p8= p;
-        break;
-        }
-      }
-    }
+  halfEdge = halfEdges->GetOpposite(halfEdges->FindHalfEdge(cell1, p2, p4));
+  p8 = halfEdge == -1 ? -1 : halfEdges->GetApex(halfEdge);
 
   stencilIds->SetNumberOfIds (8);
   stencilIds->SetId(0, p1);
@@ -583,7 +471,6 @@ void vtkSVLocalButterflySubdivisionFilter::GenerateButterflyStencil (
     {
     weights[i] = butterflyWeights[i];
     }
-  cellIds->Delete();
 }
 
 // ----------------------
@@ -601,14 +488,13 @@ int vtkSVLocalButterflySubdivisionFilter::SetFixedCells(vtkPolyData *pd, int *no
 	noSubdivideCell[cellId] = 1;
     }
   }
-  int numPoints = pd->GetNumberOfPoints();
-  vtkIdType npts,*pts;
+  vtkIdType npts,*pts,cellId;
+  vtkCellArray *polys = pd->GetPolys();
   if (this->UsePointArray)
   {
-    for (vtkIdType cellId=0;cellId < numCells;cellId++)
+    for (cellId=0, polys->InitTraversal(); polys->GetNextCell(npts, pts); cellId++)
     {
       int fixedPts = 0;
-      pd->GetCellPoints(cellId,npts,pts);
       for (int i=0;i<npts;i++)
       {
 	vtkIdType pointId= pts[i];
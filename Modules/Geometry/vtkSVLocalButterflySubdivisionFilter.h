@@ -84,11 +84,11 @@ protected:
 private:
   int GenerateSubdivisionPoints(vtkPolyData *inputDS, vtkIntArray *edgeData,
                                 vtkPoints *outputPts, vtkPointData *outputPD) override;
-  void GenerateButterflyStencil(vtkIdType p1, vtkIdType p2, vtkPolyData *polys,
+  void GenerateButterflyStencil(vtkIdType p1, vtkIdType p2, vtkIdType edgeId,
                                 vtkIdList *stencilIds, double *weights);
-  void GenerateLoopStencil(vtkIdType p1, vtkIdType p2, vtkPolyData *polys,
+  void GenerateLoopStencil(vtkIdType p1, vtkIdType p2, vtkIdType edgeId,
                            vtkIdList *stencilIds, double *weights);
-  void GenerateBoundaryStencil(vtkIdType p1, vtkIdType p2, vtkPolyData *polys,
+  void GenerateBoundaryStencil(vtkIdType p1, vtkIdType p2,
                                vtkIdList *stencilIds, double *weights);
 
   int SetFixedCells(vtkPolyData *pd,int *noSubdivideCell);
@@ -42,7 +42,6 @@
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
-#include "vtkEdgeTable.h"
 #include "vtkErrorCode.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
@@ -50,6 +49,8 @@
 #include "vtkPolyData.h"
 
 #include "vtkSVGeneralUtils.h"
+#include "vtkSVHalfEdgeTable.h"
+#include "vtkSVSubdivisionStencils.h"
 #include "vtkSVGlobals.h"
 
 // ----------------------
@@ -63,6 +64,9 @@ vtkSVLocalInterpolatingSubdivisionFilter::vtkSVLocalInterpolatingSubdivisionFilt
   this->NumberOfSubdivisions = 1;
   this->UseCellArray = 0;
   this->UsePointArray = 0;
+
+  this->HalfEdges = vtkSVHalfEdgeTable::New();
+  this->EdgeStencils = vtkSVSubdivisionStencils::New();
 }
 
 // ----------------------
@@ -80,6 +84,16 @@ vtkSVLocalInterpolatingSubdivisionFilter::~vtkSVLocalInterpolatingSubdivisionFil
     delete [] this->SubdividePointArrayName;
     this->SubdividePointArrayName = NULL;
   }
+  if (this->HalfEdges != NULL)
+  {
+    this->HalfEdges->Delete();
+    this->HalfEdges = NULL;
+  }
+  if (this->EdgeStencils != NULL)
+  {
+    this->EdgeStencils->Delete();
+    this->EdgeStencils = NULL;
+  }
 }
 
 // ----------------------
@@ -194,8 +208,9 @@ int vtkSVLocalInterpolatingSubdivisionFilter::RequestData(
         return SV_ERROR;
       }
     }
-    // Generate topology  for the input dataset
-    inputDS->BuildLinks();
+    // Generate topology  for the input dataset. The half-edges are all the
+    // filters need, so no links or cells are built for the level.
+    this->HalfEdges->Build(inputDS);
     numCells = inputDS->GetNumberOfCells ();
 
     // Copy points from input. The new points will include the old points
@@ -206,7 +221,8 @@ int vtkSVLocalInterpolatingSubdivisionFilter::RequestData(
     // Copy pointdata structure from input
     outputPD = vtkPointData::New();
     outputPD->CopyAllocate(inputDS->GetPointData(),
-                           2*inputDS->GetNumberOfPoints());
+                           inputDS->GetNumberOfPoints() +
+                           this->HalfEdges->GetNumberOfEdges());
 
     // Copy celldata structure from input
     outputCD = vtkCellData::New();
@@ -243,8 +259,10 @@ int vtkSVLocalInterpolatingSubdivisionFilter::RequestData(
     inputDS->SetPolys(outputPolys); outputPolys->Delete();
     inputDS->GetPointData()->PassData(outputPD); outputPD->Delete();
     inputDS->GetCellData()->PassData(outputCD); outputCD->Delete();
-    inputDS->Squeeze();
     } // each level
+  this->HalfEdges->Reset();
+  this->EdgeStencils->Reset();
+  inputDS->Squeeze();
 
   output->SetPoints(inputDS->GetPoints());
   output->SetPolys(inputDS->GetPolys());
@@ -255,49 +273,6 @@ int vtkSVLocalInterpolatingSubdivisionFilter::RequestData(
   return SV_OK;
 }
 
-// ----------------------
-// FindEdge
-// ----------------------
-int vtkSVLocalInterpolatingSubdivisionFilter::FindEdge (vtkPolyData *mesh,
-                                                 vtkIdType cellId,
-                                                 vtkIdType p1, vtkIdType p2,
-                                                 vtkIntArray *edgeData,
-                                                 vtkIdList *cellIds)
-{
-  int edgeId = 0;
-  int currentCellId = 0;
-  int i;
-  int numEdges;
-  vtkIdType tp1, tp2;
-  vtkCell *cell;
-
-  // get all the cells that use the edge (except for cellId)
-  mesh->GetCellEdgeNeighbors (cellId, p1, p2, cellIds);
-
-  // find the edge that has the point we are looking for
-  for ( i=0; i < cellIds->GetNumberOfIds(); i++)
-    {
-    currentCellId = cellIds->GetId(i);
-    cell = mesh->GetCell(currentCellId);
-    numEdges = cell->GetNumberOfEdges();
-    tp1 = cell->GetPointId(2);
-    tp2 = cell->GetPointId(0);
-    for (edgeId=0; edgeId < numEdges; edgeId++)
-      {
-      if ( (tp1 == p1 && tp2 == p2) ||
-           (tp2 == p1 && tp1 == p2))
-        {
-        // found the edge, return the stored value
-        return (int) edgeData->GetComponent(currentCellId,edgeId);
-        }
-      tp1 = tp2;
-      tp2 = cell->GetPointId(edgeId + 1);
-      }
-    }
-  vtkErrorMacro("Edge should have been found... but couldn't find it!!");
-  return SV_ERROR;
-}
-
 // ----------------------
 // InterpolatePosition
 // ----------------------
@@ -330,7 +305,6 @@ vtkIdType vtkSVLocalInterpolatingSubdivisionFilter::InterpolatePosition (
 // ----------------------
 void vtkSVLocalInterpolatingSubdivisionFilter::GenerateSubdivisionCells (vtkPolyData *inputDS, vtkIntArray *edgeData, vtkCellArray *outputPolys, vtkCellData *outputCD)
 {
-  vtkIdType numCells = inputDS->GetNumberOfCells();
   vtkIdType cellId, newId;
   int id;
   vtkIdType npts;
@@ -338,16 +312,17 @@ void vtkSVLocalInterpolatingSubdivisionFilter::GenerateSubdivisionCells (vtkPoly
   double edgePts[3];
   vtkIdType newCellPts[3];
   vtkCellData *inputCD = inputDS->GetCellData();
+  vtkCellArray *inputPolys = inputDS->GetPolys();
 
   // Now create new cells from existing points and generated edge points
-  for (cellId=0; cellId < numCells; cellId++)
+  for (cellId=0, inputPolys->InitTraversal();
+       inputPolys->GetNextCell(npts, pts); cellId++)
     {
-    if ( inputDS->GetCellType(cellId) != VTK_TRIANGLE )
+    if (npts != 3)
       {
       continue;
       }
-    // get the original point ids and the ids stored as cell data
-    inputDS->GetCellPoints(cellId, npts, pts);
+    // the ids stored as cell data
     edgeData->GetTuple(cellId, edgePts);
     int newPtCount=0;
     for (int i=0;i<npts;i++)
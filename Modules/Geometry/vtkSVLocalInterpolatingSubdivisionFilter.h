@@ -46,6 +46,9 @@
 
 #include "vtkPolyDataAlgorithm.h"
 
+class vtkSVHalfEdgeTable;
+class vtkSVSubdivisionStencils;
+
 class VTKSVGEOMETRY_EXPORT vtkSVLocalInterpolatingSubdivisionFilter : public vtkPolyDataAlgorithm
 {
 public:
@@ -76,8 +79,6 @@ protected:
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) override;
   virtual int GenerateSubdivisionPoints (vtkPolyData *inputDS, vtkIntArray *edgeData, vtkPoints *outputPts, vtkPointData *outputPD) = 0;
   virtual void GenerateSubdivisionCells (vtkPolyData *inputDS, vtkIntArray *edgeData, vtkCellArray *outputPolys, vtkCellData *outputCD);
-  int FindEdge (vtkPolyData *mesh, vtkIdType cellId, vtkIdType p1,
-                vtkIdType p2, vtkIntArray *edgeData, vtkIdList *cellIds);
   vtkIdType InterpolatePosition (vtkPoints *inputPts, vtkPoints *outputPts,
                                  vtkIdList *stencil, double *weights);
 
@@ -92,6 +93,14 @@ protected:
 
   int NumberOfSubdivisions;
 
+  // Half-edges of the current level, built once before the points of the
+  // level are generated.
+  vtkSVHalfEdgeTable *HalfEdges;
+
+  // Stencils of the new edge points of the current level, evaluated together
+  // once all edges are visited.
+  vtkSVSubdivisionStencils *EdgeStencils;
+
 private:
   vtkSVLocalInterpolatingSubdivisionFilter(const vtkSVLocalInterpolatingSubdivisionFilter&);  // Not implemented.
   void operator=(const vtkSVLocalInterpolatingSubdivisionFilter&);  // Not implemented.
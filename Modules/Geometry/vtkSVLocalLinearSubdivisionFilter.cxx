@@ -32,13 +32,16 @@
 #include "vtkSVLocalLinearSubdivisionFilter.h"
 
 #include "vtkCellArray.h"
-#include "vtkEdgeTable.h"
 #include "vtkIdList.h"
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
 #include "vtkPointData.h"
 #include "vtkSmartPointer.h"
 #include "vtkSVGlobals.h"
+#include "vtkSVHalfEdgeTable.h"
+#include "vtkSVSubdivisionStencils.h"
+
+#include <vector>
 
 // ----------------------
 // StandardNewMacro
@@ -52,22 +55,26 @@ int vtkSVLocalLinearSubdivisionFilter::GenerateSubdivisionPoints (vtkPolyData *i
 {
   vtkIdType *pts = 0;
   int edgeId;
-  vtkIdType npts, cellId, newId;
-  vtkIdType p1, p2;
+  vtkIdType npts, cellId, newId, halfEdge, edge, neighborId;
+  vtkIdType p1, p2, ptIds[2];
   vtkCellArray *inputPolys=inputDS->GetPolys();
-  vtkEdgeTable *edgeTable;
-  vtkIdList *cellIds = vtkIdList::New();
-  vtkIdList *pointIds = vtkIdList::New();
+  vtkSVHalfEdgeTable *halfEdges = this->HalfEdges;
+  vtkSVSubdivisionStencils *edgeStencils = this->EdgeStencils;
   vtkPoints *inputPts=inputDS->GetPoints();
   vtkPointData *inputPD=inputDS->GetPointData();
+  vtkIdType numPts = inputDS->GetNumberOfPoints();
   static double weights[2] = {.5, .5};
-  vtkNew(vtkIdList, edgeNeighbor);
 
-  // Create an edge table to keep track of which edges we've processed
-  edgeTable = vtkEdgeTable::New();
-  edgeTable->InitEdgeInsertion(inputDS->GetNumberOfPoints());
+  // New point of each edge, -1 until it is created
+  std::vector<vtkIdType> edgePoints(halfEdges->GetNumberOfEdges(), -1);
+  edgeStencils->Allocate(halfEdges->GetNumberOfEdges(),
+                         2*halfEdges->GetNumberOfEdges());
 
-  pointIds->SetNumberOfIds(2);
+  // The old points keep their data
+  for (vtkIdType ptId=0; ptId < numPts; ptId++)
+    {
+    outputPD->CopyData (inputPD, ptId, ptId);
+    }
 
   int total = inputPolys->GetNumberOfCells();
   double curr = 0;
@@ -82,76 +89,52 @@ int vtkSVLocalLinearSubdivisionFilter::GenerateSubdivisionPoints (vtkPolyData *i
   for (cellId=0, inputPolys->InitTraversal();
        inputPolys->GetNextCell(npts, pts); cellId++)
     {
-    if ( inputDS->GetCellType(cellId) != VTK_TRIANGLE )
+    if (npts != 3)
       {
       continue;
       }
 
-    p1 = pts[2];
-    p2 = pts[0];
-
     for (edgeId=0; edgeId < 3; edgeId++)
       {
-      isLocalBoundary=0;
-      inputDS->GetCellEdgeNeighbors (cellId, p1, p2, edgeNeighbor);
-      if (edgeNeighbor->GetNumberOfIds() > 1)
+      halfEdge = vtkSVHalfEdgeTable::GetHalfEdge(cellId, edgeId);
+      edge = halfEdges->GetEdge(halfEdge);
+      p1 = halfEdges->GetOrigin(halfEdge);
+      p2 = halfEdges->GetTarget(halfEdge);
+
+      if (halfEdges->GetEdgeNumberOfCells(edge) > 2)
         {
         vtkErrorMacro ("Dataset is non-manifold and cannot be subdivided.");
         delete [] noSubdivideCell;
         return 0;
         }
-      if (noSubdivideCell[edgeNeighbor->GetId(0)] ||
+      isLocalBoundary = 0;
+      neighborId = halfEdges->GetNeighbor(halfEdge);
+      if ((neighborId != -1 && noSubdivideCell[neighborId]) ||
           noSubdivideCell[cellId])
         isLocalBoundary = 1;
 
-      outputPD->CopyData (inputPD, p1, p1);
-      outputPD->CopyData (inputPD, p2, p2);
-
-      // Do we need to  create a point on this edge?
-      if (edgeTable->IsEdge (p1, p2) == -1 && isLocalBoundary == 0)
-        {
-        edgeTable->InsertEdge (p1, p2);
-        // Compute Position andnew PointData using the same subdivision scheme
-        pointIds->SetId(0,p1);
-        pointIds->SetId(1,p2);
-        newId =
-          this->InterpolatePosition (inputPts, outputPts, pointIds, weights);
-        outputPD->InterpolatePoint (inputPD, newId, pointIds, weights);
-        }
-      else if (isLocalBoundary == 0) // we have already created a point on this edge. find it
-        {
-        newId = this->FindEdge (inputDS, cellId, p1, p2, edgeData, cellIds);
-        }
-      else
+      // Do we need to  create a point on this edge? Edges between
+      // subdivided and fixed cells do not get a point.
+      if (edgePoints[edge] == -1 && isLocalBoundary == 0)
         {
-        newId = -1;
-        if (edgeTable->IsEdge (p1, p2) == -1)
-          {
-          outputPD->CopyData (inputPD, p1, p1);
-          outputPD->CopyData (inputPD, p2, p2);
-          edgeTable->InsertEdge (p1, p2);
-          }
-        else
-          {
-          inputDS->GetCellEdgeNeighbors (-1, p1, p2, cellIds);
-          //newId = this->FindEdge (inputDS, cellId, p1, p2, edgeData, cellIds);
-          }
+        // The point is computed with the others once all stencils are known
+        ptIds[0] = p1;
+        ptIds[1] = p2;
+        edgePoints[edge] = numPts +
+          edgeStencils->InsertNextStencil (2, ptIds, weights);
         }
+      newId = edgePoints[edge];
       edgeData->InsertComponent(cellId,edgeId,newId);
-      p1 = p2;
-      if (edgeId < 2)
-        {
-        p2 = pts[edgeId + 1];
-        }
       } // each edge
     this->UpdateProgress(curr / total);
     curr += 1;
     } // each cell
 
+  // Compute Position andnew PointData using the same subdivision scheme
+  edgeStencils->EvaluatePoints (inputPts, outputPts, numPts);
+  edgeStencils->InterpolatePointData (inputPD, outputPD, numPts);
+
   delete [] noSubdivideCell;
-  edgeTable->Delete();
-  cellIds->Delete();
-  pointIds->Delete();
 
   return 1;
 }
@@ -171,14 +154,13 @@ int vtkSVLocalLinearSubdivisionFilter::SetFixedCells(vtkPolyData *pd, int *noSub
         noSubdivideCell[cellId] = 1;
     }
   }
-  int numPoints = pd->GetNumberOfPoints();
-  vtkIdType npts,*pts;
+  vtkIdType npts,*pts,cellId;
+  vtkCellArray *polys = pd->GetPolys();
   if (this->UsePointArray)
   {
-    for (vtkIdType cellId=0;cellId < numCells;cellId++)
+    for (cellId=0, polys->InitTraversal(); polys->GetNextCell(npts, pts); cellId++)
     {
       int fixedPts = 0;
-      pd->GetCellPoints(cellId,npts,pts);
       for (int i=0;i<npts;i++)
       {
         vtkIdType pointId= pts[i];
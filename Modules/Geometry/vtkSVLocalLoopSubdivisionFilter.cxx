@@ -47,7 +47,6 @@
 
 #include "vtkCell.h"
 #include "vtkCellArray.h"
-#include "vtkEdgeTable.h"
 #include "vtkErrorCode.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
@@ -60,6 +59,10 @@
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include "vtkSVGlobals.h"
+#include "vtkSVHalfEdgeTable.h"
+#include "vtkSVSubdivisionStencils.h"
+
+#include <vector>
 
 // ----------------------
 // StandardNewMacro
@@ -82,20 +85,22 @@ int vtkSVLocalLoopSubdivisionFilter::GenerateSubdivisionPoints (vtkPolyData *inp
   vtkIdType numPts, cellId, newId;
   int edgeId;
   vtkIdType npts;
-  vtkIdType p1, p2;
+  vtkIdType p1, p2, halfEdge, edge, neighborId;
   vtkCellArray *inputPolys=inputDS->GetPolys();
-  vtkNew(vtkIdList, cellIds);
+  vtkSVHalfEdgeTable *halfEdges = this->HalfEdges;
+  vtkSVSubdivisionStencils *vertexStencils = this->VertexStencils;
+  vtkSVSubdivisionStencils *edgeStencils = this->EdgeStencils;
   vtkNew(vtkIdList, stencil);
   vtkPoints *inputPts=inputDS->GetPoints();
   vtkPointData *inputPD=inputDS->GetPointData();
-  vtkNew(vtkIdList, edgeNeighbor);
-  vtkNew(vtkIdList, pointCells);
+  static double keepWeight[1] = {1.0};
 
   weights = new double[256];
 
-  // Create an edge table to keep track of which edges we've processed
-  vtkNew(vtkEdgeTable, edgeTable);
-  edgeTable->InitEdgeInsertion(inputDS->GetNumberOfPoints());
+  // New point of each edge, -1 until it is created
+  std::vector<vtkIdType> edgePoints(halfEdges->GetNumberOfEdges(), -1);
+  edgeStencils->Allocate(halfEdges->GetNumberOfEdges(),
+                         4*halfEdges->GetNumberOfEdges());
 
   int total = inputPolys->GetNumberOfCells();
   int *noSubdivideCell = new int[total];
@@ -105,69 +110,68 @@ int vtkSVLocalLoopSubdivisionFilter::GenerateSubdivisionPoints (vtkPolyData *inp
 
   // Generate even points. these are derived from the old points
   numPts = inputDS->GetNumberOfPoints();
+  vertexStencils->Allocate(numPts, 7*numPts);
   for (vtkIdType ptId=0; ptId < numPts; ptId++)
     {
-    inputDS->GetPointCells(ptId,pointCells);
+    vtkIdType numPointCells = halfEdges->GetPointNumberOfCells(ptId);
+    const vtkIdType *pointEdges = halfEdges->GetPointHalfEdges(ptId);
     int numSubCells=0;
-    for (int i=0;i<pointCells->GetNumberOfIds();i++)
+    for (int i=0;i<numPointCells;i++)
       {
-      if (noSubdivideCell[pointCells->GetId(i)] == 0)
+      if (noSubdivideCell[vtkSVHalfEdgeTable::GetCell(pointEdges[i])] == 0)
         {
         numSubCells++;
         }
       }
-    if (numSubCells == pointCells->GetNumberOfIds())
+    if (numSubCells == numPointCells)
       {
-      this->GenerateEvenStencil (ptId, inputDS, stencil, weights);
-      this->InterpolatePosition (inputPts, outputPts, stencil, weights);
-      outputPD->InterpolatePoint (inputPD, ptId, stencil, weights);
+      this->GenerateEvenStencil (ptId, stencil, weights);
+      vertexStencils->InsertNextStencil (stencil, weights);
       }
     else
       {
-      stencil->Reset();
-      stencil->InsertNextId(ptId);
-      this->KeepPosition(inputPts, outputPts, stencil, weights);
-      outputPD->CopyData (inputPD, ptId, ptId);
+      vertexStencils->InsertNextStencil (1, &ptId, keepWeight);
       }
+    // The old points keep their data
+    outputPD->CopyData (inputPD, ptId, ptId);
     }
+  vertexStencils->EvaluatePoints (inputPts, outputPts, 0);
 
   int isLocalBoundary = 0;
   // Generate odd points. These will be inserted into the new dataset
   for (cellId=0, inputPolys->InitTraversal();
        inputPolys->GetNextCell(npts, pts); cellId++)
     {
-    if ( inputDS->GetCellType(cellId) != VTK_TRIANGLE )
+    if (npts != 3)
       {
       continue;
       }
 
-    // start with one edge
-    p1 = pts[2];
-    p2 = pts[0];
-
     for (edgeId=0; edgeId < 3; edgeId++)
       {
-      isLocalBoundary = 0;
-      inputDS->GetCellEdgeNeighbors (cellId, p1, p2, edgeNeighbor);
-      if (edgeNeighbor->GetNumberOfIds() > 1)
+      halfEdge = vtkSVHalfEdgeTable::GetHalfEdge(cellId, edgeId);
+      edge = halfEdges->GetEdge(halfEdge);
+      p1 = halfEdges->GetOrigin(halfEdge);
+      p2 = halfEdges->GetTarget(halfEdge);
+
+      if (halfEdges->GetEdgeNumberOfCells(edge) > 2)
         {
         delete [] weights;
 	delete [] noSubdivideCell;
         vtkErrorMacro ("Dataset is non-manifold and cannot be subdivided.");
         return SV_ERROR;
         }
-      if (noSubdivideCell[edgeNeighbor->GetId(0)] ||
+      isLocalBoundary = 0;
+      neighborId = halfEdges->GetNeighbor(halfEdge);
+      if ((neighborId != -1 && noSubdivideCell[neighborId]) ||
 	  noSubdivideCell[cellId])
 	isLocalBoundary = 1;
 
-      outputPD->CopyData (inputPD, p1, p1);
-      outputPD->CopyData (inputPD, p2, p2);
-      // Do we need to  create a point on this edge?
-      if (edgeTable->IsEdge (p1, p2) == -1 && isLocalBoundary == 0)
+      // Do we need to  create a point on this edge? Edges between
+      // subdivided and fixed cells do not get a point.
+      if (edgePoints[edge] == -1 && isLocalBoundary == 0)
         {
-        edgeTable->InsertEdge (p1, p2);
-        inputDS->GetCellEdgeNeighbors (-1, p1, p2, cellIds);
-        if (cellIds->GetNumberOfIds() == 1)
+        if (halfEdges->GetEdgeNumberOfCells(edge) == 1)
           {
           // Compute new Position and PointData using the same subdivision scheme
           stencil->SetNumberOfIds(2);
@@ -175,53 +179,26 @@ int vtkSVLocalLoopSubdivisionFilter::GenerateSubdivisionPoints (vtkPolyData *inp
           stencil->SetId(1,p2);
           weights[0] = .5; weights[1] = .5;
           } // boundary edge
-        else if (cellIds->GetNumberOfIds() == 2)
-          {
-          this->GenerateOddStencil (p1, p2,
-                                    inputDS, stencil, weights);
-          }
         else
           {
-          delete [] weights;
-          vtkErrorMacro ("Dataset is non-manifold and cannot be subdivided.");
-          return SV_ERROR;
+          this->GenerateOddStencil (p1, p2, edge, stencil, weights);
           }
-        newId = this->InterpolatePosition (inputPts, outputPts,
-                                           stencil, weights);
-        outputPD->InterpolatePoint (inputPD, newId, stencil, weights);
-        }
-      else if (isLocalBoundary == 0) // we have already created a point on this edge. find it
-        {
-        newId = this->FindEdge (inputDS, cellId, p1, p2, edgeData, cellIds);
-        }
-      else // we have already created a point on this edge. find it
-        {
-	newId = -1;
-	//std::cout<<"How much is this actually happening"<<endl;
-	//This is a boundary between subdivision and no subdivision. We do not want to put a point here.
-	if (edgeTable->IsEdge (p1, p2) == -1)
-	  {
-	  outputPD->CopyData (inputPD, p1, p1);
-	  outputPD->CopyData (inputPD, p2, p2);
-	  edgeTable->InsertEdge (p1, p2);
-	  }
-	else
-	  {
-	  inputDS->GetCellEdgeNeighbors (-1, p1, p2, cellIds);
-	  //newId = this->FindEdge (inputDS, cellId, p1, p2, edgeData, cellIds);
-	  }
+        // The point is computed with the others once all stencils are known
+        edgePoints[edge] = numPts +
+          edgeStencils->InsertNextStencil (stencil, weights);
         }
+      newId = edgePoints[edge];
       edgeData->InsertComponent(cellId,edgeId,newId);
-      p1 = p2;
-      if (edgeId < 2)
-        {
-        p2 = pts[edgeId + 1];
-        }
       } // each interior edge
     } // each cell
 
+  // Compute new Position and PointData for all edges at once
+  edgeStencils->EvaluatePoints (inputPts, outputPts, numPts);
+  edgeStencils->InterpolatePointData (inputPD, outputPD, numPts);
+
   // cleanup
   delete [] weights;
+  delete [] noSubdivideCell;
   return SV_OK;
 }
 
@@ -229,15 +206,12 @@ int vtkSVLocalLoopSubdivisionFilter::GenerateSubdivisionPoints (vtkPolyData *inp
 // GenerateStencil
 // ----------------------
 void vtkSVLocalLoopSubdivisionFilter::GenerateEvenStencil (vtkIdType p1,
-                                                    vtkPolyData *polys,
                                                     vtkIdList *stencilIds,
                                                     double *weights)
 {
-  vtkIdList *cellIds = vtkIdList::New();
-  vtkIdList *ptIds = vtkIdList::New();
-  vtkCell *cell;
+  vtkSVHalfEdgeTable *halfEdges = this->HalfEdges;
+  vtkIdType halfEdge;
 
-  int i;
   vtkIdType j;
   vtkIdType startCell, nextCell;
   vtkIdType p, p2;
@@ -246,8 +220,7 @@ void vtkSVLocalLoopSubdivisionFilter::GenerateEvenStencil (vtkIdType p1,
   double beta, cosSQ;
 
   // Get the cells that use this point
-  polys->GetPointCells (p1, cellIds);
-  vtkIdType numCellsInLoop = cellIds->GetNumberOfIds();
+  vtkIdType numCellsInLoop = halfEdges->GetPointNumberOfCells(p1);
   if (numCellsInLoop < 1)
       {
       vtkWarningMacro("numCellsInLoop < 1: " << numCellsInLoop);
@@ -255,26 +228,14 @@ void vtkSVLocalLoopSubdivisionFilter::GenerateEvenStencil (vtkIdType p1,
       return;
       }
   // Find an edge to start with that contains p1
-  polys->GetCellPoints (cellIds->GetId(0), ptIds);
-  p2 = ptIds->GetId(0);
-  i = 1;
-  while (p1 == p2)
-    {
-    p2 = ptIds->GetId(i++);
-    }
-  polys->GetCellEdgeNeighbors (-1, p1, p2, cellIds);
+  halfEdge = halfEdges->GetPointHalfEdges(p1)[0];
+  p2 = halfEdges->GetTarget(halfEdge);
+  halfEdge = halfEdges->GetEdgeHalfEdge(halfEdges->GetEdge(halfEdge));
 
-  nextCell = cellIds->GetId(0);
+  nextCell = vtkSVHalfEdgeTable::GetCell(halfEdge);
   bp2 = -1;
   bp1 = p2;
-  if (cellIds->GetNumberOfIds() == 1)
-    {
-    startCell = -1;
-    }
-  else
-    {
-    startCell = cellIds->GetId(1);
-    }
+  startCell = halfEdges->GetNeighbor(halfEdge);
 
   stencilIds->Reset();
   stencilIds->InsertNextId(p2);
@@ -282,25 +243,17 @@ void vtkSVLocalLoopSubdivisionFilter::GenerateEvenStencil (vtkIdType p1,
   // walk around the loop counter-clockwise and get cells
   for (j = 0; j < numCellsInLoop; j++)
     {
-    cell = polys->GetCell(nextCell);
-    p = -1;
-    for (i = 0; i < 3; i++)
-      {
-      if ((p = cell->GetPointId(i)) != p1 && cell->GetPointId(i) != p2)
-        {
-        break;
-        }
-      }
+    p = halfEdges->GetApex(halfEdges->FindHalfEdge(nextCell, p1, p2));
     p2 = p;
     stencilIds->InsertNextId (p2);
-    polys->GetCellEdgeNeighbors (nextCell, p1, p2, cellIds);
-    if (cellIds->GetNumberOfIds() != 1)
+    halfEdge = halfEdges->FindHalfEdge(nextCell, p1, p2);
+    if (halfEdges->GetNeighbor(halfEdge) == -1)
       {
       bp2 = p2;
       j++;
       break;
       }
-    nextCell = cellIds->GetId(0);
+    nextCell = halfEdges->GetNeighbor(halfEdge);
     }
 
   // now walk around the other way. this will only happen if there
@@ -309,24 +262,16 @@ void vtkSVLocalLoopSubdivisionFilter::GenerateEvenStencil (vtkIdType p1,
   p2 = bp1;
   for (; j < numCellsInLoop && startCell != -1; j++)
     {
-    cell = polys->GetCell(nextCell);
-    p = -1;
-    for (i = 0; i < 3; i++)
-      {
-      if ((p = cell->GetPointId(i)) != p1 && cell->GetPointId(i) != p2)
-        {
-        break;
-        }
-      }
+    p = halfEdges->GetApex(halfEdges->FindHalfEdge(nextCell, p1, p2));
     p2 = p;
     stencilIds->InsertNextId (p2);
-    polys->GetCellEdgeNeighbors (nextCell, p1, p2, cellIds);
-    if (cellIds->GetNumberOfIds() != 1)
+    halfEdge = halfEdges->FindHalfEdge(nextCell, p1, p2);
+    if (halfEdges->GetNeighbor(halfEdge) == -1)
       {
       bp1 = p2;
       break;
       }
-    nextCell = cellIds->GetId(0);
+    nextCell = halfEdges->GetNeighbor(halfEdge);
     }
 
   if (bp2 != -1) // boundary edge
@@ -363,44 +308,25 @@ void vtkSVLocalLoopSubdivisionFilter::GenerateEvenStencil (vtkIdType p1,
     weights[K] = 1.0 - K * beta;
     stencilIds->SetId (K,p1);
     }
-  cellIds->Delete();
-  ptIds->Delete();
 }
 
 // ----------------------
 // GenerateOddStencil
 // ----------------------
 void vtkSVLocalLoopSubdivisionFilter::GenerateOddStencil (vtkIdType p1, vtkIdType p2,
-                                                   vtkPolyData *polys,
+                                                   vtkIdType edgeId,
                                                    vtkIdList *stencilIds,
                                                    double *weights)
 {
-  vtkIdList *cellIds = vtkIdList::New();
-  vtkCell *cell;
+  vtkSVHalfEdgeTable *halfEdges = this->HalfEdges;
   int i;
-  vtkIdType cell0, cell1;
-  vtkIdType p3=0, p4=0;
-
-  polys->GetCellEdgeNeighbors (-1, p1, p2, cellIds);
-  cell0 = cellIds->GetId(0);
-  cell1 = cellIds->GetId(1);
+  vtkIdType halfEdge;
+  vtkIdType p3, p4;
 
-  cell = polys->GetCell(cell0);
-  for (i = 0; i < 3; i++)
-    {
-    if ((p3 = cell->GetPointId(i)) != p1 && cell->GetPointId(i) != p2)
-      {
-      break;
-      }
-    }
-  cell = polys->GetCell(cell1);
-  for (i = 0; i < 3; i++)
-    {
-    if ((p4 = cell->GetPointId(i)) != p1 && cell->GetPointId(i) != p2)
-      {
-      break;
-      }
-    }
+  // the points opposite to the edge in its two cells
+  halfEdge = halfEdges->GetEdgeHalfEdge(edgeId);
+  p3 = halfEdges->GetApex(halfEdge);
+  p4 = halfEdges->GetApex(halfEdges->GetOpposite(halfEdge));
 
   stencilIds->SetNumberOfIds (4);
   stencilIds->SetId(0, p1);
@@ -412,7 +338,6 @@ void vtkSVLocalLoopSubdivisionFilter::GenerateOddStencil (vtkIdType p1, vtkIdTyp
     {
     weights[i] = LoopWeights[i];
     }
-  cellIds->Delete();
 }
 
 // ----------------------
@@ -503,14 +428,13 @@ int vtkSVLocalLoopSubdivisionFilter::SetFixedCells(vtkPolyData *pd, int *noSubdi
 	noSubdivideCell[cellId] = 1;
     }
   }
-  int numPoints = pd->GetNumberOfPoints();
-  vtkIdType npts,*pts;
+  vtkIdType npts,*pts,cellId;
+  vtkCellArray *polys = pd->GetPolys();
   if (this->UsePointArray)
   {
-    for (vtkIdType cellId=0;cellId < numCells;cellId++)
+    for (cellId=0, polys->InitTraversal(); polys->GetNextCell(npts, pts); cellId++)
     {
       int fixedPts = 0;
-      pd->GetCellPoints(cellId,npts,pts);
       for (int i=0;i<npts;i++)
       {
 	vtkIdType pointId= pts[i];
@@ -87,9 +87,9 @@ protected:
   int GenerateSubdivisionPoints (vtkPolyData *inputDS, vtkIntArray *edgeData,
                                  vtkPoints *outputPts,
                                  vtkPointData *outputPD) override;
-  void GenerateEvenStencil (vtkIdType p1, vtkPolyData *polys,
-                            vtkIdList *stencilIds, double *weights);
-  void GenerateOddStencil (vtkIdType p1, vtkIdType p2, vtkPolyData *polys,
+  void GenerateEvenStencil (vtkIdType p1, vtkIdList *stencilIds,
+                            double *weights);
+  void GenerateOddStencil (vtkIdType p1, vtkIdType p2, vtkIdType edgeId,
                            vtkIdList *stencilIds, double *weights);
 
   int SetFixedCells(vtkPolyData *pd,int *noSubdivideCell);
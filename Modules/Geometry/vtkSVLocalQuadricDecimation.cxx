@@ -32,21 +32,57 @@
 #include "vtkSVLocalQuadricDecimation.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
-#include "vtkEdgeTable.h"
 #include "vtkDoubleArray.h"
 #include "vtkGenericCell.h"
 #include "vtkIdList.h"
 #include "vtkMath.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkIntArray.h"
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
 #include "vtkPointData.h"
-#include "vtkPriorityQueue.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkTriangle.h"
 #include "vtkSmartPointer.h"
 #include "vtkSVGeneralUtils.h"
 #include "vtkSVGlobals.h"
+#include "vtkSVIndexedHeap.h"
+#include "vtkSVQuadricKernels.h"
+
+#include <algorithm>
+
+namespace
+{
+// ----------------------
+// IsCheaperEdge
+// ----------------------
+/* Order of the edges by cost then id, -1 is no edge and comes last. */
+inline bool IsCheaperEdge(const double *costs, const vtkIdType edge0,
+                          const vtkIdType edge1)
+{
+  if (edge0 < 0)
+    return false;
+  if (edge1 < 0)
+    return true;
+  return costs[edge0] < costs[edge1] ||
+         (costs[edge0] == costs[edge1] && edge0 < edge1);
+}
+
+// ----------------------
+// EdgeCostLess
+// ----------------------
+/* Sorts edge ids cheapest first. */
+struct EdgeCostLess
+{
+  const double *Costs;
+  bool operator()(const vtkIdType edge0, const vtkIdType edge1) const
+  {
+    return IsCheaperEdge(this->Costs, edge0, edge1);
+  }
+};
+}
 
 // ----------------------
 // StandardNewMacro
@@ -59,12 +95,8 @@ vtkStandardNewMacro(vtkSVLocalQuadricDecimation);
 // ----------------------
 vtkSVLocalQuadricDecimation::vtkSVLocalQuadricDecimation()
 {
-  this->Edges = vtkEdgeTable::New();
-  this->EdgeCosts = vtkPriorityQueue::New();
-  this->EndPoint1List = vtkIdList::New();
-  this->EndPoint2List = vtkIdList::New();
+  this->EdgeCosts = vtkSVIndexedHeap::New();
   this->ErrorQuadrics = NULL;
-  this->TargetPoints = vtkDoubleArray::New();
 //  this->DecimateCellArray = vtkIntArray::New();
 //  this->DecimatePointArray = vtkIntArray::New();
 
@@ -92,6 +124,7 @@ vtkSVLocalQuadricDecimation::vtkSVLocalQuadricDecimation()
 
   this->UseCellArray = 0;
   this->UsePointArray = 0;
+  this->UseParallelDecimation = 0;
 
   this->changedPoint = NULL;
 }
@@ -101,11 +134,7 @@ vtkSVLocalQuadricDecimation::vtkSVLocalQuadricDecimation()
 // ----------------------
 vtkSVLocalQuadricDecimation::~vtkSVLocalQuadricDecimation()
 {
-  this->Edges->Delete();
   this->EdgeCosts->Delete();
-  this->EndPoint1List->Delete();
-  this->EndPoint2List->Delete();
-  this->TargetPoints->Delete();
 
   if (this->DecimateCellArrayName != NULL)
   {
@@ -218,7 +247,7 @@ int vtkSVLocalQuadricDecimation::RequestData(
   vtkIdType numTris = input->GetNumberOfPolys();
   vtkIdType edgeId, i;
   int j;
-  double cost;
+  double cost = VTK_DOUBLE_MAX;
   double *x;
   vtkCellArray *polys;
   vtkDataArray *attrib;
@@ -310,8 +339,12 @@ int vtkSVLocalQuadricDecimation::RequestData(
     new vtkSVLocalQuadricDecimation::ErrorQuadric[numPts];
 
   vtkDebugMacro(<<"Computing Edges");
-  this->Edges->InitEdgeInsertion(numPts, 1); // storing edge id as attribute
-  this->EdgeCosts->Allocate(this->Mesh->GetPolys()->GetNumberOfCells() * 3);
+  this->EdgeEndPoint1.clear();
+  this->EdgeEndPoint2.clear();
+  this->EdgeEndPoint1.reserve(numTris * 3 / 2);
+  this->EdgeEndPoint2.reserve(numTris * 3 / 2);
+  this->PointEdges.assign(numPts, std::vector<vtkIdType>());
+  this->EdgeCosts->Allocate(numTris * 3 / 2);
   for (i = 0; i <  this->Mesh->GetNumberOfCells(); i++)
     {
     this->Mesh->GetCellPoints(i, npts, pts);
@@ -325,15 +358,11 @@ int vtkSVLocalQuadricDecimation::RequestData(
 
       if (useEdge)
       {
-        if (this->Edges->IsEdge(pts[j], pts[(j+1)%3]) == -1)
+        if (this->FindEdge(pts[j], pts[(j+1)%3]) == -1)
           {
-	  // If this edge has not been processed, get an id for it, add it to
-	  // the edge list (Edges), and add its endpoints to the EndPoint1List
-	  // and EndPoint2List (the 2 endpoints to different lists).
-	  edgeId = this->Edges->GetNumberOfEdges();
-	  this->Edges->InsertEdge(pts[j], pts[(j+1)%3], edgeId);
-	  this->EndPoint1List->InsertId(edgeId, pts[j]);
-	  this->EndPoint2List->InsertId(edgeId, pts[(j+1)%3]);
+	  // If this edge has not been processed, give it the next id and add
+	  // it to the edges of both of its points.
+	  this->InsertEdge(pts[j], pts[(j+1)%3]);
           }
         }
       }
@@ -349,89 +378,81 @@ int vtkSVLocalQuadricDecimation::RequestData(
   x = new double [3+this->NumberOfComponents];
   this->CollapseCellIds = vtkIdList::New();
   this->TempX = new double [3+this->NumberOfComponents];
-  this->TempQuad = new double[11 + 4 * this->NumberOfComponents];
+  this->AllocateWorkspace(this->Workspace);
 
-  this->TempB = new double [3 +  this->NumberOfComponents];
-  this->TempA = new double*[3 +  this->NumberOfComponents];
-  this->TempData = new double [(3 +  this->NumberOfComponents)*(3 +  this->NumberOfComponents)];
-  for (i = 0; i < 3 +  this->NumberOfComponents; i++)
-    {
-    this->TempA[i] = this->TempData+i*(3 +  this->NumberOfComponents);
-    }
-  this->TargetPoints->SetNumberOfComponents(3+this->NumberOfComponents);
+  this->EdgeTargets.resize(this->EdgeEndPoint1.size()*(3+this->NumberOfComponents));
 
   vtkDebugMacro(<<"Computing Quadrics");
   this->InitializeQuadrics(numPts);
   this->AddBoundaryConstraints();
   this->UpdateProgress(0.15);
 
-  vtkDebugMacro(<<"Computing Costs");
-  // Compute the cost of and target point for collapsing each edge.
-  for (i = 0; i < this->Edges->GetNumberOfEdges(); i++)
-    {
-    if (this->AttributeErrorMetric)
-      {
-      cost = this->ComputeCost2(i, x);
-      }
-    else
-      {
-      cost = this->ComputeCost(i, x);
-      }
-    this->EdgeCosts->Insert(cost, i);
-    this->TargetPoints->InsertTuple(i, x);
-    }
-  this->UpdateProgress(0.20);
-
-  // Okay collapse edges until desired reduction is reached
   this->ActualReduction = 0.0;
   this->NumberOfEdgeCollapses = 0;
-  edgeId = this->EdgeCosts->Pop(0,cost);
-
-  int abort = 0;
-  while ( !abort && edgeId >= 0 && cost < VTK_DOUBLE_MAX &&
-         this->ActualReduction < this->TargetReduction )
+  if (this->UseParallelDecimation)
     {
-
-    if ( ! (this->NumberOfEdgeCollapses % 10000) )
+    numDeletedTris = this->CollapseInRounds(numTris);
+    }
+  else
+    {
+    vtkDebugMacro(<<"Computing Costs");
+    // Compute the cost of and target point for collapsing each edge.
+    for (i = 0; i < static_cast<vtkIdType>(this->EdgeEndPoint1.size()); i++)
       {
-      vtkDebugMacro(<<"Collapsing edge#" << this->NumberOfEdgeCollapses);
-      this->UpdateProgress (0.20 + 0.80*this->NumberOfEdgeCollapses/numPts);
-      abort = this->GetAbortExecute();
+      this->UpdateEdgeCost(i);
       }
+    this->UpdateProgress(0.20);
 
-    endPtIds[0] = this->EndPoint1List->GetId(edgeId);
-    endPtIds[1] = this->EndPoint2List->GetId(edgeId);
-    this->TargetPoints->GetTuple(edgeId, x);
+    // Okay collapse edges until desired reduction is reached
+    edgeId = this->EdgeCosts->Pop(cost);
 
-    // check for a poorly placed point
-    if ( !this->IsGoodPlacement(endPtIds[0], endPtIds[1], x))
+    int abort = 0;
+    while ( !abort && edgeId >= 0 && cost < VTK_DOUBLE_MAX &&
+           this->ActualReduction < this->TargetReduction )
       {
-      vtkDebugMacro(<<"Poor placement detected " << edgeId << " " <<  cost);
-      // return the point to the queue but with the max cost so that
-      // when it is recomputed it will be reconsidered
-      this->EdgeCosts->Insert(VTK_DOUBLE_MAX, edgeId);
 
-      edgeId = this->EdgeCosts->Pop(0, cost);
-      continue;
-      }
+      if ( ! (this->NumberOfEdgeCollapses % 10000) )
+        {
+        vtkDebugMacro(<<"Collapsing edge#" << this->NumberOfEdgeCollapses);
+        this->UpdateProgress (0.20 + 0.80*this->NumberOfEdgeCollapses/numPts);
+        abort = this->GetAbortExecute();
+        }
 
-    this->NumberOfEdgeCollapses++;
+      endPtIds[0] = this->EdgeEndPoint1[edgeId];
+      endPtIds[1] = this->EdgeEndPoint2[edgeId];
+      std::copy(&this->EdgeTargets[edgeId*(3+this->NumberOfComponents)],
+                &this->EdgeTargets[(edgeId+1)*(3+this->NumberOfComponents)], x);
 
-    // Set the new coordinates of point0.
-    this->SetPointAttributeArray(endPtIds[0], x);
-    vtkDebugMacro(<<"Cost: " << cost << " Edge: "
-                  << endPtIds[0] << " " << endPtIds[1]);
+      // check for a poorly placed point
+      if ( !this->IsGoodPlacement(endPtIds[0], endPtIds[1], x))
+        {
+        vtkDebugMacro(<<"Poor placement detected " << edgeId << " " <<  cost);
+        // return the point to the queue but with the max cost so that
+        // when it is recomputed it will be reconsidered
+        this->EdgeCosts->Insert(VTK_DOUBLE_MAX, edgeId);
+
+        edgeId = this->EdgeCosts->Pop(cost);
+        continue;
+        }
+
+      this->NumberOfEdgeCollapses++;
+
+      // Set the new coordinates of point0.
+      this->SetPointAttributeArray(endPtIds[0], x);
+      vtkDebugMacro(<<"Cost: " << cost << " Edge: "
+                    << endPtIds[0] << " " << endPtIds[1]);
 
-    // Merge the quadrics of the two points.
-    this->AddQuadric(endPtIds[1], endPtIds[0]);
+      // Merge the quadrics of the two points.
+      this->AddQuadric(endPtIds[1], endPtIds[0]);
 
-    this->UpdateEdgeData(endPtIds[0], endPtIds[1]);
+      this->UpdateEdgeData(endPtIds[0], endPtIds[1]);
 
-    // Update the output triangles.
-    vtkIdType tmpNum = this->CollapseEdge(endPtIds[0], endPtIds[1]);
-    numDeletedTris += tmpNum;
-    this->ActualReduction = (double) numDeletedTris / numTris;
-    edgeId = this->EdgeCosts->Pop(0, cost);
+      // Update the output triangles.
+      vtkIdType tmpNum = this->CollapseEdge(endPtIds[0], endPtIds[1]);
+      numDeletedTris += tmpNum;
+      this->ActualReduction = (double) numDeletedTris / numTris;
+      edgeId = this->EdgeCosts->Pop(cost);
+      }
     }
 
   vtkDebugMacro(<<"Number Of Edge Collapses: "
@@ -446,10 +467,14 @@ int vtkSVLocalQuadricDecimation::RequestData(
   delete [] x;
   this->CollapseCellIds->Delete();
   delete [] this->TempX;
-  delete [] this->TempQuad;
-  delete [] this->TempB;
-  delete [] this->TempA;
-  delete [] this->TempData;
+  this->EdgeCosts->Reset();
+  std::vector<vtkIdType>().swap(this->EdgeEndPoint1);
+  std::vector<vtkIdType>().swap(this->EdgeEndPoint2);
+  std::vector<double>().swap(this->EdgeTargets);
+  std::vector<std::vector<vtkIdType> >().swap(this->PointEdges);
+  std::vector<double>().swap(this->EdgeCostValues);
+  std::vector<unsigned char>().swap(this->EdgeDirty);
+  std::vector<vtkIdType>().swap(this->DirtyEdges);
 
   // copy the simplified mesh from the working mesh to the output mesh
   for (i = 0; i < this->Mesh->GetNumberOfCells(); i++)
@@ -506,13 +531,8 @@ void vtkSVLocalQuadricDecimation::InitializeQuadrics(vtkIdType numPts)
   double point0[3], point1[3], point2[3];
   double n[3];
   double tempP1[3], tempP2[3],  d, triArea2;
-  double data[16];
-  double *A[4], x[4];
+  double A[4][4], x[4];
   int index[4];
-  A[0] = data;
-  A[1] = data+4;
-  A[2] = data+8;
-  A[3] = data+12;
 
   // allocate local QEM sparce matrix
   QEM = new double[11 + 4 * this->NumberOfComponents];
@@ -577,7 +597,7 @@ void vtkSVLocalQuadricDecimation::InitializeQuadrics(vtkIdType numPts)
       A[3][3] = 0;
 
       // should handle poorly condition matrix better
-      if (vtkMath::LUFactorLinearSystem(A, index, 4))
+      if (vtkSVQuadricKernels::LUFactor4x4(A, index))
         {
         for (i = 0; i < this->NumberOfComponents; i++)
           {
@@ -612,7 +632,7 @@ void vtkSVLocalQuadricDecimation::InitializeQuadrics(vtkIdType numPts)
             x[1] = input->GetPointData()->GetTensors()->GetComponent(pts[1], i - this->AttributeComponents[3])*  this->AttributeScale[4];
             x[2] = input->GetPointData()->GetTensors()->GetComponent(pts[2], i - this->AttributeComponents[3])*  this->AttributeScale[4];
             }
-          vtkMath::LUSolveLinearSystem(A, index, x, 4);
+          vtkSVQuadricKernels::LUSolve4x4(A, index, x);
 
           // add in the contribution of this element into the QEM
           QEM[0] += x[0] * x[0];
@@ -642,11 +662,13 @@ void vtkSVLocalQuadricDecimation::InitializeQuadrics(vtkIdType numPts)
       }
 
       // add the QEM to all point of the face
+    int quadSize = vtkSVQuadricKernels::GetQuadricSize(this->NumberOfComponents);
     for (i = 0; i < 3; i++)
       {
-      for (j = 0; j < 11 + 4 * this->NumberOfComponents; j++)
+      double *quad = this->ErrorQuadrics[pts[i]].Quadric;
+      for (j = 0; j < quadSize; j++)
         {
-        this->ErrorQuadrics[pts[i]].Quadric[j] += QEM[j] * triArea2;
+        quad[j] += QEM[j] * triArea2;
         }
       }
     }//for all triangles
@@ -747,13 +769,10 @@ void vtkSVLocalQuadricDecimation::AddBoundaryConstraints(void)
 // ----------------------
 void vtkSVLocalQuadricDecimation::AddQuadric(vtkIdType oldPtId, vtkIdType newPtId)
 {
-  int i;
-
-  for (i = 0; i < 11 + 4*this->NumberOfComponents; i++)
-    {
-    this->ErrorQuadrics[newPtId].Quadric[i] +=
-      this->ErrorQuadrics[oldPtId].Quadric[i];
-    }
+  double *newQuad = this->ErrorQuadrics[newPtId].Quadric;
+  vtkSVQuadricKernels::Add(newQuad, this->ErrorQuadrics[oldPtId].Quadric,
+                           newQuad,
+                           vtkSVQuadricKernels::GetQuadricSize(this->NumberOfComponents));
 }
 
 // ----------------------
@@ -774,7 +793,7 @@ void vtkSVLocalQuadricDecimation::FindAffectedEdges(vtkIdType p1Id, vtkIdType p2
     for (j = 0; j < 3; j++)
       {
       if (pts[j] != p1Id && pts[j] != p2Id &&
-          (edgeId = this->Edges->IsEdge(pts[j], p2Id)) >= 0 &&
+          (edgeId = this->FindEdge(pts[j], p2Id)) >= 0 &&
           edges->IsId(edgeId) == -1)
         {
         edges->InsertNextId(edgeId);
@@ -789,7 +808,7 @@ void vtkSVLocalQuadricDecimation::FindAffectedEdges(vtkIdType p1Id, vtkIdType p2
     for (j = 0; j < 3; j++)
       {
       if (pts[j] != p1Id && pts[j] != p2Id &&
-          (edgeId = this->Edges->IsEdge(pts[j], p1Id)) >= 0 &&
+          (edgeId = this->FindEdge(pts[j], p1Id)) >= 0 &&
           edges->IsId(edgeId) == -1)
         {
         edges->InsertNextId(edgeId);
@@ -805,120 +824,549 @@ void vtkSVLocalQuadricDecimation::UpdateEdgeData(vtkIdType pt0Id, vtkIdType pt1I
 {
   vtkIdList *changedEdges = vtkIdList::New();
   vtkIdType i, edgeId, edge[2];
-  double cost;
 
   // Find all edges with exactly either of these 2 endpoints.
   this->FindAffectedEdges(pt0Id, pt1Id, changedEdges);
 
   // Reset the endpoints for these edges to reflect the new point from the
   // collapsed edge.
-  // Add these new edges to the edge table.
-  // Remove the the changed edges from the priority queue.
+  // Add these new edges to the edge arrays and remove the old ones from
+  // the edges of their points.
+  // Edges that keep their points get a new cost in place in the queue.
   for (i = 0; i < changedEdges->GetNumberOfIds(); i++)
     {
-    edge[0] = this->EndPoint1List->GetId(changedEdges->GetId(i));
-    edge[1] = this->EndPoint2List->GetId(changedEdges->GetId(i));
-
-    // Remove all affected edges from the priority queue.
-    // This does not include collapsed edge.
-    this->EdgeCosts->DeleteId(changedEdges->GetId(i));
+    vtkIdType changedId = changedEdges->GetId(i);
+    edge[0] = this->EdgeEndPoint1[changedId];
+    edge[1] = this->EdgeEndPoint2[changedId];
 
     // Determine the new set of edges
-    if (edge[0] == pt1Id)
+    if (edge[0] == pt1Id || edge[1] == pt1Id)
       {
-      if (this->Edges->IsEdge(edge[1], pt0Id) == -1)
+      // Remove the edge to the removed point from the queue.
+      vtkIdType otherId = edge[0] == pt1Id ? edge[1] : edge[0];
+      this->EdgeCosts->DeleteId(changedId);
+      this->RemovePointEdge(otherId, changedId);
+      if (this->FindEdge(otherId, pt0Id) == -1)
         { // The edge will be completely new, add it.
-        edgeId = this->Edges->GetNumberOfEdges();
-        this->Edges->InsertEdge(edge[1], pt0Id, edgeId);
-        this->EndPoint1List->InsertId(edgeId, edge[1]);
-        this->EndPoint2List->InsertId(edgeId, pt0Id);
+        edgeId = this->InsertEdge(otherId, pt0Id);
+        this->EdgeTargets.resize(this->EdgeEndPoint1.size()*(3+this->NumberOfComponents));
         // Compute cost (target point/data) and add to priority cue.
-        if (this->AttributeErrorMetric)
+        this->UpdateEdgeCost(edgeId);
+        }
+      }
+    else
+      { // This edge already has one point as the merged point.
+      this->UpdateEdgeCost(changedId);
+      }
+    }
+
+  // The collapsed edge and the removed point are gone
+  if ((edgeId = this->FindEdge(pt0Id, pt1Id)) >= 0)
+    {
+    this->RemovePointEdge(pt0Id, edgeId);
+    }
+  std::vector<vtkIdType>().swap(this->PointEdges[pt1Id]);
+
+  changedEdges->Delete();
+  return;
+}
+
+// ----------------------
+// FindEdge
+// ----------------------
+vtkIdType vtkSVLocalQuadricDecimation::FindEdge(vtkIdType p1Id, vtkIdType p2Id)
+{
+  if (this->PointEdges[p1Id].size() > this->PointEdges[p2Id].size())
+    {
+    std::swap(p1Id, p2Id);
+    }
+
+  const std::vector<vtkIdType> &edges = this->PointEdges[p1Id];
+  for (size_t i = 0; i < edges.size(); i++)
+    {
+    if (this->EdgeEndPoint1[edges[i]] == p2Id ||
+        this->EdgeEndPoint2[edges[i]] == p2Id)
+      {
+      return edges[i];
+      }
+    }
+  return -1;
+}
+
+// ----------------------
+// InsertEdge
+// ----------------------
+vtkIdType vtkSVLocalQuadricDecimation::InsertEdge(vtkIdType p1Id, vtkIdType p2Id)
+{
+  vtkIdType edgeId = this->EdgeEndPoint1.size();
+  this->EdgeEndPoint1.push_back(p1Id);
+  this->EdgeEndPoint2.push_back(p2Id);
+  this->PointEdges[p1Id].push_back(edgeId);
+  this->PointEdges[p2Id].push_back(edgeId);
+  return edgeId;
+}
+
+// ----------------------
+// RemovePointEdge
+// ----------------------
+void vtkSVLocalQuadricDecimation::RemovePointEdge(vtkIdType ptId, vtkIdType edgeId)
+{
+  std::vector<vtkIdType> &edges = this->PointEdges[ptId];
+  std::vector<vtkIdType>::iterator it = std::find(edges.begin(), edges.end(), edgeId);
+  if (it != edges.end())
+    {
+    *it = edges.back();
+    edges.pop_back();
+    }
+}
+
+// ----------------------
+// AllocateWorkspace
+// ----------------------
+void vtkSVLocalQuadricDecimation::AllocateWorkspace(CostWorkspace &workspace)
+{
+  int size = 3 + this->NumberOfComponents;
+  workspace.Quad.resize(vtkSVQuadricKernels::GetQuadricSize(this->NumberOfComponents));
+  workspace.B.resize(size);
+  workspace.A.resize(size*size);
+  workspace.Factor.resize(size*size);
+}
+
+// ----------------------
+// UpdateEdgeCost
+// ----------------------
+void vtkSVLocalQuadricDecimation::UpdateEdgeCost(vtkIdType edgeId)
+{
+  double cost;
+  if (this->UseParallelDecimation)
+    {
+    if (edgeId >= static_cast<vtkIdType>(this->EdgeDirty.size()))
+      {
+      this->EdgeDirty.resize(edgeId+1, 0);
+      this->EdgeCostValues.resize(edgeId+1, VTK_DOUBLE_MAX);
+      }
+    if (!this->EdgeDirty[edgeId])
+      {
+      this->EdgeDirty[edgeId] = 1;
+      this->DirtyEdges.push_back(edgeId);
+      }
+    return;
+    }
+
+  if (this->AttributeErrorMetric)
+    {
+    cost = this->ComputeCost2(edgeId, this->TempX, this->Workspace);
+    }
+  else
+    {
+    cost = this->ComputeCost(edgeId, this->TempX, this->Workspace);
+    }
+  this->EdgeCosts->Insert(cost, edgeId);
+  std::copy(this->TempX, this->TempX+3+this->NumberOfComponents,
+            &this->EdgeTargets[edgeId*(3+this->NumberOfComponents)]);
+}
+
+// ----------------------
+// RoundCosts
+// ----------------------
+/* Computes the cost and target of the listed edges, each thread with its
+ * own workspace. */
+class vtkSVLocalQuadricDecimation::RoundCosts
+{
+public:
+  vtkSVLocalQuadricDecimation *Filter;
+  const vtkIdType *EdgeIds;
+  vtkSMPThreadLocal<vtkSVLocalQuadricDecimation::CostWorkspace> Workspaces;
+  vtkSMPThreadLocal<std::vector<double> > Targets;
+
+  void Initialize()
+  {
+    this->Filter->AllocateWorkspace(this->Workspaces.Local());
+    this->Targets.Local().resize(3+this->Filter->NumberOfComponents);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkSVLocalQuadricDecimation::CostWorkspace &workspace =
+      this->Workspaces.Local();
+    double *x = &this->Targets.Local()[0];
+    int size = 3+this->Filter->NumberOfComponents;
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      vtkIdType edgeId = this->EdgeIds[i];
+      if (this->Filter->AttributeErrorMetric)
+        {
+        this->Filter->EdgeCostValues[edgeId] =
+          this->Filter->ComputeCost2(edgeId, x, workspace);
+        }
+      else
+        {
+        this->Filter->EdgeCostValues[edgeId] =
+          this->Filter->ComputeCost(edgeId, x, workspace);
+        }
+      std::copy(x, x+size, &this->Filter->EdgeTargets[edgeId*size]);
+      }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+// ----------------------
+// RoundMinima
+// ----------------------
+/* For each point, the cheapest candidate edge that uses it (stage 0) or
+ * that uses a point of its one ring (stage 1). The second is the cheapest
+ * candidate whose one ring holds the point. */
+class vtkSVLocalQuadricDecimation::RoundMinima
+{
+public:
+  vtkSVLocalQuadricDecimation *Filter;
+  const unsigned char *Candidate;
+  vtkIdType *PointMinimum;
+  vtkIdType *RingMinimum;
+  int Stage;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const double *costs = &this->Filter->EdgeCostValues[0];
+    for (vtkIdType ptId = begin; ptId < end; ptId++)
+      {
+      const std::vector<vtkIdType> &edges = this->Filter->PointEdges[ptId];
+      if (this->Stage == 0)
+        {
+        vtkIdType best = -1;
+        for (size_t i = 0; i < edges.size(); i++)
           {
-          cost = this->ComputeCost2(edgeId, this->TempX);
+          if (this->Candidate[edges[i]] &&
+              IsCheaperEdge(costs, edges[i], best))
+            {
+            best = edges[i];
+            }
           }
-        else
+        this->PointMinimum[ptId] = best;
+        }
+      else
+        {
+        vtkIdType best = this->PointMinimum[ptId];
+        for (size_t i = 0; i < edges.size(); i++)
           {
-          cost = this->ComputeCost(edgeId, this->TempX);
+          vtkIdType otherId = this->Filter->EdgeEndPoint1[edges[i]];
+          if (otherId == ptId)
+            {
+            otherId = this->Filter->EdgeEndPoint2[edges[i]];
+            }
+          if (IsCheaperEdge(costs, this->PointMinimum[otherId], best))
+            {
+            best = this->PointMinimum[otherId];
+            }
           }
-        this->EdgeCosts->Insert(cost, edgeId);
-        this->TargetPoints->InsertTuple(edgeId, this->TempX);
+        this->RingMinimum[ptId] = best;
         }
       }
-    else if (edge[1] == pt1Id)
-      { // The edge will be completely new, add it.
-      if (this->Edges->IsEdge(edge[0], pt0Id) == -1)
+  }
+};
+
+// ----------------------
+// RoundSelection
+// ----------------------
+/* Picks the candidates that are the cheapest for every point of their one
+ * ring. Candidates with a point of their one ring used by an edge picked
+ * before are dropped. */
+class vtkSVLocalQuadricDecimation::RoundSelection
+{
+public:
+  vtkSVLocalQuadricDecimation *Filter;
+  const vtkIdType *Candidates;
+  unsigned char *Candidate;
+  unsigned char *Chosen;
+  const unsigned char *Blocked;
+  const vtkIdType *RingMinimum;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      vtkIdType edgeId = this->Candidates[i];
+      vtkIdType ends[2];
+      ends[0] = this->Filter->EdgeEndPoint1[edgeId];
+      ends[1] = this->Filter->EdgeEndPoint2[edgeId];
+
+      int blocked = 0, cheapest = 1;
+      for (int j = 0; j < 2; j++)
         {
-        edgeId = this->Edges->GetNumberOfEdges();
-        this->Edges->InsertEdge(edge[0], pt0Id, edgeId);
-        this->EndPoint1List->InsertId(edgeId, edge[0]);
-        this->EndPoint2List->InsertId(edgeId, pt0Id);
-        // Compute cost (target point/data) and add to priority cue.
-        if (this->AttributeErrorMetric)
+        const std::vector<vtkIdType> &edges = this->Filter->PointEdges[ends[j]];
+        for (size_t k = 0; k < edges.size(); k++)
           {
-          cost = this->ComputeCost2(edgeId, this->TempX);
+          // Both points of each edge, so the end point itself is included
+          vtkIdType ringIds[2];
+          ringIds[0] = this->Filter->EdgeEndPoint1[edges[k]];
+          ringIds[1] = this->Filter->EdgeEndPoint2[edges[k]];
+          for (int l = 0; l < 2; l++)
+            {
+            blocked  |= this->Blocked[ringIds[l]];
+            cheapest &= this->RingMinimum[ringIds[l]] == edgeId;
+            }
           }
-        else
+        }
+
+      if (blocked)
+        {
+        this->Candidate[edgeId] = 0;
+        }
+      else if (cheapest)
+        {
+        this->Chosen[edgeId] = 1;
+        }
+      }
+  }
+};
+
+// ----------------------
+// RoundPlacements
+// ----------------------
+/* Checks the targets of the picked edges for flipped triangles. */
+class vtkSVLocalQuadricDecimation::RoundPlacements
+{
+public:
+  vtkSVLocalQuadricDecimation *Filter;
+  const vtkIdType *EdgeIds;
+  unsigned char *Good;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int size = 3+this->Filter->NumberOfComponents;
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      vtkIdType edgeId = this->EdgeIds[i];
+      this->Good[i] = this->Filter->IsGoodPlacement(
+        this->Filter->EdgeEndPoint1[edgeId], this->Filter->EdgeEndPoint2[edgeId],
+        &this->Filter->EdgeTargets[edgeId*size]);
+      }
+  }
+};
+
+// ----------------------
+// CollapseInRounds
+// ----------------------
+vtkIdType vtkSVLocalQuadricDecimation::CollapseInRounds(vtkIdType numTris)
+{
+  vtkIdType numPts = this->Mesh->GetNumberOfPoints();
+  vtkIdType numDeletedTris = 0;
+  vtkIdType i, edgeId, ptId;
+  int size = 3+this->NumberOfComponents;
+  size_t j, k;
+
+  // All costs are computed in the first round
+  vtkIdType numEdges = this->EdgeEndPoint1.size();
+  this->EdgeCostValues.assign(numEdges, VTK_DOUBLE_MAX);
+  this->EdgeDirty.assign(numEdges, 1);
+  this->DirtyEdges.resize(numEdges);
+  for (i = 0; i < numEdges; i++)
+    {
+    this->DirtyEdges[i] = i;
+    }
+
+  std::vector<vtkIdType> pointMinimum(numPts), ringMinimum(numPts);
+  std::vector<unsigned char> blocked(numPts);
+  std::vector<unsigned char> candidate, chosen, good;
+  std::vector<vtkIdType> candidates, selected;
+
+  RoundCosts costs;
+  costs.Filter = this;
+  RoundMinima minima;
+  minima.Filter = this;
+  minima.PointMinimum = &pointMinimum[0];
+  minima.RingMinimum = &ringMinimum[0];
+  RoundSelection selection;
+  selection.Filter = this;
+  selection.Blocked = &blocked[0];
+  selection.RingMinimum = &ringMinimum[0];
+  RoundPlacements placements;
+  placements.Filter = this;
+
+  int numRounds = 0;
+  while (this->ActualReduction < this->TargetReduction)
+    {
+    this->UpdateProgress(0.20 + 0.80*this->ActualReduction/this->TargetReduction);
+    if (this->GetAbortExecute())
+      {
+      break;
+      }
+
+    // Costs of the new edges and of the edges whose points changed
+    if (!this->DirtyEdges.empty())
+      {
+      costs.EdgeIds = &this->DirtyEdges[0];
+      vtkSMPTools::For(0, static_cast<vtkIdType>(this->DirtyEdges.size()), costs);
+      }
+    for (j = 0; j < this->DirtyEdges.size(); j++)
+      {
+      this->EdgeDirty[this->DirtyEdges[j]] = 0;
+      }
+    this->DirtyEdges.clear();
+
+    // The candidates are all edges left that can be collapsed
+    numEdges = this->EdgeEndPoint1.size();
+    candidate.assign(numEdges, 0);
+    chosen.assign(numEdges, 0);
+    candidates.clear();
+    for (ptId = 0; ptId < numPts; ptId++)
+      {
+      const std::vector<vtkIdType> &edges = this->PointEdges[ptId];
+      for (j = 0; j < edges.size(); j++)
+        {
+        edgeId = edges[j];
+        if (this->EdgeEndPoint1[edgeId] == ptId &&
+            this->EdgeCostValues[edgeId] < VTK_DOUBLE_MAX)
           {
-          cost = this->ComputeCost(edgeId, this->TempX);
+          candidate[edgeId] = 1;
+          candidates.push_back(edgeId);
           }
-        this->EdgeCosts->Insert(cost, edgeId);
-        this->TargetPoints->InsertTuple(edgeId, this->TempX);
         }
       }
-    else
-      { // This edge already has one point as the merged point.
-      if (this->AttributeErrorMetric)
+    if (candidates.empty())
+      {
+      break;
+      }
+
+    // Pick edges whose one rings do not overlap until no candidate is left.
+    // After the first pass only edges up to the most expensive edge picked
+    // in it are considered, which keeps the order close to one at a time.
+    std::fill(blocked.begin(), blocked.end(), 0);
+    selected.clear();
+    minima.Candidate = &candidate[0];
+    selection.Candidate = &candidate[0];
+    selection.Chosen = &chosen[0];
+    double costBound = VTK_DOUBLE_MAX;
+    while (!candidates.empty())
+      {
+      minima.Stage = 0;
+      vtkSMPTools::For(0, numPts, minima);
+      minima.Stage = 1;
+      vtkSMPTools::For(0, numPts, minima);
+      selection.Candidates = &candidates[0];
+      vtkSMPTools::For(0, static_cast<vtkIdType>(candidates.size()), selection);
+
+      size_t numSelected = selected.size();
+      for (j = 0; j < candidates.size(); j++)
+        {
+        edgeId = candidates[j];
+        if (!chosen[edgeId])
+          {
+          continue;
+          }
+        selected.push_back(edgeId);
+        candidate[edgeId] = 0;
+
+        vtkIdType ends[2] = {this->EdgeEndPoint1[edgeId], this->EdgeEndPoint2[edgeId]};
+        for (int l = 0; l < 2; l++)
+          {
+          const std::vector<vtkIdType> &edges = this->PointEdges[ends[l]];
+          for (k = 0; k < edges.size(); k++)
+            {
+            blocked[this->EdgeEndPoint1[edges[k]]] = 1;
+            blocked[this->EdgeEndPoint2[edges[k]]] = 1;
+            }
+          }
+        }
+      if (numSelected == 0)
         {
-        cost = this->ComputeCost2(changedEdges->GetId(i), this->TempX);
+        costBound = -VTK_DOUBLE_MAX;
+        for (j = 0; j < selected.size(); j++)
+          {
+          costBound = std::max(costBound, this->EdgeCostValues[selected[j]]);
+          }
         }
-      else
+
+      size_t numCandidates = 0;
+      for (j = 0; j < candidates.size(); j++)
+        {
+        edgeId = candidates[j];
+        if (candidate[edgeId] && this->EdgeCostValues[edgeId] <= costBound)
+          {
+          candidates[numCandidates++] = edgeId;
+          }
+        else
+          {
+          candidate[edgeId] = 0;
+          }
+        }
+      candidates.resize(numCandidates);
+      }
+
+    // Check the placements and collapse the cheapest edges first
+    EdgeCostLess edgeCostLess;
+    edgeCostLess.Costs = &this->EdgeCostValues[0];
+    std::sort(selected.begin(), selected.end(), edgeCostLess);
+    good.resize(selected.size());
+    placements.EdgeIds = &selected[0];
+    placements.Good = &good[0];
+    vtkSMPTools::For(0, static_cast<vtkIdType>(selected.size()), placements);
+
+    for (j = 0; j < selected.size() &&
+                this->ActualReduction < this->TargetReduction; j++)
+      {
+      edgeId = selected[j];
+      vtkIdType pt0Id = this->EdgeEndPoint1[edgeId];
+      vtkIdType pt1Id = this->EdgeEndPoint2[edgeId];
+      if (!good[j])
         {
-        cost = this->ComputeCost(changedEdges->GetId(i), this->TempX);
+        // Reconsidered when the cost is computed again
+        vtkDebugMacro(<<"Poor placement detected " << edgeId);
+        this->EdgeCostValues[edgeId] = VTK_DOUBLE_MAX;
+        continue;
         }
-      this->EdgeCosts->Insert(cost, changedEdges->GetId(i));
-      this->TargetPoints->InsertTuple(changedEdges->GetId(i), this->TempX);
+
+      this->NumberOfEdgeCollapses++;
+      std::copy(&this->EdgeTargets[edgeId*size],
+                &this->EdgeTargets[(edgeId+1)*size], this->TempX);
+      this->SetPointAttributeArray(pt0Id, this->TempX);
+      this->AddQuadric(pt1Id, pt0Id);
+      this->UpdateEdgeData(pt0Id, pt1Id);
+      numDeletedTris += this->CollapseEdge(pt0Id, pt1Id);
+      this->ActualReduction = (double) numDeletedTris / numTris;
       }
+    numRounds++;
     }
 
-  changedEdges->Delete();
-  return;
+  vtkDebugMacro(<<"Number Of Rounds: " << numRounds);
+  return numDeletedTris;
 }
 
 // ----------------------
 // ComputeCost
 // ----------------------
-double vtkSVLocalQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
+double vtkSVLocalQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x,
+                                                CostWorkspace &workspace)
 {
   static const double errorNumber = 1e-10;
   double temp[3], A[3][3], b[3];
   vtkIdType pointIds[2];
-  double cost = 0.0;
-  double *index;
-  int i, j;
-  double newPoint [4];
+  int i;
   double v[3],  c, norm, normTemp,  temp2[3];
   double pt1[3], pt2[3];
+  double *tempQuad = &workspace.Quad[0];
 
-  pointIds[0] = this->EndPoint1List->GetId(edgeId);
-  pointIds[1] = this->EndPoint2List->GetId(edgeId);
+  pointIds[0] = this->EdgeEndPoint1[edgeId];
+  pointIds[1] = this->EdgeEndPoint2[edgeId];
 
-  for (i = 0; i < 11 + 4 * this->NumberOfComponents; i++)
-    {
-    this->TempQuad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
-      this->ErrorQuadrics[pointIds[1]].Quadric[i];
-    }
+  vtkSVQuadricKernels::Add(this->ErrorQuadrics[pointIds[0]].Quadric,
+                           this->ErrorQuadrics[pointIds[1]].Quadric,
+                           tempQuad,
+                           vtkSVQuadricKernels::GetQuadricSize(this->NumberOfComponents));
 
-  A[0][0] = this->TempQuad[0];
-  A[0][1] = A[1][0] = this->TempQuad[1];
-  A[0][2] = A[2][0] = this->TempQuad[2];
-  A[1][1] = this->TempQuad[4];
-  A[1][2] = A[2][1] = this->TempQuad[5];
-  A[2][2] = this->TempQuad[7];
+  A[0][0] = tempQuad[0];
+  A[0][1] = A[1][0] = tempQuad[1];
+  A[0][2] = A[2][0] = tempQuad[2];
+  A[1][1] = tempQuad[4];
+  A[1][2] = A[2][1] = tempQuad[5];
+  A[2][2] = tempQuad[7];
 
-  b[0] = -this->TempQuad[3];
-  b[1] = -this->TempQuad[6];
-  b[2] = -this->TempQuad[8];
+  b[0] = -tempQuad[3];
+  b[1] = -tempQuad[6];
+  b[2] = -tempQuad[8];
 
   norm = vtkMath::Norm(A[0]);
   normTemp = vtkMath::Norm(A[1]);
@@ -965,142 +1413,71 @@ double vtkSVLocalQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
       }
     }
 
-  newPoint[0] = x[0];
-  newPoint[1] = x[1];
-  newPoint[2] = x[2];
-  newPoint[3] = 1;
-
   // Compute the cost
-  // x'*quad*x
-  index = this->TempQuad;
-  for (i = 0; i < 4; i++)
-    {
-    cost += (*index++)*newPoint[i]*newPoint[i];
-    for (j = i +1; j < 4; j++)
-      {
-      cost += 2.0*(*index++)*newPoint[i]*newPoint[j];
-      }
-    }
-
-  return cost;
+  // [x 1]'*quad*[x 1]
+  return vtkSVQuadricKernels::Evaluate(tempQuad, x);
 }
 
 
 // ----------------------
 // ComputeCost2
 // ----------------------
-double vtkSVLocalQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
+double vtkSVLocalQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x,
+                                                 CostWorkspace &workspace)
 {
-  // this function is so ugly because the functionality of converting an QEM
-  // into a dence matrix was not extracted into a separate function and
-  // neither was multiplication and some other matrix and vector primitives
   static const double errorNumber = 1e-10;
+  static const double solveTolerance = 1e-12;
   vtkIdType pointIds[2];
-  double cost = 0.0;
   int i, j;
   int solveOk;
+  int size = 3 + this->NumberOfComponents;
+  double *tempQuad = &workspace.Quad[0];
+  double *tempB = &workspace.B[0];
+  double *tempA = &workspace.A[0];
+  double *factor = &workspace.Factor[0];
 
-  pointIds[0] = this->EndPoint1List->GetId(edgeId);
-  pointIds[1] = this->EndPoint2List->GetId(edgeId);
-
-  for (i = 0; i < 11 + 4 * this->NumberOfComponents; i++)
-    {
-    this->TempQuad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
-      this->ErrorQuadrics[pointIds[1]].Quadric[i];
-    }
+  pointIds[0] = this->EdgeEndPoint1[edgeId];
+  pointIds[1] = this->EdgeEndPoint2[edgeId];
 
-  // copy the temp quad into TempA
-  // converting from the sparce matrix format into a dence
-  this->TempA[0][0] = this->TempQuad[0];
-  this->TempA[0][1] = this->TempA[1][0] = this->TempQuad[1];
-  this->TempA[0][2] = this->TempA[2][0] = this->TempQuad[2];
-  this->TempA[1][1] = this->TempQuad[4];
-  this->TempA[1][2] = this->TempA[2][1] = this->TempQuad[5];
-  this->TempA[2][2] = this->TempQuad[7];
+  vtkSVQuadricKernels::Add(this->ErrorQuadrics[pointIds[0]].Quadric,
+                           this->ErrorQuadrics[pointIds[1]].Quadric,
+                           tempQuad,
+                           vtkSVQuadricKernels::GetQuadricSize(this->NumberOfComponents));
 
-  this->TempB[0] = -this->TempQuad[3];
-  this->TempB[1] = -this->TempQuad[6];
-  this->TempB[2] = -this->TempQuad[8];
+  // converting from the sparce matrix format into a dence one
+  vtkSVQuadricKernels::AssembleSystem(tempQuad, this->NumberOfComponents,
+                                      tempA, tempB);
 
-  for (i = 3; i < 3 +  this->NumberOfComponents; i++)
+  for (i = 0; i < size; i++)
     {
-    this->TempA[0][i] = this->TempA[i][0] = this->TempQuad[11+4*(i-3)];
-    this->TempA[1][i] = this->TempA[i][1] = this->TempQuad[11+4*(i-3)+1];
-    this->TempA[2][i] = this->TempA[i][2] = this->TempQuad[11+4*(i-3)+2];
-    this->TempB[i] = -this->TempQuad[11+4*(i-3)+3];
+    x[i] = tempB[i];
     }
-
-  for (i = 3; i < 3 +  this->NumberOfComponents; i++)
+  for (i = 0; i < size*size; i++)
     {
-    for (j = 3; j < 3 +  this->NumberOfComponents; j++)
-      {
-      if (i == j)
-        {
-        this->TempA[i][j] = this->TempQuad[10];
-        }
-      else
-        {
-        this->TempA[i][j] = 0;
-        }
-      }
+    factor[i] = tempA[i];
     }
 
-  for (i = 0; i < 3 + this->NumberOfComponents; i++)
-    {
-    x[i] = this->TempB[i];
-    }
-
-  // solve A*x = b
-  // this clobers A
-  // need to develop a quality of the solution test??
-  solveOk = vtkMath::SolveLinearSystem(this->TempA, x, 3 +  this->NumberOfComponents);
-
-  // need to copy back into A
-  this->TempA[0][0] = this->TempQuad[0];
-  this->TempA[0][1] = this->TempA[1][0] = this->TempQuad[1];
-  this->TempA[0][2] = this->TempA[2][0] = this->TempQuad[2];
-  this->TempA[1][1] = this->TempQuad[4];
-  this->TempA[1][2] = this->TempA[2][1] = this->TempQuad[5];
-  this->TempA[2][2] = this->TempQuad[7];
-
-  for (i = 3; i < 3 +  this->NumberOfComponents; i++)
-    {
-    this->TempA[0][i] = this->TempA[i][0] = this->TempQuad[11+4*(i-3)];
-    this->TempA[1][i] = this->TempA[i][1] = this->TempQuad[11+4*(i-3)+1];
-    this->TempA[2][i] = this->TempA[i][2] = this->TempQuad[11+4*(i-3)+2];
-    }
-
-  for (i = 3; i < 3 +  this->NumberOfComponents; i++)
-    {
-    for (j = 3; j < 3 +  this->NumberOfComponents; j++)
-      {
-      if (i == j)
-        {
-        this->TempA[i][j] = this->TempQuad[10];
-        }
-      else
-        {
-        this->TempA[i][j] = 0;
-        }
-      }
-    }
+  // solve A*x = b, the factorization goes into its own copy so A is kept
+  // for the backup plan
+  solveOk = vtkSVQuadricKernels::SymmetricSolve(factor, size, x,
+                                                solveTolerance);
 
   // check for failure to solve the system
   if (!solveOk)
     {
     // cheapest point along the edge
     // this should not frequently occur, so I am using dynamic allocation
-    double *pt1 = new double [3+this->NumberOfComponents];
-    double *pt2 = new double [3+this->NumberOfComponents];
-    double *v = new double [3+this->NumberOfComponents];
-    double *temp = new double [3+this->NumberOfComponents];
-    double *temp2 = new double [3+this->NumberOfComponents];
+    double *pt1 = new double [size];
+    double *pt2 = new double [size];
+    double *v = new double [size];
+    double *temp = new double [size];
+    double *temp2 = new double [size];
     double d = 0;
     double c = 0;
 
     this->GetPointAttributeArray(pointIds[0], pt1);
     this->GetPointAttributeArray(pointIds[1], pt2);
-    for (i = 0; i < 3+this->NumberOfComponents; ++i)
+    for (i = 0; i < size; ++i)
       {
       v[i] = pt2[i] - pt1[i];
       }
@@ -1108,17 +1485,17 @@ double vtkSVLocalQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
     // equation for the edge pt1 + c * v
     // attempt least squares fit for c for A*(pt1 + c * v) = b
     // temp2 = A*v
-    for (i = 0; i < 3 + this->NumberOfComponents; ++i)
+    for (i = 0; i < size; ++i)
       {
       temp2[i] = 0;
-      for (j = 0; j < 3 + this->NumberOfComponents; ++j)
+      for (j = 0; j < size; ++j)
         {
-        temp2[i] += this->TempA[i][j]*v[j];
+        temp2[i] += tempA[i*size+j]*v[j];
         }
       }
 
     // c = v dot v
-    for (i = 0; i <  3 + this->NumberOfComponents; ++i)
+    for (i = 0; i < size; ++i)
       {
       d += temp2[i]*temp2[i];
       }
@@ -1126,27 +1503,27 @@ double vtkSVLocalQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
     if ( d > errorNumber)
       {
       // temp = A*pt1
-      for (i = 0; i < 3 + this->NumberOfComponents; ++i)
+      for (i = 0; i < size; ++i)
         {
         temp[i] = 0;
-        for (j = 0; j < 3 + this->NumberOfComponents; ++j)
+        for (j = 0; j < size; ++j)
           {
-          temp[i] += this->TempA[i][j]*pt1[j];
+          temp[i] += tempA[i*size+j]*pt1[j];
           }
         }
 
-      for (i = 0; i < 3 + this->NumberOfComponents; i++)
+      for (i = 0; i < size; i++)
         {
-        temp[i] = this->TempB[i] - temp[i];
+        temp[i] = tempB[i] - temp[i];
         }
 
-      for (i = 0; i < 3 + this->NumberOfComponents; i++)
+      for (i = 0; i < size; i++)
         {
         c += temp2[i]*temp[i];
         }
       c = c/d;
 
-      for (i = 0; i < 3  + this->NumberOfComponents; i++)
+      for (i = 0; i < size; i++)
         {
         x[i] = pt1[i]+c*v[i];
         }
@@ -1155,7 +1532,7 @@ double vtkSVLocalQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
       {
       // use mid point
       // might want to change to best of mid and end points??
-      for (i = 0; i < 3  + this->NumberOfComponents; i++)
+      for (i = 0; i < size; i++)
         {
         x[i] = 0.5*(pt1[i]+pt2[i]);
         }
@@ -1169,22 +1546,7 @@ double vtkSVLocalQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
 
   // Compute the cost
   // x'*A*x - 2*b*x + d
-  for (i = 0; i < 3+this->NumberOfComponents; i++)
-    {
-    cost += this->TempA[i][i]*x[i]*x[i];
-    for (j = i+1; j < 3+this->NumberOfComponents; j++)
-      {
-      cost += 2.0*this->TempA[i][j]*x[i]*x[j];
-      }
-    }
-  for (i = 0; i < 3+this->NumberOfComponents; i++)
-    {
-    cost -=  2.0 * this->TempB[i]*x[i];
-    }
-
-  cost += this->TempQuad[9];
-
-  return cost;
+  return vtkSVQuadricKernels::Evaluate(tempQuad, x, this->NumberOfComponents);
 }
 
 
@@ -1490,6 +1852,8 @@ void vtkSVLocalQuadricDecimation::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Normals Weight: " << this->NormalsWeight << "\n";
   os << indent << "TCoords Weight: " << this->TCoordsWeight << "\n";
   os << indent << "Tensors Weight: " << this->TensorsWeight << "\n";
+  os << indent << "Use Parallel Decimation: "
+     << (this->UseParallelDecimation ? "On\n" : "Off\n");
 }
 
 // ----------------------
@@ -43,11 +43,13 @@
 
 #include "vtkSVGeometryModule.h" // for export
 
-#include "vtkEdgeTable.h"
-#include "vtkDoubleArray.h"
 #include "vtkIdList.h"
 #include "vtkPolyDataAlgorithm.h"
-#include "vtkPriorityQueue.h"
+
+#include <vector>
+
+class vtkIntArray;
+class vtkSVIndexedHeap;
 
 class VTKSVGEOMETRY_EXPORT vtkSVLocalQuadricDecimation : public vtkPolyDataAlgorithm
 {
@@ -132,6 +134,18 @@ public:
   vtkBooleanMacro(UseCellArray,int);
   //@}
 
+  //@{
+  /// \brief Turn on/off collapsing edges in rounds instead of one at a time.
+  /// Each round computes the costs that changed in parallel and picks the
+  /// edges that are the cheapest of all edges touching their one rings, so
+  /// no two picked edges share a point of their one rings. The picks are
+  /// checked for flipped triangles in parallel and collapsed cheapest first.
+  /// Default is off.
+  vtkSetMacro(UseParallelDecimation,int);
+  vtkGetMacro(UseParallelDecimation,int);
+  vtkBooleanMacro(UseParallelDecimation,int);
+  //@}
+
   //@{
   /// \brief Get the actual reduction. This value is only valid after the
   /// filter has executed.
@@ -169,8 +183,23 @@ protected:
   // Description:
   // Compute cost for contracting this edge and the point that gives us this
   // cost.
-  double ComputeCost(vtkIdType edgeId, double *x);
-  double ComputeCost2(vtkIdType edgeId, double *x);
+  // The workspace holds the temporary arrays of the computation, so that
+  // several edges can be evaluated at once with a workspace each. A is the
+  // dense, row major system of the attribute metric and Factor its LDL^T
+  // factorization.
+  struct CostWorkspace
+  {
+    std::vector<double> Quad;
+    std::vector<double> B;
+    std::vector<double> A;
+    std::vector<double> Factor;
+  };
+  double ComputeCost(vtkIdType edgeId, double *x, CostWorkspace &workspace);
+  double ComputeCost2(vtkIdType edgeId, double *x, CostWorkspace &workspace);
+
+  // Description:
+  // Size the arrays of a workspace for the current number of components.
+  void AllocateWorkspace(CostWorkspace &workspace);
 
   // Description:
   // Find all edges that will have an endpoint change ids because of an edge
@@ -182,6 +211,38 @@ protected:
   // Find a cell that uses this edge.
   vtkIdType GetEdgeCellId(vtkIdType p1Id, vtkIdType p2Id);
 
+  // Description:
+  // Return the id of the edge between two points or -1, the edges of the
+  // point with fewer edges are searched.
+  vtkIdType FindEdge(vtkIdType p1Id, vtkIdType p2Id);
+
+  // Description:
+  // Add an edge to the edge arrays and the edges of its points and return
+  // its id.
+  vtkIdType InsertEdge(vtkIdType p1Id, vtkIdType p2Id);
+
+  // Description:
+  // Remove an edge from the edges of a point.
+  void RemovePointEdge(vtkIdType ptId, vtkIdType edgeId);
+
+  // Description:
+  // Compute the cost and target of an edge and put them in the queue and
+  // the target array. When collapsing in rounds, the edge is only marked to
+  // be computed at the start of the next round.
+  void UpdateEdgeCost(vtkIdType edgeId);
+
+  // Description:
+  // Collapse edges in rounds of edges with disjoint one rings until the
+  // target reduction is reached; return the number of triangles deleted.
+  vtkIdType CollapseInRounds(vtkIdType numTris);
+
+  // Description:
+  // Parallel parts of a round.
+  class RoundCosts;
+  class RoundMinima;
+  class RoundSelection;
+  class RoundPlacements;
+
   int IsGoodPlacement(vtkIdType pt0Id, vtkIdType pt1Id, const double *x);
   int TrianglePlaneCheck(const double t0[3], const double t1[3],
                          const double t2[3],  const double *x);
@@ -222,17 +283,33 @@ protected:
   char* DecimatePointArrayName;
 
   int               NumberOfEdgeCollapses;
-  vtkEdgeTable     *Edges;
-  vtkIdList        *EndPoint1List;
-  vtkIdList        *EndPoint2List;
-  vtkPriorityQueue *EdgeCosts;
-  vtkDoubleArray   *TargetPoints;
+  vtkSVIndexedHeap *EdgeCosts;
   int               NumberOfComponents;
   vtkPolyData      *Mesh;
   vtkIntArray 	   *DecimateCellArray;
   vtkIntArray 	   *DecimatePointArray;
   int UseCellArray;
   int UsePointArray;
+  int UseParallelDecimation;
+
+  //@{
+  /// \brief Edges by edge id: the two end points and the target point and
+  /// attributes of the collapse, 3+NumberOfComponents values per edge.
+  std::vector<vtkIdType> EdgeEndPoint1;
+  std::vector<vtkIdType> EdgeEndPoint2;
+  std::vector<double>    EdgeTargets;
+  //@}
+
+  /// \brief Ids of the edges that use each point.
+  std::vector<std::vector<vtkIdType> > PointEdges;
+
+  //@{
+  /// \brief Cost of each edge when collapsing in rounds, and the edges whose
+  /// cost has to be computed again.
+  std::vector<double>        EdgeCostValues;
+  std::vector<unsigned char> EdgeDirty;
+  std::vector<vtkIdType>     DirtyEdges;
+  //@}
 
   //BTX
   struct ErrorQuadric
@@ -248,10 +325,7 @@ protected:
   // Temporary variables for performance
   vtkIdList *CollapseCellIds;
   double *TempX;
-  double *TempQuad;
-  double *TempB;
-  double **TempA;
-  double *TempData;
+  CostWorkspace Workspace;
 
   int *changedPoint;
   int *fixedPoint;
@@ -33,7 +33,6 @@
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
-#include "vtkCellLocator.h"
 #include "vtkErrorCode.h"
 #include "vtkExecutive.h"
 #include "vtkFloatArray.h"
@@ -45,19 +44,23 @@
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
 #include "vtkSmartPointer.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkTriangleFilter.h"
 
 #include "vtkSVGeneralUtils.h"
 #include "vtkSVGlobals.h"
+#include "vtkSVSparseCholesky.h"
+#include "vtkSVSurfaceProjector.h"
+
+#include <vector>
 
 vtkStandardNewMacro(vtkSVLocalSmoothPolyDataFilter);
 
 // The following code defines a helper class for performing mesh smoothing
 // across the surface of another mesh.
 typedef struct _vtkSmoothPoint { //; prevent man page generation
-    vtkIdType     cellId;  // cell
-    int     subId;   // cell sub id
-    double   p[3];    // parametric coords in cell
+    vtkIdType     cellId;  // triangle of the source projector
 } vtkSmoothPoint;
 
 class vtkSVLocalSmoothPoints { //;prevent man page generation
@@ -125,6 +128,317 @@ vtkSmoothPoint *vtkSVLocalSmoothPoints::Resize(vtkIdType sz)
   return this->Array;
 }
 
+namespace
+{
+// Performs one Jacobi smoothing pass. New coordinates of the moving points
+// are computed from the old coordinates only, so all points can be moved at
+// the same time. Coordinates are kept as separate x, y and z arrays.
+class JacobiSmoothPoints
+{
+public:
+  const vtkIdType *MovingIds;   // points that can move
+  const vtkIdType *Offsets;     // start of the neighbors of each point
+  const vtkIdType *Neighbors;   // connected point ids
+  const double *OldX[3];
+  double *NewX[3];
+  double Factor;
+
+  // Optional constraint to the source surface
+  vtkSVSurfaceProjector *Projector;
+  vtkSVLocalSmoothPoints *SmoothPoints;
+  const char *Constrain;        // 1 if the point is moved onto the source
+
+  vtkSMPThreadLocal<double> MaxDist;
+  double IterationMaxDist;
+
+  void Initialize()
+    {
+    this->MaxDist.Local() = 0.0;
+    }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    double &maxDist = this->MaxDist.Local();
+
+    for (vtkIdType m=begin; m<end; m++)
+      {
+      vtkIdType ptId = this->MovingIds[m];
+      vtkIdType first = this->Offsets[ptId];
+      vtkIdType npts = this->Offsets[ptId+1] - first;
+
+      double x[3], deltaX[3], xNew[3];
+      int k;
+      for (k=0; k<3; k++)
+        {
+        x[k] = this->OldX[k][ptId];
+        deltaX[k] = 0.0;
+        }
+      for (vtkIdType j=0; j<npts; j++)
+        {
+        vtkIdType neiId = this->Neighbors[first+j];
+        for (k=0; k<3; k++)
+          {
+          deltaX[k] += (this->OldX[k][neiId] - x[k]) / npts;
+          }
+        }
+      for (k=0; k<3; k++)
+        {
+        xNew[k] = x[k] + this->Factor * deltaX[k];
+        }
+
+      // Constrain point to surface
+      if ( this->Projector != NULL && this->Constrain[ptId] )
+        {
+        vtkSmoothPoint *sPtr = this->SmoothPoints->GetSmoothPoint(ptId);
+        double closestPt[3], dist2;
+        sPtr->cellId = this->Projector->ProjectPoint(xNew, sPtr->cellId,
+                                                     closestPt, dist2);
+        for (k=0; k<3; k++)
+          {
+          xNew[k] = closestPt[k];
+          }
+        }
+
+      for (k=0; k<3; k++)
+        {
+        this->NewX[k][ptId] = xNew[k];
+        }
+      double dist = vtkMath::Norm(deltaX);
+      if ( dist > maxDist )
+        {
+        maxDist = dist;
+        }
+      }
+    }
+
+  void Reduce()
+    {
+    // Threads that did no work keep values from earlier passes, so every
+    // value is cleared once it is read
+    this->IterationMaxDist = 0.0;
+    vtkSMPThreadLocal<double>::iterator iter;
+    for (iter=this->MaxDist.begin(); iter!=this->MaxDist.end(); ++iter)
+      {
+      this->IterationMaxDist = svmaximum(this->IterationMaxDist, *iter);
+      *iter = 0.0;
+      }
+    }
+};
+
+// Backward Euler steps of Laplacian or bi-Laplacian smoothing. With U the
+// umbrella operator, x - mean of the neighbors, and D the number of
+// neighbors, a Laplacian step solves (D + lambda*D*U) x = D x0 and a
+// bi-Laplacian step (D + lambda*D*U*U) x = D x0. Only neighbors that list
+// each other and can both move are unknowns in the same system, which keeps
+// the matrix symmetric positive definite. Other neighbors, like fixed
+// points, use their coordinates from the start of the step.
+class ImplicitFairing
+{
+public:
+  int Setup(const vtkIdType numPts, const std::vector<vtkIdType> &offsets,
+            const std::vector<vtkIdType> &neighbors,
+            const std::vector<vtkIdType> &movingIds,
+            const double timeStep, const int biLaplacian)
+    {
+    this->Offsets = &offsets[0];
+    this->Neighbors = neighbors.empty() ? NULL : &neighbors[0];
+    this->MovingIds = &movingIds;
+    this->TimeStep = timeStep;
+    this->BiLaplacian = biLaplacian;
+
+    int numRows = movingIds.size();
+    this->Rows.assign(numPts, -1);
+    for (int r=0; r<numRows; r++)
+      {
+      this->Rows[movingIds[r]] = r;
+      }
+
+    // Laplacian D*U over the unknowns, a neighbor is coupled if it lists
+    // this point too. Repeated neighbors only count once in the coupling.
+    this->Known.assign(neighbors.size(), 0);
+    this->Degrees.resize(numRows);
+    this->LaplacianOffsets.assign(1, 0);
+    this->LaplacianColumns.clear();
+    this->LaplacianValues.clear();
+    for (int r=0; r<numRows; r++)
+      {
+      vtkIdType ptId = movingIds[r];
+      this->Degrees[r] = offsets[ptId+1] - offsets[ptId];
+      this->LaplacianColumns.push_back(r);
+      this->LaplacianValues.push_back(this->Degrees[r]);
+      for (vtkIdType p=offsets[ptId]; p<offsets[ptId+1]; p++)
+        {
+        if (!this->IsCoupled(ptId, p))
+          {
+          this->Known[p] = 1;
+          continue;
+          }
+        this->LaplacianColumns.push_back(this->Rows[neighbors[p]]);
+        this->LaplacianValues.push_back(-1.0);
+        }
+      this->LaplacianOffsets.push_back(this->LaplacianColumns.size());
+      }
+
+    // Matrix D + lambda*L or D + lambda*L*D^-1*L
+    std::vector<int> matrixOffsets(1, 0), matrixColumns;
+    this->MatrixValues.clear();
+    if (!biLaplacian)
+      {
+      matrixOffsets = this->LaplacianOffsets;
+      matrixColumns = this->LaplacianColumns;
+      for (size_t p=0; p<this->LaplacianValues.size(); p++)
+        {
+        this->MatrixValues.push_back(timeStep*this->LaplacianValues[p]);
+        }
+      for (int r=0; r<numRows; r++)
+        {
+        this->MatrixValues[matrixOffsets[r]] += this->Degrees[r];
+        }
+      }
+    else
+      {
+      std::vector<int> position(numRows, -1);
+      for (int r=0; r<numRows; r++)
+        {
+        int start = matrixColumns.size();
+        matrixColumns.push_back(r);
+        this->MatrixValues.push_back(this->Degrees[r]);
+        position[r] = start;
+        for (int p=this->LaplacianOffsets[r]; p<this->LaplacianOffsets[r+1]; p++)
+          {
+          int mid = this->LaplacianColumns[p];
+          double scale = timeStep*this->LaplacianValues[p]/this->Degrees[mid];
+          for (int q=this->LaplacianOffsets[mid]; q<this->LaplacianOffsets[mid+1]; q++)
+            {
+            int col = this->LaplacianColumns[q];
+            if (position[col] < start)
+              {
+              position[col] = matrixColumns.size();
+              matrixColumns.push_back(col);
+              this->MatrixValues.push_back(0.0);
+              }
+            this->MatrixValues[position[col]] += scale*this->LaplacianValues[q];
+            }
+          }
+        matrixOffsets.push_back(matrixColumns.size());
+        }
+      }
+
+    this->Solver = vtkSmartPointer<vtkSVSparseCholesky>::New();
+    if (this->Solver->Analyze(numRows, matrixOffsets, matrixColumns) != SV_OK ||
+        this->Solver->Factorize(&this->MatrixValues[0]) != SV_OK)
+      {
+      return SV_ERROR;
+      }
+    return SV_OK;
+    }
+
+  // One step from the old coordinates, the coordinates of points that are
+  // not unknowns are copied
+  void Step(std::vector<double> oldX[3], std::vector<double> newX[3])
+    {
+    for (int k=0; k<3; k++)
+      {
+      newX[k] = oldX[k];
+      this->OldX[k] = &oldX[k][0];
+      this->NewX[k] = &newX[k][0];
+      }
+    vtkSMPTools::For(0, 3, *this);
+    }
+
+  // Solve for the coordinates begin to end
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    const std::vector<vtkIdType> &movingIds = *this->MovingIds;
+    int numRows = movingIds.size();
+    std::vector<double> known(numRows), rhs(numRows);
+    for (vtkIdType k=begin; k<end; k++)
+      {
+      const double *x = this->OldX[k];
+      for (int r=0; r<numRows; r++)
+        {
+        vtkIdType ptId = movingIds[r];
+        known[r] = 0.0;
+        for (vtkIdType p=this->Offsets[ptId]; p<this->Offsets[ptId+1]; p++)
+          {
+          if (this->Known[p])
+            {
+            known[r] += x[this->Neighbors[p]];
+            }
+          }
+        }
+
+      // Right hand side D x0 + lambda*g or D x0 + lambda*L*D^-1*g
+      for (int r=0; r<numRows; r++)
+        {
+        rhs[r] = this->Degrees[r]*x[movingIds[r]];
+        if (!this->BiLaplacian)
+          {
+          rhs[r] += this->TimeStep*known[r];
+          continue;
+          }
+        for (int p=this->LaplacianOffsets[r]; p<this->LaplacianOffsets[r+1]; p++)
+          {
+          int col = this->LaplacianColumns[p];
+          rhs[r] += this->TimeStep*this->LaplacianValues[p]*known[col]/this->Degrees[col];
+          }
+        }
+
+      this->Solver->Solve(&rhs[0]);
+      for (int r=0; r<numRows; r++)
+        {
+        this->NewX[k][movingIds[r]] = rhs[r];
+        }
+      }
+    }
+
+protected:
+  // True if the neighbor at p can move, lists the point and was not listed
+  // before
+  bool IsCoupled(const vtkIdType ptId, const vtkIdType p) const
+    {
+    vtkIdType neiId = this->Neighbors[p];
+    if (this->Rows[neiId] < 0)
+      {
+      return false;
+      }
+    for (vtkIdType q=this->Offsets[ptId]; q<p; q++)
+      {
+      if (this->Neighbors[q] == neiId)
+        {
+        return false;
+        }
+      }
+    for (vtkIdType q=this->Offsets[neiId]; q<this->Offsets[neiId+1]; q++)
+      {
+      if (this->Neighbors[q] == ptId)
+        {
+        return true;
+        }
+      }
+    return false;
+    }
+
+  const vtkIdType *Offsets;
+  const vtkIdType *Neighbors;
+  const std::vector<vtkIdType> *MovingIds;
+  double TimeStep;
+  int BiLaplacian;
+
+  std::vector<int> Rows;        // unknown of each point, -1 if not moving
+  std::vector<char> Known;      // 1 for neighbors taken from the old step
+  std::vector<double> Degrees;
+  std::vector<int> LaplacianOffsets;
+  std::vector<int> LaplacianColumns;
+  std::vector<double> LaplacianValues;
+  std::vector<double> MatrixValues;
+  vtkSmartPointer<vtkSVSparseCholesky> Solver;
+
+  const double *OldX[3];
+  double *NewX[3];
+};
+}
+
 // The following code defines methods for the vtkSVLocalSmoothPolyDataFilter class
 //
 
@@ -160,6 +474,12 @@ vtkSVLocalSmoothPolyDataFilter::vtkSVLocalSmoothPolyDataFilter()
   this->UsePointArray = 0;
 
   this->ConstrainAllPoints = 1;
+
+  this->UseJacobiIteration = 0;
+
+  this->UseImplicitSmoothing = 0;
+  this->ImplicitTimeStep = 1.0;
+  this->UseBiLaplacian = 0;
 }
 
 vtkSVLocalSmoothPolyDataFilter::~vtkSVLocalSmoothPolyDataFilter()
@@ -240,7 +560,7 @@ int vtkSVLocalSmoothPolyDataFilter::RequestData(
   double x1[3], x2[3], x3[3], l1[3], l2[3];
   double CosFeatureAngle; //Cosine of angle between adjacent polys
   double CosEdgeAngle; // Cosine of angle between adjacent edges
-  double closestPt[3], dist2, *w = NULL;
+  double closestPt[3], dist2;
   int iterationNumber;
   vtkIdType numSimple=0, numBEdges=0, numFixed=0, numFEdges=0;
   vtkPolyData *inMesh, *Mesh;
@@ -249,7 +569,8 @@ int vtkSVLocalSmoothPolyDataFilter::RequestData(
   vtkCellArray *inVerts, *inLines, *inPolys, *inStrips;
   vtkPoints *newPts;
   vtkMeshVertexPtr Verts;
-  vtkCellLocator *cellLocator=NULL;
+  vtkNew(vtkSVSurfaceProjector, projector);
+  int smoothStatus = SV_OK;
 
   // Check input
   //
@@ -301,6 +622,16 @@ int vtkSVLocalSmoothPolyDataFilter::RequestData(
     }
   }
 
+  if (source)
+  {
+    if (projector->Build(source) != SV_OK)
+    {
+      vtkErrorMacro("Need polygons on the source to constrain points to");
+      this->SetErrorCode(vtkErrorCode::UserError + 1);
+      return SV_ERROR;
+    }
+  }
+
   CosFeatureAngle = cos( vtkMath::RadiansFromDegrees( this->FeatureAngle) );
   CosEdgeAngle =    cos( vtkMath::RadiansFromDegrees( this->EdgeAngle) );
 
@@ -315,7 +646,8 @@ int vtkSVLocalSmoothPolyDataFilter::RequestData(
                << "\tError Scalars " << (this->GenerateErrorScalars ? "On\n" : "Off\n")
                << "\tError Vectors " << (this->GenerateErrorVectors ? "On\n" : "Off\n"));
 
-  if ( this->NumberOfIterations <= 0 || this->RelaxationFactor == 0.0)
+  if ( this->NumberOfIterations <= 0 ||
+       (this->UseImplicitSmoothing ? this->ImplicitTimeStep : this->RelaxationFactor) == 0.0)
     { //don't do anything! pass data through
     output->CopyStructure(input);
     output->GetPointData()->PassData(input->GetPointData());
@@ -637,17 +969,12 @@ int vtkSVLocalSmoothPolyDataFilter::RequestData(
     {
       this->SmoothPoints = new vtkSVLocalSmoothPoints;
       vtkSmoothPoint *sPtr;
-      cellLocator = vtkCellLocator::New();
-      w = new double[source->GetMaxCellSize()];
-
-      cellLocator->SetDataSet(source);
-      cellLocator->BuildLocator();
 
       for (i=0; i < numPts; i++)
 	{
 	sPtr = this->SmoothPoints->InsertSmoothPoint(i);
-	cellLocator->FindClosestPoint(inPts->GetPoint(i), closestPt,
-				      sPtr->cellId, sPtr->subId, dist2);
+	sPtr->cellId = projector->FindClosestPoint(inPts->GetPoint(i),
+						   closestPt, dist2);
 	newPts->SetPoint(i, closestPt);
 	}
     }
@@ -660,92 +987,255 @@ int vtkSVLocalSmoothPolyDataFilter::RequestData(
     }
 
   factor = this->RelaxationFactor;
-  for ( maxDist=VTK_DOUBLE_MAX, iterationNumber=0;
-  maxDist > conv && iterationNumber < this->NumberOfIterations;
-  iterationNumber++ )
+  if ( this->UseJacobiIteration || this->UseImplicitSmoothing )
     {
+    // Neighbors of the points that can move, stored one after the other
+    std::vector<vtkIdType> offsets(numPts+1, 0);
+    std::vector<vtkIdType> movingIds;
+    for (i=0; i<numPts; i++)
+      {
+      offsets[i+1] = offsets[i];
+      if ( Verts[i].type != VTK_FIXED_VERTEX && Verts[i].edges != NULL &&
+      (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
+        {
+        offsets[i+1] += npts;
+        movingIds.push_back(i);
+        }
+      }
+    std::vector<vtkIdType> neighborIds(offsets[numPts]);
+    for (size_t m=0; m<movingIds.size(); m++)
+      {
+      vtkIdType ptId = movingIds[m];
+      for (j=0; j<offsets[ptId+1]-offsets[ptId]; j++)
+        {
+        neighborIds[offsets[ptId]+j] = Verts[ptId].edges->GetId(j);
+        }
+      }
 
-    if ( iterationNumber && !(iterationNumber % 5) )
+    // Points that are moved onto the source after each pass
+    std::vector<char> constrain(numPts, 0);
+    if ( source )
       {
-      this->UpdateProgress (0.5 + 0.5*iterationNumber/this->NumberOfIterations);
-      if (this->GetAbortExecute())
+      for (i=0; i<numPts; i++)
         {
-        break;
+        constrain[i] = this->ConstrainAllPoints != 0 || Verts[i].constrain == 0;
         }
       }
 
-    maxDist=0.0;
+    // Two copies of the coordinates; each pass reads one and writes the other
+    std::vector<double> coords[2][3];
+    for (k=0; k<3; k++)
+      {
+      coords[0][k].resize(numPts);
+      }
     for (i=0; i<numPts; i++)
       {
-      if ( Verts[i].type != VTK_FIXED_VERTEX && Verts[i].edges != NULL &&
-      (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
+      newPts->GetPoint(i, x);
+      for (k=0; k<3; k++)
         {
-        newPts->GetPoint(i, x); //use current points
-        deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
-        for (j=0; j<npts; j++)
+        coords[0][k][i] = x[k];
+        }
+      }
+    for (k=0; k<3; k++)
+      {
+      coords[1][k] = coords[0][k];
+      }
+
+    int current = 0;
+    if ( this->UseImplicitSmoothing )
+      {
+      ImplicitFairing fairing;
+      iterationNumber = 0;
+      if ( movingIds.empty() )
+        {
+        vtkDebugMacro(<<"No points to smooth");
+        }
+      else if ( fairing.Setup(numPts, offsets, neighborIds, movingIds,
+                              this->ImplicitTimeStep, this->UseBiLaplacian) != SV_OK )
+        {
+        vtkErrorMacro("Could not factor the implicit smoothing matrix");
+        this->SetErrorCode(vtkErrorCode::UserError + 1);
+        smoothStatus = SV_ERROR;
+        }
+      else
+        {
+        for ( maxDist=VTK_DOUBLE_MAX;
+        maxDist > conv && iterationNumber < this->NumberOfIterations;
+        iterationNumber++ )
           {
-          newPts->GetPoint(Verts[i].edges->GetId(j), y);
-          for (k=0; k<3; k++)
+          if ( iterationNumber )
             {
-            deltaX[k] += (y[k] - x[k]) / npts;
+            this->UpdateProgress (0.5 + 0.5*iterationNumber/this->NumberOfIterations);
+            if (this->GetAbortExecute())
+              {
+              break;
+              }
             }
-          }//for all connected points
 
-        for (k=0;k<3;k++)
+          fairing.Step(coords[current], coords[1-current]);
+          current = 1 - current;
+
+          // Constrain points to the source and find the largest motion
+          maxDist = 0.0;
+          for (size_t m=0; m<movingIds.size(); m++)
+            {
+            vtkIdType ptId = movingIds[m];
+            for (k=0; k<3; k++)
+              {
+              xNew[k] = coords[current][k][ptId];
+              }
+            if ( source && constrain[ptId] )
+              {
+              vtkSmoothPoint *sPtr = this->SmoothPoints->GetSmoothPoint(ptId);
+              sPtr->cellId = projector->ProjectPoint(xNew, sPtr->cellId,
+                                                     closestPt, dist2);
+              for (k=0; k<3; k++)
+                {
+                xNew[k] = closestPt[k];
+                coords[current][k][ptId] = xNew[k];
+                }
+              }
+            for (k=0; k<3; k++)
+              {
+              deltaX[k] = xNew[k] - coords[1-current][k][ptId];
+              }
+            if ( (dist = vtkMath::Norm(deltaX)) > maxDist )
+              {
+              maxDist = dist;
+              }
+            }
+          }
+        }
+      }
+    else
+      {
+      JacobiSmoothPoints smoother;
+      smoother.MovingIds = movingIds.empty() ? NULL : &movingIds[0];
+      smoother.Offsets = &offsets[0];
+      smoother.Neighbors = neighborIds.empty() ? NULL : &neighborIds[0];
+      smoother.Factor = factor;
+      smoother.Projector = source ? projector.GetPointer() : NULL;
+      smoother.SmoothPoints = this->SmoothPoints;
+      smoother.Constrain = &constrain[0];
+      smoother.IterationMaxDist = 0.0;
+
+      for ( maxDist=VTK_DOUBLE_MAX, iterationNumber=0;
+      maxDist > conv && iterationNumber < this->NumberOfIterations;
+      iterationNumber++ )
+        {
+        if ( iterationNumber && !(iterationNumber % 5) )
           {
-          xNew[k] = x[k] + factor * deltaX[k];
+          this->UpdateProgress (0.5 + 0.5*iterationNumber/this->NumberOfIterations);
+          if (this->GetAbortExecute())
+            {
+            break;
+            }
           }
 
-        // Constrain point to surface
-        if ( source )
+        // Fixed points are the same in both copies and never written
+        for (k=0; k<3; k++)
           {
-            int movepoint = 0;
-	    if (this->ConstrainAllPoints == 0)
-	    {
-	      if (Verts[i].constrain == 0)
-	        movepoint = 1;
-	    }
-	    else
-	      movepoint = 1;
-
-            if (movepoint)
-	    {
-	    vtkSmoothPoint *sPtr = this->SmoothPoints->GetSmoothPoint(i);
-	    vtkCell *cell=NULL;
-
-	    if ( sPtr->cellId >= 0 ) //in cell
-	      {
-	      cell = source->GetCell(sPtr->cellId);
-	      }
-
-	    if ( !cell || cell->EvaluatePosition(xNew, closestPt,
-	    sPtr->subId, sPtr->p, dist2, w) == 0)
-	      { // not in cell anymore
-	      cellLocator->FindClosestPoint(xNew, closestPt, sPtr->cellId,
-					    sPtr->subId, dist2);
-	      }
-	    for (k=0; k<3; k++)
-	      {
-	      xNew[k] = closestPt[k];
-	      }
-	    }
+          smoother.OldX[k] = &coords[current][k][0];
+          smoother.NewX[k] = &coords[1-current][k][0];
           }
+        if ( movingIds.empty() )
+          {
+          maxDist = 0.0;
+          break;
+          }
+        vtkSMPTools::For(0, static_cast<vtkIdType>(movingIds.size()), smoother);
+        maxDist = smoother.IterationMaxDist;
+        current = 1 - current;
+        }
+      }
+
+    for (i=0; i<numPts; i++)
+      {
+      for (k=0; k<3; k++)
+        {
+        xNew[k] = coords[current][k][i];
+        }
+      newPts->SetPoint(i, xNew);
+      }
+    }
+  else // Gauss-Seidel, each point sees the points already moved
+    {
+    for ( maxDist=VTK_DOUBLE_MAX, iterationNumber=0;
+    maxDist > conv && iterationNumber < this->NumberOfIterations;
+    iterationNumber++ )
+      {
 
-        newPts->SetPoint(i,xNew);
-        if ( (dist = vtkMath::Norm(deltaX)) > maxDist )
+      if ( iterationNumber && !(iterationNumber % 5) )
+        {
+        this->UpdateProgress (0.5 + 0.5*iterationNumber/this->NumberOfIterations);
+        if (this->GetAbortExecute())
           {
-          maxDist = dist;
+          break;
           }
-        }//if can move point
-      }//for all points
-    } //for not converged or within iteration count
+        }
+
+      maxDist=0.0;
+      for (i=0; i<numPts; i++)
+        {
+        if ( Verts[i].type != VTK_FIXED_VERTEX && Verts[i].edges != NULL &&
+        (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
+          {
+          newPts->GetPoint(i, x); //use current points
+          deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
+          for (j=0; j<npts; j++)
+            {
+            newPts->GetPoint(Verts[i].edges->GetId(j), y);
+            for (k=0; k<3; k++)
+              {
+              deltaX[k] += (y[k] - x[k]) / npts;
+              }
+            }//for all connected points
+
+          for (k=0;k<3;k++)
+            {
+            xNew[k] = x[k] + factor * deltaX[k];
+            }
+
+          // Constrain point to surface
+          if ( source )
+            {
+              int movepoint = 0;
+              if (this->ConstrainAllPoints == 0)
+              {
+                if (Verts[i].constrain == 0)
+                  movepoint = 1;
+              }
+              else
+                movepoint = 1;
+
+              if (movepoint)
+              {
+              vtkSmoothPoint *sPtr = this->SmoothPoints->GetSmoothPoint(i);
+
+              // Walk from the last triangle of the point
+              sPtr->cellId = projector->ProjectPoint(xNew, sPtr->cellId,
+                                                     closestPt, dist2);
+              for (k=0; k<3; k++)
+                {
+                xNew[k] = closestPt[k];
+                }
+              }
+            }
+
+          newPts->SetPoint(i,xNew);
+          if ( (dist = vtkMath::Norm(deltaX)) > maxDist )
+            {
+            maxDist = dist;
+            }
+          }//if can move point
+        }//for all points
+      } //for not converged or within iteration count
+    }
 
   vtkDebugMacro(<<"Performed " << iterationNumber << " smoothing passes");
   if ( source )
     {
-    cellLocator->Delete();
     delete this->SmoothPoints;
-    delete [] w;
     }
 
   // Update output. Only point coordinates have changed.
@@ -807,7 +1297,7 @@ int vtkSVLocalSmoothPolyDataFilter::RequestData(
     }
   delete [] Verts;
 
-  return SV_OK;
+  return smoothStatus;
 }
 
 int vtkSVLocalSmoothPolyDataFilter::FillInputPortInformation(int port,
@@ -838,6 +1328,10 @@ void vtkSVLocalSmoothPolyDataFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Boundary Smoothing: " << (this->BoundarySmoothing ? "On\n" : "Off\n");
   os << indent << "Generate Error Scalars: " << (this->GenerateErrorScalars ? "On\n" : "Off\n");
   os << indent << "Generate Error Vectors: " << (this->GenerateErrorVectors ? "On\n" : "Off\n");
+  os << indent << "Use Jacobi Iteration: " << (this->UseJacobiIteration ? "On\n" : "Off\n");
+  os << indent << "Use Implicit Smoothing: " << (this->UseImplicitSmoothing ? "On\n" : "Off\n");
+  os << indent << "Implicit Time Step: " << this->ImplicitTimeStep << "\n";
+  os << indent << "Use Bi-Laplacian: " << (this->UseBiLaplacian ? "On\n" : "Off\n");
   if ( this->GetSource() )
     {
       os << indent << "Source: " << static_cast<void *>(this->GetSource()) << "\n";
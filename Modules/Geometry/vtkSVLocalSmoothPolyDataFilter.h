@@ -232,6 +232,44 @@ public:
   vtkGetMacro(ConstrainAllPoints,int);
   vtkBooleanMacro(ConstrainAllPoints,int);
 
+  // Description:
+  // Turn on/off Jacobi iteration. If on, every pass computes the new point
+  // coordinates from the coordinates of the previous pass only, and the
+  // points are moved in parallel. If off, points are moved one after the
+  // other and later points see the moves of earlier ones. Fixed points and
+  // the smooth and constrain arrays are handled the same in both cases.
+  // Jacobi iteration usually needs a few more passes to converge. Default off.
+  vtkSetMacro(UseJacobiIteration,int);
+  vtkGetMacro(UseJacobiIteration,int);
+  vtkBooleanMacro(UseJacobiIteration,int);
+
+  // Description:
+  // Turn on/off implicit smoothing. If on, every iteration is one backward
+  // Euler step that solves (I + ImplicitTimeStep*U) x = x0 for all points
+  // that can move, with U the same average of the connected vertices used
+  // by the explicit passes. The sparse matrix is factored once and used for
+  // all iterations, so a few iterations do the work of many explicit
+  // passes. Fixed points, points fixed by the smooth arrays, and neighbors
+  // that do not list a point back keep their position from the start of the
+  // step. The relaxation factor is not used. Default off.
+  vtkSetMacro(UseImplicitSmoothing,int);
+  vtkGetMacro(UseImplicitSmoothing,int);
+  vtkBooleanMacro(UseImplicitSmoothing,int);
+
+  // Description:
+  // Specify the time step of implicit smoothing. Larger steps smooth more.
+  // Default 1.0.
+  vtkSetClampMacro(ImplicitTimeStep,double,0.0,VTK_DOUBLE_MAX);
+  vtkGetMacro(ImplicitTimeStep,double);
+
+  // Description:
+  // Turn on/off the bi-Laplacian for implicit smoothing. If on, the steps
+  // solve (I + ImplicitTimeStep*U*U) x = x0, which removes high frequencies
+  // with less shrinkage of the surface. Default off.
+  vtkSetMacro(UseBiLaplacian,int);
+  vtkGetMacro(UseBiLaplacian,int);
+  vtkBooleanMacro(UseBiLaplacian,int);
+
 protected:
   vtkSVLocalSmoothPolyDataFilter();
   ~vtkSVLocalSmoothPolyDataFilter();
@@ -262,6 +300,10 @@ protected:
   int GenerateErrorScalars;
   int GenerateErrorVectors;
   int OutputPointsPrecision;
+  int UseJacobiIteration;
+  int UseImplicitSmoothing;
+  double ImplicitTimeStep;
+  int UseBiLaplacian;
 
   vtkSVLocalSmoothPoints *SmoothPoints;
 private:
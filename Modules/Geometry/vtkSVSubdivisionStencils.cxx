@@ -0,0 +1,204 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVSubdivisionStencils.h"
+
+#include "vtkIdList.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+
+#include "vtkSVGlobals.h"
+
+// ----------------------
+// EvaluateFunctor
+// ----------------------
+/* Computes the positions of a range of stencils. Every stencil writes its
+ * own point, so the points are preallocated and only SetPoint is used. */
+class vtkSVSubdivisionStencils::EvaluateFunctor
+{
+public:
+  const vtkSVSubdivisionStencils *Stencils;
+  vtkPoints *InputPoints;
+  vtkPoints *OutputPoints;
+  vtkIdType FirstId;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType npts;
+    const vtkIdType *ids;
+    const double *weights;
+    double x[3], xx[3];
+    for (vtkIdType i=begin; i<end; i++)
+    {
+      this->Stencils->GetStencil(i, npts, ids, weights);
+      x[0] = x[1] = x[2] = 0.0;
+      for (vtkIdType j=0; j<npts; j++)
+      {
+        this->InputPoints->GetPoint(ids[j], xx);
+        x[0] += xx[0] * weights[j];
+        x[1] += xx[1] * weights[j];
+        x[2] += xx[2] * weights[j];
+      }
+      this->OutputPoints->SetPoint(this->FirstId + i, x);
+    }
+  }
+};
+
+// ----------------------
+// StandardNewMacro
+// ----------------------
+vtkStandardNewMacro(vtkSVSubdivisionStencils);
+
+// ----------------------
+// Constructor
+// ----------------------
+vtkSVSubdivisionStencils::vtkSVSubdivisionStencils()
+{
+  this->Offsets.push_back(0);
+}
+
+// ----------------------
+// Destructor
+// ----------------------
+vtkSVSubdivisionStencils::~vtkSVSubdivisionStencils()
+{
+}
+
+// ----------------------
+// PrintSelf
+// ----------------------
+void vtkSVSubdivisionStencils::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Number of stencils: " << this->GetNumberOfStencils() << "\n";
+  os << indent << "Number of entries: " << this->Ids.size() << "\n";
+}
+
+// ----------------------
+// Allocate
+// ----------------------
+void vtkSVSubdivisionStencils::Allocate(const vtkIdType numStencils,
+                                        const vtkIdType numEntries)
+{
+  this->Reset();
+  this->Offsets.reserve(numStencils+1);
+  this->Ids.reserve(numEntries);
+  this->Weights.reserve(numEntries);
+}
+
+// ----------------------
+// Reset
+// ----------------------
+void vtkSVSubdivisionStencils::Reset()
+{
+  this->Offsets.clear();
+  this->Offsets.push_back(0);
+  this->Ids.clear();
+  this->Weights.clear();
+}
+
+// ----------------------
+// InsertNextStencil
+// ----------------------
+vtkIdType vtkSVSubdivisionStencils::InsertNextStencil(const vtkIdType npts,
+                                                      const vtkIdType *ids,
+                                                      const double *weights)
+{
+  this->Ids.insert(this->Ids.end(), ids, ids + npts);
+  this->Weights.insert(this->Weights.end(), weights, weights + npts);
+  this->Offsets.push_back(this->Ids.size());
+  return this->GetNumberOfStencils() - 1;
+}
+
+// ----------------------
+// InsertNextStencil
+// ----------------------
+vtkIdType vtkSVSubdivisionStencils::InsertNextStencil(vtkIdList *ids,
+                                                      const double *weights)
+{
+  return this->InsertNextStencil(ids->GetNumberOfIds(), ids->GetPointer(0),
+                                 weights);
+}
+
+// ----------------------
+// EvaluatePoints
+// ----------------------
+void vtkSVSubdivisionStencils::EvaluatePoints(vtkPoints *inputPts,
+                                              vtkPoints *outputPts,
+                                              const vtkIdType firstId) const
+{
+  vtkIdType numStencils = this->GetNumberOfStencils();
+  if (outputPts->GetNumberOfPoints() < firstId + numStencils)
+  {
+    outputPts->SetNumberOfPoints(firstId + numStencils);
+  }
+
+  EvaluateFunctor evaluator;
+  evaluator.Stencils     = this;
+  evaluator.InputPoints  = inputPts;
+  evaluator.OutputPoints = outputPts;
+  evaluator.FirstId      = firstId;
+  vtkSMPTools::For(0, numStencils, evaluator);
+  outputPts->Modified();
+}
+
+// ----------------------
+// InterpolatePointData
+// ----------------------
+void vtkSVSubdivisionStencils::InterpolatePointData(vtkPointData *inputPD,
+                                                    vtkPointData *outputPD,
+                                                    const vtkIdType firstId) const
+{
+  vtkNew(vtkIdList, stencil);
+  vtkIdType npts;
+  const vtkIdType *ids;
+  const double *weights;
+  for (vtkIdType i=0; i<this->GetNumberOfStencils(); i++)
+  {
+    this->GetStencil(i, npts, ids, weights);
+    if (npts == 1 && weights[0] == 1.0)
+    {
+      outputPD->CopyData(inputPD, ids[0], firstId + i);
+      continue;
+    }
+    stencil->SetNumberOfIds(npts);
+    for (vtkIdType j=0; j<npts; j++)
+    {
+      stencil->SetId(j, ids[j]);
+    }
+    outputPD->InterpolatePoint(inputPD, firstId + i, stencil,
+                               const_cast<double *>(weights));
+  }
+}
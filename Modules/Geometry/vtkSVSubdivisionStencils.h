@@ -0,0 +1,121 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class vtkSVSubdivisionStencils
+ *  \brief Flat table of the stencils of the points of one subdivision level.
+ *
+ *  Stencil i gives new point firstId + i as a weighted sum of points of the
+ *  previous level. The point ids and weights of all stencils are kept in
+ *  two arrays with an offset per stencil, so a level is described without
+ *  a vtkIdList per point. Positions are evaluated in parallel with
+ *  vtkSMPTools once all stencils of a level are in the table; point data
+ *  is interpolated serially because vtkPointData is not safe to write from
+ *  several threads.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVSubdivisionStencils_h
+#define vtkSVSubdivisionStencils_h
+
+#include "vtkObject.h"
+#include "vtkSVGeometryModule.h" // For export
+
+#include <vector>
+
+class vtkIdList;
+class vtkPointData;
+class vtkPoints;
+
+class VTKSVGEOMETRY_EXPORT vtkSVSubdivisionStencils : public vtkObject
+{
+public:
+  static vtkSVSubdivisionStencils *New();
+  vtkTypeMacro(vtkSVSubdivisionStencils,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// \brief Empty the table and reserve space for the given number of
+  /// stencils and of entries over all stencils.
+  void Allocate(const vtkIdType numStencils, const vtkIdType numEntries);
+
+  /// \brief Empty the table.
+  void Reset();
+
+  //@{
+  /// \brief Add a stencil at the end of the table and return its index.
+  vtkIdType InsertNextStencil(const vtkIdType npts, const vtkIdType *ids,
+                              const double *weights);
+  vtkIdType InsertNextStencil(vtkIdList *ids, const double *weights);
+  //@}
+
+  /// \brief Number of stencils in the table.
+  vtkIdType GetNumberOfStencils() const {return this->Offsets.size() - 1;}
+
+  /// \brief Point ids and weights of a stencil.
+  void GetStencil(const vtkIdType stencilId, vtkIdType &npts,
+                  const vtkIdType *&ids, const double *&weights) const
+  {
+    npts    = this->Offsets[stencilId+1] - this->Offsets[stencilId];
+    ids     = this->Ids.data() + this->Offsets[stencilId];
+    weights = this->Weights.data() + this->Offsets[stencilId];
+  }
+
+  /// \brief Set the positions of points firstId to firstId + number of
+  /// stencils - 1 of outputPts from inputPts. outputPts is grown if it is
+  /// too small. The points are evaluated in parallel.
+  void EvaluatePoints(vtkPoints *inputPts, vtkPoints *outputPts,
+                      const vtkIdType firstId) const;
+
+  /// \brief Interpolate the point data of the same points. A stencil with a
+  /// single point of weight one copies the data of that point.
+  void InterpolatePointData(vtkPointData *inputPD, vtkPointData *outputPD,
+                            const vtkIdType firstId) const;
+
+protected:
+  vtkSVSubdivisionStencils();
+  ~vtkSVSubdivisionStencils();
+
+  class EvaluateFunctor;
+
+  std::vector<vtkIdType> Offsets; // start of each stencil in Ids and Weights
+  std::vector<vtkIdType> Ids;     // point ids of all stencils
+  std::vector<double>    Weights; // weights of all stencils
+
+private:
+  vtkSVSubdivisionStencils(const vtkSVSubdivisionStencils&);  // Not implemented.
+  void operator=(const vtkSVSubdivisionStencils&);  // Not implemented.
+};
+
+#endif  // vtkSVSubdivisionStencils_h
@@ -0,0 +1,409 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVSurfaceProjector.h"
+
+#include "vtkCellArray.h"
+#include "vtkMath.h"
+#include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSVBoundingBoxTree.h"
+#include "vtkSVGlobals.h"
+
+#include <algorithm>
+
+namespace
+{
+// ----------------------
+// TriangleEdge
+// ----------------------
+/* Edge of a triangle with the point ids in increasing order */
+struct TriangleEdge
+{
+  vtkIdType Pt0;
+  vtkIdType Pt1;
+  vtkIdType TriangleId;
+  int Edge;
+
+  bool operator<(const TriangleEdge &other) const
+  {
+    if (this->Pt0 != other.Pt0)
+      return this->Pt0 < other.Pt0;
+    if (this->Pt1 != other.Pt1)
+      return this->Pt1 < other.Pt1;
+    return this->TriangleId < other.TriangleId;
+  }
+
+  bool SamePoints(const TriangleEdge &other) const
+  {
+    return this->Pt0 == other.Pt0 && this->Pt1 == other.Pt1;
+  }
+};
+}
+
+// ----------------------
+// StandardNewMacro
+// ----------------------
+vtkStandardNewMacro(vtkSVSurfaceProjector);
+
+// ----------------------
+// Constructor
+// ----------------------
+vtkSVSurfaceProjector::vtkSVSurfaceProjector()
+{
+  this->MaximumWalkSteps = 64;
+  this->Tree = vtkSVBoundingBoxTree::New();
+}
+
+// ----------------------
+// Destructor
+// ----------------------
+vtkSVSurfaceProjector::~vtkSVSurfaceProjector()
+{
+  if (this->Tree != NULL)
+  {
+    this->Tree->Delete();
+    this->Tree = NULL;
+  }
+}
+
+// ----------------------
+// PrintSelf
+// ----------------------
+void vtkSVSurfaceProjector::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Maximum walk steps: " << this->MaximumWalkSteps << "\n";
+  os << indent << "Number of triangles: " << this->GetNumberOfTriangles() << "\n";
+}
+
+// ----------------------
+// Build
+// ----------------------
+int vtkSVSurfaceProjector::Build(vtkPolyData *surface)
+{
+  this->Points.clear();
+  this->Triangles.clear();
+  this->TriangleCellIds.clear();
+  this->Neighbors.clear();
+  this->PointTriangleOffsets.clear();
+  this->PointTriangleIds.clear();
+  this->Tree->Initialize();
+
+  if (surface == NULL || surface->GetPoints() == NULL ||
+      surface->GetNumberOfPolys() == 0)
+  {
+    vtkErrorMacro("Surface has no polygons to project onto");
+    return SV_ERROR;
+  }
+
+  vtkIdType numPts = surface->GetNumberOfPoints();
+  this->Points.resize(3*numPts);
+  for (vtkIdType i=0; i<numPts; i++)
+    surface->GetPoint(i, &this->Points[3*i]);
+
+  // Polygons come after verts and lines in the cell ids of vtkPolyData
+  vtkIdType cellId = surface->GetNumberOfVerts() + surface->GetNumberOfLines();
+  vtkIdType npts, *pts;
+  vtkCellArray *polys = surface->GetPolys();
+  this->Triangles.reserve(3*polys->GetNumberOfCells());
+  this->TriangleCellIds.reserve(polys->GetNumberOfCells());
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts); cellId++)
+  {
+    for (vtkIdType j=1; j<npts-1; j++)
+    {
+      this->Triangles.push_back(pts[0]);
+      this->Triangles.push_back(pts[j]);
+      this->Triangles.push_back(pts[j+1]);
+      this->TriangleCellIds.push_back(cellId);
+    }
+  }
+  vtkIdType numTriangles = this->TriangleCellIds.size();
+  if (numTriangles == 0)
+  {
+    vtkErrorMacro("Surface has no polygons to project onto");
+    return SV_ERROR;
+  }
+
+  // Neighbors across edges from sorted edges
+  std::vector<TriangleEdge> edges(3*numTriangles);
+  for (vtkIdType i=0; i<numTriangles; i++)
+  {
+    for (int j=0; j<3; j++)
+    {
+      vtkIdType p0 = this->Triangles[3*i+j];
+      vtkIdType p1 = this->Triangles[3*i+(j+1)%3];
+      TriangleEdge &edge = edges[3*i+j];
+      edge.Pt0 = svminimum(p0, p1);
+      edge.Pt1 = svmaximum(p0, p1);
+      edge.TriangleId = i;
+      edge.Edge = j;
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  this->Neighbors.assign(3*numTriangles, -1);
+  for (size_t begin=0, end=0; begin<edges.size(); begin=end)
+  {
+    for (end=begin+1; end<edges.size() && edges[end].SamePoints(edges[begin]); end++)
+      ;
+    if (end - begin == 2)
+    {
+      this->Neighbors[3*edges[begin].TriangleId+edges[begin].Edge] = edges[begin+1].TriangleId;
+      this->Neighbors[3*edges[begin+1].TriangleId+edges[begin+1].Edge] = edges[begin].TriangleId;
+    }
+    else if (end - begin > 2)
+    {
+      for (size_t k=begin; k<end; k++)
+        this->Neighbors[3*edges[k].TriangleId+edges[k].Edge] = -2;
+    }
+  }
+
+  // Triangles around each point
+  this->PointTriangleOffsets.assign(numPts+1, 0);
+  for (vtkIdType i=0; i<3*numTriangles; i++)
+    this->PointTriangleOffsets[this->Triangles[i]+1]++;
+  for (vtkIdType i=0; i<numPts; i++)
+    this->PointTriangleOffsets[i+1] += this->PointTriangleOffsets[i];
+  this->PointTriangleIds.resize(3*numTriangles);
+  std::vector<vtkIdType> fill(this->PointTriangleOffsets.begin(),
+                              this->PointTriangleOffsets.end()-1);
+  for (vtkIdType i=0; i<3*numTriangles; i++)
+    this->PointTriangleIds[fill[this->Triangles[i]]++] = i/3;
+
+  // Tree over the triangle bounds
+  std::vector<double> bounds(6*numTriangles);
+  for (vtkIdType i=0; i<numTriangles; i++)
+  {
+    double *box = &bounds[6*i];
+    for (int k=0; k<3; k++)
+    {
+      box[2*k]   = VTK_DOUBLE_MAX;
+      box[2*k+1] = -VTK_DOUBLE_MAX;
+    }
+    for (int j=0; j<3; j++)
+    {
+      const double *pt = &this->Points[3*this->Triangles[3*i+j]];
+      for (int k=0; k<3; k++)
+      {
+        box[2*k]   = svminimum(box[2*k], pt[k]);
+        box[2*k+1] = svmaximum(box[2*k+1], pt[k]);
+      }
+    }
+  }
+  this->Tree->Build(&bounds[0], numTriangles);
+
+  return SV_OK;
+}
+
+// ----------------------
+// ClosestPointOnTriangle
+// ----------------------
+int vtkSVSurfaceProjector::ClosestPointOnTriangle(const double x[3], const double a[3],
+                                                  const double b[3], const double c[3],
+                                                  double closestPt[3], double &dist2)
+{
+  // Find the region of the triangle the point projects to from the signs
+  // of the dot products with the edges
+  double ab[3], ac[3], ap[3], bp[3], cp[3];
+  for (int i=0; i<3; i++)
+  {
+    ab[i] = b[i] - a[i];
+    ac[i] = c[i] - a[i];
+    ap[i] = x[i] - a[i];
+    bp[i] = x[i] - b[i];
+    cp[i] = x[i] - c[i];
+  }
+  double d1 = vtkMath::Dot(ab, ap);
+  double d2 = vtkMath::Dot(ac, ap);
+  double d3 = vtkMath::Dot(ab, bp);
+  double d4 = vtkMath::Dot(ac, bp);
+  double d5 = vtkMath::Dot(ab, cp);
+  double d6 = vtkMath::Dot(ac, cp);
+
+  int region = 0;
+  double va = d3*d6 - d5*d4;
+  double vb = d5*d2 - d1*d6;
+  double vc = d1*d4 - d3*d2;
+  if (d1 <= 0.0 && d2 <= 0.0)
+  {
+    region = 4;
+    for (int i=0; i<3; i++)
+      closestPt[i] = a[i];
+  }
+  else if (d3 >= 0.0 && d4 <= d3)
+  {
+    region = 5;
+    for (int i=0; i<3; i++)
+      closestPt[i] = b[i];
+  }
+  else if (d6 >= 0.0 && d5 <= d6)
+  {
+    region = 6;
+    for (int i=0; i<3; i++)
+      closestPt[i] = c[i];
+  }
+  else if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+  {
+    region = 1;
+    double t = d1 - d3 > 0.0 ? d1/(d1 - d3) : 0.0;
+    for (int i=0; i<3; i++)
+      closestPt[i] = a[i] + t*ab[i];
+  }
+  else if (va <= 0.0 && d4 - d3 >= 0.0 && d5 - d6 >= 0.0)
+  {
+    region = 2;
+    double denom = (d4 - d3) + (d5 - d6);
+    double t = denom > 0.0 ? (d4 - d3)/denom : 0.0;
+    for (int i=0; i<3; i++)
+      closestPt[i] = b[i] + t*(c[i] - b[i]);
+  }
+  else if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+  {
+    region = 3;
+    double t = d2 - d6 > 0.0 ? d2/(d2 - d6) : 0.0;
+    for (int i=0; i<3; i++)
+      closestPt[i] = a[i] + t*ac[i];
+  }
+  else
+  {
+    double denom = va + vb + vc;
+    double v = denom != 0.0 ? vb/denom : 0.0;
+    double w = denom != 0.0 ? vc/denom : 0.0;
+    for (int i=0; i<3; i++)
+      closestPt[i] = a[i] + v*ab[i] + w*ac[i];
+  }
+
+  dist2 = vtkMath::Distance2BetweenPoints(x, closestPt);
+  return region;
+}
+
+// ----------------------
+// ClosestPoint
+// ----------------------
+int vtkSVSurfaceProjector::ClosestPoint(const vtkIdType triangleId, const double x[3],
+                                        double closestPt[3], double &dist2) const
+{
+  const vtkIdType *tri = &this->Triangles[3*triangleId];
+  return vtkSVSurfaceProjector::ClosestPointOnTriangle(x,
+    &this->Points[3*tri[0]], &this->Points[3*tri[1]], &this->Points[3*tri[2]],
+    closestPt, dist2);
+}
+
+// ----------------------
+// TriangleDistance2
+// ----------------------
+double vtkSVSurfaceProjector::TriangleDistance2(const vtkIdType triangleId,
+                                                const double x[3], void *data)
+{
+  double closestPt[3], dist2;
+  static_cast<vtkSVSurfaceProjector*>(data)->ClosestPoint(triangleId, x, closestPt, dist2);
+  return dist2;
+}
+
+// ----------------------
+// FindClosestPoint
+// ----------------------
+vtkIdType vtkSVSurfaceProjector::FindClosestPoint(const double x[3], double closestPt[3],
+                                                  double &dist2) const
+{
+  vtkIdType triangleId = this->Tree->FindClosestBox(x,
+    vtkSVSurfaceProjector::TriangleDistance2,
+    const_cast<vtkSVSurfaceProjector*>(this), dist2);
+  if (triangleId >= 0)
+    this->ClosestPoint(triangleId, x, closestPt, dist2);
+  return triangleId;
+}
+
+// ----------------------
+// ProjectPoint
+// ----------------------
+vtkIdType vtkSVSurfaceProjector::ProjectPoint(const double x[3], const vtkIdType startTriangle,
+                                              double closestPt[3], double &dist2) const
+{
+  if (startTriangle < 0 || startTriangle >= this->GetNumberOfTriangles())
+    return this->FindClosestPoint(x, closestPt, dist2);
+
+  // Walk to a closer neighbor until the closest point is inside the
+  // triangle, or no neighbor across its edge or around its vertex is closer
+  vtkIdType triangleId = startTriangle;
+  int region = this->ClosestPoint(triangleId, x, closestPt, dist2);
+  for (int step=0; step<this->MaximumWalkSteps; step++)
+  {
+    vtkIdType nextId = -1;
+    double nextDist2 = dist2;
+    if (region == 0)
+    {
+      return triangleId;
+    }
+    else if (region <= 3)
+    {
+      vtkIdType neighborId = this->Neighbors[3*triangleId+region-1];
+      if (neighborId == -1)
+        return triangleId;
+      if (neighborId == -2)
+        break;
+      double neighborPt[3], neighborDist2;
+      this->ClosestPoint(neighborId, x, neighborPt, neighborDist2);
+      if (neighborDist2 < nextDist2)
+      {
+        nextId = neighborId;
+        nextDist2 = neighborDist2;
+      }
+    }
+    else
+    {
+      vtkIdType ptId = this->Triangles[3*triangleId+region-4];
+      for (vtkIdType j=this->PointTriangleOffsets[ptId]; j<this->PointTriangleOffsets[ptId+1]; j++)
+      {
+        vtkIdType neighborId = this->PointTriangleIds[j];
+        if (neighborId == triangleId)
+          continue;
+        double neighborPt[3], neighborDist2;
+        this->ClosestPoint(neighborId, x, neighborPt, neighborDist2);
+        if (neighborDist2 < nextDist2)
+        {
+          nextId = neighborId;
+          nextDist2 = neighborDist2;
+        }
+      }
+    }
+
+    if (nextId == -1)
+      return triangleId;
+
+    triangleId = nextId;
+    region = this->ClosestPoint(triangleId, x, closestPt, dist2);
+  }
+
+  return this->FindClosestPoint(x, closestPt, dist2);
+}
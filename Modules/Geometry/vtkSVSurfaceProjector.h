@@ -0,0 +1,148 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class vtkSVSurfaceProjector
+ *  \brief Projects points onto the closest point of a triangle surface.
+ *
+ *  The points and triangles of the surface are copied into flat arrays
+ *  together with the neighbor of each triangle edge and the triangles
+ *  around each point. A projection starts from a triangle given by the
+ *  caller, usually the triangle the point was projected to last time, and
+ *  walks to neighboring triangles while they are closer. When no start
+ *  triangle is given, the walk can not decide, or it takes too many steps,
+ *  a vtkSVBoundingBoxTree over the triangles is searched instead.
+ *
+ *  Polygons are split into triangle fans and other cells are not used. The
+ *  triangle ids returned can be mapped back to cell ids of the surface with
+ *  GetCellId. Projections only read the arrays after Build, so they can be
+ *  called from several threads at once.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVSurfaceProjector_h
+#define vtkSVSurfaceProjector_h
+
+#include "vtkObject.h"
+#include "vtkSVGeometryModule.h" // For export
+
+#include <vector>
+
+class vtkPolyData;
+class vtkSVBoundingBoxTree;
+
+class VTKSVGEOMETRY_EXPORT vtkSVSurfaceProjector : public vtkObject
+{
+public:
+  static vtkSVSurfaceProjector *New();
+  vtkTypeMacro(vtkSVSurfaceProjector,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  //@{
+  /// \brief Largest number of triangles visited by a walk before the tree
+  /// is searched instead. Default is 64.
+  vtkSetClampMacro(MaximumWalkSteps, int, 0, VTK_INT_MAX);
+  vtkGetMacro(MaximumWalkSteps, int);
+  //@}
+
+  /// \brief Copy the surface and build the tree, SV_ERROR if the surface
+  /// has no polygons.
+  int Build(vtkPolyData *surface);
+
+  /// \brief Closest point on the surface found with the tree. Returns the
+  /// triangle of the closest point, -1 if there are no triangles. dist2 is
+  /// the squared distance to the closest point.
+  vtkIdType FindClosestPoint(const double x[3], double closestPt[3],
+                             double &dist2) const;
+
+  /// \brief Closest point on the surface found by walking from the start
+  /// triangle, with the tree as fall back. Returns the triangle of the
+  /// closest point.
+  vtkIdType ProjectPoint(const double x[3], const vtkIdType startTriangle,
+                         double closestPt[3], double &dist2) const;
+
+  //@{
+  /// \brief Sizes and the cell of the surface a triangle comes from.
+  vtkIdType GetNumberOfTriangles() const {return this->TriangleCellIds.size();}
+  vtkIdType GetCellId(const vtkIdType triangleId) const {return this->TriangleCellIds[triangleId];}
+  //@}
+
+  /// \brief Closest point on the triangle (a, b, c). Returns 0 if the point
+  /// is inside the triangle, 1, 2 or 3 if it is on edge ab, bc or ca, and 4,
+  /// 5 or 6 if it is vertex a, b or c.
+  static int ClosestPointOnTriangle(const double x[3], const double a[3],
+                                    const double b[3], const double c[3],
+                                    double closestPt[3], double &dist2);
+
+protected:
+  vtkSVSurfaceProjector();
+  ~vtkSVSurfaceProjector();
+
+  /// \brief Closest point on a triangle of the copy
+  int ClosestPoint(const vtkIdType triangleId, const double x[3],
+                   double closestPt[3], double &dist2) const;
+
+  /// \brief Squared distance to a triangle for the tree search
+  static double TriangleDistance2(const vtkIdType triangleId,
+                                  const double x[3], void *data);
+
+  int MaximumWalkSteps;
+
+  //@{
+  /// \brief Three coordinates per point and three points per triangle.
+  std::vector<double> Points;
+  std::vector<vtkIdType> Triangles;
+  std::vector<vtkIdType> TriangleCellIds;
+  //@}
+
+  /// \brief Triangle across edges ab, bc and ca of each triangle. -1 on
+  /// boundary edges and -2 on edges with more than two triangles.
+  std::vector<vtkIdType> Neighbors;
+
+  //@{
+  /// \brief Triangles around each point, from PointTriangleOffsets[i] to
+  /// PointTriangleOffsets[i+1] in PointTriangleIds.
+  std::vector<vtkIdType> PointTriangleOffsets;
+  std::vector<vtkIdType> PointTriangleIds;
+  //@}
+
+  vtkSVBoundingBoxTree *Tree;
+
+private:
+  vtkSVSurfaceProjector(const vtkSVSurfaceProjector&);  // Not implemented.
+  void operator=(const vtkSVSurfaceProjector&);  // Not implemented.
+};
+
+#endif  // vtkSVSurfaceProjector_h
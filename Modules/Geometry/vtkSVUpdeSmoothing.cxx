@@ -37,9 +37,11 @@
 #include "vtkPolyData.h"
 #include "vtkCellArray.h"
 #include "vtkFeatureEdges.h"
+#include "vtkIdList.h"
 #include "vtkIntArray.h"
 #include "vtkDoubleArray.h"
 #include "vtkCellData.h"
+#include "vtkCommand.h"
 #include "vtkPointData.h"
 #include "vtkSmartPointer.h"
 #include "vtkSmoothPolyDataFilter.h"
@@ -48,6 +50,9 @@
 #include "vtkGenericCell.h"
 #include "vtkLine.h"
 #include "vtkMath.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkTriangle.h"
 #include "vtkTriangleFilter.h"
 #include "vtkXMLPolyDataWriter.h"
@@ -57,9 +62,94 @@
 #include "vtkSVGlobals.h"
 #include "vtkSVMathUtils.h"
 #include "vtkSVLocalSmoothPolyDataFilter.h"
+#include "vtkSVSurfaceProjector.h"
 
 #include <iostream>
 
+// ----------------------
+// SweepFunctor
+// ----------------------
+/* Optimizes the points of one color. Points of one color share no cell, so
+ * every point only reads the points of its own cells and writes its own
+ * position and its own entries of the arrays. */
+class vtkSVUpdeSmoothing::SweepFunctor
+{
+public:
+  vtkSVUpdeSmoothing *Self;
+  const vtkIdType *PointIds;
+  int Untangle;
+  double MoveStep;
+  vtkDoubleArray *ShapeImproveFunction;
+  vtkDoubleArray *ShapeImproveDirection;
+
+  // Scratch lists and statistics of each thread
+  vtkSMPThreadLocalObject<vtkIdList> AllCapableNeighbors;
+  vtkSMPThreadLocalObject<vtkIdList> CellEdgeNeighbors;
+  vtkSMPThreadLocal<SweepStatistics> Statistics;
+  vtkSMPThreadLocal<int> ThreadFailed;
+
+  // Statistics of all colors so far
+  SweepStatistics Total;
+  int Failed;
+
+  void Initialize()
+  {
+    SweepStatistics &stats = this->Statistics.Local();
+    stats.NumberOfImprovedPoints = 0;
+    stats.NumberOfRejectedPoints = 0;
+    stats.MaximumCondition = 0.0;
+    stats.AverageCondition = 0.0;
+    this->ThreadFailed.Local() = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    SweepStatistics &stats = this->Statistics.Local();
+    int &failed = this->ThreadFailed.Local();
+    vtkIdList *allCapableNeighbors = this->AllCapableNeighbors.Local();
+    vtkIdList *cellEdgeNeighbors = this->CellEdgeNeighbors.Local();
+
+    for (vtkIdType i=begin; i<end && !failed; i++)
+    {
+      if (this->Self->OptimizePoint(this->Untangle, this->PointIds[i],
+                                    this->MoveStep, allCapableNeighbors,
+                                    cellEdgeNeighbors,
+                                    this->ShapeImproveFunction,
+                                    this->ShapeImproveDirection,
+                                    stats) != SV_OK)
+      {
+        failed = 1;
+      }
+    }
+  }
+
+  void Reduce()
+  {
+    // Threads that did no work keep values from earlier colors, so every
+    // value is cleared once it is read
+    vtkSMPThreadLocal<SweepStatistics>::iterator iter;
+    for (iter=this->Statistics.begin(); iter!=this->Statistics.end(); ++iter)
+    {
+      this->Total.NumberOfImprovedPoints += iter->NumberOfImprovedPoints;
+      this->Total.NumberOfRejectedPoints += iter->NumberOfRejectedPoints;
+      this->Total.MaximumCondition = svmaximum(this->Total.MaximumCondition,
+                                               iter->MaximumCondition);
+      this->Total.AverageCondition += iter->AverageCondition;
+      iter->NumberOfImprovedPoints = 0;
+      iter->NumberOfRejectedPoints = 0;
+      iter->MaximumCondition = 0.0;
+      iter->AverageCondition = 0.0;
+    }
+    vtkSMPThreadLocal<int>::iterator failIter;
+    for (failIter=this->ThreadFailed.begin();
+         failIter!=this->ThreadFailed.end(); ++failIter)
+    {
+      this->Failed = this->Failed || *failIter;
+      *failIter = 0;
+    }
+  }
+};
+
 // ----------------------
 // StandardNewMacro
 // ----------------------
@@ -73,7 +163,7 @@ vtkSVUpdeSmoothing::vtkSVUpdeSmoothing()
   this->WorkPd = vtkPolyData::New();
   this->SourcePd = NULL;
 
-  this->CellLocator = vtkCellLocator::New();
+  this->SourceProjector = vtkSVSurfaceProjector::New();
   this->SourceCellNormals = NULL;
   this->SourcePointNormals = NULL;
   this->OriginalCellNormals = NULL;
@@ -86,6 +176,15 @@ vtkSVUpdeSmoothing::vtkSVUpdeSmoothing()
   this->Beta = 0.8;
 
   this->SmoothPointArrayName = NULL;
+
+  this->UseParallelSweeps = 0;
+  this->LastSweepStatistics.Untangling = 0;
+  this->LastSweepStatistics.Sweep = 0;
+  this->LastSweepStatistics.NumberOfImprovedPoints = 0;
+  this->LastSweepStatistics.NumberOfRejectedPoints = 0;
+  this->LastSweepStatistics.MaximumCondition = 0.0;
+  this->LastSweepStatistics.AverageCondition = 0.0;
+  this->LastSweepStatistics.StepSize = 0.0;
 }
 
 // ----------------------
@@ -105,10 +204,10 @@ vtkSVUpdeSmoothing::~vtkSVUpdeSmoothing()
     this->SourcePd = NULL;
   }
 
-  if (this->CellLocator != NULL)
+  if (this->SourceProjector != NULL)
   {
-    this->CellLocator->Delete();
-    this->CellLocator = NULL;
+    this->SourceProjector->Delete();
+    this->SourceProjector = NULL;
   }
 
   if (this->SmoothPointArrayName != NULL)
@@ -127,6 +226,7 @@ void vtkSVUpdeSmoothing::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "Number of outer smooth operations: " << this->NumberOfOuterSmoothOperations << "\n";
   os << indent << "Number of inner smooth operations: " << this->NumberOfInnerSmoothOperations << "\n";
+  os << indent << "Use parallel sweeps: " << this->UseParallelSweeps << "\n";
 }
 
 // ----------------------
@@ -203,12 +303,9 @@ int vtkSVUpdeSmoothing::RequestData(vtkInformation *vtkNotUsed(request),
     //writer->Write();
   }
 
-  // Build locator if source given
+  // Build projector if source given
   if (this->SourcePd != NULL)
   {
-    this->CellLocator->SetDataSet(this->SourcePd);
-    this->CellLocator->BuildLocator();
-
     vtkNew(vtkPolyDataNormals, sNormaler);
     sNormaler->SetInputData(this->SourcePd);
     sNormaler->SplittingOff();
@@ -224,6 +321,14 @@ int vtkSVUpdeSmoothing::RequestData(vtkInformation *vtkNotUsed(request),
       this->SourcePd->GetCellData()->GetArray("Normals");
     this->SourcePointNormals =
       this->SourcePd->GetPointData()->GetArray("Normals");
+
+    if (this->SourceProjector->Build(this->SourcePd) != SV_OK)
+    {
+      vtkErrorMacro("Could not build projector on source surface");
+      return SV_ERROR;
+    }
+    this->SourceTriangles.clear();
+    this->SourceTriangles.resize(numPts, -1);
   }
 
   vtkNew(vtkPolyDataNormals, oNormaler);
@@ -398,7 +503,7 @@ int vtkSVUpdeSmoothing::RequestData(vtkInformation *vtkNotUsed(request),
   }
 
   this->CellPoints.clear();
-  this->CellPoints.resize(numPts);
+  this->CellPoints.resize(numCells);
   vtkIdType npts, *pts;
   for (int i=0; i<numCells; i++)
   {
@@ -409,13 +514,18 @@ int vtkSVUpdeSmoothing::RequestData(vtkInformation *vtkNotUsed(request),
     }
   }
 
+  if (this->UseParallelSweeps)
+  {
+    this->ColorPoints();
+  }
+
   int allGood = 0;
   int maxIters = 1;
   int iter = 0;
 
   while (!allGood && iter < maxIters + 1)
   {
-    fprintf(stdout,"OUTER ITER: %d\n", iter);
+    vtkDebugMacro("OUTER ITER: " << iter);
     allGood = 1;
     if ( this->UntangleSurface(shapeImproveFunction, shapeImproveDirection) != SV_OK)
     {
@@ -479,7 +589,7 @@ int vtkSVUpdeSmoothing::RequestData(vtkInformation *vtkNotUsed(request),
   vtkNew(vtkPolyData, savePd);
   for (int i=0; i<this->NumberOfOuterSmoothOperations; i++)
   {
-    fprintf(stdout,"SMOOTIHNG ITER: %d\n", i);
+    vtkDebugMacro("SMOOTHING ITER: " << i);
     savePd->DeepCopy(tmp);
 
     vtkNew(vtkSVLocalSmoothPolyDataFilter, smoother);
@@ -792,505 +902,645 @@ int vtkSVUpdeSmoothing::RequestData(vtkInformation *vtkNotUsed(request),
 int vtkSVUpdeSmoothing::UntangleSurface(vtkDoubleArray *shapeImproveFunction,
                                         vtkDoubleArray *shapeImproveDirection)
 {
-  int numPolys = this->WorkPd->GetNumberOfPolys();
-  int numPts = this->WorkPd->GetNumberOfPoints();
+  double moveStep = 0.001;
 
-  int pointCellStatus;
-  double pointImprove = 0;
-  double pointImproveDir[3];
-  double testPointImprove = 0;
-  double testPointImproveDir[3];
+  int allGood = 0;
+  int maxIters = 100;
+  int iter = 0;
 
-  int subId;
-  double pt0[3];
-  double normDot;
-  double newPt[3];
-  double normal[3];
-  double sourcePts[3][3];
-  double tangentImproveDir[3];
-  double closestPt[3], distance;
-  vtkIdType closestCellId;
-  vtkNew(vtkGenericCell, genericCell);
+  while(!allGood && iter < maxIters)
+  {
+    // TODO ADJUST FOR NO SOURCE BEING PROVIDED
+    // First make sure there are no inverted points
+    if (this->SweepPoints(1, iter, moveStep, shapeImproveFunction,
+                          shapeImproveDirection) != SV_OK)
+    {
+      return SV_ERROR;
+    }
 
-  vtkIdType nspts, *spts;
-  vtkIdType ntpts, *tpts;
-  vtkNew(vtkIdList, allCapableNeighbors);
-  vtkNew(vtkIdList, cellEdgeNeighbors);
-  double maxBad = 0.0;
-  double avgBad = 0.0;
-  int lesser = 0;
-  int greater = 0;
+    allGood = this->LastSweepStatistics.NumberOfImprovedPoints == 0;
+    iter++;
+  }
 
+  if (!allGood)
+  {
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+// ----------------------
+// SmoothSurface
+// ----------------------
+int vtkSVUpdeSmoothing::SmoothSurface(vtkDoubleArray *shapeImproveFunction,
+                                      vtkDoubleArray *shapeImproveDirection)
+{
   double moveStep = 0.001;
 
   int allGood = 0;
   int maxIters = 100;
   int iter = 0;
 
-  while(!allGood && iter < maxIters)
+  while (!allGood && iter < maxIters)
   {
-    allGood = 1;
+    if (this->SweepPoints(0, iter, moveStep, shapeImproveFunction,
+                          shapeImproveDirection) != SV_OK)
+    {
+      return SV_ERROR;
+    }
 
-    // TODO ADJUST FOR NO SOURCE BEING PROVIDED
-    // First make sure there are no inverted points
-    for (int i=0; i<numPts; i++)
+    SweepStatistics &stats = this->LastSweepStatistics;
+    vtkDebugMacro("ITER " << iter << " MAX CONDITION: " << stats.MaximumCondition <<
+                  ", AVG CONDITION: " << stats.AverageCondition <<
+                  ", STEP SIZE: " << moveStep);
+    vtkDebugMacro("WORSE: " << stats.NumberOfRejectedPoints <<
+                  ", BETTER: " << stats.NumberOfImprovedPoints);
+    if (stats.NumberOfImprovedPoints == 0)
+    {
+      moveStep*=0.1;
+    }
+    if (stats.NumberOfRejectedPoints == 0)
+    {
+      moveStep*=10;
+    }
+    if (moveStep < 1.0e-6)
+      allGood = 1;
+
+    iter++;
+  }
+
+  if (!allGood)
+  {
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+// ----------------------
+// SweepPoints
+// ----------------------
+int vtkSVUpdeSmoothing::SweepPoints(const int untangle, const int sweep,
+                                    const double moveStep,
+                                    vtkDoubleArray *shapeImproveFunction,
+                                    vtkDoubleArray *shapeImproveDirection)
+{
+  int numPts = this->WorkPd->GetNumberOfPoints();
+
+  SweepStatistics &stats = this->LastSweepStatistics;
+  stats.Untangling = untangle;
+  stats.Sweep = sweep;
+  stats.StepSize = moveStep;
+  stats.NumberOfImprovedPoints = 0;
+  stats.NumberOfRejectedPoints = 0;
+  stats.MaximumCondition = 0.0;
+  stats.AverageCondition = 0.0;
+
+  int failed = 0;
+  if (this->UseParallelSweeps)
+  {
+    // The colors are done one after the other, the points of one color all
+    // at once
+    SweepFunctor sweeper;
+    sweeper.Self = this;
+    sweeper.Untangle = untangle;
+    sweeper.MoveStep = moveStep;
+    sweeper.ShapeImproveFunction = shapeImproveFunction;
+    sweeper.ShapeImproveDirection = shapeImproveDirection;
+    sweeper.Total = stats;
+    sweeper.Failed = 0;
+
+    int numColors = this->ColorOffsets.empty() ? 0 : this->ColorOffsets.size() - 1;
+    for (int color=0; color<numColors && !sweeper.Failed; color++)
+    {
+      sweeper.PointIds = &this->ColoredPoints[0] + this->ColorOffsets[color];
+      vtkSMPTools::For(0, this->ColorOffsets[color+1] - this->ColorOffsets[color],
+                       sweeper);
+    }
+    stats = sweeper.Total;
+    failed = sweeper.Failed;
+  }
+  else
+  {
+    vtkNew(vtkIdList, allCapableNeighbors);
+    vtkNew(vtkIdList, cellEdgeNeighbors);
+    for (int i=0; i<numPts && !failed; i++)
     {
       if (this->FixedPoints[i])
       {
         continue;
       }
 
-      pointImprove = 0;
-      for (int j=0; j<3; j++)
+      if (this->OptimizePoint(untangle, i, moveStep, allCapableNeighbors,
+                              cellEdgeNeighbors, shapeImproveFunction,
+                              shapeImproveDirection, stats) != SV_OK)
       {
-        pointImproveDir[j] = 0.0;
+        failed = 1;
       }
+    }
+  }
 
-      this->WorkPd->GetPoint(i, pt0);
+  if (failed)
+  {
+    vtkErrorMacro("Point is technically outside the cell it was found to be closest to");
+    return SV_ERROR;
+  }
 
-      if (this->SourcePd != NULL)
-      {
-        this->CellLocator->FindClosestPoint(pt0, closestPt, genericCell, closestCellId, subId, distance);
+  // Sum of the conditions until here
+  stats.AverageCondition /= numPts;
 
-        pointCellStatus = 0;
-        if (this->PointCellStatus(closestPt, closestCellId, pointCellStatus)  != SV_OK)
-        {
-          vtkErrorMacro("Point is technically outside the cell it was found to be closest to");
-          return SV_ERROR;
-        }
+  this->InvokeEvent(vtkCommand::IterationEvent, &stats);
 
-        this->SourceCellNormals->GetTuple(closestCellId, normal);
-      }
-      else
-      {
-        this->OriginalPointNormals->GetTuple(i, normal);
-      }
+  return SV_OK;
+}
 
-      this->CheckVertexInverted(i, normal, pointImprove, pointImproveDir);
+// ----------------------
+// OptimizePoint
+// ----------------------
+int vtkSVUpdeSmoothing::OptimizePoint(const int untangle, const int ptId,
+                                      const double moveStep,
+                                      vtkIdList *allCapableNeighbors,
+                                      vtkIdList *cellEdgeNeighbors,
+                                      vtkDoubleArray *shapeImproveFunction,
+                                      vtkDoubleArray *shapeImproveDirection,
+                                      SweepStatistics &stats)
+{
+  int better = 0, worse = 0;
+  double pointImprove = 0.0;
+  double tangentImproveDir[3] = {0.0, 0.0, 0.0};
 
-      if (pointImprove != 0.0)
-      {
-        allGood = 0;
+  if (untangle)
+  {
+    if (this->UntanglePoint(ptId, moveStep, pointImprove,
+                            tangentImproveDir) != SV_OK)
+    {
+      return SV_ERROR;
+    }
+    better = pointImprove != 0.0;
+  }
+  else
+  {
+    if (this->SmoothPoint(ptId, moveStep, allCapableNeighbors,
+                          cellEdgeNeighbors, pointImprove,
+                          tangentImproveDir, better, worse) != SV_OK)
+    {
+      return SV_ERROR;
+    }
+  }
 
-        vtkMath::Normalize(pointImproveDir);
-        //vtkMath::MultiplyScalar(pointImproveDir, -1.0);
+  shapeImproveDirection->SetTuple(ptId, tangentImproveDir);
+  shapeImproveFunction->SetTuple1(ptId, pointImprove);
 
-        fprintf(stdout,"MOVING POINT: %d\n", i);
-        fprintf(stdout,"POINT FIX INVERSION DIR: %.6f %.6f %.6f\n", pointImproveDir[0], pointImproveDir[1], pointImproveDir[2]);
+  stats.NumberOfImprovedPoints += better;
+  stats.NumberOfRejectedPoints += worse;
+  if (pointImprove > stats.MaximumCondition)
+    stats.MaximumCondition = pointImprove;
+  stats.AverageCondition += pointImprove;
 
-        //this->SourcePointNormals->GetTuple(i, normal);
-        vtkMath::Normalize(normal);
-        normDot = vtkMath::Dot(pointImproveDir, normal);
+  return SV_OK;
+}
+
+// ----------------------
+// UntanglePoint
+// ----------------------
+int vtkSVUpdeSmoothing::UntanglePoint(const int ptId, const double moveStep,
+                                      double &pointImprove,
+                                      double tangentImproveDir[3])
+{
+  int pointCellStatus;
+  double pointImproveDir[3];
 
-        vtkMath::MultiplyScalar(normal, normDot);
-        //fprintf(stdout,"NORM DOT: %6f\n", normDot);
-        vtkMath::Subtract(pointImproveDir, normal, tangentImproveDir);
-        vtkMath::Normalize(tangentImproveDir);
+  double pt0[3];
+  double normDot;
+  double newPt[3];
+  double normal[3];
+  double closestPt[3], distance;
+  vtkIdType closestCellId;
 
-        vtkMath::MultiplyScalar(tangentImproveDir, moveStep);
-        vtkMath::Add(pt0, tangentImproveDir, newPt);
-        fprintf(stdout,"TANGENT IMP DIR: %.6f %.6f %.6f\n", tangentImproveDir[0], tangentImproveDir[1], tangentImproveDir[2]);
+  pointImprove = 0;
+  for (int j=0; j<3; j++)
+  {
+    pointImproveDir[j] = 0.0;
+  }
 
-        this->WorkPd->GetPoints()->SetPoint(i, newPt);
-        //this->CheckVertexInverted(i, testPointImprove, testPointImproveDir);
+  this->WorkPd->GetPoint(ptId, pt0);
 
-        //if (testPointImprove > pointImprove)
-        //{
-        //  this->WorkPd->GetPoints()->SetPoint(i, pt0);
-        //}
-      }
+  if (this->SourcePd != NULL)
+  {
+    this->SourceTriangles[ptId] = this->SourceProjector->ProjectPoint(pt0, this->SourceTriangles[ptId], closestPt, distance);
+    closestCellId = this->SourceProjector->GetCellId(this->SourceTriangles[ptId]);
 
-      shapeImproveDirection->SetTuple(i, tangentImproveDir);
-      shapeImproveFunction->SetTuple1(i, pointImprove);
+    pointCellStatus = 0;
+    if (this->PointCellStatus(closestPt, closestCellId, pointCellStatus)  != SV_OK)
+    {
+      return SV_ERROR;
     }
-    iter++;
+
+    this->SourceCellNormals->GetTuple(closestCellId, normal);
+  }
+  else
+  {
+    this->OriginalPointNormals->GetTuple(ptId, normal);
   }
 
-  if (!allGood)
+  this->CheckVertexInverted(ptId, normal, pointImprove, pointImproveDir);
+
+  if (pointImprove != 0.0)
   {
-    return SV_ERROR;
+    vtkMath::Normalize(pointImproveDir);
+    //vtkMath::MultiplyScalar(pointImproveDir, -1.0);
+
+    //this->SourcePointNormals->GetTuple(ptId, normal);
+    vtkMath::Normalize(normal);
+    normDot = vtkMath::Dot(pointImproveDir, normal);
+
+    vtkMath::MultiplyScalar(normal, normDot);
+    //fprintf(stdout,"NORM DOT: %6f\n", normDot);
+    vtkMath::Subtract(pointImproveDir, normal, tangentImproveDir);
+    vtkMath::Normalize(tangentImproveDir);
+
+    vtkMath::MultiplyScalar(tangentImproveDir, moveStep);
+    vtkMath::Add(pt0, tangentImproveDir, newPt);
+
+    this->WorkPd->GetPoints()->SetPoint(ptId, newPt);
   }
 
   return SV_OK;
 }
 
 // ----------------------
-// SmoothSurface
+// SmoothPoint
 // ----------------------
-int vtkSVUpdeSmoothing::SmoothSurface(vtkDoubleArray *shapeImproveFunction,
-                                      vtkDoubleArray *shapeImproveDirection)
+int vtkSVUpdeSmoothing::SmoothPoint(const int ptId, const double moveStep,
+                                    vtkIdList *allCapableNeighbors,
+                                    vtkIdList *cellEdgeNeighbors,
+                                    double &pointImprove,
+                                    double tangentImproveDir[3],
+                                    int &better, int &worse)
 {
-  int numPolys = this->WorkPd->GetNumberOfPolys();
-  int numPts = this->WorkPd->GetNumberOfPoints();
-
   int dirWorks;
   int pointCellStatus;
-  int cellId, pointIndex;
-  double pointImprove = 0;
+  int cellId;
   double pointImproveDir[3];
   double testPointImprove = 0;
   double testPointImproveDir[3];
-  double testPt[3];
 
-  int subId;
   int edgeStatus;
   double pt0[3];
   double normDot;
   double newPt[3];
   double normal[3];
-  double smoothPt[3];
-  double sourcePts[3][3];
-  double tangentImproveDir[3];
   double closestPt[3], distance;
   vtkIdType closestCellId;
-  vtkNew(vtkGenericCell, genericCell);
 
   vtkIdType nspts, *spts;
   vtkIdType ntpts, *tpts;
-  vtkNew(vtkIdList, allCapableNeighbors);
-  vtkNew(vtkIdList, cellEdgeNeighbors);
-  double maxBad = 0.0;
-  double avgBad = 0.0;
-  int lesser = 0;
-  int greater = 0;
 
-  double moveStep = 0.001;
-
-  int allGood = 0;
-  int maxIters = 100;
-  int iter = 0;
+  better = 0;
+  worse = 0;
 
-  while (!allGood && iter < maxIters)
+  pointImprove = 0;
+  for (int j=0; j<3; j++)
   {
-    maxBad = 0;
-    avgBad = 0;
-    lesser = 0;
-    greater = 0;
-    for (int i=0; i<numPts; i++)
-    {
-      if (this->FixedPoints[i])
-      {
-        continue;
-      }
-
-      pointImprove = 0;
-      for (int j=0; j<3; j++)
-      {
-        pointImproveDir[j] = 0.0;
-      }
+    pointImproveDir[j] = 0.0;
+  }
 
-      this->ComputeVertexCondition(i, pointImprove, pointImproveDir);
-      vtkMath::Normalize(pointImproveDir);
-      vtkMath::MultiplyScalar(pointImproveDir, -1.0);
+  this->ComputeVertexCondition(ptId, pointImprove, pointImproveDir);
+  vtkMath::Normalize(pointImproveDir);
+  vtkMath::MultiplyScalar(pointImproveDir, -1.0);
 
-      fprintf(stdout,"MOVING POINT: %d\n", i);
-      fprintf(stdout,"POINT IMP DIR: %.6f %.6f %.6f\n", pointImproveDir[0], pointImproveDir[1], pointImproveDir[2]);
 //=============================ONE==========================================
-      if (this->SourcePd == NULL)
-      {
-        vtkMath::MultiplyScalar(pointImproveDir, moveStep);
-        this->WorkPd->GetPoint(i, pt0);
-        vtkMath::Add(pt0, pointImproveDir, newPt);
+  if (this->SourcePd == NULL)
+  {
+    vtkMath::MultiplyScalar(pointImproveDir, moveStep);
+    this->WorkPd->GetPoint(ptId, pt0);
+    vtkMath::Add(pt0, pointImproveDir, newPt);
 
-        this->WorkPd->GetPoints()->SetPoint(i, newPt);
-        this->ComputeVertexCondition(i, testPointImprove, testPointImproveDir);
+    this->WorkPd->GetPoints()->SetPoint(ptId, newPt);
+    this->ComputeVertexCondition(ptId, testPointImprove, testPointImproveDir);
 
-        if (testPointImprove > pointImprove)
-        {
-          this->WorkPd->GetPoints()->SetPoint(i, pt0);
-          greater++;
-        }
-        else
-        {
-          lesser++;
-        }
-      }
+    if (testPointImprove > pointImprove)
+    {
+      this->WorkPd->GetPoints()->SetPoint(ptId, pt0);
+      worse = 1;
+    }
+    else
+    {
+      better = 1;
+    }
+  }
 
 //=============================TWO==========================================
 
-      //this->SourcePointNormals->GetTuple(i, normal);
-      //vtkMath::Normalize(normal);
-      //normDot = vtkMath::Dot(pointImproveDir, normal);
+  //this->SourcePointNormals->GetTuple(i, normal);
+  //vtkMath::Normalize(normal);
+  //normDot = vtkMath::Dot(pointImproveDir, normal);
 
-      //vtkMath::MultiplyScalar(normal, normDot);
-      ////fprintf(stdout,"NORM DOT: %6f\n", normDot);
-      //vtkMath::Subtract(pointImproveDir, normal, tangentImproveDir);
-      //vtkMath::Normalize(tangentImproveDir);
+  //vtkMath::MultiplyScalar(normal, normDot);
+  ////fprintf(stdout,"NORM DOT: %6f\n", normDot);
+  //vtkMath::Subtract(pointImproveDir, normal, tangentImproveDir);
+  //vtkMath::Normalize(tangentImproveDir);
 
-      //vtkMath::MultiplyScalar(tangentImproveDir, moveStep);
-      //this->WorkPd->GetPoint(i, pt0);
-      //vtkMath::Add(pt0, tangentImproveDir, newPt);
-      //fprintf(stdout,"TANGENT IMP DIR: %.6f %.6f %.6f\n", tangentImproveDir[0], tangentImproveDir[1], tangentImproveDir[2]);
+  //vtkMath::MultiplyScalar(tangentImproveDir, moveStep);
+  //this->WorkPd->GetPoint(ptId, pt0);
+  //vtkMath::Add(pt0, tangentImproveDir, newPt);
+  //fprintf(stdout,"TANGENT IMP DIR: %.6f %.6f %.6f\n", tangentImproveDir[0], tangentImproveDir[1], tangentImproveDir[2]);
 
-      //this->WorkPd->GetPoints()->SetPoint(i, newPt);
-      //this->ComputeVertexCondition(i, testPointImprove, testPointImproveDir);
+  //this->WorkPd->GetPoints()->SetPoint(ptId, newPt);
+  //this->ComputeVertexCondition(ptId, testPointImprove, testPointImproveDir);
 
-      //if (testPointImprove > pointImprove)
-      //{
-      //  this->WorkPd->GetPoints()->SetPoint(i, pt0);
-      //  greater++;
-      //}
-      //else
-      //{
-      //  lesser++;
-      //}
+  //if (testPointImprove > pointImprove)
+  //{
+  //  this->WorkPd->GetPoints()->SetPoint(ptId, pt0);
+  //  greater++;
+  //}
+  //else
+  //{
+  //  lesser++;
+  //}
 
 //=============================THREE==========================================
-      else
+  else
+  {
+    // Now time to move point
+    this->WorkPd->GetPoint(ptId, pt0);
+
+    this->SourceTriangles[ptId] = this->SourceProjector->ProjectPoint(pt0, this->SourceTriangles[ptId], closestPt, distance);
+    closestCellId = this->SourceProjector->GetCellId(this->SourceTriangles[ptId]);
+    //fprintf(stdout,"  CLOSEST CELL: %d\n", closestCellId);
+
+    pointCellStatus = 0;
+    if (this->PointCellStatus(closestPt, closestCellId, pointCellStatus)  != SV_OK)
+    {
+      return SV_ERROR;
+    }
+
+    allCapableNeighbors->Reset();
+
+    this->SourcePd->GetCellPoints(closestCellId, nspts, spts);
+
+    // Within cell
+    allCapableNeighbors->InsertNextId(closestCellId);
+
+    // On edges
+    if (pointCellStatus == 1)
+    {
+      cellEdgeNeighbors->Reset();
+      this->SourcePd->GetCellEdgeNeighbors(closestCellId, spts[1], spts[2], cellEdgeNeighbors);
+      for (int k=0; k<cellEdgeNeighbors->GetNumberOfIds(); k++)
       {
-        // Now time to move point
-        this->WorkPd->GetPoint(i, pt0);
+        allCapableNeighbors->InsertNextId(cellEdgeNeighbors->GetId(k));
+      }
+    }
+    if (pointCellStatus == 2)
+    {
+      cellEdgeNeighbors->Reset();
+      this->SourcePd->GetCellEdgeNeighbors(closestCellId, spts[0], spts[2], cellEdgeNeighbors);
+      for (int k=0; k<cellEdgeNeighbors->GetNumberOfIds(); k++)
+      {
+        allCapableNeighbors->InsertNextId(cellEdgeNeighbors->GetId(k));
+      }
+    }
+    if (pointCellStatus == 4)
+    {
+      cellEdgeNeighbors->Reset();
+      this->SourcePd->GetCellEdgeNeighbors(closestCellId, spts[0], spts[1], cellEdgeNeighbors);
+      for (int k=0; k<cellEdgeNeighbors->GetNumberOfIds(); k++)
+      {
+        allCapableNeighbors->InsertNextId(cellEdgeNeighbors->GetId(k));
+      }
+    }
 
-        this->CellLocator->FindClosestPoint(pt0, closestPt, genericCell, closestCellId, subId, distance);
-        //fprintf(stdout,"  CLOSEST CELL: %d\n", closestCellId);
+    // On verts
+    if (pointCellStatus == 3)
+    {
+      // on vertex 2
+      this->SourcePd->GetPointCells(spts[2], allCapableNeighbors);
+    }
 
-        pointCellStatus = 0;
-        if (this->PointCellStatus(closestPt, closestCellId, pointCellStatus)  != SV_OK)
-        {
-          vtkErrorMacro("Point is technically outside the cell it was found to be closest to");
-          return SV_ERROR;
-        }
+    if (pointCellStatus == 5)
+    {
+      // on vertex 1
+      this->SourcePd->GetPointCells(spts[1], allCapableNeighbors);
+    }
 
-        fprintf(stdout,"  POINT CELL STATUS: %d\n", pointCellStatus);
+    if (pointCellStatus == 6)
+    {
+      // on vertex 0
+      this->SourcePd->GetPointCells(spts[0], allCapableNeighbors);
+    }
 
-        allCapableNeighbors->Reset();
+    for (int k=0; k<allCapableNeighbors->GetNumberOfIds(); k++)
+    {
+      cellId = allCapableNeighbors->GetId(k);
+      this->SourcePd->GetCellPoints(cellId, ntpts, tpts);
 
-        this->SourcePd->GetCellPoints(closestCellId, nspts, spts);
+      this->SourceCellNormals->GetTuple(cellId, normal);
+      vtkMath::Normalize(normal);
+      normDot = vtkMath::Dot(pointImproveDir, normal);
 
-        // Within cell
-        allCapableNeighbors->InsertNextId(closestCellId);
+      vtkMath::MultiplyScalar(normal, normDot);
+      vtkMath::Subtract(pointImproveDir, normal, tangentImproveDir);
+      vtkMath::Normalize(tangentImproveDir);
 
-        // On edges
-        if (pointCellStatus == 1)
+      //dirWorks = 0;
+      if (pointCellStatus == 1)
+      {
+        for (int l=0; l<ntpts; l++)
         {
-          fprintf(stdout,"  ON EDGE\n");
-          cellEdgeNeighbors->Reset();
-          this->SourcePd->GetCellEdgeNeighbors(closestCellId, spts[1], spts[2], cellEdgeNeighbors);
-          for (int k=0; k<cellEdgeNeighbors->GetNumberOfIds(); k++)
+          if (tpts[l] == spts[1] || tpts[l] == spts[2])
           {
-            allCapableNeighbors->InsertNextId(cellEdgeNeighbors->GetId(k));
+            if (tpts[(l+1)%ntpts] == spts[1] || tpts[(l+1)%ntpts] == spts[2])
+            {
+              dirWorks = this->MovePointFromEdgeToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
+            }
           }
         }
-        if (pointCellStatus == 2)
+      }
+      else if (pointCellStatus == 2)
+      {
+        for (int l=0; l<ntpts; l++)
         {
-          fprintf(stdout,"  ON EDGE\n");
-          cellEdgeNeighbors->Reset();
-          this->SourcePd->GetCellEdgeNeighbors(closestCellId, spts[0], spts[2], cellEdgeNeighbors);
-          for (int k=0; k<cellEdgeNeighbors->GetNumberOfIds(); k++)
+          if (tpts[l] == spts[0] || tpts[l] == spts[2])
           {
-            allCapableNeighbors->InsertNextId(cellEdgeNeighbors->GetId(k));
+            if (tpts[(l+1)%ntpts] == spts[0] || tpts[(l+1)%ntpts] == spts[2])
+            {
+              dirWorks = this->MovePointFromEdgeToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
+            }
           }
         }
-        if (pointCellStatus == 4)
+      }
+      else if (pointCellStatus == 4)
+      {
+        for (int l=0; l<ntpts; l++)
         {
-          fprintf(stdout,"  ON EDGE\n");
-          cellEdgeNeighbors->Reset();
-          this->SourcePd->GetCellEdgeNeighbors(closestCellId, spts[0], spts[1], cellEdgeNeighbors);
-          for (int k=0; k<cellEdgeNeighbors->GetNumberOfIds(); k++)
+          if (tpts[l] == spts[0] || tpts[l] == spts[1])
           {
-            allCapableNeighbors->InsertNextId(cellEdgeNeighbors->GetId(k));
+            if (tpts[(l+1)%ntpts] == spts[0] || tpts[(l+1)%ntpts] == spts[1])
+            {
+              dirWorks = this->MovePointFromEdgeToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
+            }
           }
         }
-
-        // On verts
-        if (pointCellStatus == 3)
+      }
+      else if (pointCellStatus == 3)
+      {
+        for (int l=0; l<ntpts; l++)
         {
-          // on vertex 2
-          fprintf(stdout,"  ON VERTEX 2\n");
-          this->SourcePd->GetPointCells(spts[2], allCapableNeighbors);
+          if (tpts[l] != spts[2])
+            continue;
+          dirWorks = this->MovePointFromPointToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
         }
-
-        if (pointCellStatus == 5)
+      }
+      else if (pointCellStatus == 5)
+      {
+        for (int l=0; l<ntpts; l++)
         {
-          // on vertex 1
-          fprintf(stdout,"  ON VERTEX 1\n");
-          this->SourcePd->GetPointCells(spts[1], allCapableNeighbors);
+          if (tpts[l] != spts[1])
+            continue;
+          dirWorks = this->MovePointFromPointToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
         }
-
-        if (pointCellStatus == 6)
+      }
+      else if (pointCellStatus == 6)
+      {
+        for (int l=0; l<ntpts; l++)
         {
-          fprintf(stdout,"  ON VERTEX 0\n");
-          // on vertex 0
-          this->SourcePd->GetPointCells(spts[0], allCapableNeighbors);
+          if (tpts[l] != spts[0])
+            continue;
+          dirWorks = this->MovePointFromPointToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
         }
+      }
+      else
+      {
+        dirWorks = this->MovePointToEdge(closestPt, cellId, tangentImproveDir, newPt, edgeStatus);
+      }
 
-        for (int k=0; k<allCapableNeighbors->GetNumberOfIds(); k++)
-        {
-          cellId = allCapableNeighbors->GetId(k);
-          this->SourcePd->GetCellPoints(cellId, ntpts, tpts);
+      if (!dirWorks)
+      {
+        continue;
+      }
 
-          this->SourceCellNormals->GetTuple(cellId, normal);
-          vtkMath::Normalize(normal);
-          normDot = vtkMath::Dot(pointImproveDir, normal);
+      // iterate till get to good spot
+      double segmentLength = vtkSVMathUtils::Distance(closestPt, newPt);
+      double stepSize = segmentLength * 0.001;
+      int numberOfSteps = (int) ceil(segmentLength/stepSize);
+      stepSize = segmentLength /numberOfSteps;
+      double dirLength = 0.0;
 
-          vtkMath::MultiplyScalar(normal, normDot);
-          vtkMath::Subtract(pointImproveDir, normal, tangentImproveDir);
-          vtkMath::Normalize(tangentImproveDir);
+      int m;
+      double newOptDir[3];
+      double funcVal = pointImprove;
+      double newFuncVal;
+      for (m=0; m<numberOfSteps; m++)
+      {
+        dirLength += stepSize;
+        this->MovePointDistance(closestPt, tangentImproveDir, dirLength, newPt);
 
-          fprintf(stdout,"  --------------------TESTING CELL: %d\n", cellId);
-          //dirWorks = 0;
-          if (pointCellStatus == 1)
-          {
-            for (int l=0; l<ntpts; l++)
-            {
-              if (tpts[l] == spts[1] || tpts[l] == spts[2])
-              {
-                if (tpts[(l+1)%ntpts] == spts[1] || tpts[(l+1)%ntpts] == spts[2])
-                {
-                  dirWorks = this->MovePointFromEdgeToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
-                }
-              }
-            }
-          }
-          else if (pointCellStatus == 2)
-          {
-            for (int l=0; l<ntpts; l++)
-            {
-              if (tpts[l] == spts[0] || tpts[l] == spts[2])
-              {
-                if (tpts[(l+1)%ntpts] == spts[0] || tpts[(l+1)%ntpts] == spts[2])
-                {
-                  dirWorks = this->MovePointFromEdgeToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
-                }
-              }
-            }
-          }
-          else if (pointCellStatus == 4)
-          {
-            for (int l=0; l<ntpts; l++)
-            {
-              if (tpts[l] == spts[0] || tpts[l] == spts[1])
-              {
-                if (tpts[(l+1)%ntpts] == spts[0] || tpts[(l+1)%ntpts] == spts[1])
-                {
-                  dirWorks = this->MovePointFromEdgeToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
-                }
-              }
-            }
-          }
-          else if (pointCellStatus == 3)
-          {
-            for (int l=0; l<ntpts; l++)
-            {
-              if (tpts[l] != spts[2])
-                continue;
-              dirWorks = this->MovePointFromPointToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
-            }
-          }
-          else if (pointCellStatus == 5)
-          {
-            for (int l=0; l<ntpts; l++)
-            {
-              if (tpts[l] != spts[1])
-                continue;
-              dirWorks = this->MovePointFromPointToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
-            }
-          }
-          else if (pointCellStatus == 6)
-          {
-            for (int l=0; l<ntpts; l++)
-            {
-              if (tpts[l] != spts[0])
-                continue;
-              dirWorks = this->MovePointFromPointToEdge(closestPt, tpts[l], tpts[(l+1)%ntpts], tpts[(l+2)%ntpts], tangentImproveDir, newPt, edgeStatus);
-            }
-          }
-          else
-          {
-            dirWorks = this->MovePointToEdge(closestPt, cellId, tangentImproveDir, newPt, edgeStatus);
-          }
+        this->WorkPd->GetPoints()->SetPoint(ptId, newPt);
 
-          if (!dirWorks)
-          {
-            fprintf(stdout,"  DIRECTION ON CELL %d DIDNT WORK\n", cellId);
-            continue;
-          }
+        this->ComputeVertexCondition(ptId, newFuncVal, newOptDir);
 
-          fprintf(stdout,"  FOUND CELL IN WHICH PROJECTED DIRECTION LIES: %d\n", cellId);
-          // iterate till get to good spot
-          double segmentLength = vtkSVMathUtils::Distance(closestPt, newPt);
-          fprintf(stdout,  "  CLOSEST POINT: %.6f %.6f %.6f\n", closestPt[0], closestPt[1], closestPt[2]);
-          fprintf(stdout,  "  NEW     POINT: %.6f %.6f %.6f\n", newPt[0], newPt[1], newPt[2]);
-          double stepSize = segmentLength * 0.001;
-          int numberOfSteps = (int) ceil(segmentLength/stepSize);
-          stepSize = segmentLength /numberOfSteps;
-          fprintf(stdout,"  STEP SIZE: %.6f\n", stepSize);
-          double dirLength = 0.0;
-
-          int m;
-          double newOptDir[3];
-          double funcVal = pointImprove;
-          double newFuncVal;
-          for (m=0; m<numberOfSteps; m++)
+        if (newFuncVal > funcVal)
+        {
+          this->WorkPd->GetPoints()->SetPoint(ptId, closestPt);
+          break;
+        }
+        else
+        {
+          funcVal = newFuncVal;
+
+          for (int n=0; n<3; n++)
           {
-            dirLength += stepSize;
-            this->MovePointDistance(closestPt, tangentImproveDir, dirLength, newPt);
+            closestPt[n] = newPt[n];
+          }
+        }
+      }
 
-            this->WorkPd->GetPoints()->SetPoint(i, newPt);
+      if (m > 0)
+      {
+        this->WorkPd->GetPoints()->SetPoint(ptId, closestPt);
+        break;
+      }
+    }
+  }
 
-            this->ComputeVertexCondition(i, newFuncVal, newOptDir);
-            fprintf(stdout,"  INNER STEP %d OF %d; OLD: %.6f, NEW: %.6f\n", m, numberOfSteps, funcVal, newFuncVal);
+  return SV_OK;
+}
 
-            if (newFuncVal > funcVal)
-            {
-              this->WorkPd->GetPoints()->SetPoint(i, closestPt);
-              break;
-            }
-            else
-            {
-              funcVal = newFuncVal;
+// ----------------------
+// ColorPoints
+// ----------------------
+int vtkSVUpdeSmoothing::ColorPoints()
+{
+  int numPts = this->WorkPd->GetNumberOfPoints();
 
-              for (int n=0; n<3; n++)
-              {
-                closestPt[n] = newPt[n];
-              }
-            }
-          }
+  // Greedy coloring in point order. Points that share a cell get different
+  // colors, so the points of one color never read a point that another one
+  // moves. Fixed points are never moved and get no color.
+  std::vector<int> pointColors(numPts, -1);
+  std::vector<int> colorUsedBy;
+  int numColors = 0;
+  for (int i=0; i<numPts; i++)
+  {
+    if (this->FixedPoints[i])
+    {
+      continue;
+    }
 
-          fprintf(stdout,"  NUMBER OF STEPS: %d, OUT OF %d\n", m, numberOfSteps);
-          if (m >= numberOfSteps-1)
-          {
-            fprintf(stdout,"  MADE IT TO EDGE!\n");
-          }
-          if (m > 0)
-          {
-            this->WorkPd->GetPoints()->SetPoint(i, closestPt);
-            break;
-          }
+    for (int j=0; j<this->PointCells[i].size(); j++)
+    {
+      int cellId = this->PointCells[i][j];
+      for (int k=0; k<this->CellPoints[cellId].size(); k++)
+      {
+        int neighborColor = pointColors[this->CellPoints[cellId][k]];
+        if (neighborColor != -1)
+        {
+          colorUsedBy[neighborColor] = i;
         }
       }
-      shapeImproveDirection->SetTuple(i, tangentImproveDir);
-      shapeImproveFunction->SetTuple1(i, pointImprove);
-
-      if (pointImprove > maxBad)
-        maxBad = pointImprove;
-      avgBad += pointImprove;
     }
 
-    avgBad /= numPts;
-    fprintf(stdout,"==========================ITER %d MAX CONDITION: %.6f, AVG CONDITION=======================: %.6f\n", iter, maxBad, avgBad);
-    fprintf(stdout,"==========================================STEP SIZE: %.3e==================================\n", moveStep);
-    //fprintf(stdout,"ITER %d MAX CONDITION: %.6f, AVG CONDITION: %.6f, STEPSIZE: %.6f\n", iter, maxBad, avgBad, moveStep);
-    fprintf(stdout,"WORSE: %d, BETTER: %d\n", greater, lesser);
-    if (lesser == 0)
+    int color = 0;
+    while (color < numColors && colorUsedBy[color] == i)
     {
-      moveStep*=0.1;
+      color++;
     }
-    if (greater == 0)
+    if (color == numColors)
     {
-      moveStep*=10;
+      colorUsedBy.push_back(-1);
+      numColors++;
     }
-    if (moveStep < 1.0e-6)
-      allGood = 1;
+    pointColors[i] = color;
+  }
 
-    iter++;
+  // Points of each color, in point order
+  this->ColorOffsets.assign(numColors+1, 0);
+  for (int i=0; i<numPts; i++)
+  {
+    if (pointColors[i] != -1)
+    {
+      this->ColorOffsets[pointColors[i]+1]++;
+    }
+  }
+  for (int color=0; color<numColors; color++)
+  {
+    this->ColorOffsets[color+1] += this->ColorOffsets[color];
   }
 
-  if (!allGood)
+  this->ColoredPoints.resize(this->ColorOffsets[numColors]);
+  std::vector<vtkIdType> nextPoint(this->ColorOffsets.begin(),
+                                   this->ColorOffsets.end()-1);
+  for (int i=0; i<numPts; i++)
   {
-    return SV_ERROR;
+    if (pointColors[i] != -1)
+    {
+      this->ColoredPoints[nextPoint[pointColors[i]]++] = i;
+    }
   }
 
+  vtkDebugMacro("Colored " << this->ColoredPoints.size() << " points with " << numColors << " colors");
+
   return SV_OK;
 }
 
@@ -1361,8 +1611,6 @@ int vtkSVUpdeSmoothing::CheckVertexInverted(int ptId, double compareNormal[3], d
 
         vertexCondition += f;
 
-        if (f != 0.0)
-          fprintf(stdout,"CELL %d IS FLIPPED\n", cellId);
         this->ComputeUntanglingDerivatives(pts[0], pts[1], pts[2], compareNormal, SV_PI/2.0, df);
 
         vertexCondition += f;
@@ -46,8 +46,14 @@
 
 #include "vtkPolyDataAlgorithm.h"
 #include "vtkSVGeometryModule.h" // for export
-#include "vtkCellLocator.h"
 #include <set>
+#include <vector>
+
+class vtkDataArray;
+class vtkDoubleArray;
+class vtkIdList;
+class vtkIntArray;
+class vtkSVSurfaceProjector;
 
 class VTKSVGEOMETRY_EXPORT vtkSVUpdeSmoothing : public vtkPolyDataAlgorithm
 {
@@ -83,6 +89,34 @@ public:
   vtkGetStringMacro(SmoothPointArrayName);
   //@}
 
+  //@{
+  /// \brief If on, the points are colored so that points of the same color
+  /// share no cell, and the points of each color are untangled and smoothed
+  /// in parallel. The points are visited in a different order than in the
+  /// serial sweep, so the result is not exactly the same. Default: OFF
+  vtkGetMacro(UseParallelSweeps,int);
+  vtkSetMacro(UseParallelSweeps,int);
+  vtkBooleanMacro(UseParallelSweeps,int);
+  //@}
+
+  /// \brief Quality of the surface after one sweep over the points.
+  /// \details After every sweep the filter invokes a
+  /// vtkCommand::IterationEvent with a pointer to these statistics as call
+  /// data, so observers can follow the optimization.
+  struct SweepStatistics
+  {
+    int Untangling;                   // 1 if untangling, 0 if smoothing
+    int Sweep;                        // sweep number in the current pass
+    vtkIdType NumberOfImprovedPoints; // inverted points moved or moves kept
+    vtkIdType NumberOfRejectedPoints; // moves undone as the shape got worse
+    double MaximumCondition;          // largest point condition
+    double AverageCondition;          // average point condition
+    double StepSize;                  // step used in the sweep
+  };
+
+  /// \brief Statistics of the last sweep.
+  const SweepStatistics &GetLastSweepStatistics() const {return this->LastSweepStatistics;}
+
 protected:
   vtkSVUpdeSmoothing();
   ~vtkSVUpdeSmoothing();
@@ -99,6 +133,21 @@ protected:
                       vtkDoubleArray *shapeImproveDirection);
   int SmoothSurface(vtkDoubleArray *shapeImproveFunction,
                     vtkDoubleArray *shapeImproveDirection);
+  int SweepPoints(const int untangle, const int sweep, const double moveStep,
+                  vtkDoubleArray *shapeImproveFunction,
+                  vtkDoubleArray *shapeImproveDirection);
+  int OptimizePoint(const int untangle, const int ptId, const double moveStep,
+                    vtkIdList *allCapableNeighbors, vtkIdList *cellEdgeNeighbors,
+                    vtkDoubleArray *shapeImproveFunction,
+                    vtkDoubleArray *shapeImproveDirection,
+                    SweepStatistics &stats);
+  int UntanglePoint(const int ptId, const double moveStep,
+                    double &pointImprove, double tangentImproveDir[3]);
+  int SmoothPoint(const int ptId, const double moveStep,
+                  vtkIdList *allCapableNeighbors, vtkIdList *cellEdgeNeighbors,
+                  double &pointImprove, double tangentImproveDir[3],
+                  int &better, int &worse);
+  int ColorPoints();
 
   int PointCellStatus(double currentPt[3], int sourceCell, int &pointCellStatus);
   int EdgeStatusWithDir(double currentPt[3], int sourceCell, double moveDir[3], int &edgeStatus) ;
@@ -136,7 +185,7 @@ protected:
   vtkPolyData *WorkPd;
   vtkPolyData *SourcePd;
   vtkIntArray *SmoothPointArray;
-  vtkCellLocator *CellLocator;
+  vtkSVSurfaceProjector *SourceProjector;
 
   vtkDataArray *SourceCellNormals;
   vtkDataArray *SourcePointNormals;
@@ -150,6 +199,18 @@ protected:
   std::vector<std::vector<int> > CellPoints;
   std::vector<int> FixedPoints;
 
+  // Source triangle each point was projected to last, walks start there
+  std::vector<vtkIdType> SourceTriangles;
+
+  // Points that are not fixed sorted by color, with the start of each color
+  int UseParallelSweeps;
+  std::vector<vtkIdType> ColorOffsets;
+  std::vector<vtkIdType> ColoredPoints;
+
+  SweepStatistics LastSweepStatistics;
+
+  class SweepFunctor;
+
 private:
   vtkSVUpdeSmoothing(const vtkSVUpdeSmoothing&);  // Not implemented.
   void operator=(const vtkSVUpdeSmoothing&);  // Not implemented.
@@ -0,0 +1,173 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkPoints.h"
+#include "vtkSVControlGrid.h"
+#include "vtkSVGlobals.h"
+#include "vtkSVNURBSUtils.h"
+
+#include <cmath>
+
+// Weights are powers of two, so scaling by them and back is exact
+static void FillGrid(vtkSVControlGrid *grid, const int dim[3])
+{
+  grid->SetDimensions(dim[0], dim[1], dim[2]);
+  grid->SetNumberOfControlPoints(dim[0]*dim[1]*dim[2]);
+  for (int i=0; i<dim[0]; i++)
+  {
+    for (int j=0; j<dim[1]; j++)
+    {
+      for (int k=0; k<dim[2]; k++)
+      {
+        double w = pow(2.0, (i+2*j+k)%4 - 1);
+        grid->SetControlPoint(i, j, k, 0.1+i, 0.3*j-1.0, 0.7*k+0.2*i, w);
+      }
+    }
+  }
+}
+
+// Compare the buffer with the points and weights of the reference grid
+static int CheckBuffer(vtkSVControlGrid *grid, vtkSVControlGrid *reference)
+{
+  int dim[3];
+  reference->GetDimensions(dim);
+  vtkSVTensorView<double> PW = grid->GetHomogeneousPoints();
+  if (PW.GetShape(0) != dim[0] || PW.GetShape(1) != dim[1] ||
+      PW.GetShape(2) != dim[2] || PW.GetShape(3) != 4)
+  {
+    fprintf(stderr,"Homogeneous buffer does not match the grid dimensions\n");
+    return SV_ERROR;
+  }
+  for (int i=0; i<dim[0]; i++)
+  {
+    for (int j=0; j<dim[1]; j++)
+    {
+      for (int k=0; k<dim[2]; k++)
+      {
+        double pt[3], w;
+        reference->GetControlPoint(i, j, k, pt, w);
+        for (int l=0; l<3; l++)
+        {
+          if (PW(i, j, k, l) != pt[l]*w)
+          {
+            fprintf(stderr,"Homogeneous point %d %d %d is not weighted once\n", i, j, k);
+            return SV_ERROR;
+          }
+        }
+        if (PW(i, j, k, 3) != w)
+        {
+          fprintf(stderr,"Homogeneous weight %d %d %d does not match\n", i, j, k);
+          return SV_ERROR;
+        }
+      }
+    }
+  }
+  return SV_OK;
+}
+
+// Compare the points and weights of two grids
+static int CheckPoints(vtkSVControlGrid *grid, vtkSVControlGrid *reference)
+{
+  int dim[3];
+  reference->GetDimensions(dim);
+  for (int i=0; i<dim[0]; i++)
+  {
+    for (int j=0; j<dim[1]; j++)
+    {
+      for (int k=0; k<dim[2]; k++)
+      {
+        double pt[3], w, refPt[3], refW;
+        grid->GetControlPoint(i, j, k, pt, w);
+        reference->GetControlPoint(i, j, k, refPt, refW);
+        if (pt[0] != refPt[0] || pt[1] != refPt[1] || pt[2] != refPt[2] ||
+            w != refW)
+        {
+          fprintf(stderr,"Control point %d %d %d changed\n", i, j, k);
+          return SV_ERROR;
+        }
+      }
+    }
+  }
+  return SV_OK;
+}
+
+int TestControlGridHomogeneous(int argc, char *argv[])
+{
+  int dim[3] = {4, 3, 2};
+  vtkNew(vtkSVControlGrid, reference);
+  FillGrid(reference, dim);
+  vtkNew(vtkSVControlGrid, grid);
+  FillGrid(grid, dim);
+
+  // Buffer built from the points
+  if (CheckBuffer(grid, reference) != SV_OK)
+    return EXIT_FAILURE;
+
+  // Points changed to Pw in place, the rebuilt buffer is the same
+  vtkSVNURBSUtils::GetPWFromP(grid);
+  if (!grid->GetPointsWeighted())
+  {
+    fprintf(stderr,"Grid does not know its points are weighted\n");
+    return EXIT_FAILURE;
+  }
+  if (CheckBuffer(grid, reference) != SV_OK)
+    return EXIT_FAILURE;
+
+  // Writing the buffer back keeps the points weighted
+  if (grid->UpdateFromHomogeneousPoints() != SV_OK)
+    return EXIT_FAILURE;
+  vtkNew(vtkSVControlGrid, copy);
+  copy->DeepCopy(grid);
+  if (!copy->GetPointsWeighted() || CheckBuffer(copy, reference) != SV_OK)
+  {
+    fprintf(stderr,"Copy of the weighted grid does not match\n");
+    return EXIT_FAILURE;
+  }
+
+  // And back to P, the points are the ones we started with
+  vtkSVNURBSUtils::GetPFromPW(grid);
+  if (grid->GetPointsWeighted() || CheckPoints(grid, reference) != SV_OK)
+    return EXIT_FAILURE;
+  if (CheckBuffer(grid, reference) != SV_OK)
+    return EXIT_FAILURE;
+
+  // Same through a second grid
+  vtkNew(vtkSVControlGrid, PW);
+  vtkNew(vtkSVControlGrid, P);
+  vtkSVNURBSUtils::GetPWFromP(grid, PW);
+  if (CheckBuffer(PW, reference) != SV_OK)
+    return EXIT_FAILURE;
+  vtkSVNURBSUtils::GetPFromPW(PW, P);
+  if (CheckPoints(P, reference) != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkSVGlobals.h"
+#include "vtkSVMathUtils.h"
+#include "vtkSVNURBSCollection.h"
+#include "vtkSVNURBSCurve.h"
+#include "vtkSVNURBSExtraction.h"
+#include "vtkSVNURBSSurface.h"
+#include "vtkSVNURBSUtils.h"
+
+#include <cmath>
+
+// Check that each element operator maps the Bernstein polynomials to the
+// B-spline basis functions that are non-zero on the element
+static int CheckDirection(const vtkSVNURBSExtractionOperators &operators,
+                          const int patch, const vtkIdType element,
+                          const int dir, vtkDoubleArray *knots, const int p)
+{
+  const double *U = knots->GetPointer(0);
+  int span = operators.GetElementSpan(patch, element, dir);
+  vtkSVTensorView<const double> C = operators.GetOperator(
+    operators.GetElementOperatorId(patch, element, dir));
+  if (C.GetShape(0) != p+1)
+    return SV_ERROR;
+
+  std::vector<double> N(p+1);
+  for (int s=0; s<5; s++)
+  {
+    double t = (s+0.5)/5;
+    double u = U[span] + t*(U[span+1]-U[span]);
+    vtkSVNURBSUtils::BasisFunctions(U, p, span, u, &N[0]);
+    for (int i=0; i<=p; i++)
+    {
+      double val = 0.0;
+      for (int k=0; k<=p; k++)
+        val += C(i, k)*vtkSVMathUtils::Binom(p, k)*pow(t, k)*pow(1.0-t, p-k);
+      if (fabs(val - N[i]) > 1.0e-12)
+        return SV_ERROR;
+    }
+  }
+  return SV_OK;
+}
+
+int TestExtractionOperators(int argc, char *argv[])
+{
+  // Surface with circle knots in u and uniform knots in v
+  int p=2;
+  int q=3;
+  vtkNew(vtkDoubleArray, uKnots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, 12, p, uKnots);
+  uKnots->SetTuple1(3, 1./4);
+  uKnots->SetTuple1(4, 1./4);
+  uKnots->SetTuple1(5, 1./2);
+  uKnots->SetTuple1(6, 1./2);
+  uKnots->SetTuple1(7, 3./4);
+  uKnots->SetTuple1(8, 3./4);
+  vtkNew(vtkDoubleArray, vKnots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, 13, q, vKnots);
+
+  vtkNew(vtkSVNURBSSurface, surface);
+  surface->SetUKnotVector(uKnots);
+  surface->SetVKnotVector(vKnots);
+  surface->SetUDegree(p);
+  surface->SetVDegree(q);
+
+  // Curve with the same v knots scaled, its operators are shared
+  vtkNew(vtkDoubleArray, knots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, 13, q, knots);
+  for (int i=0; i<knots->GetNumberOfTuples(); i++)
+    knots->SetTuple1(i, 10.0*knots->GetTuple1(i));
+  vtkNew(vtkSVNURBSCurve, curve);
+  curve->SetKnotVector(knots);
+  curve->SetDegree(q);
+
+  vtkNew(vtkSVNURBSCollection, patches);
+  patches->AddItem(surface);
+  patches->AddItem(curve);
+
+  vtkSVNURBSExtractionOperators operators;
+  if (vtkSVNURBSUtils::ComputeExtractionOperators(patches, operators) != SV_OK)
+    return EXIT_FAILURE;
+
+  // 4 by 6 surface elements and 6 curve elements
+  if (operators.GetNumberOfPatches() != 2 ||
+      operators.GetNumberOfElements(0) != 24 ||
+      operators.GetNumberOfElements(1) != 6)
+  {
+    fprintf(stderr,"Wrong number of elements\n");
+    return EXIT_FAILURE;
+  }
+
+  // Circle spans are all C0 and share one operator, the uniform cubic
+  // spans give five distinct ones, and the curve adds none
+  if (operators.GetNumberOfOperators() != 6)
+  {
+    fprintf(stderr,"Expected 6 unique operators, got %d\n", operators.GetNumberOfOperators());
+    return EXIT_FAILURE;
+  }
+
+  for (vtkIdType e=0; e<24; e++)
+  {
+    if (CheckDirection(operators, 0, e, 0, uKnots, p) != SV_OK ||
+        CheckDirection(operators, 0, e, 1, vKnots, q) != SV_OK)
+    {
+      fprintf(stderr,"Wrong operator for surface element %d\n", (int) e);
+      return EXIT_FAILURE;
+    }
+  }
+  for (vtkIdType e=0; e<6; e++)
+  {
+    if (CheckDirection(operators, 1, e, 0, knots, q) != SV_OK)
+    {
+      fprintf(stderr,"Wrong operator for curve element %d\n", (int) e);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Tensor product of the element in the middle
+  vtkSVTensor<double> C;
+  operators.GetElementOperator(0, 9, C);
+  if (C.GetShape(0) != (p+1)*(q+1) || C.GetShape(1) != (p+1)*(q+1))
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,449 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkDoubleArray.h"
+#include "vtkSVControlGrid.h"
+#include "vtkSVGlobals.h"
+#include "vtkSVNURBSCollection.h"
+#include "vtkSVNURBSCurve.h"
+#include "vtkSVNURBSSurface.h"
+#include "vtkSVNURBSUtils.h"
+#include "vtkSVNURBSVolume.h"
+
+#include <cmath>
+#include <vector>
+
+// Rational curve of degree three with six control points
+static void BuildCurve(vtkSVNURBSCurve *curve)
+{
+  int p=3, np=6;
+  vtkNew(vtkDoubleArray, knots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, p+np+1, p, knots);
+
+  vtkNew(vtkSVControlGrid, grid);
+  grid->SetDimensions(np, 1, 1);
+  grid->SetNumberOfControlPoints(np);
+  grid->SetControlPoint(0, 0, 0, 0.0, 0.0, 0.0, 1.0);
+  grid->SetControlPoint(1, 0, 0, 4.0, 0.0, 0.0, 0.5);
+  grid->SetControlPoint(2, 0, 0, 4.0, -1.0, 0.0, 2.0);
+  grid->SetControlPoint(3, 0, 0, 2.0, -1.0, 1.0, 1.0);
+  grid->SetControlPoint(4, 0, 0, 2.0, 1.0, 0.0, 0.75);
+  grid->SetControlPoint(5, 0, 0, 0.0, 2.0, 0.0, 1.0);
+
+  curve->SetControlPointGrid(grid);
+  curve->SetKnotVector(knots);
+  curve->SetDegree(p);
+}
+
+// Same cylinder as in TestSurfaceKnotRefinement
+static void BuildCylinder(vtkSVNURBSSurface *surface)
+{
+  int p=2, q=1, np=9, mp=2;
+  vtkNew(vtkSVControlGrid, grid);
+  grid->SetDimensions(np, mp, 1);
+  grid->SetNumberOfControlPoints(np*mp);
+  for (int j=0; j<mp; j++)
+  {
+    grid->SetControlPoint(0, j, 0, 1.0, 0.0, j+(j*9), 1.0);
+    grid->SetControlPoint(1, j, 0, 1.0, 1.0, j+(j*9), sqrt(2)/2);
+    grid->SetControlPoint(2, j, 0, 0.0, 1.0, j+(j*9), 1.0);
+    grid->SetControlPoint(3, j, 0, -1.0, 1.0, j+(j*9), sqrt(2)/2);
+    grid->SetControlPoint(4, j, 0, -1.0, 0.0, j+(j*9), 1.0);
+    grid->SetControlPoint(5, j, 0, -1.0, -1.0, j+(j*9), sqrt(2)/2);
+    grid->SetControlPoint(6, j, 0, 0.0, -1.0, j+(j*9), 1.0);
+    grid->SetControlPoint(7, j, 0, 1.0, -1.0, j+(j*9), sqrt(2)/2);
+    grid->SetControlPoint(8, j, 0, 1.0, 0.0, j+(j*9), 1.0);
+  }
+
+  vtkNew(vtkDoubleArray, uKnots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, p+np+1, p, uKnots);
+  uKnots->SetTuple1(3, 1./4);
+  uKnots->SetTuple1(4, 1./4);
+  uKnots->SetTuple1(5, 1./2);
+  uKnots->SetTuple1(6, 1./2);
+  uKnots->SetTuple1(7, 3./4);
+  uKnots->SetTuple1(8, 3./4);
+
+  vtkNew(vtkDoubleArray, vKnots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, q+mp+1, q, vKnots);
+
+  surface->SetControlPointGrid(grid);
+  surface->SetUKnotVector(uKnots);
+  surface->SetVKnotVector(vKnots);
+  surface->SetUDegree(p);
+  surface->SetVDegree(q);
+}
+
+// Rational block with degrees two, one and two
+static void BuildVolume(vtkSVNURBSVolume *volume)
+{
+  int degrees[3] = {2, 1, 2};
+  int dim[3] = {4, 3, 3};
+  vtkNew(vtkSVControlGrid, grid);
+  grid->SetDimensions(dim[0], dim[1], dim[2]);
+  grid->SetNumberOfControlPoints(dim[0]*dim[1]*dim[2]);
+  for (int i=0; i<dim[0]; i++)
+  {
+    for (int j=0; j<dim[1]; j++)
+    {
+      for (int k=0; k<dim[2]; k++)
+      {
+        double w = 1.0 + 0.25*((i+j+2*k)%3);
+        grid->SetControlPoint(i, j, k, i+0.1*j*k, j+0.2*i, k+0.1*i*i, w);
+      }
+    }
+  }
+  volume->SetControlPointGrid(grid);
+
+  vtkNew(vtkDoubleArray, uKnots);
+  vtkNew(vtkDoubleArray, vKnots);
+  vtkNew(vtkDoubleArray, wKnots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, dim[0]+degrees[0]+1, degrees[0], uKnots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, dim[1]+degrees[1]+1, degrees[1], vKnots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, dim[2]+degrees[2]+1, degrees[2], wKnots);
+  volume->SetUKnotVector(uKnots);
+  volume->SetVKnotVector(vKnots);
+  volume->SetWKnotVector(wKnots);
+  volume->SetUDegree(degrees[0]);
+  volume->SetVDegree(degrees[1]);
+  volume->SetWDegree(degrees[2]);
+}
+
+static void GetKnotArray(const std::vector<double> &knots, vtkDoubleArray *array)
+{
+  array->SetNumberOfTuples(knots.size());
+  for (size_t i=0; i<knots.size(); i++)
+    array->SetTuple1(i, knots[i]);
+}
+
+static int CheckKnots(vtkDoubleArray *knots, vtkDoubleArray *reference)
+{
+  if (knots->GetNumberOfTuples() != reference->GetNumberOfTuples())
+  {
+    fprintf(stderr,"Refined knot vector has %d knots, expected %d\n",
+            (int) knots->GetNumberOfTuples(), (int) reference->GetNumberOfTuples());
+    return SV_ERROR;
+  }
+  for (int i=0; i<knots->GetNumberOfTuples(); i++)
+  {
+    if (fabs(knots->GetTuple1(i) - reference->GetTuple1(i)) > 1.0e-12)
+    {
+      fprintf(stderr,"Knot %d is %g, expected %g\n", i, knots->GetTuple1(i),
+              reference->GetTuple1(i));
+      return SV_ERROR;
+    }
+  }
+  return SV_OK;
+}
+
+static int CheckGrids(vtkSVControlGrid *grid, vtkSVControlGrid *reference)
+{
+  int dim[3], refDim[3];
+  grid->GetDimensions(dim);
+  reference->GetDimensions(refDim);
+  if (dim[0] != refDim[0] || dim[1] != refDim[1] || dim[2] != refDim[2])
+  {
+    fprintf(stderr,"Refined grid is %d x %d x %d, expected %d x %d x %d\n",
+            dim[0], dim[1], dim[2], refDim[0], refDim[1], refDim[2]);
+    return SV_ERROR;
+  }
+  for (int i=0; i<dim[0]; i++)
+  {
+    for (int j=0; j<dim[1]; j++)
+    {
+      for (int k=0; k<dim[2]; k++)
+      {
+        double pw[4], refPw[4];
+        grid->GetControlPoint(i, j, k, pw);
+        reference->GetControlPoint(i, j, k, refPw);
+        for (int l=0; l<4; l++)
+        {
+          if (fabs(pw[l] - refPw[l]) > 1.0e-10)
+          {
+            fprintf(stderr,"Control point %d %d %d differs from knot refinement\n",
+                    i, j, k);
+            return SV_ERROR;
+          }
+        }
+      }
+    }
+  }
+  return SV_OK;
+}
+
+// Knot refinement of every fiber of a volume grid in one direction with
+// curves, the reference for the volume refinement
+static int RefineFibers(vtkSVControlGrid *grid, vtkDoubleArray *knots,
+                        const int degree, const int dir,
+                        vtkDoubleArray *insertKnots,
+                        vtkSVControlGrid *newGrid, vtkDoubleArray *newKnots)
+{
+  int dim[3];
+  grid->GetDimensions(dim);
+  int newDim[3] = {dim[0], dim[1], dim[2]};
+  newDim[dir] += insertKnots->GetNumberOfTuples();
+  newGrid->SetDimensions(newDim[0], newDim[1], newDim[2]);
+  newGrid->SetNumberOfControlPoints(newDim[0]*newDim[1]*newDim[2]);
+
+  int d0 = (dir+1)%3, d1 = (dir+2)%3;
+  for (int a=0; a<dim[d0]; a++)
+  {
+    for (int b=0; b<dim[d1]; b++)
+    {
+      int ijk[3];
+      ijk[d0] = a;
+      ijk[d1] = b;
+
+      vtkNew(vtkSVControlGrid, fiber);
+      fiber->SetDimensions(dim[dir], 1, 1);
+      fiber->SetNumberOfControlPoints(dim[dir]);
+      for (int i=0; i<dim[dir]; i++)
+      {
+        double pw[4];
+        ijk[dir] = i;
+        grid->GetControlPoint(ijk[0], ijk[1], ijk[2], pw);
+        fiber->SetControlPoint(i, 0, 0, pw);
+      }
+
+      vtkNew(vtkSVNURBSCurve, curve);
+      curve->SetControlPointGrid(fiber);
+      curve->SetKnotVector(knots);
+      curve->SetDegree(degree);
+      if (curve->InsertKnots(insertKnots) != SV_OK)
+        return SV_ERROR;
+
+      for (int i=0; i<newDim[dir]; i++)
+      {
+        double pw[4];
+        ijk[dir] = i;
+        curve->GetControlPoint(i, pw);
+        newGrid->SetControlPoint(ijk[0], ijk[1], ijk[2], pw);
+      }
+      newKnots->DeepCopy(curve->GetKnotVector());
+    }
+  }
+  return SV_OK;
+}
+
+static int TestCurve()
+{
+  std::vector<double> insertKnots = {0.1, 0.5, 0.5, 0.9};
+  vtkNew(vtkDoubleArray, insertArray);
+  GetKnotArray(insertKnots, insertArray);
+
+  // Knot insertion only
+  vtkNew(vtkSVNURBSCurve, reference);
+  BuildCurve(reference);
+  reference->InsertKnots(insertArray);
+
+  vtkSVNURBSRefinementPlan plan;
+  plan.InsertKnots[0] = insertKnots;
+  vtkNew(vtkSVNURBSCurve, curve);
+  BuildCurve(curve);
+  if (curve->Refine(plan) != SV_OK)
+  {
+    fprintf(stderr,"Curve refinement failed\n");
+    return SV_ERROR;
+  }
+  if (CheckGrids(curve->GetControlPointGrid(), reference->GetControlPointGrid()) != SV_OK ||
+      CheckKnots(curve->GetKnotVector(), reference->GetKnotVector()) != SV_OK)
+    return SV_ERROR;
+  if (curve->GetNumberOfControlPoints() != reference->GetNumberOfControlPoints() ||
+      curve->GetNumberOfKnotPoints() != reference->GetNumberOfKnotPoints() ||
+      curve->GetDegree() != 3)
+  {
+    fprintf(stderr,"Curve counts were not updated by the refinement\n");
+    return SV_ERROR;
+  }
+
+  // Degree elevation, then knot insertion
+  vtkNew(vtkSVNURBSCurve, elevatedReference);
+  BuildCurve(elevatedReference);
+  elevatedReference->IncreaseDegree(2);
+  elevatedReference->InsertKnots(insertArray);
+
+  plan.TargetDegrees[0] = 5;
+  vtkNew(vtkSVNURBSCurve, elevated);
+  BuildCurve(elevated);
+  if (elevated->Refine(plan) != SV_OK)
+  {
+    fprintf(stderr,"Curve refinement with elevation failed\n");
+    return SV_ERROR;
+  }
+  if (CheckGrids(elevated->GetControlPointGrid(), elevatedReference->GetControlPointGrid()) != SV_OK ||
+      CheckKnots(elevated->GetKnotVector(), elevatedReference->GetKnotVector()) != SV_OK)
+    return SV_ERROR;
+  if (elevated->GetDegree() != 5 ||
+      elevated->GetNumberOfControlPoints() != elevatedReference->GetNumberOfControlPoints())
+  {
+    fprintf(stderr,"Curve degree was not updated by the refinement\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestSurface()
+{
+  std::vector<double> uInsert = {0.1, 0.1, 0.3, 0.6};
+  std::vector<double> vInsert = {0.04, 0.33, 0.7, 0.9, 0.9};
+  vtkNew(vtkDoubleArray, uArray);
+  vtkNew(vtkDoubleArray, vArray);
+  GetKnotArray(uInsert, uArray);
+  GetKnotArray(vInsert, vArray);
+
+  vtkNew(vtkSVNURBSSurface, reference);
+  BuildCylinder(reference);
+  reference->IncreaseDegree(1, 1);
+  reference->InsertKnots(uArray, 0);
+  reference->InsertKnots(vArray, 1);
+
+  vtkSVNURBSRefinementPlan plan;
+  plan.TargetDegrees[1] = 2;
+  plan.InsertKnots[0] = uInsert;
+  plan.InsertKnots[1] = vInsert;
+  vtkNew(vtkSVNURBSSurface, surface);
+  BuildCylinder(surface);
+  if (surface->Refine(plan) != SV_OK)
+  {
+    fprintf(stderr,"Surface refinement failed\n");
+    return SV_ERROR;
+  }
+  if (CheckGrids(surface->GetControlPointGrid(), reference->GetControlPointGrid()) != SV_OK ||
+      CheckKnots(surface->GetUKnotVector(), reference->GetUKnotVector()) != SV_OK ||
+      CheckKnots(surface->GetVKnotVector(), reference->GetVKnotVector()) != SV_OK)
+    return SV_ERROR;
+
+  // Counts and degrees are refreshed like after InsertKnots
+  if (surface->GetNumberOfUControlPoints() != reference->GetNumberOfUControlPoints() ||
+      surface->GetNumberOfVControlPoints() != reference->GetNumberOfVControlPoints() ||
+      surface->GetNumberOfUKnotPoints() != reference->GetNumberOfUKnotPoints() ||
+      surface->GetNumberOfVKnotPoints() != reference->GetNumberOfVKnotPoints() ||
+      surface->GetUDegree() != 2 || surface->GetVDegree() != 2)
+  {
+    fprintf(stderr,"Surface counts were not updated by the refinement\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+static int TestCollection()
+{
+  std::vector<double> uInsert = {0.1, 0.3, 0.6};
+  std::vector<double> wInsert = {0.2, 0.2, 0.75};
+  vtkNew(vtkDoubleArray, uArray);
+  vtkNew(vtkDoubleArray, wArray);
+  GetKnotArray(uInsert, uArray);
+  GetKnotArray(wInsert, wArray);
+
+  // References, the surface with InsertKnots and the volume fiber by fiber
+  vtkNew(vtkSVNURBSSurface, surfaceReference);
+  BuildCylinder(surfaceReference);
+  surfaceReference->InsertKnots(uArray, 0);
+
+  vtkNew(vtkSVNURBSVolume, volumeReference);
+  BuildVolume(volumeReference);
+  vtkNew(vtkSVControlGrid, uGrid);
+  vtkNew(vtkSVControlGrid, uwGrid);
+  vtkNew(vtkDoubleArray, uKnots);
+  vtkNew(vtkDoubleArray, wKnots);
+  if (RefineFibers(volumeReference->GetControlPointGrid(),
+                   volumeReference->GetUKnotVector(), 2, 0, uArray,
+                   uGrid, uKnots) != SV_OK ||
+      RefineFibers(uGrid, volumeReference->GetWKnotVector(), 2, 2, wArray,
+                   uwGrid, wKnots) != SV_OK)
+  {
+    fprintf(stderr,"Could not refine the volume fibers\n");
+    return SV_ERROR;
+  }
+
+  // The collection is refined with one plan, the surface ignores w
+  vtkNew(vtkSVNURBSSurface, surface);
+  BuildCylinder(surface);
+  vtkNew(vtkSVNURBSVolume, volume);
+  BuildVolume(volume);
+  vtkNew(vtkSVNURBSCollection, patches);
+  patches->AddItem(surface);
+  patches->AddItem(volume);
+
+  vtkSVNURBSRefinementPlan plan;
+  plan.InsertKnots[0] = uInsert;
+  plan.InsertKnots[2] = wInsert;
+  if (vtkSVNURBSUtils::RefineCollection(patches, plan) != SV_OK)
+  {
+    fprintf(stderr,"Collection refinement failed\n");
+    return SV_ERROR;
+  }
+
+  if (CheckGrids(surface->GetControlPointGrid(), surfaceReference->GetControlPointGrid()) != SV_OK ||
+      CheckKnots(surface->GetUKnotVector(), surfaceReference->GetUKnotVector()) != SV_OK ||
+      surface->GetNumberOfUControlPoints() != surfaceReference->GetNumberOfUControlPoints())
+  {
+    fprintf(stderr,"Surface of the collection does not match knot refinement\n");
+    return SV_ERROR;
+  }
+
+  if (CheckGrids(volume->GetControlPointGrid(), uwGrid) != SV_OK ||
+      CheckKnots(volume->GetUKnotVector(), uKnots) != SV_OK ||
+      CheckKnots(volume->GetVKnotVector(), volumeReference->GetVKnotVector()) != SV_OK ||
+      CheckKnots(volume->GetWKnotVector(), wKnots) != SV_OK)
+  {
+    fprintf(stderr,"Volume of the collection does not match knot refinement\n");
+    return SV_ERROR;
+  }
+  int dim[3];
+  uwGrid->GetDimensions(dim);
+  if (volume->GetNumberOfUControlPoints() != dim[0] ||
+      volume->GetNumberOfVControlPoints() != dim[1] ||
+      volume->GetNumberOfWControlPoints() != dim[2] ||
+      volume->GetNumberOfWKnotPoints() != wKnots->GetNumberOfTuples() ||
+      volume->GetUDegree() != 2 || volume->GetVDegree() != 1 ||
+      volume->GetWDegree() != 2)
+  {
+    fprintf(stderr,"Volume counts were not updated by the refinement\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
+int TestRefinementPlan(int argc, char *argv[])
+{
+  if (TestCurve() != SV_OK)
+    return EXIT_FAILURE;
+  if (TestSurface() != SV_OK)
+    return EXIT_FAILURE;
+  if (TestCollection() != SV_OK)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
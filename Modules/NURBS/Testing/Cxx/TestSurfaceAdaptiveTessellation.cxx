@@ -0,0 +1,126 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtkMath.h"
+
+#include "vtkSVControlGrid.h"
+#include "vtkSVGlobals.h"
+#include "vtkSVNURBSSurface.h"
+#include "vtkSVNURBSUtils.h"
+
+#include <cmath>
+
+int TestSurfaceAdaptiveTessellation(int argc, char *argv[])
+{
+  // Cylinder of radius one, circles in u and lines in v
+  int p=2;
+  int q=1;
+  int np=9;
+  int mp=2;
+
+  vtkNew(vtkSVControlGrid, controlPointGrid);
+  controlPointGrid->SetDimensions(np, mp, 1);
+  controlPointGrid->SetNumberOfControlPoints(np*mp);
+  for (int j=0; j<mp; j++)
+  {
+    controlPointGrid->SetControlPoint(0, j, 0, 1.0, 0.0, (j*9), 1.0);
+    controlPointGrid->SetControlPoint(1, j, 0, 1.0, 1.0, (j*9), sqrt(2)/2);
+    controlPointGrid->SetControlPoint(2, j, 0, 0.0, 1.0, (j*9), 1.0);
+    controlPointGrid->SetControlPoint(3, j, 0, -1.0, 1.0, (j*9), sqrt(2)/2);
+    controlPointGrid->SetControlPoint(4, j, 0, -1.0, 0.0, (j*9), 1.0);
+    controlPointGrid->SetControlPoint(5, j, 0, -1.0, -1.0, (j*9), sqrt(2)/2);
+    controlPointGrid->SetControlPoint(6, j, 0, 0.0, -1.0, (j*9), 1.0);
+    controlPointGrid->SetControlPoint(7, j, 0, 1.0, -1.0, (j*9), sqrt(2)/2);
+    controlPointGrid->SetControlPoint(8, j, 0, 1.0, 0.0, (j*9), 1.0);
+  }
+
+  vtkNew(vtkDoubleArray, uKnots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, p+np+1, p, uKnots);
+  uKnots->SetTuple1(3, 1./4);
+  uKnots->SetTuple1(4, 1./4);
+  uKnots->SetTuple1(5, 1./2);
+  uKnots->SetTuple1(6, 1./2);
+  uKnots->SetTuple1(7, 3./4);
+  uKnots->SetTuple1(8, 3./4);
+  vtkNew(vtkDoubleArray, vKnots);
+  vtkSVNURBSUtils::LinSpaceClamp(0, 1, q+mp+1, q, vKnots);
+
+  vtkNew(vtkSVNURBSSurface, surface);
+  surface->SetControlPointGrid(controlPointGrid);
+  surface->SetUKnotVector(uKnots);
+  surface->SetVKnotVector(vKnots);
+  surface->SetUDegree(p);
+  surface->SetVDegree(q);
+
+  double chordTolerance = 1.0e-3;
+  if (surface->GenerateAdaptivePolyDataRepresentation(chordTolerance, 0.0) != SV_OK)
+    return EXIT_FAILURE;
+  vtkPolyData *mesh = surface->GetSurfaceRepresentation();
+
+  // The straight direction needs no divisions, so there is one row of
+  // cells and two rings of points
+  int numCells  = mesh->GetNumberOfCells();
+  int numPoints = mesh->GetNumberOfPoints();
+  if (numCells == 0 || numPoints != 2*numCells)
+  {
+    fprintf(stderr,"Expected a single row of cells, got %d cells and %d points\n", numCells, numPoints);
+    return EXIT_FAILURE;
+  }
+
+  // All points on the cylinder, and the middle of each cell edge around the
+  // circle within the chord tolerance
+  for (int i=0; i<numPoints; i++)
+  {
+    double pt[3];
+    mesh->GetPoint(i, pt);
+    if (fabs(sqrt(pt[0]*pt[0] + pt[1]*pt[1]) - 1.0) > 1.0e-10)
+    {
+      fprintf(stderr,"Point %d is not on the surface\n", i);
+      return EXIT_FAILURE;
+    }
+  }
+  double edgeLength = 2.0*vtkMath::Pi()/numCells;
+  if (edgeLength*edgeLength/8.0 > 1.5*chordTolerance)
+  {
+    fprintf(stderr,"Chord error is above tolerance with %d cells\n", numCells);
+    return EXIT_FAILURE;
+  }
+
+  // A looser tolerance must give fewer cells
+  surface->GenerateAdaptivePolyDataRepresentation(1.0e-2, 0.0);
+  if (surface->GetSurfaceRepresentation()->GetNumberOfCells() >= numCells)
+  {
+    fprintf(stderr,"Looser tolerance did not reduce the number of cells\n");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
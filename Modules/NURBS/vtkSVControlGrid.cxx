@@ -37,6 +37,7 @@
 #include "vtkPointData.h"
 #include "vtkPoints.h"
 #include "vtkSmartPointer.h"
+#include "vtkStructuredData.h"
 
 #include "vtkSVGlobals.h"
 
@@ -47,6 +48,9 @@ vtkStandardNewMacro(vtkSVControlGrid);
 // ----------------------
 vtkSVControlGrid::vtkSVControlGrid()
 {
+  this->HomogeneousPointsValid = false;
+  this->PointsWeighted = 0;
+
   vtkNew(vtkPoints, internalPoints);
   this->SetPoints(internalPoints);
 
@@ -68,6 +72,8 @@ vtkSVControlGrid::~vtkSVControlGrid()
 void vtkSVControlGrid::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "PointsWeighted: " << this->PointsWeighted << "\n";
 }
 
 // ----------------------
@@ -84,6 +90,31 @@ void vtkSVControlGrid::CopyStructure(vtkDataSet *ds)
 void vtkSVControlGrid::Initialize()
 {
   this->Superclass::Initialize();
+  this->ReleaseHomogeneousPoints();
+}
+
+// ----------------------
+// ShallowCopy
+// ----------------------
+void vtkSVControlGrid::ShallowCopy(vtkDataObject *src)
+{
+  this->Superclass::ShallowCopy(src);
+  this->ReleaseHomogeneousPoints();
+
+  vtkSVControlGrid *grid = vtkSVControlGrid::SafeDownCast(src);
+  this->PointsWeighted = grid ? grid->GetPointsWeighted() : 0;
+}
+
+// ----------------------
+// DeepCopy
+// ----------------------
+void vtkSVControlGrid::DeepCopy(vtkDataObject *src)
+{
+  this->Superclass::DeepCopy(src);
+  this->ReleaseHomogeneousPoints();
+
+  vtkSVControlGrid *grid = vtkSVControlGrid::SafeDownCast(src);
+  this->PointsWeighted = grid ? grid->GetPointsWeighted() : 0;
 }
 
 // ----------------------
@@ -117,6 +148,7 @@ int vtkSVControlGrid::SetNumberOfControlPoints(const int numPoints)
   int numCurrentVals = weights->GetNumberOfTuples();
   if (numPoints > numCurrentVals)
     weights->SetNumberOfTuples(numPoints);
+  this->HomogeneousPointsValid = false;
   return SV_OK;
 }
 
@@ -130,6 +162,7 @@ int vtkSVControlGrid::SetControlPoint(const int i, const int j, const int k, con
   this->GetPointId(i, j, k, ptId);
   this->GetPoints()->SetPoint(ptId, pt);
   this->GetPointData()->GetArray("Weights")->InsertTuple1(ptId, w);
+  this->HomogeneousPointsValid = false;
 
   return SV_OK;
 }
@@ -144,6 +177,7 @@ int vtkSVControlGrid::SetControlPoint(const int i, const int j, const int k, con
   this->GetPointId(i, j, k, ptId);
   this->GetPoints()->SetPoint(ptId, p);
   this->GetPointData()->GetArray("Weights")->InsertTuple1(ptId, w);
+  this->HomogeneousPointsValid = false;
 
   return SV_OK;
 }
@@ -294,3 +328,189 @@ int vtkSVControlGrid::GetPointId(const int i, const int j, const int k)
   int ptId = vtkStructuredData::ComputePointIdForExtent(extent, pos);
   return ptId;
 }
+
+// ----------------------
+// BuildHomogeneousPoints
+// ----------------------
+int vtkSVControlGrid::BuildHomogeneousPoints()
+{
+  int dim[3];
+  this->GetDimensions(dim);
+
+  if (this->HomogeneousPointsValid &&
+      this->GetMTime() <= this->HomogeneousBuildTime &&
+      this->HomogeneousPoints.GetShape(0) == dim[0] &&
+      this->HomogeneousPoints.GetShape(1) == dim[1] &&
+      this->HomogeneousPoints.GetShape(2) == dim[2])
+  {
+    return SV_OK;
+  }
+
+  vtkDataArray *weights = this->GetPointData()->GetArray("Weights");
+  if (weights == NULL)
+  {
+    vtkErrorMacro("No weigths on surface");
+    return SV_ERROR;
+  }
+  if (this->GetNumberOfPoints() != dim[0]*dim[1]*dim[2] ||
+      weights->GetNumberOfTuples() < dim[0]*dim[1]*dim[2])
+  {
+    vtkErrorMacro("Number of control points does not match dimensions");
+    return SV_ERROR;
+  }
+
+  this->HomogeneousPoints.Resize(dim[0], dim[1], dim[2], 4);
+  for (int i=0; i<dim[0]; i++)
+  {
+    for (int j=0; j<dim[1]; j++)
+    {
+      for (int k=0; k<dim[2]; k++)
+      {
+        int pos[3];
+        pos[0] = i;
+        pos[1] = j;
+        pos[2] = k;
+        int ptId = vtkStructuredData::ComputePointId(dim, pos);
+
+        double *pw = &this->HomogeneousPoints(i, j, k, 0);
+        this->GetPoints()->GetPoint(ptId, pw);
+        pw[3] = weights->GetTuple1(ptId);
+        if (!this->PointsWeighted)
+        {
+          for (int l=0; l<3; l++)
+            pw[l] *= pw[3];
+        }
+      }
+    }
+  }
+
+  this->HomogeneousPointsValid = true;
+  this->HomogeneousBuildTime.Modified();
+
+  return SV_OK;
+}
+
+// ----------------------
+// GetHomogeneousPoints
+// ----------------------
+vtkSVTensorView<double> vtkSVControlGrid::GetHomogeneousPoints()
+{
+  if (this->BuildHomogeneousPoints() != SV_OK)
+    return vtkSVTensorView<double>();
+
+  return this->HomogeneousPoints.GetView();
+}
+
+// ----------------------
+// GetHomogeneousPointer
+// ----------------------
+double *vtkSVControlGrid::GetHomogeneousPointer()
+{
+  if (this->BuildHomogeneousPoints() != SV_OK)
+    return NULL;
+
+  return this->HomogeneousPoints.GetData();
+}
+
+// ----------------------
+// GetHomogeneousStrides
+// ----------------------
+void vtkSVControlGrid::GetHomogeneousStrides(vtkIdType strides[4])
+{
+  int dim[3];
+  this->GetDimensions(dim);
+
+  strides[3] = 1;
+  strides[2] = 4;
+  strides[1] = 4*dim[2];
+  strides[0] = 4*dim[2]*dim[1];
+}
+
+// ----------------------
+// SetHomogeneousPoints
+// ----------------------
+int vtkSVControlGrid::SetHomogeneousPoints(vtkSVTensor<double> &PW)
+{
+  if (PW.GetRank() != 4 || PW.GetShape(3) != 4)
+  {
+    vtkErrorMacro("Homogeneous control points must have shape (n, m, l, 4)");
+    return SV_ERROR;
+  }
+
+  int dim[3];
+  for (int i=0; i<3; i++)
+    dim[i] = PW.GetShape(i);
+
+  this->SetNumberOfControlPoints(dim[0]*dim[1]*dim[2]);
+  this->SetDimensions(dim);
+  this->HomogeneousPoints.Swap(PW);
+
+  return this->UpdateFromHomogeneousPoints();
+}
+
+// ----------------------
+// UpdateFromHomogeneousPoints
+// ----------------------
+int vtkSVControlGrid::UpdateFromHomogeneousPoints()
+{
+  int dim[3];
+  this->GetDimensions(dim);
+
+  if (this->HomogeneousPoints.GetRank() != 4 ||
+      this->HomogeneousPoints.GetShape(0) != dim[0] ||
+      this->HomogeneousPoints.GetShape(1) != dim[1] ||
+      this->HomogeneousPoints.GetShape(2) != dim[2])
+  {
+    vtkErrorMacro("Homogeneous points do not match grid dimensions");
+    return SV_ERROR;
+  }
+
+  vtkDataArray *weights = this->GetPointData()->GetArray("Weights");
+  if (weights == NULL)
+  {
+    vtkErrorMacro("No weigths on surface");
+    return SV_ERROR;
+  }
+  this->GetPoints()->SetNumberOfPoints(dim[0]*dim[1]*dim[2]);
+  weights->SetNumberOfTuples(dim[0]*dim[1]*dim[2]);
+
+  for (int i=0; i<dim[0]; i++)
+  {
+    for (int j=0; j<dim[1]; j++)
+    {
+      for (int k=0; k<dim[2]; k++)
+      {
+        int pos[3];
+        pos[0] = i;
+        pos[1] = j;
+        pos[2] = k;
+        int ptId = vtkStructuredData::ComputePointId(dim, pos);
+
+        const double *pw = &this->HomogeneousPoints(i, j, k, 0);
+        double pt[3];
+        for (int l=0; l<3; l++)
+          pt[l] = this->PointsWeighted ? pw[l] : pw[l]/pw[3];
+        this->GetPoints()->SetPoint(ptId, pt);
+        weights->SetTuple1(ptId, pw[3]);
+      }
+    }
+  }
+
+  // Points now match the buffer
+  this->GetPoints()->Modified();
+  weights->Modified();
+  this->HomogeneousPointsValid = true;
+  this->HomogeneousBuildTime.Modified();
+
+  return SV_OK;
+}
+
+// ----------------------
+// ReleaseHomogeneousPoints
+// ----------------------
+void vtkSVControlGrid::ReleaseHomogeneousPoints()
+{
+  vtkSVTensor<double> empty;
+  this->HomogeneousPoints.Swap(empty);
+  this->HomogeneousPointsValid = false;
+}
@@ -48,6 +48,7 @@
 #include "vtkStructuredGrid.h"
 
 #include "vtkSVNURBSModule.h"
+#include "vtkSVTensor.h"
 
 class VTKSVNURBS_EXPORT vtkSVControlGrid : public vtkStructuredGrid
 {
@@ -64,6 +65,12 @@ public:
   /// \brief Initialize to empty structured grid
   void Initialize() override;
 
+  //@{
+  /// \brief Copy the grid, including whether the points are weighted.
+  void ShallowCopy(vtkDataObject *src) override;
+  void DeepCopy(vtkDataObject *src) override;
+  //@}
+
   /** \brief Set the number of control points, needs to be called before
    *  and SetControlPoint(. */
   int SetNumberOfControlPoints(const int numPoints);
@@ -147,6 +154,41 @@ public:
   virtual void GetDimensions (int dim[3]) override {vtkStructuredGrid::GetDimensions(dim);}
   //@}
 
+  //@{
+  /** \brief Get the control points in homogeneous form (x*w, y*w, z*w, w).
+   *  Values are stored contiguously with shape (dim0, dim1, dim2, 4), the
+   *  last index being the fastest. The buffer is built from the points and
+   *  weights on first access and rebuilt only when the grid has been modified
+   *  since. Writes through the pointer are not seen by the points and weights
+   *  until UpdateFromHomogeneousPoints is called. */
+  vtkSVTensorView<double> GetHomogeneousPoints();
+  double *GetHomogeneousPointer();
+  //@}
+
+  /** \brief Get the distance in doubles between neighboring entries of the
+   *  homogeneous buffer along i, j, k and the component axis. */
+  void GetHomogeneousStrides(vtkIdType strides[4]);
+
+  /** \brief Use a homogeneous tensor of shape (dim0, dim1, dim2, 4) as the
+   *  new control points. Storage is swapped rather than copied, so PW holds
+   *  the previous buffer on return. Dimensions, points and weights are set. */
+  int SetHomogeneousPoints(vtkSVTensor<double> &PW);
+
+  /// \brief Write the homogeneous buffer back to the points and weights.
+  int UpdateFromHomogeneousPoints();
+
+  /// \brief Free the homogeneous buffer.
+  void ReleaseHomogeneousPoints();
+
+  //@{
+  /** \brief Set when the points hold (x*w, y*w, z*w) instead of (x, y, z),
+   *  as after vtkSVNURBSUtils::GetPWFromP. The homogeneous buffer then copies
+   *  the points without weighting them again, and UpdateFromHomogeneousPoints
+   *  writes them back weighted. Default is 0. */
+  vtkSetMacro(PointsWeighted, int);
+  vtkGetMacro(PointsWeighted, int);
+  //@}
+
   //@{
   /// \brief Retrieve an instance of this class from an information object.
   static vtkSVControlGrid* GetData(vtkInformation* info);
@@ -159,6 +201,13 @@ protected:
 
   virtual void ComputeScalarRange() override {vtkStructuredGrid::GetScalarRange();}
 
+  int BuildHomogeneousPoints();
+
+  vtkSVTensor<double> HomogeneousPoints;
+  vtkTimeStamp        HomogeneousBuildTime;
+  bool                HomogeneousPointsValid;
+  int                 PointsWeighted;
+
 private:
   vtkSVControlGrid(const vtkSVControlGrid&);  // Not implemented.
   void operator=(const vtkSVControlGrid&);  // Not implemented.
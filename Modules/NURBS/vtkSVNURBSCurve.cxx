@@ -40,6 +40,8 @@
 #include "vtkSVGlobals.h"
 #include "vtkSVNURBSUtils.h"
 
+#include <algorithm>
+
 // ----------------------
 // StandardNewMacro
 // ----------------------
@@ -330,6 +332,51 @@ int vtkSVNURBSCurve::InsertKnots(vtkDoubleArray *newKnots)
   return SV_OK;
 }
 
+// ----------------------
+// Refine
+// ----------------------
+int vtkSVNURBSCurve::Refine(const vtkSVNURBSRefinementPlan &plan)
+{
+  vtkSVNURBSRefinementWorkspace work;
+  return this->Refine(plan, work);
+}
+
+// ----------------------
+// Refine
+// ----------------------
+int vtkSVNURBSCurve::Refine(const vtkSVNURBSRefinementPlan &plan,
+                            vtkSVNURBSRefinementWorkspace &work)
+{
+  // Load homogeneous points and knots into the work space
+  vtkSVTensorView<double> PW = this->ControlPointGrid->GetHomogeneousPoints();
+  if (PW.GetData() == NULL)
+  {
+    vtkErrorMacro("Could not get homogeneous control points");
+    return SV_ERROR;
+  }
+  work.Points.Resize(PW.GetShape(0), PW.GetShape(1), PW.GetShape(2), 4);
+  work.Points.GetView().CopyFrom(PW);
+
+  double *knots = this->KnotVector->GetPointer(0);
+  work.Knots[0].assign(knots, knots+this->KnotVector->GetNumberOfTuples());
+
+  int degrees[3] = {this->Degree, 0, 0};
+  if (vtkSVNURBSUtils::ApplyRefinementPlan(1, degrees, plan, work) != SV_OK)
+  {
+    vtkErrorMacro("Error in refinement");
+    return SV_ERROR;
+  }
+
+  // Replace existing data with refined data
+  this->ControlPointGrid->SetHomogeneousPoints(work.Points);
+  this->KnotVector->SetNumberOfTuples(work.Knots[0].size());
+  std::copy(work.Knots[0].begin(), work.Knots[0].end(), this->KnotVector->GetPointer(0));
+  this->Degree = degrees[0];
+  this->UpdateCurve();
+
+  return SV_OK;
+}
+
 // ----------------------
 // RemoveKnot
 // ----------------------
@@ -51,6 +51,7 @@
 #include "vtkIntArray.h"
 #include "vtkPolyData.h"
 #include "vtkSVControlGrid.h"
+#include "vtkSVNURBSRefinement.h"
 
 class vtkSVNURBSCollection;
 
@@ -137,6 +138,15 @@ public:
    *  done as this is not checked. */
   int InsertKnots(vtkDoubleArray *newKnots);
 
+  //@{
+  /** \brief Raise the degree and insert knots following a refinement plan,
+   *  only the first direction of the plan is used. The control points are
+   *  replaced in place. Pass a work space to reuse its buffers between
+   *  calls. */
+  int Refine(const vtkSVNURBSRefinementPlan &plan);
+  int Refine(const vtkSVNURBSRefinementPlan &plan, vtkSVNURBSRefinementWorkspace &work);
+  //@}
+
   /** \brief remove single knot from knot span of specified value. Value must match knots exactly. */
   int RemoveKnot(const double removeKnot, const int numberOfRemovals, const double tol);
 
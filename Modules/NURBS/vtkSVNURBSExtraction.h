@@ -0,0 +1,175 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class vtkSVNURBSExtractionOperators
+ *  \brief Bezier extraction operators of every element of a set of NURBS
+ *  patches, stored once per distinct local knot configuration.
+ *
+ *  The operator of an element maps the Bernstein polynomials of the element
+ *  to the B-spline basis functions that are non-zero on it. Operators are
+ *  univariate, one per parametric direction of an element, and the
+ *  multivariate operator is their tensor product (see GetElementOperator).
+ *  Since the operator only depends on the local knot vector of the element
+ *  up to an affine map, elements with the same normalized local knots share
+ *  the same entry in the operator pool. For uniform knots this leaves only a
+ *  few distinct operators per direction no matter how many elements exist.
+ *
+ *  Elements of a patch are numbered with the first direction fastest, the
+ *  same as the control points of a vtkSVControlGrid.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVNURBSExtraction_h
+#define vtkSVNURBSExtraction_h
+
+#include "vtkType.h"
+
+#include "vtkSVTensor.h"
+
+#include <vector>
+
+class vtkSVNURBSExtractionOperators
+{
+public:
+  /// \brief Remove all patches and operators.
+  void Initialize()
+  {
+    this->OperatorDegrees.clear();
+    this->OperatorOffsets.clear();
+    this->Coefficients.clear();
+    this->PatchDimensions.clear();
+    this->PatchDegrees.clear();
+    this->PatchNumberOfElements.clear();
+    this->PatchElementOffsets.assign(1, 0);
+    this->ElementOperators.clear();
+    this->ElementSpans.clear();
+  }
+
+  //@{
+  /// \brief Sizes of the stored data.
+  int GetNumberOfOperators() const {return this->OperatorDegrees.size();}
+  int GetNumberOfPatches() const {return this->PatchDimensions.size();}
+  vtkIdType GetNumberOfElements() const {return this->ElementOperators.size()/3;}
+  vtkIdType GetNumberOfElements(const int patch) const
+  {
+    return this->PatchElementOffsets[patch+1] - this->PatchElementOffsets[patch];
+  }
+  //@}
+
+  /// \brief Univariate operator id as a (p+1)x(p+1) view, rows are the
+  /// B-spline functions and columns the Bernstein polynomials.
+  vtkSVTensorView<const double> GetOperator(const int id) const
+  {
+    const int n = this->OperatorDegrees[id] + 1;
+    const vtkIdType shape[2] = {n, n};
+    const vtkIdType stride[2] = {n, 1};
+    return vtkSVTensorView<const double>(&this->Coefficients[this->OperatorOffsets[id]],
+                                         2, shape, stride);
+  }
+
+  //@{
+  /// \brief Operator id and knot span of an element in direction dir,
+  /// element is the index within its patch.
+  int GetElementOperatorId(const int patch, const vtkIdType element, const int dir) const
+  {
+    return this->ElementOperators[3*(this->PatchElementOffsets[patch]+element)+dir];
+  }
+  int GetElementSpan(const int patch, const vtkIdType element, const int dir) const
+  {
+    return this->ElementSpans[3*(this->PatchElementOffsets[patch]+element)+dir];
+  }
+  //@}
+
+  /// \brief Form the full tensor product operator of an element. Local
+  /// functions and polynomials are numbered with the first direction fastest.
+  void GetElementOperator(const int patch, const vtkIdType element,
+                          vtkSVTensor<double> &C) const
+  {
+    const int dim = this->PatchDimensions[patch];
+    vtkSVTensorView<const double> ops[3];
+    int n[3] = {1, 1, 1};
+    for (int d=0; d<dim; d++)
+    {
+      ops[d] = this->GetOperator(this->GetElementOperatorId(patch, element, d));
+      n[d]   = ops[d].GetShape(0);
+    }
+    const int size = n[0]*n[1]*n[2];
+    C.Resize(size, size);
+    for (int a=0; a<size; a++)
+    {
+      const int ai[3] = {a%n[0], (a/n[0])%n[1], a/(n[0]*n[1])};
+      for (int b=0; b<size; b++)
+      {
+        const int bi[3] = {b%n[0], (b/n[0])%n[1], b/(n[0]*n[1])};
+        double val = 1.0;
+        for (int d=0; d<dim; d++)
+          val *= ops[d](ai[d], bi[d]);
+        C(a, b) = val;
+      }
+    }
+  }
+
+  //@{
+  /// \brief Pool of unique univariate operators. Operator i has degree
+  /// OperatorDegrees[i] and its row major coefficients start at
+  /// Coefficients[OperatorOffsets[i]].
+  std::vector<int> OperatorDegrees;
+  std::vector<vtkIdType> OperatorOffsets;
+  std::vector<double> Coefficients;
+  //@}
+
+  //@{
+  /// \brief Number of parametric directions, three degrees and three element
+  /// counts of each patch, unused directions have degree 0 and one element.
+  /// Elements of patch i are PatchElementOffsets[i] up to
+  /// PatchElementOffsets[i+1].
+  std::vector<int> PatchDimensions;
+  std::vector<int> PatchDegrees;
+  std::vector<int> PatchNumberOfElements;
+  std::vector<vtkIdType> PatchElementOffsets;
+  //@}
+
+  //@{
+  /// \brief Three operator ids and three knot span indices of each element,
+  /// -1 for unused directions. The span gives the control points of the
+  /// element, span-p to span in that direction.
+  std::vector<int> ElementOperators;
+  std::vector<int> ElementSpans;
+  //@}
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkSVNURBSExtraction.h
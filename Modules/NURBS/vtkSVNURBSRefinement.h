@@ -0,0 +1,105 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *  \class vtkSVNURBSRefinementPlan
+ *  \brief Description of the h, p or k-refinement to apply to a NURBS
+ *  object in one call, and the reusable work space to apply it with.
+ *
+ *  Degrees are raised to TargetDegrees and the knots in InsertKnots are
+ *  inserted along each parametric direction. When ElevateFirst is on (the
+ *  default) the degree is raised before the knots are inserted, which is
+ *  k-refinement and keeps the maximum continuity across the new knots.
+ *  Otherwise knots are inserted first and the continuity across them stays
+ *  at the original p-1.
+ *
+ *  vtkSVNURBSRefinementWorkspace holds every buffer needed during the
+ *  refinement. Passing the same work space for all patches of a
+ *  vtkSVNURBSCollection means the buffers are only allocated once.
+ *
+ *  \author Adam Updegrove
+ *  \author updega2@gmail.com
+ *  \author UC Berkeley
+ *  \author shaddenlab.berkeley.edu
+ */
+
+#ifndef vtkSVNURBSRefinement_h
+#define vtkSVNURBSRefinement_h
+
+#include "vtkSMPThreadLocal.h"
+
+#include "vtkSVTensor.h"
+
+#include <vector>
+
+struct vtkSVNURBSRefinementPlan
+{
+  vtkSVNURBSRefinementPlan() : ElevateFirst(1)
+  {
+    for (int i=0; i<3; i++)
+      this->TargetDegrees[i] = -1;
+  }
+
+  /// \brief Degree wanted in each direction, ignored if not above current.
+  int TargetDegrees[3];
+
+  /// \brief Increasing knots to insert in each direction, may be empty.
+  std::vector<double> InsertKnots[3];
+
+  /// \brief Raise degree before inserting knots (k-refinement).
+  int ElevateFirst;
+};
+
+class vtkSVNURBSRefinementWorkspace
+{
+public:
+  /// \brief Homogeneous control points of shape (n0, n1, n2, 4).
+  vtkSVTensor<double> Points;
+
+  /// \brief Knot vector of each direction.
+  std::vector<double> Knots[3];
+
+  //@{
+  /// \brief Buffers the result of each step is written to before swapping.
+  vtkSVTensor<double> Buffer;
+  std::vector<double> NewKnots;
+  vtkSVTensor<double> DegreeCoefficients;
+  //@}
+
+  //@{
+  /// \brief Per thread scratch used by the fiber kernels.
+  vtkSMPThreadLocal<std::vector<double> > Scratch;
+  vtkSMPThreadLocal<std::vector<double> > KnotScratch;
+  //@}
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkSVNURBSRefinement.h
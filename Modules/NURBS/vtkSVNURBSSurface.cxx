@@ -33,14 +33,166 @@
 
 #include "vtkCellArray.h"
 #include "vtkCleanPolyData.h"
+#include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkSparseArray.h"
 
 #include "vtkSVGlobals.h"
 #include "vtkSVNURBSUtils.h"
 
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Most divisions used for a single knot span in adaptive tessellation
+const int MaxSpanDivisions = 256;
+
+// ----------------------
+// SegmentDivisions
+// ----------------------
+/* Divisions needed to follow the polyline x0 ... xm sampled uniformly over
+ * a parameter length of length, using the second differences for the chord
+ * error and the total angle the polyline turns through for the angle */
+int SegmentDivisions(const std::vector<double> &x, const int start,
+                     const int stride, const int m, const double length,
+                     const double chordTolerance, const double angleTolerance)
+{
+  double h = length/m;
+  double maxSecond = 0.0;
+  double turning   = 0.0;
+  for (int k=1; k<m; k++)
+  {
+    const double *x0 = &x[3*(start+(k-1)*stride)];
+    const double *x1 = &x[3*(start+k*stride)];
+    const double *x2 = &x[3*(start+(k+1)*stride)];
+    double d0[3], d1[3], d2[3];
+    for (int c=0; c<3; c++)
+    {
+      d0[c] = x1[c] - x0[c];
+      d1[c] = x2[c] - x1[c];
+      d2[c] = d1[c] - d0[c];
+    }
+    maxSecond = svmaximum(maxSecond, vtkMath::Norm(d2)/(h*h));
+
+    double n0 = vtkMath::Norm(d0);
+    double n1 = vtkMath::Norm(d1);
+    if (n0 > 0.0 && n1 > 0.0)
+    {
+      double cosAngle = vtkMath::Dot(d0, d1)/(n0*n1);
+      turning += acos(svmaximum(-1.0, svminimum(1.0, cosAngle)));
+    }
+  }
+
+  // Chord error of a segment of length h is about h^2 |C''| / 8
+  int divisions = 1;
+  if (chordTolerance > 0.0)
+    divisions = svmaximum(divisions, static_cast<int>(ceil(length*sqrt(maxSecond/(8.0*chordTolerance)))));
+  // The m-1 turning angles of the polyline only cover (m-1)/m of the span
+  if (angleTolerance > 0.0 && m > 1)
+    divisions = svmaximum(divisions, static_cast<int>(ceil(turning*m/((m-1)*angleTolerance))));
+
+  return svminimum(divisions, MaxSpanDivisions);
+}
+
+// ----------------------
+// ElementDivisions
+// ----------------------
+/* Samples each knot span element on a test grid and finds the divisions
+ * needed in u and v on that element */
+class ElementDivisions
+{
+public:
+  vtkSVTensorView<const double> Pw;
+  const double *UKnots;
+  const double *VKnots;
+  int P;
+  int Q;
+  const std::vector<int> *USpans;
+  const std::vector<int> *VSpans;
+  double ChordTolerance;
+  double AngleTolerance;
+  std::vector<int> *UDivisions;
+  std::vector<int> *VDivisions;
+  vtkSMPThreadLocal<std::vector<double> > Samples;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<double> &x = this->Samples.Local();
+
+    // Test grid resolves a polynomial of the span degree a few times over
+    const int mu = 2*(this->P+1);
+    const int mv = 2*(this->Q+1);
+    x.resize(3*(mu+1)*(mv+1));
+
+    const int numUSpans = this->USpans->size();
+    for (vtkIdType e=begin; e<end; e++)
+    {
+      const int uSpan = (*this->USpans)[e%numUSpans];
+      const int vSpan = (*this->VSpans)[e/numUSpans];
+      const double u0 = this->UKnots[uSpan];
+      const double du = this->UKnots[uSpan+1] - u0;
+      const double v0 = this->VKnots[vSpan];
+      const double dv = this->VKnots[vSpan+1] - v0;
+
+      for (int b=0; b<=mv; b++)
+      {
+        for (int a=0; a<=mu; a++)
+          vtkSVNURBSUtils::SurfacePoint(this->Pw, this->UKnots, this->P,
+                                        this->VKnots, this->Q,
+                                        u0 + a*du/mu, v0 + b*dv/mv,
+                                        &x[3*(a+b*(mu+1))]);
+      }
+
+      int nu = 1;
+      for (int b=0; b<=mv; b++)
+        nu = svmaximum(nu, SegmentDivisions(x, b*(mu+1), 1, mu, du,
+                                            this->ChordTolerance, this->AngleTolerance));
+      int nv = 1;
+      for (int a=0; a<=mu; a++)
+        nv = svmaximum(nv, SegmentDivisions(x, a, mu+1, mv, dv,
+                                            this->ChordTolerance, this->AngleTolerance));
+      (*this->UDivisions)[e] = nu;
+      (*this->VDivisions)[e] = nv;
+    }
+  }
+};
+
+// ----------------------
+// EvaluateRows
+// ----------------------
+/* Evaluates the tessellation points, one v row at a time */
+class EvaluateRows
+{
+public:
+  vtkSVTensorView<const double> Pw;
+  const double *UKnots;
+  const double *VKnots;
+  int P;
+  int Q;
+  const std::vector<double> *UEvals;
+  const std::vector<double> *VEvals;
+  double *Points;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const int numU = this->UEvals->size();
+    for (vtkIdType j=begin; j<end; j++)
+    {
+      for (int i=0; i<numU; i++)
+        vtkSVNURBSUtils::SurfacePoint(this->Pw, this->UKnots, this->P,
+                                      this->VKnots, this->Q,
+                                      (*this->UEvals)[i], (*this->VEvals)[j],
+                                      &this->Points[3*(i+j*numU)]);
+    }
+  }
+};
+}
+
 // ----------------------
 // StandardNewMacro
 // ----------------------
@@ -160,6 +312,21 @@ vtkSVNURBSSurface* vtkSVNURBSSurface::GetData(vtkInformationVector* v, int i)
   return vtkSVNURBSSurface::GetData(v->GetInformationObject(i));
 }
 
+// ----------------------
+// UpdateSurface
+// ----------------------
+void vtkSVNURBSSurface::UpdateSurface()
+{
+  int dim[3];
+  this->ControlPointGrid->GetDimensions(dim);
+  this->NumberOfUControlPoints = dim[0];
+  this->NumberOfVControlPoints = dim[1];
+  this->NumberOfUKnotPoints    = this->UKnotVector->GetNumberOfTuples();
+  this->NumberOfVKnotPoints    = this->VKnotVector->GetNumberOfTuples();
+  this->UDegree = this->NumberOfUKnotPoints - this->NumberOfUControlPoints - 1;
+  this->VDegree = this->NumberOfVKnotPoints - this->NumberOfVControlPoints - 1;
+}
+
 // ----------------------
 // IncreaseDegree
 // ----------------------
@@ -357,6 +524,56 @@ int vtkSVNURBSSurface::InsertKnots(vtkDoubleArray *newKnots, const int dim)
   return SV_OK;
 }
 
+// ----------------------
+// Refine
+// ----------------------
+int vtkSVNURBSSurface::Refine(const vtkSVNURBSRefinementPlan &plan)
+{
+  vtkSVNURBSRefinementWorkspace work;
+  return this->Refine(plan, work);
+}
+
+// ----------------------
+// Refine
+// ----------------------
+int vtkSVNURBSSurface::Refine(const vtkSVNURBSRefinementPlan &plan,
+                              vtkSVNURBSRefinementWorkspace &work)
+{
+  // Load homogeneous points and knots into the work space
+  vtkSVTensorView<double> PW = this->ControlPointGrid->GetHomogeneousPoints();
+  if (PW.GetData() == NULL)
+  {
+    vtkErrorMacro("Could not get homogeneous control points");
+    return SV_ERROR;
+  }
+  work.Points.Resize(PW.GetShape(0), PW.GetShape(1), PW.GetShape(2), 4);
+  work.Points.GetView().CopyFrom(PW);
+
+  for (int i=0; i<2; i++)
+  {
+    double *knots = this->UVKnotVectors[i]->GetPointer(0);
+    work.Knots[i].assign(knots, knots+this->UVKnotVectors[i]->GetNumberOfTuples());
+  }
+
+  int degrees[3] = {this->UDegree, this->VDegree, 0};
+  if (vtkSVNURBSUtils::ApplyRefinementPlan(2, degrees, plan, work) != SV_OK)
+  {
+    vtkErrorMacro("Error in refinement");
+    return SV_ERROR;
+  }
+
+  // Replace existing data with refined data
+  this->ControlPointGrid->SetHomogeneousPoints(work.Points);
+  for (int i=0; i<2; i++)
+  {
+    this->UVKnotVectors[i]->SetNumberOfTuples(work.Knots[i].size());
+    std::copy(work.Knots[i].begin(), work.Knots[i].end(), this->UVKnotVectors[i]->GetPointer(0));
+  }
+  this->UpdateSurface();
+
+  return SV_OK;
+}
+
 // ----------------------
 // RemoveKnot
 // ----------------------
@@ -699,6 +916,158 @@ int vtkSVNURBSSurface::GeneratePolyDataRepresentation(const double uSpacing,
   return SV_OK;
 }
 
+// ----------------------
+// GenerateAdaptivePolyDataRepresentation
+// ----------------------
+int vtkSVNURBSSurface::GenerateAdaptivePolyDataRepresentation(const double chordTolerance,
+                                                              const double angleTolerance)
+{
+  if (chordTolerance <= 0.0 && angleTolerance <= 0.0)
+  {
+    vtkErrorMacro("Need a positive chord or angle tolerance");
+    return SV_ERROR;
+  }
+
+  // Get number of control points and knots
+  int dim[3];
+  this->ControlPointGrid->GetDimensions(dim);
+  this->NumberOfUControlPoints = dim[0];
+  this->NumberOfVControlPoints = dim[1];
+  this->NumberOfUKnotPoints = this->UKnotVector->GetNumberOfTuples();
+  this->NumberOfVKnotPoints = this->VKnotVector->GetNumberOfTuples();
+  int nUCon  = this->NumberOfUControlPoints;
+  int nVCon  = this->NumberOfVControlPoints;
+  int nUKnot = this->NumberOfUKnotPoints;
+  int nVKnot = this->NumberOfVKnotPoints;
+  if (nUCon == 0 || nVCon == 0)
+  {
+    vtkErrorMacro("No control points");
+    return SV_ERROR;
+  }
+  if (nUKnot == 0 || nVKnot == 0)
+  {
+    vtkErrorMacro("No knot points");
+    return SV_ERROR;
+  }
+
+  // Using clamped formula for degree of curve
+  int p = nUKnot - nUCon - 1;
+  int q = nVKnot - nVCon - 1;
+
+  const double *U = this->UKnotVector->GetPointer(0);
+  const double *V = this->VKnotVector->GetPointer(0);
+  vtkSVTensorView<double> PW = this->ControlPointGrid->GetHomogeneousPoints();
+  if (PW.GetData() == NULL || PW.GetSize() == 0)
+  {
+    vtkErrorMacro("Could not get homogeneous control points");
+    return SV_ERROR;
+  }
+  vtkSVTensorView<const double> Pw = PW.Slice(2, 0);
+
+  // Non-zero knot spans in each direction
+  std::vector<int> uSpans, vSpans;
+  for (int i=p; i<nUCon; i++)
+  {
+    if (U[i+1] > U[i])
+      uSpans.push_back(i);
+  }
+  for (int i=q; i<nVCon; i++)
+  {
+    if (V[i+1] > V[i])
+      vSpans.push_back(i);
+  }
+  if (uSpans.empty() || vSpans.empty())
+  {
+    vtkErrorMacro("Surface has no non-zero knot spans");
+    return SV_ERROR;
+  }
+
+  // Divisions needed on each element
+  int numElements = uSpans.size()*vSpans.size();
+  std::vector<int> elementUDivisions(numElements), elementVDivisions(numElements);
+  ElementDivisions divider;
+  divider.Pw = Pw;
+  divider.UKnots = U;
+  divider.VKnots = V;
+  divider.P = p;
+  divider.Q = q;
+  divider.USpans = &uSpans;
+  divider.VSpans = &vSpans;
+  divider.ChordTolerance = chordTolerance;
+  divider.AngleTolerance = angleTolerance;
+  divider.UDivisions = &elementUDivisions;
+  divider.VDivisions = &elementVDivisions;
+  vtkSMPTools::For(0, numElements, divider);
+
+  // Every element in a column of spans uses the same u divisions and every
+  // element in a row the same v divisions, so points on shared span
+  // boundaries match and the mesh has no cracks
+  std::vector<int> uDivisions(uSpans.size(), 1), vDivisions(vSpans.size(), 1);
+  for (int e=0; e<numElements; e++)
+  {
+    size_t i = e%uSpans.size();
+    size_t j = e/uSpans.size();
+    uDivisions[i] = svmaximum(uDivisions[i], elementUDivisions[e]);
+    vDivisions[j] = svmaximum(vDivisions[j], elementVDivisions[e]);
+  }
+
+  std::vector<double> uEvals, vEvals;
+  for (size_t i=0; i<uSpans.size(); i++)
+  {
+    double u0 = U[uSpans[i]];
+    double du = U[uSpans[i]+1] - u0;
+    for (int a=0; a<uDivisions[i]; a++)
+      uEvals.push_back(u0 + a*du/uDivisions[i]);
+  }
+  uEvals.push_back(U[uSpans.back()+1]);
+  for (size_t j=0; j<vSpans.size(); j++)
+  {
+    double v0 = V[vSpans[j]];
+    double dv = V[vSpans[j]+1] - v0;
+    for (int b=0; b<vDivisions[j]; b++)
+      vEvals.push_back(v0 + b*dv/vDivisions[j]);
+  }
+  vEvals.push_back(V[vSpans.back()+1]);
+
+  // Get the physical points on the surface
+  int numUDiv = uEvals.size();
+  int numVDiv = vEvals.size();
+  vtkNew(vtkPoints, surfacePoints);
+  surfacePoints->SetDataTypeToDouble();
+  surfacePoints->SetNumberOfPoints(numUDiv*numVDiv);
+
+  EvaluateRows evaluator;
+  evaluator.Pw = Pw;
+  evaluator.UKnots = U;
+  evaluator.VKnots = V;
+  evaluator.P = p;
+  evaluator.Q = q;
+  evaluator.UEvals = &uEvals;
+  evaluator.VEvals = &vEvals;
+  evaluator.Points = vtkDoubleArray::SafeDownCast(surfacePoints->GetData())->GetPointer(0);
+  vtkSMPTools::For(0, numVDiv, evaluator);
+
+  // Get grid connectivity for pointset
+  vtkNew(vtkCellArray, surfaceCells);
+  this->GetStructuredGridConnectivity(numUDiv, numVDiv, surfaceCells);
+
+  // Update the surface representation
+  this->SurfaceRepresentation->SetPoints(surfacePoints);
+  this->SurfaceRepresentation->SetPolys(surfaceCells);
+
+  // Clean the surface in case of duplicate points (closed surface)
+  vtkNew(vtkCleanPolyData, cleaner);
+  cleaner->SetInputData(this->SurfaceRepresentation);
+  cleaner->SetTolerance(1.0e-6);
+  cleaner->Update();
+
+  // Get clean output and build links
+  this->SurfaceRepresentation->DeepCopy(cleaner->GetOutput());
+  this->SurfaceRepresentation->BuildLinks();
+
+  return SV_OK;
+}
+
 // ----------------------
 // GetUMultiplicity
 // ----------------------
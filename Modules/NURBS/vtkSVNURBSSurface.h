@@ -50,6 +50,7 @@
 #include "vtkPolyData.h"
 
 #include "vtkSVControlGrid.h"
+#include "vtkSVNURBSRefinement.h"
 #include "vtkSVNURBSCollection.h"
 #include "vtkSVNURBSObject.h"
 
@@ -116,12 +117,28 @@ public:
    *  \param vSpacing Sets the spacing to sample the NURBS at in the v parameter direction. */
   int GeneratePolyDataRepresentation(const double uSpacing, const double vSpacing);
 
+  /** \brief Function to generate a polydata representation of the surface
+   *  with divisions chosen per knot span from the local shape. Spans that
+   *  are flat get a single division. Every span in a column shares its u
+   *  divisions and every span in a row its v divisions, so the result has
+   *  no cracks at span boundaries. Stored in SurfaceRepresentation.
+   *  \param chordTolerance Largest distance wanted between the surface and
+   *  the mesh, not used if zero or less.
+   *  \param angleTolerance Largest angle in radians that the u and v
+   *  iso-curves of the surface may turn through across one division, not
+   *  used if zero or less. This bounds the angle between neighboring edges
+   *  of the mesh along those curves, not between cell normals. */
+  int GenerateAdaptivePolyDataRepresentation(const double chordTolerance,
+                                             const double angleTolerance);
+
   //Functions to set control points/knots/etc.
   void SetControlPoints(vtkStructuredGrid *points2d);
   void SetKnotVector(vtkDoubleArray *knotVector, const int dim);
 
   //Functions to manipulate the geometry
-  void UpdateSurface() {} /**< \brief Unimplemented */
+  /** \brief Update the numbers of control points and knots and the
+   *  degrees from the control point grid and knot vectors. */
+  void UpdateSurface();
 
   /** \brief Increase the degree of the surface a specified number of times. */
   int IncreaseDegree(const int numberOfIncreases, const int dim);
@@ -140,6 +157,14 @@ public:
    *  done as this is not checked. */
   int InsertKnots(vtkDoubleArray *newKnots, const int dim);
 
+  //@{
+  /** \brief Raise the degree and insert knots in both directions following
+   *  a refinement plan. The control points are replaced in place. Pass a work
+   *  space to reuse its buffers between calls. */
+  int Refine(const vtkSVNURBSRefinementPlan &plan);
+  int Refine(const vtkSVNURBSRefinementPlan &plan, vtkSVNURBSRefinementWorkspace &work);
+  //@}
+
   /** \brief Remove a knot a certain number of times.*/
   int RemoveKnot(const double removeKnot, const int dim, const int numberOfRemovals, const double tolerance);
 
@@ -36,6 +36,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkSparseArray.h"
 #include "vtkStructuredData.h"
@@ -45,11 +46,363 @@
 #include "vtkSVMathUtils.h"
 #include "vtkSVNURBSCurve.h"
 #include "vtkSVNURBSSurface.h"
+#include "vtkSVNURBSVolume.h"
 
 #include <cassert>
 #include <cmath>
+#include <map>
 #include <string>
 
+namespace
+{
+// Largest degree handled by the fixed size basis function buffers
+const int MaxBasisDegree = 32;
+
+// ----------------------
+// Copy4
+// ----------------------
+inline void Copy4(const double *pw, double *out)
+{
+  out[0] = pw[0]; out[1] = pw[1]; out[2] = pw[2]; out[3] = pw[3];
+}
+
+// ----------------------
+// Blend4
+// ----------------------
+/* out = alpha*pw0 + (1-alpha)*pw1, out may alias either input */
+inline void Blend4(const double *pw0, const double alpha, const double *pw1, double *out)
+{
+  for (int i=0; i<4; i++)
+    out[i] = alpha*pw0[i] + (1.0-alpha)*pw1[i];
+}
+
+// ----------------------
+// FindSpanInKnots
+// ----------------------
+/* Same as vtkSVNURBSUtils::FindSpan on a raw knot vector with n+1 control points */
+int FindSpanInKnots(const int p, const int n, const double u, const double *knots)
+{
+  int nCon = n+1;
+  if (u == knots[nCon])
+    return nCon - 1;
+
+  int low  = p;
+  int high = nCon;
+  int mid  = (low+high)/2;
+  while (u < knots[mid] || u >= knots[mid+1])
+  {
+    if (u < knots[mid])
+      high = mid;
+    else
+      low = mid;
+    mid = (low+high)/2;
+  }
+  return mid;
+}
+
+// ----------------------
+// ElevateFibers
+// ----------------------
+/* Degree elevation of all fibers along the first axis of a rank 4 grid */
+class ElevateFibers
+{
+public:
+  vtkSVTensorView<const double> In;
+  vtkSVTensorView<double>       Out;
+  const double *Knots;
+  int P;
+  int T;
+  int NumberOfKnots;
+  const vtkSVTensor<double> *Coefficients;
+  vtkSMPThreadLocal<std::vector<double> > *Scratch;
+  vtkSMPThreadLocal<std::vector<double> > *KnotScratch;
+  vtkSMPThreadLocal<int> Errors;
+
+  ElevateFibers() : Errors(0) {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<double> &scratch = this->Scratch->Local();
+    std::vector<double> &knots = this->KnotScratch->Local();
+    knots.resize(this->NumberOfKnots);
+    int &errors = this->Errors.Local();
+
+    int numFibers2 = this->In.GetShape(2);
+    for (vtkIdType f=begin; f<end; f++)
+    {
+      int j = f/numFibers2;
+      int l = f%numFibers2;
+      int nh;
+      if (vtkSVNURBSUtils::IncreaseDegreeFiber(this->In.Slice(2, l).Slice(1, j),
+                                               this->Knots, this->P, this->T,
+                                               *this->Coefficients,
+                                               this->Out.Slice(2, l).Slice(1, j),
+                                               &knots[0], nh, scratch) != SV_OK ||
+          nh != this->Out.GetShape(0)-1)
+        errors++;
+    }
+  }
+};
+
+// ----------------------
+// RefineFibers
+// ----------------------
+/* Knot refinement of all fibers along the first axis of a rank 4 grid */
+class RefineFibers
+{
+public:
+  vtkSVTensorView<const double> In;
+  vtkSVTensorView<double>       Out;
+  const double *Knots;
+  const double *InsertKnots;
+  const double *NewKnots;
+  int P;
+  int NumberOfInsertKnots;
+  vtkSMPThreadLocal<int> Errors;
+
+  RefineFibers() : Errors(0) {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int &errors = this->Errors.Local();
+
+    int numFibers2 = this->In.GetShape(2);
+    for (vtkIdType f=begin; f<end; f++)
+    {
+      int j = f/numFibers2;
+      int l = f%numFibers2;
+      if (vtkSVNURBSUtils::KnotRefinementFiber(this->In.Slice(2, l).Slice(1, j),
+                                               this->Knots, this->P,
+                                               this->InsertKnots,
+                                               this->NumberOfInsertKnots,
+                                               this->NewKnots,
+                                               this->Out.Slice(2, l).Slice(1, j)) != SV_OK)
+        errors++;
+    }
+  }
+};
+
+// ----------------------
+// CountErrors
+// ----------------------
+int CountErrors(vtkSMPThreadLocal<int> &errors)
+{
+  int total = 0;
+  for (vtkSMPThreadLocal<int>::iterator it=errors.begin(); it!=errors.end(); ++it)
+    total += *it;
+  return total;
+}
+
+// ----------------------
+// ElevateAlongAxis
+// ----------------------
+int ElevateAlongAxis(const int axis, const int p, const int t,
+                     vtkSVNURBSRefinementWorkspace &work)
+{
+  std::vector<double> &knots = work.Knots[axis];
+  int n = work.Points.GetShape(axis)-1;
+  if (static_cast<int>(knots.size()) != n+p+2)
+  {
+    fprintf(stderr,"Invalid number of control points given with knot span\n");
+    return SV_ERROR;
+  }
+
+  // Size everything once
+  vtkSVNURBSUtils::GetDegreeElevationCoefficients(p, t, work.DegreeCoefficients);
+  vtkSVNURBSUtils::GetElevatedKnots(&knots[0], knots.size(), t, work.NewKnots);
+  int nhat = work.NewKnots.size()-(p+t)-2;
+
+  vtkIdType shape[4];
+  for (int i=0; i<4; i++)
+    shape[i] = work.Points.GetShape(i);
+  shape[axis] = nhat+1;
+  work.Buffer.Resize(4, shape);
+
+  ElevateFibers elevator;
+  elevator.In  = static_cast<const vtkSVTensor<double> &>(work.Points).GetView().SwapAxes(0, axis);
+  elevator.Out = work.Buffer.GetView().SwapAxes(0, axis);
+  elevator.Knots         = &knots[0];
+  elevator.P             = p;
+  elevator.T             = t;
+  elevator.NumberOfKnots = work.NewKnots.size();
+  elevator.Coefficients  = &work.DegreeCoefficients;
+  elevator.Scratch       = &work.Scratch;
+  elevator.KnotScratch   = &work.KnotScratch;
+  vtkSMPTools::For(0, elevator.In.GetShape(1)*elevator.In.GetShape(2), elevator);
+  if (CountErrors(elevator.Errors) != 0)
+  {
+    fprintf(stderr,"Error on degree elevation\n");
+    return SV_ERROR;
+  }
+
+  work.Points.Swap(work.Buffer);
+  knots.swap(work.NewKnots);
+
+  return SV_OK;
+}
+
+// ----------------------
+// RefineAlongAxis
+// ----------------------
+int RefineAlongAxis(const int axis, const int p,
+                    const std::vector<double> &insertKnots,
+                    vtkSVNURBSRefinementWorkspace &work)
+{
+  std::vector<double> &knots = work.Knots[axis];
+  int n = work.Points.GetShape(axis)-1;
+  int r = insertKnots.size();
+  if (static_cast<int>(knots.size()) != n+p+2)
+  {
+    fprintf(stderr,"Invalid number of control points given with knot span\n");
+    return SV_ERROR;
+  }
+  if (insertKnots.front() < knots[p] || insertKnots.back() > knots[n+1])
+  {
+    fprintf(stderr,"Knots to insert must be within the knot span\n");
+    return SV_ERROR;
+  }
+
+  // Size everything once
+  work.NewKnots.resize(knots.size()+r);
+  vtkSVNURBSUtils::GetRefinedKnots(&knots[0], knots.size(), p,
+                                   &insertKnots[0], r, &work.NewKnots[0]);
+
+  vtkIdType shape[4];
+  for (int i=0; i<4; i++)
+    shape[i] = work.Points.GetShape(i);
+  shape[axis] = n+r+1;
+  work.Buffer.Resize(4, shape);
+
+  RefineFibers refiner;
+  refiner.In  = static_cast<const vtkSVTensor<double> &>(work.Points).GetView().SwapAxes(0, axis);
+  refiner.Out = work.Buffer.GetView().SwapAxes(0, axis);
+  refiner.Knots               = &knots[0];
+  refiner.InsertKnots         = &insertKnots[0];
+  refiner.NewKnots            = &work.NewKnots[0];
+  refiner.P                   = p;
+  refiner.NumberOfInsertKnots = r;
+  vtkSMPTools::For(0, refiner.In.GetShape(1)*refiner.In.GetShape(2), refiner);
+  if (CountErrors(refiner.Errors) != 0)
+  {
+    fprintf(stderr,"Error on knot refinement\n");
+    return SV_ERROR;
+  }
+
+  work.Points.Swap(work.Buffer);
+  knots.swap(work.NewKnots);
+
+  return SV_OK;
+}
+
+// Relative tolerance for normalized local knots to be considered equal
+const double ExtractionKnotTolerance = 1.0e-10;
+
+// ----------------------
+// ExtractionElement
+// ----------------------
+/* One knot span of one direction of one patch */
+struct ExtractionElement
+{
+  const double *Knots;
+  int Degree;
+  int Span;
+};
+
+// ----------------------
+// ExtractionKeys
+// ----------------------
+/* Normalized local knot vector of each element, used to find duplicates */
+class ExtractionKeys
+{
+public:
+  const std::vector<ExtractionElement> *Elements;
+  std::vector<std::vector<long long> > *Keys;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType e=begin; e<end; e++)
+    {
+      const ExtractionElement &element = (*this->Elements)[e];
+      const int p = element.Degree;
+      const double *localKnots = element.Knots + element.Span - p;
+      const double length = localKnots[p+1] - localKnots[p];
+
+      // The first and last local knots do not change the operator
+      std::vector<long long> &key = (*this->Keys)[e];
+      key.resize(2*p);
+      for (int i=0; i<2*p; i++)
+        key[i] = static_cast<long long>(std::floor((localKnots[i+1]-localKnots[p])/
+                                                   (length*ExtractionKnotTolerance) + 0.5));
+    }
+  }
+};
+
+// ----------------------
+// ExtractionOperators
+// ----------------------
+/* Extraction operator of each unique element */
+class ExtractionOperators
+{
+public:
+  const std::vector<ExtractionElement> *Elements;
+  const std::vector<vtkIdType> *Representatives;
+  vtkSVNURBSExtractionOperators *Operators;
+  vtkSMPThreadLocal<int> Errors;
+
+  ExtractionOperators() : Errors(0) {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int &errors = this->Errors.Local();
+    for (vtkIdType id=begin; id<end; id++)
+    {
+      const ExtractionElement &element = (*this->Elements)[(*this->Representatives)[id]];
+      if (vtkSVNURBSUtils::GetElementExtractionOperator(
+            element.Knots + element.Span - element.Degree, element.Degree,
+            &this->Operators->Coefficients[this->Operators->OperatorOffsets[id]]) != SV_OK)
+        errors++;
+    }
+  }
+};
+
+// ----------------------
+// GetPatchKnots
+// ----------------------
+/* Parametric dimension, degrees and knot vectors of any NURBS patch type */
+int GetPatchKnots(vtkSVNURBSObject *patch, int &dim, int degrees[3],
+                  vtkDoubleArray *knots[3])
+{
+  if (vtkSVNURBSCurve *curve = vtkSVNURBSCurve::SafeDownCast(patch))
+  {
+    dim = 1;
+    degrees[0] = curve->GetDegree();
+    knots[0]   = curve->GetKnotVector();
+  }
+  else if (vtkSVNURBSSurface *surface = vtkSVNURBSSurface::SafeDownCast(patch))
+  {
+    dim = 2;
+    degrees[0] = surface->GetUDegree();
+    degrees[1] = surface->GetVDegree();
+    knots[0]   = surface->GetUKnotVector();
+    knots[1]   = surface->GetVKnotVector();
+  }
+  else if (vtkSVNURBSVolume *volume = vtkSVNURBSVolume::SafeDownCast(patch))
+  {
+    dim = 3;
+    degrees[0] = volume->GetUDegree();
+    degrees[1] = volume->GetVDegree();
+    degrees[2] = volume->GetWDegree();
+    knots[0]   = volume->GetUKnotVector();
+    knots[1]   = volume->GetVKnotVector();
+    knots[2]   = volume->GetWKnotVector();
+  }
+  else
+    return SV_ERROR;
+
+  return SV_OK;
+}
+}
+
 // ----------------------
 // StandardNewMacro
 // ----------------------
@@ -471,7 +824,6 @@ int vtkSVNURBSUtils::GetControlPointsOfCurve(vtkPoints *points, vtkDoubleArray *
 
   vtkNew(vtkDenseArray<double>, pointArrayTmp);
   vtkNew(vtkDenseArray<double>, pointArrayFinal);
-  vtkNew(vtkDenseArray<double>, cPointArray);
   if (vtkSVNURBSUtils::PointsToTypedArray(points, pointArrayTmp) != SV_OK)
   {
     return SV_ERROR;
@@ -488,18 +840,19 @@ int vtkSVNURBSUtils::GetControlPointsOfCurve(vtkPoints *points, vtkDoubleArray *
     vtkSVNURBSUtils::DeepCopy(pointArrayTmp, pointArrayFinal);
   }
 
-  vtkNew(vtkSparseArray<double>, NPinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPFinal, NPinv) != SV_OK)
+  // Solve in place on contiguous storage instead of forming the inverse
+  vtkSVTensor<double> NP, cPointGrid;
+  vtkSVNURBSUtils::TypedArrayToTensor(NPFinal, NP);
+  vtkSVNURBSUtils::TypedArrayToTensor(pointArrayFinal, cPointGrid);
+  vtkIdType gridShape[4] = {cPointGrid.GetShape(0), 1, 1, 3};
+  cPointGrid.Reshape(4, gridShape);
+  if (vtkSVNURBSUtils::SolveAlongAxis(NP, 0, cPointGrid) != SV_OK)
   {
     fprintf(stderr,"System could not be inverted\n");
     return SV_ERROR;
   }
-  if (vtkSVNURBSUtils::MatrixVecMultiply(NPinv, 0, pointArrayFinal, 1, cPointArray) != SV_OK)
-  {
-    return SV_ERROR;
-  }
 
-  if (vtkSVNURBSUtils::TypedArrayToPoints(cPointArray, cPoints) != SV_OK)
+  if (vtkSVNURBSUtils::TensorToPoints(cPointGrid, cPoints) != SV_OK)
   {
     return SV_ERROR;
   }
@@ -2192,52 +2545,24 @@ int vtkSVNURBSUtils::GetControlPointsOfSurface(vtkStructuredGrid *points, vtkDou
     vtkSVNURBSUtils::DeepCopy(pointMatTmp, pointMatFinal);
   }
 
-  int nUCon = pointMatFinal->GetExtents()[0].GetSize();
-  int nVCon = pointMatFinal->GetExtents()[1].GetSize();
-
-  //fprintf(stdout,"Basis functions U:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPUFinal);
-  vtkNew(vtkSparseArray<double>, NPUinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPUFinal, NPUinv) != SV_OK)
-  {
-    fprintf(stderr,"System could not be inverted\n");
-    return SV_ERROR;
-  }
+  // Solve each direction in place, A_u^-1 P A_v^-T without forming inverses
+  vtkSVTensor<double> NPU, NPV, cPointGrid;
+  vtkSVNURBSUtils::TypedArrayToTensor(NPUFinal, NPU);
+  vtkSVNURBSUtils::TypedArrayToTensor(NPVFinal, NPV);
+  vtkSVNURBSUtils::TypedArrayToTensor(pointMatFinal, cPointGrid);
+  vtkIdType gridShape[4] = {cPointGrid.GetShape(0), cPointGrid.GetShape(1), 1, 3};
+  cPointGrid.Reshape(4, gridShape);
 
-  //fprintf(stdout,"Basis functions V:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPVFinal);
-  vtkNew(vtkSparseArray<double>, NPVinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPVFinal, NPVinv) != SV_OK)
+  if (vtkSVNURBSUtils::SolveAlongAxis(NPU, 0, cPointGrid) != SV_OK ||
+      vtkSVNURBSUtils::SolveAlongAxis(NPV, 1, cPointGrid) != SV_OK)
   {
     fprintf(stderr,"System could not be inverted\n");
     return SV_ERROR;
   }
 
-
-  //fprintf(stdout,"Inverted system U:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPUinv);
-  //fprintf(stdout,"Inverted system V:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPVinv);
-  vtkNew(vtkDenseArray<double>, tmpUGrid);
-  if (vtkSVNURBSUtils::MatrixMatrixMultiply(NPUinv, 0, 1, pointMatFinal, 1, 3, tmpUGrid) != SV_OK)
-  {
-    fprintf(stderr, "Error in matrix multiply\n");
-    return SV_ERROR;
-  }
-  vtkNew(vtkDenseArray<double>, tmpUGridT);
-  vtkSVNURBSUtils::MatrixTranspose(tmpUGrid, 1, tmpUGridT);
-  vtkNew(vtkDenseArray<double>, tmpVGrid);
-  if (vtkSVNURBSUtils::MatrixMatrixMultiply(NPVinv, 0, 1, tmpUGridT, 1, 3, tmpVGrid) != SV_OK)
-  {
-    fprintf(stderr, "Error in matrix multiply\n");
-    return SV_ERROR;
-  }
-
   vtkNew(vtkPoints, finalPoints);
   cPoints->SetPoints(finalPoints);
-  vtkNew(vtkDenseArray<double>, tmpVGridT);
-  vtkSVNURBSUtils::MatrixTranspose(tmpVGrid, 1, tmpVGridT);
-  vtkSVNURBSUtils::TypedArrayToStructuredGrid(tmpVGridT, cPoints);
+  vtkSVNURBSUtils::TensorToStructuredGrid(cPointGrid, cPoints);
   //fprintf(stdout,"Final structured grid of control points\n");
   //vtkSVNURBSUtils::PrintStructuredGrid(cPoints);
 
@@ -2328,111 +2653,24 @@ int vtkSVNURBSUtils::GetControlPointsOfVolume(vtkStructuredGrid *points,
     vtkSVNURBSUtils::DeepCopy(pointMatTmp, pointMatFinal);
   }
 
-  int nUCon = pointMatFinal->GetExtents()[0].GetSize();
-  int nVCon = pointMatFinal->GetExtents()[1].GetSize();
-  int nWCon = pointMatFinal->GetExtents()[2].GetSize();
-
-  //fprintf(stdout,"Basis functions U:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPUFinal);
-  vtkNew(vtkSparseArray<double>, NPUinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPUFinal, NPUinv) != SV_OK)
-  {
-    fprintf(stderr,"System could not be inverted\n");
-    return SV_ERROR;
-  }
-
-  //fprintf(stdout,"Basis functions V:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPVFinal);
-  vtkNew(vtkSparseArray<double>, NPVinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPVFinal, NPVinv) != SV_OK)
-  {
-    fprintf(stderr,"System could not be inverted\n");
-    return SV_ERROR;
-  }
+  // Solve each direction in place without forming inverses
+  vtkSVTensor<double> NPU, NPV, NPW, cPointGrid;
+  vtkSVNURBSUtils::TypedArrayToTensor(NPUFinal, NPU);
+  vtkSVNURBSUtils::TypedArrayToTensor(NPVFinal, NPV);
+  vtkSVNURBSUtils::TypedArrayToTensor(NPWFinal, NPW);
+  vtkSVNURBSUtils::TypedArrayToTensor(pointMatFinal, cPointGrid);
 
-  //fprintf(stdout,"Basis functions W:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPWFinal);
-  vtkNew(vtkSparseArray<double>, NPWinv);
-  if (vtkSVNURBSUtils::InvertSystem(NPWFinal, NPWinv) != SV_OK)
+  if (vtkSVNURBSUtils::SolveAlongAxis(NPU, 0, cPointGrid) != SV_OK ||
+      vtkSVNURBSUtils::SolveAlongAxis(NPV, 1, cPointGrid) != SV_OK ||
+      vtkSVNURBSUtils::SolveAlongAxis(NPW, 2, cPointGrid) != SV_OK)
   {
     fprintf(stderr,"System could not be inverted\n");
     return SV_ERROR;
   }
 
-  //fprintf(stdout,"Inverted system U:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPUinv);
-  //fprintf(stdout,"Inverted system V:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPVinv);
-  //fprintf(stdout,"Inverted system W:\n");
-  //vtkSVNURBSUtils::PrintMatrix(NPWinv);
-
-  vtkNew(vtkSparseArray<double>, NPVinvT);
-  vtkSVNURBSUtils::MatrixTranspose(NPVinv, 0, NPVinvT);
-
-  vtkNew(vtkSparseArray<double>, NPWinvT);
-  vtkSVNURBSUtils::MatrixTranspose(NPWinv, 0, NPWinvT);
-
-  int numUDiv = NPUinv->GetExtents()[0].GetSize();
-  int numVDiv = NPVinv->GetExtents()[0].GetSize();
-  int numWDiv = NPWinv->GetExtents()[0].GetSize();
-
-  vtkArrayExtents size;
-  size.SetDimensions(4);
-  size.SetExtent(0, vtkArrayRange(0, numUDiv));
-  size.SetExtent(1, vtkArrayRange(0, numVDiv));
-  size.SetExtent(2, vtkArrayRange(0, nWCon));
-  size.SetExtent(3, vtkArrayRange(0, 3));
-  vtkNew(vtkDenseArray<double>, tmpW);
-  tmpW->Resize(size);
-
-  for (int i=0; i<nWCon; i++)
-  {
-    vtkNew(vtkDenseArray<double>, tmpWMat);
-    vtkSVNURBSUtils::GetMatrixOfDim4Grid(pointMatFinal, 0, 1, 2, i, 3, tmpWMat);
-
-
-    vtkNew(vtkDenseArray<double>, tmpUGrid);
-    if (vtkSVNURBSUtils::MatrixMatrixMultiply(NPUinv, 0, 1, tmpWMat, 1, 3, tmpUGrid) != SV_OK)
-    {
-      fprintf(stderr, "Error in matrix multiply\n");
-      return SV_ERROR;
-    }
-    vtkNew(vtkDenseArray<double>, tmpVGrid);
-    if (vtkSVNURBSUtils::MatrixMatrixMultiply(tmpUGrid, 1, 3, NPVinvT, 0, 1, tmpVGrid) != SV_OK)
-    {
-      fprintf(stderr, "Error in matrix multiply\n");
-      return SV_ERROR;
-    }
-
-    vtkSVNURBSUtils::SetMatrixOfDim4Grid(tmpVGrid, tmpW, 0, 1, 2, i, 3);
-  }
-
-  size.SetExtent(0, vtkArrayRange(0, numUDiv));
-  size.SetExtent(1, vtkArrayRange(0, numVDiv));
-  size.SetExtent(2, vtkArrayRange(0, numWDiv));
-  size.SetExtent(3, vtkArrayRange(0, 3));
-  vtkNew(vtkDenseArray<double>, fullGrid);
-  fullGrid->Resize(size);
-
-  for (int i=0; i<numUDiv; i++)
-  {
-    vtkNew(vtkDenseArray<double>, tmpWGrid);
-    vtkSVNURBSUtils::GetMatrixOfDim4Grid(tmpW, 1, 2, 0, i, 3, tmpWGrid);
-
-    // Do second matrix multiply with v basis functions
-    vtkNew(vtkDenseArray<double>, tmpVWGrid);
-    if (vtkSVNURBSUtils::MatrixMatrixMultiply(tmpWGrid, 1, 3, NPWinvT, 0, 1, tmpVWGrid) != SV_OK)
-    {
-      fprintf(stderr, "Error in matrix multiply\n");
-      return SV_ERROR;
-    }
-
-    vtkSVNURBSUtils::SetMatrixOfDim4Grid(tmpVWGrid, fullGrid, 1, 2, 0, i, 3);
-  }
-
   vtkNew(vtkPoints, finalPoints);
   cPoints->SetPoints(finalPoints);
-  vtkSVNURBSUtils::TypedArrayToStructuredGrid(fullGrid, cPoints);
+  vtkSVNURBSUtils::TensorToStructuredGrid(cPointGrid, cPoints);
   //fprintf(stdout,"Final structured grid of control points\n");
   //vtkSVNURBSUtils::PrintStructuredGrid(cPoints);
 
@@ -2787,253 +3025,92 @@ int vtkSVNURBSUtils::InsertKnot(vtkSVControlGrid *controlPoints,
   int dims[3];
   controlPoints->GetDimensions(dims);
 
-  vtkNew(vtkSVControlGrid, PW);
-  vtkSVNURBSUtils::GetPWFromP(controlPoints, PW);
-
   // Set values used by alg to more concise vars
-  int np   = dims[0]-1;
-  int p    = uDegree;
-  int mp   = dims[1]-1;
-  int q    = vDegree;
   int dir  = insertDirection;
+  if (dir != 0 && dir != 1)
+  {
+    fprintf(stderr,"Invalid insert direction %d given\n", dir);
+    return SV_ERROR;
+  }
+  int p    = dir == 0 ? uDegree : vDegree;
+  int np   = dims[dir]-1;
   double u = insertValue;
   int k    = span;
   int s    = currentMultiplicity;
   int r    = numberOfInserts;
 
+  vtkDoubleArray *knots    = dir == 0 ? uKnots : vKnots;
+  vtkDoubleArray *newKnots = dir == 0 ? newUKnots : newVKnots;
+  vtkDoubleArray *oKnots    = dir == 0 ? vKnots : uKnots;
+  vtkDoubleArray *newOKnots = dir == 0 ? newVKnots : newUKnots;
+
   // Can't possibly add more knots at location than the degree of the curve
-  if ( (r+s) > p && dir == 0)
-  {
-    fprintf(stderr, "Error: number of inserts and current multiplicity cannot exceed the degree of the curve\n");
-  }
-  if ( (r+s) > q && dir == 1)
+  if ( (r+s) > p)
   {
     fprintf(stderr, "Error: number of inserts and current multiplicity cannot exceed the degree of the curve\n");
   }
 
+  // number of knots
+  int nuk = np+p+1;
+
   // Double check to see if correct vals were given
-  if ((np+1)*(mp+1) != PW->GetNumberOfPoints())
+  if (knots->GetNumberOfTuples() != nuk+1)
   {
-    fprintf(stderr,"Invalid number of control points in u or v direction given\n");
+    fprintf(stderr,"Invalid number of control points given with knot span\n");
     return SV_ERROR;
   }
 
-  if (dir == 0)
-  {
-    // number of knots
-    int nuk = np+p+1;
-    int nup  = np+r;
-
-    // Set output number of points and knots
-    newControlPoints->SetNumberOfControlPoints((nup+1)*(mp+1));
-    newControlPoints->SetDimensions(nup+1, mp+1, 1);
-    newUKnots->SetNumberOfTuples(nuk+r+1);
-
-    // Double check to see if correct vals were given
-    if (uKnots->GetNumberOfTuples() != nuk+1)
-    {
-      fprintf(stderr,"Invalid number of control points given with knot span\n");
-      return SV_ERROR;
-    }
-
-    vtkNew(vtkDoubleArray, tmpPoints);
-    tmpPoints->SetNumberOfComponents(4);
-    tmpPoints->SetNumberOfTuples(p+1);
-    // Set unchanging knots
-    for (int i=0; i<=k; i++)
-      newUKnots->SetTuple1(i, uKnots->GetTuple1(i));
+  // Set the new knot span
+  newKnots->SetNumberOfTuples(nuk+r+1);
 
-    // Set the new knot r times
-    for (int i=1; i<=r; i++)
-      newUKnots->SetTuple1(k+i, u);
+  // Set unchanging knots
+  for (int i=0; i<=k; i++)
+    newKnots->SetTuple1(i, knots->GetTuple1(i));
 
-    // Set the rest of the new knot span
-    for (int i=k+1; i<=nuk; i++)
-      newUKnots->SetTuple1(i+r, uKnots->GetTuple1(i));
+  // Set the new knot r times
+  for (int i=1; i<=r; i++)
+    newKnots->SetTuple1(k+i, u);
 
-    // Copy the v knot vector to output
-    if (newVKnots != NULL && vKnots != NULL)
-      newVKnots->DeepCopy(vKnots);
+  // Set the rest of the new knot span
+  for (int i=k+1; i<=nuk; i++)
+    newKnots->SetTuple1(i+r, knots->GetTuple1(i));
 
-    // Set up alpha array
-    double **alpha = new double*[p-s];
-    for (int i=0; i<p-s; i++)
-      alpha[i] = new double[r+1];
+  // Copy the other knot vector to output
+  if (newOKnots != NULL && oKnots != NULL)
+    newOKnots->DeepCopy(oKnots);
 
-    // Preload all the alphas
-    for (int j=1; j<=r; j++)
-    {
-      int L = k-p+j;
-      for (int i=0; i<=p-j-s; i++)
-        alpha[i][j] = (u - uKnots->GetTuple1(L+i))/(uKnots->GetTuple1(i+k+1)-uKnots->GetTuple1(L+i));
-    }
+  // Contiguous homogeneous points, output has r more along dir
+  vtkSVTensorView<const double> PW = controlPoints->GetHomogeneousPoints();
+  if (PW.GetData() == NULL)
+    return SV_ERROR;
+  vtkSVTensor<double> QW;
+  int newDims[3] = {dims[0], dims[1], dims[2]};
+  newDims[dir] += r;
+  QW.Resize(newDims[0], newDims[1], newDims[2], 4);
 
-    // Insert knot each column
-    for (int col=0; col<=mp; col++)
+  // Insert the knot in each fiber along dir
+  vtkSVTensorView<const double> inGrid  = PW.SwapAxes(0, dir);
+  vtkSVTensorView<double>       outGrid = QW.GetView().SwapAxes(0, dir);
+  std::vector<double> scratch;
+  for (int j=0; j<inGrid.GetShape(1); j++)
+  {
+    for (int l=0; l<inGrid.GetShape(2); l++)
     {
-      // Set unchanging control points
-      for (int i=0; i<=k-p; i++)
-      {
-        double pw[4];
-        PW->GetControlPoint(i, col, 0, pw);
-        newControlPoints->SetControlPoint(i, col, 0, pw);
-      }
-
-      for (int i=k-s; i<=np; i++)
-      {
-        double pw[4];
-        PW->GetControlPoint(i, col, 0, pw);
-        newControlPoints->SetControlPoint(i+r, col, 0, pw);
-      }
-
-      // Set up tmp points
-      for (int i=0; i<=p-s; i++)
-      {
-        double pw[4];
-        PW->GetControlPoint(k-p+i, col, 0, pw);
-        tmpPoints->SetTuple(i, pw);
-      }
-
-      // Insert the new knot r times
-      int L=0;
-      for (int j=1; j<=r; j++)
+      if (vtkSVNURBSUtils::InsertKnotFiber(inGrid.Slice(2, l).Slice(1, j),
+                                           knots->GetPointer(0), p, u, k, s, r,
+                                           outGrid.Slice(2, l).Slice(1, j),
+                                           scratch) != SV_OK)
       {
-        L = k-p+j;
-        for (int i=0; i<=p-j-s; i++)
-        {
-          double pt0[4], pt1[4], newPoint[4];
-          tmpPoints->GetTuple(i+1, pt0);
-          tmpPoints->GetTuple(i, pt1);
-          vtkSVMathUtils::Add(pt0, alpha[i][j], pt1, 1.0-alpha[i][j], 4, newPoint);
-          tmpPoints->SetTuple(i, newPoint);
-
-          // Fill the control point grid with the tmp points
-          newControlPoints->SetControlPoint(L, col, 0, tmpPoints->GetTuple(0));
-          newControlPoints->SetControlPoint(k+r-j-s, col, 0, tmpPoints->GetTuple(p-j-s));
-        }
+        return SV_ERROR;
       }
-      for (int i=L+1; i<k-s; i++)
-        newControlPoints->SetControlPoint(i, col, 0, tmpPoints->GetTuple(i-L));
-
     }
-
-    // Clean up alphas
-    for (int i=0; i<p-s; i++)
-      delete [] alpha[i];
-    delete [] alpha;
-
   }
-  // Other dir!!
-  else if (dir == 1)
-  {
-    // number of knots
-    int nuk = mp+q+1;
-    int nup  = mp+r;
-
-    // Set output number of points and knots
-    newControlPoints->SetNumberOfControlPoints((nup+1)*(np+1));
-    newControlPoints->SetDimensions(np+1, nup+1, 1);
-    newVKnots->SetNumberOfTuples(nuk+r+1);
-
-    // Double check to see if correct vals were given
-    if (vKnots->GetNumberOfTuples() != nuk+1)
-    {
-      fprintf(stderr,"Invalid number of control points given with knot span\n");
-      return SV_ERROR;
-    }
-
-    vtkNew(vtkDoubleArray, tmpPoints);
-    tmpPoints->SetNumberOfComponents(4);
-    tmpPoints->SetNumberOfTuples(p+1);
-    // Set unchanging knots
-    for (int i=0; i<=k; i++)
-      newVKnots->SetTuple1(i, vKnots->GetTuple1(i));
-
-    // Set the new knot r times
-    for (int i=1; i<=r; i++)
-      newVKnots->SetTuple1(k+i, u);
 
-    // Set the rest of the new knot span
-    for (int i=k+1; i<=nuk; i++)
-      newVKnots->SetTuple1(i+r, vKnots->GetTuple1(i));
+  // Hand the homogeneous points to the output grid
+  newControlPoints->SetHomogeneousPoints(QW);
 
-    // Copy the u knot vector to output
-    if (newUKnots != NULL && uKnots != NULL)
-      newUKnots->DeepCopy(uKnots);
-
-    // Set up alpha array
-    double **alpha = new double*[q-s];
-    for (int i=0; i<q-s; i++)
-      alpha[i] = new double[r+1];
-
-    // Preload all the alphas
-    for (int j=1; j<=r; j++)
-    {
-      int L = k-q+j;
-      for (int i=0; i<=q-j-s; j++)
-        alpha[i][j] = (u - vKnots->GetTuple1(L+i))/(vKnots->GetTuple1(i+k+1)-vKnots->GetTuple1(L+i));
-    }
-
-    // Insert knot each row
-    for (int row=0; row<=np; row++)
-    {
-      // Set unchanging control points
-      for (int i=0; i<=k-q; i++)
-      {
-        double pw[4];
-        PW->GetControlPoint(row, i, 0, pw);
-        newControlPoints->SetControlPoint(row, i, 0, pw);
-      }
-
-      for (int i=k-s; i<=mp; i++)
-      {
-        double pw[4];
-        PW->GetControlPoint(row, i, 0, pw);
-        newControlPoints->SetControlPoint(row, i+r, 0, pw);
-      }
-
-      // Set up tmp points
-      for (int i=0; i<=q-s; i++)
-      {
-        double pw[4];
-        PW->GetControlPoint(row, k-q+i, 0, pw);
-        tmpPoints->SetTuple(i, pw);
-      }
-
-      // Insert the new knot r times
-      int L=0;
-      for (int j=1; j<=r; j++)
-      {
-        L = k-q+j;
-        for (int i=0; i<=q-j-s; i++)
-        {
-          double pt0[4], pt1[4], newPoint[4];
-          tmpPoints->GetTuple(i+1, pt0);
-          tmpPoints->GetTuple(i, pt1);
-          vtkSVMathUtils::Add(pt0, alpha[i][j], pt1, 1.0-alpha[i][j], 4, newPoint);
-          tmpPoints->SetTuple(i, newPoint);
-
-          // Fill the control point grid with the tmp points
-          newControlPoints->SetControlPoint(row, L, 0, tmpPoints->GetTuple(0));
-          newControlPoints->SetControlPoint(row, k+r-j-s, 0, tmpPoints->GetTuple(q-j-s));
-        }
-      }
-
-      for (int i=L+1; i<k-s; i++)
-        newControlPoints->SetControlPoint(row, i, 0, tmpPoints->GetTuple(i-L));
-    }
-
-    // Clean up alphas
-    for (int i=0; i<q-s; i++)
-      delete [] alpha[i];
-    delete [] alpha;
-  }
-
-  // Realy quick, convert everything back to just p
-  vtkSVNURBSUtils::GetPFromPW(newControlPoints);
-
-  return SV_OK;
-}
+  return SV_OK;
+}
 
 // ----------------------
 // KnotRefinement
@@ -3051,233 +3128,71 @@ int vtkSVNURBSUtils::KnotRefinement(vtkSVControlGrid *controlPoints,
   int dims[3];
   controlPoints->GetDimensions(dims);
 
-  // Really quick, convert all points to pw
-  vtkNew(vtkSVControlGrid, PW);
-  vtkSVNURBSUtils::GetPWFromP(controlPoints, PW);
-
   // Set values used by alg to more concise vars
-  int n = dims[0]-1;
-  int p = uDegree;
-  int m = dims[1]-1;
-  int q = vDegree;
   int dir = insertDirection;
+  if (dir != 0 && dir != 1)
+  {
+    fprintf(stderr,"Invalid insert direction %d given\n", dir);
+    return SV_ERROR;
+  }
+  int p = dir == 0 ? uDegree : vDegree;
+  int n = dims[dir]-1;
   int r = insertKnots->GetNumberOfTuples()-1;
 
+  vtkDoubleArray *knots    = dir == 0 ? uKnots : vKnots;
+  vtkDoubleArray *newKnots = dir == 0 ? newUKnots : newVKnots;
+  vtkDoubleArray *oKnots    = dir == 0 ? vKnots : uKnots;
+  vtkDoubleArray *newOKnots = dir == 0 ? newVKnots : newUKnots;
+
   // Number knots
   int nuk = n+p+1;
-  int nvk = m+q+1;
 
-  if (dir == 0)
+  // Double check to see if correct vals were given
+  if (knots->GetNumberOfTuples() != nuk+1)
   {
-    // Double check to see if correct vals were given
-    if (uKnots->GetNumberOfTuples() != nuk+1)
-    {
-      fprintf(stderr,"Invalid number of control points given with u knot span\n");
-      return SV_ERROR;
-    }
-
-    int a, b;
-    vtkSVNURBSUtils::FindSpan(p, insertKnots->GetTuple1(0), uKnots, a);
-    vtkSVNURBSUtils::FindSpan(p, insertKnots->GetTuple1(r), uKnots, b);
-    b++;
-
-    newControlPoints->SetNumberOfControlPoints((n+r+2)*(m+1));
-    newControlPoints->SetDimensions(n+r+2, m+1, 1);
-    newUKnots->SetNumberOfTuples(nuk+r+2);
-
-    // Pass unchanging control points before new
-    for (int col=0; col<=m; col++)
-    {
-      for (int i=0; i<=a-p; i++)
-      {
-        double pw[4];
-        PW->GetControlPoint(i, col, 0, pw);
-        newControlPoints->SetControlPoint(i, col, 0, pw);
-      }
-
-      // Set unchanging control points after new
-      for (int i=b-1; i<=n; i++)
-      {
-        double pw[4];
-        PW->GetControlPoint(i, col, 0, pw);
-        newControlPoints->SetControlPoint(i+r+1, col, 0, pw);
-      }
-    }
-
-    // Set unchanging knots before new ones
-    for (int i=0; i<=a; i++)
-      newUKnots->SetTuple1(i, uKnots->GetTuple1(i));
-
-    // Set unchanging knots after new ones
-    for (int i=b+p; i<=nuk; i++)
-      newUKnots->SetTuple1(i+r+1, uKnots->GetTuple1(i));
-
-    // Copy v knot span to new v knots span
-    if(newVKnots != NULL && vKnots != NULL)
-      newVKnots->DeepCopy(vKnots);
-
-    // Set iter vars
-    int i=b+p-1;
-    int k=b+p+r;
-
-    // Loop through and calc new cps
-    for (int j=r; j>=0; j--)
-    {
-      while(insertKnots->GetTuple1(j) <= uKnots->GetTuple1(i) && i > a)
-      {
-        for (int col=0; col<=m; col++)
-        {
-          double pw[4];
-          PW->GetControlPoint(i-p-1, col, 0, pw);
-          newControlPoints->SetControlPoint(k-p-1, col, 0, pw);
-        }
-        newUKnots->SetTuple1(k, uKnots->GetTuple1(i));
-        k--;
-        i--;
-      }
-      for (int col=0; col<=m; col++)
-      {
-        double pdw[4];
-        newControlPoints->GetControlPoint(k-p, col, 0, pdw);
-        newControlPoints->SetControlPoint(k-p-1, col, 0, pdw);
-      }
-      for (int l=1; l<=p; l++)
-      {
-        int ind = k-p+l;
-        double alpha = newUKnots->GetTuple1(k+l) - insertKnots->GetTuple1(j);
-        if (fabs(alpha) >= -1.e-10 && fabs(alpha) <= 1.0e-10)
-        {
-          for (int col=0; col<=m; col++)
-          {
-            double pw[4];
-            newControlPoints->GetControlPoint(ind, col, 0, pw);
-            newControlPoints->SetControlPoint(ind-1, col, 0, pw);
-          }
-        }
-        else
-        {
-          alpha = alpha/(newUKnots->GetTuple1(k+l) - uKnots->GetTuple1(i-p+l));
-          for (int col=0; col<=m; col++)
-          {
-            double pw0[4], pw1[4], newPoint[4];
-            newControlPoints->GetControlPoint(ind-1, col, 0, pw0);
-            newControlPoints->GetControlPoint(ind, col, 0, pw1);
-            vtkSVMathUtils::Add(pw0, alpha, pw1, 1.0-alpha, 4, newPoint);
-            newControlPoints->SetControlPoint(ind-1, col, 0, newPoint);
-          }
-        }
-      }
-      newUKnots->SetTuple1(k, insertKnots->GetTuple1(j));
-      k--;
-    }
+    fprintf(stderr,"Invalid number of control points given with %s knot span\n", dir == 0 ? "u" : "v");
+    return SV_ERROR;
   }
-  else if (dir == 1)
-  {
-    // Double check to see if correct vals were given
-    if (vKnots->GetNumberOfTuples() != nvk+1)
-    {
-      fprintf(stderr,"Invalid number of control points given with v knot span\n");
-      return SV_ERROR;
-    }
-
-    int a, b;
-    vtkSVNURBSUtils::FindSpan(q, insertKnots->GetTuple1(0), vKnots, a);
-    vtkSVNURBSUtils::FindSpan(q, insertKnots->GetTuple1(r), vKnots, b);
-    b++;
-
-    newControlPoints->SetNumberOfControlPoints((m+r+2)*(n+1));
-    newControlPoints->SetDimensions(n+1, m+r+2, 1);
-    newVKnots->SetNumberOfTuples(nvk+r+2);
 
-    // Pass unchanging control points before new
-    for (int row=0; row<=n; row++)
-    {
-      for (int i=0; i<=a-q; i++)
-      {
-        double pw[4];
-        PW->GetControlPoint(row, i, 0, pw);
-        newControlPoints->SetControlPoint(row, i, 0, pw);
-      }
-
-      // Set unchanging control points after new
-      for (int i=b-1; i<=m; i++)
-      {
-        double pw[4];
-        PW->GetControlPoint(row, i, 0, pw);
-        newControlPoints->SetControlPoint(row, i+r+1, 0, pw);
-      }
-    }
-
-    // Set unchanging knots before new ones
-    for (int i=0; i<=a; i++)
-      newVKnots->SetTuple1(i, vKnots->GetTuple1(i));
+  // Get the new knot span
+  newKnots->SetNumberOfTuples(nuk+r+2);
+  vtkSVNURBSUtils::GetRefinedKnots(knots->GetPointer(0), nuk+1, p,
+                                   insertKnots->GetPointer(0), r+1,
+                                   newKnots->GetPointer(0));
 
-    // Set unchanging knots after new ones
-    for (int i=b+q; i<=nvk; i++)
-      newVKnots->SetTuple1(i+r+1, vKnots->GetTuple1(i));
-
-    // Copy u knot span to new u knots span
-    if (newUKnots != NULL && uKnots != NULL)
-      newUKnots->DeepCopy(uKnots);
+  // Copy other knot span to new knots span
+  if(newOKnots != NULL && oKnots != NULL)
+    newOKnots->DeepCopy(oKnots);
 
-    // Set iter vars
-    int i=b+q-1;
-    int k=b+q+r;
+  // Contiguous homogeneous points, output has r+1 more along dir
+  vtkSVTensorView<const double> PW = controlPoints->GetHomogeneousPoints();
+  if (PW.GetData() == NULL)
+    return SV_ERROR;
+  vtkSVTensor<double> QW;
+  int newDims[3] = {dims[0], dims[1], dims[2]};
+  newDims[dir] += r+1;
+  QW.Resize(newDims[0], newDims[1], newDims[2], 4);
 
-    // Loop through and calc new cps
-    for (int j=r; j>=0; j--)
+  // Refine each fiber along dir
+  vtkSVTensorView<const double> inGrid  = PW.SwapAxes(0, dir);
+  vtkSVTensorView<double>       outGrid = QW.GetView().SwapAxes(0, dir);
+  for (int j=0; j<inGrid.GetShape(1); j++)
+  {
+    for (int l=0; l<inGrid.GetShape(2); l++)
     {
-      while(insertKnots->GetTuple1(j) <= vKnots->GetTuple1(i) && i > a)
-      {
-        for (int row=0; row<=n; row++)
-        {
-          double pw[4];
-          PW->GetControlPoint(row, i-q-1, 0, pw);
-          newControlPoints->SetControlPoint(row, k-q-1, 0, pw);
-        }
-        newVKnots->SetTuple1(k, vKnots->GetTuple1(i));
-        k--;
-        i--;
-      }
-      for (int row=0; row<=n; row++)
-      {
-        double pdw[4];
-        newControlPoints->GetControlPoint(row, k-q, 0, pdw);
-        newControlPoints->SetControlPoint(row, k-q-1, 0, pdw);
-      }
-      for (int l=1; l<=q; l++)
+      if (vtkSVNURBSUtils::KnotRefinementFiber(inGrid.Slice(2, l).Slice(1, j),
+                                               knots->GetPointer(0), p,
+                                               insertKnots->GetPointer(0), r+1,
+                                               newKnots->GetPointer(0),
+                                               outGrid.Slice(2, l).Slice(1, j)) != SV_OK)
       {
-        int ind = k-q+l;
-        double alpha = newVKnots->GetTuple1(k+l) - insertKnots->GetTuple1(j);
-        if (fabs(alpha) >= -1.e-10 && fabs(alpha) <= 1.0e-10)
-        {
-          for (int row=0; row<=n; row++)
-          {
-            double pw[4];
-            newControlPoints->GetControlPoint(row, ind, 0, pw);
-            newControlPoints->SetControlPoint(row, ind-1, 0, pw);
-          }
-        }
-        else
-        {
-          alpha = alpha/(newVKnots->GetTuple1(k+l) - vKnots->GetTuple1(i-q+l));
-          for (int row=0; row<=n; row++)
-          {
-            double pw0[4], pw1[4], newPoint[4];
-            newControlPoints->GetControlPoint(row, ind-1, 0, pw0);
-            newControlPoints->GetControlPoint(row, ind, 0, pw1);
-            vtkSVMathUtils::Add(pw0, alpha, pw1, 1.0-alpha, 4, newPoint);
-            newControlPoints->SetControlPoint(row, ind-1, 0, newPoint);
-          }
-        }
+        return SV_ERROR;
       }
-      newVKnots->SetTuple1(k, insertKnots->GetTuple1(j));
-      k--;
     }
   }
 
-  // Convert back from weighted points
-  vtkSVNURBSUtils::GetPFromPW(newControlPoints);
+  // Hand the homogeneous points to the output grid
+  newControlPoints->SetHomogeneousPoints(QW);
 
   return SV_OK;
 }
@@ -3614,680 +3529,1004 @@ int vtkSVNURBSUtils::IncreaseDegree(vtkSVControlGrid *controlPoints,
   int dims[3];
   controlPoints->GetDimensions(dims);
 
-  // Really quick, convert all points to pw
-  vtkNew(vtkSVControlGrid, PW);
-  vtkSVNURBSUtils::GetPWFromP(controlPoints, PW);
-
   // Set values used by alg to more concise vars
-  int n   = dims[0]-1;
-  int m   = dims[1]-1;
-  int p   = uDegree;
-  int q   = vDegree;
-  int t   = numberOfIncreases;
   int dir = increaseDirection;
-
-  int nuk = n+p+1;
-  int nvk = m+q+1;
-
-  if (dir == 0)
+  if (dir != 0 && dir != 1)
   {
-    // Double check to see if correct vals were given
-    if (uKnots->GetNumberOfTuples() != nuk+1)
-    {
-      fprintf(stderr,"Invalid number of control points given with knot span\n");
-      return SV_ERROR;
-    }
-    // Compute s by cmputing the number of non-repeated internal knot vals
-    vtkNew(vtkIntArray, multiplicity);
-    vtkNew(vtkDoubleArray, singleValues);
-    vtkSVNURBSUtils::GetMultiplicity(uKnots, multiplicity, singleValues);
-
-    // S s is length of mult vector minus 2 (p+1 ends)
-    int s = multiplicity->GetNumberOfTuples() - 2;
-    int nukhat = nuk+t*(s+2);
-    int nhat = n+t*(s+1);
+    fprintf(stderr,"Invalid increase direction %d given\n", dir);
+    return SV_ERROR;
+  }
+  int n   = dims[dir]-1;
+  int p   = dir == 0 ? uDegree : vDegree;
+  int t   = numberOfIncreases;
 
-    // New degree
-    int ph  = p+t;
-    int ph2 = ph/2;
+  vtkDoubleArray *knots    = dir == 0 ? uKnots : vKnots;
+  vtkDoubleArray *newKnots = dir == 0 ? newUKnots : newVKnots;
+  vtkDoubleArray *oKnots    = dir == 0 ? vKnots : uKnots;
+  vtkDoubleArray *newOKnots = dir == 0 ? newVKnots : newUKnots;
 
-    // Set up new knots, just bezier knot span
-    newUKnots->SetNumberOfTuples(nukhat+1);
-    if (newVKnots != NULL && vKnots != NULL)
-      newVKnots->DeepCopy(vKnots);
+  int nuk = n+p+1;
 
-    // New control points, updated each time for new bezier curve
-    newControlPoints->SetNumberOfControlPoints((nhat+1)*(m+1));
-    newControlPoints->SetDimensions(nhat+1, m+1, 1);
+  // Double check to see if correct vals were given
+  if (knots->GetNumberOfTuples() != nuk+1)
+  {
+    fprintf(stderr,"Invalid number of control points given with knot span\n");
+    return SV_ERROR;
+  }
 
-    // Set up tmp arrays
-    // Coeffecients for degree elevation
-    vtkNew(vtkDoubleArray, bezalphas);
-    bezalphas->SetNumberOfComponents(p+1);
-    bezalphas->SetNumberOfTuples(p+t+1);
+  // Compute s by cmputing the number of non-repeated internal knot vals
+  vtkNew(vtkIntArray, multiplicity);
+  vtkNew(vtkDoubleArray, singleValues);
+  vtkSVNURBSUtils::GetMultiplicity(knots, multiplicity, singleValues);
 
-    // Bezier control strips, degree p
-    vtkNew(vtkSVControlGrid, bpts);
-    bpts->SetNumberOfControlPoints((p+1)*(m+1));
-    bpts->SetDimensions(p+1, m+1, 1);
+  // S s is length of mult vector minus 2 (p+1 ends)
+  int s = multiplicity->GetNumberOfTuples() - 2;
+  int nukhat = nuk+t*(s+2);
+  int nhat = n+t*(s+1);
 
-    // Bezier control points, degree p+t
-    vtkNew(vtkSVControlGrid, ebpts);
-    ebpts->SetNumberOfControlPoints((p+t+1)*(m+1));
-    ebpts->SetDimensions(p+t+1, m+1, 1);
+  // Set up new knots
+  newKnots->SetNumberOfTuples(nukhat+1);
+  if (newOKnots != NULL && oKnots != NULL)
+    newOKnots->DeepCopy(oKnots);
 
-    // Leftmost control pionts of next Bezier segment
-    vtkNew(vtkSVControlGrid, nextbpts);
-    nextbpts->SetNumberOfControlPoints((p-1)*(m+1));
-    nextbpts->SetDimensions(p-1, m+1, 1);
+  // Coeffecients for degree elevation, shared by all fibers
+  vtkSVTensor<double> bezalfs;
+  vtkSVNURBSUtils::GetDegreeElevationCoefficients(p, t, bezalfs);
 
-    // Alpha values for knot insertion
-    vtkNew(vtkDoubleArray, alphas);
-    alphas->SetNumberOfTuples(p-1);
+  // Contiguous homogeneous points
+  vtkSVTensorView<const double> PW = controlPoints->GetHomogeneousPoints();
+  if (PW.GetData() == NULL)
+    return SV_ERROR;
+  vtkSVTensor<double> QW;
+  int newDims[3] = {dims[0], dims[1], dims[2]};
+  newDims[dir] = nhat+1;
+  QW.Resize(newDims[0], newDims[1], newDims[2], 4);
 
-    //Compute coefficients
-    bezalphas->SetComponent(0, 0, 1.0);
-    bezalphas->SetComponent(ph, p, 1.0);
-    for (int i=1; i<=ph2; i++)
+  // Elevate each fiber along dir, knots are the same for each
+  vtkSVTensorView<const double> inGrid  = PW.SwapAxes(0, dir);
+  vtkSVTensorView<double>       outGrid = QW.GetView().SwapAxes(0, dir);
+  std::vector<double> scratch;
+  for (int j=0; j<inGrid.GetShape(1); j++)
+  {
+    for (int l=0; l<inGrid.GetShape(2); l++)
     {
-      double inv = 1.0/vtkSVMathUtils::Binom(ph, i);
-      int mpi = svminimum(p, i);
-      for (int j=svmaximum(0, i-t); j<=mpi; j++)
+      int nh;
+      if (vtkSVNURBSUtils::IncreaseDegreeFiber(inGrid.Slice(2, l).Slice(1, j),
+                                               knots->GetPointer(0), p, t,
+                                               bezalfs,
+                                               outGrid.Slice(2, l).Slice(1, j),
+                                               newKnots->GetPointer(0), nh,
+                                               scratch) != SV_OK)
+      {
+        return SV_ERROR;
+      }
+      if (nh != nhat)
       {
-        double newVal = inv*vtkSVMathUtils::Binom(p, j)*vtkSVMathUtils::Binom(t, i-j);
-        bezalphas->SetComponent(i, j, newVal);
+        fprintf(stderr,"Something went wrong: nhat %d does not equal iter n %d\n", nhat, nh);
+        return SV_ERROR;
       }
     }
+  }
 
-    for (int i=ph2+1; i<=ph-1; i++)
-    {
-      int mpi = svminimum(p, i);
-      for (int j=svmaximum(0, i-t); j<=mpi; j++)
-        bezalphas->SetComponent(i, j, bezalphas->GetComponent(ph-i, p-j));
-    }
+  // Hand the homogeneous points to the output grid
+  newControlPoints->SetHomogeneousPoints(QW);
 
-    // Set up iter vars
-    int nukh   =  ph;
-    int kind =  ph+1;
-    int r    = -1;
-    int a    =  p;
-    int b    =  p+1;
-    int cind =  1;
-    double ua = uKnots->GetTuple1(0);
+  return SV_OK;
+}
 
-    // Pass the first control point
-    for (int col=0; col<=m; col++)
-    {
-      double firstpw[4];
-      PW->GetControlPoint(0, col, 0, firstpw);
-      newControlPoints->SetControlPoint(0, col, 0, firstpw);
-    }
+// ----------------------
+// InsertKnotFiber
+// ----------------------
+int vtkSVNURBSUtils::InsertKnotFiber(vtkSVTensorView<const double> Pw,
+                                     const double *knots, const int p,
+                                     const double u, const int span,
+                                     const int currentMultiplicity,
+                                     const int numberOfInserts,
+                                     vtkSVTensorView<double> Qw,
+                                     std::vector<double> &scratch)
+{
+  // Set values used by alg to more concise vars
+  int np = Pw.GetShape(0)-1;
+  int k  = span;
+  int s  = currentMultiplicity;
+  int r  = numberOfInserts;
 
-    for (int i=0; i<=ph; i++)
-      newUKnots->SetTuple1(i, ua);
+  if (Qw.GetShape(0) != np+r+1 || p-s < 0)
+  {
+    fprintf(stderr,"Invalid output size or multiplicity given for knot insertion\n");
+    return SV_ERROR;
+  }
 
-    // Initialize the first bezier segment.
-    for (int i=0; i<=p; i++)
+  // Local points, p+1 homogeneous points
+  scratch.resize(4*(p+1));
+  double *Rw = &scratch[0];
+
+  // Set unchanging control points
+  for (int i=0; i<=k-p; i++)
+    Copy4(Pw.GetPointer(i), Qw.GetPointer(i));
+  for (int i=k-s; i<=np; i++)
+    Copy4(Pw.GetPointer(i), Qw.GetPointer(i+r));
+
+  // Set up tmp points
+  for (int i=0; i<=p-s; i++)
+    Copy4(Pw.GetPointer(k-p+i), Rw+4*i);
+
+  // Insert the new knot r times
+  int L = k-p;
+  for (int j=1; j<=r; j++)
+  {
+    L = k-p+j;
+    for (int i=0; i<=p-j-s; i++)
     {
-      for (int col=0; col<=m; col++)
-      {
-        double pw[4];
-        PW->GetControlPoint(i, col , 0, pw);
-        bpts->SetControlPoint(i, col, 0, pw);
-      }
+      double alpha = (u - knots[L+i])/(knots[i+k+1] - knots[L+i]);
+      Blend4(Rw+4*(i+1), alpha, Rw+4*i, Rw+4*i);
     }
+    Copy4(Rw, Qw.GetPointer(L));
+    Copy4(Rw+4*(p-j-s), Qw.GetPointer(k+r-j-s));
+  }
 
-    // Loop through knot vector
-    while (b<nuk)
-    {
-      // Calculate mult
-      int i=b;
-      while (b<nuk && uKnots->GetTuple1(b) == uKnots->GetTuple1(b+1))
-        b++;
+  // Load the remaining control points
+  for (int i=L+1; i<k-s; i++)
+    Copy4(Rw+4*(i-L), Qw.GetPointer(i));
 
-      // Set up iter vars
-      int mul   = b-i+1;
-      nukh        = nukh+mul+t;
-      double ub = uKnots->GetTuple1(b);
-      int oldr  = r;
-      r = p-mul;
+  return SV_OK;
+}
 
-      // r multiplicities
-      int lbz;
-      if (oldr > 0)
-        lbz = (oldr+2)/2;
-      else
-        lbz = 1;
-      int rbz;
-      if (r >0)
-        rbz = ph-(r+1)/2;
-      else
-        rbz = ph;
+// ----------------------
+// GetElevatedKnots
+// ----------------------
+int vtkSVNURBSUtils::GetElevatedKnots(const double *knots, const int numKnots,
+                                      const int numberOfIncreases,
+                                      std::vector<double> &newKnots)
+{
+  newKnots.clear();
+  int i=0;
+  while (i<numKnots)
+  {
+    int mult = 1;
+    while (i+mult < numKnots && knots[i+mult] == knots[i])
+      mult++;
+    newKnots.insert(newKnots.end(), mult+numberOfIncreases, knots[i]);
+    i += mult;
+  }
 
-      // Insert this knot r times
-      // Extract bezier segment
-      if (r>0)
-      {
-        double numer = ub - ua;
-        for (int k=p; k>mul; k--)
-          alphas->SetTuple1(k-mul-1, numer/(uKnots->GetTuple1(a+k)-ua));
+  return SV_OK;
+}
 
-        for (int j=1; j<=r; j++)
-        {
-          int save = r-j;
-          int mulj = mul+j;
-          for (int k=p; k>=mulj; k--)
-          {
-            double alpha = alphas->GetTuple1(k-mulj);
-            for (int col=0; col<=m; col++)
-            {
-              double pw0[4], pw1[4], newPoint[4];
-              bpts->GetControlPoint(k, col, 0,  pw0);
-              bpts->GetControlPoint(k-1, col, 0, pw1);
-              vtkSVMathUtils::Add(pw0, alpha, pw1, 1.0-alpha, 4, newPoint);
-              bpts->SetControlPoint(k, col, 0, newPoint);
-            }
-          }
-          for (int col=0; col<=m; col++)
-          {
-            double pw[4];
-            bpts->GetControlPoint(p, col, 0,  pw);
-            nextbpts->SetControlPoint(save, col, 0,  pw);
-          }
-        }
-      }
+// ----------------------
+// GetRefinedKnots
+// ----------------------
+int vtkSVNURBSUtils::GetRefinedKnots(const double *knots, const int numKnots,
+                                     const int p, const double *insertKnots,
+                                     const int numberOfInsertKnots,
+                                     double *newKnots)
+{
+  int nuk = numKnots-1;
+  int n   = nuk-p-1;
+  int r   = numberOfInsertKnots-1;
+
+  int a = FindSpanInKnots(p, n, insertKnots[0], knots);
+  int b = FindSpanInKnots(p, n, insertKnots[r], knots)+1;
+
+  // Set unchanging knots before and after new ones
+  for (int i=0; i<=a; i++)
+    newKnots[i] = knots[i];
+  for (int i=b+p; i<=nuk; i++)
+    newKnots[i+r+1] = knots[i];
+
+  // Merge from the back
+  int i=b+p-1;
+  int k=b+p+r;
+  for (int j=r; j>=0; j--)
+  {
+    while (insertKnots[j] <= knots[i] && i > a)
+    {
+      newKnots[k] = knots[i];
+      k--;
+      i--;
+    }
+    newKnots[k] = insertKnots[j];
+    k--;
+  }
+
+  return SV_OK;
+}
 
-      // Elevate degree of segment
-      for (int i=lbz; i<=ph; i++)
+// ----------------------
+// KnotRefinementFiber
+// ----------------------
+int vtkSVNURBSUtils::KnotRefinementFiber(vtkSVTensorView<const double> Pw,
+                                         const double *knots, const int p,
+                                         const double *insertKnots,
+                                         const int numberOfInsertKnots,
+                                         const double *newKnots,
+                                         vtkSVTensorView<double> Qw)
+{
+  int n = Pw.GetShape(0)-1;
+  int r = numberOfInsertKnots-1;
+
+  if (Qw.GetShape(0) != n+r+2)
+  {
+    fprintf(stderr,"Invalid output size given for knot refinement\n");
+    return SV_ERROR;
+  }
+
+  int a = FindSpanInKnots(p, n, insertKnots[0], knots);
+  int b = FindSpanInKnots(p, n, insertKnots[r], knots)+1;
+
+  // Pass unchanging control points before and after new
+  for (int i=0; i<=a-p; i++)
+    Copy4(Pw.GetPointer(i), Qw.GetPointer(i));
+  for (int i=b-1; i<=n; i++)
+    Copy4(Pw.GetPointer(i), Qw.GetPointer(i+r+1));
+
+  // Set iter vars
+  int i=b+p-1;
+  int k=b+p+r;
+
+  // Loop through and calc new cps
+  for (int j=r; j>=0; j--)
+  {
+    while (insertKnots[j] <= knots[i] && i > a)
+    {
+      Copy4(Pw.GetPointer(i-p-1), Qw.GetPointer(k-p-1));
+      k--;
+      i--;
+    }
+    Copy4(Qw.GetPointer(k-p), Qw.GetPointer(k-p-1));
+    for (int l=1; l<=p; l++)
+    {
+      int ind = k-p+l;
+      double alpha = newKnots[k+l] - insertKnots[j];
+      if (fabs(alpha) <= 1.0e-10)
+        Copy4(Qw.GetPointer(ind), Qw.GetPointer(ind-1));
+      else
       {
-        for (int col=0; col<=m; col++)
-        {
-          double zero[4] = {0.0, 0.0, 0.0, 0.0};
-          ebpts->SetControlPoint(i, col, 0,  zero);
-        }
-        int mpi = svminimum(p, i);
-        for (int j=svmaximum(0, i-t); j<=mpi; j++)
-        {
-          for (int col=0; col<=m; col++)
-          {
-            double pw0[4], pw1[4], newPoint[4];
-            int dimers[3];
-            ebpts->GetDimensions(dimers);
-            ebpts->GetControlPoint(i, col, 0,  pw0);
-            bpts->GetControlPoint(j, col, 0, pw1);
-            vtkSVMathUtils::Add(pw0, 1.0, pw1, bezalphas->GetComponent(i, j), 4, newPoint);
-            ebpts->SetControlPoint(i, col, 0, newPoint);
-          }
-        }
+        alpha = alpha/(newKnots[k+l] - knots[i-p+l]);
+        Blend4(Qw.GetPointer(ind-1), alpha, Qw.GetPointer(ind), Qw.GetPointer(ind-1));
       }
+    }
+    k--;
+  }
 
-      // Now remove unnecessary knots
-      if (oldr>1)
-      {
-        // Set up iter vars
-        int first = kind-2;
-        int last  = kind;
+  return SV_OK;
+}
 
-        double den = ub - ua;
-        double bet = (ub-newUKnots->GetTuple1(kind-1))/den;
+// ----------------------
+// GetDegreeElevationCoefficients
+// ----------------------
+int vtkSVNURBSUtils::GetDegreeElevationCoefficients(const int p, const int t,
+                                                    vtkSVTensor<double> &bezalfs)
+{
+  int ph  = p+t;
+  int ph2 = ph/2;
 
-        // Loop through
-        for (int tr=1; tr<oldr; tr++)
-        {
-          int i = first;
-          int j = last;
-          int kj = j-kind+1;
+  bezalfs.Resize(ph+1, p+1);
+  bezalfs.Fill(0.0);
 
-          // Compute the new control points
-          while (j-i > tr)
-          {
-            // Suspiscious
-            if (i<cind)
-            {
-              double alpha = (ub-newUKnots->GetTuple1(i))/(ua-newUKnots->GetTuple1(i));
-              for (int col=0; col<=m; col++)
-              {
-                double pw0[4], pw1[4], newPoint[4];
-                newControlPoints->GetControlPoint(i, col, 0, pw0);
-                newControlPoints->GetControlPoint(i-1, col, 0, pw1);
-                vtkSVMathUtils::Add(pw0, alpha, pw1, 1.0-alpha, 4, newPoint);
-                newControlPoints->SetControlPoint(i, col, 0, newPoint);
-              }
-            }
-            if (j>=lbz)
-            {
-              if (j-tr<=kind-ph+oldr)
-              {
-                double gam = (ub-newUKnots->GetTuple1(j-tr))/den;
-                for (int col=0; col<=m; col++)
-                {
-                  double pw0[4], pw1[4], newPoint[4];
-                  ebpts->GetControlPoint(kj, col, 0, pw0);
-                  ebpts->GetControlPoint(kj+1, col, 0, pw1);
-                  vtkSVMathUtils::Add(pw0, gam, pw1, 1.0-gam, 4, newPoint);
-                  ebpts->SetControlPoint(kj, col, 0, newPoint);
-                }
-              }
-              else
-              {
-                for (int col=0; col<=m; col++)
-                {
-                  double pw0[4], pw1[4], newPoint[4];
-                  ebpts->GetControlPoint(kj, col, 0, pw0);
-                  ebpts->GetControlPoint(kj+1, col, 0, pw1);
-                  vtkSVMathUtils::Add(pw0, bet, pw1, 1.0-bet, 4, newPoint);
-                  ebpts->SetControlPoint(kj, col, 0, newPoint);
-                }
-              }
-            }
-            i++;
-            j--;
-            kj--;
-          }
-          first--;
-          last++;
-        }
-      }
+  bezalfs(0, 0)  = 1.0;
+  bezalfs(ph, p) = 1.0;
+  for (int i=1; i<=ph2; i++)
+  {
+    double inv = 1.0/vtkSVMathUtils::Binom(ph, i);
+    int mpi = svminimum(p, i);
+    for (int j=svmaximum(0, i-t); j<=mpi; j++)
+      bezalfs(i, j) = inv*vtkSVMathUtils::Binom(p, j)*vtkSVMathUtils::Binom(t, i-j);
+  }
+
+  for (int i=ph2+1; i<=ph-1; i++)
+  {
+    int mpi = svminimum(p, i);
+    for (int j=svmaximum(0, i-t); j<=mpi; j++)
+      bezalfs(i, j) = bezalfs(ph-i, p-j);
+  }
+
+  return SV_OK;
+}
+
+// ----------------------
+// IncreaseDegreeFiber
+// ----------------------
+int vtkSVNURBSUtils::IncreaseDegreeFiber(vtkSVTensorView<const double> Pw,
+                                         const double *knots, const int p,
+                                         const int numberOfIncreases,
+                                         const vtkSVTensor<double> &bezalfs,
+                                         vtkSVTensorView<double> Qw,
+                                         double *newKnots, int &nh,
+                                         std::vector<double> &scratch)
+{
+  // Set values used by alg to more concise vars
+  int n   = Pw.GetShape(0)-1;
+  int t   = numberOfIncreases;
+  int nuk = n+p+1;
+  int ph  = p+t;
+
+  // Bezier control points of degree p, elevated bezier points of degree p+t,
+  // leftmost points of next segment and alphas for knot insertion
+  scratch.resize(4*(p+1) + 4*(ph+1) + 4*svmaximum(p-1, 1) + svmaximum(p-1, 1));
+  double *bpts     = &scratch[0];
+  double *ebpts    = bpts + 4*(p+1);
+  double *nextbpts = ebpts + 4*(ph+1);
+  double *alphas   = nextbpts + 4*svmaximum(p-1, 1);
+
+  // Set up iter vars
+  int nukh = ph;
+  int kind = ph+1;
+  int r    = -1;
+  int a    = p;
+  int b    = p+1;
+  int cind = 1;
+  double ua = knots[0];
 
-      // Load knot ua for the end of the span
-      if (a!=p)
+  // Pass the first control point
+  Copy4(Pw.GetPointer(0), Qw.GetPointer(0));
+  for (int i=0; i<=ph; i++)
+    newKnots[i] = ua;
+
+  // Initialize the first bezier segment.
+  for (int i=0; i<=p; i++)
+    Copy4(Pw.GetPointer(i), bpts+4*i);
+
+  // Loop through knot vector
+  while (b<nuk)
+  {
+    // Calculate mult
+    int i=b;
+    while (b<nuk && knots[b] == knots[b+1])
+      b++;
+
+    // Set up iter vars
+    int mul   = b-i+1;
+    nukh      = nukh+mul+t;
+    double ub = knots[b];
+    int oldr  = r;
+    r = p-mul;
+    if (r < 0 && b < nuk)
+    {
+      fprintf(stderr,"Interior knot multiplicity %d exceeds degree %d\n", mul, p);
+      return SV_ERROR;
+    }
+
+    // r multiplicities
+    int lbz = oldr > 0 ? (oldr+2)/2 : 1;
+    int rbz = r > 0 ? ph-(r+1)/2 : ph;
+
+    // Insert this knot r times
+    if (r>0)
+    {
+      double numer = ub - ua;
+      for (int k=p; k>mul; k--)
+        alphas[k-mul-1] = numer/(knots[a+k]-ua);
+
+      for (int j=1; j<=r; j++)
       {
-        for (int i=0; i<ph-oldr; i++)
-        {
-          newUKnots->SetTuple1(kind, ua);
-          kind++;
-        }
+        int save = r-j;
+        int mulj = mul+j;
+        for (int k=p; k>=mulj; k--)
+          Blend4(bpts+4*k, alphas[k-mulj], bpts+4*(k-1), bpts+4*k);
+        Copy4(bpts+4*p, nextbpts+4*save);
       }
+    }
 
-      // Load remaining control points
-      for (int j=lbz; j<=rbz; j++)
+    // Elevate degree of segment
+    for (int ii=lbz; ii<=ph; ii++)
+    {
+      double *ebpt = ebpts+4*ii;
+      ebpt[0] = ebpt[1] = ebpt[2] = ebpt[3] = 0.0;
+      int mpi = svminimum(p, ii);
+      for (int j=svmaximum(0, ii-t); j<=mpi; j++)
       {
-        for (int col=0; col<=m; col++)
-        {
-          double pw[4];
-          ebpts->GetControlPoint(j, col, 0, pw);
-          newControlPoints->SetControlPoint(cind, col, 0, pw);
-        }
-        cind++;
+        double coeff = bezalfs(ii, j);
+        for (int c=0; c<4; c++)
+          ebpt[c] += coeff*bpts[4*j+c];
       }
+    }
 
-      // Set up the next b points
-      if (b<nuk)
+    // Now remove unnecessary knots
+    if (oldr>1)
+    {
+      int first = kind-2;
+      int last  = kind;
+      double den = ub - ua;
+      double bet = (ub-newKnots[kind-1])/den;
+
+      for (int tr=1; tr<oldr; tr++)
       {
-        for (int j=0; j<r; j++)
+        int ii = first;
+        int j  = last;
+        int kj = j-kind+1;
+
+        // Compute the new control points
+        while (j-ii > tr)
         {
-          for (int col=0; col<=m; col++)
+          if (ii<cind)
           {
-            double pw[4];
-            nextbpts->GetControlPoint(j, col, 0,  pw);
-            bpts->SetControlPoint(j, col, 0,  pw);
+            double alpha = (ub-newKnots[ii])/(ua-newKnots[ii]);
+            Blend4(Qw.GetPointer(ii), alpha, Qw.GetPointer(ii-1), Qw.GetPointer(ii));
           }
-        }
-        for (int j=r; j<=p; j++)
-        {
-          for (int col=0; col<=m; col++)
+          if (j>=lbz)
           {
-            double pw[4];
-            PW->GetControlPoint(b-p+j, col, 0, pw);
-            bpts->SetControlPoint(j, col, 0,  pw);
+            if (j-tr<=kind-ph+oldr)
+            {
+              double gam = (ub-newKnots[j-tr])/den;
+              Blend4(ebpts+4*kj, gam, ebpts+4*(kj+1), ebpts+4*kj);
+            }
+            else
+              Blend4(ebpts+4*kj, bet, ebpts+4*(kj+1), ebpts+4*kj);
           }
+          ii++;
+          j--;
+          kj--;
         }
-        a=b;
-        b++;
-        ua=ub;
+        first--;
+        last++;
       }
-      else
+    }
+
+    // Load knot ua for the end of the span
+    if (a!=p)
+    {
+      for (int ii=0; ii<ph-oldr; ii++)
       {
-        // This is the end
-        for (int i=0; i<=ph; i++)
-          newUKnots->SetTuple1(kind+i, ub);
+        newKnots[kind] = ua;
+        kind++;
       }
     }
-    int nh = nukh-ph-1;
 
-    if (nukh != nukhat)
+    // Load remaining control points
+    for (int j=lbz; j<=rbz; j++)
     {
-      fprintf(stderr,"Something went wrong: nukhat %d does not equal iter m %d\n", nukhat, nukh);
-      return SV_ERROR;
+      if (cind >= Qw.GetShape(0))
+      {
+        fprintf(stderr,"Something went wrong: more control points than allocated during degree elevation\n");
+        return SV_ERROR;
+      }
+      Copy4(ebpts+4*j, Qw.GetPointer(cind));
+      cind++;
     }
-    if (nh != nhat)
+
+    // Set up the next b points
+    if (b<nuk)
     {
-      fprintf(stderr,"Something went wrong: nukhat %d does not equal iter m %d\n", nhat, nh);
-      return SV_ERROR;
+      for (int j=0; j<r; j++)
+        Copy4(nextbpts+4*j, bpts+4*j);
+      for (int j=r; j<=p; j++)
+        Copy4(Pw.GetPointer(b-p+j), bpts+4*j);
+      a=b;
+      b++;
+      ua=ub;
     }
+    else
+    {
+      // This is the end
+      for (int ii=0; ii<=ph; ii++)
+        newKnots[kind+ii] = ub;
+    }
+  }
+  nh = nukh-ph-1;
+
+  return SV_OK;
+}
 
+// ----------------------
+// LUFactor
+// ----------------------
+int vtkSVNURBSUtils::LUFactor(vtkSVTensor<double> &A, std::vector<int> &pivots)
+{
+  int n = A.GetShape(0);
+  if (A.GetRank() != 2 || A.GetShape(1) != n)
+  {
+    fprintf(stderr,"Matrix must be square to factor\n");
+    return SV_ERROR;
   }
-  else if (dir == 1)
+
+  // Doolittle with partial pivoting, rows swapped in place
+  pivots.resize(n);
+  for (int k=0; k<n; k++)
   {
-    if (vKnots->GetNumberOfTuples() != nvk+1)
+    int maxRow = k;
+    double maxVal = fabs(A(k, k));
+    for (int i=k+1; i<n; i++)
     {
-      fprintf(stderr,"Invalid number of control points given with knot span\n");
+      if (fabs(A(i, k)) > maxVal)
+      {
+        maxVal = fabs(A(i, k));
+        maxRow = i;
+      }
+    }
+    if (maxVal < 1.0e-16)
+    {
+      fprintf(stderr,"Matrix is singular\n");
       return SV_ERROR;
     }
+    pivots[k] = maxRow;
+    if (maxRow != k)
+    {
+      for (int j=0; j<n; j++)
+        std::swap(A(k, j), A(maxRow, j));
+    }
 
-    // Compute s by cmputing the number of non-repeated internal knot vals
-    vtkNew(vtkIntArray, multiplicity);
-    vtkNew(vtkDoubleArray, singleValues);
-    vtkSVNURBSUtils::GetMultiplicity(vKnots, multiplicity, singleValues);
+    double *rowK = &A(k, 0);
+    for (int i=k+1; i<n; i++)
+    {
+      double *rowI = &A(i, 0);
+      double factor = rowI[k]/rowK[k];
+      rowI[k] = factor;
+      for (int j=k+1; j<n; j++)
+        rowI[j] -= factor*rowK[j];
+    }
+  }
 
-    // S s is length of mult vector minus 2 (p+1 ends)
-    int s = multiplicity->GetNumberOfTuples() - 2;
-    int nvkhat = nvk+t*(s+2);
-    int nhat = m+t*(s+1);
+  return SV_OK;
+}
 
-    // New degree
-    int qh  = q+t;
-    int qh2 = qh/2;
+// ----------------------
+// LUSolve
+// ----------------------
+int vtkSVNURBSUtils::LUSolve(const vtkSVTensor<double> &LU,
+                             const std::vector<int> &pivots,
+                             vtkSVTensorView<double> B)
+{
+  int n = LU.GetShape(0);
+  if (B.GetShape(0) != n || static_cast<int>(pivots.size()) != n)
+  {
+    fprintf(stderr,"Right hand side does not match factored matrix\n");
+    return SV_ERROR;
+  }
 
-    // Set up new knots, just bezier knot span
-    newVKnots->SetNumberOfTuples(nvkhat+1);
-    if (newUKnots != NULL && uKnots != NULL)
-      newUKnots->DeepCopy(uKnots);
+  // Right hand side may be a vector or a set of column vectors
+  int nrhs = B.GetRank() > 1 ? B.GetShape(1) : 1;
+  for (int c=0; c<nrhs; c++)
+  {
+    vtkSVTensorView<double> b = B.GetRank() > 1 ? B.Slice(1, c) : B;
 
-    // New control points, updated each time for new bezier curve
-    newControlPoints->SetNumberOfControlPoints((nhat+1)*(n+1));
-    newControlPoints->SetDimensions(n+q, nhat+1, 1);
+    // Permute
+    for (int k=0; k<n; k++)
+    {
+      if (pivots[k] != k)
+        std::swap(b(k), b(pivots[k]));
+    }
 
-    // Set up tmp arrays
-    // Coeffecients for degree elevation
-    vtkNew(vtkDoubleArray, bezalphas);
-    bezalphas->SetNumberOfComponents(q+1);
-    bezalphas->SetNumberOfTuples(q+t+1);
+    // Forward, unit lower
+    for (int i=1; i<n; i++)
+    {
+      const double *row = &LU(i, 0);
+      double sum = b(i);
+      for (int j=0; j<i; j++)
+        sum -= row[j]*b(j);
+      b(i) = sum;
+    }
 
-    // Bezier control strips, degree p
-    vtkNew(vtkSVControlGrid, bpts);
-    bpts->SetNumberOfControlPoints((q+1)*(n+1));
-    bpts->SetDimensions(n+1, q+1, 1);
+    // Backward, upper
+    for (int i=n-1; i>=0; i--)
+    {
+      const double *row = &LU(i, 0);
+      double sum = b(i);
+      for (int j=i+1; j<n; j++)
+        sum -= row[j]*b(j);
+      b(i) = sum/row[i];
+    }
+  }
 
-    // Bezier control points, degree p+t
-    vtkNew(vtkSVControlGrid, ebpts);
-    ebpts->SetNumberOfControlPoints((q+t+1)*(n+1));
-    ebpts->SetDimensions(n+1, q+t+1, 1);
+  return SV_OK;
+}
 
-    // Leftmost control pionts of next Bezier segment
-    vtkNew(vtkSVControlGrid, nextbpts);
-    nextbpts->SetNumberOfControlPoints((q-1)*(n+1));
-    nextbpts->SetDimensions(n+1, q-1, 1);
+// ----------------------
+// SolveAlongAxis
+// ----------------------
+int vtkSVNURBSUtils::SolveAlongAxis(const vtkSVTensor<double> &A,
+                                    const int axis,
+                                    vtkSVTensor<double> &grid)
+{
+  if (grid.GetRank() != 4 || axis < 0 || axis > 2 ||
+      A.GetShape(0) != grid.GetShape(axis))
+  {
+    fprintf(stderr,"Grid does not match system along axis %d\n", axis);
+    return SV_ERROR;
+  }
 
-    // Alpha values for knot insertion
-    vtkNew(vtkDoubleArray, alphas);
-    alphas->SetNumberOfTuples(q-1);
+  // Factor once and solve for every fiber along axis
+  vtkSVTensor<double> LU = A;
+  std::vector<int> pivots;
+  if (vtkSVNURBSUtils::LUFactor(LU, pivots) != SV_OK)
+    return SV_ERROR;
 
-    //Compute coefficients
-    bezalphas->SetComponent(0, 0, 1.0);
-    bezalphas->SetComponent(qh, q, 1.0);
-    for (int i=1; i<=qh2; i++)
+  vtkSVTensorView<double> swapped = grid.GetView().SwapAxes(0, axis);
+  for (int j=0; j<swapped.GetShape(1); j++)
+  {
+    for (int k=0; k<swapped.GetShape(2); k++)
     {
-      double inv = 1.0/vtkSVMathUtils::Binom(qh, i);
-      int mpi = svminimum(q, i);
-      for (int j=svmaximum(0, i-t); j<=mpi; j++)
-      {
-        double newVal = inv*vtkSVMathUtils::Binom(q, j)*vtkSVMathUtils::Binom(t, i-j);
-        bezalphas->SetComponent(i, j, newVal);
-      }
+      if (vtkSVNURBSUtils::LUSolve(LU, pivots, swapped.Slice(2, k).Slice(1, j)) != SV_OK)
+        return SV_ERROR;
     }
+  }
+
+  return SV_OK;
+}
+
+// ----------------------
+// BasisFunctions
+// ----------------------
+int vtkSVNURBSUtils::BasisFunctions(const double *knots, const int p,
+                                    const int span, const double u, double *N)
+{
+  // Small fixed size so this can be called per sample without allocating
+  if (p > MaxBasisDegree)
+  {
+    fprintf(stderr,"Degree %d too large for basis evaluation\n", p);
+    return SV_ERROR;
+  }
+  double uLeft[MaxBasisDegree+1], uRight[MaxBasisDegree+1];
 
-    for (int i=qh2+1; i<=qh-1; i++)
+  N[0] = 1.0;
+  for (int i=1; i<=p; i++)
+  {
+    uLeft[i]  = u - knots[span+1-i];
+    uRight[i] = knots[span+i] - u;
+    double saved = 0.0;
+    for (int j=0; j<i; j++)
     {
-      int mpi = svminimum(q, i);
-      for (int j=svmaximum(0, i-t); j<=mpi; j++)
-        bezalphas->SetComponent(i, j, bezalphas->GetComponent(qh-i, q-j));
+      double temp = N[j]/(uRight[j+1] + uLeft[i-j]);
+      N[j] = saved + uRight[j+1]*temp;
+      saved = uLeft[i-j]*temp;
     }
+    N[i] = saved;
+  }
 
-    // Set up iter vars
-    int nvkh   =  qh;
-    int kind =  qh+1;
-    int r    = -1;
-    int a    =  q;
-    int b    =  q+1;
-    int cind =  1;
-    double va = vKnots->GetTuple1(0);
+  return SV_OK;
+}
 
-    // Pass the first control point
-    for (int row=0; row<=n; row++)
+// ----------------------
+// CurvePoint
+// ----------------------
+int vtkSVNURBSUtils::CurvePoint(vtkSVTensorView<const double> Pw,
+                                const double *knots, const int p,
+                                const double u, double pt[3])
+{
+  int n = Pw.GetShape(0)-1;
+  int span = FindSpanInKnots(p, n, u, knots);
+
+  double N[MaxBasisDegree+1];
+  if (vtkSVNURBSUtils::BasisFunctions(knots, p, span, u, N) != SV_OK)
+    return SV_ERROR;
+
+  double cw[4] = {0.0, 0.0, 0.0, 0.0};
+  for (int i=0; i<=p; i++)
+  {
+    const double *pw = Pw.GetPointer(span-p+i);
+    for (int c=0; c<4; c++)
+      cw[c] += N[i]*pw[c];
+  }
+  for (int c=0; c<3; c++)
+    pt[c] = cw[c]/cw[3];
+
+  return SV_OK;
+}
+
+// ----------------------
+// SurfacePoint
+// ----------------------
+int vtkSVNURBSUtils::SurfacePoint(vtkSVTensorView<const double> Pw,
+                                  const double *uKnots, const int p,
+                                  const double *vKnots, const int q,
+                                  const double u, const double v, double pt[3])
+{
+  int n = Pw.GetShape(0)-1;
+  int m = Pw.GetShape(1)-1;
+  int uSpan = FindSpanInKnots(p, n, u, uKnots);
+  int vSpan = FindSpanInKnots(q, m, v, vKnots);
+
+  double Nu[MaxBasisDegree+1], Nv[MaxBasisDegree+1];
+  if (vtkSVNURBSUtils::BasisFunctions(uKnots, p, uSpan, u, Nu) != SV_OK ||
+      vtkSVNURBSUtils::BasisFunctions(vKnots, q, vSpan, v, Nv) != SV_OK)
+    return SV_ERROR;
+
+  double sw[4] = {0.0, 0.0, 0.0, 0.0};
+  for (int l=0; l<=q; l++)
+  {
+    double tmp[4] = {0.0, 0.0, 0.0, 0.0};
+    for (int k=0; k<=p; k++)
     {
-      double firstpw[4];
-      PW->GetControlPoint(row, 0, 0, firstpw);
-      newControlPoints->SetControlPoint(row, 0, 0, firstpw);
+      const double *pw = Pw.GetPointer(uSpan-p+k, vSpan-q+l);
+      for (int c=0; c<4; c++)
+        tmp[c] += Nu[k]*pw[c];
     }
+    for (int c=0; c<4; c++)
+      sw[c] += Nv[l]*tmp[c];
+  }
+  for (int c=0; c<3; c++)
+    pt[c] = sw[c]/sw[3];
 
-    for (int i=0; i<=qh; i++)
-      newVKnots->SetTuple1(i, va);
+  return SV_OK;
+}
+
+// ----------------------
+// ApplyRefinementPlan
+// ----------------------
+int vtkSVNURBSUtils::ApplyRefinementPlan(const int numberOfDirections,
+                                         int degrees[3],
+                                         const vtkSVNURBSRefinementPlan &plan,
+                                         vtkSVNURBSRefinementWorkspace &work)
+{
+  if (work.Points.GetRank() != 4 || work.Points.GetShape(3) != 4)
+  {
+    fprintf(stderr,"Homogeneous control points must have shape (n, m, l, 4)\n");
+    return SV_ERROR;
+  }
+
+  // Two passes, degree elevation and knot insertion in the order requested
+  for (int pass=0; pass<2; pass++)
+  {
+    int elevate = (pass == 0) == (plan.ElevateFirst != 0);
+    for (int dir=0; dir<numberOfDirections; dir++)
+    {
+      if (elevate)
+      {
+        int t = plan.TargetDegrees[dir] - degrees[dir];
+        if (t <= 0)
+          continue;
+        if (ElevateAlongAxis(dir, degrees[dir], t, work) != SV_OK)
+          return SV_ERROR;
+        degrees[dir] += t;
+      }
+      else
+      {
+        if (plan.InsertKnots[dir].empty())
+          continue;
+        if (RefineAlongAxis(dir, degrees[dir], plan.InsertKnots[dir], work) != SV_OK)
+          return SV_ERROR;
+      }
+    }
+  }
+
+  return SV_OK;
+}
+
+// ----------------------
+// RefineCollection
+// ----------------------
+int vtkSVNURBSUtils::RefineCollection(vtkSVNURBSCollection *patches,
+                                      const vtkSVNURBSRefinementPlan &plan)
+{
+  // One work space for all patches, buffers grow to the largest patch
+  vtkSVNURBSRefinementWorkspace work;
 
-    // Initialize the first bezier segment.
-    for (int i=0; i<=q; i++)
+  for (int i=0; i<patches->GetNumberOfItems(); i++)
+  {
+    vtkSVNURBSObject *patch = patches->GetItem(i);
+    if (vtkSVNURBSSurface *surface = vtkSVNURBSSurface::SafeDownCast(patch))
     {
-      for (int row=0; row<=n; row++)
+      if (surface->Refine(plan, work) != SV_OK)
       {
-        double pw[4];
-        PW->GetControlPoint(row, i, 0, pw);
-        bpts->SetControlPoint(row, i, 0, pw);
+        fprintf(stderr,"Could not refine patch %d\n", i);
+        return SV_ERROR;
       }
     }
-
-    // Loop through knot vector
-    while (b<nvk)
+    else if (vtkSVNURBSCurve *curve = vtkSVNURBSCurve::SafeDownCast(patch))
     {
-      // Calculate mult
-      int i=b;
-      while (b<nvk && vKnots->GetTuple1(b) == vKnots->GetTuple1(b+1))
-        b++;
-
-      // Set up iter vars
-      int mul   = b-i+1;
-      nvkh        = nvkh+mul+t;
-      double vb = vKnots->GetTuple1(b);
-      int oldr  = r;
-      r = q-mul;
-
-      // r multiplicities
-      int lbz;
-      if (oldr > 0)
-        lbz = (oldr+2)/2;
-      else
-        lbz = 1;
-      int rbz;
-      if (r >0)
-        rbz = qh-(r+1)/2;
-      else
-        rbz = qh;
-
-      // Insert this knot r times
-      // Extract bezier segment
-      if (r>0)
+      if (curve->Refine(plan, work) != SV_OK)
       {
-        double numer = vb - va;
-        for (int k=q; k>mul; k--)
-          alphas->SetTuple1(k-mul-1, numer/(vKnots->GetTuple1(a+k)-va));
-
-        for (int j=1; j<=r; j++)
-        {
-          int save = r-j;
-          int mulj = mul+j;
-          for (int k=q; k>=mulj; k--)
-          {
-            double alpha = alphas->GetTuple1(k-mulj);
-            for (int row=0; row<=n; row++)
-            {
-              double pw0[4], pw1[4], newPoint[4];
-              bpts->GetControlPoint(row, k, 0,  pw0);
-              bpts->GetControlPoint(row, k-1, 0, pw1);
-              vtkSVMathUtils::Add(pw0, alpha, pw1, 1.0-alpha, 4, newPoint);
-              bpts->SetControlPoint(row, k, 0, newPoint);
-            }
-          }
-          for (int row=0; row<=n; row++)
-          {
-            double pw[4];
-            bpts->GetControlPoint(row, q, 0,  pw);
-            nextbpts->SetControlPoint(row, save, 0,  pw);
-          }
-        }
+        fprintf(stderr,"Could not refine patch %d\n", i);
+        return SV_ERROR;
       }
-
-      // Elevate degree of segment
-      for (int i=lbz; i<=qh; i++)
+    }
+    else if (vtkSVNURBSVolume *volume = vtkSVNURBSVolume::SafeDownCast(patch))
+    {
+      if (volume->Refine(plan, work) != SV_OK)
       {
-        for (int row=0; row<=n; row++)
-        {
-          double zero[4] = {0.0, 0.0, 0.0, 0.0};
-          ebpts->SetControlPoint(row, i, 0,  zero);
-        }
-        int mpi = svminimum(q, i);
-        for (int j=svmaximum(0, i-t); j<=mpi; j++)
-        {
-          for (int row=0; row<=n; row++)
-          {
-            double pw0[4], pw1[4], newPoint[4];
-            int dimers[3];
-            ebpts->GetDimensions(dimers);
-            ebpts->GetControlPoint(row, i, 0,  pw0);
-            bpts->GetControlPoint(row, j, 0, pw1);
-            vtkSVMathUtils::Add(pw0, 1.0, pw1, bezalphas->GetComponent(i, j), 4, newPoint);
-            ebpts->SetControlPoint(row, i, 0, newPoint);
-          }
-        }
+        fprintf(stderr,"Could not refine patch %d\n", i);
+        return SV_ERROR;
       }
+    }
+    else
+    {
+      fprintf(stderr,"Refinement of %s patches is not supported\n", patch->GetType().c_str());
+      return SV_ERROR;
+    }
+  }
 
-      // Now remove unnecessary knots
-      if (oldr>1)
-      {
-        // Set up iter vars
-        int first = kind-2;
-        int last  = kind;
+  return SV_OK;
+}
+
+// ----------------------
+// GetElementExtractionOperator
+// ----------------------
+int vtkSVNURBSUtils::GetElementExtractionOperator(const double *localKnots,
+                                                  const int p, double *C)
+{
+  if (p < 0 || p > MaxBasisDegree)
+  {
+    fprintf(stderr,"Degree %d is not supported for Bezier extraction\n", p);
+    return SV_ERROR;
+  }
+  const double ua = localKnots[p];
+  const double ub = localKnots[p+1];
+  if (ub <= ua)
+  {
+    fprintf(stderr,"Element has zero length in parameter space\n");
+    return SV_ERROR;
+  }
 
-        double den = vb - va;
-        double bet = (vb-newVKnots->GetTuple1(kind-1))/den;
+  // Knots to insert at both ends to get multiplicity p
+  int multA = 0;
+  for (int i=p; i>=0 && localKnots[i] == ua; i--)
+    multA++;
+  int multB = 0;
+  for (int i=p+1; i<2*p+2 && localKnots[i] == ub; i++)
+    multB++;
+  const int numLeft  = svmaximum(p-multA, 0);
+  const int numRight = svmaximum(p-multB, 0);
+  const int numInserts = numLeft + numRight;
+
+  // Control points are the unit vectors so that after insertion they hold
+  // the coefficients of each original basis function
+  const int np = p+1;
+  std::vector<double> K(localKnots, localKnots+2*p+2);
+  K.reserve(2*p+2+numInserts);
+  std::vector<double> Q((np+numInserts)*np, 0.0);
+  for (int i=0; i<np; i++)
+    Q[i*np+i] = 1.0;
 
-        // Loop through
-        for (int tr=1; tr<oldr; tr++)
-        {
-          int i = first;
-          int j = last;
-          int kj = j-kind+1;
+  // Boehm insertion into the span of the element, the span index moves
+  // with the knots inserted on the left
+  int numPoints = np;
+  int span = p;
+  for (int ins=0; ins<numInserts; ins++)
+  {
+    const double u = ins < numLeft ? ua : ub;
+    for (int j=numPoints; j>span; j--)
+      std::copy(&Q[(j-1)*np], &Q[j*np], &Q[j*np]);
+    for (int j=span; j>=span-p+1; j--)
+    {
+      const double alpha = (u - K[j])/(K[j+p] - K[j]);
+      for (int i=0; i<np; i++)
+        Q[j*np+i] = alpha*Q[j*np+i] + (1.0-alpha)*Q[(j-1)*np+i];
+    }
+    K.insert(K.begin()+span+1, u);
+    numPoints++;
+    if (ins < numLeft)
+      span++;
+  }
 
-          // Compute the new control points
-          while (j-i > tr)
-          {
-            // Suspiscious
-            if (i<cind)
-            {
-              double alpha = (vb-newVKnots->GetTuple1(i))/(va-newVKnots->GetTuple1(i));
-              for (int row=0; row<=n; row++)
-              {
-                double pw0[4], pw1[4], newPoint[4];
-                newControlPoints->GetControlPoint(row, i, 0, pw0);
-                newControlPoints->GetControlPoint(row, i-1, 0, pw1);
-                vtkSVMathUtils::Add(pw0, alpha, pw1, 1.0-alpha, 4, newPoint);
-                newControlPoints->SetControlPoint(row, i, 0, newPoint);
-              }
-            }
-            if (j>=lbz)
-            {
-              if (j-tr<=kind-qh+oldr)
-              {
-                double gam = (vb-newVKnots->GetTuple1(j-tr))/den;
-                for (int row=0; row<=n; row++)
-                {
-                  double pw0[4], pw1[4], newPoint[4];
-                  ebpts->GetControlPoint(row, kj, 0, pw0);
-                  ebpts->GetControlPoint(row, kj+1, 0, pw1);
-                  vtkSVMathUtils::Add(pw0, gam, pw1, 1.0-gam, 4, newPoint);
-                  ebpts->SetControlPoint(row, kj, 0, newPoint);
-                }
-              }
-              else
-              {
-                for (int row=0; row<=n; row++)
-                {
-                  double pw0[4], pw1[4], newPoint[4];
-                  ebpts->GetControlPoint(row, kj, 0, pw0);
-                  ebpts->GetControlPoint(row, kj+1, 0, pw1);
-                  vtkSVMathUtils::Add(pw0, bet, pw1, 1.0-bet, 4, newPoint);
-                  ebpts->SetControlPoint(row, kj, 0, newPoint);
-                }
-              }
-            }
-            i++;
-            j--;
-            kj--;
-          }
-          first--;
-          last++;
-        }
-      }
+  // Bezier points of the element are span-p to span
+  for (int i=0; i<np; i++)
+  {
+    for (int k=0; k<np; k++)
+      C[i*np+k] = Q[(span-p+k)*np+i];
+  }
 
-      // Load knot va for the end of the span
-      if (a!=q)
-      {
-        for (int i=0; i<qh-oldr; i++)
-        {
-          newVKnots->SetTuple1(kind, va);
-          kind++;
-        }
-      }
+  return SV_OK;
+}
+
+// ----------------------
+// ComputeExtractionOperators
+// ----------------------
+int vtkSVNURBSUtils::ComputeExtractionOperators(vtkSVNURBSCollection *patches,
+                                                vtkSVNURBSExtractionOperators &operators)
+{
+  operators.Initialize();
+
+  // Gather the knot spans of every direction of every patch
+  const int numPatches = patches->GetNumberOfItems();
+  std::vector<ExtractionElement> elements;
+  std::vector<vtkIdType> directionOffsets(3*numPatches+1, 0);
+  for (int i=0; i<numPatches; i++)
+  {
+    vtkSVNURBSObject *patch = patches->GetItem(i);
+    int dim;
+    int degrees[3] = {0, 0, 0};
+    vtkDoubleArray *knots[3] = {NULL, NULL, NULL};
+    if (GetPatchKnots(patch, dim, degrees, knots) != SV_OK)
+    {
+      fprintf(stderr,"Bezier extraction of %s patches is not supported\n", patch->GetType().c_str());
+      return SV_ERROR;
+    }
 
-      // Load remaining control points
-      for (int j=lbz; j<=rbz; j++)
+    operators.PatchDimensions.push_back(dim);
+    vtkIdType numElements = 1;
+    for (int dir=0; dir<3; dir++)
+    {
+      directionOffsets[3*i+dir] = elements.size();
+      operators.PatchDegrees.push_back(degrees[dir]);
+      if (dir >= dim)
       {
-        for (int row=0; row<=n; row++)
-        {
-          double pw[4];
-          ebpts->GetControlPoint(row, j, 0, pw);
-          newControlPoints->SetControlPoint(row, cind, 0, pw);
-        }
-        cind++;
+        operators.PatchNumberOfElements.push_back(1);
+        continue;
       }
 
-      // Set up the next b points
-      if (b<nvk)
+      const int p = degrees[dir];
+      const int numKnots = knots[dir]->GetNumberOfTuples();
+      const double *U = knots[dir]->GetPointer(0);
+      int count = 0;
+      for (int span=p; span<numKnots-p-1; span++)
       {
-        for (int j=0; j<r; j++)
-        {
-          for (int row=0; row<=n; row++)
-          {
-            double pw[4];
-            nextbpts->GetControlPoint(row, j, 0,  pw);
-            bpts->SetControlPoint(row, j, 0,  pw);
-          }
-        }
-        for (int j=r; j<=q; j++)
+        if (U[span+1] > U[span])
         {
-          for (int row=0; row<=n; row++)
-          {
-            double pw[4];
-            PW->GetControlPoint(row, b-q+j, 0, pw);
-            bpts->SetControlPoint(j, 0, 0, pw);
-          }
+          ExtractionElement element = {U, p, span};
+          elements.push_back(element);
+          count++;
         }
-        a=b;
-        b++;
-        va=vb;
       }
-      else
+      if (count == 0)
       {
-        // This is the end
-        for (int i=0; i<=qh; i++)
-          newVKnots->SetTuple1(kind+i, vb);
+        fprintf(stderr,"Patch %d has no non-zero knot spans in direction %d\n", i, dir);
+        return SV_ERROR;
       }
+      operators.PatchNumberOfElements.push_back(count);
+      numElements *= count;
     }
-    int nh = nvkh-qh-1;
+    operators.PatchElementOffsets.push_back(operators.PatchElementOffsets.back()+numElements);
+  }
+  directionOffsets[3*numPatches] = elements.size();
 
-    if (nvkh != nvkhat)
-    {
-      fprintf(stderr,"Something went wrong: nvkhat %d does not equal iter m %d\n", nvkhat, nvkh);
-      return SV_ERROR;
-    }
-    if (nh != nhat)
+  // Normalized local knots of every span, in parallel
+  std::vector<std::vector<long long> > keys(elements.size());
+  ExtractionKeys keyer;
+  keyer.Elements = &elements;
+  keyer.Keys     = &keys;
+  vtkSMPTools::For(0, elements.size(), keyer);
+
+  // Give each distinct local knot configuration an id, in element order
+  // so the numbering does not depend on threading
+  std::map<std::vector<long long>, int> keyIds;
+  std::vector<int> elementIds(elements.size());
+  std::vector<vtkIdType> representatives;
+  for (size_t e=0; e<elements.size(); e++)
+  {
+    std::map<std::vector<long long>, int>::iterator it = keyIds.find(keys[e]);
+    if (it == keyIds.end())
     {
-      fprintf(stderr,"Something went wrong: nvkhat %d does not equal iter m %d\n", nhat, nh);
-      return SV_ERROR;
+      const int id = representatives.size();
+      const int np = elements[e].Degree+1;
+      keyIds.insert(std::make_pair(keys[e], id));
+      operators.OperatorDegrees.push_back(elements[e].Degree);
+      operators.OperatorOffsets.push_back(operators.Coefficients.size());
+      operators.Coefficients.resize(operators.Coefficients.size()+np*np);
+      representatives.push_back(e);
+      elementIds[e] = id;
     }
+    else
+      elementIds[e] = it->second;
+  }
 
+  // Compute only the unique operators, in parallel
+  ExtractionOperators extractor;
+  extractor.Elements        = &elements;
+  extractor.Representatives = &representatives;
+  extractor.Operators       = &operators;
+  vtkSMPTools::For(0, representatives.size(), extractor);
+  if (CountErrors(extractor.Errors) != 0)
+  {
+    fprintf(stderr,"Error on Bezier extraction\n");
+    return SV_ERROR;
   }
 
-  // Realy quick, convert everything back to just p
-  vtkSVNURBSUtils::GetPFromPW(newControlPoints);
+  // Operator ids and spans of the tensor product elements
+  operators.ElementOperators.resize(3*operators.PatchElementOffsets.back());
+  operators.ElementSpans.resize(3*operators.PatchElementOffsets.back());
+  for (int i=0; i<numPatches; i++)
+  {
+    const int *n = &operators.PatchNumberOfElements[3*i];
+    for (vtkIdType element=0; element<operators.GetNumberOfElements(i); element++)
+    {
+      const int ei[3] = {static_cast<int>(element%n[0]),
+                         static_cast<int>((element/n[0])%n[1]),
+                         static_cast<int>(element/(n[0]*n[1]))};
+      const vtkIdType loc = 3*(operators.PatchElementOffsets[i]+element);
+      for (int dir=0; dir<3; dir++)
+      {
+        if (dir >= operators.PatchDimensions[i])
+        {
+          operators.ElementOperators[loc+dir] = -1;
+          operators.ElementSpans[loc+dir]     = -1;
+          continue;
+        }
+        const vtkIdType e = directionOffsets[3*i+dir] + ei[dir];
+        operators.ElementOperators[loc+dir] = elementIds[e];
+        operators.ElementSpans[loc+dir]     = elements[e].Span;
+      }
+    }
+  }
 
   return SV_OK;
 }
@@ -5251,6 +5490,8 @@ int vtkSVNURBSUtils::GetPWFromP(vtkSVControlGrid *controlPoints)
     vtkMath::MultiplyScalar(pt, weight);
     controlPoints->GetPoints()->SetPoint(i, pt);
   }
+  controlPoints->SetPointsWeighted(1);
+  controlPoints->Modified();
 
   return SV_OK;
 }
@@ -5275,6 +5516,8 @@ int vtkSVNURBSUtils::GetPWFromP(vtkSVControlGrid *controlPoints, vtkSVControlGri
     controlPointWeights->GetPoints()->SetPoint(i, pt);
     newWeights->SetTuple1(i, weight);
   }
+  controlPointWeights->SetPointsWeighted(1);
+  controlPointWeights->Modified();
 
   return SV_OK;
 }
@@ -5294,6 +5537,8 @@ int vtkSVNURBSUtils::GetPFromPW(vtkSVControlGrid *controlPoints)
     vtkMath::MultiplyScalar(pt, 1./weight);
     controlPoints->GetPoints()->SetPoint(i, pt);
   }
+  controlPoints->SetPointsWeighted(0);
+  controlPoints->Modified();
 
   return SV_OK;
 }
@@ -5317,6 +5562,8 @@ int vtkSVNURBSUtils::GetPFromPW(vtkSVControlGrid *controlPointWeights, vtkSVCont
     controlPoints->GetPoints()->SetPoint(i, pt);
     newWeights->SetTuple1(i, weight);
   }
+  controlPoints->SetPointsWeighted(0);
+  controlPoints->Modified();
 
   return SV_OK;
 }
@@ -5925,6 +6172,171 @@ int vtkSVNURBSUtils::SetMatrixComp(vtkTypedArray<double> *vec,  const int loc, c
 //  return SV_OK;
 //}
 
+// ----------------------
+// TypedArrayToTensor
+// ----------------------
+int vtkSVNURBSUtils::TypedArrayToTensor(vtkTypedArray<double> *array,
+                                        vtkSVTensor<double> &output)
+{
+  int dims = array->GetDimensions();
+  if (dims < 1 || dims > vtkSVTensor<double>::MAX_RANK)
+  {
+    fprintf(stderr,"This dimension not supported\n");
+    return SV_ERROR;
+  }
+
+  vtkIdType shape[vtkSVTensor<double>::MAX_RANK];
+  for (int i=0; i<dims; i++)
+    shape[i] = array->GetExtents()[i].GetSize();
+  output.Resize(dims, shape);
+  output.Fill(0.0);
+
+  // Only touch stored values so sparse arrays stay cheap
+  vtkSVTensorView<double> view = output.GetView();
+  vtkArrayCoordinates loc;
+  for (vtkIdType n=0; n<array->GetNonNullSize(); n++)
+  {
+    array->GetCoordinatesN(n, loc);
+    vtkIdType ijkl[4] = {0, 0, 0, 0};
+    for (int i=0; i<dims; i++)
+      ijkl[i] = loc[i];
+    view(ijkl[0], ijkl[1], ijkl[2], ijkl[3]) = array->GetValueN(n);
+  }
+
+  return SV_OK;
+}
+
+// ----------------------
+// TensorToTypedArray
+// ----------------------
+int vtkSVNURBSUtils::TensorToTypedArray(const vtkSVTensor<double> &tensor,
+                                        vtkTypedArray<double> *output)
+{
+  int dims = tensor.GetRank();
+  if (dims < 1)
+  {
+    fprintf(stderr,"This dimension not supported\n");
+    return SV_ERROR;
+  }
+
+  vtkArrayExtents size;
+  size.SetDimensions(dims);
+  for (int i=0; i<dims; i++)
+    size.SetExtent(i, vtkArrayRange(0, tensor.GetShape(i)));
+  output->Resize(size);
+
+  vtkSVTensorView<const double> view = tensor.GetView();
+  vtkArrayCoordinates loc;
+  loc.SetDimensions(dims);
+  for (vtkIdType i=0; i<tensor.GetShape(0); i++)
+  {
+    for (vtkIdType j=0; j<tensor.GetShape(1); j++)
+    {
+      for (vtkIdType k=0; k<tensor.GetShape(2); k++)
+      {
+        for (vtkIdType l=0; l<tensor.GetShape(3); l++)
+        {
+          vtkIdType ijkl[4] = {i, j, k, l};
+          for (int d=0; d<dims; d++)
+            loc.SetCoordinate(d, ijkl[d]);
+          output->SetValue(loc, view(i, j, k, l));
+        }
+      }
+    }
+  }
+
+  return SV_OK;
+}
+
+// ----------------------
+// TensorToPoints
+// ----------------------
+int vtkSVNURBSUtils::TensorToPoints(const vtkSVTensor<double> &tensor,
+                                    vtkPoints *output)
+{
+  int dims = tensor.GetRank();
+  if (tensor.GetShape(dims-1) != 3)
+  {
+    fprintf(stderr,"Last dimension should have xyz coordinates\n");
+    return SV_ERROR;
+  }
+
+  // Values are contiguous triplets, just copy them over in order
+  vtkIdType numVals = tensor.GetSize()/3;
+  const double *values = tensor.GetData();
+  output->SetNumberOfPoints(numVals);
+  for (vtkIdType i=0; i<numVals; i++)
+    output->SetPoint(i, values+3*i);
+
+  return SV_OK;
+}
+
+// ----------------------
+// TensorToStructuredGrid
+// ----------------------
+int vtkSVNURBSUtils::TensorToStructuredGrid(const vtkSVTensor<double> &tensor,
+                                            vtkStructuredGrid *output)
+{
+  int dims = tensor.GetRank();
+  if (dims < 2 || tensor.GetShape(dims-1) != 3)
+  {
+    fprintf(stderr,"Last dimension should have xyz coordinates\n");
+    return SV_ERROR;
+  }
+
+  int dim[3] = {1, 1, 1};
+  for (int i=0; i<dims-1; i++)
+    dim[i] = tensor.GetShape(i);
+
+  output->SetDimensions(dim);
+  output->GetPoints()->SetNumberOfPoints(dim[0]*dim[1]*dim[2]);
+
+  const double *values = tensor.GetData();
+  for (int i=0; i<dim[0]; i++)
+  {
+    for (int j=0; j<dim[1]; j++)
+    {
+      for (int k=0; k<dim[2]; k++)
+      {
+        int pos[3];
+        pos[0] = i;
+        pos[1] = j;
+        pos[2] = k;
+        int ptId = vtkStructuredData::ComputePointId(dim, pos);
+        output->GetPoints()->SetPoint(ptId, values+3*((i*dim[1] + j)*dim[2] + k));
+      }
+    }
+  }
+
+  return SV_OK;
+}
+
+// ----------------------
+// ControlGridToTensorPW
+// ----------------------
+int vtkSVNURBSUtils::ControlGridToTensorPW(vtkSVControlGrid *grid,
+                                           vtkSVTensor<double> &PW)
+{
+  vtkSVTensorView<double> gridPW = grid->GetHomogeneousPoints();
+  if (gridPW.GetData() == NULL)
+    return SV_ERROR;
+
+  PW.Resize(gridPW.GetShape(0), gridPW.GetShape(1), gridPW.GetShape(2), 4);
+  PW.GetView().CopyFrom(gridPW);
+
+  return SV_OK;
+}
+
+// ----------------------
+// TensorPWToControlGrid
+// ----------------------
+int vtkSVNURBSUtils::TensorPWToControlGrid(const vtkSVTensor<double> &PW,
+                                           vtkSVControlGrid *grid)
+{
+  vtkSVTensor<double> tmpPW = PW;
+  return grid->SetHomogeneousPoints(tmpPW);
+}
+
 // ----------------------
 // StructuredGridToTypedArray
 // ----------------------
@@ -56,8 +56,12 @@
 
 #include "vtkSVControlGrid.h"
 #include "vtkSVNURBSCollection.h"
+#include "vtkSVNURBSExtraction.h"
+#include "vtkSVNURBSRefinement.h"
+#include "vtkSVTensor.h"
 
 #include <cassert> // assert() in inline implementations.
+#include <vector>
 
 class VTKSVNURBS_EXPORT vtkSVNURBSUtils : public vtkObject
 {
@@ -209,6 +213,40 @@ public:
                              vtkDoubleArray *newUKnots,
                              vtkDoubleArray *newVKnots);
 
+  /** \brief Applies a full refinement plan to the homogeneous control points
+   *  and knots held in a work space. Each step sizes its output once and
+   *  processes all fibers of the control grid in parallel.
+   *  \param numberOfDirections Number of parametric directions of the object.
+   *  \param degrees Degree in each direction, updated to the final degrees.
+   *  \param plan The degrees and knots wanted.
+   *  \param work Holds the input points in work.Points and knots in
+   *  work.Knots, which are replaced by the refined ones. */
+  static int ApplyRefinementPlan(const int numberOfDirections, int degrees[3],
+                                 const vtkSVNURBSRefinementPlan &plan,
+                                 vtkSVNURBSRefinementWorkspace &work);
+
+  /** \brief Refines every curve, surface and volume of a collection with
+   *  the same plan, sharing one work space between all the patches. */
+  static int RefineCollection(vtkSVNURBSCollection *patches,
+                              const vtkSVNURBSRefinementPlan &plan);
+
+  /** \brief Computes the Bezier extraction operator of one element from
+   *  its local knot vector, without touching any control points.
+   *  \param localKnots The 2p+2 knots around the element, the element being
+   *  localKnots[p] to localKnots[p+1].
+   *  \param p Degree.
+   *  \param C (p+1)x(p+1) row major output, row i holds the Bernstein
+   *  coefficients of the ith basis function non-zero on the element. */
+  static int GetElementExtractionOperator(const double *localKnots,
+                                          const int p, double *C);
+
+  /** \brief Computes the extraction operators of all elements of all
+   *  curves, surfaces and volumes in a collection. Elements with the same
+   *  normalized local knots share one operator, and the unique operators
+   *  are computed in parallel. */
+  static int ComputeExtractionOperators(vtkSVNURBSCollection *patches,
+                                        vtkSVNURBSExtractionOperators &operators);
+
   /** \brief Removes a given knot from a nurbs object.
    *  \param controlPoints Control points of curve.
    *  \param uKnots The knots of the surface in the u direction.
@@ -556,6 +594,132 @@ public:
                                      vtkTypedArray<double> *newNPW,
                                      vtkTypedArray<double> *newPoints);
 
+  // Fiber kernels
+  // A fiber is the one dimensional row of homogeneous control points along the
+  // direction being modified, given as a rank 2 view of shape (n+1, 4). The
+  // surface and volume routines apply these to every fiber of the grid.
+  /** \brief Inserts a knot into one fiber of homogeneous control points.
+   *  \param Pw Input fiber of homogeneous control points.
+   *  \param knots The knot span of the fiber direction.
+   *  \param p Degree in the fiber direction.
+   *  \param u The knot value to insert.
+   *  \param span The span where the knot will be inserted. Use FindSpan.
+   *  \param currentMultiplicity The current multiplicity of u.
+   *  \param numberOfInserts Number of times to insert the knot.
+   *  \param scratch Work space, resized if needed so it can be reused.
+   *  \return Qw Output fiber, must have numberOfInserts more points than Pw. */
+  static int InsertKnotFiber(vtkSVTensorView<const double> Pw,
+                             const double *knots, const int p,
+                             const double u, const int span,
+                             const int currentMultiplicity,
+                             const int numberOfInserts,
+                             vtkSVTensorView<double> Qw,
+                             std::vector<double> &scratch);
+
+  /** \brief Performs knot refinement on one fiber of homogeneous control points.
+   *  \param Pw Input fiber of homogeneous control points.
+   *  \param knots The knot span of the fiber direction.
+   *  \param p Degree in the fiber direction.
+   *  \param insertKnots The increasing knots to insert.
+   *  \param numberOfInsertKnots The number of knots in insertKnots.
+   *  \param newKnots The refined knot span, see GetRefinedKnots.
+   *  \return Qw Output fiber, must have numberOfInsertKnots more points than Pw. */
+  static int KnotRefinementFiber(vtkSVTensorView<const double> Pw,
+                                 const double *knots, const int p,
+                                 const double *insertKnots,
+                                 const int numberOfInsertKnots,
+                                 const double *newKnots,
+                                 vtkSVTensorView<double> Qw);
+
+  /** \brief Elevates the degree of one fiber of homogeneous control points.
+   *  \param Pw Input fiber of homogeneous control points.
+   *  \param knots The knot span of the fiber direction.
+   *  \param p Degree in the fiber direction.
+   *  \param numberOfIncreases Number of times to elevate the degree.
+   *  \param bezalfs Coefficients from GetDegreeElevationCoefficients.
+   *  \param scratch Work space, resized if needed so it can be reused.
+   *  \return Qw Output fiber, must be large enough for the elevated points.
+   *  \return newKnots The elevated knot span, must be large enough.
+   *  \return nh The index of the last new control point. */
+  static int IncreaseDegreeFiber(vtkSVTensorView<const double> Pw,
+                                 const double *knots, const int p,
+                                 const int numberOfIncreases,
+                                 const vtkSVTensor<double> &bezalfs,
+                                 vtkSVTensorView<double> Qw,
+                                 double *newKnots, int &nh,
+                                 std::vector<double> &scratch);
+
+  /** \brief Computes the bezier degree elevation coefficients of a degree p
+   *  bezier elevated t times. Result is of shape (p+t+1, p+1). */
+  static int GetDegreeElevationCoefficients(const int p, const int t,
+                                            vtkSVTensor<double> &bezalfs);
+
+  /** \brief Computes the knot span after raising the degree t times. Every
+   *  distinct knot value gets its multiplicity increased by t. */
+  static int GetElevatedKnots(const double *knots, const int numKnots,
+                              const int numberOfIncreases,
+                              std::vector<double> &newKnots);
+
+  /** \brief Computes the knot span after refinement with the increasing set
+   *  of insertKnots. newKnots must hold numKnots+numberOfInsertKnots values. */
+  static int GetRefinedKnots(const double *knots, const int numKnots,
+                             const int p,
+                             const double *insertKnots,
+                             const int numberOfInsertKnots,
+                             double *newKnots);
+
+  /** \brief LU factorization with partial pivoting of a square matrix, in place.
+   *  \param A Square rank 2 tensor, replaced by its factors.
+   *  \return pivots The row permutation. */
+  static int LUFactor(vtkSVTensor<double> &A, std::vector<int> &pivots);
+
+  /** \brief Solves the system given by a factored matrix for every column of
+   *  the rank 2 view B (n rows by number of right hand sides), in place. */
+  static int LUSolve(const vtkSVTensor<double> &LU, const std::vector<int> &pivots,
+                     vtkSVTensorView<double> B);
+
+  /** \brief Solves A X = B along one axis of a rank 4 grid of shape
+   *  (n0, n1, n2, numComps). Used by the fitting routines to apply the
+   *  inverse of the basis function matrices one direction at a time.
+   *  \param A Square basis function matrix for direction axis.
+   *  \param axis The axis of the grid the matrix acts on.
+   *  \param grid The right hand side, replaced by the solution. */
+  static int SolveAlongAxis(const vtkSVTensor<double> &A, const int axis,
+                            vtkSVTensor<double> &grid);
+
+  /** \brief Computes the p+1 non-vanishing basis functions at u.
+   *  \param knots The knot span.
+   *  \param p Degree.
+   *  \param span The span containing u. Use FindSpan.
+   *  \param u Parameter value.
+   *  \param N Output array of length p+1, N[0] belongs to control point span-p. */
+  static int BasisFunctions(const double *knots, const int p, const int span,
+                            const double u, double *N);
+
+  /** \brief Evaluates a curve from homogeneous control points.
+   *  \param Pw Rank 2 view of shape (n+1, 4).
+   *  \param knots The knot span.
+   *  \param p Degree.
+   *  \param u Parameter value.
+   *  \param pt Output point, divided by the weight. */
+  static int CurvePoint(vtkSVTensorView<const double> Pw, const double *knots,
+                        const int p, const double u, double pt[3]);
+
+  /** \brief Evaluates a surface from homogeneous control points.
+   *  \param Pw Rank 3 view of shape (n+1, m+1, 4). Use
+   *  vtkSVControlGrid::GetHomogeneousPoints().Slice(2, 0).
+   *  \param uKnots The knot span in the u direction.
+   *  \param p Degree in the u direction.
+   *  \param vKnots The knot span in the v direction.
+   *  \param q Degree in the v direction.
+   *  \param u Parameter value in u.
+   *  \param v Parameter value in v.
+   *  \param pt Output point, divided by the weight. */
+  static int SurfacePoint(vtkSVTensorView<const double> Pw,
+                          const double *uKnots, const int p,
+                          const double *vKnots, const int q,
+                          const double u, const double v, double pt[3]);
+
   static int AddDerivativeRows(vtkTypedArray<double> *NP, vtkTypedArray<double> *newNP,
                                const int p, vtkDoubleArray *knots);
   static int AddDerivativePoints(vtkTypedArray<double> *points,
@@ -595,6 +759,12 @@ public:
   static int GetMatrixOfDim4Grid(vtkTypedArray<double> *grid, const int dim0, const int dim1, const int dim2, const int comp2, const int num3, vtkTypedArray<double> *matrix);
   static int SetMatrixOfDim4Grid(vtkTypedArray<double> *matrix, vtkTypedArray<double> *grid, const int dim0, const int dim1, const int dim2, const int comp2, const int num3);
   static int DeepCopy(vtkTypedArray<double> *input, vtkTypedArray<double> *output);
+  static int TypedArrayToTensor(vtkTypedArray<double> *array, vtkSVTensor<double> &output);
+  static int TensorToTypedArray(const vtkSVTensor<double> &tensor, vtkTypedArray<double> *output);
+  static int TensorToPoints(const vtkSVTensor<double> &tensor, vtkPoints *output);
+  static int TensorToStructuredGrid(const vtkSVTensor<double> &tensor, vtkStructuredGrid *output);
+  static int ControlGridToTensorPW(vtkSVControlGrid *grid, vtkSVTensor<double> &PW);
+  static int TensorPWToControlGrid(const vtkSVTensor<double> &PW, vtkSVControlGrid *grid);
 
   //Matrix and vector math
   static int MatrixPointsMultiply(vtkTypedArray<double> *mat, vtkPoints *pointVec, vtkPoints *output);
@@ -44,6 +44,9 @@
 #include "vtkSVCleanUnstructuredGrid.h"
 #include "vtkSVGlobals.h"
 #include "vtkSVNURBSUtils.h"
+
+#include <algorithm>
+
 // ----------------------
 // StandardNewMacro
 // ----------------------
@@ -273,6 +276,67 @@ void vtkSVNURBSVolume::SetControlPoints(vtkStructuredGrid *points3d)
 }
 
 
+// ----------------------
+// Refine
+// ----------------------
+int vtkSVNURBSVolume::Refine(const vtkSVNURBSRefinementPlan &plan)
+{
+  vtkSVNURBSRefinementWorkspace work;
+  return this->Refine(plan, work);
+}
+
+// ----------------------
+// Refine
+// ----------------------
+int vtkSVNURBSVolume::Refine(const vtkSVNURBSRefinementPlan &plan,
+                             vtkSVNURBSRefinementWorkspace &work)
+{
+  // Load homogeneous points and knots into the work space
+  vtkSVTensorView<double> PW = this->ControlPointGrid->GetHomogeneousPoints();
+  if (PW.GetData() == NULL)
+  {
+    vtkErrorMacro("Could not get homogeneous control points");
+    return SV_ERROR;
+  }
+  work.Points.Resize(PW.GetShape(0), PW.GetShape(1), PW.GetShape(2), 4);
+  work.Points.GetView().CopyFrom(PW);
+
+  for (int i=0; i<3; i++)
+  {
+    double *knots = this->UVWKnotVectors[i]->GetPointer(0);
+    work.Knots[i].assign(knots, knots+this->UVWKnotVectors[i]->GetNumberOfTuples());
+  }
+
+  int degrees[3] = {this->UDegree, this->VDegree, this->WDegree};
+  if (vtkSVNURBSUtils::ApplyRefinementPlan(3, degrees, plan, work) != SV_OK)
+  {
+    vtkErrorMacro("Error in refinement");
+    return SV_ERROR;
+  }
+
+  // Replace existing data with refined data
+  this->ControlPointGrid->SetHomogeneousPoints(work.Points);
+  for (int i=0; i<3; i++)
+  {
+    this->UVWKnotVectors[i]->SetNumberOfTuples(work.Knots[i].size());
+    std::copy(work.Knots[i].begin(), work.Knots[i].end(), this->UVWKnotVectors[i]->GetPointer(0));
+  }
+
+  int dim[3];
+  this->ControlPointGrid->GetDimensions(dim);
+  this->NumberOfUControlPoints = dim[0];
+  this->NumberOfVControlPoints = dim[1];
+  this->NumberOfWControlPoints = dim[2];
+  this->NumberOfUKnotPoints    = this->UKnotVector->GetNumberOfTuples();
+  this->NumberOfVKnotPoints    = this->VKnotVector->GetNumberOfTuples();
+  this->NumberOfWKnotPoints    = this->WKnotVector->GetNumberOfTuples();
+  this->UDegree = degrees[0];
+  this->VDegree = degrees[1];
+  this->WDegree = degrees[2];
+
+  return SV_OK;
+}
+
 // ----------------------
 // GenerateVolumeRepresentation
 // ----------------------
@@ -46,6 +46,7 @@
 #include "vtkSVNURBSModule.h"
 
 #include "vtkSVControlGrid.h"
+#include "vtkSVNURBSRefinement.h"
 #include "vtkDenseArray.h"
 #include "vtkDoubleArray.h"
 #include "vtkIntArray.h"
@@ -128,6 +129,14 @@ public:
   void UpdateCurve() {} /**< \brief Unimplemented */
   int IncreaseDegree(const int degree, const int dim) {return 0;} /**< \brief Unimplemented */
 
+  //@{
+  /** \brief Raise the degree and insert knots in all three directions
+   *  following a refinement plan. The control points are replaced in place.
+   *  Pass a work space to reuse its buffers between calls. */
+  int Refine(const vtkSVNURBSRefinementPlan &plan);
+  int Refine(const vtkSVNURBSRefinementPlan &plan, vtkSVNURBSRefinementWorkspace &work);
+  //@}
+
   int SetUKnotVector(vtkDoubleArray *knots);
   int SetVKnotVector(vtkDoubleArray *knots);
   int SetWKnotVector(vtkDoubleArray *knots);